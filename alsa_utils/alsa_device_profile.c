@@ -20,8 +20,11 @@
 
 #include <errno.h>
 #include <inttypes.h>
+#include <pthread.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <cutils/properties.h>
 
 #include <log/log.h>
@@ -58,6 +61,11 @@ extern int8_t const pcm_format_value_map[50];
 static const unsigned std_sample_rates[] =
     {96000, 88200, 192000, 176400, 48000, 44100, 32000, 24000, 22050, 16000, 12000, 11025, 8000};
 
+/* serializes completion of two-phase profile reads, see the "Two-phase load"
+ * section below */
+static pthread_mutex_t profile_async_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t profile_async_cond = PTHREAD_COND_INITIALIZER;
+
 static void profile_reset(alsa_device_profile* profile)
 {
     profile->card = profile->device = -1;
@@ -71,6 +79,7 @@ static void profile_reset(alsa_device_profile* profile)
     profile->min_channel_count = profile->max_channel_count = DEFAULT_CHANNEL_COUNT;
 
     profile->is_valid = false;
+    profile->partial = false;
 }
 
 void profile_init(alsa_device_profile* profile, int direction)
@@ -93,7 +102,13 @@ bool profile_is_cached_for(const alsa_device_profile* profile, int card, int dev
 }
 
 void profile_decache(alsa_device_profile* profile) {
+    /* under the async lock so a completion worker cannot swap probed
+     * capabilities into a decached profile, and so that any waiters see the
+     * pending flag clear */
+    pthread_mutex_lock(&profile_async_lock);
     profile_reset(profile);
+    pthread_cond_broadcast(&profile_async_cond);
+    pthread_mutex_unlock(&profile_async_lock);
 }
 
 /*
@@ -433,12 +448,114 @@ static int read_alsa_device_config(alsa_device_profile * profile, struct pcm_con
     return ret;
 }
 
+/*
+ * Capability cache
+ *
+ * Probing the supported sample rates opens the device once per candidate
+ * rate, which can take hundreds of milliseconds on some USB DACs (and the
+ * kernel serializes opens of a single ALSA device, so the probes cannot
+ * usefully run concurrently).  Instead, the probed capabilities are cached
+ * in-process keyed by the card's USB ID (VID:PID, from
+ * /proc/asound/cardN/usbid) and the stream direction, so replugging a known
+ * device skips the probing entirely.  Cards without a USB ID are probed
+ * every time as before.
+ */
+
+#define PROFILE_CACHE_SIZE 16
+#define USB_ID_SIZE 16          /* "vvvv:pppp" plus margin */
+
+struct profile_cache_entry {
+    bool in_use;
+    char usb_id[USB_ID_SIZE];
+    alsa_device_profile caps;   /* card/device fields are not meaningful */
+};
+
+static struct profile_cache_entry profile_cache[PROFILE_CACHE_SIZE];
+static unsigned profile_cache_next;
+static pthread_mutex_t profile_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static bool read_usb_device_id(int card, char* usb_id, size_t size)
+{
+    char path[sizeof("/proc/asound/card") + 20];
+
+    snprintf(path, sizeof(path), "/proc/asound/card%d/usbid", card);
+    FILE* file = fopen(path, "re");
+    if (file == NULL) {
+        return false;   /* not a USB card */
+    }
+    const bool ok = fgets(usb_id, size, file) != NULL;
+    fclose(file);
+    if (!ok) {
+        return false;
+    }
+    usb_id[strcspn(usb_id, "\n")] = '\0';
+    return usb_id[0] != '\0';
+}
+
+static bool profile_cache_lookup(alsa_device_profile* profile, const char* usb_id)
+{
+    bool found = false;
+
+    pthread_mutex_lock(&profile_cache_lock);
+    for (size_t i = 0; i < PROFILE_CACHE_SIZE; i++) {
+        const struct profile_cache_entry* entry = &profile_cache[i];
+        if (entry->in_use && entry->caps.direction == profile->direction &&
+                strcmp(entry->usb_id, usb_id) == 0) {
+            const int card = profile->card;
+            const int device = profile->device;
+            *profile = entry->caps;
+            profile->card = card;
+            profile->device = device;
+            found = true;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&profile_cache_lock);
+    if (found) {
+        ALOGV("%s: profile for %s dir %d filled from cache",
+              __func__, usb_id, profile->direction);
+    }
+    return found;
+}
+
+static void profile_cache_store(const alsa_device_profile* profile, const char* usb_id)
+{
+    struct profile_cache_entry* entry = NULL;
+
+    pthread_mutex_lock(&profile_cache_lock);
+    for (size_t i = 0; i < PROFILE_CACHE_SIZE; i++) {
+        if (profile_cache[i].in_use &&
+                profile_cache[i].caps.direction == profile->direction &&
+                strcmp(profile_cache[i].usb_id, usb_id) == 0) {
+            entry = &profile_cache[i];  /* refresh the existing entry */
+            break;
+        }
+    }
+    if (entry == NULL) {
+        entry = &profile_cache[profile_cache_next++ % PROFILE_CACHE_SIZE];
+    }
+    entry->in_use = true;
+    strlcpy(entry->usb_id, usb_id, sizeof(entry->usb_id));
+    entry->caps = *profile;
+    /* cached capabilities are complete by definition; a profile snapshotted
+     * mid-async-probe must not leak partial = true into future lookups */
+    entry->caps.partial = false;
+    pthread_mutex_unlock(&profile_cache_lock);
+}
+
 bool profile_read_device_info(alsa_device_profile* profile)
 {
     if (!profile_is_initialized(profile)) {
         return false;
     }
 
+    /* a replugged USB device we have seen before needs no probing */
+    char usb_id[USB_ID_SIZE];
+    const bool have_usb_id = read_usb_device_id(profile->card, usb_id, sizeof(usb_id));
+    if (have_usb_id && profile_cache_lookup(profile, usb_id)) {
+        return true;
+    }
+
     /* let's get some defaults */
     read_alsa_device_config(profile, &profile->default_config);
     ALOGV("default_config chans:%d rate:%d format:%d count:%d size:%d",
@@ -470,9 +587,160 @@ bool profile_read_device_info(alsa_device_profile* profile)
     profile->is_valid = true;
 
     pcm_params_free(alsa_hw_params);
+
+    /* an empty rate list means every probe failed (e.g. the device was busy);
+     * don't let that poison the cache for the next plug */
+    if (have_usb_id && profile->sample_rates[0] != 0) {
+        profile_cache_store(profile, usb_id);
+    }
     return true;
 }
 
+/*
+ * Two-phase load
+ *
+ * Everything in a profile except the sample rate list comes from a single
+ * pcm_params_get() query.  The rate list is the expensive part: each
+ * candidate rate in std_sample_rates[] is verified by opening and closing
+ * the device, which can take hundreds of milliseconds on USB and gates
+ * plug-to-first-audio.  profile_read_device_info_async() therefore returns
+ * as soon as the profile is usable -- default config, formats and channel
+ * counts filled in, the rate list holding just the default rate -- and
+ * finishes the rate probes on a detached worker thread.  The worker probes
+ * a private copy and swaps the result in under profile_async_lock, so the
+ * caller-visible profile goes from minimal to complete in one step.
+ *
+ * A rate probe that races the caller's own open of the device simply fails
+ * for that rate, so a probe run that comes back empty is discarded and the
+ * minimal profile is kept (and not cached, see above).
+ */
+
+struct profile_async_job {
+    alsa_device_profile probe;      /* private copy the worker probes into */
+    alsa_device_profile* target;
+};
+
+static void* profile_async_worker(void* arg)
+{
+    struct profile_async_job* job = (struct profile_async_job*)arg;
+    alsa_device_profile* probe = &job->probe;
+
+    /* the snapshot was taken with partial still set; clear it before the
+     * probe so the completed result reads complete when copied around */
+    probe->partial = false;
+    /* the minimal profile in the target stays usable while this runs */
+    const bool ok = profile_read_device_info(probe) && probe->sample_rates[0] != 0;
+
+    pthread_mutex_lock(&profile_async_lock);
+    alsa_device_profile* target = job->target;
+    if (target->partial && profile_is_cached_for(target, probe->card, probe->device)) {
+        if (ok) {
+            *target = *probe;
+        } else {
+            ALOGW("%s: full capability probe failed for card %d device %d, "
+                  "keeping minimal profile", __func__, probe->card, probe->device);
+        }
+        target->partial = false;
+        pthread_cond_broadcast(&profile_async_cond);
+    } /* else the profile was decached or reused while we probed */
+    pthread_mutex_unlock(&profile_async_lock);
+
+    free(job);
+    return NULL;
+}
+
+bool profile_read_device_info_async(alsa_device_profile* profile)
+{
+    if (!profile_is_initialized(profile)) {
+        return false;
+    }
+
+    /* a replugged USB device we have seen before yields the full profile
+     * immediately */
+    char usb_id[USB_ID_SIZE];
+    if (read_usb_device_id(profile->card, usb_id, sizeof(usb_id)) &&
+            profile_cache_lookup(profile, usb_id)) {
+        profile->partial = false;
+        return true;
+    }
+
+    if (read_alsa_device_config(profile, &profile->default_config) != 0) {
+        return false;
+    }
+    ALOGV("default_config chans:%d rate:%d format:%d count:%d size:%d",
+          profile->default_config.channels, profile->default_config.rate,
+          profile->default_config.format, profile->default_config.period_count,
+          profile->default_config.period_size);
+
+    struct pcm_params * alsa_hw_params = pcm_params_get(profile->card,
+                                                        profile->device,
+                                                        profile->direction);
+    if (alsa_hw_params == NULL) {
+        return false;
+    }
+
+    /* formats and channel counts come from the params query, no opens needed */
+    profile_enum_sample_formats(profile,
+            pcm_params_get_mask(alsa_hw_params, PCM_PARAM_FORMAT));
+    profile_enum_channel_counts(
+            profile, pcm_params_get_min(alsa_hw_params, PCM_PARAM_CHANNELS),
+            pcm_params_get_max(alsa_hw_params, PCM_PARAM_CHANNELS));
+    pcm_params_free(alsa_hw_params);
+
+    /* just the default rate until the worker finishes the open/close probes */
+    profile->sample_rates[0] = profile->default_config.rate;
+    profile->sample_rates[1] = 0;
+
+    profile->is_valid = true;
+
+    pthread_mutex_lock(&profile_async_lock);
+    profile->partial = true;
+    pthread_mutex_unlock(&profile_async_lock);
+
+    struct profile_async_job* job =
+            (struct profile_async_job *)calloc(1, sizeof(*job));
+    bool started = false;
+    if (job != NULL) {
+        job->probe = *profile;
+        job->target = profile;
+
+        pthread_t thread;
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        started = pthread_create(&thread, &attr, profile_async_worker, job) == 0;
+        pthread_attr_destroy(&attr);
+        if (!started) {
+            free(job);
+        }
+    }
+    if (!started) {
+        /* no worker; fall back to completing in place */
+        pthread_mutex_lock(&profile_async_lock);
+        profile->partial = false;
+        pthread_mutex_unlock(&profile_async_lock);
+        return profile_read_device_info(profile);
+    }
+    return true;
+}
+
+bool profile_is_complete(const alsa_device_profile* profile)
+{
+    pthread_mutex_lock(&profile_async_lock);
+    const bool complete = !profile->partial;
+    pthread_mutex_unlock(&profile_async_lock);
+    return complete;
+}
+
+void profile_wait_until_complete(alsa_device_profile* profile)
+{
+    pthread_mutex_lock(&profile_async_lock);
+    while (profile->partial) {
+        pthread_cond_wait(&profile_async_cond, &profile_async_lock);
+    }
+    pthread_mutex_unlock(&profile_async_lock);
+}
+
 char * profile_get_sample_rate_strs(const alsa_device_profile* profile)
 {
     /* if we assume that rate strings are about 5 characters (48000 is 5), plus ~1 for a
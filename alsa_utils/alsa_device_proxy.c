@@ -15,13 +15,16 @@
  */
 
 #define LOG_TAG "alsa_device_proxy"
+#define ATRACE_TAG ATRACE_TAG_AUDIO
 /*#define LOG_NDEBUG 0*/
 /*#define LOG_PCM_PARAMS 0*/
 
+#include <cutils/trace.h>
 #include <log/log.h>
 
 #include <errno.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <audio_utils/clock.h>
@@ -35,6 +38,12 @@
 
 #define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
 
+/* stream id used in trace records: recognizable from the card and device */
+static inline int proxy_trace_id(const alsa_device_proxy * proxy)
+{
+    return (proxy->profile->card << 8) | (proxy->profile->device & 0xFF);
+}
+
 static const unsigned format_byte_size_map[] = {
     2, /* PCM_FORMAT_S16_LE */
     4, /* PCM_FORMAT_S32_LE */
@@ -104,6 +113,9 @@ int proxy_prepare(alsa_device_proxy * proxy, const alsa_device_profile* profile,
     }
 
     proxy->pcm = NULL;
+    proxy->open_flags = 0;
+    proxy->gather_buffer = NULL;
+    proxy->gather_size = 0;
     // config format should be checked earlier against profile.
     if (config->format >= 0 && (size_t)config->format < ARRAY_SIZE(format_byte_size_map)) {
         proxy->frame_size = format_byte_size_map[config->format] * proxy->alsa_config.channels;
@@ -126,7 +138,7 @@ int proxy_prepare(alsa_device_proxy * proxy, const alsa_device_profile* profile,
     return ret;
 }
 
-int proxy_open(alsa_device_proxy * proxy)
+static int proxy_open_with_flags(alsa_device_proxy * proxy, unsigned flags)
 {
     const alsa_device_profile* profile = proxy->profile;
     ALOGV("proxy_open(card:%d device:%d %s)", profile->card, profile->device,
@@ -137,10 +149,11 @@ int proxy_open(alsa_device_proxy * proxy)
     }
 
     proxy->pcm = pcm_open(profile->card, profile->device,
-            profile->direction | PCM_MONOTONIC, &proxy->alsa_config);
+            profile->direction | flags, &proxy->alsa_config);
     if (proxy->pcm == NULL) {
         return -ENOMEM;
     }
+    proxy->open_flags = profile->direction | flags;
 
     if (!pcm_is_ready(proxy->pcm)) {
         ALOGE("  proxy_open() pcm_is_ready() failed: %s", pcm_get_error(proxy->pcm));
@@ -152,6 +165,85 @@ int proxy_open(alsa_device_proxy * proxy)
         return -ENOMEM;
     }
 
+    alsa_trace_record(ALSA_TRACE_EVENT_OPEN, proxy_trace_id(proxy),
+            flags, proxy->alsa_config.rate);
+    return 0;
+}
+
+int proxy_open(alsa_device_proxy * proxy)
+{
+    return proxy_open_with_flags(proxy, PCM_MONOTONIC);
+}
+
+int proxy_open_mmap(alsa_device_proxy * proxy)
+{
+    return proxy_open_with_flags(proxy, PCM_MMAP | PCM_MONOTONIC);
+}
+
+/*
+ * Returns the supplied value rounded up to the next even multiple of 16
+ */
+static unsigned int round_to_16_mult(unsigned int size)
+{
+    return (size + 15) & ~15;   /* 0xFFFFFFF0; */
+}
+
+int proxy_set_period_hint(alsa_device_proxy * proxy, unsigned int period_size,
+        unsigned int period_count)
+{
+    const alsa_device_profile* profile = proxy->profile;
+
+    /* stage the new configuration completely before touching the stream */
+    if (period_size == 0) {
+        period_size = proxy->alsa_config.period_size;
+    }
+    period_size = round_to_16_mult(period_size);
+    if (profile->min_period_size != 0 && period_size < profile->min_period_size) {
+        period_size = round_to_16_mult(profile->min_period_size);
+    }
+    if (profile->max_period_size != 0 && period_size > profile->max_period_size) {
+        period_size = profile->max_period_size & ~15u;
+    }
+    if (period_count == 0) {
+        period_count = proxy->alsa_config.period_count;
+    }
+
+    if (period_size == proxy->alsa_config.period_size &&
+            period_count == proxy->alsa_config.period_count) {
+        return 0;   /* already configured this way, no gap at all */
+    }
+
+    ALOGV("proxy_set_period_hint() %u x %u -> %u x %u",
+          proxy->alsa_config.period_size, proxy->alsa_config.period_count,
+          period_size, period_count);
+
+    const struct pcm_config saved_config = proxy->alsa_config;
+    proxy->alsa_config.period_size = period_size;
+    proxy->alsa_config.period_count = period_count;
+
+    if (proxy->pcm == NULL) {
+        return 0;   /* not open; the hint takes effect at the next proxy_open() */
+    }
+
+    /* The kernel cannot renegotiate hw_params on an open stream, so the gap
+     * is exactly one close/reopen with everything else staged above.  The
+     * close is not a proxy_close(): the gather buffer and the cumulative
+     * transferred count survive the swap, as they do across standby. */
+    const unsigned flags = proxy->open_flags & ~(unsigned)(PCM_OUT | PCM_IN);
+    alsa_trace_record(ALSA_TRACE_EVENT_CLOSE, proxy_trace_id(proxy),
+            proxy->transferred, 0);
+    pcm_close(proxy->pcm);
+    proxy->pcm = NULL;
+
+    int ret = proxy_open_with_flags(proxy, flags);
+    if (ret != 0) {
+        /* the device rejected the new geometry: fall back to the old one */
+        ALOGW("proxy_set_period_hint() reopen with %u x %u failed (%d), "
+              "restoring %u x %u", period_size, period_count, ret,
+              saved_config.period_size, saved_config.period_count);
+        proxy->alsa_config = saved_config;
+        return proxy_open_with_flags(proxy, flags);
+    }
     return 0;
 }
 
@@ -160,9 +252,15 @@ void proxy_close(alsa_device_proxy * proxy)
     ALOGV("proxy_close() [pcm:%p]", proxy->pcm);
 
     if (proxy->pcm != NULL) {
+        alsa_trace_record(ALSA_TRACE_EVENT_CLOSE, proxy_trace_id(proxy),
+                proxy->transferred, 0);
         pcm_close(proxy->pcm);
         proxy->pcm = NULL;
     }
+
+    free(proxy->gather_buffer);
+    proxy->gather_buffer = NULL;
+    proxy->gather_size = 0;
 }
 
 /*
@@ -260,22 +358,178 @@ int proxy_get_capture_position(const alsa_device_proxy * proxy,
  */
 int proxy_write(alsa_device_proxy * proxy, const void *data, unsigned int count)
 {
+    atrace_begin(ATRACE_TAG, "proxy_write");
     int ret = pcm_write(proxy->pcm, data, count);
+    atrace_end(ATRACE_TAG);
     if (ret == 0) {
         proxy->transferred += count / proxy->frame_size;
+        alsa_trace_record(ALSA_TRACE_EVENT_WRITE, proxy_trace_id(proxy),
+                count, proxy->transferred);
+    } else {
+        alsa_trace_record(ALSA_TRACE_EVENT_XRUN, proxy_trace_id(proxy),
+                count, ret);
     }
     return ret;
 }
 
 int proxy_read(alsa_device_proxy * proxy, void *data, unsigned int count)
 {
+    atrace_begin(ATRACE_TAG, "proxy_read");
     int ret = pcm_read(proxy->pcm, data, count);
+    atrace_end(ATRACE_TAG);
     if (ret == 0) {
         proxy->transferred += count / proxy->frame_size;
+        alsa_trace_record(ALSA_TRACE_EVENT_READ, proxy_trace_id(proxy),
+                count, proxy->transferred);
+    } else {
+        alsa_trace_record(ALSA_TRACE_EVENT_XRUN, proxy_trace_id(proxy),
+                count, ret);
     }
     return ret;
 }
 
+/* gathers the fragments directly into the ALSA ring buffer */
+static int proxy_writev_mmap(alsa_device_proxy * proxy, const struct iovec *iov,
+        size_t total_bytes)
+{
+    size_t frag = 0;
+    size_t frag_offset = 0;
+    size_t remaining = total_bytes;
+
+    while (remaining != 0) {
+        void *areas;
+        unsigned int offset;
+        unsigned int frames = remaining / proxy->frame_size;
+
+        int ret = pcm_mmap_begin(proxy->pcm, &areas, &offset, &frames);
+        if (ret < 0) {
+            return ret;
+        }
+        if (frames == 0) {
+            ret = pcm_wait(proxy->pcm, 1000);
+            if (ret < 0) {
+                return ret;
+            }
+            continue;
+        }
+        if ((size_t)frames > remaining / proxy->frame_size) {
+            frames = remaining / proxy->frame_size;
+        }
+
+        uint8_t *dst = (uint8_t *)areas + (size_t)offset * proxy->frame_size;
+        const size_t chunk = (size_t)frames * proxy->frame_size;
+        size_t copied = 0;
+        while (copied < chunk) {
+            size_t n = iov[frag].iov_len - frag_offset;
+            if (n > chunk - copied) {
+                n = chunk - copied;
+            }
+            memcpy(dst + copied,
+                   (const uint8_t *)iov[frag].iov_base + frag_offset, n);
+            copied += n;
+            frag_offset += n;
+            if (frag_offset == iov[frag].iov_len) {
+                frag++;
+                frag_offset = 0;
+            }
+        }
+
+        ret = pcm_mmap_commit(proxy->pcm, offset, frames);
+        if (ret < 0) {
+            return ret;
+        }
+        proxy->transferred += frames;
+        remaining -= chunk;
+    }
+
+    return 0;
+}
+
+int proxy_writev(alsa_device_proxy * proxy, const struct iovec *iov, int iov_count)
+{
+    size_t total_bytes = 0;
+
+    for (int i = 0; i < iov_count; i++) {
+        total_bytes += iov[i].iov_len;
+    }
+    if (total_bytes == 0) {
+        return 0;
+    }
+    if (total_bytes % proxy->frame_size != 0) {
+        ALOGE("proxy_writev() %zu bytes is not a whole number of frames", total_bytes);
+        return -EINVAL;
+    }
+    if (proxy->pcm == NULL) {
+        return -ENODEV;
+    }
+
+    if ((proxy->open_flags & PCM_MMAP) != 0) {
+        int ret = proxy_writev_mmap(proxy, iov, total_bytes);
+        if (ret == 0) {
+            alsa_trace_record(ALSA_TRACE_EVENT_WRITE, proxy_trace_id(proxy),
+                    total_bytes, proxy->transferred);
+        } else {
+            alsa_trace_record(ALSA_TRACE_EVENT_XRUN, proxy_trace_id(proxy),
+                    total_bytes, ret);
+        }
+        return ret;
+    }
+
+    if (proxy->gather_size < total_bytes) {
+        void *new_buffer = realloc(proxy->gather_buffer, total_bytes);
+        if (new_buffer == NULL) {
+            return -ENOMEM;
+        }
+        proxy->gather_buffer = new_buffer;
+        proxy->gather_size = total_bytes;
+    }
+
+    uint8_t *dst = proxy->gather_buffer;
+    for (int i = 0; i < iov_count; i++) {
+        memcpy(dst, iov[i].iov_base, iov[i].iov_len);
+        dst += iov[i].iov_len;
+    }
+
+    return proxy_write(proxy, proxy->gather_buffer, total_bytes);
+}
+
+int proxy_mmap_begin(alsa_device_proxy * proxy, void **buffer, unsigned int *frames)
+{
+    void *areas;
+
+    if (proxy->pcm == NULL) {
+        return -ENODEV;
+    }
+    int ret = pcm_mmap_begin(proxy->pcm, &areas, &proxy->mmap_offset, frames);
+    if (ret < 0) {
+        return ret;
+    }
+    /* hand back the usable region directly so the caller renders in place */
+    *buffer = (uint8_t *)areas + (size_t)proxy->mmap_offset * proxy->frame_size;
+    return 0;
+}
+
+int proxy_mmap_commit(alsa_device_proxy * proxy, unsigned int frames)
+{
+    if (proxy->pcm == NULL) {
+        return -ENODEV;
+    }
+    int ret = pcm_mmap_commit(proxy->pcm, proxy->mmap_offset, frames);
+    if (ret < 0) {
+        return ret;
+    }
+    proxy->transferred += frames;
+    return 0;
+}
+
+int proxy_mmap_wait(alsa_device_proxy * proxy, int timeout_ms)
+{
+    if (proxy->pcm == NULL) {
+        return -ENODEV;
+    }
+    return pcm_wait(proxy->pcm, timeout_ms);
+}
+
 /*
  * Debugging
  */
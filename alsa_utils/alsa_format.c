@@ -23,6 +23,62 @@
 
 #define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
 
+/*
+ * One row per PCM encoding expressible on both sides: tinyalsa format,
+ * audio HAL format.  Both lookup tables below are generated from this list,
+ * so the two directions cannot drift apart.  Both 24-bit packings are
+ * covered: AUDIO_FORMAT_PCM_8_24_BIT (24 bits in a 32-bit word) and
+ * AUDIO_FORMAT_PCM_24_BIT_PACKED (3 bytes per sample).
+ */
+#define ALSA_FORMAT_MAP_LIST(V)                             \
+    V(PCM_FORMAT_S16_LE,  AUDIO_FORMAT_PCM_16_BIT)          \
+    V(PCM_FORMAT_S32_LE,  AUDIO_FORMAT_PCM_32_BIT)          \
+    V(PCM_FORMAT_S8,      AUDIO_FORMAT_PCM_8_BIT)           \
+    V(PCM_FORMAT_S24_LE,  AUDIO_FORMAT_PCM_8_24_BIT)        \
+    V(PCM_FORMAT_S24_3LE, AUDIO_FORMAT_PCM_24_BIT_PACKED)
+
+/* Indexed by enum pcm_format. */
+static audio_format_t const audio_format_value_map[] = {
+#define V(alsa, hal) [alsa] = (hal),
+    ALSA_FORMAT_MAP_LIST(V)
+#undef V
+};
+
+_Static_assert(ARRAY_SIZE(audio_format_value_map) == PCM_FORMAT_MAX,
+        "audio_format_value_map must cover every enum pcm_format");
+
+/*
+ * Indexed by linear PCM audio_format_t value.  The two subformats with no
+ * tinyalsa equivalent are pinned to PCM_FORMAT_INVALID explicitly, because an
+ * initializer gap would silently read as 0 == PCM_FORMAT_S16_LE.
+ */
+static int8_t const pcm_format_value_map_from_audio[] = {
+    [AUDIO_FORMAT_DEFAULT]   = PCM_FORMAT_INVALID,
+    [AUDIO_FORMAT_PCM_FLOAT] = PCM_FORMAT_INVALID,
+#define V(alsa, hal) [hal] = (alsa),
+    ALSA_FORMAT_MAP_LIST(V)
+#undef V
+};
+
+_Static_assert(ARRAY_SIZE(pcm_format_value_map_from_audio) == AUDIO_FORMAT_PCM_24_BIT_PACKED + 1,
+        "pcm_format_value_map_from_audio must cover every linear PCM subformat");
+
+audio_format_t audio_format_from_pcm_format(enum pcm_format format)
+{
+    if (format < 0 || (size_t)format >= ARRAY_SIZE(audio_format_value_map)) {
+        return AUDIO_FORMAT_INVALID;
+    }
+    return audio_format_value_map[format];
+}
+
+enum pcm_format pcm_format_from_audio_format(audio_format_t format)
+{
+    if ((size_t)format >= ARRAY_SIZE(pcm_format_value_map_from_audio)) {
+        return PCM_FORMAT_INVALID;
+    }
+    return pcm_format_value_map_from_audio[format];
+}
+
 /*
  * Maps from bit position in pcm_mask to PCM_ format constants.
  */
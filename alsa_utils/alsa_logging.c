@@ -17,7 +17,13 @@
 #define LOG_TAG "alsa_logging"
 /*#define LOG_NDEBUG 0*/
 
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <string.h>
+#include <time.h>
 
 #include <log/log.h>
 
@@ -100,6 +106,184 @@ void log_pcm_params(struct pcm_params * alsa_hw_params)
           pcm_params_get_max(alsa_hw_params, PCM_PARAM_TICK_TIME));
 }
 
+/*
+ * Binary event tracing
+ *
+ * Records go into a preallocated power-of-two ring.  Producers claim a
+ * slot with an atomic increment, fill it, then publish it by storing the
+ * slot sequence number (claim index + 1) with release ordering.  The
+ * drain thread reads a slot, then re-checks the sequence number to detect
+ * that a lapping producer overwrote it mid-read; overwritten and skipped
+ * records are counted as drops.
+ */
+
+#define TRACE_RING_SIZE 1024    /* power of two */
+#define TRACE_DRAIN_INTERVAL_NS (100 * 1000000LL)
+
+struct trace_record {
+    atomic_uint_fast64_t seq;   /* claim index + 1, written last */
+    int64_t ts_ns;
+    int64_t arg0;
+    int64_t arg1;
+    int32_t event;
+    int32_t id;
+};
+
+static struct {
+    struct trace_record ring[TRACE_RING_SIZE];
+    atomic_uint_fast64_t head;  /* next slot to claim */
+    uint64_t tail;              /* next slot to drain, drain thread only */
+    uint64_t dropped;
+
+    atomic_bool enabled;
+    bool started;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t exit_cond;
+    bool exit;
+} trace = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .exit_cond = PTHREAD_COND_INITIALIZER,
+};
+
+static const char * const trace_event_names[] = {
+    "open",     /* ALSA_TRACE_EVENT_OPEN */
+    "close",    /* ALSA_TRACE_EVENT_CLOSE */
+    "read",     /* ALSA_TRACE_EVENT_READ */
+    "write",    /* ALSA_TRACE_EVENT_WRITE */
+    "xrun",     /* ALSA_TRACE_EVENT_XRUN */
+};
+
+void alsa_trace_record(enum alsa_trace_event event, int id, int64_t arg0, int64_t arg1)
+{
+    if (!atomic_load_explicit(&trace.enabled, memory_order_relaxed))
+        return;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    const uint64_t index = atomic_fetch_add_explicit(&trace.head, 1,
+            memory_order_relaxed);
+    struct trace_record *rec = &trace.ring[index & (TRACE_RING_SIZE - 1)];
+
+    rec->ts_ns = ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    rec->event = event;
+    rec->id = id;
+    rec->arg0 = arg0;
+    rec->arg1 = arg1;
+    atomic_store_explicit(&rec->seq, index + 1, memory_order_release);
+}
+
+static void trace_drain(void)
+{
+    const uint64_t head = atomic_load_explicit(&trace.head, memory_order_acquire);
+
+    /* producers may have lapped the ring since the last drain */
+    if (head - trace.tail > TRACE_RING_SIZE) {
+        trace.dropped += head - TRACE_RING_SIZE - trace.tail;
+        trace.tail = head - TRACE_RING_SIZE;
+    }
+
+    while (trace.tail != head) {
+        struct trace_record *rec = &trace.ring[trace.tail & (TRACE_RING_SIZE - 1)];
+
+        if (atomic_load_explicit(&rec->seq, memory_order_acquire) !=
+                trace.tail + 1)
+            break;      /* not yet published */
+
+        const struct trace_record copy = {
+            .ts_ns = rec->ts_ns,
+            .arg0 = rec->arg0,
+            .arg1 = rec->arg1,
+            .event = rec->event,
+            .id = rec->id,
+        };
+        /* a producer lapping us mid-read bumps the sequence number */
+        if (atomic_load_explicit(&rec->seq, memory_order_acquire) !=
+                trace.tail + 1) {
+            trace.dropped++;
+            trace.tail++;
+            continue;
+        }
+
+        const char *name = (size_t)copy.event < ARRAY_SIZE(trace_event_names) ?
+                trace_event_names[copy.event] : "?";
+        ALOGD("trace: %" PRId64 ".%06u %s id=%#x arg0=%" PRId64 " arg1=%" PRId64,
+              copy.ts_ns / 1000000000LL,
+              (unsigned)(copy.ts_ns % 1000000000LL) / 1000,
+              name, copy.id, copy.arg0, copy.arg1);
+        trace.tail++;
+    }
+
+    if (trace.dropped != 0) {
+        ALOGW("trace: dropped %" PRIu64 " records", trace.dropped);
+        trace.dropped = 0;
+    }
+}
+
+static void *trace_drain_thread(void *arg)
+{
+    (void)arg;
+
+    pthread_mutex_lock(&trace.lock);
+    while (!trace.exit) {
+        struct timespec ts;
+
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += TRACE_DRAIN_INTERVAL_NS;
+        ts.tv_sec += ts.tv_nsec / 1000000000LL;
+        ts.tv_nsec %= 1000000000LL;
+        pthread_cond_timedwait(&trace.exit_cond, &trace.lock, &ts);
+
+        pthread_mutex_unlock(&trace.lock);
+        trace_drain();
+        pthread_mutex_lock(&trace.lock);
+    }
+    pthread_mutex_unlock(&trace.lock);
+
+    return NULL;
+}
+
+int alsa_trace_start(void)
+{
+    int ret = 0;
+
+    pthread_mutex_lock(&trace.lock);
+    if (!trace.started) {
+        trace.exit = false;
+        if (pthread_create(&trace.thread, NULL, trace_drain_thread, NULL) != 0) {
+            ALOGE("unable to start trace drain thread");
+            ret = -ENOMEM;
+        } else {
+            trace.started = true;
+            atomic_store(&trace.enabled, true);
+        }
+    }
+    pthread_mutex_unlock(&trace.lock);
+
+    return ret;
+}
+
+void alsa_trace_stop(void)
+{
+    pthread_mutex_lock(&trace.lock);
+    if (!trace.started) {
+        pthread_mutex_unlock(&trace.lock);
+        return;
+    }
+    atomic_store(&trace.enabled, false);
+    trace.exit = true;
+    pthread_cond_signal(&trace.exit_cond);
+    pthread_mutex_unlock(&trace.lock);
+
+    pthread_join(trace.thread, NULL);
+    trace_drain();      /* flush whatever is still queued */
+
+    pthread_mutex_lock(&trace.lock);
+    trace.started = false;
+    pthread_mutex_unlock(&trace.lock);
+}
+
 void log_pcm_config(struct pcm_config * config, const char* label) {
     ALOGV("log_pcm_config() - %s", label);
     ALOGV("  channels:%d", config->channels);
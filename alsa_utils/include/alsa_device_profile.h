@@ -50,6 +50,10 @@ typedef struct  {
 
     bool is_valid;
 
+    /* minimal profile from profile_read_device_info_async(); the full sample
+     * rate enumeration is still completing on a worker thread */
+    bool partial;
+
     /* read from the hardware device */
     struct pcm_config default_config;
 
@@ -68,6 +72,16 @@ void profile_decache(alsa_device_profile* profile);
 
 bool profile_read_device_info(alsa_device_profile* profile);
 
+/* Two-phase variant of profile_read_device_info(): returns as soon as the
+ * profile is usable for an open (default config, formats and channel counts,
+ * but only the default sample rate), then completes the per-rate open/close
+ * probes on a detached worker thread and swaps the full rate list in under a
+ * lock.  Use profile_is_complete()/profile_wait_until_complete() before
+ * reporting full capabilities (e.g. to audio policy). */
+bool profile_read_device_info_async(alsa_device_profile* profile);
+bool profile_is_complete(const alsa_device_profile* profile);
+void profile_wait_until_complete(alsa_device_profile* profile);
+
 /* Audio Config Strings Methods */
 char * profile_get_sample_rate_strs(const alsa_device_profile* profile);
 char * profile_get_format_strs(const alsa_device_profile* profile);
@@ -17,6 +17,8 @@
 #ifndef ANDROID_SYSTEM_MEDIA_ALSA_UTILS_ALSA_DEVICE_PROXY_H
 #define ANDROID_SYSTEM_MEDIA_ALSA_UTILS_ALSA_DEVICE_PROXY_H
 
+#include <sys/uio.h>
+
 #include <tinyalsa/asoundlib.h>
 
 #include "alsa_device_profile.h"
@@ -27,9 +29,17 @@ typedef struct {
     struct pcm_config alsa_config;
 
     struct pcm * pcm;
+    unsigned open_flags;  /* the tinyalsa flags the pcm was opened with */
 
     size_t frame_size;    /* valid after proxy_prepare(), the frame size in bytes */
     uint64_t transferred; /* the total frames transferred, not cleared on standby */
+
+    unsigned int mmap_offset; /* frame offset of the region returned by the last
+                               * proxy_mmap_begin(), consumed by proxy_mmap_commit() */
+
+    void * gather_buffer; /* staging buffer for proxy_writev() on non-mmap
+                           * streams, lazily sized to the largest writev */
+    size_t gather_size;
 } alsa_device_proxy;
 
 
@@ -37,7 +47,24 @@ typedef struct {
 int proxy_prepare(alsa_device_proxy * proxy, const alsa_device_profile * profile,
                    struct pcm_config * config);
 int proxy_open(alsa_device_proxy * proxy);
+/* as proxy_open(), but the device is opened for mmap I/O
+ * (proxy_mmap_begin/commit) instead of proxy_write/proxy_read */
+int proxy_open_mmap(alsa_device_proxy * proxy);
 void proxy_close(alsa_device_proxy * proxy);
+/*
+ * Renegotiates the period geometry at runtime, e.g. to switch between a
+ * low-latency and a power-efficient configuration without tearing the
+ * stream down.  The size is rounded to a multiple of 16 and clamped to the
+ * profile's period limits; 0 keeps the current value.  The kernel cannot
+ * change hw_params on an open stream, so the new configuration is staged
+ * completely and then applied with a single close/reopen (the gather
+ * buffer and the transferred count survive, as across standby); if the
+ * device rejects the new geometry the previous one is restored.  On a
+ * proxy that is not open the hint simply takes effect at the next
+ * proxy_open().  Returns 0 on success.
+ */
+int proxy_set_period_hint(alsa_device_proxy * proxy, unsigned int period_size,
+        unsigned int period_count);
 int proxy_get_presentation_position(const alsa_device_proxy * proxy,
         uint64_t *frames, struct timespec *timestamp);
 int proxy_get_capture_position(const alsa_device_proxy * proxy,
@@ -62,6 +89,29 @@ int proxy_scan_rates(alsa_device_proxy * proxy, const unsigned sample_rates[]);
 int proxy_write(alsa_device_proxy * proxy, const void *data, unsigned int count);
 int proxy_read(alsa_device_proxy * proxy, void *data, unsigned int count);
 
+/*
+ * As proxy_write(), but the period is gathered from iov_count fragments so
+ * callers assembling a period from several sources (e.g. mix output plus
+ * encoded framing) need no contiguous assembly buffer.  The total byte
+ * count must be a whole number of frames; fragments need not be.  On a
+ * proxy opened with proxy_open_mmap() the fragments are copied straight
+ * into the ALSA ring buffer, otherwise they are gathered into an internal
+ * staging buffer and written as one proxy_write().
+ */
+int proxy_writev(alsa_device_proxy * proxy, const struct iovec *iov, int iov_count);
+
+/*
+ * Zero-copy I/O on a proxy opened with proxy_open_mmap(): proxy_mmap_begin()
+ * returns a pointer into the ALSA ring buffer and the number of contiguous
+ * frames that may be transferred there; the caller renders (or captures) in
+ * place and then commits the frames actually used with proxy_mmap_commit(),
+ * which replaces the period-sized memcpy of proxy_write/proxy_read.
+ * When no frames are available, wait with proxy_mmap_wait() before retrying.
+ */
+int proxy_mmap_begin(alsa_device_proxy * proxy, void **buffer, unsigned int *frames);
+int proxy_mmap_commit(alsa_device_proxy * proxy, unsigned int frames);
+int proxy_mmap_wait(alsa_device_proxy * proxy, int timeout_ms);
+
 /* Debugging */
 void proxy_dump(const alsa_device_proxy * proxy, int fd);
 
@@ -23,4 +23,18 @@
 
 enum pcm_format get_pcm_format_for_mask(const struct pcm_mask* mask);
 
+/*
+ * Returns the audio HAL format corresponding to a tinyalsa format,
+ * or AUDIO_FORMAT_INVALID if there is none.
+ * Table-driven; both directions are generated from one mapping list and
+ * statically checked for completeness against the enums.
+ */
+audio_format_t audio_format_from_pcm_format(enum pcm_format format);
+
+/*
+ * Returns the tinyalsa format corresponding to a linear PCM audio HAL format,
+ * or PCM_FORMAT_INVALID if there is none (e.g. AUDIO_FORMAT_PCM_FLOAT).
+ */
+enum pcm_format pcm_format_from_audio_format(audio_format_t format);
+
 #endif /* ANDROID_SYSTEM_MEDIA_ALSA_UTILS_ALSA_FORMAT_H */
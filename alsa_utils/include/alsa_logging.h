@@ -17,10 +17,37 @@
 #ifndef ANDROID_SYSTEM_MEDIA_ALSA_UTILS_ALSA_LOGGING_H
 #define ANDROID_SYSTEM_MEDIA_ALSA_UTILS_ALSA_LOGGING_H
 
+#include <stdint.h>
+
 #include <tinyalsa/asoundlib.h>
 
 void log_pcm_mask(const char* mask_name, const struct pcm_mask* mask);
 void log_pcm_params(struct pcm_params * alsa_hw_params);
 void log_pcm_config(struct pcm_config * config, const char* label);
 
+/*
+ * Binary ALSA event tracing.
+ *
+ * alsa_trace_record() appends a fixed-size record (monotonic timestamp,
+ * event, stream id, two event arguments) to a preallocated lock-free ring;
+ * no string formatting happens on the caller's thread.  A drain thread
+ * started by alsa_trace_start() periodically formats the records to the
+ * log, so tracing can stay enabled on latency-sensitive streams.  While
+ * tracing is stopped alsa_trace_record() is a single flag test.
+ *
+ * If producers outrun the drain thread the oldest records are dropped and
+ * the drop count is reported in the log.
+ */
+enum alsa_trace_event {
+    ALSA_TRACE_EVENT_OPEN,
+    ALSA_TRACE_EVENT_CLOSE,
+    ALSA_TRACE_EVENT_READ,
+    ALSA_TRACE_EVENT_WRITE,
+    ALSA_TRACE_EVENT_XRUN,
+};
+
+int alsa_trace_start(void);
+void alsa_trace_stop(void);
+void alsa_trace_record(enum alsa_trace_event event, int id, int64_t arg0, int64_t arg1);
+
 #endif /* ANDROID_SYSTEM_MEDIA_ALSA_UTILS_ALSA_LOGGING_H */
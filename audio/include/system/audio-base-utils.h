@@ -341,6 +341,214 @@ static const uint32_t AUDIO_ENCAPSULATION_METADATA_TYPE_ALL_POSITION_BITS =
 static const uint32_t AUDIO_ENCAPSULATION_TYPE_CNT = AUDIO_ARRAY_SIZE(
                                                      AUDIO_ENCAPSULATION_TYPE_ALL_ARRAY);
 
+// Every named format accepted by audio_is_valid_format() in audio.h, in
+// order from low to high for binary search (see audio_valid_format_index
+// below).  Config negotiation can represent a format capability set as a
+// bitset over the indices of this array and intersect candidate sets word by
+// word, instead of calling audio_is_valid_format() per candidate.
+// Note that for main formats without subformat structure (e.g. MP3),
+// audio_is_valid_format() accepts any subformat value; only the named
+// formats with a zero subformat appear here for those mains.
+// inline constexpr
+static CONST_ARRAY audio_format_t AUDIO_FORMAT_ALL_VALID_ARRAY[] = {
+    AUDIO_FORMAT_PCM_16_BIT,          // 0x00000001u
+    AUDIO_FORMAT_PCM_8_BIT,           // 0x00000002u
+    AUDIO_FORMAT_PCM_32_BIT,          // 0x00000003u
+    AUDIO_FORMAT_PCM_8_24_BIT,        // 0x00000004u
+    AUDIO_FORMAT_PCM_FLOAT,           // 0x00000005u
+    AUDIO_FORMAT_PCM_24_BIT_PACKED,   // 0x00000006u
+    AUDIO_FORMAT_MP3,                 // 0x01000000u
+    AUDIO_FORMAT_AMR_NB,              // 0x02000000u
+    AUDIO_FORMAT_AMR_WB,              // 0x03000000u
+    AUDIO_FORMAT_AAC,                 // 0x04000000u
+    AUDIO_FORMAT_AAC_MAIN,            // 0x04000001u
+    AUDIO_FORMAT_AAC_LC,              // 0x04000002u
+    AUDIO_FORMAT_AAC_SSR,             // 0x04000004u
+    AUDIO_FORMAT_AAC_LTP,             // 0x04000008u
+    AUDIO_FORMAT_AAC_HE_V1,           // 0x04000010u
+    AUDIO_FORMAT_AAC_SCALABLE,        // 0x04000020u
+    AUDIO_FORMAT_AAC_ERLC,            // 0x04000040u
+    AUDIO_FORMAT_AAC_LD,              // 0x04000080u
+    AUDIO_FORMAT_AAC_HE_V2,           // 0x04000100u
+    AUDIO_FORMAT_AAC_ELD,             // 0x04000200u
+    AUDIO_FORMAT_AAC_XHE,             // 0x04000300u
+    AUDIO_FORMAT_HE_AAC_V1,           // 0x05000000u
+    AUDIO_FORMAT_HE_AAC_V2,           // 0x06000000u
+    AUDIO_FORMAT_VORBIS,              // 0x07000000u
+    AUDIO_FORMAT_OPUS,                // 0x08000000u
+    AUDIO_FORMAT_AC3,                 // 0x09000000u
+    AUDIO_FORMAT_E_AC3,               // 0x0A000000u
+    AUDIO_FORMAT_E_AC3_JOC,           // 0x0A000001u
+    AUDIO_FORMAT_DTS,                 // 0x0B000000u
+    AUDIO_FORMAT_DTS_HD,              // 0x0C000000u
+    AUDIO_FORMAT_IEC61937,            // 0x0D000000u
+    AUDIO_FORMAT_DOLBY_TRUEHD,        // 0x0E000000u
+    AUDIO_FORMAT_EVRC,                // 0x10000000u
+    AUDIO_FORMAT_EVRCB,               // 0x11000000u
+    AUDIO_FORMAT_EVRCWB,              // 0x12000000u
+    AUDIO_FORMAT_EVRCNW,              // 0x13000000u
+    AUDIO_FORMAT_AAC_ADIF,            // 0x14000000u
+    AUDIO_FORMAT_WMA,                 // 0x15000000u
+    AUDIO_FORMAT_WMA_PRO,             // 0x16000000u
+    AUDIO_FORMAT_AMR_WB_PLUS,         // 0x17000000u
+    AUDIO_FORMAT_MP2,                 // 0x18000000u
+    AUDIO_FORMAT_QCELP,               // 0x19000000u
+    AUDIO_FORMAT_DSD,                 // 0x1A000000u
+    AUDIO_FORMAT_FLAC,                // 0x1B000000u
+    AUDIO_FORMAT_ALAC,                // 0x1C000000u
+    AUDIO_FORMAT_APE,                 // 0x1D000000u
+    AUDIO_FORMAT_AAC_ADTS,            // 0x1E000000u
+    AUDIO_FORMAT_AAC_ADTS_MAIN,       // 0x1E000001u
+    AUDIO_FORMAT_AAC_ADTS_LC,         // 0x1E000002u
+    AUDIO_FORMAT_AAC_ADTS_SSR,        // 0x1E000004u
+    AUDIO_FORMAT_AAC_ADTS_LTP,        // 0x1E000008u
+    AUDIO_FORMAT_AAC_ADTS_HE_V1,      // 0x1E000010u
+    AUDIO_FORMAT_AAC_ADTS_SCALABLE,   // 0x1E000020u
+    AUDIO_FORMAT_AAC_ADTS_ERLC,       // 0x1E000040u
+    AUDIO_FORMAT_AAC_ADTS_LD,         // 0x1E000080u
+    AUDIO_FORMAT_AAC_ADTS_HE_V2,      // 0x1E000100u
+    AUDIO_FORMAT_AAC_ADTS_ELD,        // 0x1E000200u
+    AUDIO_FORMAT_AAC_ADTS_XHE,        // 0x1E000300u
+    AUDIO_FORMAT_SBC,                 // 0x1F000000u
+    AUDIO_FORMAT_APTX,                // 0x20000000u
+    AUDIO_FORMAT_APTX_HD,             // 0x21000000u
+    AUDIO_FORMAT_AC4,                 // 0x22000000u
+    AUDIO_FORMAT_LDAC,                // 0x23000000u
+    AUDIO_FORMAT_MAT,                 // 0x24000000u
+    AUDIO_FORMAT_MAT_1_0,             // 0x24000001u
+    AUDIO_FORMAT_MAT_2_0,             // 0x24000002u
+    AUDIO_FORMAT_MAT_2_1,             // 0x24000003u
+    AUDIO_FORMAT_AAC_LATM,            // 0x25000000u
+    AUDIO_FORMAT_AAC_LATM_LC,         // 0x25000002u
+    AUDIO_FORMAT_AAC_LATM_HE_V1,      // 0x25000010u
+    AUDIO_FORMAT_AAC_LATM_HE_V2,      // 0x25000100u
+    AUDIO_FORMAT_CELT,                // 0x26000000u
+    AUDIO_FORMAT_APTX_ADAPTIVE,       // 0x27000000u
+    AUDIO_FORMAT_LHDC,                // 0x28000000u
+    AUDIO_FORMAT_LHDC_LL,             // 0x29000000u
+    AUDIO_FORMAT_APTX_TWSP,           // 0x2A000000u
+    AUDIO_FORMAT_LC3,                 // 0x2B000000u
+    AUDIO_FORMAT_MPEGH_BL_L3,         // 0x2C000013u
+    AUDIO_FORMAT_MPEGH_BL_L4,         // 0x2C000014u
+    AUDIO_FORMAT_MPEGH_LC_L3,         // 0x2C000023u
+    AUDIO_FORMAT_MPEGH_LC_L4,         // 0x2C000024u
+    AUDIO_FORMAT_IEC60958,            // 0x2D000000u
+    AUDIO_FORMAT_DTS_UHD,             // 0x2E000000u
+    AUDIO_FORMAT_DRA,                 // 0x2F000000u
+};
+
+static const uint32_t AUDIO_FORMAT_VALID_CNT = AUDIO_ARRAY_SIZE(AUDIO_FORMAT_ALL_VALID_ARRAY);
+
+// Bitmap over the main format byte (format >> 24): the bit for a main format
+// is set if any format with that main format is valid.  One word test
+// rejects a candidate before any per-subformat work.  Verified against
+// AUDIO_FORMAT_ALL_VALID_ARRAY by the static checks below.
+static CONST_ARRAY uint32_t AUDIO_FORMAT_MAIN_VALID_POSITION_BITS[8] = {
+    0xFFFF7FFFu,    // mains 0x00-0x1F; 0x0F is unassigned
+    0x0000FFFFu,    // mains 0x20-0x2F
+    0, 0, 0, 0, 0, 0,
+};
+
+// Position bits of the main formats whose subformat values are restricted
+// to an enumerated set; all other valid main formats accept any subformat
+// value in audio_is_valid_format().  All such mains are below 64.
+static const uint64_t AUDIO_FORMAT_SUB_RESTRICTED_MAIN_BITS =
+        (1ULL << ((uint32_t)AUDIO_FORMAT_PCM_MAIN >> 24)) |
+        (1ULL << ((uint32_t)AUDIO_FORMAT_AAC >> 24)) |
+        (1ULL << ((uint32_t)AUDIO_FORMAT_E_AC3 >> 24)) |
+        (1ULL << ((uint32_t)AUDIO_FORMAT_AAC_ADTS >> 24)) |
+        (1ULL << ((uint32_t)AUDIO_FORMAT_MAT >> 24)) |
+        (1ULL << ((uint32_t)AUDIO_FORMAT_AAC_LATM >> 24)) |
+        (1ULL << ((uint32_t)AUDIO_FORMAT_MPEGH >> 24));
+
+// Valid PCM subformats as position bits, in the style of the encapsulation
+// position bits above.  All PCM subformat values are < 32.
+static const uint32_t AUDIO_FORMAT_PCM_SUB_VALID_POSITION_BITS =
+        (1u << AUDIO_FORMAT_PCM_SUB_16_BIT) |
+        (1u << AUDIO_FORMAT_PCM_SUB_8_BIT) |
+        (1u << AUDIO_FORMAT_PCM_SUB_32_BIT) |
+        (1u << AUDIO_FORMAT_PCM_SUB_8_24_BIT) |
+        (1u << AUDIO_FORMAT_PCM_SUB_FLOAT) |
+        (1u << AUDIO_FORMAT_PCM_SUB_24_BIT_PACKED);
+
+// The discrete sample rates used in stream configurations, in order from low
+// to high for binary search (see audio_sample_rate_index below).  A rate
+// capability set fits the position bits of one word.
+// inline constexpr
+static CONST_ARRAY uint32_t AUDIO_SAMPLE_RATE_ALL_ARRAY[] = {
+    8000, 11025, 12000, 16000, 22050, 24000, 32000, 44100, 48000,
+    64000, 88200, 96000, 128000, 176400, 192000, 352800, 384000,
+};
+
+static const uint32_t AUDIO_SAMPLE_RATE_CNT = AUDIO_ARRAY_SIZE(AUDIO_SAMPLE_RATE_ALL_ARRAY);
+
+// Returns the index of format in AUDIO_FORMAT_ALL_VALID_ARRAY, or -1 if the
+// format is not valid.  Use the index to build format capability bitsets.
+static inline int audio_valid_format_index(audio_format_t format)
+{
+    const uint32_t value = (uint32_t)format;
+    int low = 0;
+    int high = (int)AUDIO_FORMAT_VALID_CNT - 1;
+    while (low <= high) {
+        const int mid = (low + high) / 2;
+        const uint32_t entry = (uint32_t)AUDIO_FORMAT_ALL_VALID_ARRAY[mid];
+        if (entry < value) {
+            low = mid + 1;
+        } else if (entry > value) {
+            high = mid - 1;
+        } else {
+            return mid;
+        }
+    }
+    return -1;
+}
+
+// Equivalent to audio_is_valid_format() in audio.h, but driven by the tables
+// above: one bitmap word test rejects candidates with an invalid main
+// format, a second settles the mains that accept any subformat, and only
+// the sub restricted mains resolve through the sorted array.
+static inline bool audio_is_valid_format_fast(audio_format_t format)
+{
+    const uint32_t main_index = (uint32_t)format >> 24;
+    if ((AUDIO_FORMAT_MAIN_VALID_POSITION_BITS[main_index >> 5]
+            & (1u << (main_index & 31))) == 0) {
+        return false;
+    }
+    // valid mains are all below 64, so the shift is in range.
+    if (((AUDIO_FORMAT_SUB_RESTRICTED_MAIN_BITS >> main_index) & 1) == 0) {
+        return true;
+    }
+    return audio_valid_format_index(format) >= 0;
+}
+
+// Returns the index of rate in AUDIO_SAMPLE_RATE_ALL_ARRAY, or -1 if the
+// rate is not one of the discrete configuration rates.
+static inline int audio_sample_rate_index(uint32_t rate)
+{
+    int low = 0;
+    int high = (int)AUDIO_SAMPLE_RATE_CNT - 1;
+    while (low <= high) {
+        const int mid = (low + high) / 2;
+        const uint32_t entry = AUDIO_SAMPLE_RATE_ALL_ARRAY[mid];
+        if (entry < rate) {
+            low = mid + 1;
+        } else if (entry > rate) {
+            high = mid - 1;
+        } else {
+            return mid;
+        }
+    }
+    return -1;
+}
+
+// Returns the position bit of rate for a one word rate capability set, or 0
+// if the rate is not one of the discrete configuration rates.
+static inline uint32_t audio_sample_rate_position_bits(uint32_t rate)
+{
+    const int index = audio_sample_rate_index(rate);
+    return index >= 0 ? 1u << index : 0;
+}
+
 #if AUDIO_ARRAYS_STATIC_CHECK
 
 template<typename T, size_t N>
@@ -392,6 +600,32 @@ static_assert(AUDIO_DEVICE_IN_DIGITAL_CNT == std::size(AUDIO_DEVICE_IN_ALL_DIGIT
 static_assert(AUDIO_DEVICE_IN_BLE_CNT == std::size(AUDIO_DEVICE_IN_ALL_BLE_ARRAY));
 static_assert(AUDIO_ENCAPSULATION_TYPE_CNT == std::size(AUDIO_ENCAPSULATION_TYPE_ALL_ARRAY));
 
+static_assert(isSorted(AUDIO_FORMAT_ALL_VALID_ARRAY),
+              "AUDIO_FORMAT_ALL_VALID_ARRAY must be sorted");
+static_assert(isSorted(AUDIO_SAMPLE_RATE_ALL_ARRAY),
+              "AUDIO_SAMPLE_RATE_ALL_ARRAY must be sorted");
+static_assert(AUDIO_FORMAT_VALID_CNT == std::size(AUDIO_FORMAT_ALL_VALID_ARRAY));
+static_assert(AUDIO_SAMPLE_RATE_CNT == std::size(AUDIO_SAMPLE_RATE_ALL_ARRAY));
+static_assert(AUDIO_SAMPLE_RATE_CNT <= 32,
+              "rate capability sets must fit the position bits of one word");
+
+constexpr bool mainFormatBitmapMatchesValidArray() {
+    uint32_t bits[std::size(AUDIO_FORMAT_MAIN_VALID_POSITION_BITS)] = {};
+    for (const audio_format_t format : AUDIO_FORMAT_ALL_VALID_ARRAY) {
+        const uint32_t main_index = (uint32_t)format >> 24;
+        bits[main_index >> 5] |= 1u << (main_index & 31);
+    }
+    for (size_t i = 0; i < std::size(bits); ++i) {
+        if (bits[i] != AUDIO_FORMAT_MAIN_VALID_POSITION_BITS[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(mainFormatBitmapMatchesValidArray(),
+              "AUDIO_FORMAT_MAIN_VALID_POSITION_BITS must match AUDIO_FORMAT_ALL_VALID_ARRAY");
+
 #if __has_builtin(__builtin_popcount)
 // Replace with constexpr std::popcount with C++20
 
@@ -1942,30 +1942,36 @@ static inline bool audio_has_proportional_frames(audio_format_t format)
 
 static inline size_t audio_bytes_per_sample(audio_format_t format)
 {
-    size_t size = 0;
-
-    switch (format) {
-    case AUDIO_FORMAT_PCM_32_BIT:
-    case AUDIO_FORMAT_PCM_8_24_BIT:
-        size = sizeof(int32_t);
-        break;
-    case AUDIO_FORMAT_PCM_24_BIT_PACKED:
-        size = sizeof(uint8_t) * 3;
-        break;
-    case AUDIO_FORMAT_PCM_16_BIT:
-    case AUDIO_FORMAT_IEC61937:
-        size = sizeof(int16_t);
-        break;
-    case AUDIO_FORMAT_PCM_8_BIT:
-        size = sizeof(uint8_t);
-        break;
-    case AUDIO_FORMAT_PCM_FLOAT:
-        size = sizeof(float);
-        break;
-    default:
-        break;
+    /* Bytes per sample indexed by the PCM sub-format, which audio-hal-enums.h
+     * defines as small consecutive values, so the common PCM path is a single
+     * table load instead of a branch tree. */
+    static const uint8_t pcm_bytes_per_sample[] = {
+        0,                   /* AUDIO_FORMAT_PCM_MAIN (AUDIO_FORMAT_DEFAULT) */
+        sizeof(int16_t),     /* AUDIO_FORMAT_PCM_SUB_16_BIT */
+        sizeof(uint8_t),     /* AUDIO_FORMAT_PCM_SUB_8_BIT */
+        sizeof(int32_t),     /* AUDIO_FORMAT_PCM_SUB_32_BIT */
+        sizeof(int32_t),     /* AUDIO_FORMAT_PCM_SUB_8_24_BIT */
+        sizeof(float),       /* AUDIO_FORMAT_PCM_SUB_FLOAT */
+        sizeof(uint8_t) * 3, /* AUDIO_FORMAT_PCM_SUB_24_BIT_PACKED */
+    };
+#ifdef __cplusplus
+    static_assert(
+#else
+    _Static_assert(
+#endif
+            AUDIO_FORMAT_PCM_SUB_16_BIT == 1 &&
+            AUDIO_FORMAT_PCM_SUB_8_BIT == 2 &&
+            AUDIO_FORMAT_PCM_SUB_32_BIT == 3 &&
+            AUDIO_FORMAT_PCM_SUB_8_24_BIT == 4 &&
+            AUDIO_FORMAT_PCM_SUB_FLOAT == 5 &&
+            AUDIO_FORMAT_PCM_SUB_24_BIT_PACKED == 6,
+            "pcm_bytes_per_sample must match the sub-formats in audio-hal-enums.h");
+
+    if (audio_is_linear_pcm(format)) {
+        const uint32_t sub = format & AUDIO_FORMAT_SUB_MASK;
+        return sub < sizeof(pcm_bytes_per_sample) ? pcm_bytes_per_sample[sub] : 0;
     }
-    return size;
+    return format == AUDIO_FORMAT_IEC61937 ? sizeof(int16_t) : 0;
 }
 
 static inline size_t audio_bytes_per_frame(uint32_t channel_count, audio_format_t format)
@@ -31,9 +31,36 @@ const effect_uuid_t * const EFFECT_UIID_DOWNMIX = &EFFECT_UIID_DOWNMIX_;
 
 /* enumerated parameter settings for downmix effect */
 typedef enum {
-    DOWNMIX_PARAM_TYPE
+    DOWNMIX_PARAM_TYPE,
+    // Read only.  Bit mask of downmix_process_capability_t values as a
+    // uint32_t, describing which buffer arrangements process() supports.
+    // Implementations predating this parameter reject the command, which
+    // hosts must treat as no capabilities: separate in and out buffers,
+    // EFFECT_BUFFER_ACCESS_WRITE only.
+    DOWNMIX_PARAM_PROCESS_CAPABILITIES,
 } downmix_params_t;
 
+/*
+ * Buffer arrangement capabilities of a downmix implementation.
+ *
+ * Without these, every downmix instance in an effect chain needs its own
+ * scratch output buffer, and mixing the result into the chain output costs
+ * one more pass over the data.  A host that finds the capability below may
+ * drop the scratch buffer or the add pass; one that does not must keep the
+ * conservative arrangement.
+ */
+typedef enum {
+    // process() accepts inBuffer.raw == outBuffer.raw.  A downmix never
+    // produces more channels than it consumes, so frames can be rewritten
+    // front to back within the same allocation; the output is then packed
+    // at the buffer start.  Partial overlap is not supported.
+    DOWNMIX_PROCESS_CAPABILITY_IN_PLACE   = 0x1,
+    // process() honors EFFECT_BUFFER_ACCESS_ACCUMULATE as the output buffer
+    // accessMode, adding the downmixed frames into outBuffer instead of
+    // replacing it.
+    DOWNMIX_PROCESS_CAPABILITY_ACCUMULATE = 0x2,
+} downmix_process_capability_t;
+
 
 typedef enum {
     DOWNMIX_TYPE_INVALID                 = -1,
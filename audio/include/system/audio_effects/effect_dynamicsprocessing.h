@@ -42,6 +42,13 @@ typedef enum
     DP_PARAM_POST_EQ = 0x60,
     DP_PARAM_POST_EQ_BAND = 0x65,
     DP_PARAM_LIMITER = 0x70,
+    // Availability of the shared memory MBC configuration channel, as a
+    // uint32_t read as a boolean.  When the implementation reports 1, the
+    // host may share a dp_config_memory_t with it (the memory itself
+    // travels out of band, e.g. as an AIDL SharedMemory) and then
+    // reconfigures the multi-band compressor with one generation flip
+    // instead of a DP_PARAM_MBC_BAND command per channel and band.
+    DP_PARAM_CONFIG_MEMORY_SUPPORTED = 0x80,
 } t_dynamicsprocessing_params;
 
 /* enumerated variants */
@@ -51,6 +58,134 @@ typedef enum
     VARIANT_FAVOR_TIME_RESOLUTION = 0x01,
 } t_dynamicsprocessing_variants;
 
+/*
+ * Shared memory MBC configuration channel.
+ *
+ * Reconfiguring the multi-band compressor through DP_PARAM_MBC_BAND takes
+ * one effect command per channel per band - hundreds of sequential round
+ * trips for a full setup - during which the engine runs on a half-updated
+ * configuration.  A dp_config_memory_t is instead mapped by both sides:
+ * the host fills the bank the engine is not reading and then publishes it
+ * with a single generation increment, so the engine switches between two
+ * complete configurations and never observes a partial one.
+ *
+ * The low bit of the generation selects the active bank, so consecutive
+ * writes alternate banks automatically.  Readers validate the generation
+ * after copying and retry on a concurrent flip; at live-tuning write rates
+ * a retry is all but unobservable.  There is exactly one writer; the magic
+ * and version fields are written once before the memory is shared.
+ */
+
+#define DP_CONFIG_MEMORY_MAGIC   0x66637064u /* 'dpcf' (little endian) */
+#define DP_CONFIG_MEMORY_VERSION 1u
+
+// Capacity of one configuration bank; an instance uses the leading
+// channel_count x band_count entries of each bank.
+#define DP_CONFIG_MEMORY_MAX_CHANNELS 32
+#define DP_CONFIG_MEMORY_MAX_BANDS    16
+
+/* Retries in dp_config_memory_read before reporting failure;
+ * the previous configuration remains in use when that happens. */
+#define DP_CONFIG_MEMORY_MAX_READ_RETRIES 3
+
+// One MBC band, the same values DP_PARAM_MBC_BAND carries.
+typedef struct dp_mbc_band_config {
+    uint32_t enabled;              // 0 or 1
+    float cutoff_frequency_hz;
+    float attack_time_ms;
+    float release_time_ms;
+    float ratio;
+    float threshold_db;
+    float knee_width_db;
+    float noise_gate_threshold_db;
+    float expander_ratio;
+    float pre_gain_db;
+    float post_gain_db;
+} dp_mbc_band_config_t;
+
+typedef struct dp_config_memory {
+    uint32_t magic;          // DP_CONFIG_MEMORY_MAGIC, written once before sharing
+    uint32_t version;        // DP_CONFIG_MEMORY_VERSION, written once before sharing
+    uint32_t generation;     // incremented per publication; low bit selects the bank
+    uint32_t channel_count;  // channels configured in the active bank
+    uint32_t band_count;     // bands per channel in the active bank
+    uint32_t reserved[3];    // must be zero
+    // Two complete configurations, indexed [bank][channel][band];
+    // bank (generation & 1) is the active one.
+    dp_mbc_band_config_t banks[2][DP_CONFIG_MEMORY_MAX_CHANNELS][DP_CONFIG_MEMORY_MAX_BANDS];
+} dp_config_memory_t;
+
+/* Initializes a zeroed configuration channel; call once before sharing the memory. */
+static inline void dp_config_memory_init(dp_config_memory_t *mem) {
+    memset(mem, 0, sizeof(*mem));
+    mem->version = DP_CONFIG_MEMORY_VERSION;
+    __atomic_store_n(&mem->magic, DP_CONFIG_MEMORY_MAGIC, __ATOMIC_RELEASE);
+}
+
+/* Returns true if mem holds a configuration channel of a layout this header understands. */
+static inline bool dp_config_memory_valid(const dp_config_memory_t *mem) {
+    return __atomic_load_n(&mem->magic, __ATOMIC_ACQUIRE) == DP_CONFIG_MEMORY_MAGIC
+            && mem->version == DP_CONFIG_MEMORY_VERSION;
+}
+
+/* Returns the current generation, for readers polling for a new configuration. */
+static inline uint32_t dp_config_memory_generation(const dp_config_memory_t *mem) {
+    return __atomic_load_n(&mem->generation, __ATOMIC_ACQUIRE);
+}
+
+/* Publishes a full MBC configuration of channel_count x band_count entries,
+ * laid out [channel][band].  Wait-free; must only be called from the single
+ * writer.  Returns false if the dimensions exceed the bank capacity. */
+static inline bool dp_config_memory_write(dp_config_memory_t *mem,
+        const dp_mbc_band_config_t *bands, uint32_t channel_count, uint32_t band_count) {
+    if (channel_count > DP_CONFIG_MEMORY_MAX_CHANNELS
+            || band_count > DP_CONFIG_MEMORY_MAX_BANDS) {
+        return false;
+    }
+    const uint32_t generation = __atomic_load_n(&mem->generation, __ATOMIC_RELAXED);
+    dp_mbc_band_config_t (*bank)[DP_CONFIG_MEMORY_MAX_BANDS] =
+            mem->banks[(generation + 1) & 1];  // the bank readers are not using
+    for (uint32_t ch = 0; ch < channel_count; ++ch) {
+        memcpy(bank[ch], &bands[ch * band_count], band_count * sizeof(*bands));
+    }
+    mem->channel_count = channel_count;
+    mem->band_count = band_count;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&mem->generation, generation + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/* Copies the active configuration into bands (laid out [channel][band],
+ * sized for at least DP_CONFIG_MEMORY_MAX_CHANNELS x DP_CONFIG_MEMORY_MAX_BANDS
+ * entries).  Returns false if the channel is invalid or a consistent snapshot
+ * could not be taken within DP_CONFIG_MEMORY_MAX_READ_RETRIES; the caller
+ * keeps its last configuration. */
+static inline bool dp_config_memory_read(const dp_config_memory_t *mem,
+        dp_mbc_band_config_t *bands, uint32_t *channel_count, uint32_t *band_count) {
+    if (!dp_config_memory_valid(mem)) return false;
+    for (int retry = 0; retry < DP_CONFIG_MEMORY_MAX_READ_RETRIES; ++retry) {
+        const uint32_t generation = __atomic_load_n(&mem->generation, __ATOMIC_ACQUIRE);
+        const dp_mbc_band_config_t (*bank)[DP_CONFIG_MEMORY_MAX_BANDS] =
+                mem->banks[generation & 1];
+        const uint32_t channels = mem->channel_count;
+        const uint32_t perChannel = mem->band_count;
+        if (channels > DP_CONFIG_MEMORY_MAX_CHANNELS
+                || perChannel > DP_CONFIG_MEMORY_MAX_BANDS) {
+            return false;  // never written by dp_config_memory_write
+        }
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            memcpy(&bands[ch * perChannel], bank[ch], perChannel * sizeof(*bands));
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&mem->generation, __ATOMIC_RELAXED) == generation) {
+            *channel_count = channels;
+            *band_count = perChannel;
+            return true;
+        }
+    }
+    return false;
+}
+
 #if __cplusplus
 } // extern "C"
 #endif
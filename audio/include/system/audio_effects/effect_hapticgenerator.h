@@ -34,8 +34,27 @@ typedef enum
 {
     HG_PARAM_HAPTIC_INTENSITY, // haptic intensity
     HG_PARAM_VIBRATOR_INFO, // vibrator information, e.g. resonant frequency, Q factor
+    // batch of timestamped haptic intensity updates:
+    //  first uint32_t is the number of updates followed by the corresponding
+    // number of hg_scale_update_t, ordered by ascending timestamp.
+    // One command carries a whole block of updates, so hosts driving the
+    // intensity per frame send one command per buffer instead of one per
+    // update, and implementations can precompute the envelope ramps for the
+    // block at once.
+    HG_PARAM_HAPTIC_SCALE_BLOCK,
 } t_hapticgenerator_params;
 
+// Maximum number of hg_scale_update_t in one HG_PARAM_HAPTIC_SCALE_BLOCK
+// command; keeps the payload within the effect command size limits.
+#define HG_SCALE_BLOCK_MAX_UPDATES 64
+
+typedef struct hg_scale_update {
+    int64_t timestamp_ns; // CLOCK_MONOTONIC time at which the update applies;
+                          // an update in the past applies immediately
+    int32_t id;           // same identifier as HG_PARAM_HAPTIC_INTENSITY
+    int32_t intensity;    // same value as HG_PARAM_HAPTIC_INTENSITY
+} hg_scale_update_t;
+
 #if __cplusplus
 }  // extern "C"
 #endif
@@ -49,6 +49,13 @@ typedef enum
     SPATIALIZER_PARAM_HINGE_ANGLE,
     // Display orientation as a float value in rad
     SPATIALIZER_PARAM_DISPLAY_ORIENTATION,
+    // Availability of the shared memory head pose channel, as a uint32_t
+    // read as a boolean.  When the implementation reports 1, the framework
+    // may share a spatializer_pose_memory_t page with it (the memory itself
+    // travels out of band, e.g. as an AIDL SharedMemory) and then publishes
+    // poses there instead of sending SPATIALIZER_PARAM_HEAD_TO_STAGE
+    // commands at head tracking rate.
+    SPATIALIZER_PARAM_HEAD_POSE_MEMORY_SUPPORTED,
 } t_virtualizer_stage_params;
 
 // See SpatializationLevel.aidl
@@ -63,6 +70,85 @@ typedef enum {
     SPATIALIZATION_MODE_TRANSAURAL = 1,
 } spatialization_mode_t;
 
+/*
+ * Shared memory head pose channel.
+ *
+ * Sending SPATIALIZER_PARAM_HEAD_TO_STAGE through effect commands costs a
+ * full command round trip per pose, which at head tracking rate (100 Hz)
+ * is measurable and adds queuing latency.  A spatializer_pose_memory_t is
+ * instead mapped by both sides: the framework overwrites the single slot
+ * with the latest pose and the implementation samples it at the start of
+ * each process() call, so the newest pose always wins and nothing queues.
+ *
+ * The slot is guarded by a sequence counter, odd while the writer is
+ * updating; readers retry on a torn snapshot.  The writer never blocks,
+ * and with one pose written per 10 ms a reader retry is all but
+ * unobservable.  There is exactly one writer; the magic and version
+ * fields are written once before the memory is shared and never change.
+ */
+
+#define SPATIALIZER_POSE_MEMORY_MAGIC   0x65736f70u /* 'pose' (little endian) */
+#define SPATIALIZER_POSE_MEMORY_VERSION 1u
+
+/* Retries in spatializer_pose_memory_read before reporting failure;
+ * the previous pose remains in use when that happens. */
+#define SPATIALIZER_POSE_MEMORY_MAX_READ_RETRIES 3
+
+typedef struct spatializer_pose_memory {
+    uint32_t magic;            // SPATIALIZER_POSE_MEMORY_MAGIC, written once before sharing
+    uint32_t version;          // SPATIALIZER_POSE_MEMORY_VERSION, written once before sharing
+    uint32_t sequence;         // incremented before and after each write, odd while writing
+    uint32_t reserved;         // must be zero
+    int64_t timestampNs;       // CLOCK_MONOTONIC time the pose was sensed
+    float headToStage[6];      // translation x, y, z then rotation vector x, y, z,
+                               // same convention as SPATIALIZER_PARAM_HEAD_TO_STAGE
+    int32_t headTrackingMode;  // see SpatializerHeadTrackingMode.aidl
+} spatializer_pose_memory_t;
+
+/* Initializes a zeroed pose channel; call once before sharing the memory. */
+static inline void spatializer_pose_memory_init(spatializer_pose_memory_t *mem) {
+    memset(mem, 0, sizeof(*mem));
+    mem->version = SPATIALIZER_POSE_MEMORY_VERSION;
+    __atomic_store_n(&mem->magic, SPATIALIZER_POSE_MEMORY_MAGIC, __ATOMIC_RELEASE);
+}
+
+/* Returns true if mem holds a pose channel of a layout this header understands. */
+static inline bool spatializer_pose_memory_valid(const spatializer_pose_memory_t *mem) {
+    return __atomic_load_n(&mem->magic, __ATOMIC_ACQUIRE) == SPATIALIZER_POSE_MEMORY_MAGIC
+            && mem->version == SPATIALIZER_POSE_MEMORY_VERSION;
+}
+
+/* Publishes a pose.  Wait-free; must only be called from the single writer. */
+static inline void spatializer_pose_memory_write(spatializer_pose_memory_t *mem,
+        const float headToStage[6], int32_t headTrackingMode, int64_t timestampNs) {
+    const uint32_t sequence = __atomic_load_n(&mem->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&mem->sequence, sequence + 1, __ATOMIC_RELAXED);  // odd: write in progress
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(mem->headToStage, headToStage, sizeof(mem->headToStage));
+    mem->headTrackingMode = headTrackingMode;
+    mem->timestampNs = timestampNs;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&mem->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+/* Reads the latest pose into the out parameters.  Returns false if the
+ * channel is invalid or a consistent snapshot could not be taken within
+ * SPATIALIZER_POSE_MEMORY_MAX_READ_RETRIES; the caller keeps its last pose. */
+static inline bool spatializer_pose_memory_read(const spatializer_pose_memory_t *mem,
+        float headToStage[6], int32_t *headTrackingMode, int64_t *timestampNs) {
+    if (!spatializer_pose_memory_valid(mem)) return false;
+    for (int retry = 0; retry < SPATIALIZER_POSE_MEMORY_MAX_READ_RETRIES; ++retry) {
+        const uint32_t sequence = __atomic_load_n(&mem->sequence, __ATOMIC_ACQUIRE);
+        if (sequence & 1) continue;  // write in progress
+        memcpy(headToStage, mem->headToStage, sizeof(mem->headToStage));
+        *headTrackingMode = mem->headTrackingMode;
+        *timestampNs = mem->timestampNs;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&mem->sequence, __ATOMIC_RELAXED) == sequence) return true;
+    }
+    return false;
+}
+
 #if __cplusplus
 }  // extern "C"
 #endif
@@ -197,6 +197,42 @@ struct sound_trigger_generic_sound_model {
     struct sound_trigger_sound_model common;
 };
 
+/*
+ * Shared memory sound model reference.
+ *
+ * sound_trigger_sound_model carries the opaque model data inline after the
+ * struct (data_offset from the struct head, data_size bytes), so every model
+ * load copies the full payload - several MB for hotword models - through each
+ * process hop on the way to the DSP.  The reference form below describes the
+ * same bytes sitting in a shared memory region (ashmem or dmabuf) instead:
+ * the loader passes the descriptor and the receiver maps the region read
+ * only, so a model swap moves no payload bytes and a recognition restart no
+ * longer waits on the copy.
+ *
+ * Versioning follows the extended properties pattern above: the version
+ * field comes first, each new version appends fields to the previous layout,
+ * and a receiver that does not implement the offered version rejects the
+ * load, upon which the caller falls back to the inline form.
+ */
+
+#define SOUND_MODEL_MEMORY_VERSION_1       1
+#define SOUND_MODEL_MEMORY_CURRENT_VERSION SOUND_MODEL_MEMORY_VERSION_1
+
+struct sound_trigger_sound_model_memory_1 {
+    uint32_t version;                       /* SOUND_MODEL_MEMORY_VERSION_1 */
+    struct sound_trigger_sound_model common; /* type, uuid and vendor_uuid as for the
+                                               inline form.  data_size is the model byte
+                                               count within the region; data_offset is
+                                               relative to the region start, not to this
+                                               struct */
+    int      data_fd;                       /* file descriptor of the region, mappable
+                                               read only.  Ownership stays with the
+                                               caller; receivers wanting to keep the
+                                               region past the call must dup() it */
+    uint32_t memory_size;                   /* total region size in bytes, at least
+                                               data_offset + data_size */
+};
+
 /*
  * Model specific parameters to be used with parameter set and get APIs
  */
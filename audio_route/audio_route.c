@@ -16,14 +16,24 @@
  */
 
 #define LOG_TAG "audio_route"
+#define ATRACE_TAG ATRACE_TAG_AUDIO
 /*#define LOG_NDEBUG 0*/
 
 #include <errno.h>
 #include <expat.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#include <cutils/trace.h>
 #include <log/log.h>
 
 #include <tinyalsa/asoundlib.h>
@@ -31,6 +41,16 @@
 #define BUF_SIZE 1024
 #define MIXER_XML_PATH "/system/etc/mixer_paths.xml"
 #define INITIAL_MIXER_PATH_SIZE 8
+#define INITIAL_APPLY_QUEUE_SIZE 8
+
+/* below this many dirty controls a parallel update is not worth a wakeup */
+#define PARALLEL_UPDATE_MIN_CTLS 8
+
+/* below this many controls the initial state snapshot is taken serially */
+#define PARALLEL_SNAPSHOT_MIN_CTLS 64
+
+/* granularity of the parse arena; large values are given their own chunk */
+#define ARENA_CHUNK_SIZE (64 * 1024)
 
 enum update_direction {
     DIRECTION_FORWARD,
@@ -66,19 +86,84 @@ struct mixer_value {
     int index;
     long value;
     /*
-     memory pointed by this is allocated in start_tag during parsing ctl of
-     MIXER_CTL_TYPE_BYTE or MIXER_CTL_TYPE_INT, and is released after the
-     parsed values are updated to either setting value within a path,
-     or top level initial setting value
+     memory pointed by this is the parse state scratch buffer filled in
+     start_tag during parsing ctl of MIXER_CTL_TYPE_BYTE or
+     MIXER_CTL_TYPE_INT; it is only valid until the parsed values are
+     updated to either setting value within a path, or top level initial
+     setting value
      */
     long *values;
 };
 
+/* one step of a compiled path apply program */
+struct path_step {
+    unsigned int ctl_index;
+    unsigned int num_bytes;     /* num_values * sizeof_ctl_type(type) */
+    unsigned int value_offset;  /* into the program value blob */
+};
+
 struct mixer_path {
     char *name;
     unsigned int size;
     unsigned int length;
     struct mixer_setting *setting;
+
+    /* flat apply program: the settings flattened into one allocation
+       (step table followed by the value blob) so applying a path walks a
+       contiguous array instead of chasing per-setting value pointers.
+       Compiled after parsing, dropped whenever a setting changes. */
+    struct path_step *steps;
+    unsigned int num_steps;
+    uint8_t *values;
+
+    /* ar->route_generation observed right after this path was last applied
+       and updated, 0 = never; see audio_route_apply_and_update_path() */
+    uint64_t applied_generation;
+};
+
+/* worker thread for audio_route_update_mixer_parallel(), started lazily */
+struct update_worker {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    unsigned int begin;         /* dirty_list range assigned to the worker */
+    unsigned int end;
+    bool busy;
+    bool exit;
+    bool started;
+};
+
+/* one queued transition for the async applier thread */
+struct pending_transition {
+    struct mixer_path *path;
+    int direction;              /* enum update_direction */
+};
+
+/* applier thread for audio_route_*_path_async(), started lazily.  Callers
+   enqueue transitions and return; the applier performs the kernel control
+   writes.  An enqueued transition that exactly undoes the newest still
+   queued one is cancelled against it before either touches the kernel, so
+   fast route flapping settles to the final state with no intermediate
+   codec writes. */
+struct apply_queue {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t done;        /* signalled when the applier goes idle */
+    struct pending_transition *items;
+    unsigned int size;          /* allocated entries */
+    unsigned int count;         /* queued entries */
+    bool busy;                  /* a popped transition is being applied */
+    bool exit;
+    bool started;
+};
+
+/* a chunk of the parse arena; the usable bytes follow the header */
+struct arena_chunk {
+    struct arena_chunk *next;
+    size_t used;
+    size_t size;
 };
 
 struct audio_route {
@@ -86,15 +171,52 @@ struct audio_route {
     unsigned int num_mixer_ctls;
     struct mixer_state *mixer_state;
 
+    /* bump allocator holding the path names and setting values.  The path
+       tables are built once at init and only freed all at once, so the
+       thousands of small strings and value buffers a large XML produces
+       are packed into a few chunks instead of individual heap blocks. */
+    struct arena_chunk *arena;
+
+    struct update_worker worker;
+    struct apply_queue apply_queue;
+
+    /* controls whose new_value may differ from old_value, so
+       audio_route_update_mixer() does not scan every control */
+    uint32_t *dirty_bitmap;
+    unsigned int *dirty_list;
+    unsigned int num_dirty_ctls;
+
     unsigned int mixer_path_size;
     unsigned int num_mixer_paths;
     struct mixer_path *mixer_path;
+
+    /* bumped by every operation that mutates the mixer state, so a path
+       whose applied_generation still matches is known to be a no-op */
+    uint64_t route_generation;
+};
+
+/* a top level <ctl> assignment, recorded during parsing for the path cache */
+struct initial_value {
+    unsigned int ctl_index;
+    int index;              /* -1 applies to all values */
+    unsigned int num_values;
+    long *values;
 };
 
 struct config_parse_state {
     struct audio_route *ar;
     struct mixer_path *path;
     int level;
+
+    struct initial_value *init_values;
+    unsigned int num_init_values;
+    unsigned int init_values_size;
+    bool cache_disabled;
+
+    /* scratch for multi-value <ctl> tags, grown on demand and reused
+       across tags instead of allocated and freed per tag */
+    long *value_scratch;
+    unsigned int value_scratch_size;
 };
 
 /* path functions */
@@ -137,6 +259,63 @@ static inline struct mixer_ctl *index_to_ctl(struct audio_route *ar,
     return ar->mixer_state[ctl_index].ctl;
 }
 
+/* records that new_value was written, deduplicated by the bitmap */
+static void mark_ctl_dirty(struct audio_route *ar, unsigned int ctl_index)
+{
+    if (ar->dirty_bitmap[ctl_index >> 5] & (1u << (ctl_index & 31)))
+        return;
+    ar->dirty_bitmap[ctl_index >> 5] |= 1u << (ctl_index & 31);
+    ar->dirty_list[ar->num_dirty_ctls++] = ctl_index;
+}
+
+/* parse arena */
+
+static void *arena_alloc(struct audio_route *ar, size_t size)
+{
+    struct arena_chunk *chunk = ar->arena;
+
+    size = (size + 7) & ~(size_t)7;
+    if (chunk == NULL || chunk->size - chunk->used < size) {
+        const size_t data_size = size > ARENA_CHUNK_SIZE ?
+                size : ARENA_CHUNK_SIZE;
+
+        chunk = malloc(sizeof(struct arena_chunk) + data_size);
+        if (chunk == NULL)
+            return NULL;
+        chunk->used = 0;
+        chunk->size = data_size;
+        chunk->next = ar->arena;
+        ar->arena = chunk;
+    }
+
+    void *ptr = (uint8_t *)(chunk + 1) + chunk->used;
+    chunk->used += size;
+    return ptr;
+}
+
+static char *arena_strdup(struct audio_route *ar, const char *s)
+{
+    const size_t size = strlen(s) + 1;
+    char *copy = arena_alloc(ar, size);
+
+    if (copy != NULL)
+        memcpy(copy, s, size);
+    return copy;
+}
+
+static void arena_free(struct audio_route *ar)
+{
+    struct arena_chunk *chunk = ar->arena;
+
+    while (chunk != NULL) {
+        struct arena_chunk *next = chunk->next;
+
+        free(chunk);
+        chunk = next;
+    }
+    ar->arena = NULL;
+}
+
 #if 0
 static void path_print(struct audio_route *ar, struct mixer_path *path)
 {
@@ -162,17 +341,79 @@ static void path_print(struct audio_route *ar, struct mixer_path *path)
 }
 #endif
 
+static void path_program_free(struct mixer_path *path)
+{
+    free(path->steps);
+    path->steps = NULL;
+    path->num_steps = 0;
+    path->values = NULL;
+}
+
+/*
+ * Flattens the path settings into a single allocation: a table of
+ * {ctl_index, byte count, value offset} steps followed by the concatenated
+ * setting values.  Unsupported control types are filtered out here, so
+ * path_apply() neither looks up control types nor touches the
+ * mixer_setting structs.  Best effort: on allocation failure the path is
+ * simply applied from the settings as before.
+ */
+static void path_compile(struct mixer_path *path)
+{
+    size_t value_bytes = 0;
+    unsigned int num_steps = 0;
+    unsigned int i;
+
+    path_program_free(path);
+
+    for (i = 0; i < path->length; i++) {
+        if (!is_supported_ctl_type(path->setting[i].type))
+            continue;
+        value_bytes += path->setting[i].num_values *
+                sizeof_ctl_type(path->setting[i].type);
+        num_steps++;
+    }
+
+    path->steps = malloc(num_steps * sizeof(struct path_step) + value_bytes);
+    if (path->steps == NULL)
+        return;
+    path->values = (uint8_t *)(path->steps + num_steps);
+
+    unsigned int value_offset = 0;
+    unsigned int step = 0;
+    for (i = 0; i < path->length; i++) {
+        struct mixer_setting *setting = &path->setting[i];
+
+        if (!is_supported_ctl_type(setting->type))
+            continue;
+        const unsigned int num_bytes = setting->num_values *
+                sizeof_ctl_type(setting->type);
+        path->steps[step].ctl_index = setting->ctl_index;
+        path->steps[step].num_bytes = num_bytes;
+        path->steps[step].value_offset = value_offset;
+        memcpy(path->values + value_offset, setting->value.ptr, num_bytes);
+        value_offset += num_bytes;
+        step++;
+    }
+    path->num_steps = num_steps;
+}
+
+/* once the paths are final, compile each one for fast application */
+static void compile_paths(struct audio_route *ar)
+{
+    unsigned int i;
+
+    for (i = 0; i < ar->num_mixer_paths; i++)
+        path_compile(&ar->mixer_path[i]);
+}
+
 static void path_free(struct audio_route *ar)
 {
     unsigned int i;
 
     for (i = 0; i < ar->num_mixer_paths; i++) {
-        free(ar->mixer_path[i].name);
+        path_program_free(&ar->mixer_path[i]);
         if (ar->mixer_path[i].setting) {
-            size_t j;
-            for (j = 0; j < ar->mixer_path[i].length; j++) {
-                free(ar->mixer_path[i].setting[j].value.ptr);
-            }
+            /* names and setting values live in the arena */
             free(ar->mixer_path[i].setting);
             ar->mixer_path[i].size = 0;
             ar->mixer_path[i].length = 0;
@@ -183,6 +424,7 @@ static void path_free(struct audio_route *ar)
     ar->mixer_path = NULL;
     ar->mixer_path_size = 0;
     ar->num_mixer_paths = 0;
+    arena_free(ar);
 }
 
 static struct mixer_path *path_get_by_name(struct audio_route *ar,
@@ -224,10 +466,14 @@ static struct mixer_path *path_create(struct audio_route *ar, const char *name)
     }
 
     /* initialise the new mixer path */
-    ar->mixer_path[ar->num_mixer_paths].name = strdup(name);
+    ar->mixer_path[ar->num_mixer_paths].name = arena_strdup(ar, name);
     ar->mixer_path[ar->num_mixer_paths].size = 0;
     ar->mixer_path[ar->num_mixer_paths].length = 0;
     ar->mixer_path[ar->num_mixer_paths].setting = NULL;
+    ar->mixer_path[ar->num_mixer_paths].steps = NULL;
+    ar->mixer_path[ar->num_mixer_paths].num_steps = 0;
+    ar->mixer_path[ar->num_mixer_paths].values = NULL;
+    ar->mixer_path[ar->num_mixer_paths].applied_generation = 0;
 
     /* return the mixer path just added, then increment number of them */
     return &ar->mixer_path[ar->num_mixer_paths++];
@@ -250,6 +496,9 @@ static int alloc_path_setting(struct mixer_path *path)
     struct mixer_setting *new_path_setting;
     int path_index;
 
+    /* the compiled program no longer matches the settings */
+    path_program_free(path);
+
     /* check if we need to allocate more space for path settings */
     if (path->size <= path->length) {
         if (path->size == 0)
@@ -301,7 +550,8 @@ static int path_add_setting(struct audio_route *ar, struct mixer_path *path,
 
     size_t value_sz = sizeof_ctl_type(setting->type);
 
-    path->setting[path_index].value.ptr = calloc(setting->num_values, value_sz);
+    path->setting[path_index].value.ptr =
+            arena_alloc(ar, setting->num_values * value_sz);
     /* copy all values */
     memcpy(path->setting[path_index].value.ptr, setting->value.ptr,
            setting->num_values * value_sz);
@@ -326,6 +576,8 @@ static int path_add_value(struct audio_route *ar, struct mixer_path *path,
         return -1;
     }
 
+    path_program_free(path);
+
     path_index = find_ctl_index_in_path(path, mixer_value->ctl_index);
     if (path_index < 0) {
         /* New path */
@@ -345,7 +597,9 @@ static int path_add_value(struct audio_route *ar, struct mixer_path *path,
         path->setting[path_index].type = type;
 
         size_t value_sz = sizeof_ctl_type(type);
-        path->setting[path_index].value.ptr = calloc(num_values, value_sz);
+        path->setting[path_index].value.ptr =
+                arena_alloc(ar, num_values * value_sz);
+        memset(path->setting[path_index].value.ptr, 0, num_values * value_sz);
         if (path->setting[path_index].type == MIXER_CTL_TYPE_BYTE)
             path->setting[path_index].value.bytes[0] = mixer_value->value;
         else if (path->setting[path_index].type == MIXER_CTL_TYPE_ENUM)
@@ -407,6 +661,24 @@ static int path_apply(struct audio_route *ar, struct mixer_path *path)
     enum mixer_ctl_type type;
 
     ALOGD("Apply path: %s", path->name != NULL ? path->name : "none");
+
+    ar->route_generation++;
+
+    /* the compiled program is the common case; paths are compiled after
+       parsing and only lose their program if a setting changed */
+    if (path->steps == NULL)
+        path_compile(path);
+    if (path->steps != NULL) {
+        for (i = 0; i < path->num_steps; i++) {
+            const struct path_step *step = &path->steps[i];
+
+            memcpy(ar->mixer_state[step->ctl_index].new_value.ptr,
+                   path->values + step->value_offset, step->num_bytes);
+            mark_ctl_dirty(ar, step->ctl_index);
+        }
+        return 0;
+    }
+
     for (i = 0; i < path->length; i++) {
         ctl_index = path->setting[i].ctl_index;
         ctl = index_to_ctl(ar, ctl_index);
@@ -416,6 +688,7 @@ static int path_apply(struct audio_route *ar, struct mixer_path *path)
         size_t value_sz = sizeof_ctl_type(type);
         memcpy(ar->mixer_state[ctl_index].new_value.ptr, path->setting[i].value.ptr,
                    path->setting[i].num_values * value_sz);
+        mark_ctl_dirty(ar, ctl_index);
     }
 
     return 0;
@@ -429,6 +702,9 @@ static int path_reset(struct audio_route *ar, struct mixer_path *path)
     enum mixer_ctl_type type;
 
     ALOGV("Reset path: %s", path->name != NULL ? path->name : "none");
+
+    ar->route_generation++;
+
     for (i = 0; i < path->length; i++) {
         ctl_index = path->setting[i].ctl_index;
         ctl = index_to_ctl(ar, ctl_index);
@@ -440,6 +716,7 @@ static int path_reset(struct audio_route *ar, struct mixer_path *path)
         memcpy(ar->mixer_state[ctl_index].new_value.ptr,
                ar->mixer_state[ctl_index].reset_value.ptr,
                ar->mixer_state[ctl_index].num_values * value_sz);
+        mark_ctl_dirty(ar, ctl_index);
     }
 
     return 0;
@@ -470,6 +747,463 @@ static int mixer_enum_string_to_value(struct mixer_ctl *ctl, const char *string)
     return i;
 }
 
+/*
+ * Binary path cache
+ *
+ * Parsing the mixer XML dominates audio_route_init() on large
+ * configurations, so the parsed result is cached in a flat binary file next
+ * to the XML ("<xml_path>.cache").  The cache holds the flattened
+ * mixer_path/mixer_setting tables plus the top level initial control
+ * assignments, and is validated against the XML file (size and mtime) and
+ * the current mixer control list (count and a hash of names, types and
+ * value counts) before use; any mismatch falls back to the XML parser,
+ * which then rewrites the cache.  The control indices stored in the cache
+ * are only meaningful for the mixer they were resolved against, hence the
+ * control list hash.  Saving is best effort: if the directory is not
+ * writable every init simply parses the XML as before.
+ */
+
+#define CACHE_MAGIC 0x31435241u     /* "ARC1" */
+#define CACHE_VERSION 1
+
+/* value pool entries are aligned for in-place access from the mapping */
+#define CACHE_ALIGN(x) (((x) + 7) & ~(uint64_t)7)
+
+struct cache_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t long_size;         /* sizeof(long) of the writer */
+    uint32_t num_ctls;
+    uint32_t ctl_hash;
+    uint32_t num_paths;
+    uint32_t num_settings;
+    uint32_t num_init_values;
+    uint32_t value_pool_size;
+    uint32_t string_pool_size;
+    int64_t xml_size;
+    int64_t xml_mtime_sec;
+    int64_t xml_mtime_nsec;
+};
+
+struct cache_path {
+    uint32_t name_offset;       /* into the string pool */
+    uint32_t first_setting;     /* into the setting table */
+    uint32_t length;
+};
+
+struct cache_setting {
+    uint32_t ctl_index;
+    uint32_t num_values;
+    uint32_t type;
+    uint32_t value_offset;      /* into the value pool, native ctl values */
+};
+
+struct cache_init_value {
+    uint32_t ctl_index;
+    int32_t index;              /* -1 applies to all values */
+    uint32_t num_values;
+    uint32_t value_offset;      /* into the value pool, stored as longs */
+};
+
+static uint32_t mixer_ctls_hash(struct audio_route *ar)
+{
+    uint32_t hash = 2166136261u;    /* FNV-1a */
+    unsigned int i;
+
+    for (i = 0; i < ar->num_mixer_ctls; i++) {
+        struct mixer_ctl *ctl = ar->mixer_state[i].ctl;
+        const char *name = mixer_ctl_get_name(ctl);
+
+        while (*name)
+            hash = (hash ^ (unsigned char)*name++) * 16777619u;
+        hash = (hash ^ (uint32_t)mixer_ctl_get_type(ctl)) * 16777619u;
+        hash = (hash ^ ar->mixer_state[i].num_values) * 16777619u;
+    }
+    return hash;
+}
+
+static void record_initial_value(struct config_parse_state *state,
+                                 unsigned int ctl_index, int index,
+                                 const long *values, unsigned int num_values)
+{
+    struct initial_value *init;
+
+    if (state->cache_disabled || num_values == 0)
+        return;
+
+    if (state->init_values_size <= state->num_init_values) {
+        unsigned int new_size = state->init_values_size == 0 ?
+                INITIAL_MIXER_PATH_SIZE : state->init_values_size * 2;
+        struct initial_value *new_values = realloc(state->init_values,
+                new_size * sizeof(struct initial_value));
+        if (new_values == NULL) {
+            state->cache_disabled = true;
+            return;
+        }
+        state->init_values = new_values;
+        state->init_values_size = new_size;
+    }
+
+    init = &state->init_values[state->num_init_values];
+    init->values = malloc(num_values * sizeof(long));
+    if (init->values == NULL) {
+        state->cache_disabled = true;
+        return;
+    }
+    memcpy(init->values, values, num_values * sizeof(long));
+    init->ctl_index = ctl_index;
+    init->index = index;
+    init->num_values = num_values;
+    state->num_init_values++;
+}
+
+static void free_initial_values(struct config_parse_state *state)
+{
+    unsigned int i;
+
+    for (i = 0; i < state->num_init_values; i++)
+        free(state->init_values[i].values);
+    free(state->init_values);
+    state->init_values = NULL;
+    state->num_init_values = 0;
+    state->init_values_size = 0;
+}
+
+static bool cache_file_paths(const char *xml_path, char *cache_path,
+                             char *temp_path, size_t size)
+{
+    return snprintf(cache_path, size, "%s.cache", xml_path) < (int)size &&
+            snprintf(temp_path, size, "%s.cache.tmp", xml_path) < (int)size;
+}
+
+static void cache_save(struct audio_route *ar, const char *xml_path,
+                       struct config_parse_state *state)
+{
+    char cache_path[PATH_MAX];
+    char temp_path[PATH_MAX];
+    struct stat st;
+    struct cache_header header;
+    uint64_t value_pool_size = 0;
+    uint64_t string_pool_size = 0;
+    uint32_t num_settings = 0;
+    unsigned int i, j;
+
+    if (state->cache_disabled)
+        return;
+    if (stat(xml_path, &st) != 0)
+        return;
+    if (!cache_file_paths(xml_path, cache_path, temp_path, sizeof(cache_path)))
+        return;
+
+    /* size the tables and pools */
+    for (i = 0; i < ar->num_mixer_paths; i++) {
+        struct mixer_path *path = &ar->mixer_path[i];
+
+        string_pool_size += strlen(path->name) + 1;
+        for (j = 0; j < path->length; j++) {
+            value_pool_size = CACHE_ALIGN(value_pool_size) +
+                    (uint64_t)path->setting[j].num_values *
+                    sizeof_ctl_type(path->setting[j].type);
+            num_settings++;
+        }
+    }
+    for (i = 0; i < state->num_init_values; i++) {
+        value_pool_size = CACHE_ALIGN(value_pool_size) +
+                (uint64_t)state->init_values[i].num_values * sizeof(long);
+    }
+
+    const uint64_t paths_offset = sizeof(struct cache_header);
+    const uint64_t settings_offset = paths_offset +
+            (uint64_t)ar->num_mixer_paths * sizeof(struct cache_path);
+    const uint64_t init_values_offset = settings_offset +
+            (uint64_t)num_settings * sizeof(struct cache_setting);
+    const uint64_t value_pool_offset = CACHE_ALIGN(init_values_offset +
+            (uint64_t)state->num_init_values * sizeof(struct cache_init_value));
+    const uint64_t string_pool_offset = value_pool_offset + value_pool_size;
+    const uint64_t total_size = string_pool_offset + string_pool_size;
+
+    if (total_size > UINT32_MAX)
+        return;
+
+    uint8_t *buf = calloc(1, total_size);
+    if (buf == NULL)
+        return;
+
+    memset(&header, 0, sizeof(header));
+    header.magic = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    header.long_size = sizeof(long);
+    header.num_ctls = ar->num_mixer_ctls;
+    header.ctl_hash = mixer_ctls_hash(ar);
+    header.num_paths = ar->num_mixer_paths;
+    header.num_settings = num_settings;
+    header.num_init_values = state->num_init_values;
+    header.value_pool_size = value_pool_size;
+    header.string_pool_size = string_pool_size;
+    header.xml_size = st.st_size;
+    header.xml_mtime_sec = st.st_mtim.tv_sec;
+    header.xml_mtime_nsec = st.st_mtim.tv_nsec;
+    memcpy(buf, &header, sizeof(header));
+
+    struct cache_path *cache_paths = (struct cache_path *)(buf + paths_offset);
+    struct cache_setting *cache_settings =
+            (struct cache_setting *)(buf + settings_offset);
+    struct cache_init_value *cache_init_values =
+            (struct cache_init_value *)(buf + init_values_offset);
+    uint8_t *value_pool = buf + value_pool_offset;
+    char *string_pool = (char *)(buf + string_pool_offset);
+
+    uint64_t value_offset = 0;
+    uint64_t string_offset = 0;
+    uint32_t setting_index = 0;
+
+    for (i = 0; i < ar->num_mixer_paths; i++) {
+        struct mixer_path *path = &ar->mixer_path[i];
+
+        cache_paths[i].name_offset = string_offset;
+        cache_paths[i].first_setting = setting_index;
+        cache_paths[i].length = path->length;
+        strcpy(string_pool + string_offset, path->name);
+        string_offset += strlen(path->name) + 1;
+
+        for (j = 0; j < path->length; j++) {
+            struct mixer_setting *setting = &path->setting[j];
+            const size_t value_sz = sizeof_ctl_type(setting->type);
+
+            value_offset = CACHE_ALIGN(value_offset);
+            cache_settings[setting_index].ctl_index = setting->ctl_index;
+            cache_settings[setting_index].num_values = setting->num_values;
+            cache_settings[setting_index].type = setting->type;
+            cache_settings[setting_index].value_offset = value_offset;
+            memcpy(value_pool + value_offset, setting->value.ptr,
+                   setting->num_values * value_sz);
+            value_offset += setting->num_values * value_sz;
+            setting_index++;
+        }
+    }
+    for (i = 0; i < state->num_init_values; i++) {
+        struct initial_value *init = &state->init_values[i];
+
+        value_offset = CACHE_ALIGN(value_offset);
+        cache_init_values[i].ctl_index = init->ctl_index;
+        cache_init_values[i].index = init->index;
+        cache_init_values[i].num_values = init->num_values;
+        cache_init_values[i].value_offset = value_offset;
+        memcpy(value_pool + value_offset, init->values,
+               init->num_values * sizeof(long));
+        value_offset += init->num_values * sizeof(long);
+    }
+
+    /* write to a temp file and rename so readers never see a partial cache */
+    FILE *file = fopen(temp_path, "we");
+    if (file != NULL) {
+        const bool written = fwrite(buf, 1, total_size, file) == total_size;
+        fclose(file);
+        if (written) {
+            if (rename(temp_path, cache_path) != 0)
+                unlink(temp_path);
+        } else {
+            unlink(temp_path);
+        }
+    }
+    free(buf);
+}
+
+/*
+ * Replays a validated cache into the audio_route: initial values are applied
+ * to the mixer state and the path tables are rebuilt through the regular
+ * path functions, so ownership is the same as after an XML parse.
+ */
+static bool cache_apply(struct audio_route *ar, const struct cache_header *header,
+                        const struct cache_path *cache_paths,
+                        const struct cache_setting *cache_settings,
+                        const struct cache_init_value *cache_init_values,
+                        const uint8_t *value_pool, const char *string_pool)
+{
+    unsigned int i, j;
+
+    ar->route_generation++;
+
+    for (i = 0; i < header->num_init_values; i++) {
+        const struct cache_init_value *init = &cache_init_values[i];
+        struct mixer_state *ms = &ar->mixer_state[init->ctl_index];
+        const enum mixer_ctl_type type = mixer_ctl_get_type(ms->ctl);
+        const long *values = (const long *)(value_pool + init->value_offset);
+
+        if (!is_supported_ctl_type(type))
+            continue;
+        mark_ctl_dirty(ar, init->ctl_index);
+        if (init->index >= 0) {
+            if ((unsigned int)init->index >= ms->num_values)
+                continue;
+            if (type == MIXER_CTL_TYPE_BYTE)
+                ms->new_value.bytes[init->index] = values[0];
+            else if (type == MIXER_CTL_TYPE_ENUM)
+                ms->new_value.enumerated[init->index] = values[0];
+            else
+                ms->new_value.integer[init->index] = values[0];
+        } else {
+            for (j = 0; j < ms->num_values; j++) {
+                if (type == MIXER_CTL_TYPE_BYTE)
+                    ms->new_value.bytes[j] = values[j];
+                else if (type == MIXER_CTL_TYPE_INT)
+                    ms->new_value.integer[j] = values[j];
+                else if (type == MIXER_CTL_TYPE_ENUM)
+                    ms->new_value.enumerated[j] = values[0];
+                else
+                    ms->new_value.integer[j] = values[0];
+            }
+        }
+    }
+
+    for (i = 0; i < header->num_paths; i++) {
+        struct mixer_path *path = path_create(ar,
+                string_pool + cache_paths[i].name_offset);
+
+        if (path == NULL)
+            return false;
+        for (j = 0; j < cache_paths[i].length; j++) {
+            const struct cache_setting *cached =
+                    &cache_settings[cache_paths[i].first_setting + j];
+            struct mixer_setting setting;
+
+            setting.ctl_index = cached->ctl_index;
+            setting.num_values = cached->num_values;
+            setting.type = cached->type;
+            setting.value.ptr = (void *)(value_pool + cached->value_offset);
+            if (path_add_setting(ar, path, &setting) < 0)
+                return false;
+        }
+    }
+    return true;
+}
+
+static bool cache_load(struct audio_route *ar, const char *xml_path)
+{
+    char cache_path[PATH_MAX];
+    char temp_path[PATH_MAX];
+    struct stat xml_st;
+    struct stat cache_st;
+    bool loaded = false;
+    unsigned int i;
+
+    if (!cache_file_paths(xml_path, cache_path, temp_path, sizeof(cache_path)))
+        return false;
+
+    const int fd = open(cache_path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    if (fstat(fd, &cache_st) != 0 ||
+            cache_st.st_size < (off_t)sizeof(struct cache_header)) {
+        close(fd);
+        return false;
+    }
+    const size_t map_size = cache_st.st_size;
+    void *map = mmap(NULL, map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return false;
+
+    const struct cache_header *header = map;
+
+    /* reject anything not written for this XML file and this mixer */
+    if (header->magic != CACHE_MAGIC ||
+            header->version != CACHE_VERSION ||
+            header->long_size != sizeof(long) ||
+            header->num_ctls != ar->num_mixer_ctls ||
+            header->ctl_hash != mixer_ctls_hash(ar) ||
+            stat(xml_path, &xml_st) != 0 ||
+            header->xml_size != xml_st.st_size ||
+            header->xml_mtime_sec != xml_st.st_mtim.tv_sec ||
+            header->xml_mtime_nsec != xml_st.st_mtim.tv_nsec)
+        goto done;
+
+    const uint64_t paths_offset = sizeof(struct cache_header);
+    const uint64_t settings_offset = paths_offset +
+            (uint64_t)header->num_paths * sizeof(struct cache_path);
+    const uint64_t init_values_offset = settings_offset +
+            (uint64_t)header->num_settings * sizeof(struct cache_setting);
+    const uint64_t value_pool_offset = CACHE_ALIGN(init_values_offset +
+            (uint64_t)header->num_init_values * sizeof(struct cache_init_value));
+    const uint64_t string_pool_offset = value_pool_offset +
+            header->value_pool_size;
+
+    if (string_pool_offset + header->string_pool_size != (uint64_t)map_size)
+        goto done;
+
+    const struct cache_path *cache_paths =
+            (const struct cache_path *)((uint8_t *)map + paths_offset);
+    const struct cache_setting *cache_settings =
+            (const struct cache_setting *)((uint8_t *)map + settings_offset);
+    const struct cache_init_value *cache_init_values =
+            (const struct cache_init_value *)((uint8_t *)map + init_values_offset);
+    const uint8_t *value_pool = (const uint8_t *)map + value_pool_offset;
+    const char *string_pool = (const char *)map + string_pool_offset;
+
+    /* validate every table entry before touching the mixer state */
+    for (i = 0; i < header->num_paths; i++) {
+        const struct cache_path *path = &cache_paths[i];
+
+        if (path->name_offset >= header->string_pool_size ||
+                memchr(string_pool + path->name_offset, '\0',
+                       header->string_pool_size - path->name_offset) == NULL ||
+                path->first_setting > header->num_settings ||
+                path->length > header->num_settings - path->first_setting)
+            goto done;
+    }
+    for (i = 0; i < header->num_settings; i++) {
+        const struct cache_setting *setting = &cache_settings[i];
+
+        if (setting->ctl_index >= ar->num_mixer_ctls ||
+                !is_supported_ctl_type(setting->type) ||
+                setting->num_values !=
+                        ar->mixer_state[setting->ctl_index].num_values ||
+                (setting->value_offset & 7) != 0 ||
+                setting->value_offset > header->value_pool_size ||
+                (uint64_t)setting->num_values * sizeof_ctl_type(setting->type) >
+                        header->value_pool_size - setting->value_offset)
+            goto done;
+    }
+    for (i = 0; i < header->num_init_values; i++) {
+        const struct cache_init_value *init = &cache_init_values[i];
+
+        if (init->ctl_index >= ar->num_mixer_ctls ||
+                init->num_values == 0 ||
+                (init->value_offset & 7) != 0 ||
+                init->value_offset >= header->value_pool_size ||
+                (uint64_t)init->num_values * sizeof(long) >
+                        header->value_pool_size - init->value_offset)
+            goto done;
+        /* broadcast values must cover the whole control: cache_apply reads
+         * values[j] per element for BYTE and INT controls, so a short record
+         * would read past its pool slice.  ENUM and BOOL broadcast values[0],
+         * so a single value is also acceptable there. */
+        if (init->index == -1) {
+            const struct mixer_state *ms = &ar->mixer_state[init->ctl_index];
+            const enum mixer_ctl_type type = mixer_ctl_get_type(ms->ctl);
+
+            if (type == MIXER_CTL_TYPE_BYTE || type == MIXER_CTL_TYPE_INT) {
+                if (init->num_values != ms->num_values)
+                    goto done;
+            } else if (init->num_values != 1 &&
+                    init->num_values != ms->num_values) {
+                goto done;
+            }
+        }
+    }
+
+    loaded = cache_apply(ar, header, cache_paths, cache_settings,
+                         cache_init_values, value_pool, string_pool);
+    if (!loaded)
+        path_free(ar);
+
+done:
+    munmap(map, map_size);
+    if (loaded)
+        ALOGV("loaded %u paths from %s", header->num_paths, cache_path);
+    return loaded;
+}
+
 static void start_tag(void *data, const XML_Char *tag_name,
                       const XML_Char **attr)
 {
@@ -542,11 +1276,17 @@ static void start_tag(void *data, const XML_Char *tag_name,
                     goto done;
                 }
                 unsigned int num_values = mixer_ctl_get_num_values(ctl);
-                value_array = calloc(num_values, sizeof(long));
-                if (!value_array) {
-                    ALOGE("failed to allocate mem for ctl %s", attr_name);
-                    goto done;
+                if (num_values > state->value_scratch_size) {
+                    long *new_scratch = realloc(state->value_scratch,
+                                                num_values * sizeof(long));
+                    if (!new_scratch) {
+                        ALOGE("failed to allocate mem for ctl %s", attr_name);
+                        goto done;
+                    }
+                    state->value_scratch = new_scratch;
+                    state->value_scratch_size = num_values;
                 }
+                value_array = state->value_scratch;
                 for (i = 0; i < num_values; i++) {
                     attr_sub_value = strtok_r((char *)attr_value, " ", &test_r);
                     if (attr_sub_value == NULL) {
@@ -590,10 +1330,14 @@ static void start_tag(void *data, const XML_Char *tag_name,
             type = mixer_ctl_get_type(ctl);
             if (is_supported_ctl_type(type)) {
                 /* apply the new value */
+                ar->route_generation++;
+                mark_ctl_dirty(ar, ctl_index);
                 if (attr_id) {
                     /* set only one value */
                     id = atoi((char *)attr_id);
-                    if (id < ar->mixer_state[ctl_index].num_values)
+                    if (id < ar->mixer_state[ctl_index].num_values) {
+                        long single_value;
+
                         if (type == MIXER_CTL_TYPE_BYTE)
                             ar->mixer_state[ctl_index].new_value.bytes[id] = value_array[0];
                         else if (type == MIXER_CTL_TYPE_INT)
@@ -602,9 +1346,14 @@ static void start_tag(void *data, const XML_Char *tag_name,
                             ar->mixer_state[ctl_index].new_value.enumerated[id] = value;
                         else
                             ar->mixer_state[ctl_index].new_value.integer[id] = value;
-                    else
+
+                        single_value = (type == MIXER_CTL_TYPE_BYTE ||
+                                type == MIXER_CTL_TYPE_INT) ? value_array[0] : value;
+                        record_initial_value(state, ctl_index, id, &single_value, 1);
+                    } else {
                         ALOGW("value id out of range for mixer ctl '%s'",
                               mixer_ctl_get_name(ctl));
+                    }
                 } else {
                     /* set all values the same except for CTL_TYPE_BYTE and CTL_TYPE_INT */
                     for (i = 0; i < ar->mixer_state[ctl_index].num_values; i++)
@@ -616,6 +1365,12 @@ static void start_tag(void *data, const XML_Char *tag_name,
                             ar->mixer_state[ctl_index].new_value.enumerated[i] = value;
                         else
                             ar->mixer_state[ctl_index].new_value.integer[i] = value;
+
+                    if (type == MIXER_CTL_TYPE_BYTE || type == MIXER_CTL_TYPE_INT)
+                        record_initial_value(state, ctl_index, -1, value_array,
+                                ar->mixer_state[ctl_index].num_values);
+                    else
+                        record_initial_value(state, ctl_index, -1, &value, 1);
                 }
             }
         } else {
@@ -638,7 +1393,6 @@ static void start_tag(void *data, const XML_Char *tag_name,
     }
 
 done:
-    free(value_array);
     state->level++;
 }
 
@@ -650,19 +1404,19 @@ static void end_tag(void *data, const XML_Char *tag_name)
     state->level--;
 }
 
-static int alloc_mixer_state(struct audio_route *ar)
+/* Snapshots the current hardware state of the controls in [begin, end).
+   Multi-value controls are fetched with one bulk mixer_ctl_get_array()
+   read rather than a kernel round trip per value.  Controls are
+   independent, so disjoint ranges may be snapshotted concurrently. */
+static void snapshot_ctl_range(struct audio_route *ar, unsigned int begin,
+                               unsigned int end)
 {
     unsigned int i;
     unsigned int num_values;
     struct mixer_ctl *ctl;
     enum mixer_ctl_type type;
 
-    ar->num_mixer_ctls = mixer_get_num_ctls(ar->mixer);
-    ar->mixer_state = calloc(ar->num_mixer_ctls, sizeof(struct mixer_state));
-    if (!ar->mixer_state)
-        return -1;
-
-    for (i = 0; i < ar->num_mixer_ctls; i++) {
+    for (i = begin; i < end; i++) {
         ctl = mixer_get_ctl(ar->mixer, i);
         num_values = mixer_ctl_get_num_values(ctl);
 
@@ -689,6 +1443,55 @@ static int alloc_mixer_state(struct audio_route *ar)
         memcpy(ar->mixer_state[i].new_value.ptr, ar->mixer_state[i].old_value.ptr,
                num_values * value_sz);
     }
+}
+
+struct snapshot_job {
+    struct audio_route *ar;
+    unsigned int begin;
+    unsigned int end;
+};
+
+static void *snapshot_worker(void *arg)
+{
+    struct snapshot_job *job = arg;
+
+    snapshot_ctl_range(job->ar, job->begin, job->end);
+    return NULL;
+}
+
+static int alloc_mixer_state(struct audio_route *ar)
+{
+    ar->num_mixer_ctls = mixer_get_num_ctls(ar->mixer);
+    ar->mixer_state = calloc(ar->num_mixer_ctls, sizeof(struct mixer_state));
+    if (!ar->mixer_state)
+        return -1;
+
+    ar->dirty_bitmap = calloc((ar->num_mixer_ctls + 31) / 32, sizeof(uint32_t));
+    ar->dirty_list = calloc(ar->num_mixer_ctls, sizeof(unsigned int));
+    ar->num_dirty_ctls = 0;
+    if (!ar->dirty_bitmap || !ar->dirty_list)
+        return -1;
+
+    /* The initial snapshot is one read ioctl per control, which is serial
+       kernel latency that dominates init on cards with a large control
+       surface.  Split the range with a transient thread so the latencies
+       overlap; fall back to a serial scan if the thread cannot start. */
+    if (ar->num_mixer_ctls >= PARALLEL_SNAPSHOT_MIN_CTLS) {
+        struct snapshot_job job = {
+            .ar = ar,
+            .begin = 0,
+            .end = ar->num_mixer_ctls / 2,
+        };
+        pthread_t thread;
+
+        if (pthread_create(&thread, NULL, snapshot_worker, &job) == 0) {
+            snapshot_ctl_range(ar, job.end, ar->num_mixer_ctls);
+            pthread_join(thread, NULL);
+            return 0;
+        }
+        ALOGW("unable to start mixer snapshot worker, reading serially");
+    }
+    snapshot_ctl_range(ar, 0, ar->num_mixer_ctls);
 
     return 0;
 }
@@ -710,62 +1513,203 @@ static void free_mixer_state(struct audio_route *ar)
 
     free(ar->mixer_state);
     ar->mixer_state = NULL;
+    free(ar->dirty_bitmap);
+    ar->dirty_bitmap = NULL;
+    free(ar->dirty_list);
+    ar->dirty_list = NULL;
+    ar->num_dirty_ctls = 0;
 }
 
-/* Update the mixer with any changed values */
-int audio_route_update_mixer(struct audio_route *ar)
+/* Compares a single control's new_value against old_value and writes it
+   out if changed.  Never touches the dirty bookkeeping, so disjoint
+   controls may be updated concurrently. */
+static void update_dirty_ctl(struct audio_route *ar, unsigned int i)
 {
-    unsigned int i;
     unsigned int j;
     struct mixer_ctl *ctl;
+    unsigned int num_values = ar->mixer_state[i].num_values;
+    enum mixer_ctl_type type;
 
-    for (i = 0; i < ar->num_mixer_ctls; i++) {
-        unsigned int num_values = ar->mixer_state[i].num_values;
-        enum mixer_ctl_type type;
+    ctl = ar->mixer_state[i].ctl;
 
-        ctl = ar->mixer_state[i].ctl;
+    /* Skip unsupported types */
+    type = mixer_ctl_get_type(ctl);
+    if (!is_supported_ctl_type(type))
+        return;
 
-        /* Skip unsupported types */
-        type = mixer_ctl_get_type(ctl);
-        if (!is_supported_ctl_type(type))
-            continue;
-
-        /* if the value has changed, update the mixer */
-        bool changed = false;
-        if (type == MIXER_CTL_TYPE_BYTE) {
-            for (j = 0; j < num_values; j++) {
-                if (ar->mixer_state[i].old_value.bytes[j] != ar->mixer_state[i].new_value.bytes[j]) {
-                    changed = true;
-                    break;
-                }
+    /* if the value has changed, update the mixer */
+    bool changed = false;
+    if (type == MIXER_CTL_TYPE_BYTE) {
+        for (j = 0; j < num_values; j++) {
+            if (ar->mixer_state[i].old_value.bytes[j] != ar->mixer_state[i].new_value.bytes[j]) {
+                changed = true;
+                break;
             }
-         } else if (type == MIXER_CTL_TYPE_ENUM) {
-             for (j = 0; j < num_values; j++) {
-                 if (ar->mixer_state[i].old_value.enumerated[j]
-                         != ar->mixer_state[i].new_value.enumerated[j]) {
-                     changed = true;
-                     break;
-                 }
-             }
-         } else {
-            for (j = 0; j < num_values; j++) {
-                if (ar->mixer_state[i].old_value.integer[j] != ar->mixer_state[i].new_value.integer[j]) {
-                    changed = true;
-                    break;
-                }
+        }
+    } else if (type == MIXER_CTL_TYPE_ENUM) {
+        for (j = 0; j < num_values; j++) {
+            if (ar->mixer_state[i].old_value.enumerated[j]
+                    != ar->mixer_state[i].new_value.enumerated[j]) {
+                changed = true;
+                break;
             }
         }
-        if (changed) {
-            if (type == MIXER_CTL_TYPE_ENUM)
-                mixer_ctl_set_value(ctl, 0, ar->mixer_state[i].new_value.enumerated[0]);
-            else
-                mixer_ctl_set_array(ctl, ar->mixer_state[i].new_value.ptr, num_values);
-
-            size_t value_sz = sizeof_ctl_type(type);
-            memcpy(ar->mixer_state[i].old_value.ptr, ar->mixer_state[i].new_value.ptr,
-                   num_values * value_sz);
+    } else {
+        for (j = 0; j < num_values; j++) {
+            if (ar->mixer_state[i].old_value.integer[j] != ar->mixer_state[i].new_value.integer[j]) {
+                changed = true;
+                break;
+            }
         }
     }
+    if (changed) {
+        if (type == MIXER_CTL_TYPE_ENUM)
+            mixer_ctl_set_value(ctl, 0, ar->mixer_state[i].new_value.enumerated[0]);
+        else
+            mixer_ctl_set_array(ctl, ar->mixer_state[i].new_value.ptr, num_values);
+
+        size_t value_sz = sizeof_ctl_type(type);
+        memcpy(ar->mixer_state[i].old_value.ptr, ar->mixer_state[i].new_value.ptr,
+               num_values * value_sz);
+    }
+}
+
+/* clears the dirty bookkeeping once every listed control has been updated */
+static void clear_dirty_ctls(struct audio_route *ar)
+{
+    unsigned int d;
+
+    for (d = 0; d < ar->num_dirty_ctls; d++) {
+        const unsigned int i = ar->dirty_list[d];
+
+        ar->dirty_bitmap[i >> 5] &= ~(1u << (i & 31));
+    }
+    ar->num_dirty_ctls = 0;
+}
+
+/* Update the mixer with any changed values; only the controls written
+   since the last update are compared, not the whole mixer */
+int audio_route_update_mixer(struct audio_route *ar)
+{
+    unsigned int d;
+
+    atrace_begin(ATRACE_TAG, "audio_route_update_mixer");
+    atrace_int(ATRACE_TAG, "audio_route_dirty_ctls", ar->num_dirty_ctls);
+    for (d = 0; d < ar->num_dirty_ctls; d++)
+        update_dirty_ctl(ar, ar->dirty_list[d]);
+    clear_dirty_ctls(ar);
+    atrace_end(ATRACE_TAG);
+
+    return 0;
+}
+
+static void *update_worker_main(void *arg)
+{
+    struct audio_route *ar = arg;
+    struct update_worker *w = &ar->worker;
+    unsigned int d;
+
+    pthread_mutex_lock(&w->lock);
+    for (;;) {
+        while (!w->busy && !w->exit)
+            pthread_cond_wait(&w->wake, &w->lock);
+        if (w->exit)
+            break;
+        pthread_mutex_unlock(&w->lock);
+
+        for (d = w->begin; d < w->end; d++)
+            update_dirty_ctl(ar, ar->dirty_list[d]);
+
+        pthread_mutex_lock(&w->lock);
+        w->busy = false;
+        pthread_cond_signal(&w->done);
+    }
+    pthread_mutex_unlock(&w->lock);
+
+    return NULL;
+}
+
+static bool update_worker_start(struct audio_route *ar)
+{
+    struct update_worker *w = &ar->worker;
+
+    if (w->started)
+        return true;
+
+    pthread_mutex_init(&w->lock, NULL);
+    pthread_cond_init(&w->wake, NULL);
+    pthread_cond_init(&w->done, NULL);
+    if (pthread_create(&w->thread, NULL, update_worker_main, ar) != 0) {
+        ALOGW("unable to start mixer update worker");
+        pthread_mutex_destroy(&w->lock);
+        pthread_cond_destroy(&w->wake);
+        pthread_cond_destroy(&w->done);
+        return false;
+    }
+    w->started = true;
+
+    return true;
+}
+
+static void update_worker_stop(struct audio_route *ar)
+{
+    struct update_worker *w = &ar->worker;
+
+    if (!w->started)
+        return;
+
+    pthread_mutex_lock(&w->lock);
+    w->exit = true;
+    pthread_cond_signal(&w->wake);
+    pthread_mutex_unlock(&w->lock);
+    pthread_join(w->thread, NULL);
+    pthread_mutex_destroy(&w->lock);
+    pthread_cond_destroy(&w->wake);
+    pthread_cond_destroy(&w->done);
+    w->started = false;
+    w->exit = false;
+}
+
+/*
+ * Same contract as audio_route_update_mixer(), but the dirty control
+ * writes are split between the caller and a worker thread so the kernel
+ * ioctl latencies of independent hardware blocks overlap.  Safe because
+ * the dirty list holds each control exactly once (deduplicated by
+ * mark_ctl_dirty()), so the two halves always touch disjoint controls.
+ * Falls back to the serial update for small dirty sets or if the worker
+ * cannot be started.
+ */
+int audio_route_update_mixer_parallel(struct audio_route *ar)
+{
+    struct update_worker *w = &ar->worker;
+    unsigned int d;
+
+    if (ar->num_dirty_ctls < PARALLEL_UPDATE_MIN_CTLS ||
+            !update_worker_start(ar))
+        return audio_route_update_mixer(ar);
+
+    atrace_begin(ATRACE_TAG, "audio_route_update_mixer_parallel");
+    atrace_int(ATRACE_TAG, "audio_route_dirty_ctls", ar->num_dirty_ctls);
+
+    const unsigned int mid = ar->num_dirty_ctls / 2;
+
+    pthread_mutex_lock(&w->lock);
+    w->begin = 0;
+    w->end = mid;
+    w->busy = true;
+    pthread_cond_signal(&w->wake);
+    pthread_mutex_unlock(&w->lock);
+
+    for (d = mid; d < ar->num_dirty_ctls; d++)
+        update_dirty_ctl(ar, ar->dirty_list[d]);
+
+    pthread_mutex_lock(&w->lock);
+    while (w->busy)
+        pthread_cond_wait(&w->done, &w->lock);
+    pthread_mutex_unlock(&w->lock);
+
+    clear_dirty_ctls(ar);
+    atrace_end(ATRACE_TAG);
 
     return 0;
 }
@@ -793,6 +1737,8 @@ void audio_route_reset(struct audio_route *ar)
     unsigned int i;
     enum mixer_ctl_type type;
 
+    ar->route_generation++;
+
     /* load all of the saved values */
     for (i = 0; i < ar->num_mixer_ctls; i++) {
         type = mixer_ctl_get_type(ar->mixer_state[i].ctl);
@@ -802,6 +1748,7 @@ void audio_route_reset(struct audio_route *ar)
         size_t value_sz = sizeof_ctl_type(type);
         memcpy(ar->mixer_state[i].new_value.ptr, ar->mixer_state[i].reset_value.ptr,
             ar->mixer_state[i].num_values * value_sz);
+        mark_ctl_dirty(ar, i);
     }
 }
 
@@ -943,10 +1890,56 @@ static int audio_route_update_path(struct audio_route *ar, const char *name, int
 
 int audio_route_apply_and_update_path(struct audio_route *ar, const char *name)
 {
-    if (audio_route_apply_path(ar, name) < 0) {
+    struct mixer_path *path;
+
+    if (!ar) {
+        ALOGE("invalid audio_route");
         return -1;
     }
-    return audio_route_update_path(ar, name, DIRECTION_FORWARD);
+
+    path = path_get_by_name(ar, name);
+    if (!path) {
+        ALOGE("unable to find path '%s'", name);
+        return -1;
+    }
+
+    /* Media session churn re-applies the same path many times in a row.
+       If nothing has mutated the mixer state since this path was last
+       applied and updated, the mixer already holds exactly this path's
+       values, so the full apply and per-value comparison pass is a no-op.
+       Path settings are immutable after init, so the generation check
+       alone is exact.  A skipped apply must still claim the path's
+       controls, though: every apply is balanced by a reset that drops
+       active_count, so skipping the claim would let the first client's
+       reset release controls a second client still needs. */
+    if (path->applied_generation != 0
+            && path->applied_generation == ar->route_generation) {
+        for (size_t i = 0; i < path->length; ++i) {
+            struct mixer_state *ms =
+                    &ar->mixer_state[path->setting[i].ctl_index];
+
+            if (is_supported_ctl_type(mixer_ctl_get_type(ms->ctl)))
+                ms->active_count++;
+        }
+        ALOGV("Skip apply path: %s, mixer state unchanged", name);
+        return 0;
+    }
+
+    /* name the trace slice after the path so route latencies are attributable */
+    if (atrace_is_tag_enabled(ATRACE_TAG)) {
+        char traced[64];
+        snprintf(traced, sizeof(traced), "audio_route_apply_and_update_path(%s)", name);
+        atrace_begin(ATRACE_TAG, traced);
+    }
+    path_apply(ar, path);
+    int ret = audio_route_update_path(ar, name, DIRECTION_FORWARD);
+    atrace_end(ATRACE_TAG);
+    if (ret < 0) {
+        return -1;
+    }
+    path->applied_generation = ar->route_generation;
+
+    return 0;
 }
 
 int audio_route_reset_and_update_path(struct audio_route *ar, const char *name)
@@ -966,6 +1959,171 @@ int audio_route_force_reset_and_update_path(struct audio_route *ar, const char *
     return audio_route_update_path(ar, name, DIRECTION_REVERSE_RESET);
 }
 
+static void *apply_queue_main(void *arg)
+{
+    struct audio_route *ar = arg;
+    struct apply_queue *q = &ar->apply_queue;
+
+    pthread_mutex_lock(&q->lock);
+    for (;;) {
+        while (q->count == 0 && !q->exit)
+            pthread_cond_wait(&q->wake, &q->lock);
+        if (q->exit && q->count == 0)
+            break;
+
+        struct pending_transition t = q->items[0];
+        q->count--;
+        memmove(q->items, q->items + 1, q->count * sizeof(q->items[0]));
+        q->busy = true;
+        pthread_mutex_unlock(&q->lock);
+
+        if (t.direction == DIRECTION_FORWARD)
+            audio_route_apply_and_update_path(ar, t.path->name);
+        else
+            audio_route_reset_and_update_path(ar, t.path->name);
+
+        pthread_mutex_lock(&q->lock);
+        q->busy = false;
+        if (q->count == 0)
+            pthread_cond_broadcast(&q->done);
+    }
+    pthread_mutex_unlock(&q->lock);
+
+    return NULL;
+}
+
+static bool apply_queue_start(struct audio_route *ar)
+{
+    struct apply_queue *q = &ar->apply_queue;
+
+    if (q->started)
+        return true;
+
+    q->items = malloc(INITIAL_APPLY_QUEUE_SIZE * sizeof(q->items[0]));
+    if (!q->items)
+        return false;
+    q->size = INITIAL_APPLY_QUEUE_SIZE;
+    q->count = 0;
+
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->wake, NULL);
+    pthread_cond_init(&q->done, NULL);
+    if (pthread_create(&q->thread, NULL, apply_queue_main, ar) != 0) {
+        ALOGW("unable to start async path applier");
+        pthread_mutex_destroy(&q->lock);
+        pthread_cond_destroy(&q->wake);
+        pthread_cond_destroy(&q->done);
+        free(q->items);
+        q->items = NULL;
+        return false;
+    }
+    q->started = true;
+
+    return true;
+}
+
+static void apply_queue_stop(struct audio_route *ar)
+{
+    struct apply_queue *q = &ar->apply_queue;
+
+    if (!q->started)
+        return;
+
+    pthread_mutex_lock(&q->lock);
+    q->exit = true;
+    pthread_cond_signal(&q->wake);
+    pthread_mutex_unlock(&q->lock);
+    pthread_join(q->thread, NULL);
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->wake);
+    pthread_cond_destroy(&q->done);
+    free(q->items);
+    q->items = NULL;
+    q->started = false;
+    q->exit = false;
+}
+
+static int apply_queue_push(struct audio_route *ar, const char *name, int direction)
+{
+    struct mixer_path *path;
+
+    if (!ar) {
+        ALOGE("invalid audio_route");
+        return -1;
+    }
+
+    path = path_get_by_name(ar, name);
+    if (!path) {
+        ALOGE("unable to find path '%s'", name);
+        return -1;
+    }
+
+    if (!apply_queue_start(ar)) {
+        /* no applier thread: apply synchronously, same net effect */
+        if (direction == DIRECTION_FORWARD)
+            return audio_route_apply_and_update_path(ar, name);
+        return audio_route_reset_and_update_path(ar, name);
+    }
+
+    struct apply_queue *q = &ar->apply_queue;
+
+    pthread_mutex_lock(&q->lock);
+
+    /* If the newest queued transition is the opposite transition of the
+       same path, neither has touched the kernel yet and the pair is a
+       no-op; cancel them against each other.  Only the adjacent pair is
+       cancelled so transitions of other paths are never reordered. */
+    if (q->count > 0) {
+        struct pending_transition *last = &q->items[q->count - 1];
+        if (last->path == path && last->direction != direction) {
+            q->count--;
+            pthread_mutex_unlock(&q->lock);
+            return 0;
+        }
+    }
+
+    if (q->count == q->size) {
+        struct pending_transition *items = realloc(q->items,
+                2 * q->size * sizeof(q->items[0]));
+        if (!items) {
+            pthread_mutex_unlock(&q->lock);
+            return -1;
+        }
+        q->items = items;
+        q->size *= 2;
+    }
+    q->items[q->count].path = path;
+    q->items[q->count].direction = direction;
+    q->count++;
+    pthread_cond_signal(&q->wake);
+    pthread_mutex_unlock(&q->lock);
+
+    return 0;
+}
+
+int audio_route_apply_and_update_path_async(struct audio_route *ar, const char *name)
+{
+    return apply_queue_push(ar, name, DIRECTION_FORWARD);
+}
+
+int audio_route_reset_and_update_path_async(struct audio_route *ar, const char *name)
+{
+    return apply_queue_push(ar, name, DIRECTION_REVERSE);
+}
+
+void audio_route_drain_async(struct audio_route *ar)
+{
+    struct apply_queue *q = &ar->apply_queue;
+
+    if (!ar || !q->started)
+        return;
+
+    pthread_mutex_lock(&q->lock);
+    while (q->count > 0 || q->busy)
+        pthread_cond_wait(&q->done, &q->lock);
+    pthread_mutex_unlock(&q->lock);
+}
+
 struct audio_route *audio_route_init(unsigned int card, const char *xml_path)
 {
     struct config_parse_state state;
@@ -997,6 +2155,14 @@ struct audio_route *audio_route_init(unsigned int card, const char *xml_path)
     if (xml_path == NULL)
         xml_path = MIXER_XML_PATH;
 
+    /* a valid binary cache replaces the XML parse entirely */
+    if (cache_load(ar, xml_path)) {
+        audio_route_update_mixer(ar);
+        save_mixer_state(ar);
+        compile_paths(ar);
+        return ar;
+    }
+
     file = fopen(xml_path, "r");
 
     if (!file) {
@@ -1039,11 +2205,20 @@ struct audio_route *audio_route_init(unsigned int card, const char *xml_path)
     audio_route_update_mixer(ar);
     save_mixer_state(ar);
 
+    /* best effort: speed up the next init with this mixer and XML file */
+    cache_save(ar, xml_path, &state);
+    free_initial_values(&state);
+    free(state.value_scratch);
+
+    compile_paths(ar);
+
     XML_ParserFree(parser);
     fclose(file);
     return ar;
 
 err_parse:
+    free_initial_values(&state);
+    free(state.value_scratch);
     path_free(ar);
     XML_ParserFree(parser);
 err_parser_create:
@@ -1059,8 +2234,93 @@ err_calloc:
     return NULL;
 }
 
+/* Process-wide registry of shared audio_route instances.  Multiple HAL
+   modules on the same card share one parsed route set and one mixer state
+   instead of double-parsing the XML and fighting through duplicate
+   mixer_state arrays; with a single state the active counts arbitrate
+   consistently across clients. */
+struct shared_route {
+    struct shared_route *next;
+    struct audio_route *ar;
+    unsigned int card;
+    char *xml_path;
+    unsigned int refcount;
+};
+
+static pthread_mutex_t shared_routes_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct shared_route *shared_routes;
+
+struct audio_route *audio_route_init_shared(unsigned int card,
+                                            const char *xml_path)
+{
+    struct shared_route *node;
+    struct audio_route *ar;
+
+    if (xml_path == NULL)
+        xml_path = MIXER_XML_PATH;
+
+    pthread_mutex_lock(&shared_routes_lock);
+    for (node = shared_routes; node != NULL; node = node->next) {
+        if (node->card == card && strcmp(node->xml_path, xml_path) == 0) {
+            node->refcount++;
+            pthread_mutex_unlock(&shared_routes_lock);
+            return node->ar;
+        }
+    }
+
+    /* parse under the lock, so two clients racing to init the same card
+       still parse only once */
+    ar = audio_route_init(card, xml_path);
+    if (ar != NULL) {
+        node = calloc(1, sizeof(struct shared_route));
+        char *path_copy = node != NULL ? strdup(xml_path) : NULL;
+        if (path_copy == NULL) {
+            /* registry bookkeeping failed; hand the instance out unshared */
+            free(node);
+        } else {
+            node->ar = ar;
+            node->card = card;
+            node->xml_path = path_copy;
+            node->refcount = 1;
+            node->next = shared_routes;
+            shared_routes = node;
+        }
+    }
+    pthread_mutex_unlock(&shared_routes_lock);
+    return ar;
+}
+
+/* drops one shared reference; returns true when other owners remain and
+   the caller must not tear the instance down */
+static bool shared_route_release(struct audio_route *ar)
+{
+    struct shared_route **node;
+
+    pthread_mutex_lock(&shared_routes_lock);
+    for (node = &shared_routes; *node != NULL; node = &(*node)->next) {
+        if ((*node)->ar == ar) {
+            struct shared_route *found = *node;
+
+            if (--found->refcount > 0) {
+                pthread_mutex_unlock(&shared_routes_lock);
+                return true;
+            }
+            *node = found->next;
+            free(found->xml_path);
+            free(found);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&shared_routes_lock);
+    return false;
+}
+
 void audio_route_free(struct audio_route *ar)
 {
+    if (shared_route_release(ar))
+        return;
+    apply_queue_stop(ar);
+    update_worker_stop(ar);
     free_mixer_state(ar);
     mixer_close(ar->mixer);
     path_free(ar);
@@ -25,10 +25,23 @@ extern "C" {
 struct audio_route *audio_route_init(unsigned int card, const char *xml_path);
 void audio_route_free(struct audio_route *ar);
 
+/* As audio_route_init(), but instances are shared process-wide: a second
+ * init on the same card and XML file returns the already-parsed instance
+ * instead of parsing the XML again and keeping a duplicate mixer state,
+ * and all clients arbitrate routes through the same control active
+ * counts.  Each init must be balanced by an audio_route_free(); the
+ * instance is torn down when the last owner frees it.  As with an
+ * unshared instance, direct route calls from concurrent clients must be
+ * externally serialized or go through the *_async calls. */
+struct audio_route *audio_route_init_shared(unsigned int card,
+                                            const char *xml_path);
+
 /* Apply an audio route path by name */
 int audio_route_apply_path(struct audio_route *ar, const char *name);
 
-/* Apply and update mixer with audio route path by name */
+/* Apply and update mixer with audio route path by name.
+ * Returns immediately if the path is already applied and the mixer state
+ * has not changed since, so redundant re-applies are O(1). */
 int audio_route_apply_and_update_path(struct audio_route *ar, const char *name);
 
 /* Reset an audio route path by name */
@@ -37,6 +50,18 @@ int audio_route_reset_path(struct audio_route *ar, const char *name);
 /* Reset and update mixer with audio route path by name */
 int audio_route_reset_and_update_path(struct audio_route *ar, const char *name);
 
+/* As the apply/reset and update calls above, but the transition is queued
+ * and performed by a dedicated applier thread, so the caller never blocks
+ * on kernel control writes.  A queued transition that is exactly undone by
+ * the next one of the same path is cancelled before touching the kernel,
+ * so fast route flapping settles to the final state.  Queued transitions
+ * must not race with direct calls on the same audio_route; drain first. */
+int audio_route_apply_and_update_path_async(struct audio_route *ar, const char *name);
+int audio_route_reset_and_update_path_async(struct audio_route *ar, const char *name);
+
+/* Wait until every queued async transition has been applied */
+void audio_route_drain_async(struct audio_route *ar);
+
 /* Reset and update mixer with audio route path by name forcely */
 int audio_route_force_reset_and_update_path(struct audio_route *ar, const char *name);
 
@@ -46,6 +71,12 @@ void audio_route_reset(struct audio_route *ar);
 /* Update the mixer with any changed values */
 int audio_route_update_mixer(struct audio_route *ar);
 
+/* As audio_route_update_mixer(), but large updates are split between the
+ * calling thread and a worker thread so the kernel write latencies of
+ * independent controls overlap.  Must not run concurrently with other
+ * calls on the same audio_route. */
+int audio_route_update_mixer_parallel(struct audio_route *ar);
+
 #if defined(__cplusplus)
 }  /* extern "C" */
 #endif
@@ -14,7 +14,11 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <string.h>
+
 #include <audio_utils/Balance.h>
+#include <audio_utils/limiter.h>
 
 namespace android::audio_utils {
 
@@ -41,6 +45,7 @@ void Balance::setChannelMask(audio_channel_mask_t channelMask)
     // reset ramping variables
     mRampBalance = 0.f;
     mRampVolumes.clear();
+    mRampGenerator.setChannelCount(mChannelCount);
 
     if (audio_channel_mask_get_representation(mChannelMask)
             == AUDIO_CHANNEL_REPRESENTATION_INDEX) {
@@ -88,19 +93,115 @@ void Balance::process(float *buffer, size_t frames)
             mRampVolumes = mVolumes;
         } else if (mRampBalance != mBalance) {
             if (frames > 0) {
-                std::vector<float> mDeltas(mVolumes.size());
-                const float r = 1.f / frames;
-                for (size_t j = 0; j < mChannelCount; ++j) {
-                    mDeltas[j] = (mVolumes[j] - mRampVolumes[j]) * r;
-                }
-
                 // ramped balance
+                mRampGenerator.setGains(mRampVolumes.data());
+                mRampGenerator.rampLinear(mVolumes.data(), frames);
+                mRampGenerator.process(buffer, frames);
+            }
+            mRampBalance = mBalance;
+            mRampVolumes = mVolumes;
+            return;
+        }
+        // fall through
+    }
+
+    // non-ramped balance
+    for (size_t i = 0; i < frames; ++i) {
+        for (size_t j = 0; j < mChannelCount; ++j) {
+            *buffer++ *= mVolumes[j];
+        }
+    }
+}
+
+void Balance::applyGains(float *buffer, size_t frames, const float *gains) const
+{
+    RampGenerator::applyGains(buffer, frames, gains, mChannelCount);
+}
+
+void Balance::process(float *buffer, size_t frames, float masterVolume)
+{
+    if (mChannelCount == 0 || frames == 0 || isnan(masterVolume)) {
+        return;
+    }
+
+    // fold the master volume into the balance volumes for a single multiply pass.
+    mGains.resize(mChannelCount);
+    for (size_t j = 0; j < mChannelCount; ++j) {
+        mGains[j] = mVolumes[j] * masterVolume;
+    }
+
+    if (mRamp) {
+        if (mRampVolumes.size() != mVolumes.size()) {
+            // As in process(), ramping starts on the next call; the balance,
+            // volume and master volume state is saved and the non-ramping
+            // code below applies.
+            mRampBalance = mBalance;
+            mRampVolumes = mVolumes;
+            mRampMasterVolume = masterVolume;
+        } else if (mRampBalance != mBalance || mRampMasterVolume != masterVolume) {
+            // Block ramp from the previous combined gains toward the new ones.
+            std::vector<float> startGains(mChannelCount);
+            for (size_t j = 0; j < mChannelCount; ++j) {
+                startGains[j] = mRampVolumes[j] * mRampMasterVolume;
+            }
+            mRampGenerator.setGains(startGains.data());
+            mRampGenerator.rampLinear(mGains.data(), frames);
+            mRampGenerator.process(buffer, frames);
+            mRampBalance = mBalance;
+            mRampVolumes = mVolumes;
+            mRampMasterVolume = masterVolume;
+            return;
+        }
+        // fall through
+    }
+
+    // non-ramped balance and master volume.
+    applyGains(buffer, frames, mGains.data());
+    mRampMasterVolume = masterVolume;
+}
+
+void Balance::processMonoBlend(const float *in, float *out, size_t frames, bool limit)
+{
+    if (mChannelCount < 2) {
+        if (in != out) {
+            memcpy(out, in, frames * mChannelCount * sizeof(float));
+        }
+        return;
+    }
+
+    const float recipdiv = 1.f / mChannelCount;
+    const bool limitStereo = limit && mChannelCount == 2;
+    // blends one input frame to the mono average (or limited stereo sum),
+    // matching the in-place mono_blend() computation.
+    const auto blend = [&](const float *frame) {
+        float accum = 0.f;
+        for (size_t j = 0; j < mChannelCount; ++j) {
+            accum += frame[j];
+        }
+        return limitStereo ? limiter(accum * M_SQRT1_2) : accum * recipdiv;
+    };
+
+    if (mRamp && mBalance != 0.f) {
+        if (mRampVolumes.size() != mVolumes.size()) {
+            // As in process(), ramping starts on the next call; the balance and
+            // volume state is saved and the non-ramping code below applies.
+            mRampBalance = mBalance;
+            mRampVolumes = mVolumes;
+        } else if (mRampBalance != mBalance) {
+            if (frames > 0) {
+                // blend to out first, then block ramp the balance volumes
+                // in-place over the blended data.
+                float *blended = out;
                 for (size_t i = 0; i < frames; ++i) {
-                    const float findex = i;
-                    for (size_t j = 0; j < mChannelCount; ++j) { // better precision: delta * i
-                        *buffer++ *= mRampVolumes[j] + mDeltas[j] * findex;
+                    const float accum = blend(in);
+                    for (size_t j = 0; j < mChannelCount; ++j) {
+                        *out++ = accum;
                     }
+                    in += mChannelCount;
                 }
+                mRampGenerator.setGains(mRampVolumes.data());
+                mRampGenerator.rampLinear(mVolumes.data(), frames);
+                mRampGenerator.process(blended, frames);
             }
             mRampBalance = mBalance;
             mRampVolumes = mVolumes;
@@ -109,11 +210,14 @@ void Balance::process(float *buffer, size_t frames)
         // fall through
     }
 
-    // non-ramped balance
+    // non-ramped balance; with a balance of 0.f mVolumes are unity
+    // and only the blend applies.
     for (size_t i = 0; i < frames; ++i) {
+        const float accum = blend(in);
         for (size_t j = 0; j < mChannelCount; ++j) {
-            *buffer++ *= mVolumes[j];
+            *out++ = accum * mVolumes[j];
         }
+        in += mChannelCount;
     }
 }
 
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <new>
+#include <vector>
+#include <audio_utils/clock.h>
+#include <audio_utils/EventJournal.h>
+
+namespace android::audio_utils {
+
+EventJournalWriter::EventJournalWriter(audio_utils_fifo_shm *shm)
+    : mShm(shm),
+      // throttleFront deliberately NULL: the journal writer never blocks on
+      // its reader; when the ring wraps, the reader accounts the loss.
+      mFifo(shm->frameCount(), shm->frameSize(), shm->buffer(), *shm->writerRear(),
+              NULL /*throttleFront*/),
+      mWriter(mFifo)
+{
+}
+
+int EventJournalWriter::create(uint32_t capacityEvents, EventJournalWriter **writer)
+{
+    if (writer == NULL) {
+        return -EINVAL;
+    }
+    *writer = NULL;
+    audio_utils_fifo_shm *shm;
+    const int err = audio_utils_fifo_shm::create(capacityEvents,
+            sizeof(event_journal_record), AUDIO_UTILS_FIFO_SHM_NONE, -1 /*numaNode*/, &shm);
+    if (err != 0) {
+        return err;
+    }
+    EventJournalWriter *object = new(std::nothrow) EventJournalWriter(shm);
+    if (object == NULL) {
+        delete shm;
+        return -ENOMEM;
+    }
+    *writer = object;
+    return 0;
+}
+
+void EventJournalWriter::log(uint32_t id, const void *payload, size_t size)
+{
+    event_journal_record record;
+    record.id = id;
+    record.sequence = mSequence++;
+    record.timeNs = audio_utils_get_monotonic_time_ns();
+    if (size > sizeof(record.payload)) {
+        size = sizeof(record.payload);
+    }
+    memset(record.payload, 0, sizeof(record.payload));
+    if (payload != NULL) {
+        memcpy(record.payload, payload, size);
+    }
+    // Without a throttle front the writer always has room, so this cannot
+    // block or fail; the oldest unread records are sacrificed instead.
+    (void) mWriter.write(&record, 1);
+}
+
+EventJournalReader::EventJournalReader(audio_utils_fifo_shm *shm)
+    : mShm(shm),
+      mFifo(shm->frameCount(), shm->frameSize(), shm->buffer(), *shm->writerRear(),
+              shm->throttleFront()),
+      // throttlesWriter true only to start reading from index zero and see
+      // records logged before we attached; the writer ignores the front index.
+      mReader(mFifo, true /*throttlesWriter*/, false /*flush*/)
+{
+}
+
+int EventJournalReader::attach(int fd, EventJournalReader **reader)
+{
+    if (reader == NULL) {
+        return -EINVAL;
+    }
+    *reader = NULL;
+    audio_utils_fifo_shm *shm;
+    int err = audio_utils_fifo_shm::attach(fd, &shm);
+    if (err != 0) {
+        return err;
+    }
+    if (shm->frameSize() != sizeof(event_journal_record)) {
+        delete shm;
+        return -EINVAL;
+    }
+    EventJournalReader *object = new(std::nothrow) EventJournalReader(shm);
+    if (object == NULL) {
+        delete shm;
+        return -ENOMEM;
+    }
+    *reader = object;
+    return 0;
+}
+
+ssize_t EventJournalReader::read(event_journal_record *records, size_t maxCount, size_t *lost)
+{
+    size_t totalLost = 0;
+    ssize_t actual = mReader.read(records, maxCount, NULL /*timeout*/, &totalLost);
+    if (actual == -EOVERFLOW) {
+        // the reader has now caught up with the writer; the still valid
+        // frames are readable on retry
+        size_t moreLost = 0;
+        actual = mReader.read(records, maxCount, NULL /*timeout*/, &moreLost);
+        totalLost += moreLost;
+    }
+    if (lost != NULL) {
+        *lost = totalLost;
+    }
+    return actual;
+}
+
+void dumpMergedEventJournals(int fd, EventJournalReader *const *readers,
+        const char *const *tags, size_t count)
+{
+    struct Entry {
+        event_journal_record record;
+        size_t journal;
+    };
+    std::vector<Entry> entries;
+    for (size_t i = 0; i < count; i++) {
+        char indexTag[32];
+        const char *tag = tags != NULL ? tags[i] : indexTag;
+        if (tags == NULL) {
+            (void) snprintf(indexTag, sizeof(indexTag), "#%zu", i);
+        }
+        size_t journalLost = 0;
+        for (;;) {
+            event_journal_record chunk[64];
+            size_t lost = 0;
+            const ssize_t actual = readers[i]->read(chunk, sizeof(chunk) / sizeof(chunk[0]),
+                    &lost);
+            journalLost += lost;
+            if (actual < 0) {
+                dprintf(fd, "journal %s: read error %zd\n", tag, actual);
+                break;
+            }
+            for (ssize_t j = 0; j < actual; j++) {
+                entries.push_back(Entry{chunk[j], i});
+            }
+            if ((size_t) actual < sizeof(chunk) / sizeof(chunk[0])) {
+                break;
+            }
+        }
+        if (journalLost > 0) {
+            dprintf(fd, "journal %s: lost %zu events to ring wrap\n", tag, journalLost);
+        }
+    }
+    // stable sort keeps a journal's equal-timestamp records in log order
+    std::stable_sort(entries.begin(), entries.end(),
+            [](const Entry &a, const Entry &b) { return a.record.timeNs < b.record.timeNs; });
+    for (const auto &entry : entries) {
+        char indexTag[32];
+        const char *tag;
+        if (tags != NULL) {
+            tag = tags[entry.journal];
+        } else {
+            (void) snprintf(indexTag, sizeof(indexTag), "#%zu", entry.journal);
+            tag = indexTag;
+        }
+        char hex[2 * kEventJournalPayloadSize + 1];
+        for (size_t i = 0; i < kEventJournalPayloadSize; i++) {
+            (void) snprintf(&hex[2 * i], 3, "%02x", entry.record.payload[i]);
+        }
+        dprintf(fd, "%14.6f %-12s id=0x%08x seq=%u payload=%s\n",
+                entry.record.timeNs * 1e-9, tag, entry.record.id, entry.record.sequence, hex);
+    }
+}
+
+}  // namespace android::audio_utils
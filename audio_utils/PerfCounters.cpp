@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include <audio_utils/PerfCounters.h>
+
+namespace android::audio_utils {
+
+// the fallback page when no shared region is attached
+static PerfCounterPage gDefaultPage = {
+        PerfCounterPage::kMagic, PerfCounterPage::kVersion, {}, {} };
+
+static std::atomic<PerfCounterPage*> gPage{&gDefaultPage};
+
+PerfCounterPage* perfCounterPage()
+{
+    return gPage.load(std::memory_order_relaxed);
+}
+
+bool perfCounterAttach(PerfCounterPage* page)
+{
+    if (page == nullptr) {
+        gPage.store(&gDefaultPage, std::memory_order_release);
+        return true;
+    }
+    if (page->magic == 0) {
+        // the atomics are lock-free and address-free, so zero fill is valid
+        memset(static_cast<void*>(page), 0, sizeof(*page));
+        page->version = PerfCounterPage::kVersion;
+        page->magic = PerfCounterPage::kMagic;  // stamped last
+    } else if (page->magic != PerfCounterPage::kMagic
+            || page->version != PerfCounterPage::kVersion) {
+        return false;
+    }
+    gPage.store(page, std::memory_order_release);
+    return true;
+}
+
+}  // namespace android::audio_utils
+
+using android::audio_utils::PerfCounterPage;
+using android::audio_utils::perfCounterPage;
+
+void audio_utils_perf_counter_add(unsigned slot, uint64_t amount)
+{
+    if (slot >= AUDIO_UTILS_PERF_COUNTER_COUNT) return;
+    perfCounterPage()->counters[slot].fetch_add(amount, std::memory_order_relaxed);
+}
+
+void audio_utils_perf_histogram_add(unsigned slot, int64_t value)
+{
+    if (slot >= AUDIO_UTILS_PERF_HISTOGRAM_COUNT) return;
+    // bin 0 for values <= 0, otherwise floor(log2(value)) + 1
+    const unsigned bin = value <= 0 ? 0 : 64 - __builtin_clzll((uint64_t)value);
+    PerfCounterPage::DurationHistogram& h = perfCounterPage()->histograms[slot];
+    h.bins[bin].fetch_add(1, std::memory_order_relaxed);
+    h.count.fetch_add(1, std::memory_order_relaxed);
+}
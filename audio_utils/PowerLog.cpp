@@ -19,15 +19,16 @@
 #include <log/log.h>
 
 #include <algorithm>
-#include <iomanip>
 #include <math.h>
-#include <sstream>
 #include <stdint.h>
+#include <string.h>
 #include <unistd.h>
 #include <vector>
 
 #include <audio_utils/clock.h>
 #include <audio_utils/LogPlot.h>
+#include <audio_utils/roundup.h>
+#include <audio_utils/string.h>
 #include <audio_utils/power.h>
 #include <audio_utils/PowerLog.h>
 
@@ -40,6 +41,13 @@ constexpr size_t array_size(const T(&)[N])
     return N;
 }
 
+// bound on one dump line (timestamp, brackets, maxColumns powers and the
+// sum annotation), excluding the caller's prefix
+constexpr size_t kMaxDumpLineLength = 128;
+// bound on the ASCII art graph: LogPlot is at most WIDTH_MAX plus margin
+// columns wide and HEIGHT plus axis lines tall
+constexpr size_t kMaxDumpPlotLength = 4096;
+
 PowerLog::PowerLog(uint32_t sampleRate,
         uint32_t channelCount,
         audio_format_t format,
@@ -47,6 +55,7 @@ PowerLog::PowerLog(uint32_t sampleRate,
         size_t framesPerEntry)
     : mCurrentTime(0)
     , mCurrentEnergy(0)
+    , mCurrentChannelEnergy(channelCount <= kMaxPrecomputeChannels ? channelCount : 0)
     , mCurrentFrames(0)
     , mIdx(0)
     , mConsecutiveZeroes(0)
@@ -55,6 +64,7 @@ PowerLog::PowerLog(uint32_t sampleRate,
     , mFormat(format)
     , mFramesPerEntry(framesPerEntry)
     , mEntries(entries)
+    , mChannelEnergies(entries * (channelCount <= kMaxPrecomputeChannels ? channelCount : 0))
 {
     (void)mSampleRate; // currently unused, for future use
     LOG_ALWAYS_FATAL_IF(!audio_utils_is_compute_power_format_supported(format),
@@ -63,9 +73,36 @@ PowerLog::PowerLog(uint32_t sampleRate,
 
 void PowerLog::log(const void *buffer, size_t frames, int64_t nowNs)
 {
+    // The energy computation is the expensive part of logging, so run the
+    // vectorized per-channel pass over the whole buffer before taking the
+    // lock.  The result is usable whenever the buffer stays within the
+    // current entry - the common case of buffers much smaller than an entry -
+    // otherwise we recompute per chunk below, holding the lock as before.
+    const bool perChannel = !mCurrentChannelEnergy.empty();
+    float bufferEnergy[kMaxPrecomputeChannels];
+    if (perChannel) {
+        audio_utils_compute_energy_peak(buffer, mFormat, frames, mChannelCount,
+                bufferEnergy, nullptr /* peak */);
+    }
+
     std::lock_guard<std::mutex> guard(mLock);
+    foldRealtimeEntries_l(); // keep wait-free entries in time order with ours
+
+    if (perChannel && mCurrentFrames + frames < mFramesPerEntry) {
+        // accumulate only, no entry completes.
+        if (mCurrentTime == 0) {
+            mCurrentTime = nowNs;
+        }
+        for (uint32_t ch = 0; ch < mChannelCount; ++ch) {
+            mCurrentChannelEnergy[ch] += bufferEnergy[ch];
+            mCurrentEnergy += bufferEnergy[ch];
+        }
+        mCurrentFrames += frames;
+        return;
+    }
 
     const size_t bytes_per_sample = audio_bytes_per_sample(mFormat);
+    const void *wholeBuffer = buffer; // bufferEnergy covers exactly this pointer and frames.
     while (frames > 0) {
         // check partial computation
         size_t required = mFramesPerEntry - mCurrentFrames;
@@ -74,8 +111,23 @@ void PowerLog::log(const void *buffer, size_t frames, int64_t nowNs)
         if (mCurrentTime == 0) {
             mCurrentTime = nowNs;
         }
-        mCurrentEnergy +=
-                audio_utils_compute_energy_mono(buffer, mFormat, process * mChannelCount);
+        if (perChannel) {
+            float chunkEnergy[kMaxPrecomputeChannels];
+            const float *energy = chunkEnergy;
+            if (buffer == wholeBuffer && process == frames) {
+                energy = bufferEnergy; // the out-of-lock pass covered this chunk exactly.
+            } else {
+                audio_utils_compute_energy_peak(buffer, mFormat, process, mChannelCount,
+                        chunkEnergy, nullptr /* peak */);
+            }
+            for (uint32_t ch = 0; ch < mChannelCount; ++ch) {
+                mCurrentChannelEnergy[ch] += energy[ch];
+                mCurrentEnergy += energy[ch];
+            }
+        } else {
+            mCurrentEnergy +=
+                    audio_utils_compute_energy_mono(buffer, mFormat, process * mChannelCount);
+        }
         mCurrentFrames += process;
 
         ALOGV("nowNs:%lld, required:%zu, process:%zu, mCurrentEnergy:%f, mCurrentFrames:%zu",
@@ -84,33 +136,246 @@ void PowerLog::log(const void *buffer, size_t frames, int64_t nowNs)
             return;
         }
 
-        // We store the data as normalized energy per sample. The energy sequence is
-        // zero terminated. Consecutive zeroes are ignored.
-        if (mCurrentEnergy == 0.f) {
-            if (mConsecutiveZeroes++ == 0) {
-                mEntries[mIdx++] = std::make_pair(nowNs, 0.f);
-                // zero terminate the signal sequence.
+        completeEntry_l(nowNs);
+        frames -= process;
+        buffer = (const uint8_t *)buffer + process * mChannelCount * bytes_per_sample;
+    }
+}
+
+void PowerLog::completeEntry_l(int64_t nowNs)
+{
+    const bool perChannel = !mCurrentChannelEnergy.empty();
+    // We store the data as normalized energy per sample. The energy sequence is
+    // zero terminated. Consecutive zeroes are ignored.
+    const size_t entryIdx = mIdx;
+    bool wrote = true;
+    if (mCurrentEnergy == 0.f) {
+        if (mConsecutiveZeroes++ == 0) {
+            mEntries[mIdx] = std::make_pair(nowNs, 0.f);
+            if (perChannel) {
+                std::fill_n(&mChannelEnergies[mIdx * mChannelCount], mChannelCount, 0.f);
             }
+            ++mIdx;
+            // zero terminate the signal sequence.
         } else {
-            mConsecutiveZeroes = 0;
-            mEntries[mIdx++] = std::make_pair(mCurrentTime, mCurrentEnergy);
-            ALOGV("writing %lld %f", (long long)mCurrentTime, mCurrentEnergy);
+            wrote = false;
         }
-        if (mIdx >= mEntries.size()) {
-            mIdx -= mEntries.size();
+    } else {
+        mConsecutiveZeroes = 0;
+        mEntries[mIdx] = std::make_pair(mCurrentTime, mCurrentEnergy);
+        if (perChannel) {
+            std::copy(mCurrentChannelEnergy.begin(), mCurrentChannelEnergy.end(),
+                    &mChannelEnergies[mIdx * mChannelCount]);
         }
-        mCurrentTime = 0;
-        mCurrentEnergy = 0;
-        mCurrentFrames = 0;
-        frames -= process;
-        buffer = (const uint8_t *)buffer + mCurrentFrames * mChannelCount * bytes_per_sample;
+        ++mIdx;
+        ALOGV("writing %lld %f", (long long)mCurrentTime, mCurrentEnergy);
+    }
+    if (mIdx >= mEntries.size()) {
+        mIdx -= mEntries.size();
+    }
+    if (wrote) {
+        publishEntry(entryIdx);
     }
+    mCurrentTime = 0;
+    mCurrentEnergy = 0;
+    std::fill(mCurrentChannelEnergy.begin(), mCurrentChannelEnergy.end(), 0.f);
+    mCurrentFrames = 0;
+}
+
+status_t PowerLog::enableRealtimeLog(size_t capacity)
+{
+    std::lock_guard<std::mutex> guard(mLock);
+    if (capacity == 0) {
+        capacity = kDefaultRealtimeEntries;
+    }
+    const size_t rounded = roundup(capacity);
+    std::unique_ptr<RealtimeEntry[]> ring(new(std::nothrow) RealtimeEntry[rounded]);
+    if (ring == nullptr) {
+        return NO_MEMORY;
+    }
+    mRealtimeRing = std::move(ring);
+    mRealtimeMask = rounded - 1;
+    mRealtimeRear.store(0, std::memory_order_relaxed);
+    mRealtimeFront.store(0, std::memory_order_relaxed);
+    mRealtimeOverruns.store(0, std::memory_order_relaxed);
+    return NO_ERROR;
+}
+
+void PowerLog::logRealtime(float energy, size_t frames, int64_t nowNs)
+{
+    static_assert(std::atomic<uint32_t>::is_always_lock_free,
+            "the ring sequence must be lock-free for the wait-free producer");
+    if (mRealtimeRing == nullptr || frames == 0) {
+        return;
+    }
+    const uint32_t rear = mRealtimeRear.load(std::memory_order_relaxed);
+    if (rear - mRealtimeFront.load(std::memory_order_acquire) > mRealtimeMask) {
+        // ring full: drop and count rather than block or take a lock.
+        mRealtimeOverruns.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    RealtimeEntry &entry = mRealtimeRing[rear & mRealtimeMask];
+    entry.timeNs = nowNs;
+    entry.energy = energy;
+    entry.frames = (uint32_t)std::min(frames, (size_t)UINT32_MAX);
+    mRealtimeRear.store(rear + 1, std::memory_order_release); // publish
+}
+
+void PowerLog::foldRealtimeEntries()
+{
+    std::lock_guard<std::mutex> guard(mLock);
+    foldRealtimeEntries_l();
+}
+
+void PowerLog::foldRealtimeEntries_l()
+{
+    if (mRealtimeRing == nullptr) {
+        return;
+    }
+    uint32_t front = mRealtimeFront.load(std::memory_order_relaxed);
+    const uint32_t rear = mRealtimeRear.load(std::memory_order_acquire);
+    for (; front != rear; ++front) {
+        const RealtimeEntry &entry = mRealtimeRing[front & mRealtimeMask];
+        // Distribute the entry's energy evenly over its frames and accumulate
+        // into the current bin, completing bins exactly as log() does.
+        size_t frames = entry.frames;
+        const float energyPerFrame = entry.energy / frames;
+        while (frames > 0) {
+            const size_t required = mFramesPerEntry - mCurrentFrames;
+            const size_t process = std::min(required, frames);
+            if (mCurrentTime == 0) {
+                mCurrentTime = entry.timeNs;
+            }
+            mCurrentEnergy += energyPerFrame * process;
+            mCurrentFrames += process;
+            if (process < required) {
+                break;
+            }
+            completeEntry_l(entry.timeNs);
+            frames -= process;
+        }
+        // release the slot to the producer entry by entry.
+        mRealtimeFront.store(front + 1, std::memory_order_release);
+    }
+}
+
+uint32_t PowerLog::realtimeOverruns() const
+{
+    return mRealtimeOverruns.load(std::memory_order_relaxed);
+}
+
+std::vector<float> PowerLog::channelEnergies(size_t *idx)
+{
+    std::lock_guard<std::mutex> guard(mLock);
+    foldRealtimeEntries_l();
+    if (idx != nullptr) {
+        *idx = mIdx;
+    }
+    if (mCurrentChannelEnergy.empty()) {
+        // summed only: report zeroes of the full expected extent.
+        return std::vector<float>(mEntries.size() * mChannelCount);
+    }
+    return mChannelEnergies;
+}
+
+status_t PowerLog::setSharedRegion(void *shared, size_t size)
+{
+    static_assert(std::atomic<uint32_t>::is_always_lock_free,
+            "the shared sequence must be lock-free across processes");
+
+    std::lock_guard<std::mutex> guard(mLock);
+    if (shared == nullptr) {
+        mShared = nullptr;
+        return NO_ERROR;
+    }
+    if (size < sharedSize(mEntries.size())) {
+        return BAD_VALUE;
+    }
+    SharedHeader *header = static_cast<SharedHeader *>(shared);
+    // odd sequence: observers treat the region as mid-update while we fill it.
+    header->sequence.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    header->version = kSharedVersion;
+    header->entries = mEntries.size();
+    header->idx = mIdx;
+    header->sampleRate = mSampleRate;
+    header->channelCount = mChannelCount;
+    header->format = mFormat;
+    header->framesPerEntry = mFramesPerEntry;
+    SharedEntry *entries = sharedEntries(header);
+    for (size_t i = 0; i < mEntries.size(); ++i) {
+        entries[i].timeNs = mEntries[i].first;
+        entries[i].energy = mEntries[i].second;
+        entries[i].reserved = 0.f;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    header->sequence.store(2, std::memory_order_release);
+    mShared = header;
+    return NO_ERROR;
+}
+
+void PowerLog::publishEntry(size_t entryIdx)
+{
+    if (mShared == nullptr) {
+        return;
+    }
+    // single-writer seqlock: odd sequence while the entry and index update.
+    const uint32_t sequence = mShared->sequence.load(std::memory_order_relaxed);
+    mShared->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    SharedEntry &entry = sharedEntries(mShared)[entryIdx];
+    entry.timeNs = mEntries[entryIdx].first;
+    entry.energy = mEntries[entryIdx].second;
+    mShared->idx = mIdx;
+    std::atomic_thread_fence(std::memory_order_release);
+    mShared->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+/* static */
+bool PowerLog::readSharedRegion(const void *shared, size_t size,
+        std::vector<std::pair<int64_t, float>> *entries, size_t *idx)
+{
+    if (shared == nullptr || entries == nullptr || idx == nullptr
+            || size < sizeof(SharedHeader)) {
+        return false;
+    }
+    const SharedHeader *header = static_cast<const SharedHeader *>(shared);
+    constexpr int kMaxRetries = 100;
+    for (int retry = 0; retry < kMaxRetries; ++retry) {
+        const uint32_t sequence = header->sequence.load(std::memory_order_acquire);
+        if (sequence & 1) {
+            continue; // writer mid-update
+        }
+        if (header->version != kSharedVersion) {
+            return false;
+        }
+        const uint32_t numberOfEntries = header->entries;
+        if (numberOfEntries == 0 || size < sharedSize(numberOfEntries)) {
+            return false;
+        }
+        const size_t snapshotIdx = header->idx;
+        entries->clear();
+        entries->reserve(numberOfEntries);
+        const SharedEntry *sharedEntry =
+                reinterpret_cast<const SharedEntry *>(header + 1);
+        for (uint32_t i = 0; i < numberOfEntries; ++i) {
+            entries->emplace_back(sharedEntry[i].timeNs, sharedEntry[i].energy);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (header->sequence.load(std::memory_order_relaxed) == sequence
+                && snapshotIdx < numberOfEntries) {
+            *idx = snapshotIdx;
+            return true;
+        }
+    }
+    return false; // never caught the writer at rest.
 }
 
 std::string PowerLog::dumpToString(
-        const char *prefix, size_t lines, int64_t limitNs, bool logPlot) const
+        const char *prefix, size_t lines, int64_t limitNs, bool logPlot)
 {
     std::lock_guard<std::mutex> guard(mLock);
+    foldRealtimeEntries_l(); // pending wait-free entries must appear in the dump
 
     const size_t maxColumns = 10;
     const size_t numberOfEntries = mEntries.size();
@@ -162,22 +427,27 @@ std::string PowerLog::dumpToString(
     if (offset > 0) {
         --offset;
     }
-    // We accumulate the log info into a string, and write to the fd once.
-    std::stringstream ss;
-    ss << std::fixed << std::setprecision(1);
-    // ss << std::scientific;
+    // We accumulate the log info into a fixed-capacity buffer sized from the
+    // line count found above, and write to the fd once; a dump during
+    // bugreport collection must not reallocate while audio threads run.
+    // the per-channel annotation adds up to 8 characters per channel per line.
+    const bool perChannel = !mChannelEnergies.empty() && mChannelCount > 1;
+    audio_utils::dump_buffer<> buf((count + 2)
+            * (strlen(prefix) + kMaxDumpLineLength + (perChannel ? mChannelCount * 8 : 0))
+            + (logPlot ? kMaxDumpPlotLength : 0));
     if (nonzeros == 0) {
-        ss << prefix << "Signal power history: (none)\n";
+        buf.appendf("%sSignal power history: (none)\n", prefix);
     } else {
         // First value is power, second value is whether value is start of
         // a new time stamp.
         std::vector<std::pair<float, bool>> plotEntries;
-        ss << prefix << "Signal power history:\n";
+        buf.appendf("%sSignal power history:\n", prefix);
 
         size_t column = 0;
         bool first = true;
         bool start = false;
         float cumulative = 0.f;
+        std::vector<float> cumulativeChannel(perChannel ? mChannelCount : 0);
         for (; offset >= 0; --offset) {
             const size_t idx = (mIdx + numberOfEntries - offset - 1) % numberOfEntries;
             const int64_t time = mEntries[idx].first;
@@ -185,7 +455,20 @@ std::string PowerLog::dumpToString(
 
             if (energy == 0.f) {
                 if (!first) {
-                    ss << " ] sum(" << audio_utils_power_from_energy(cumulative) << ")";
+                    buf.append(" ] sum(")
+                            .append_fixed(audio_utils_power_from_energy(cumulative), 1)
+                            .append(")");
+                    if (perChannel) {
+                        // per-channel signal power, exposing channel imbalance.
+                        buf.append(" ch(");
+                        for (uint32_t ch = 0; ch < mChannelCount; ++ch) {
+                            if (ch != 0) buf.append(" ");
+                            buf.append_fixed(
+                                    audio_utils_power_from_energy(cumulativeChannel[ch]), 1);
+                            cumulativeChannel[ch] = 0.f;
+                        }
+                        buf.append(")");
+                    }
                     // Add an entry to denote the start of a new time stamp series.
                     if (!plotEntries.empty()) {
                         // First value should be between min and max of all graph entries
@@ -200,40 +483,46 @@ std::string PowerLog::dumpToString(
             }
             if (column == 0) {
                 // print time if at start of column
-                if (!first) {
-                    ss << "\n";
-                }
-                ss << prefix << " " << audio_utils_time_string_from_ns(time).time
-                        << (start ? ": [ ": ":   ");
+                buf.appendf("%s%s %s%s", first ? "" : "\n", prefix,
+                        audio_utils_time_string_from_ns(time).time,
+                        start ? ": [ " : ":   ");
                 first = false;
                 start = false;
             }  else {
-                ss << " ";
+                buf.append(" ");
             }
             if (++column >= maxColumns) {
                 column = 0;
             }
 
             cumulative += energy;
+            if (perChannel) {
+                for (uint32_t ch = 0; ch < mChannelCount; ++ch) {
+                    cumulativeChannel[ch] += mChannelEnergies[idx * mChannelCount + ch];
+                }
+            }
             // convert energy to power and print
             const float power =
                     audio_utils_power_from_energy(energy / (mChannelCount * mFramesPerEntry));
-            ss << std::setw(6) << power;
+            buf.append_fixed(power, 1, 6);  // the direct formatter dominates this loop
             ALOGV("state: %d %lld %f", state, (long long)time, power);
             // Add an entry to the ASCII art power log graph.
             // false indicates the value doesn't have a new series time stamp.
             plotEntries.emplace_back(power, false);
         }
         if (logPlot) {
-            ss << "\n" << audio_utils_log_plot(plotEntries.begin(), plotEntries.end());
+            // the plot helper still builds a std::string; append it in one piece
+            const std::string plot = audio_utils_log_plot(plotEntries.begin(), plotEntries.end());
+            buf.append("\n");
+            buf.appendn(plot.c_str(), plot.size());
         }
-        ss << "\n";
+        buf.append("\n");
     }
-    return ss.str();
+    return {buf.c_str(), buf.size()};
 }
 
 status_t PowerLog::dump(
-        int fd, const char *prefix, size_t lines, int64_t limitNs, bool logPlot) const
+        int fd, const char *prefix, size_t lines, int64_t limitNs, bool logPlot)
 {
     // Since dumpToString and write are thread safe, this function
     // is conceptually thread-safe but simultaneous calls to dump
@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <math.h>
+
+#include <audio_utils/RampGenerator.h>
+
+namespace android::audio_utils {
+
+namespace {
+
+// Fixed channel count gain loops: with channelCount a compile time constant
+// the inner channel loop unrolls and the frame loop vectorizes.
+template <size_t channelCount>
+void applyGainsFixed(float *buffer, size_t frames, const float *gains) {
+    for (size_t i = 0; i < frames; ++i) {
+        for (size_t j = 0; j < channelCount; ++j) {
+            buffer[j] *= gains[j];
+        }
+        buffer += channelCount;
+    }
+}
+
+} // namespace
+
+void RampGenerator::applyGains(
+        float *buffer, size_t frames, const float *gains, size_t channelCount)
+{
+    switch (channelCount) {
+    case 1:
+        applyGainsFixed<1>(buffer, frames, gains);
+        return;
+    case 2:
+        applyGainsFixed<2>(buffer, frames, gains);
+        return;
+    case 4:
+        applyGainsFixed<4>(buffer, frames, gains);
+        return;
+    case 6:
+        applyGainsFixed<6>(buffer, frames, gains);
+        return;
+    case 8:
+        applyGainsFixed<8>(buffer, frames, gains);
+        return;
+    default:
+        break;
+    }
+    for (size_t i = 0; i < frames; ++i) {
+        for (size_t j = 0; j < channelCount; ++j) {
+            *buffer++ *= gains[j];
+        }
+    }
+}
+
+void RampGenerator::setChannelCount(size_t channelCount)
+{
+    mChannelCount = channelCount;
+    mGains.assign(channelCount, 1.f);
+    mStartGains.resize(channelCount);
+    mTargets.resize(channelCount);
+    mScratch.resize(channelCount);
+    mState = RAMP_NONE;
+}
+
+void RampGenerator::setGains(const float *gains)
+{
+    std::copy(gains, gains + mChannelCount, mGains.begin());
+    mState = RAMP_NONE;
+}
+
+void RampGenerator::setGain(float gain)
+{
+    std::fill(mGains.begin(), mGains.end(), gain);
+    mState = RAMP_NONE;
+}
+
+void RampGenerator::rampLinear(const float *targets, size_t rampFrames)
+{
+    std::copy(targets, targets + mChannelCount, mTargets.begin());
+    if (rampFrames == 0) {
+        mGains = mTargets;
+        mState = RAMP_NONE;
+        return;
+    }
+    mStartGains = mGains;
+    mRampFrames = rampFrames;
+    mFrame = 0;
+    mState = RAMP_LINEAR;
+}
+
+void RampGenerator::rampLinear(float target, size_t rampFrames)
+{
+    std::fill(mScratch.begin(), mScratch.end(), target);
+    rampLinear(mScratch.data(), rampFrames);
+}
+
+void RampGenerator::rampExponential(const float *targets, float timeConstantFrames)
+{
+    std::copy(targets, targets + mChannelCount, mTargets.begin());
+    if (!(timeConstantFrames > 0.f)) { // also catches NaN.
+        mGains = mTargets;
+        mState = RAMP_NONE;
+        return;
+    }
+    mAlpha = 1.f - expf(-1.f / timeConstantFrames);
+    mState = RAMP_EXPONENTIAL;
+}
+
+void RampGenerator::rampExponential(float target, float timeConstantFrames)
+{
+    std::fill(mScratch.begin(), mScratch.end(), target);
+    rampExponential(mScratch.data(), timeConstantFrames);
+}
+
+void RampGenerator::advance(size_t frames)
+{
+    switch (mState) {
+    case RAMP_NONE:
+        return;
+    case RAMP_LINEAR:
+        mFrame += frames;
+        if (mFrame >= mRampFrames) {
+            mGains = mTargets;
+            mState = RAMP_NONE;
+            return;
+        }
+        {
+            const float frac = (float)mFrame / mRampFrames;
+            for (size_t j = 0; j < mChannelCount; ++j) {
+                mGains[j] = mStartGains[j] + (mTargets[j] - mStartGains[j]) * frac;
+            }
+        }
+        return;
+    case RAMP_EXPONENTIAL: {
+        // the remaining distance decays by (1 - alpha) every frame.
+        const float factor = powf(1.f - mAlpha, (float)frames);
+        float error = 0.f;
+        for (size_t j = 0; j < mChannelCount; ++j) {
+            mGains[j] = mTargets[j] + (mGains[j] - mTargets[j]) * factor;
+            error = std::max(error, fabsf(mGains[j] - mTargets[j]));
+        }
+        if (error <= kRampEpsilon) {
+            mGains = mTargets;
+            mState = RAMP_NONE;
+        }
+        return;
+    }
+    }
+}
+
+void RampGenerator::fill(float *gains, size_t frames)
+{
+    if (mChannelCount == 0) {
+        return;
+    }
+    size_t i = 0;
+    if (mState == RAMP_LINEAR) {
+        const float r = 1.f / mRampFrames;
+        const size_t rampFrames = std::min(frames, mRampFrames - mFrame);
+        for (; i < rampFrames; ++i) {
+            const float frac = (mFrame + i) * r; // better precision: delta * i
+            for (size_t j = 0; j < mChannelCount; ++j) {
+                *gains++ = mStartGains[j] + (mTargets[j] - mStartGains[j]) * frac;
+            }
+        }
+        advance(rampFrames);
+    } else if (mState == RAMP_EXPONENTIAL) {
+        const float oneMinusAlpha = 1.f - mAlpha;
+        for (; i < frames && mState == RAMP_EXPONENTIAL; ++i) {
+            float error = 0.f;
+            for (size_t j = 0; j < mChannelCount; ++j) {
+                *gains++ = mGains[j];
+                mGains[j] = mTargets[j] + (mGains[j] - mTargets[j]) * oneMinusAlpha;
+                error = std::max(error, fabsf(mGains[j] - mTargets[j]));
+            }
+            if (error <= kRampEpsilon) {
+                mGains = mTargets;
+                mState = RAMP_NONE;
+            }
+        }
+    }
+    // settled gains for the remainder.
+    for (; i < frames; ++i) {
+        for (size_t j = 0; j < mChannelCount; ++j) {
+            *gains++ = mGains[j];
+        }
+    }
+}
+
+void RampGenerator::process(float *buffer, size_t frames)
+{
+    if (mChannelCount == 0) {
+        return;
+    }
+    size_t i = 0;
+    // Block ramp: the gains are constant over kRampBlockFrames frames
+    // so applyGains() vectorizes, and step toward the target over the buffer.
+    while (i < frames && mState != RAMP_NONE) {
+        const size_t blockFrames = std::min(kRampBlockFrames, frames - i);
+        applyGains(buffer, blockFrames, mGains.data(), mChannelCount);
+        buffer += blockFrames * mChannelCount;
+        advance(blockFrames);
+        i += blockFrames;
+    }
+    if (i < frames) {
+        applyGains(buffer, frames - i, mGains.data(), mChannelCount);
+    }
+}
+
+} // namespace android::audio_utils
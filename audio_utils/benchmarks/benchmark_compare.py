@@ -0,0 +1,211 @@
+#!/usr/bin/env python3
+
+#
+# Copyright (C) 2026 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+"""
+Gate libaudioutils benchmark results against a recorded baseline.
+
+The benchmarks in this directory emit machine-readable results natively:
+
+  benchmark --benchmark_format=json --benchmark_out=results.json
+
+This tool distills such a JSON file into a compact baseline and compares a
+later run against it, exiting nonzero when any benchmark regressed by more
+than the threshold, so perf CI can gate rather than observe.
+
+Usage:
+  benchmark_compare.py baseline results.json [-o baseline.json]
+  - records the median real_time and items_per_second of each benchmark
+
+  benchmark_compare.py compare baseline.json results.json [--threshold PCT]
+  - exits 1 if any benchmark's real_time regressed by more than PCT percent
+    (default 5) or its items_per_second dropped by more than PCT percent
+
+  benchmark_compare.py summary results.json [-o table.txt]
+  - writes a fixed-width per-benchmark table of real_time, items_per_second
+    and bytes_per_second (for benchmarks reporting memory traffic, e.g. the
+    channelmix coverage matrix), suitable as a build artifact
+
+Only entries with run_type "iteration" (or no run_type, for older benchmark
+libraries) are considered; aggregates, complexity fits and errored runs are
+skipped.  Repeated runs of the same benchmark name are reduced to the median,
+so --benchmark_repetitions can be used to stabilize either side.
+"""
+
+import argparse
+import json
+import statistics
+import sys
+
+
+def load_runs(path):
+  """Returns {name: {"real_time": ns, "items_per_second": float or None}}
+  with repeated runs of a name reduced to their median."""
+  with open(path) as f:
+    doc = json.load(f)
+  times = {}
+  items = {}
+  for run in doc.get("benchmarks", []):
+    if run.get("run_type", "iteration") != "iteration":
+      continue
+    if "error_occurred" in run:
+      continue
+    name = run["name"]
+    times.setdefault(name, []).append(float(run["real_time"]))
+    ips = run.get("items_per_second")
+    if ips is not None:
+      items.setdefault(name, []).append(float(ips))
+  runs = {}
+  for name, ts in times.items():
+    runs[name] = {
+        "real_time": statistics.median(ts),
+        "items_per_second":
+            statistics.median(items[name]) if name in items else None,
+    }
+  return runs
+
+
+def cmd_baseline(args):
+  runs = load_runs(args.results)
+  if not runs:
+    print("error: no benchmark iterations in %s" % args.results,
+          file=sys.stderr)
+    return 1
+  out = {"benchmarks": runs}
+  if args.output:
+    with open(args.output, "w") as f:
+      json.dump(out, f, indent=2, sort_keys=True)
+      f.write("\n")
+  else:
+    json.dump(out, sys.stdout, indent=2, sort_keys=True)
+    print()
+  return 0
+
+
+def cmd_compare(args):
+  with open(args.baseline) as f:
+    baseline = json.load(f)["benchmarks"]
+  current = load_runs(args.results)
+  threshold = args.threshold / 100.0
+  regressions = []
+  missing = []
+  for name, base in sorted(baseline.items()):
+    cur = current.get(name)
+    if cur is None:
+      missing.append(name)
+      continue
+    base_t = base["real_time"]
+    ratio = cur["real_time"] / base_t if base_t > 0 else 1.0
+    if ratio > 1.0 + threshold:
+      regressions.append("%s: real_time %+.1f%% (%.0f -> %.0f ns)" % (
+          name, (ratio - 1.0) * 100.0, base_t, cur["real_time"]))
+    base_ips = base.get("items_per_second")
+    cur_ips = cur.get("items_per_second")
+    if base_ips and cur_ips and cur_ips < base_ips * (1.0 - threshold):
+      regressions.append("%s: items_per_second %+.1f%% (%.3g -> %.3g)" % (
+          name, (cur_ips / base_ips - 1.0) * 100.0, base_ips, cur_ips))
+  for name in missing:
+    print("warning: %s in baseline but not in results" % name,
+          file=sys.stderr)
+  if regressions:
+    print("%d regression(s) beyond %.1f%%:" % (len(regressions),
+                                               args.threshold))
+    for line in regressions:
+      print("  " + line)
+    return 1
+  print("no regressions beyond %.1f%% in %d benchmark(s)" % (
+      args.threshold, len(baseline)))
+  return 0
+
+
+def cmd_summary(args):
+  with open(args.results) as f:
+    doc = json.load(f)
+  runs = {}
+  for run in doc.get("benchmarks", []):
+    if run.get("run_type", "iteration") != "iteration":
+      continue
+    if "error_occurred" in run:
+      continue
+    r = runs.setdefault(run["name"], {
+        "label": run.get("label", ""),
+        "real_time": [],
+        "items_per_second": [],
+        "bytes_per_second": [],
+    })
+    r["real_time"].append(float(run["real_time"]))
+    for key in ("items_per_second", "bytes_per_second"):
+      value = run.get(key)
+      if value is not None:
+        r[key].append(float(value))
+  if not runs:
+    print("error: no benchmark iterations in %s" % args.results,
+          file=sys.stderr)
+    return 1
+
+  def median_or_dash(values, scale, fmt):
+    return fmt % (statistics.median(values) / scale) if values else "-"
+
+  lines = ["%-28s %12s %12s %12s  %s" % (
+      "benchmark", "time_ns", "Mitems/s", "MB/s", "label")]
+  for name, r in sorted(runs.items()):
+    lines.append("%-28s %12.0f %12s %12s  %s" % (
+        name,
+        statistics.median(r["real_time"]),
+        median_or_dash(r["items_per_second"], 1e6, "%.3f"),
+        median_or_dash(r["bytes_per_second"], 2 ** 20, "%.1f"),
+        r["label"]))
+  table = "\n".join(lines) + "\n"
+  if args.output:
+    with open(args.output, "w") as f:
+      f.write(table)
+  else:
+    sys.stdout.write(table)
+  return 0
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__,
+      formatter_class=argparse.RawDescriptionHelpFormatter)
+  sub = parser.add_subparsers(dest="command", required=True)
+
+  p = sub.add_parser("baseline",
+      help="distill a benchmark JSON file into a baseline")
+  p.add_argument("results", help="JSON from --benchmark_out")
+  p.add_argument("-o", "--output", help="baseline file (default stdout)")
+  p.set_defaults(func=cmd_baseline)
+
+  p = sub.add_parser("compare",
+      help="compare a benchmark JSON file against a baseline")
+  p.add_argument("baseline", help="baseline produced by the baseline command")
+  p.add_argument("results", help="JSON from --benchmark_out")
+  p.add_argument("--threshold", type=float, default=5.0,
+      help="allowed regression in percent (default %(default)s)")
+  p.set_defaults(func=cmd_compare)
+
+  p = sub.add_parser("summary",
+      help="write a per-benchmark summary table from a JSON file")
+  p.add_argument("results", help="JSON from --benchmark_out")
+  p.add_argument("-o", "--output", help="table file (default stdout)")
+  p.set_defaults(func=cmd_summary)
+
+  args = parser.parse_args()
+  sys.exit(args.func(args))
+
+
+if __name__ == "__main__":
+  main()
@@ -0,0 +1,174 @@
+/*
+ * Copyright 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_BENCHMARK_PERF_EVENTS_H
+#define ANDROID_AUDIO_BENCHMARK_PERF_EVENTS_H
+
+/*
+ * Optional hardware perf counters for benchmarks, via perf_event_open(2).
+ *
+ * Wall time alone cannot tell whether a kernel variant is compute- or
+ * memory-bound; instructions, cache misses and stalled cycles per processed
+ * item can.  Wrap the timed loop with start()/stop() and call report() to
+ * attach the per-item counts to the benchmark state as user counters.
+ *
+ * Counters the kernel or PMU does not support are simply absent from the
+ * output, and when perf_event_open is denied entirely (perf_event_paranoid,
+ * seccomp, no PMU) the whole object degrades to a no-op, so benchmarks run
+ * unchanged on devices without counter access.
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+class PerfEventCounters {
+public:
+    PerfEventCounters() {
+#if defined(__linux__)
+        openCounter("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        openCounter("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        openCounter("stalled_cycles", PERF_TYPE_HARDWARE,
+                PERF_COUNT_HW_STALLED_CYCLES_BACKEND);
+        openCounter("L1d_miss", PERF_TYPE_HW_CACHE,
+                PERF_COUNT_HW_CACHE_L1D
+                        | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                        | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+        // the last cache level before memory, the usual proxy for "L2/L3 miss"
+        openCounter("LL_miss", PERF_TYPE_HW_CACHE,
+                PERF_COUNT_HW_CACHE_LL
+                        | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                        | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+#endif
+    }
+
+    ~PerfEventCounters() {
+#if defined(__linux__)
+        for (const Counter& counter : mCounters) {
+            (void) close(counter.fd);
+        }
+#endif
+    }
+
+    PerfEventCounters(const PerfEventCounters&) = delete;
+    PerfEventCounters& operator=(const PerfEventCounters&) = delete;
+
+    /** Whether at least one hardware counter could be opened. */
+    bool available() const { return !mCounters.empty(); }
+
+    /** Reset and enable all counters.  Call immediately before the timed loop. */
+    void start() {
+#if defined(__linux__)
+        for (const Counter& counter : mCounters) {
+            (void) ioctl(counter.fd, PERF_EVENT_IOC_RESET, 0);
+            (void) ioctl(counter.fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    /** Disable all counters.  Call immediately after the timed loop. */
+    void stop() {
+#if defined(__linux__)
+        for (const Counter& counter : mCounters) {
+            (void) ioctl(counter.fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+#endif
+    }
+
+    /**
+     * Attach the counts between the last start() and stop() to the benchmark
+     * state, normalized per processed item, plus the backend stall fraction
+     * and instructions per cycle when both inputs are available.
+     *
+     * \param state the benchmark being reported
+     * \param items total items processed between start() and stop(), > 0
+     */
+    void report(benchmark::State& state, uint64_t items) const {
+#if defined(__linux__)
+        if (items == 0) {
+            return;
+        }
+        uint64_t instructions = 0;
+        uint64_t cycles = 0;
+        uint64_t stalled = 0;
+        for (const Counter& counter : mCounters) {
+            uint64_t value = 0;
+            if (read(counter.fd, &value, sizeof(value)) != (ssize_t) sizeof(value)) {
+                continue;
+            }
+            state.counters[counter.name + "/item"] =
+                    benchmark::Counter((double) value / items);
+            if (counter.name == "instructions") {
+                instructions = value;
+            } else if (counter.name == "cycles") {
+                cycles = value;
+            } else if (counter.name == "stalled_cycles") {
+                stalled = value;
+            }
+        }
+        if (cycles > 0) {
+            if (instructions > 0) {
+                state.counters["IPC"] = benchmark::Counter((double) instructions / cycles);
+            }
+            if (stalled > 0) {
+                state.counters["stall_frac"] = benchmark::Counter((double) stalled / cycles);
+            }
+        }
+#else
+        (void) state;
+        (void) items;
+#endif
+    }
+
+private:
+#if defined(__linux__)
+    struct Counter {
+        std::string name;
+        int fd;
+    };
+
+    void openCounter(const char *name, uint32_t type, uint64_t config) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        const int fd = (int) syscall(__NR_perf_event_open, &attr,
+                0 /* this thread */, -1 /* any cpu */, -1 /* no group */, 0 /* flags */);
+        if (fd >= 0) {
+            mCounters.push_back({name, fd});
+        }
+        // unsupported or denied counters are silently absent from the report
+    }
+
+    std::vector<Counter> mCounters;
+#endif
+};
+
+#endif  // !ANDROID_AUDIO_BENCHMARK_PERF_EVENTS_H
@@ -74,6 +74,7 @@ static void BM_BiquadFilter1D(benchmark::State& state) {
         }
         benchmark::ClobberMemory();
     }
+    state.SetItemsProcessed(state.iterations() * DATA_SIZE);
 }
 
 static void BiquadFilter1DArgs(benchmark::internal::Benchmark* b) {
@@ -448,6 +449,7 @@ static void BM_BiquadFilter(benchmark::State& state, bool optimized) {
         biquadFilter.process(output.data(), input.data(), DATA_SIZE);
         benchmark::ClobberMemory();
     }
+    state.SetItemsProcessed(state.iterations() * DATA_SIZE);
     state.SetComplexityN(state.range(1));  // O(channelCount)
 }
 
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <audio_utils/BiquadFilter.h>
+#include <audio_utils/Pipeline.h>
+#include <audio_utils/cache_topology.h>
+#include <audio_utils/format.h>
+
+#include <sstream>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+static constexpr size_t kChannels = 2;
+static constexpr size_t kFrames = 96 * 1024;  // ~1 s at 96 kHz, larger than L2
+
+/*
+ * Sweeps the Pipeline tile size over a conversion + biquad chain on a
+ * buffer much larger than L2, to validate on target what
+ * audio_utils_recommend_tile_frames() advises: throughput should peak
+ * around the advisory and fall off once the working set spills a level.
+ * The advisory for this chain is shown in each label.
+ */
+static void BM_CacheTileSweep(benchmark::State& state) {
+    const size_t tileFrames = state.range(0);
+    using android::audio_utils::BiquadFilter;
+    using android::audio_utils::kBiquadNumCoefs;
+
+    std::vector<int16_t> in(kFrames * kChannels);
+    for (size_t i = 0; i < in.size(); ++i) {
+        in[i] = (int16_t)(i * 13 + 1);
+    }
+    std::vector<float> out(kFrames * kChannels);
+    const std::array<float, kBiquadNumCoefs> coefs{
+            0.25f, 0.5f, 0.25f, 0.1f, 0.05f };
+    BiquadFilter<float> filter(kChannels, coefs);
+
+    auto convert = [](void *dst, const void *src, size_t frames) {
+        memcpy_by_audio_format(dst, AUDIO_FORMAT_PCM_FLOAT,
+                src, AUDIO_FORMAT_PCM_16_BIT, frames * kChannels);
+    };
+    auto biquad = [&filter](void *dst, const void *src, size_t frames) {
+        filter.process((float *)dst, (const float *)src, frames);
+    };
+    android::audio_utils::Pipeline<decltype(convert), decltype(biquad)> pipeline(
+            tileFrames,
+            sizeof(int16_t) * kChannels,
+            sizeof(float) * kChannels,
+            sizeof(float) * kChannels,
+            convert, biquad);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(in.data());
+        benchmark::DoNotOptimize(out.data());
+        pipeline.process(out.data(), in.data(), kFrames);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(
+            state.iterations() * kFrames * sizeof(float) * kChannels);
+    // chain working set per tile: input, intermediate, output
+    std::ostringstream label;
+    label << "advisory="
+            << audio_utils_recommend_tile_frames(sizeof(float) * kChannels, 3);
+    state.SetLabel(label.str());
+}
+
+BENCHMARK(BM_CacheTileSweep)->RangeMultiplier(2)->Range(64, 16384);
+
+BENCHMARK_MAIN();
@@ -17,6 +17,7 @@
 #include <audio_utils/ChannelMix.h>
 
 #include <random>
+#include <string>
 #include <vector>
 
 #include <benchmark/benchmark.h>
@@ -48,44 +49,38 @@ static constexpr audio_channel_mask_t kChannelPositionMasks[] = {
 };
 
 /*
-$ adb shell /data/benchmarktest64/channelmix_benchmark/channelmix_benchmark
-Pixel 4XL Coral arm64 benchmark
+The full (input mask, output mask) coverage matrix with replace and
+accumulate variants is large, so measured tables are not embedded here;
+produce the per-pair summary artifact with:
 
------------------------------------------------------------
-Benchmark                 Time             CPU   Iterations
------------------------------------------------------------
-BM_ChannelMix/0        2180 ns         2175 ns       321797 AUDIO_CHANNEL_OUT_MONO
-BM_ChannelMix/1        2180 ns         2175 ns       321901
-BM_ChannelMix/2        3265 ns         3256 ns       214957 AUDIO_CHANNEL_OUT_STEREO
-BM_ChannelMix/3        3987 ns         3978 ns       175964 AUDIO_CHANNEL_OUT_2POINT1
-BM_ChannelMix/4        4713 ns         4700 ns       148922 AUDIO_CHANNEL_OUT_2POINT0POINT2
-BM_ChannelMix/5        1050 ns         1047 ns       668462 AUDIO_CHANNEL_OUT_QUAD
-BM_ChannelMix/6        1052 ns         1049 ns       667155 AUDIO_CHANNEL_OUT_QUAD_SIDE
-BM_ChannelMix/7        4714 ns         4701 ns       148926 AUDIO_CHANNEL_OUT_SURROUND
-BM_ChannelMix/8        5437 ns         5422 ns       129099 AUDIO_CHANNEL_OUT_2POINT1POINT2
-BM_ChannelMix/9        5437 ns         5422 ns       129108 AUDIO_CHANNEL_OUT_3POINT0POINT2
-BM_ChannelMix/10       5435 ns         5422 ns       129083 AUDIO_CHANNEL_OUT_PENTA
-BM_ChannelMix/11       6161 ns         6143 ns       113945 AUDIO_CHANNEL_OUT_3POINT1POINT2
-BM_ChannelMix/12       2511 ns         2504 ns       279645 AUDIO_CHANNEL_OUT_5POINT1
-BM_ChannelMix/13       2511 ns         2503 ns       279621 AUDIO_CHANNEL_OUT_5POINT1_SIDE
-BM_ChannelMix/14       6882 ns         6865 ns       101946 AUDIO_CHANNEL_OUT_6POINT1
-BM_ChannelMix/15       7607 ns         7586 ns        92271 AUDIO_CHANNEL_OUT_5POINT1POINT2
-BM_ChannelMix/16       2812 ns         2804 ns       249729 AUDIO_CHANNEL_OUT_7POINT1
-BM_ChannelMix/17       9055 ns         9032 ns        77517 AUDIO_CHANNEL_OUT_5POINT1POINT4
-BM_ChannelMix/18       9055 ns         9031 ns        77477 AUDIO_CHANNEL_OUT_7POINT1POINT2
-BM_ChannelMix/19      10510 ns        10479 ns        66762 AUDIO_CHANNEL_OUT_7POINT1POINT4
-BM_ChannelMix/20      11293 ns        11262 ns        62135 AUDIO_CHANNEL_OUT_13POINT_360RA
-BM_ChannelMix/21      19886 ns        19829 ns        35265 AUDIO_CHANNEL_OUT_22POINT2
+$ channelmix_benchmark --benchmark_format=json --benchmark_out=results.json
+$ benchmark_compare.py summary results.json -o channelmix_summary.txt
+
+and gate regressions per pair with benchmark_compare.py compare (see
+README.md).  bytes_read/bytes_written counters report the memory traffic
+of each pair, so a layout regression shows up as a drop in bytes per
+second even when the frame rate of another pair masks it.
 */
 
+// Output masks supported by ChannelMix: currently stereo only
+// (see the TODO in ChannelMix.h about 5.1 and 7.1 targets).  Listing the
+// output axis explicitly keeps the benchmark a full (input, output) matrix
+// that grows automatically when more targets land.
+static constexpr audio_channel_mask_t kOutputChannelMasks[] = {
+    AUDIO_CHANNEL_OUT_STEREO,
+};
+
 static void BM_ChannelMix(benchmark::State& state) {
     const audio_channel_mask_t channelMask = kChannelPositionMasks[state.range(0)];
+    const audio_channel_mask_t outputChannelMask = kOutputChannelMasks[state.range(1)];
+    const bool accumulate = state.range(2);
     using namespace ::android::audio_utils::channels;
     ChannelMix channelMix(channelMask);
     constexpr size_t frameCount = 1024;
-    size_t inChannels = audio_channel_count_from_out_mask(channelMask);
+    const size_t inChannels = audio_channel_count_from_out_mask(channelMask);
+    const size_t outChannels = audio_channel_count_from_out_mask(outputChannelMask);
     std::vector<float> input(inChannels * frameCount);
-    std::vector<float> output(FCC_2 * frameCount);
+    std::vector<float> output(outChannels * frameCount);
     constexpr float amplitude = 0.01f;
 
     std::minstd_rand gen(channelMask);
@@ -99,17 +94,39 @@ static void BM_ChannelMix(benchmark::State& state) {
     for (auto _ : state) {
         benchmark::DoNotOptimize(input.data());
         benchmark::DoNotOptimize(output.data());
-        channelMix.process(input.data(), output.data(), frameCount, false /* accumulate */);
+        channelMix.process(input.data(), output.data(), frameCount, accumulate);
         benchmark::ClobberMemory();
     }
 
+    // Memory traffic per iteration: the input is read, the output is
+    // written, and with accumulate the output is also read.
+    const size_t bytesRead =
+            frameCount * (inChannels + (accumulate ? outChannels : 0)) * sizeof(float);
+    const size_t bytesWritten = frameCount * outChannels * sizeof(float);
+    state.SetItemsProcessed(state.iterations() * frameCount);
+    state.SetBytesProcessed(state.iterations() * (bytesRead + bytesWritten));
+    state.counters["bytes_read"] = benchmark::Counter(
+            bytesRead, benchmark::Counter::kIsIterationInvariantRate,
+            benchmark::Counter::kIs1024);
+    state.counters["bytes_written"] = benchmark::Counter(
+            bytesWritten, benchmark::Counter::kIsIterationInvariantRate,
+            benchmark::Counter::kIs1024);
     state.SetComplexityN(inChannels);
-    state.SetLabel(audio_channel_out_mask_to_string(channelMask));
+    std::string label(audio_channel_out_mask_to_string(channelMask));
+    label += "->";
+    label += audio_channel_out_mask_to_string(outputChannelMask);
+    if (accumulate) label += " accumulate";
+    state.SetLabel(label);
 }
 
 static void ChannelMixArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"in", "out", "accumulate"});
     for (int i = 0; i < (int)std::size(kChannelPositionMasks); i++) {
-        b->Args({i});
+        for (int out = 0; out < (int)std::size(kOutputChannelMasks); out++) {
+            for (int accumulate = 0; accumulate < 2; accumulate++) {
+                b->Args({i, out, accumulate});
+            }
+        }
     }
 }
 
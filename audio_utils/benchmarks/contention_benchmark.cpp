@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Contended writer benchmarks for the audio logging classes.
+ *
+ * Production Statistics, PowerLog and ErrorLog instances are written from
+ * audio threads while dump readers poll them at metrics or bugreport
+ * cadence (1-10 Hz).  Each iteration below is one 20 ms audio callback's
+ * worth of logging, run against a background reader polling the dump path
+ * every poll_ms milliseconds (0 runs the uncontended baseline without a
+ * reader thread), so the writer-side latency degradation under realistic
+ * contention is visible, and the wait-free variants have honest
+ * before/after numbers rather than single-threaded ones.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <audio_utils/ErrorLog.h>
+#include <audio_utils/PowerLog.h>
+#include <audio_utils/Statistics.h>
+
+static constexpr uint32_t kSampleRate = 48000;
+static constexpr uint32_t kChannelCount = 2;
+static constexpr size_t kFramesPerBurst = 960;   // one 20 ms callback at 48 kHz
+static constexpr int64_t kBurstNs = 20'000'000;  // burst duration in nanoseconds
+
+// Runs dump() every pollMs milliseconds on its own thread until destruction;
+// pollMs <= 0 starts no thread.
+class DumpPoller {
+public:
+    template <typename F>
+    DumpPoller(int pollMs, F dump) {
+        if (pollMs <= 0) return;
+        mThread = std::thread([this, pollMs, dump] {
+            while (!mQuit.load(std::memory_order_relaxed)) {
+                dump();
+                std::this_thread::sleep_for(std::chrono::milliseconds(pollMs));
+            }
+        });
+    }
+    ~DumpPoller() {
+        mQuit.store(true, std::memory_order_relaxed);
+        if (mThread.joinable()) mThread.join();
+    }
+
+private:
+    std::atomic<bool> mQuit{false};
+    std::thread mThread;
+};
+
+static std::vector<float> makeAudioBurst(size_t samples) {
+    std::vector<float> data(samples);
+    std::minstd_rand gen(samples);
+    std::uniform_real_distribution<float> dis(-0.1f, 0.1f);
+    for (auto &datum : data) {
+        datum = dis(gen);
+    }
+    return data;
+}
+
+static void BM_Statistics_add_contended(benchmark::State& state) {
+    android::audio_utils::Statistics<float> stat(0.999);
+    const std::vector<float> data = makeAudioBurst(kFramesPerBurst);
+    DumpPoller poller(state.range(0), [&] {
+        const std::string s = stat.toString();
+        benchmark::DoNotOptimize(s.data());
+    });
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(data.data());
+        for (const float datum : data) {
+            stat.add(datum);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * data.size());
+}
+
+BENCHMARK(BM_Statistics_add_contended)
+        ->ArgNames({"poll_ms"})->Arg(0)->Arg(1000)->Arg(100);
+
+static void BM_PowerLog_log_contended(benchmark::State& state) {
+    android::PowerLog powerLog(kSampleRate, kChannelCount,
+            AUDIO_FORMAT_PCM_FLOAT, 400 /* entries */, kFramesPerBurst / 2);
+    const std::vector<float> data = makeAudioBurst(kFramesPerBurst * kChannelCount);
+    DumpPoller poller(state.range(0), [&] {
+        const std::string s = powerLog.dumpToString("", 0, 0, false /* logPlot */);
+        benchmark::DoNotOptimize(s.data());
+    });
+
+    int64_t nowNs = 1;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(data.data());
+        powerLog.log(data.data(), kFramesPerBurst, nowNs);
+        nowNs += kBurstNs;
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * kFramesPerBurst);
+}
+
+BENCHMARK(BM_PowerLog_log_contended)
+        ->ArgNames({"poll_ms"})->Arg(0)->Arg(1000)->Arg(100);
+
+// The wait-free producer path: energies are precomputed (as by a DSP proxy)
+// and appended with logRealtime(), the dump poller folds them.
+static void BM_PowerLog_logRealtime_contended(benchmark::State& state) {
+    android::PowerLog powerLog(kSampleRate, kChannelCount,
+            AUDIO_FORMAT_PCM_FLOAT, 400 /* entries */, kFramesPerBurst / 2);
+    powerLog.enableRealtimeLog();
+    DumpPoller poller(state.range(0), [&] {
+        const std::string s = powerLog.dumpToString("", 0, 0, false /* logPlot */);
+        benchmark::DoNotOptimize(s.data());
+    });
+
+    int64_t nowNs = 1;
+    for (auto _ : state) {
+        powerLog.logRealtime(0.01f /* energy */, kFramesPerBurst, nowNs);
+        nowNs += kBurstNs;
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * kFramesPerBurst);
+}
+
+BENCHMARK(BM_PowerLog_logRealtime_contended)
+        ->ArgNames({"poll_ms"})->Arg(0)->Arg(1000)->Arg(100);
+
+// One error burst is several codes so aggregation and rollover both occur.
+static constexpr size_t kErrorsPerBurst = 16;
+
+static void BM_ErrorLog_log_contended(benchmark::State& state) {
+    android::ErrorLog<int32_t> errorLog(64 /* entries */);
+    DumpPoller poller(state.range(0), [&] {
+        const std::string s = errorLog.dumpToString();
+        benchmark::DoNotOptimize(s.data());
+    });
+
+    int64_t nowNs = 1;
+    int32_t code = 0;
+    for (auto _ : state) {
+        for (size_t i = 0; i < kErrorsPerBurst; ++i) {
+            errorLog.log(code++ & 7, nowNs);
+        }
+        nowNs += kBurstNs;
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * kErrorsPerBurst);
+}
+
+BENCHMARK(BM_ErrorLog_log_contended)
+        ->ArgNames({"poll_ms"})->Arg(0)->Arg(1000)->Arg(100);
+
+static void BM_WaitFreeErrorLog_log_contended(benchmark::State& state) {
+    android::WaitFreeErrorLog<int32_t> errorLog(
+            64 /* entriesPerWriter */, 1 /* maxWriters */);
+    auto *writer = errorLog.createWriter();
+    DumpPoller poller(state.range(0), [&] {
+        const std::string s = errorLog.dumpToString();
+        benchmark::DoNotOptimize(s.data());
+    });
+
+    int64_t nowNs = 1;
+    int32_t code = 0;
+    for (auto _ : state) {
+        for (size_t i = 0; i < kErrorsPerBurst; ++i) {
+            writer->log(code++ & 7, nowNs);
+        }
+        nowNs += kBurstNs;
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * kErrorsPerBurst);
+}
+
+BENCHMARK(BM_WaitFreeErrorLog_log_contended)
+        ->ArgNames({"poll_ms"})->Arg(0)->Arg(1000)->Arg(100);
+
+BENCHMARK_MAIN();
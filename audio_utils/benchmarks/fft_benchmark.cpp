@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <audio_utils/fixedfft.h>
+
+/*
+ * Compares the fixed point and float FFT paths, including the conversion
+ * passes a float pipeline pays to use the fixed transform, so the saving of
+ * float_fft() over convert + fixed_fft + convert is directly visible.
+ */
+
+static void initFloat(std::vector<float>& v) {
+    std::minstd_rand gen(v.size());
+    std::uniform_real_distribution<> dis(-0.25f, 0.25f);
+    for (auto& x : v) {
+        x = dis(gen);
+    }
+}
+
+static void BM_FixedFft(benchmark::State& state) {
+    const int n = state.range(0);
+    std::vector<int32_t> v(n);
+    std::minstd_rand gen(n);
+    std::uniform_int_distribution<> dis(-8192, 8192);
+    for (auto& x : v) {
+        x = (dis(gen) << 16) | (uint16_t)dis(gen);
+    }
+
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(v.data());
+        fixed_fft(n, v.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.SetComplexityN(n);
+}
+
+BENCHMARK(BM_FixedFft)->RangeMultiplier(4)->Range(64, 16384)->Complexity();
+
+static void BM_FloatFft(benchmark::State& state) {
+    const int n = state.range(0);
+    std::vector<float> v(n * 2);
+    initFloat(v);
+
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(v.data());
+        float_fft(n, v.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.SetComplexityN(n);
+}
+
+BENCHMARK(BM_FloatFft)->RangeMultiplier(4)->Range(64, 16384)->Complexity();
+
+// A float pipeline using the fixed transform pays a quantization pass in and
+// a conversion pass out on every block; this is the path float_fft replaces.
+static void BM_FixedFftFromFloat(benchmark::State& state) {
+    const int n = state.range(0);
+    std::vector<float> in(n * 2);
+    std::vector<int32_t> v(n);
+    std::vector<float> out(n * 2);
+    initFloat(in);
+
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(in.data());
+        for (int i = 0; i < n; ++i) {
+            const int32_t re = (int32_t)lrintf(in[i * 2] * 32768.f);
+            const int32_t im = (int32_t)lrintf(in[i * 2 + 1] * 32768.f);
+            v[i] = (re << 16) | (im & 0xFFFF);
+        }
+        fixed_fft(n, v.data());
+        for (int i = 0; i < n; ++i) {
+            out[i * 2] = (int16_t)(v[i] >> 16) / 32768.f;
+            out[i * 2 + 1] = (int16_t)(v[i] & 0xFFFF) / 32768.f;
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.SetComplexityN(n);
+}
+
+BENCHMARK(BM_FixedFftFromFloat)->RangeMultiplier(4)->Range(64, 16384)->Complexity();
+
+static void BM_FloatFftReal(benchmark::State& state) {
+    const int n = state.range(0);
+    std::vector<float> v(n * 2);
+    initFloat(v);
+
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(v.data());
+        float_fft_real(n, v.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.SetComplexityN(n);
+}
+
+BENCHMARK(BM_FloatFftReal)->RangeMultiplier(4)->Range(64, 8192)->Complexity();
+
+static void BM_FixedFftReal(benchmark::State& state) {
+    const int n = state.range(0);
+    std::vector<int32_t> v(n);
+    std::minstd_rand gen(n);
+    std::uniform_int_distribution<> dis(-8192, 8192);
+    for (auto& x : v) {
+        x = (dis(gen) << 16) | (uint16_t)dis(gen);
+    }
+
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(v.data());
+        fixed_fft_real(n, v.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.SetComplexityN(n);
+}
+
+BENCHMARK(BM_FixedFftReal)->RangeMultiplier(4)->Range(64, 8192)->Complexity();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <audio_utils/fifo.h>
+
+#include <atomic>
+#include <climits>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+static constexpr uint32_t kFrameCount = 4096;
+static constexpr uint32_t kFrameSize = sizeof(int16_t) * 2;  // 16-bit stereo
+
+/*
+ * Single-threaded round trip: write a burst then read it back, no
+ * synchronization overhead.  This is the upper bound on FIFO throughput
+ * and catches regressions in the index masking and copy paths.
+ */
+static void BM_FifoWriteRead(benchmark::State& state) {
+    const size_t burst = state.range(0);
+    std::vector<uint8_t> buffer(kFrameCount * kFrameSize);
+    audio_utils_fifo fifo(kFrameCount, kFrameSize, buffer.data(),
+            true /*throttlesWriter*/, AUDIO_UTILS_FIFO_SYNC_SINGLE_THREADED);
+    audio_utils_fifo_writer writer(fifo);
+    audio_utils_fifo_reader reader(fifo);
+    std::vector<uint8_t> in(burst * kFrameSize);
+    std::vector<uint8_t> out(burst * kFrameSize);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(in.data());
+        benchmark::DoNotOptimize(out.data());
+        ssize_t actual = writer.write(in.data(), burst);
+        if (actual != (ssize_t)burst) {
+            state.SkipWithError("write failed");
+            break;
+        }
+        actual = reader.read(out.data(), burst);
+        if (actual != (ssize_t)burst) {
+            state.SkipWithError("read failed");
+            break;
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * burst * kFrameSize);
+}
+
+BENCHMARK(BM_FifoWriteRead)->Arg(16)->Arg(96)->Arg(256)->Arg(1024);
+
+/*
+ * obtain/release pair cost in frames-available steady state, the path a
+ * zero-copy client exercises per mix cycle.
+ */
+static void BM_FifoObtainRelease(benchmark::State& state) {
+    const size_t burst = state.range(0);
+    std::vector<uint8_t> buffer(kFrameCount * kFrameSize);
+    audio_utils_fifo fifo(kFrameCount, kFrameSize, buffer.data(),
+            true /*throttlesWriter*/, AUDIO_UTILS_FIFO_SYNC_SINGLE_THREADED);
+    audio_utils_fifo_writer writer(fifo);
+    audio_utils_fifo_reader reader(fifo);
+    audio_utils_iovec iovec[2];
+
+    for (auto _ : state) {
+        ssize_t actual = writer.obtain(iovec, burst);
+        if (actual != (ssize_t)burst) {
+            state.SkipWithError("writer obtain failed");
+            break;
+        }
+        writer.release(burst);
+        actual = reader.obtain(iovec, burst);
+        if (actual != (ssize_t)burst) {
+            state.SkipWithError("reader obtain failed");
+            break;
+        }
+        reader.release(burst);
+    }
+}
+
+BENCHMARK(BM_FifoObtainRelease)->Arg(16)->Arg(96)->Arg(256);
+
+/*
+ * Two-threaded producer/consumer with futex throttling.  The consumer
+ * (benchmark thread) blocks when empty and the producer blocks when full,
+ * so the measured time includes the futex wait/wake cost that dominates
+ * small-burst IPC in practice.
+ */
+static void BM_FifoThreaded(benchmark::State& state) {
+    const size_t burst = state.range(0);
+    std::vector<uint8_t> buffer(kFrameCount * kFrameSize);
+    audio_utils_fifo fifo(kFrameCount, kFrameSize, buffer.data(),
+            true /*throttlesWriter*/);
+    audio_utils_fifo_writer writer(fifo);
+    audio_utils_fifo_reader reader(fifo);
+    std::vector<uint8_t> out(burst * kFrameSize);
+
+    std::atomic<bool> done{false};
+    std::thread producer([&] {
+        std::vector<uint8_t> in(burst * kFrameSize);
+        const struct timespec timeout = { .tv_sec = LONG_MAX, .tv_nsec = 0 };
+        while (!done.load(std::memory_order_relaxed)) {
+            (void)writer.write(in.data(), burst, &timeout);
+        }
+    });
+
+    const struct timespec timeout = { .tv_sec = LONG_MAX, .tv_nsec = 0 };
+    for (auto _ : state) {
+        size_t remaining = burst;
+        while (remaining > 0) {
+            const ssize_t actual = reader.read(
+                    out.data(), remaining, &timeout);
+            if (actual < 0) {
+                state.SkipWithError("read failed");
+                break;
+            }
+            remaining -= actual;
+        }
+        if (remaining > 0) break;
+    }
+    done = true;
+    // unblock a producer waiting for space
+    while (reader.read(out.data(), burst) > 0) { }
+    producer.join();
+    state.SetBytesProcessed(state.iterations() * burst * kFrameSize);
+}
+
+BENCHMARK(BM_FifoThreaded)->Arg(16)->Arg(96)->Arg(256)->Arg(1024);
+
+BENCHMARK_MAIN();
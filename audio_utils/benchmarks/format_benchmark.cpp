@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <audio_utils/format.h>
+
+#include <sstream>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+static constexpr audio_format_t kFormats[] = {
+    AUDIO_FORMAT_PCM_8_BIT,
+    AUDIO_FORMAT_PCM_16_BIT,
+    AUDIO_FORMAT_PCM_24_BIT_PACKED,
+    AUDIO_FORMAT_PCM_8_24_BIT,
+    AUDIO_FORMAT_PCM_32_BIT,
+    AUDIO_FORMAT_PCM_FLOAT,
+};
+
+static const char *formatName(audio_format_t format) {
+    switch (format) {
+    case AUDIO_FORMAT_PCM_8_BIT:         return "u8";
+    case AUDIO_FORMAT_PCM_16_BIT:        return "i16";
+    case AUDIO_FORMAT_PCM_24_BIT_PACKED: return "p24";
+    case AUDIO_FORMAT_PCM_8_24_BIT:      return "q8_23";
+    case AUDIO_FORMAT_PCM_32_BIT:        return "i32";
+    case AUDIO_FORMAT_PCM_FLOAT:         return "float";
+    default:                             return "?";
+    }
+}
+
+/*
+ * memcpy_by_audio_format() for every convertible format pair, across buffer
+ * sizes from a low-latency burst to a deep mix buffer.  Bytes processed is
+ * reported on the destination side.
+ */
+static void BM_FormatConvert(benchmark::State& state) {
+    const audio_format_t dstFormat = kFormats[state.range(0)];
+    const audio_format_t srcFormat = kFormats[state.range(1)];
+    const size_t count = state.range(2);
+
+    std::vector<uint8_t> src(count * audio_bytes_per_sample(srcFormat));
+    std::vector<uint8_t> dst(count * audio_bytes_per_sample(dstFormat));
+    // nonzero pattern so float conversions do not collapse to zero fills
+    for (size_t i = 0; i < src.size(); ++i) {
+        src[i] = (uint8_t)(i * 13 + 1);
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(src.data());
+        benchmark::DoNotOptimize(dst.data());
+        memcpy_by_audio_format(dst.data(), dstFormat, src.data(), srcFormat, count);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetBytesProcessed(
+            state.iterations() * count * audio_bytes_per_sample(dstFormat));
+    std::ostringstream label;
+    label << formatName(srcFormat) << "->" << formatName(dstFormat);
+    state.SetLabel(label.str());
+}
+
+static void FormatConvertArgs(benchmark::internal::Benchmark* b) {
+    for (int dst = 0; dst < (int)std::size(kFormats); ++dst) {
+        for (int src = 0; src < (int)std::size(kFormats); ++src) {
+            if (audio_format_get_converter(kFormats[dst], kFormats[src]) == NULL) {
+                continue;  // pair not supported
+            }
+            for (const int count : { 128, 1024, 8192 }) {
+                b->Args({dst, src, count});
+            }
+        }
+    }
+}
+
+BENCHMARK(BM_FormatConvert)->Apply(FormatConvertArgs);
+
+BENCHMARK_MAIN();
@@ -50,6 +50,7 @@ static void BM_MemcpyToFloatFromFloatWithClamping(benchmark::State& state) {
     if (expected != dst) {
         state.SkipWithError("Incorrect clamping!");
     }
+    state.SetItemsProcessed(state.iterations() * count);
     state.SetComplexityN(state.range(0));
 }
 
@@ -79,6 +80,7 @@ static void BM_MemcpyFloat(benchmark::State& state) {
     if (src != dst) {
         state.SkipWithError("Incorrect memcpy!");
     }
+    state.SetItemsProcessed(state.iterations() * count);
     state.SetComplexityN(state.range(0));
 }
 
@@ -105,6 +107,7 @@ static void BM_MemcpyToFloatFromI16(benchmark::State& state) {
         benchmark::ClobberMemory();
     }
 
+    state.SetItemsProcessed(state.iterations() * count);
     state.SetComplexityN(state.range(0));
 }
 
@@ -132,9 +135,227 @@ static void BM_MemcpyToI16FromFloat(benchmark::State& state) {
         benchmark::ClobberMemory();
     }
 
+    state.SetItemsProcessed(state.iterations() * count);
     state.SetComplexityN(state.range(0));
 }
 
 BENCHMARK(BM_MemcpyToI16FromFloat)->RangeMultiplier(2)->Ranges({{10, 8<<12}});
 
+static void BM_MemcpyToFloatFromF16(benchmark::State& state) {
+    const size_t count = state.range(0);
+
+    std::vector<uint16_t> src(count);
+    std::vector<float> dst(count);
+
+    // Initialize src buffer with deterministic pseudo-random half codes (no NaNs)
+    std::minstd_rand gen(count);
+    std::uniform_int_distribution<> dis(0, 0x7bff);
+    for (size_t i = 0; i < count; i++) {
+        src[i] = dis(gen);
+    }
+
+    // Run the test
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(src.data());
+        benchmark::DoNotOptimize(dst.data());
+        memcpy_to_float_from_f16(dst.data(), src.data(), count);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+    state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BM_MemcpyToFloatFromF16)->RangeMultiplier(2)->Ranges({{10, 8<<12}});
+
+static void BM_MemcpyToF16FromFloat(benchmark::State& state) {
+    const size_t count = state.range(0);
+
+    std::vector<float> src(count);
+    std::vector<uint16_t> dst(count);
+
+    // Initialize src buffer with deterministic pseudo-random values
+    std::minstd_rand gen(count);
+    std::uniform_real_distribution<> dis;
+    for (size_t i = 0; i < count; i++) {
+        src[i] = dis(gen);
+    }
+
+    // Run the test
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(src.data());
+        benchmark::DoNotOptimize(dst.data());
+        memcpy_to_f16_from_float(dst.data(), src.data(), count);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+    state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BM_MemcpyToF16FromFloat)->RangeMultiplier(2)->Ranges({{10, 8<<12}});
+
+static void BM_MemcpyToI16FromFloatDithered(benchmark::State& state) {
+    const size_t count = state.range(0);
+    constexpr uint32_t channels = 2;
+
+    std::vector<float> src(count);
+    std::vector<int16_t> dst(count);
+
+    // Initialize src buffer with deterministic pseudo-random values
+    std::minstd_rand gen(count);
+    std::uniform_real_distribution<> dis;
+    for (size_t i = 0; i < count; i++) {
+        src[i] = dis(gen);
+    }
+
+    audio_utils_dither_state ditherState;
+    audio_utils_dither_init(&ditherState, channels);
+
+    // Run the test
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(src.data());
+        benchmark::DoNotOptimize(dst.data());
+        memcpy_to_i16_from_float_dithered(dst.data(), src.data(), count / channels,
+                &ditherState);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+    state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BM_MemcpyToI16FromFloatDithered)->RangeMultiplier(2)->Ranges({{10, 8<<12}});
+
+// Convert a large (cache-exceeding) buffer while a mixer-sized working set is
+// re-read between conversions; arg1 selects the non-temporal variant.  The
+// difference between the two shows the working set being evicted by the
+// cacheable stores and kept resident by the streaming ones.
+static void BM_MemcpyToI16FromFloatLargeWithWorkingSet(benchmark::State& state) {
+    const size_t count = state.range(0);
+    const bool nonTemporal = state.range(1);
+    constexpr size_t kWorkingSetFloats = 65536;  // 256KB mixer working set
+
+    std::vector<float> src(count);
+    std::vector<int16_t> dst(count);
+    std::vector<float> workingSet(kWorkingSetFloats, 1.f);
+
+    // Initialize src buffer with deterministic pseudo-random values
+    std::minstd_rand gen(count);
+    std::uniform_real_distribution<> dis(-1., 1.);
+    for (size_t i = 0; i < count; i++) {
+        src[i] = dis(gen);
+    }
+
+    float accum = 0.f;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(src.data());
+        benchmark::DoNotOptimize(dst.data());
+        if (nonTemporal) {
+            memcpy_to_i16_from_float_nt(dst.data(), src.data(), count);
+        } else {
+            memcpy_to_i16_from_float(dst.data(), src.data(), count);
+        }
+        for (size_t i = 0; i < kWorkingSetFloats; i++) {
+            accum += workingSet[i];
+        }
+        benchmark::ClobberMemory();
+    }
+    benchmark::DoNotOptimize(accum);
+    state.SetItemsProcessed(state.iterations() * count);
+    state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BM_MemcpyToI16FromFloatLargeWithWorkingSet)
+        ->RangeMultiplier(4)->Ranges({{1<<20, 1<<24}, {0, 1}});
+
+static void BM_AccumulateFloatFromFloatWithGain(benchmark::State& state) {
+    const size_t count = state.range(0);
+
+    std::vector<float> src(count);
+    std::vector<float> dst(count);
+
+    // Initialize src buffer with deterministic pseudo-random values
+    std::minstd_rand gen(count);
+    std::uniform_real_distribution<> dis;
+    for (size_t i = 0; i < count; i++) {
+        src[i] = dis(gen);
+    }
+
+    // Run the test
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(src.data());
+        benchmark::DoNotOptimize(dst.data());
+        accumulate_float_from_float_with_gain(dst.data(), src.data(), count, 0.707f);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+    state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BM_AccumulateFloatFromFloatWithGain)->RangeMultiplier(2)->Ranges({{10, 8<<12}});
+
+static void BM_AccumulateFloatFromI16WithGain(benchmark::State& state) {
+    const size_t count = state.range(0);
+
+    std::vector<int16_t> src(count);
+    std::vector<float> dst(count);
+
+    // Initialize src buffer with deterministic pseudo-random values
+    std::minstd_rand gen(count);
+    std::uniform_int_distribution<int16_t> dis(INT16_MIN, INT16_MAX);
+    for (size_t i = 0; i < count; i++) {
+        src[i] = dis(gen);
+    }
+
+    // Run the test
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(src.data());
+        benchmark::DoNotOptimize(dst.data());
+        accumulate_float_from_i16_with_gain(dst.data(), src.data(), count, 0.707f);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+    state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BM_AccumulateFloatFromI16WithGain)->RangeMultiplier(2)->Ranges({{10, 8<<12}});
+
+static void BM_AccumulateFloatFromFloatWithChannelGains(benchmark::State& state) {
+    const size_t frames = state.range(0);
+    const size_t channelCount = state.range(1);
+    const size_t count = frames * channelCount;
+
+    std::vector<float> src(count);
+    std::vector<float> dst(count);
+    std::vector<float> gains(channelCount);
+
+    // Initialize src buffer with deterministic pseudo-random values
+    std::minstd_rand gen(count);
+    std::uniform_real_distribution<> dis;
+    for (size_t i = 0; i < count; i++) {
+        src[i] = dis(gen);
+    }
+    for (size_t i = 0; i < channelCount; i++) {
+        gains[i] = dis(gen);
+    }
+
+    // Run the test
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(src.data());
+        benchmark::DoNotOptimize(dst.data());
+        accumulate_float_from_float_with_channel_gains(
+                dst.data(), src.data(), frames, channelCount, gains.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+    state.SetComplexityN(state.range(0));
+}
+
+BENCHMARK(BM_AccumulateFloatFromFloatWithChannelGains)
+        ->RangeMultiplier(2)->Ranges({{10, 8<<12}, {2, 8}});
+
 BENCHMARK_MAIN();
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <vector>
+
+#include <audio_utils/spdif/SPDIFEncoder.h>
+#include <benchmark/benchmark.h>
+
+using namespace android;
+
+/*
+ * Passthrough throughput: the frame scanner plus IEC61937 burst assembly,
+ * which is the entire software cost of compressed passthrough.  The streams
+ * reuse the header vectors from tests/spdif_tests.cpp so the benchmark
+ * exercises the same parse paths the tests pin down.
+ */
+
+namespace {
+
+class BenchmarkSPDIFEncoder : public SPDIFEncoder {
+public:
+    explicit BenchmarkSPDIFEncoder(audio_format_t format)
+            : SPDIFEncoder(format)
+    {
+    }
+
+    ssize_t writeOutput(const void * /* buffer */, size_t numBytes) override {
+        mOutputBytes += numBytes;
+        return numBytes;
+    }
+
+    FrameScanner *getFramer() const { return mFramer; }
+
+    size_t mOutputBytes = 0;
+};
+
+// This is the beginning of the file voice1-48k-64kbps-15s.ac3
+const uint8_t sVoice1ch48k_AC3[] = {
+    0x0b, 0x77, 0x44, 0xcd, 0x08, 0x40, 0x2f, 0x84, 0x29, 0xca, 0x6e, 0x44, 0xa4, 0xfd, 0xce, 0xf7,
+    0xc9, 0x9f, 0x3e, 0x74, 0xfa, 0x01, 0x0a, 0xda, 0xb3, 0x3e, 0xb0, 0x95, 0xf2, 0x5a, 0xef, 0x9e
+};
+constexpr size_t kAC3FrameSize = 256; // frame size encoded in the header above
+
+// This is the beginning of the file channelcheck_48k6ch.eac3
+const uint8_t sChannel6ch48k_EAC3[] = {
+    0x0b, 0x77, 0x01, 0xbf, 0x3f, 0x85, 0x7f, 0xe8, 0x1e, 0x40, 0x82, 0x10, 0x00, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x03, 0xfc, 0x60, 0x80, 0x7e, 0x59, 0x00, 0xfc, 0xf3, 0xcf, 0x01, 0xf9, 0xe7
+};
+
+// Synthetic DTS core header: 48 kHz (sfreq 13), 16 blocks (512 sample
+// frames per sync frame), fsize 511 for a 512 byte frame, cpf 0.
+const uint8_t sSynthetic48k_DTS[] = {
+    0x7f, 0xfe, 0x80, 0x01, 0xfc, 0x3c, 0x1f, 0xf0, 0x34, 0x00, 0x00, 0x00
+};
+constexpr size_t kDTSFrameSize = 512; // fsize + 1
+
+// Builds a stream of frameCount frames: the real header, zero filled to the
+// frame size the scanner parses from it.
+std::vector<uint8_t> makeStream(audio_format_t format,
+        const uint8_t *header, size_t headerSize, size_t frameCount)
+{
+    // Discover the encoded frame size by scanning the header once.
+    BenchmarkSPDIFEncoder probe(format);
+    probe.write(header, headerSize);
+    const size_t frameSize = probe.getFramer()->getFrameSizeBytes();
+
+    std::vector<uint8_t> frame(header, header + headerSize);
+    frame.resize(frameSize, 0);
+    std::vector<uint8_t> stream;
+    stream.reserve(frameCount * frameSize);
+    for (size_t i = 0; i < frameCount; ++i) {
+        stream.insert(stream.end(), frame.begin(), frame.end());
+    }
+    return stream;
+}
+
+struct Codec {
+    const char *name;
+    audio_format_t format;
+    const uint8_t *header;
+    size_t headerSize;
+};
+
+const Codec kCodecs[] = {
+    { "AC3",  AUDIO_FORMAT_AC3,   sVoice1ch48k_AC3,     sizeof(sVoice1ch48k_AC3) },
+    { "EAC3", AUDIO_FORMAT_E_AC3, sChannel6ch48k_EAC3,  sizeof(sChannel6ch48k_EAC3) },
+    { "DTS",  AUDIO_FORMAT_DTS,   sSynthetic48k_DTS,    sizeof(sSynthetic48k_DTS) },
+};
+
+} // namespace
+
+/*
+ * Scanner plus burst assembly over a synchronized stream, the steady state
+ * of passthrough playback.  Bytes processed is the compressed input side.
+ */
+static void BM_SpdifEncode(benchmark::State& state) {
+    const Codec& codec = kCodecs[state.range(0)];
+    constexpr size_t kFrameCount = 64;
+    const std::vector<uint8_t> stream =
+            makeStream(codec.format, codec.header, codec.headerSize, kFrameCount);
+
+    BenchmarkSPDIFEncoder encoder(codec.format);
+    for (auto _ : state) {
+        encoder.write(stream.data(), stream.size());
+        benchmark::DoNotOptimize(encoder.mOutputBytes);
+    }
+    state.SetBytesProcessed(state.iterations() * stream.size());
+    state.SetLabel(codec.name);
+}
+
+BENCHMARK(BM_SpdifEncode)->DenseRange(0, std::size(kCodecs) - 1);
+
+/*
+ * Worst case: an unsynchronized stream that never matches a sync word, so
+ * the scanner rejects every byte.  This bounds the CPU burned while hunting
+ * for sync after a discontinuity.
+ */
+static void BM_SpdifScannerResync(benchmark::State& state) {
+    const Codec& codec = kCodecs[state.range(0)];
+    // 0x55 cannot begin or continue any supported sync word.
+    const std::vector<uint8_t> garbage(16384, 0x55);
+
+    BenchmarkSPDIFEncoder encoder(codec.format);
+    for (auto _ : state) {
+        encoder.write(garbage.data(), garbage.size());
+        benchmark::DoNotOptimize(encoder.mOutputBytes);
+    }
+    state.SetBytesProcessed(state.iterations() * garbage.size());
+    state.SetLabel(codec.name);
+}
+
+BENCHMARK(BM_SpdifScannerResync)->DenseRange(0, std::size(kCodecs) - 1);
+
+BENCHMARK_MAIN();
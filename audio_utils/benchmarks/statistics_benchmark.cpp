@@ -60,6 +60,30 @@ static void BM_MeanVariance(benchmark::State& state, int iterlimit, int alphalim
 }
 
 
+template <typename Stats>
+static void BM_BulkMeanVariance(benchmark::State& state, int iterlimit) {
+    Stats stat;  // bulk add requires alpha == 1.
+    using T = decltype(stat.getMin());
+    constexpr size_t count = 1 << 20; // exactly one "mega" samples from the distribution.
+    constexpr T range = 1.;
+    std::vector<T> data(count);
+    initUniform(data, -range, range);
+
+    // Run the test
+    int iters = 0;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(data.data());
+        stat.add(data.data(), data.size());
+        benchmark::ClobberMemory();
+        if (++iters % iterlimit == 0) {
+            printf("%d>  mean:%.17g  variance:%.17g\n",
+                    iters, (double)stat.getMean(), (double)stat.getPopVariance());
+            stat.reset();
+        }
+    }
+    state.SetComplexityN(count);
+}
+
 // Test case:
 // Do we work correctly within the capacity of float statistics when alpha == 1?
 //
@@ -76,6 +100,22 @@ static void BM_MeanVariance_float_float_float(benchmark::State &state) {
 
 BENCHMARK(BM_MeanVariance_float_float_float);
 
+// benchmark block accumulation of float
+static void BM_BulkMeanVariance_float_float_float(benchmark::State &state) {
+    BM_BulkMeanVariance<android::audio_utils::Statistics<float, float, float>>(state,
+        float_iterlimit);
+}
+
+BENCHMARK(BM_BulkMeanVariance_float_float_float);
+
+// benchmark block accumulation of float with double sums
+static void BM_BulkMeanVariance_float_double_double(benchmark::State &state) {
+    BM_BulkMeanVariance<android::audio_utils::Statistics<float, double, double>>(state,
+        float_iterlimit);
+}
+
+BENCHMARK(BM_BulkMeanVariance_float_double_double);
+
 // benchmark reference float
 static void BM_RefMeanVariance_float_float(benchmark::State &state) {
     BM_MeanVariance<android::audio_utils::ReferenceStatistics<float, float>>(state,
@@ -145,4 +185,57 @@ static auto BM_MeanVariance_float_double_double_alpha(benchmark::State &state) {
 
 BENCHMARK(BM_MeanVariance_float_double_double_alpha);
 
+// Test case:
+// Sweep alpha expressed as an equivalent rectangular window length
+// (see alphaFromWindowLength), with argument 0 meaning alpha exactly one.
+// The per-sample cost should be flat across the sweep, confirming the window
+// length can be chosen purely for convergence behavior at no throughput cost.
+static void BM_MeanVariance_float_double_windowed(benchmark::State &state) {
+    const size_t windowLength = state.range(0);
+    const double alpha = windowLength == 0
+            ? 1. : android::audio_utils::alphaFromWindowLength(windowLength);
+    android::audio_utils::Statistics<float, double, double> stat(alpha);
+    constexpr size_t count = 1 << 16;
+    constexpr float range = 1.;
+    std::vector<float> data(count);
+    initUniform(data, -range, range);
+
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(data.data());
+        for (const auto &datum : data) {
+            stat.add(datum);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK(BM_MeanVariance_float_double_windowed)
+        ->Arg(0)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000)->Arg(100000);
+
+// Test case:
+// As above with a startup window active; the per-sample alpha selection in
+// add() must not cost measurably more than the plain exponential path.
+static void BM_MeanVariance_float_double_startup_window(benchmark::State &state) {
+    const size_t windowLength = state.range(0);
+    android::audio_utils::Statistics<float, double, double> stat(
+            android::audio_utils::alphaFromWindowLength(windowLength));
+    stat.setStartupWindow(windowLength);
+    constexpr size_t count = 1 << 16;
+    constexpr float range = 1.;
+    std::vector<float> data(count);
+    initUniform(data, -range, range);
+
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(data.data());
+        for (const auto &datum : data) {
+            stat.add(datum);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK(BM_MeanVariance_float_double_startup_window)->Arg(100)->Arg(10000);
+
 BENCHMARK_MAIN();
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <audio_utils/cache_topology.h>
+
+#define CACHE_SYSFS_FORMAT "/sys/devices/system/cpu/cpu0/cache/index%d/%s"
+#define CACHE_MAX_INDEX 8
+
+// conservative defaults when sysfs does not expose the topology
+#define DEFAULT_L1D_SIZE (32 * 1024)
+#define DEFAULT_L2_SIZE (256 * 1024)
+#define DEFAULT_LINE_SIZE 64
+
+#define MIN_TILE_FRAMES 32
+#define MAX_TILE_FRAMES 4096
+
+static struct audio_utils_cache_topology cached_topology;
+static int cached_probed;  // 0 probed, -ENOENT defaults
+static pthread_once_t cache_once = PTHREAD_ONCE_INIT;
+
+// reads a small sysfs attribute into buf, returns true on success
+static bool read_attr(int index, const char *attr, char *buf, size_t size)
+{
+    char path[128];
+    snprintf(path, sizeof(path), CACHE_SYSFS_FORMAT, index, attr);
+    FILE *f = fopen(path, "re");
+    if (f == NULL) {
+        return false;
+    }
+    const bool ok = fgets(buf, size, f) != NULL;
+    fclose(f);
+    return ok;
+}
+
+// parses "32K" / "512K" / "4096K" / "1M" style sysfs cache sizes
+static size_t parse_size(const char *s)
+{
+    char *end;
+    size_t size = strtoul(s, &end, 10);
+    if (*end == 'K') {
+        size *= 1024;
+    } else if (*end == 'M') {
+        size *= 1024 * 1024;
+    }
+    return size;
+}
+
+static void probe_topology(void)
+{
+    struct audio_utils_cache_topology *t = &cached_topology;
+    bool found = false;
+    for (int i = 0; i < CACHE_MAX_INDEX; i++) {
+        char type[32];
+        char level[32];
+        char size[32];
+        if (!read_attr(i, "type", type, sizeof(type)) ||
+                !read_attr(i, "level", level, sizeof(level)) ||
+                !read_attr(i, "size", size, sizeof(size))) {
+            break;
+        }
+        if (strncmp(type, "Instruction", 11) == 0) {
+            continue;
+        }
+        const size_t bytes = parse_size(size);
+        switch (atoi(level)) {
+        case 1:
+            t->l1d_size = bytes;
+            break;
+        case 2:
+            t->l2_size = bytes;
+            break;
+        case 3:
+            t->l3_size = bytes;
+            break;
+        default:
+            break;
+        }
+        char line[32];
+        if (t->line_size == 0 &&
+                read_attr(i, "coherency_line_size", line, sizeof(line))) {
+            t->line_size = strtoul(line, NULL, 10);
+        }
+        found = true;
+    }
+    if (!found || t->l1d_size == 0) {
+        t->l1d_size = DEFAULT_L1D_SIZE;
+        if (t->l2_size == 0) {
+            t->l2_size = DEFAULT_L2_SIZE;
+        }
+        cached_probed = -ENOENT;
+    }
+    if (t->line_size == 0) {
+        t->line_size = DEFAULT_LINE_SIZE;
+    }
+}
+
+int audio_utils_get_cache_topology(struct audio_utils_cache_topology *topology)
+{
+    pthread_once(&cache_once, probe_topology);
+    *topology = cached_topology;
+    return cached_probed;
+}
+
+size_t audio_utils_recommend_tile_frames(size_t max_frame_size, size_t num_buffers)
+{
+    if (max_frame_size == 0) {
+        max_frame_size = 1;
+    }
+    if (num_buffers == 0) {
+        num_buffers = 1;
+    }
+    struct audio_utils_cache_topology t;
+    (void)audio_utils_get_cache_topology(&t);
+
+    // target half of L1d; if even the minimum tile does not fit there,
+    // aim at a quarter of L2 instead (big frame counts, many buffers)
+    size_t budget = t.l1d_size / 2;
+    const size_t bytes_per_frame = max_frame_size * num_buffers;
+    if (budget < MIN_TILE_FRAMES * bytes_per_frame && t.l2_size != 0) {
+        const size_t l2_budget = t.l2_size / 4;
+        if (l2_budget > budget) {
+            budget = l2_budget;
+        }
+    }
+
+    size_t tile = MIN_TILE_FRAMES;
+    while (tile < MAX_TILE_FRAMES && tile * 2 * bytes_per_frame <= budget) {
+        tile *= 2;
+    }
+    return tile;
+}
@@ -15,6 +15,7 @@
  */
 
 #include <string.h>
+#include <type_traits>
 #include <audio_utils/channels.h>
 #include "private/private.h"
 
@@ -345,7 +346,7 @@ static inline uint8x3_t int32_to_uint8x3(int32_t in) {
     for (src_index = 0; src_index < num_in_samples; src_index += in_buff_chans) { \
         temp = uint8x3_to_int32(*src_ptr++); \
         temp += uint8x3_to_int32(*src_ptr++); \
-        *dst_ptr = int32_to_uint8x3(temp >> 1); \
+        *dst_ptr++ = int32_to_uint8x3(temp >> 1); \
         src_ptr += num_skip_samples; \
     } \
     /* return number of *bytes* generated */ \
@@ -659,6 +660,107 @@ static size_t expand_channels_non_destructive(const void* in_buff, size_t in_buf
     }
 }
 
+/*
+ * Template form of the adjust_channels() conversion with the sample type and
+ * both channel counts as compile time constants, for converters fixed at
+ * stream open (see adjust_channels_get_fn() below).  With the counts known,
+ * the per-frame channel loops fully unroll and vectorize; the macros above
+ * keep them in runtime variables.
+ *
+ * The semantics are identical to adjust_channels() for the same tuple:
+ * expand zero-fills at the frame end (mono duplicated to the first two
+ * channels), contract drops from the frame end (multi to mono averages the
+ * first two channels), and in-place operation is supported.  If the runtime
+ * arguments disagree with the compiled tuple, defers to the generic path so
+ * the returned pointer is always safe to call.
+ */
+template <typename T, size_t IN_CHANS, size_t OUT_CHANS>
+static size_t adjust_channels_fixed(const void* in_buff, size_t in_buff_chans,
+                                    void* out_buff, size_t out_buff_chans,
+                                    unsigned sample_size_in_bytes, size_t num_in_bytes)
+{
+    if (in_buff_chans != IN_CHANS || out_buff_chans != OUT_CHANS
+            || sample_size_in_bytes != sizeof(T)) {
+        return adjust_channels(in_buff, in_buff_chans, out_buff, out_buff_chans,
+                               sample_size_in_bytes, num_in_bytes);
+    }
+    const size_t num_in_samples = num_in_bytes / sizeof(T);
+    const size_t num_frames = num_in_samples / IN_CHANS;
+    if constexpr (OUT_CHANS > IN_CHANS) {
+        /* expand back to front, as EXPAND_CHANNELS / EXPAND_MONO_TO_MULTI */
+        const T zero{};
+        const T* src_ptr = (const T*)in_buff + num_in_samples - 1;
+        T* dst_ptr = (T*)out_buff + num_frames * OUT_CHANS - 1;
+        for (size_t frame = 0; frame < num_frames; ++frame) {
+            if constexpr (IN_CHANS == 1) {
+                /* special case of mono source to multi-channel */
+                for (size_t i = 0; i < OUT_CHANS - 2; ++i) {
+                    *dst_ptr-- = zero;
+                }
+                *dst_ptr-- = *src_ptr;
+                *dst_ptr-- = *src_ptr--;
+            } else {
+                for (size_t i = 0; i < OUT_CHANS - IN_CHANS; ++i) {
+                    *dst_ptr-- = zero;
+                }
+                for (size_t i = 0; i < IN_CHANS; ++i) {
+                    *dst_ptr-- = *src_ptr--;
+                }
+            }
+        }
+        return num_frames * OUT_CHANS * sizeof(T);
+    } else if constexpr (OUT_CHANS < IN_CHANS) {
+        /* contract front to back, as CONTRACT_CHANNELS / CONTRACT_TO_MONO */
+        const T* src_ptr = (const T*)in_buff;
+        T* dst_ptr = (T*)out_buff;
+        for (size_t frame = 0; frame < num_frames; ++frame) {
+            if constexpr (OUT_CHANS == 1 && std::is_same<T, uint8x3_t>::value) {
+                /* special case Multi to Mono, as CONTRACT_TO_MONO_24 */
+                const int32_t temp =
+                        uint8x3_to_int32(src_ptr[0]) + uint8x3_to_int32(src_ptr[1]);
+                *dst_ptr++ = int32_to_uint8x3(temp >> 1);
+            } else if constexpr (OUT_CHANS == 1) {
+                /* special case Multi to Mono, averaged as CONTRACT_TO_MONO */
+                const int32_t temp0 = src_ptr[0];
+                const int32_t temp1 = src_ptr[1];
+                *dst_ptr++ = (temp0 & temp1) + ((temp0 ^ temp1) >> 1);
+            } else {
+                for (size_t i = 0; i < OUT_CHANS; ++i) {
+                    *dst_ptr++ = src_ptr[i];
+                }
+            }
+            src_ptr += IN_CHANS;
+        }
+        return num_frames * OUT_CHANS * sizeof(T);
+    } else {
+        if (in_buff != out_buff) {
+            memcpy(out_buff, in_buff, num_in_bytes);
+        }
+        return num_in_bytes;
+    }
+}
+
+/*
+ * Instantiates adjust_channels_fixed() for one channel count pair across the
+ * supported sample sizes.
+ */
+template <size_t IN_CHANS, size_t OUT_CHANS>
+static adjust_channels_fn fixed_fn_for_sample_size(unsigned sample_size_in_bytes)
+{
+    switch (sample_size_in_bytes) {
+    case 1:
+        return adjust_channels_fixed<uint8_t, IN_CHANS, OUT_CHANS>;
+    case 2:
+        return adjust_channels_fixed<int16_t, IN_CHANS, OUT_CHANS>;
+    case 3:
+        return adjust_channels_fixed<uint8x3_t, IN_CHANS, OUT_CHANS>;
+    case 4:
+        return adjust_channels_fixed<int32_t, IN_CHANS, OUT_CHANS>;
+    default:
+        return NULL;
+    }
+}
+
 size_t adjust_channels(const void* in_buff, size_t in_buff_chans,
                        void* out_buff, size_t out_buff_chans,
                        unsigned sample_size_in_bytes, size_t num_in_bytes)
@@ -693,6 +795,51 @@ size_t adjust_selected_channels(const void* in_buff, size_t in_buff_chans,
     return num_in_bytes;
 }
 
+adjust_channels_fn adjust_channels_get_fn(size_t in_buff_chans, size_t out_buff_chans,
+                       unsigned sample_size_in_bytes)
+{
+    if (sample_size_in_bytes < 1 || sample_size_in_bytes > 4) {
+        return NULL;
+    }
+    /* the fixed conversions of USB and other hardware streams:
+     * mono/stereo fan-out and the stereo <-> multichannel pairs. */
+    switch (in_buff_chans) {
+    case 1:
+        if (out_buff_chans == 2) {
+            return fixed_fn_for_sample_size<1, 2>(sample_size_in_bytes);
+        }
+        break;
+    case 2:
+        switch (out_buff_chans) {
+        case 1:
+            return fixed_fn_for_sample_size<2, 1>(sample_size_in_bytes);
+        case 4:
+            return fixed_fn_for_sample_size<2, 4>(sample_size_in_bytes);
+        case 6:
+            return fixed_fn_for_sample_size<2, 6>(sample_size_in_bytes);
+        case 8:
+            return fixed_fn_for_sample_size<2, 8>(sample_size_in_bytes);
+        }
+        break;
+    case 4:
+        if (out_buff_chans == 2) {
+            return fixed_fn_for_sample_size<4, 2>(sample_size_in_bytes);
+        }
+        break;
+    case 6:
+        if (out_buff_chans == 2) {
+            return fixed_fn_for_sample_size<6, 2>(sample_size_in_bytes);
+        }
+        break;
+    case 8:
+        if (out_buff_chans == 2) {
+            return fixed_fn_for_sample_size<8, 2>(sample_size_in_bytes);
+        }
+        break;
+    }
+    return adjust_channels;    /* uncommon tuple: generic dispatch */
+}
+
 size_t adjust_channels_non_destructive(const void* in_buff, size_t in_buff_chans,
                        void* out_buff, size_t out_buff_chans,
                        unsigned sample_size_in_bytes, size_t num_in_bytes)
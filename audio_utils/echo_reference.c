@@ -19,13 +19,17 @@
 
 #include <errno.h>
 #include <inttypes.h>
+#include <math.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stddef.h>
 #include <stdlib.h>
 
 #include <log/log.h>
 #include <system/audio.h>
+#include <audio_utils/primitives.h>
 #include <audio_utils/resampler.h>
+#include <audio_utils/roundup.h>
 #include <audio_utils/echo_reference.h>
 
 // echo reference state: bit field indicating if read, write or both are active.
@@ -35,6 +39,52 @@ enum state {
     ECHOREF_WRITING = 0x02      // writing is active
 };
 
+// maximum number of additional readers sharing one echo reference
+#define ECHOREF_MAX_READERS 4
+
+// filter taps per decimation phase: total filter length is the ratio times this
+#define ECHOREF_DECIMATE_TAPS_PER_PHASE 16
+// largest integer rate ratio handled by the inline decimator
+#define ECHOREF_DECIMATE_MAX_RATIO 6
+
+// fixed-point integer-ratio decimator used instead of the generic resampler
+// for exact rate ratios (e.g. 48 kHz playback down to a 16 kHz reference).
+// A windowed sinc low pass is applied in Q15 at every ratio-th input frame,
+// which is considerably cheaper than the arbitrary-ratio speex resampler.
+struct echo_reference_decimator {
+    uint32_t ratio;         // input frames per output frame
+    uint32_t channels;      // interleaved channels (after stereo to mono conversion)
+    size_t num_taps;        // filter length: ratio * ECHOREF_DECIMATE_TAPS_PER_PHASE
+    int64_t group_delay_ns; // constant filter group delay, precomputed at creation
+    int16_t *coefs;         // Q15 filter coefficients, num_taps long
+    int16_t *in_buf;        // filter history followed by the frames being decimated
+    size_t in_buf_frames;   // allocated capacity of in_buf in frames
+    size_t frames_held;     // history frames carried over between calls
+};
+
+// Timestamp index over the reference ring: the frame ending at pos is
+// rendered at play_time_ns, and neighboring positions are interpolated at
+// the reference sample rate.  One record is appended per write(), with the
+// playback delay and the conversion (resampler or decimator) delay already
+// folded in, so read() maps a capture time to an aligned frame with a
+// binary search instead of nudging a frame count by per-read heuristics.
+#define ECHOREF_MAX_TIME_RECORDS 32
+struct echo_reference_time_record {
+    uint64_t pos;           // ring position just past the frames of the write
+    int64_t play_time_ns;   // CLOCK_REALTIME ns when the frame at pos - 1 has rendered
+};
+
+struct echo_reference;
+
+// additional reader created by echo_reference_create_reader(): an independent
+// read cursor over the shared reader ring buffer filled by write().
+struct echo_reference_reader {
+    struct echo_reference_itfe itfe; // must be first member
+    struct echo_reference *er;       // echo reference the cursor reads from
+    uint64_t rd_pos;                 // total frames consumed by this reader
+    int in_use;                      // slot is allocated, protected by er->lock
+};
+
 struct echo_reference {
     struct echo_reference_itfe itfe;
     int status;                     // init status
@@ -47,9 +97,15 @@ struct echo_reference {
     uint32_t wr_channel_count;      // write number of channels
     uint32_t wr_sampling_rate;      // write sampling rate in Hz
     size_t wr_frame_size;           // write frame size (bytes per sample)
-    void *buffer;                   // main buffer
-    size_t buf_size;                // main buffer size in frames
-    size_t frames_in;               // number of frames in main buffer
+    int32_t *wr_weights_q15;        // per write channel fold weights (Q15),
+                                    // normalized to unity per reference channel
+    void *buffer;                   // main reference ring buffer
+    size_t buf_frames;              // ring capacity in frames, power of two
+    uint64_t buf_rd_pos;            // total frames consumed from the ring
+    uint64_t buf_wr_pos;            // total frames written to the ring
+    struct echo_reference_time_record time_records[ECHOREF_MAX_TIME_RECORDS];
+                                    // timestamp index, oldest first
+    size_t time_record_count;       // number of valid time records
     void *wr_buf;                   // buffer for input conversions
     size_t wr_buf_size;             // size of conversion buffer in frames
     size_t wr_frames_in;            // number of frames in conversion buffer
@@ -65,6 +121,14 @@ struct echo_reference {
     pthread_cond_t cond;                       // condition signaled when data is ready to read
     struct resampler_itfe *resampler;          // input resampler
     struct resampler_buffer_provider provider; // resampler buffer provider
+    struct echo_reference_decimator *decimator; // inline decimator for integer rate ratios,
+                                                // used instead of the generic resampler
+    void *reader_buf;               // shared ring buffer for additional readers,
+                                    // allocated when the first reader is created
+    size_t reader_buf_frames;       // reader ring capacity in frames, power of two
+    _Atomic uint64_t reader_wr_pos; // total frames published to the reader ring
+    uint32_t reader_count;          // number of active readers, protected by lock
+    struct echo_reference_reader readers[ECHOREF_MAX_READERS]; // reader cursors
 };
 
 
@@ -115,8 +179,10 @@ static void echo_reference_reset_l(struct echo_reference *er)
     ALOGV("echo_reference_reset_l()");
     free(er->buffer);
     er->buffer = NULL;
-    er->buf_size = 0;
-    er->frames_in = 0;
+    er->buf_frames = 0;
+    er->buf_rd_pos = 0;
+    er->buf_wr_pos = 0;
+    er->time_record_count = 0;
     free(er->wr_buf);
     er->wr_buf = NULL;
     er->wr_buf_size = 0;
@@ -126,6 +192,228 @@ static void echo_reference_reset_l(struct echo_reference *er)
     er->prev_delta_sign = 0;
 }
 
+static void echo_reference_decimator_reset(struct echo_reference_decimator *d)
+{
+    // start from silence: the history primes the filter so the first input
+    // frame already produces output
+    d->frames_held = d->num_taps - 1;
+    memset(d->in_buf, 0, d->frames_held * d->channels * sizeof(int16_t));
+}
+
+static void echo_reference_release_decimator(struct echo_reference_decimator *d)
+{
+    if (d == NULL) {
+        return;
+    }
+    free(d->coefs);
+    free(d->in_buf);
+    free(d);
+}
+
+static struct echo_reference_decimator *echo_reference_create_decimator(uint32_t inSampleRate,
+                                                                        uint32_t outSampleRate,
+                                                                        uint32_t channels)
+{
+    if (outSampleRate == 0 || inSampleRate % outSampleRate != 0) {
+        return NULL;
+    }
+    uint32_t ratio = inSampleRate / outSampleRate;
+    if (ratio < 2 || ratio > ECHOREF_DECIMATE_MAX_RATIO) {
+        return NULL;
+    }
+
+    struct echo_reference_decimator *d =
+            (struct echo_reference_decimator *)calloc(1, sizeof(*d));
+    if (d == NULL) {
+        return NULL;
+    }
+    d->ratio = ratio;
+    d->channels = channels;
+    d->num_taps = (size_t)ratio * ECHOREF_DECIMATE_TAPS_PER_PHASE;
+    d->group_delay_ns = ((int64_t)(d->num_taps - 1) * 1000000000) / (2 * inSampleRate);
+    d->coefs = (int16_t *)malloc(d->num_taps * sizeof(int16_t));
+    // enough history for one call with no input; grown on demand by decimate()
+    d->in_buf_frames = d->num_taps;
+    d->in_buf = (int16_t *)malloc(d->in_buf_frames * channels * sizeof(int16_t));
+    if (d->coefs == NULL || d->in_buf == NULL) {
+        echo_reference_release_decimator(d);
+        return NULL;
+    }
+
+    // Hamming windowed sinc low pass with cutoff at 90% of the output Nyquist
+    // frequency, normalized to unity DC gain and quantized to Q15.
+    const double fc = 0.45 / ratio; // cutoff in cycles per input sample
+    double gain = 0.0;
+    for (size_t i = 0; i < d->num_taps; i++) {
+        const double x = (double)i - (double)(d->num_taps - 1) / 2.0;
+        const double sinc = (x == 0.0) ? 2.0 * fc : sin(2.0 * M_PI * fc * x) / (M_PI * x);
+        const double window = 0.54 - 0.46 * cos(2.0 * M_PI * i / (d->num_taps - 1));
+        gain += sinc * window;
+    }
+    for (size_t i = 0; i < d->num_taps; i++) {
+        const double x = (double)i - (double)(d->num_taps - 1) / 2.0;
+        const double sinc = (x == 0.0) ? 2.0 * fc : sin(2.0 * M_PI * fc * x) / (M_PI * x);
+        const double window = 0.54 - 0.46 * cos(2.0 * M_PI * i / (d->num_taps - 1));
+        d->coefs[i] = (int16_t)lrint(sinc * window / gain * 32767.0);
+    }
+
+    echo_reference_decimator_reset(d);
+
+    ALOGV("echo_reference_create_decimator() ratio %u, %zu taps", ratio, d->num_taps);
+    return d;
+}
+
+// Decimate inFrames interleaved frames into out, which must have room for
+// inFrames / ratio + 1 frames. The input is first copied after the carried
+// history, so out may alias in. Returns the number of frames produced.
+static size_t echo_reference_decimate(struct echo_reference_decimator *d,
+                                      const int16_t *in, size_t inFrames, int16_t *out)
+{
+    const uint32_t channels = d->channels;
+
+    if (d->frames_held + inFrames > d->in_buf_frames) {
+        size_t frames = d->frames_held + inFrames;
+        ALOGV("echo_reference_decimate() increasing buffer size from %zu to %zu",
+                d->in_buf_frames, frames);
+        int16_t *new_buf = (int16_t *)realloc(d->in_buf,
+                frames * channels * sizeof(int16_t));
+        if (new_buf == NULL) {
+            ALOGE("echo_reference_decimate() allocation failed, frames dropped");
+            return 0;
+        }
+        d->in_buf = new_buf;
+        d->in_buf_frames = frames;
+    }
+    memcpy(d->in_buf + d->frames_held * channels, in, inFrames * channels * sizeof(int16_t));
+
+    const size_t total = d->frames_held + inFrames;
+    size_t produced = 0;
+    // one output frame for each full filter window, advancing by ratio frames
+    for (size_t end = d->num_taps - 1; end < total; end += d->ratio) {
+        for (uint32_t c = 0; c < channels; c++) {
+            const int16_t *x = d->in_buf + (end - (d->num_taps - 1)) * channels + c;
+            int32_t acc = 1 << 14; // Q15 rounding
+            // independent multiply-accumulates, vectorizable by the compiler
+            for (size_t k = 0; k < d->num_taps; k++) {
+                acc += (int32_t)d->coefs[d->num_taps - 1 - k] * (int32_t)x[k * channels];
+            }
+            out[produced * channels + c] = clamp16(acc >> 15);
+        }
+        produced++;
+    }
+
+    // carry the unconsumed tail over as history for the next call
+    const size_t consumed = produced * d->ratio;
+    d->frames_held = total - consumed;
+    memmove(d->in_buf, d->in_buf + consumed * channels,
+            d->frames_held * channels * sizeof(int16_t));
+    return produced;
+}
+
+/*
+ * Folds interleaved multichannel playback down to the reference channel
+ * count.  Write channel c contributes to reference channel (c % out_channels)
+ * with the Q15 weight weights_q15[c].  The weights of each reference channel
+ * are normalized to unity on assignment, so the accumulator fits in 32 bits
+ * for any write channel count.  The loops are branch-free multiply
+ * accumulates with a fixed stride that the compiler can unroll and vectorize
+ * across frames.
+ */
+static void echo_reference_fold(int16_t *dst, const int16_t *src, size_t frames,
+                                uint32_t in_channels, uint32_t out_channels,
+                                const int32_t *weights_q15)
+{
+    while (frames--) {
+        for (uint32_t o = 0; o < out_channels; o++) {
+            int32_t acc = 0;
+            for (uint32_t c = o; c < in_channels; c += out_channels) {
+                acc += weights_q15[c] * (int32_t)src[c];
+            }
+            *dst++ = clamp16(acc >> 15);
+        }
+        src += in_channels;
+    }
+}
+
+// number of frames held in the main ring, from the read cursor to the write end
+static size_t echo_reference_frames_in(const struct echo_reference *er)
+{
+    return er->buf_wr_pos > er->buf_rd_pos ? (size_t)(er->buf_wr_pos - er->buf_rd_pos) : 0;
+}
+
+// Grows the main ring so that it holds at least neededFrames, preserving the
+// unconsumed frames at their absolute positions.
+static int echo_reference_ring_grow(struct echo_reference *er, size_t neededFrames)
+{
+    if (neededFrames <= er->buf_frames) {
+        return 0;
+    }
+    const size_t frames = audio_utils_next_pow2((unsigned)neededFrames);
+    ALOGV("echo_reference_ring_grow() increasing buffer size from %zu to %zu",
+            er->buf_frames, frames);
+    void *new_buf = calloc(frames, er->rd_frame_size);
+    if (new_buf == NULL) {
+        return -ENOMEM;
+    }
+    for (uint64_t pos = er->buf_rd_pos; pos < er->buf_wr_pos; ) {
+        const size_t old_index = (size_t)(pos & (er->buf_frames - 1));
+        const size_t new_index = (size_t)(pos & (frames - 1));
+        size_t part = er->buf_frames - old_index;
+        if (part > frames - new_index) {
+            part = frames - new_index;
+        }
+        if (part > (size_t)(er->buf_wr_pos - pos)) {
+            part = (size_t)(er->buf_wr_pos - pos);
+        }
+        memcpy((char *)new_buf + new_index * er->rd_frame_size,
+               (char *)er->buffer + old_index * er->rd_frame_size,
+               part * er->rd_frame_size);
+        pos += part;
+    }
+    free(er->buffer);
+    er->buffer = new_buf;
+    er->buf_frames = frames;
+    return 0;
+}
+
+// copies frames into the main ring at absolute position pos
+static void echo_reference_ring_put(struct echo_reference *er, const void *src,
+                                    uint64_t pos, size_t frames)
+{
+    const char *from = (const char *)src;
+    while (frames != 0) {
+        const size_t index = (size_t)(pos & (er->buf_frames - 1));
+        size_t part = er->buf_frames - index;
+        if (part > frames) {
+            part = frames;
+        }
+        memcpy((char *)er->buffer + index * er->rd_frame_size,
+               from, part * er->rd_frame_size);
+        from += part * er->rd_frame_size;
+        pos += part;
+        frames -= part;
+    }
+}
+
+// copies frames out of the main ring from absolute position pos
+static void echo_reference_ring_get(struct echo_reference *er, void *dst,
+                                    uint64_t pos, size_t frames)
+{
+    char *to = (char *)dst;
+    while (frames != 0) {
+        const size_t index = (size_t)(pos & (er->buf_frames - 1));
+        size_t part = er->buf_frames - index;
+        if (part > frames) {
+            part = frames;
+        }
+        memcpy(to, (char *)er->buffer + index * er->rd_frame_size,
+               part * er->rd_frame_size);
+        to += part * er->rd_frame_size;
+        pos += part;
+        frames -= part;
+    }
+}
+
 /* additional space in resampler buffer allowing for extra samples to be returned
  * by speex resampler when sample rates ratio is not an integer.
  */
@@ -168,10 +456,13 @@ static int echo_reference_write(struct echo_reference_itfe *echo_reference,
         if (er->resampler != NULL) {
             er->resampler->reset(er->resampler);
         }
+        if (er->decimator != NULL) {
+            echo_reference_decimator_reset(er->decimator);
+        }
         er->state |= ECHOREF_WRITING;
     }
 
-    if ((er->state & ECHOREF_READING) == 0) {
+    if ((er->state & ECHOREF_READING) == 0 && er->reader_count == 0) {
         goto exit;
     }
 
@@ -185,7 +476,7 @@ static int echo_reference_write(struct echo_reference_itfe *echo_reference,
 
     void *srcBuf;
     size_t inFrames;
-    // do stereo to mono and down sampling if necessary
+    // fold the channels and down sample if necessary
     if (er->rd_channel_count != er->wr_channel_count ||
             er->rd_sampling_rate != er->wr_sampling_rate) {
         size_t wrBufSize = buffer->frame_count;
@@ -216,17 +507,20 @@ static int echo_reference_write(struct echo_reference_itfe *echo_reference,
         }
 
         if (er->rd_channel_count != er->wr_channel_count) {
-            // must be stereo to mono
-            int16_t *src16 = (int16_t *)buffer->raw;
-            int16_t *dst16 = (int16_t *)er->wr_buf;
-            size_t frames = buffer->frame_count;
-            while (frames--) {
-                *dst16++ = (int16_t)(((int32_t)*src16 + (int32_t)*(src16 + 1)) >> 1);
-                src16 += 2;
-            }
+            // fold the playback channels down to the reference channels
+            echo_reference_fold((int16_t *)er->wr_buf, (const int16_t *)buffer->raw,
+                                buffer->frame_count, er->wr_channel_count,
+                                er->rd_channel_count, er->wr_weights_q15);
         }
         if (er->wr_sampling_rate != er->rd_sampling_rate) {
-            if (er->resampler == NULL) {
+            if (er->resampler == NULL && er->decimator == NULL) {
+                // prefer the inline decimator for integer rate ratios;
+                // it handles the common 48 kHz to 16 kHz reference path
+                er->decimator = echo_reference_create_decimator(er->wr_sampling_rate,
+                                                                er->rd_sampling_rate,
+                                                                er->rd_channel_count);
+            }
+            if (er->decimator == NULL && er->resampler == NULL) {
                 int rc;
                 ALOGV("echo_reference_write() new ReSampler(%d, %d)",
                       er->wr_sampling_rate, er->rd_sampling_rate);
@@ -245,23 +539,35 @@ static int echo_reference_write(struct echo_reference_itfe *echo_reference,
                     goto exit;
                 }
             }
-            // er->wr_src_buf and er->wr_frames_in are used by getNexBuffer() called by the
-            // resampler to get new frames
-            if (er->rd_channel_count != er->wr_channel_count) {
-                er->wr_src_buf = er->wr_buf;
+            if (er->decimator != NULL) {
+                // decimate() buffers its input before producing output,
+                // so wr_buf may be both the source and the destination
+                const int16_t *src = (er->rd_channel_count != er->wr_channel_count)
+                        ? (const int16_t *)er->wr_buf : (const int16_t *)buffer->raw;
+                ALOGV("echo_reference_write() decimating(%d, %d)",
+                      er->wr_sampling_rate, er->rd_sampling_rate);
+                inFrames = echo_reference_decimate(er->decimator, src, buffer->frame_count,
+                                                   (int16_t *)er->wr_buf);
             } else {
-                er->wr_src_buf = buffer->raw;
+                // er->wr_src_buf and er->wr_frames_in are used by getNexBuffer() called by the
+                // resampler to get new frames
+                if (er->rd_channel_count != er->wr_channel_count) {
+                    er->wr_src_buf = er->wr_buf;
+                } else {
+                    er->wr_src_buf = buffer->raw;
+                }
+                er->wr_frames_in = buffer->frame_count;
+                // inFrames is always more than we need here to get frames remaining from
+                // previous runs
+                // inFrames is updated by resample() with the number of frames produced
+                ALOGV("echo_reference_write() ReSampling(%d, %d)",
+                      er->wr_sampling_rate, er->rd_sampling_rate);
+                er->resampler->resample_from_provider(er->resampler,
+                                                         (int16_t *)er->wr_buf, &inFrames);
+                ALOGV_IF(er->wr_frames_in != 0,
+                        "echo_reference_write() er->wr_frames_in not 0 (%zu) after resampler",
+                        er->wr_frames_in);
             }
-            er->wr_frames_in = buffer->frame_count;
-            // inFrames is always more than we need here to get frames remaining from previous runs
-            // inFrames is updated by resample() with the number of frames produced
-            ALOGV("echo_reference_write() ReSampling(%d, %d)",
-                  er->wr_sampling_rate, er->rd_sampling_rate);
-            er->resampler->resample_from_provider(er->resampler,
-                                                     (int16_t *)er->wr_buf, &inFrames);
-            ALOGV_IF(er->wr_frames_in != 0,
-                    "echo_reference_write() er->wr_frames_in not 0 (%zu) after resampler",
-                    er->wr_frames_in);
         }
         srcBuf = er->wr_buf;
     } else {
@@ -269,26 +575,69 @@ static int echo_reference_write(struct echo_reference_itfe *echo_reference,
         srcBuf = buffer->raw;
     }
 
-    if (er->frames_in + inFrames > er->buf_size) {
-        ALOGV("echo_reference_write() increasing buffer size from %zu to %zu",
-                er->buf_size, er->frames_in + inFrames);
-        er->buf_size = er->frames_in + inFrames;
-        void *new_buf = realloc(er->buffer, er->buf_size * er->rd_frame_size);
-        if (new_buf == NULL) {
-            status = -ENOMEM;
-            goto exit;
-        } else {
-            er->buffer = new_buf;
+    if (er->reader_buf != NULL) {
+        // Publish the converted frames to the shared reader ring. Readers never
+        // take er->lock so a slow reader cannot block or stall the writer.
+        const uint64_t wrPos = atomic_load_explicit(&er->reader_wr_pos, memory_order_relaxed);
+        const char *src = (const char *)srcBuf;
+        uint64_t pos = wrPos;
+        size_t frames = inFrames;
+        if (frames > er->reader_buf_frames) {
+            // cannot happen with sensible write sizes: keep only the newest history
+            src += (frames - er->reader_buf_frames) * er->rd_frame_size;
+            pos += frames - er->reader_buf_frames;
+            frames = er->reader_buf_frames;
         }
+        while (frames != 0) {
+            size_t index = (size_t)(pos & (er->reader_buf_frames - 1));
+            size_t part = er->reader_buf_frames - index;
+            if (part > frames) {
+                part = frames;
+            }
+            memcpy((char *)er->reader_buf + index * er->rd_frame_size,
+                   src, part * er->rd_frame_size);
+            src += part * er->rd_frame_size;
+            pos += part;
+            frames -= part;
+        }
+        // release so that readers observe the frames before the new position
+        atomic_store_explicit(&er->reader_wr_pos, wrPos + inFrames, memory_order_release);
+    }
+
+    if ((er->state & ECHOREF_READING) == 0) {
+        goto exit;
+    }
+
+    status = echo_reference_ring_grow(er, echo_reference_frames_in(er) + inFrames);
+    if (status != 0) {
+        goto exit;
+    }
+    echo_reference_ring_put(er, srcBuf, er->buf_wr_pos, inFrames);
+    er->buf_wr_pos += inFrames;
+
+    // Index the write for the binary search in read(): by convention the
+    // render time stamps the end of the written buffer, and the conversion
+    // delay is folded in here once rather than on every read.
+    int64_t playTimeNs = (int64_t)er->wr_render_time.tv_sec * 1000000000 +
+            er->wr_render_time.tv_nsec + er->playback_delay;
+    if (er->resampler != NULL) {
+        // the resampler already compensates part of the delay
+        playTimeNs -= er->resampler->delay_ns(er->resampler);
+    } else if (er->decimator != NULL) {
+        playTimeNs -= er->decimator->group_delay_ns;
     }
-    memcpy((char *)er->buffer + er->frames_in * er->rd_frame_size,
-           srcBuf,
-           inFrames * er->rd_frame_size);
-    er->frames_in += inFrames;
+    if (er->time_record_count == ECHOREF_MAX_TIME_RECORDS) {
+        memmove(&er->time_records[0], &er->time_records[1],
+                (ECHOREF_MAX_TIME_RECORDS - 1) * sizeof(er->time_records[0]));
+        er->time_record_count--;
+    }
+    er->time_records[er->time_record_count].pos = er->buf_wr_pos;
+    er->time_records[er->time_record_count].play_time_ns = playTimeNs;
+    er->time_record_count++;
 
     ALOGV("echo_reference_write() frames written:[%zu], frames total:[%zu] buffer size:[%zu]\n"
           "                       er->wr_render_time:[%d].[%d], er->playback_delay:[%d]",
-          inFrames, er->frames_in, er->buf_size,
+          inFrames, echo_reference_frames_in(er), er->buf_frames,
           (int)er->wr_render_time.tv_sec, (int)er->wr_render_time.tv_nsec, er->playback_delay);
 
     pthread_cond_signal(&er->cond);
@@ -325,7 +674,7 @@ static int echo_reference_read(struct echo_reference_itfe *echo_reference,
 
     ALOGV("echo_reference_read() START, delayCapture:[%d], "
             "er->frames_in:[%zu],buffer->frame_count:[%zu]",
-    buffer->delay_ns, er->frames_in, buffer->frame_count);
+    buffer->delay_ns, echo_reference_frames_in(er), buffer->frame_count);
 
     if ((er->state & ECHOREF_READING) == 0) {
         ALOGV("echo_reference_read() start read");
@@ -342,7 +691,7 @@ static int echo_reference_read(struct echo_reference_itfe *echo_reference,
 //    ALOGV("echo_reference_read() %d frames", buffer->frame_count);
 
     // allow some time for new frames to arrive if not enough frames are ready for read
-    if (er->frames_in < buffer->frame_count) {
+    if (echo_reference_frames_in(er) < buffer->frame_count) {
         uint32_t timeoutMs = (uint32_t)((1000 * buffer->frame_count) / er->rd_sampling_rate / 2);
         struct timespec ts = {0, 0};
 
@@ -357,148 +706,114 @@ static int echo_reference_read(struct echo_reference_itfe *echo_reference,
 
         pthread_cond_timedwait(&er->cond, &er->lock, &ts);
 
-        ALOGV_IF((er->frames_in < buffer->frame_count),
+        ALOGV_IF((echo_reference_frames_in(er) < buffer->frame_count),
                  "echo_reference_read() waited %d ms but still not enough frames"
                  " er->frames_in: %zu, buffer->frame_count = %zu",
-                 timeoutMs, er->frames_in, buffer->frame_count);
+                 timeoutMs, echo_reference_frames_in(er), buffer->frame_count);
     }
 
-    int64_t timeDiff;
-    struct timespec tmp;
-
-    if ((er->wr_render_time.tv_sec == 0 && er->wr_render_time.tv_nsec == 0) ||
-        (buffer->time_stamp.tv_sec == 0 && buffer->time_stamp.tv_nsec == 0)) {
-        ALOGV("echo_reference_read(): NEW:timestamp is zero---------setting timeDiff = 0, "
+    if ((buffer->time_stamp.tv_sec == 0 && buffer->time_stamp.tv_nsec == 0) ||
+            er->time_record_count == 0) {
+        ALOGV("echo_reference_read(): NEW:timestamp is zero---------"
              "not updating delay this time");
-        timeDiff = 0;
     } else {
-        if (buffer->time_stamp.tv_nsec < er->wr_render_time.tv_nsec) {
-            tmp.tv_sec = buffer->time_stamp.tv_sec - er->wr_render_time.tv_sec - 1;
-            tmp.tv_nsec = 1000000000 + buffer->time_stamp.tv_nsec - er->wr_render_time.tv_nsec;
-        } else {
-            tmp.tv_sec = buffer->time_stamp.tv_sec - er->wr_render_time.tv_sec;
-            tmp.tv_nsec = buffer->time_stamp.tv_nsec - er->wr_render_time.tv_nsec;
-        }
-        timeDiff = (((int64_t)tmp.tv_sec * 1000000000 + tmp.tv_nsec));
-
-        int64_t expectedDelayNs =  er->playback_delay + buffer->delay_ns - timeDiff;
-
-        if (er->resampler != NULL) {
-            // Resampler already compensates part of the delay
-            int32_t rsmp_delay = er->resampler->delay_ns(er->resampler);
-            expectedDelayNs -= rsmp_delay;
+        // capture time of the first frame in the microphone buffer
+        const int64_t micTimeNs = (int64_t)buffer->time_stamp.tv_sec * 1000000000 +
+                buffer->time_stamp.tv_nsec - buffer->delay_ns;
+
+        // binary search for the oldest record whose frames finish rendering
+        // at or after the capture time
+        size_t lo = 0;
+        size_t hi = er->time_record_count;
+        while (lo < hi) {
+            const size_t mid = (lo + hi) / 2;
+            if (er->time_records[mid].play_time_ns < micTimeNs) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
         }
-
-        ALOGV("echo_reference_read(): expectedDelayNs[%" PRId64 "] = "
-                "er->playback_delay[%d] + delayCapture[%d"
-                "] - timeDiff[%" PRId64 "]",
-                expectedDelayNs, er->playback_delay, buffer->delay_ns, timeDiff);
-
-        if (expectedDelayNs > 0) {
-            int64_t delayNs = ((int64_t)er->frames_in * 1000000000) / er->rd_sampling_rate;
-
-            int64_t  deltaNs = delayNs - expectedDelayNs;
-
-            ALOGV("echo_reference_read(): EchoPathDelayDeviation between reference and DMA [%"
-                    PRId64 "]", deltaNs);
-            if (llabs(deltaNs) >= MIN_DELAY_DELTA_NS) {
-                // smooth the variation and update the reference buffer only
-                // if a deviation in the same direction is observed for more than MIN_DELTA_NUM
-                // consecutive reads.
-                int16_t delay_sign = (deltaNs >= 0) ? 1 : -1;
-                if (delay_sign == er->prev_delta_sign) {
-                    er->delta_count++;
-                } else {
-                    er->delta_count = 1;
-                }
-                er->prev_delta_sign = delay_sign;
-
-                if (er->delta_count > MIN_DELTA_NUM) {
-                    size_t previousFrameIn = er->frames_in;
-                    er->frames_in = (size_t)((expectedDelayNs * er->rd_sampling_rate)/1000000000);
-                    int offset = er->frames_in - previousFrameIn;
-
-                    ALOGV("echo_reference_read(): deltaNs ENOUGH and %s: "
-                            "er->frames_in: %zu, previousFrameIn = %zu",
-                         delay_sign ? "positive" : "negative", er->frames_in, previousFrameIn);
-
-                    if (deltaNs < 0) {
-                        // Less data available in the reference buffer than expected
-                        if (er->frames_in > er->buf_size) {
-                            er->buf_size = er->frames_in;
-                            ALOGV("echo_reference_read(): increasing buffer size to %zu",
-                                  er->buf_size);
-                            void *new_buf = realloc(er->buffer, er->buf_size * er->rd_frame_size);
-                            if (new_buf == NULL) {
-                                status = -ENOMEM;
-                                goto exit;
-                            } else {
-                                er->buffer = new_buf;
-                            }
-                        }
-
-                        if (offset > 0) {
-                            memset((char *)er->buffer + previousFrameIn * er->rd_frame_size,
-                                   0, offset * er->rd_frame_size);
-                            ALOGV("echo_reference_read(): pushing ref buffer by [%d]", offset);
-                        }
-                    } else {
-                        // More data available in the reference buffer than expected
-                        offset = -offset;
-                        if (offset > 0) {
-                            memcpy(er->buffer, (char *)er->buffer + (offset * er->rd_frame_size),
-                                   er->frames_in * er->rd_frame_size);
-                            ALOGV("echo_reference_read(): shifting ref buffer by [%zu]",
-                                  er->frames_in);
-                        }
-                    }
-                }
+        // when the capture time is past every record, extrapolate from the newest
+        const struct echo_reference_time_record *rec =
+                &er->time_records[lo < er->time_record_count ? lo : er->time_record_count - 1];
+        const int64_t targetPos = (int64_t)rec->pos +
+                ((micTimeNs - rec->play_time_ns) * (int64_t)er->rd_sampling_rate) / 1000000000;
+        const int64_t deltaNs = ((targetPos - (int64_t)er->buf_rd_pos) * 1000000000) /
+                er->rd_sampling_rate;
+
+        ALOGV("echo_reference_read(): EchoPathDelayDeviation between reference and DMA [%"
+                PRId64 "]", deltaNs);
+        if (llabs(deltaNs) >= MIN_DELAY_DELTA_NS) {
+            // smooth the variation and realign the read position only if a
+            // deviation in the same direction is observed for more than
+            // MIN_DELTA_NUM consecutive reads.
+            int16_t delay_sign = (deltaNs >= 0) ? 1 : -1;
+            if (delay_sign == er->prev_delta_sign) {
+                er->delta_count++;
             } else {
+                er->delta_count = 1;
+            }
+            er->prev_delta_sign = delay_sign;
+
+            if (er->delta_count > MIN_DELTA_NUM) {
+                ALOGV("echo_reference_read(): deltaNs ENOUGH and %s: "
+                        "realigning read position by [%" PRId64 "] frames",
+                        delay_sign > 0 ? "positive" : "negative",
+                        targetPos - (int64_t)er->buf_rd_pos);
+                er->buf_rd_pos = targetPos > 0 ? (uint64_t)targetPos : 0;
                 er->delta_count = 0;
                 er->prev_delta_sign = 0;
-                ALOGV("echo_reference_read(): Constant EchoPathDelay - difference "
-                        "between reference and DMA %" PRId64, deltaNs);
             }
         } else {
-            ALOGV("echo_reference_read(): NEGATIVE expectedDelayNs[%" PRId64
-                 "] = er->playback_delay[%d] + delayCapture[%d"
-                 "] - timeDiff[%" PRId64 "]",
-                 expectedDelayNs, er->playback_delay, buffer->delay_ns, timeDiff);
+            er->delta_count = 0;
+            er->prev_delta_sign = 0;
+            ALOGV("echo_reference_read(): Constant EchoPathDelay - difference "
+                    "between reference and DMA %" PRId64, deltaNs);
         }
     }
 
-    if (er->frames_in < buffer->frame_count) {
-        if (buffer->frame_count > er->buf_size) {
-            er->buf_size = buffer->frame_count;
-            ALOGV("echo_reference_read(): increasing buffer size to %zu", er->buf_size);
-            void *new_buf  = realloc(er->buffer, er->buf_size * er->rd_frame_size);
-            if (new_buf == NULL) {
-                status = -ENOMEM;
-                goto exit;
-            } else {
-                er->buffer = new_buf;
+    {
+        // Copy from the ring.  Positions ahead of the writer (reference not
+        // produced yet) or older than the retained history read as silence,
+        // which replaces the old zero padding and buffer shifting.
+        const size_t framesIn = echo_reference_frames_in(er);
+        size_t copyFrames = buffer->frame_count;
+        if (copyFrames > framesIn) {
+            copyFrames = framesIn;
+        }
+        const uint64_t oldest = er->buf_wr_pos > er->buf_frames ?
+                er->buf_wr_pos - er->buf_frames : 0;
+        size_t leadSilence = 0;
+        if (oldest > er->buf_rd_pos) {
+            leadSilence = (size_t)(oldest - er->buf_rd_pos);
+            if (leadSilence > copyFrames) {
+                leadSilence = copyFrames;
             }
+            memset(buffer->raw, 0, leadSilence * er->rd_frame_size);
+        }
+        echo_reference_ring_get(er, (char *)buffer->raw + leadSilence * er->rd_frame_size,
+                er->buf_rd_pos + leadSilence, copyFrames - leadSilence);
+        if (copyFrames < buffer->frame_count) {
+            // filling up the reference buffer with 0s to match the expected delay.
+            memset((char *)buffer->raw + copyFrames * er->rd_frame_size,
+                   0, (buffer->frame_count - copyFrames) * er->rd_frame_size);
+        }
+        er->buf_rd_pos += copyFrames;
+
+        // drop index records fully behind the read position, always keeping
+        // the newest one as the interpolation anchor
+        while (er->time_record_count > 1 && er->time_records[1].pos <= er->buf_rd_pos) {
+            memmove(&er->time_records[0], &er->time_records[1],
+                    (er->time_record_count - 1) * sizeof(er->time_records[0]));
+            er->time_record_count--;
         }
-        // filling up the reference buffer with 0s to match the expected delay.
-        memset((char *)er->buffer + er->frames_in * er->rd_frame_size,
-            0, (buffer->frame_count - er->frames_in) * er->rd_frame_size);
-        er->frames_in = buffer->frame_count;
     }
 
-    memcpy(buffer->raw,
-           (char *)er->buffer,
-           buffer->frame_count * er->rd_frame_size);
-
-    er->frames_in -= buffer->frame_count;
-    memcpy(er->buffer,
-           (char *)er->buffer + buffer->frame_count * er->rd_frame_size,
-           er->frames_in * er->rd_frame_size);
-
     // As the reference buffer is now time aligned to the microphone signal there is a zero delay
     buffer->delay_ns = 0;
 
     ALOGV("echo_reference_read() END %zu frames, total frames in %zu",
-          buffer->frame_count, er->frames_in);
+          buffer->frame_count, echo_reference_frames_in(er));
 
     pthread_cond_signal(&er->cond);
 
@@ -508,6 +823,154 @@ exit:
 }
 
 
+static int echo_reference_read_reader(struct echo_reference_itfe *echo_reference,
+                         struct echo_reference_buffer *buffer)
+{
+    struct echo_reference_reader *reader = (struct echo_reference_reader *)echo_reference;
+    struct echo_reference *er;
+
+    if (reader == NULL) {
+        return -EINVAL;
+    }
+
+    er = reader->er;
+
+    if (buffer == NULL) {
+        ALOGV("echo_reference_read_reader() stop read");
+        // skip to the most recent frames so a later read does not return stale data
+        reader->rd_pos = atomic_load_explicit(&er->reader_wr_pos, memory_order_acquire);
+        return 0;
+    }
+
+    const uint64_t wrPos = atomic_load_explicit(&er->reader_wr_pos, memory_order_acquire);
+
+    if (reader->rd_pos + er->reader_buf_frames < wrPos) {
+        // the writer lapped this reader: resynchronize on recent frames, keeping
+        // half the ring of headroom so the copy below is not overwritten while it runs
+        ALOGV("echo_reference_read_reader() overrun, skipping %" PRIu64 " frames",
+              wrPos - reader->rd_pos);
+        reader->rd_pos = wrPos - er->reader_buf_frames / 2;
+    }
+
+    size_t frames = buffer->frame_count;
+    const uint64_t avail = wrPos - reader->rd_pos;
+    if (frames > avail) {
+        frames = (size_t)avail;
+    }
+
+    char *dst = (char *)buffer->raw;
+    uint64_t pos = reader->rd_pos;
+    size_t framesLeft = frames;
+    while (framesLeft != 0) {
+        size_t index = (size_t)(pos & (er->reader_buf_frames - 1));
+        size_t part = er->reader_buf_frames - index;
+        if (part > framesLeft) {
+            part = framesLeft;
+        }
+        memcpy(dst, (char *)er->reader_buf + index * er->rd_frame_size,
+               part * er->rd_frame_size);
+        dst += part * er->rd_frame_size;
+        pos += part;
+        framesLeft -= part;
+    }
+
+    // The writer may have overwritten the frames while they were being copied.
+    // The fence orders the copy above before rechecking the write position.
+    atomic_thread_fence(memory_order_acquire);
+    const uint64_t endPos = atomic_load_explicit(&er->reader_wr_pos, memory_order_relaxed);
+    if (endPos - reader->rd_pos > er->reader_buf_frames) {
+        // torn copy: drop it and resynchronize
+        reader->rd_pos = endPos;
+        frames = 0;
+    } else {
+        reader->rd_pos += frames;
+    }
+
+    buffer->frame_count = frames;
+    // readers are not delay adjusted against the microphone signal
+    buffer->delay_ns = 0;
+
+    ALOGV("echo_reference_read_reader() END %zu frames", frames);
+    return 0;
+}
+
+int echo_reference_create_reader(struct echo_reference_itfe *echo_reference,
+                                 struct echo_reference_itfe **reader)
+{
+    struct echo_reference *er = (struct echo_reference *)echo_reference;
+    struct echo_reference_reader *rd = NULL;
+    int status = 0;
+    size_t i;
+
+    ALOGV("echo_reference_create_reader()");
+
+    if (er == NULL || reader == NULL) {
+        return -EINVAL;
+    }
+
+    *reader = NULL;
+
+    pthread_mutex_lock(&er->lock);
+
+    if (er->reader_buf == NULL) {
+        // hold about half a second of reference so slow readers are not lapped,
+        // rounded up to a power of two for cheap ring index arithmetic
+        size_t frames = 1;
+        while (frames < er->rd_sampling_rate / 2) {
+            frames <<= 1;
+        }
+        er->reader_buf = calloc(frames, er->rd_frame_size);
+        if (er->reader_buf == NULL) {
+            status = -ENOMEM;
+            goto exit;
+        }
+        er->reader_buf_frames = frames;
+    }
+
+    for (i = 0; i < ECHOREF_MAX_READERS; i++) {
+        if (!er->readers[i].in_use) {
+            rd = &er->readers[i];
+            break;
+        }
+    }
+    if (rd == NULL) {
+        ALOGW("echo_reference_create_reader() all %d reader slots in use",
+              ECHOREF_MAX_READERS);
+        status = -ENOMEM;
+        goto exit;
+    }
+
+    rd->itfe.read = echo_reference_read_reader;
+    rd->itfe.write = NULL; // readers cannot write
+    rd->er = er;
+    rd->rd_pos = atomic_load_explicit(&er->reader_wr_pos, memory_order_relaxed);
+    rd->in_use = 1;
+    er->reader_count++;
+    *reader = &rd->itfe;
+
+exit:
+    pthread_mutex_unlock(&er->lock);
+    return status;
+}
+
+void echo_reference_release_reader(struct echo_reference_itfe *reader)
+{
+    struct echo_reference_reader *rd = (struct echo_reference_reader *)reader;
+    struct echo_reference *er;
+
+    if (rd == NULL) {
+        return;
+    }
+
+    ALOGV("echo_reference_release_reader()");
+
+    er = rd->er;
+    pthread_mutex_lock(&er->lock);
+    rd->in_use = 0;
+    er->reader_count--;
+    pthread_mutex_unlock(&er->lock);
+}
+
 int create_echo_reference(audio_format_t rdFormat,
                             uint32_t rdChannelCount,
                             uint32_t rdSamplingRate,
@@ -531,14 +994,31 @@ int create_echo_reference(audio_format_t rdFormat,
         ALOGW("create_echo_reference bad format rd %d, wr %d", rdFormat, wrFormat);
         return -EINVAL;
     }
+    // the reference is mono or stereo; playback may carry more channels
+    // (e.g. a multi-speaker zone) as long as they fold evenly onto the
+    // reference channels.
     if ((rdChannelCount != 1 && rdChannelCount != 2) ||
-            wrChannelCount != 2) {
+            wrChannelCount < rdChannelCount ||
+            wrChannelCount % rdChannelCount != 0) {
         ALOGW("create_echo_reference bad channel count rd %d, wr %d", rdChannelCount,
                 wrChannelCount);
         return -EINVAL;
     }
 
     er = (struct echo_reference *)calloc(1, sizeof(struct echo_reference));
+    if (er == NULL) {
+        return -ENOMEM;
+    }
+    er->wr_weights_q15 = (int32_t *)malloc(wrChannelCount * sizeof(*er->wr_weights_q15));
+    if (er->wr_weights_q15 == NULL) {
+        free(er);
+        return -ENOMEM;
+    }
+    // default fold: every write channel contributes equally to its
+    // reference channel.
+    for (uint32_t c = 0; c < wrChannelCount; c++) {
+        er->wr_weights_q15[c] = (int32_t)(1 << 15) / (int32_t)(wrChannelCount / rdChannelCount);
+    }
 
     er->itfe.read = echo_reference_read;
     er->itfe.write = echo_reference_write;
@@ -556,6 +1036,67 @@ int create_echo_reference(audio_format_t rdFormat,
     return 0;
 }
 
+int echo_reference_set_channel_weights(struct echo_reference_itfe *echo_reference,
+                                       const float *weights, size_t count)
+{
+    struct echo_reference *er = (struct echo_reference *)echo_reference;
+    int status = 0;
+
+    if (er == NULL) {
+        return -EINVAL;
+    }
+
+    pthread_mutex_lock(&er->lock);
+
+    const uint32_t in = er->wr_channel_count;
+    const uint32_t out = er->rd_channel_count;
+
+    if (weights == NULL) {
+        // restore the default equal weight fold
+        for (uint32_t c = 0; c < in; c++) {
+            er->wr_weights_q15[c] = (int32_t)(1 << 15) / (int32_t)(in / out);
+        }
+        goto exit;
+    }
+    if (count != in) {
+        status = -EINVAL;
+        goto exit;
+    }
+    // validate before applying anything: the weights must be non-negative
+    // (the comparison also rejects NaN) with a non-zero sum per reference
+    // channel.
+    for (uint32_t o = 0; o < out; o++) {
+        float sum = 0.f;
+        for (uint32_t c = o; c < in; c += out) {
+            if (!(weights[c] >= 0.f)) {
+                status = -EINVAL;
+                goto exit;
+            }
+            sum += weights[c];
+        }
+        if (sum <= 0.f) {
+            status = -EINVAL;
+            goto exit;
+        }
+    }
+    // normalize each reference channel to unity gain so the reference level
+    // does not depend on the absolute weight scale, and so the Q15 fold
+    // accumulator cannot overflow.
+    for (uint32_t o = 0; o < out; o++) {
+        float sum = 0.f;
+        for (uint32_t c = o; c < in; c += out) {
+            sum += weights[c];
+        }
+        for (uint32_t c = o; c < in; c += out) {
+            er->wr_weights_q15[c] = (int32_t)roundf(weights[c] / sum * (float)(1 << 15));
+        }
+    }
+
+exit:
+    pthread_mutex_unlock(&er->lock);
+    return status;
+}
+
 void release_echo_reference(struct echo_reference_itfe *echo_reference) {
     struct echo_reference *er = (struct echo_reference *)echo_reference;
 
@@ -568,5 +1109,8 @@ void release_echo_reference(struct echo_reference_itfe *echo_reference) {
     if (er->resampler != NULL) {
         release_resampler(er->resampler);
     }
+    echo_reference_release_decimator(er->decimator);
+    free(er->reader_buf);
+    free(er->wr_weights_q15);
     free(er);
 }
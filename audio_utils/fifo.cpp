@@ -16,16 +16,26 @@
 
 //#define LOG_NDEBUG 0
 #define LOG_TAG "audio_utils_fifo"
+#define ATRACE_TAG ATRACE_TAG_AUDIO
 
 #include <errno.h>
 #include <limits.h>
+#include <sched.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
 
+#include <audio_utils/Histogram.h>
+#include <audio_utils/PerfCounters.h>
+#include <audio_utils/clock.h>
 #include <audio_utils/clock_nanosleep.h>
 #include <audio_utils/fifo.h>
 #include <audio_utils/futex.h>
 #include <audio_utils/roundup.h>
+#include <cutils/trace.h>
 #include <log/log.h>
 #include <system/audio.h> // FALLTHROUGH_INTENDED
 #include <utils/Errors.h>
@@ -34,8 +44,9 @@ audio_utils_fifo_base::audio_utils_fifo_base(uint32_t frameCount,
         audio_utils_fifo_index& writerRear, audio_utils_fifo_index *throttleFront,
         audio_utils_fifo_sync sync)
         __attribute__((no_sanitize("integer"))) :
-    mFrameCount(frameCount), mFrameCountP2(roundup(frameCount)),
+    mFrameCount(frameCount), mFrameCountP2(audio_utils_next_pow2(frameCount)),
     mFudgeFactor(mFrameCountP2 - mFrameCount),
+    mFrameCountP2Shift((uint32_t) __builtin_ctz(mFrameCountP2)),
     // FIXME need an API to configure the sync types
     mWriterRear(writerRear), mWriterRearSync(sync),
     mThrottleFront(throttleFront), mThrottleFrontSync(sync),
@@ -56,9 +67,11 @@ uint32_t audio_utils_fifo_base::sum(uint32_t index, uint32_t increment) const
         uint32_t mask = mFrameCountP2 - 1;
         ALOG_ASSERT((index & mask) < mFrameCount);
         ALOG_ASSERT(increment <= mFrameCountP2);
-        if ((index & mask) + increment >= mFrameCount) {
-            increment += mFudgeFactor;
-        }
+        // Branch-free form of "if ((index & mask) + increment >= mFrameCount)
+        // increment += mFudgeFactor": the comparison result (0 or 1) scales the
+        // fudge factor, so skipping the wasted indices at the end of a generation
+        // doesn't cost a mispredicted branch on every wrap.
+        increment += mFudgeFactor * ((index & mask) + increment >= mFrameCount);
         index += increment;
         ALOG_ASSERT((index & mask) < mFrameCount);
         return index;
@@ -98,7 +111,10 @@ int32_t audio_utils_fifo_base::diff(uint32_t rear, uint32_t front, size_t *lost,
                 // Calculate the number of lost frames as the raw difference,
                 // less the mFrameCount frames that are still valid and can be read on retry,
                 // less the wasted indices that don't count as true lost frames.
-                *lost = diff - (flush ? 0 : mFrameCount) - mFudgeFactor * (genDiff/mFrameCountP2);
+                // genDiff / mFrameCountP2, without a hardware divide: the divisor is a
+                // power of two, so its reciprocal is the precomputed shift.
+                *lost = diff - (flush ? 0 : mFrameCount)
+                        - mFudgeFactor * (genDiff >> mFrameCountP2Shift);
             }
             return -EOVERFLOW;
         }
@@ -129,21 +145,24 @@ void audio_utils_fifo_base::shutdown() const
 ////////////////////////////////////////////////////////////////////////////////
 
 audio_utils_fifo::audio_utils_fifo(uint32_t frameCount, uint32_t frameSize, void *buffer,
-        audio_utils_fifo_index& writerRear, audio_utils_fifo_index *throttleFront)
+        audio_utils_fifo_index& writerRear, audio_utils_fifo_index *throttleFront,
+        audio_utils_fifo_index *flushEpoch)
         __attribute__((no_sanitize("integer"))) :
     audio_utils_fifo_base(frameCount, writerRear, throttleFront, AUDIO_UTILS_FIFO_SYNC_SHARED),
-    mFrameSize(frameSize), mBuffer(buffer)
+    mFrameSize(frameSize), mBuffer(buffer), mFlushEpoch(flushEpoch), mIntegrityTags(NULL)
 {
     // maximum value of frameCount * frameSize is INT32_MAX (2^31 - 1), not 2^31, because we need to
     // be able to distinguish successful and error return values from read and write.
     LOG_ALWAYS_FATAL_IF(frameCount == 0 || frameSize == 0 || buffer == NULL ||
             frameCount > ((uint32_t) INT32_MAX) / frameSize);
+    (void) snprintf(mTraceName, sizeof(mTraceName), "afifo_%p_fill", this);
 }
 
 audio_utils_fifo::audio_utils_fifo(uint32_t frameCount, uint32_t frameSize, void *buffer,
         bool throttlesWriter, audio_utils_fifo_sync sync) :
     audio_utils_fifo(frameCount, frameSize, buffer, mSingleProcessSharedRear,
-        throttlesWriter ?  &mSingleProcessSharedFront : NULL)
+        throttlesWriter ?  &mSingleProcessSharedFront : NULL,
+        throttlesWriter ?  &mSingleProcessSharedFlushEpoch : NULL)
 {
     LOG_ALWAYS_FATAL_IF(sync == AUDIO_UTILS_FIFO_SYNC_SHARED);
 }
@@ -163,10 +182,86 @@ audio_utils_fifo_provider::~audio_utils_fifo_provider()
 {
 }
 
+void audio_utils_fifo_provider::enableWaitHistogram(int32_t subBucketBits, int64_t maxNs)
+{
+    mWaitHistogram = std::make_unique<android::audio_utils::LogHistogram>(subBucketBits, maxNs);
+}
+
+void audio_utils_fifo_provider::recordWaitNs(int64_t ns)
+{
+    mWaitCount++;
+    mWaitTotalNs += ns;
+    if (ns > mWaitMaxNs) {
+        mWaitMaxNs = ns;
+    }
+    if (mWaitHistogram != NULL) {
+        mWaitHistogram->add(ns);
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
+namespace {
+
+/**
+ * CRC-32C (Castagnoli) over \p length bytes at \p data, as computed by the SSE4.2 and
+ * ARMv8 CRC instructions.  Used by the integrity mode of write() and read(); the hardware
+ * paths keep the per-frame cost to a few cycles per word, so tagging during the copy is
+ * near free, and the portable fallback is table-driven.
+ *
+ * \param crc    Seed; the frame's sequence number in integrity mode.
+ * \param data   Non-NULL pointer to the bytes to checksum.
+ * \param length Number of bytes to checksum.
+ *
+ * \return The CRC-32C of the bytes.
+ */
+uint32_t crc32c(uint32_t crc, const void *data, size_t length)
+{
+    const uint8_t *p = (const uint8_t *) data;
+    crc = ~crc;
+#if defined(__SSE4_2__)
+    for (; length >= sizeof(uint32_t); length -= sizeof(uint32_t), p += sizeof(uint32_t)) {
+        uint32_t word;
+        memcpy(&word, p, sizeof(word));
+        crc = __builtin_ia32_crc32si(crc, word);
+    }
+    for (; length > 0; length--, p++) {
+        crc = __builtin_ia32_crc32qi(crc, *p);
+    }
+#elif defined(__ARM_FEATURE_CRC32)
+    for (; length >= sizeof(uint32_t); length -= sizeof(uint32_t), p += sizeof(uint32_t)) {
+        uint32_t word;
+        memcpy(&word, p, sizeof(word));
+        crc = __crc32cw(crc, word);
+    }
+    for (; length > 0; length--, p++) {
+        crc = __crc32cb(crc, *p);
+    }
+#else
+    static const uint32_t *table = [] {
+        uint32_t *t = new uint32_t[256];
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c >> 1) ^ ((c & 1) ? 0x82F63B78 : 0);
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+    for (; length > 0; length--, p++) {
+        crc = table[(crc ^ *p) & 0xFF] ^ (crc >> 8);
+    }
+#endif
+    return ~crc;
+}
+
+}   // namespace
+
 audio_utils_fifo_writer::audio_utils_fifo_writer(audio_utils_fifo& fifo) :
-    audio_utils_fifo_provider(fifo), mLocalRear(0),
+    audio_utils_fifo_provider(fifo), mLocalRear(0), mCachedAvail(0),
+    mLocalFlushEpoch(fifo.mFlushEpoch != NULL ? fifo.mFlushEpoch->loadAcquire() : 0),
+    mPaced(false), mNsPerFrame(0), mPacedLastFront(0), mPacedLastNs(0),
     mArmLevel(fifo.mFrameCount), mTriggerLevel(0),
     mIsArmed(true), // because initial fill level of zero is < mArmLevel
     mEffectiveFrames(fifo.mFrameCount)
@@ -191,6 +286,28 @@ ssize_t audio_utils_fifo_writer::write(const void *buffer, size_t count,
                     (char *) buffer + (iovec[0].mLength * mFifo.mFrameSize),
                     iovec[1].mLength * mFifo.mFrameSize);
         }
+        if (mFifo.mIntegrityTags != NULL) {
+            // Tag each frame from the source buffer, which is still warm from the copy
+            // above; the CRC is over the writer's private copy, so corruption anywhere in
+            // the shared buffer afterwards is caught by the reader.  The tags are published
+            // to the reader by the index store-release in release() below.
+            const char *frame = (const char *) buffer;
+            uint32_t sequence = mLocalRear;
+            for (int i = 0; i < 2; i++) {
+                if (i == 1) {
+                    // The index space skips mFudgeFactor values at the buffer wrap for
+                    // non-power-of-2 frame counts (see sum()), so re-derive the second
+                    // iovec's start: the reader may wrap at a different batch boundary.
+                    sequence = mFifo.sum(mLocalRear, iovec[0].mLength);
+                }
+                audio_utils_fifo_integrity_tag *tag = &mFifo.mIntegrityTags[iovec[i].mOffset];
+                for (uint32_t j = 0; j < iovec[i].mLength;
+                        j++, tag++, sequence++, frame += mFifo.mFrameSize) {
+                    tag->mSequence = sequence;
+                    tag->mCrc = crc32c(sequence, frame, mFifo.mFrameSize);
+                }
+            }
+        }
         release(availToWrite);
     }
     return availToWrite;
@@ -203,12 +320,20 @@ ssize_t audio_utils_fifo_writer::obtain(audio_utils_iovec iovec[2], size_t count
 {
     int err = 0;
     size_t availToWrite;
-    if (mFifo.mThrottleFront != NULL) {
+    if (mFifo.mThrottleFront != NULL && count > 0 && count <= mCachedAvail) {
+        // Fast path: the request fits within the writer-local available count,
+        // so skip the load of the reader's front index; see mCachedAvail in fifo.h.
+        // Shutdown or index corruption is detected on the next refresh instead.
+        availToWrite = count;
+    } else if (mFifo.mThrottleFront != NULL) {
         int retries = kRetries;
         for (;;) {
             uint32_t front = mFifo.mThrottleFrontSync == AUDIO_UTILS_FIFO_SYNC_SINGLE_THREADED ?
                     mFifo.mThrottleFront->loadSingleThreaded() :
                     mFifo.mThrottleFront->loadAcquire();
+            if (mPaced) {
+                updateReaderRate(front);
+            }
             // returns -EIO if mIsShutdown
             int32_t filled = mFifo.diff(mLocalRear, front);
             if (filled < 0) {
@@ -228,6 +353,9 @@ ssize_t audio_utils_fifo_writer::obtain(audio_utils_iovec iovec[2], size_t count
             // TODO abstract out switch and replace by general sync object
             //      the high level code (synchronization, sleep, futex, iovec) should be completely
             //      separate from the low level code (indexes, available, masking).
+            struct timespec stallStart;
+            clock_gettime(CLOCK_MONOTONIC, &stallStart);
+            atrace_begin(ATRACE_TAG, "afifo_write_wait");
             int op = FUTEX_WAIT;
             switch (mFifo.mThrottleFrontSync) {
             case AUDIO_UTILS_FIFO_SYNC_SINGLE_THREADED:
@@ -247,6 +375,12 @@ ssize_t audio_utils_fifo_writer::obtain(audio_utils_iovec iovec[2], size_t count
                 op = FUTEX_WAIT_PRIVATE;
                 FALLTHROUGH_INTENDED;
             case AUDIO_UTILS_FIFO_SYNC_SHARED:
+                if (mPaced && mNsPerFrame > 0) {
+                    // Sleep for the expected reader drain time instead of parking on the
+                    // futex, then re-poll; see setPaced() in fifo.h.
+                    err = pacedWait(count, timeout);
+                    break;
+                }
                 if (timeout->tv_sec == LONG_MAX) {
                     timeout = NULL;
                 }
@@ -258,6 +392,9 @@ ssize_t audio_utils_fifo_writer::obtain(audio_utils_iovec iovec[2], size_t count
                         // changed value between the earlier atomic_load_explicit() and sys_futex().
                         // Try to load index again, but give up if we are unable to converge.
                         if (retries-- > 0) {
+                            // balance the slice before retrying; the next
+                            // iteration opens its own if it waits again
+                            atrace_end(ATRACE_TAG);
                             // bypass the "timeout = NULL;" below
                             continue;
                         }
@@ -276,8 +413,24 @@ ssize_t audio_utils_fifo_writer::obtain(audio_utils_iovec iovec[2], size_t count
                 LOG_ALWAYS_FATAL("mFifo.mThrottleFrontSync=%d", mFifo.mThrottleFrontSync);
                 break;
             }
+            // every remaining path out of the switch executed the begin above;
+            // end unconditionally so the slice cannot leak open on this thread
+            atrace_end(ATRACE_TAG);
+            if (err != -ENOTSUP) {
+                struct timespec stallEnd;
+                clock_gettime(CLOCK_MONOTONIC, &stallEnd);
+                const int64_t stallNs = audio_utils_ns_from_timespec(&stallEnd)
+                        - audio_utils_ns_from_timespec(&stallStart);
+                audio_utils_perf_counter_add(AUDIO_UTILS_PERF_COUNTER_FIFO_WRITE_STALLS, 1);
+                audio_utils_perf_histogram_add(AUDIO_UTILS_PERF_HISTOGRAM_FIFO_WRITE_STALL_NS,
+                        stallNs);
+                recordWaitNs(stallNs);
+            }
             timeout = NULL;
         }
+        // availToWrite came from a real load of the front index, before any
+        // clamp to count, so it is the freshest possible cached value.
+        mCachedAvail = availToWrite;
     } else {
         if (mFifo.mIsShutdown) {
             err = -EIO;
@@ -320,6 +473,9 @@ void audio_utils_fifo_writer::release(size_t count)
             uint32_t front = mFifo.mThrottleFrontSync == AUDIO_UTILS_FIFO_SYNC_SINGLE_THREADED ?
                     mFifo.mThrottleFront->loadSingleThreaded() :
                     mFifo.mThrottleFront->loadAcquire();
+            if (mPaced) {
+                updateReaderRate(front);
+            }
             // returns -EIO if mIsShutdown
             int32_t filled = mFifo.diff(mLocalRear, front);
             mLocalRear = mFifo.sum(mLocalRear, count);
@@ -328,6 +484,16 @@ void audio_utils_fifo_writer::release(size_t count)
             } else {
                 mFifo.mWriterRear.storeRelease(mLocalRear);
             }
+            // Refresh the cached available count for free from the front index
+            // load above; after this release the fill level is filled + count.
+            if (filled >= 0) {
+                const uint32_t newFilled = (uint32_t) filled + count;
+                mCachedAvail = mEffectiveFrames > newFilled ? mEffectiveFrames - newFilled : 0;
+                // gated on the audio trace category; one relaxed load when tracing is off
+                atrace_int(ATRACE_TAG, mFifo.mTraceName, (int32_t) newFilled);
+            } else {
+                mCachedAvail = 0;
+            }
             // TODO add comments
             int op = FUTEX_WAKE;
             switch (mFifo.mWriterRearSync) {
@@ -392,6 +558,8 @@ void audio_utils_fifo_writer::resize(uint32_t frameCount)
         }
     }
     mEffectiveFrames = frameCount;
+    // force obtain() to recompute against the new effective buffer size
+    mCachedAvail = 0;
 }
 
 uint32_t audio_utils_fifo_writer::size() const
@@ -422,6 +590,205 @@ void audio_utils_fifo_writer::getHysteresis(uint32_t *armLevel, uint32_t *trigge
     *triggerLevel = mTriggerLevel;
 }
 
+bool audio_utils_fifo_writer::flushRequested()
+{
+    if (mFifo.mFlushEpoch == NULL) {
+        return false;
+    }
+    // The epoch cell is only stored by the throttling reader and is low-rate,
+    // so a plain load-acquire is used for all sync types.
+    const uint32_t epoch = mFifo.mFlushEpoch->loadAcquire();
+    if (epoch == mLocalFlushEpoch) {
+        return false;
+    }
+    mLocalFlushEpoch = epoch;
+    return true;
+}
+
+void audio_utils_fifo_writer::setPaced(bool paced)
+{
+    mPaced = paced;
+    // restart the estimate so a stale rate from a previous paced episode is not reused
+    mNsPerFrame = 0;
+    mPacedLastNs = 0;
+}
+
+void audio_utils_fifo_writer::updateReaderRate(uint32_t front)
+        __attribute__((no_sanitize("integer")))
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    const int64_t nowNs = audio_utils_ns_from_timespec(&now);
+    if (mPacedLastNs == 0) {
+        // first sample only establishes the baseline
+        mPacedLastFront = front;
+        mPacedLastNs = nowNs;
+        return;
+    }
+    // Raw index difference; for a non-power-of-2 frame count this includes the
+    // fudge indices skipped at each generation, slightly over-reporting the
+    // advance, which is acceptable for a rate estimate.
+    const uint32_t advance = front - mPacedLastFront;
+    if (advance == 0) {
+        // the reader has not run yet; keep the baseline so elapsed time accumulates
+        return;
+    }
+    const int64_t elapsedNs = nowNs - mPacedLastNs;
+    mPacedLastFront = front;
+    mPacedLastNs = nowNs;
+    if (elapsedNs <= 0 || advance > mFifo.mFrameCountP2) {
+        // clock went backwards, or the sample is stale across a reader catch-up
+        return;
+    }
+    const int64_t nsPerFrame = elapsedNs / advance;
+    if (nsPerFrame == 0) {
+        return;
+    }
+    // Smooth over a few samples so one early or late reader release does not
+    // swing the pace; weight 1/4 converges within a handful of periods.
+    mNsPerFrame = mNsPerFrame == 0 ? nsPerFrame : (3 * mNsPerFrame + nsPerFrame) / 4;
+}
+
+int audio_utils_fifo_writer::pacedWait(size_t count, const struct timespec *timeout)
+        __attribute__((no_sanitize("integer")))
+{
+    uint32_t framesNeeded = count < (size_t) mEffectiveFrames ? (uint32_t) count :
+            mEffectiveFrames;
+    if (framesNeeded == 0) {
+        framesNeeded = 1;
+    }
+    int64_t sleepNs = framesNeeded * mNsPerFrame;
+    if (sleepNs < kPacedMinSleepNs) {
+        sleepNs = kPacedMinSleepNs;
+    } else if (sleepNs > kPacedMaxSleepNs) {
+        sleepNs = kPacedMaxSleepNs;
+    }
+    bool clipped = false;
+    if (timeout->tv_sec != LONG_MAX) {
+        const int64_t timeoutNs = audio_utils_ns_from_timespec(timeout);
+        if (sleepNs >= timeoutNs) {
+            sleepNs = timeoutNs;
+            clipped = true;
+        }
+    }
+    struct timespec sleep;
+    sleep.tv_sec = sleepNs / NANOS_PER_SECOND;
+    sleep.tv_nsec = sleepNs % NANOS_PER_SECOND;
+    int err = audio_utils_clock_nanosleep(CLOCK_MONOTONIC, 0 /*flags*/, &sleep, NULL /*remain*/);
+    if (err < 0) {
+        LOG_ALWAYS_FATAL_IF(errno != EINTR, "unexpected err=%d errno=%d", err, errno);
+        return -errno;
+    }
+    return clipped ? -ETIMEDOUT : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+audio_utils_fifo_multiwriter::audio_utils_fifo_multiwriter(audio_utils_fifo& fifo) :
+    mFifo(fifo), mReserveRear(fifo.mWriterRear.loadAcquire()), mTotalReleased(0)
+{
+    LOG_ALWAYS_FATAL_IF(fifo.mWriterRearSync == AUDIO_UTILS_FIFO_SYNC_SINGLE_THREADED);
+}
+
+audio_utils_fifo_multiwriter::~audio_utils_fifo_multiwriter()
+{
+}
+
+ssize_t audio_utils_fifo_multiwriter::write(const void *buffer, size_t count)
+        __attribute__((no_sanitize("integer")))
+{
+    // Phase 1: claim a slice by advancing the reservation index.
+    // The claim is bounded against the throttling reader's front if there is one,
+    // or against the published rear otherwise, so that a claim can never overlap
+    // a slice that another writer is still copying into.
+    uint32_t localRear;
+    size_t availToWrite;
+    for (;;) {
+        localRear = mReserveRear.load(std::memory_order_relaxed);
+        const uint32_t front = mFifo.mThrottleFront != NULL ?
+                mFifo.mThrottleFront->loadAcquire() : mFifo.mWriterRear.loadAcquire();
+        // returns -EIO if mIsShutdown
+        const int32_t filled = mFifo.diff(localRear, front);
+        if (filled < 0) {
+            return filled;
+        }
+        availToWrite = mFifo.mFrameCount - (uint32_t) filled;
+        if (availToWrite > count) {
+            availToWrite = count;
+        }
+        if (availToWrite == 0) {
+            return 0;
+        }
+        const uint32_t newRear = mFifo.sum(localRear, availToWrite);
+        if (mReserveRear.compare_exchange_weak(localRear, newRear,
+                std::memory_order_relaxed)) {
+            break;
+        }
+        // lost the race with another writer, re-evaluate
+    }
+
+    // Phase 2: copy into the claimed slice, no locks held.
+    const uint32_t rearOffset = localRear & (mFifo.mFrameCountP2 - 1);
+    size_t part1 = mFifo.mFrameCount - rearOffset;
+    if (part1 > availToWrite) {
+        part1 = availToWrite;
+    }
+    const size_t part2 = availToWrite - part1;
+    memcpy((char *) mFifo.mBuffer + rearOffset * mFifo.mFrameSize, buffer,
+            part1 * mFifo.mFrameSize);
+    if (part2 > 0) {
+        memcpy((char *) mFifo.mBuffer, (char *) buffer + (part1 * mFifo.mFrameSize),
+                part2 * mFifo.mFrameSize);
+    }
+
+    // Phase 3: publish in claim order.  If an earlier claim has not been published
+    // yet, spin until the published rear catches up to the start of our slice.
+    for (uint32_t spins = 0; mFifo.mWriterRear.loadAcquire() != localRear; ++spins) {
+        if (spins >= kSpinsBeforeYield) {
+            sched_yield();
+        }
+    }
+    mFifo.mWriterRear.storeRelease(mFifo.sum(localRear, availToWrite));
+    mTotalReleased.fetch_add(availToWrite, std::memory_order_relaxed);
+
+    // Wake any readers blocked waiting for data.
+    // No hysteresis: each publication is assumed to be a period's worth of data.
+    int op = FUTEX_WAKE;
+    switch (mFifo.mWriterRearSync) {
+    case AUDIO_UTILS_FIFO_SYNC_SLEEP:
+        break;
+    case AUDIO_UTILS_FIFO_SYNC_PRIVATE:
+        op = FUTEX_WAKE_PRIVATE;
+        FALLTHROUGH_INTENDED;
+    case AUDIO_UTILS_FIFO_SYNC_SHARED: {
+        const int err = mFifo.mWriterRear.wake(op, INT32_MAX /*waiters*/);
+        // err is number of processes woken up
+        if (err < 0) {
+            LOG_ALWAYS_FATAL("%s: unexpected err=%d errno=%d", __func__, err, errno);
+        }
+        break;
+    }
+    default:
+        LOG_ALWAYS_FATAL("mFifo.mWriterRearSync=%d", mFifo.mWriterRearSync);
+        break;
+    }
+    return availToWrite;
+}
+
+ssize_t audio_utils_fifo_multiwriter::available()
+        __attribute__((no_sanitize("integer")))
+{
+    const uint32_t localRear = mReserveRear.load(std::memory_order_relaxed);
+    const uint32_t front = mFifo.mThrottleFront != NULL ?
+            mFifo.mThrottleFront->loadAcquire() : mFifo.mWriterRear.loadAcquire();
+    // returns -EIO if mIsShutdown
+    const int32_t filled = mFifo.diff(localRear, front);
+    if (filled < 0) {
+        return filled;
+    }
+    return mFifo.mFrameCount - (uint32_t) filled;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 audio_utils_fifo_reader::audio_utils_fifo_reader(audio_utils_fifo& fifo, bool throttlesWriter,
@@ -440,7 +807,7 @@ audio_utils_fifo_reader::audio_utils_fifo_reader(audio_utils_fifo& fifo, bool th
     mFlush(flush),
     mArmLevel(-1), mTriggerLevel(mFifo.mFrameCount),
     mIsArmed(true), // because initial fill level of zero is > mArmLevel
-    mTotalLost(0), mTotalFlushed(0)
+    mTotalLost(0), mTotalFlushed(0), mIntegrityStats{}
 {
 }
 
@@ -463,11 +830,70 @@ ssize_t audio_utils_fifo_reader::read(void *buffer, size_t count, const struct t
                     (char *) mFifo.mBuffer + iovec[1].mOffset * mFifo.mFrameSize,
                     iovec[1].mLength * mFifo.mFrameSize);
         }
+        if (mFifo.mIntegrityTags != NULL) {
+            // Verify from the destination copy, so the check covers the bytes the consumer
+            // actually received; re-reading the shared buffer could pass on data that was
+            // corrupted between our copy and the re-read.
+            const char *frame = (const char *) buffer;
+            uint32_t sequence = mLocalFront;
+            for (int i = 0; i < 2; i++) {
+                if (i == 1) {
+                    // match the writer: the index space skips mFudgeFactor values at the
+                    // buffer wrap (see sum()), wherever the writer's batches wrapped
+                    sequence = mFifo.sum(mLocalFront, iovec[0].mLength);
+                }
+                const audio_utils_fifo_integrity_tag *tag =
+                        &mFifo.mIntegrityTags[iovec[i].mOffset];
+                for (uint32_t j = 0; j < iovec[i].mLength;
+                        j++, tag++, sequence++, frame += mFifo.mFrameSize) {
+                    if (tag->mSequence != sequence) {
+                        // also catches a stale frame from a previous lap around the buffer
+                        mIntegrityStats.sequenceErrors++;
+                    } else if (tag->mCrc != crc32c(sequence, frame, mFifo.mFrameSize)) {
+                        mIntegrityStats.crcErrors++;
+                    }
+                }
+            }
+            mIntegrityStats.framesChecked += availToRead;
+        }
         release(availToRead);
     }
     return availToRead;
 }
 
+ssize_t audio_utils_fifo_reader::readVia(
+        size_t (*via)(void *cookie, const void *buffer, size_t count),
+        void *cookie, size_t count, const struct timespec *timeout, size_t *lost)
+        __attribute__((no_sanitize("integer")))
+{
+    audio_utils_iovec iovec[2];
+    const ssize_t availToRead = obtain(iovec, count, timeout, lost);
+    if (availToRead <= 0) {
+        return availToRead;
+    }
+    size_t consumed = 0;
+    for (int i = 0; i < 2 && iovec[i].mLength > 0; i++) {
+        const size_t accepted = via(cookie,
+                (const char *) mFifo.mBuffer + iovec[i].mOffset * mFifo.mFrameSize,
+                iovec[i].mLength);
+        if (accepted > iovec[i].mLength) {
+            ALOGE("%s via callback accepted %zu > offered %u", __func__, accepted,
+                    iovec[i].mLength);
+            mFifo.shutdown();
+            return -EIO;
+        }
+        consumed += accepted;
+        // a short consumption ends the iteration
+        if (accepted < iovec[i].mLength) {
+            break;
+        }
+    }
+    if (consumed > 0) {
+        release(consumed);
+    }
+    return consumed;
+}
+
 ssize_t audio_utils_fifo_reader::obtain(audio_utils_iovec iovec[2], size_t count,
         const struct timespec *timeout)
         __attribute__((no_sanitize("integer")))
@@ -496,6 +922,10 @@ void audio_utils_fifo_reader::release(size_t count)
             } else {
                 mThrottleFront->storeRelease(mLocalFront);
             }
+            if (filled >= 0) {
+                // gated on the audio trace category; one relaxed load when tracing is off
+                atrace_int(ATRACE_TAG, mFifo.mTraceName, (int32_t) (filled - count));
+            }
             // TODO add comments
             int op = FUTEX_WAKE;
             switch (mFifo.mThrottleFrontSync) {
@@ -550,6 +980,9 @@ ssize_t audio_utils_fifo_reader::obtain(audio_utils_iovec iovec[2], size_t count
             break;
         }
         // TODO add comments
+        struct timespec stallStart;
+        clock_gettime(CLOCK_MONOTONIC, &stallStart);
+        atrace_begin(ATRACE_TAG, "afifo_read_wait");
         int op = FUTEX_WAIT;
         switch (mFifo.mWriterRearSync) {
         case AUDIO_UTILS_FIFO_SYNC_SINGLE_THREADED:
@@ -580,6 +1013,9 @@ ssize_t audio_utils_fifo_reader::obtain(audio_utils_iovec iovec[2], size_t count
                     // changed value between the earlier atomic_load_explicit() and sys_futex().
                     // Try to load index again, but give up if we are unable to converge.
                     if (retries-- > 0) {
+                        // balance the slice before retrying; the next
+                        // iteration opens its own if it waits again
+                        atrace_end(ATRACE_TAG);
                         // bypass the "timeout = NULL;" below
                         continue;
                     }
@@ -598,6 +1034,19 @@ ssize_t audio_utils_fifo_reader::obtain(audio_utils_iovec iovec[2], size_t count
             LOG_ALWAYS_FATAL("mFifo.mWriterRearSync=%d", mFifo.mWriterRearSync);
             break;
         }
+        // every remaining path out of the switch executed the begin above;
+        // end unconditionally so the slice cannot leak open on this thread
+        atrace_end(ATRACE_TAG);
+        if (err != -ENOTSUP) {
+            struct timespec stallEnd;
+            clock_gettime(CLOCK_MONOTONIC, &stallEnd);
+            const int64_t stallNs = audio_utils_ns_from_timespec(&stallEnd)
+                    - audio_utils_ns_from_timespec(&stallStart);
+            audio_utils_perf_counter_add(AUDIO_UTILS_PERF_COUNTER_FIFO_READ_STALLS, 1);
+            audio_utils_perf_histogram_add(AUDIO_UTILS_PERF_HISTOGRAM_FIFO_READ_STALL_NS,
+                    stallNs);
+            recordWaitNs(stallNs);
+        }
         timeout = NULL;
     }
     size_t ourLost;
@@ -653,12 +1102,46 @@ ssize_t audio_utils_fifo_reader::flush(size_t *lost)
 {
     audio_utils_iovec iovec[2];
     ssize_t ret = obtain(iovec, SIZE_MAX /*count*/, NULL /*timeout*/, lost);
+    const bool signalWriter = mThrottleFront != NULL && mFifo.mFlushEpoch != NULL
+            && !mFifo.mIsShutdown;
+    if (signalWriter) {
+        // Bump the epoch before releasing the frames, so a writer woken by the
+        // release() below already observes the new epoch when it polls
+        // flushRequested().  Only this reader stores the cell, so a plain
+        // load/store pair is sufficient for all sync types.
+        mFifo.mFlushEpoch->storeRelease(mFifo.mFlushEpoch->loadAcquire() + 1);
+    }
     if (ret > 0) {
         size_t flushed = (size_t) ret;
         release(flushed);
         mTotalFlushed += flushed;
         ret = flushed;
     }
+    if (signalWriter) {
+        // Wake a writer blocked on a full FIFO even if nothing was flushed, or
+        // if the release() wake was suppressed by hysteresis, so it re-polls
+        // and can act on the flush promptly.
+        int op = FUTEX_WAKE;
+        switch (mFifo.mThrottleFrontSync) {
+        case AUDIO_UTILS_FIFO_SYNC_SINGLE_THREADED:
+        case AUDIO_UTILS_FIFO_SYNC_SLEEP:
+            break;
+        case AUDIO_UTILS_FIFO_SYNC_PRIVATE:
+            op = FUTEX_WAKE_PRIVATE;
+            FALLTHROUGH_INTENDED;
+        case AUDIO_UTILS_FIFO_SYNC_SHARED: {
+            int err = mThrottleFront->wake(op, 1 /*waiters*/);
+            // err is number of processes woken up
+            if (err < 0 || err > 1) {
+                LOG_ALWAYS_FATAL("%s: unexpected err=%d errno=%d", __func__, err, errno);
+            }
+            break;
+        }
+        default:
+            LOG_ALWAYS_FATAL("mFifo.mThrottleFrontSync=%d", mFifo.mThrottleFrontSync);
+            break;
+        }
+    }
     return ret;
 }
 
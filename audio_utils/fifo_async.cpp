@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "audio_utils_fifo_async"
+
+#include <vector>
+
+#include <audio_utils/fifo_async.h>
+#include <audio_utils/futex.h>
+#include <log/log.h>
+
+audio_utils_fifo_async_service::audio_utils_fifo_async_service(int64_t pollNs) :
+    mPollNs(pollNs)
+{
+    LOG_ALWAYS_FATAL_IF(pollNs <= 0);
+    mThread = std::thread(&audio_utils_fifo_async_service::threadLoop, this);
+}
+
+audio_utils_fifo_async_service::~audio_utils_fifo_async_service()
+{
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        mQuit = true;
+        wakeLocked();
+    }
+    mThread.join();
+}
+
+int audio_utils_fifo_async_service::registerReader(audio_utils_fifo_reader &reader,
+        size_t minFrames, callback_t callback)
+{
+    LOG_ALWAYS_FATAL_IF(minFrames == 0 || callback == nullptr);
+    std::lock_guard<std::mutex> lock(mLock);
+    const int handle = mNextHandle++;
+    mEntries[handle] = std::make_shared<Entry>(reader, minFrames, std::move(callback));
+    // data may already be available; don't wait out the current tick
+    wakeLocked();
+    return handle;
+}
+
+void audio_utils_fifo_async_service::unregisterReader(int handle)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    auto it = mEntries.find(handle);
+    if (it == mEntries.end()) {
+        return;
+    }
+    // an in-flight callback on the service thread may still complete;
+    // mActive stops any further ones.
+    it->second->mActive = false;
+    mEntries.erase(it);
+}
+
+// Call with mLock held.
+void audio_utils_fifo_async_service::wakeLocked()
+{
+    mWake.storeRelease(mWake.loadSingleThreaded() + 1);
+    int err = mWake.wake(FUTEX_WAKE_PRIVATE, 1 /*waiters*/);
+    LOG_ALWAYS_FATAL_IF(err < 0, "%s: unexpected err=%d errno=%d", __func__, err, errno);
+}
+
+void audio_utils_fifo_async_service::threadLoop()
+{
+    std::vector<std::shared_ptr<Entry>> entries;    // reused scratch, snapshot per pass
+    for (;;) {
+        uint32_t wakeSeen;
+        entries.clear();
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            if (mQuit) {
+                return;
+            }
+            // The wake count is sampled before scanning, so a registration or
+            // unregistration during the scan cuts the following sleep short.
+            wakeSeen = mWake.loadAcquire();
+            entries.reserve(mEntries.size());
+            for (auto& pair : mEntries) {
+                entries.push_back(pair.second);
+            }
+        }
+        for (auto& entry : entries) {
+            {
+                std::lock_guard<std::mutex> lock(mLock);
+                if (mQuit) {
+                    return;
+                }
+                if (!entry->mActive) {
+                    continue;
+                }
+            }
+            const ssize_t avail = entry->mReader.available();
+            if (avail < 0) {
+                // report the error once, then drop the registration
+                entry->mCallback(entry->mReader, avail);
+                std::lock_guard<std::mutex> lock(mLock);
+                if (entry->mActive) {
+                    entry->mActive = false;
+                    for (auto it = mEntries.begin(); it != mEntries.end(); ++it) {
+                        if (it->second == entry) {
+                            mEntries.erase(it);
+                            break;
+                        }
+                    }
+                }
+            } else if ((size_t) avail >= entry->mMinFrames) {
+                entry->mCallback(entry->mReader, avail);
+            }
+        }
+        struct timespec timeout;
+        timeout.tv_sec = mPollNs / 1000000000;
+        timeout.tv_nsec = mPollNs % 1000000000;
+        // wait for the poll interval, or less if woken; benign races
+        // (EAGAIN, EINTR, ETIMEDOUT) just start the next pass early.
+        (void) mWake.wait(FUTEX_WAIT_PRIVATE, wakeSeen, &timeout);
+    }
+}
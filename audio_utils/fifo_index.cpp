@@ -46,8 +46,51 @@ void audio_utils_fifo_index::storeRelease(uint32_t value)
     atomic_store_explicit(&mIndex, value, std::memory_order_release);
 }
 
+// Adaptive spin window applied before blocking in wait().
+// The partner's index update often lands within a few microseconds, and a futex
+// sleep/wake round trip costs far more than a short spin.  The window is shared
+// process-wide (the index itself must stay a 32-bit POD, so it cannot hold
+// per-index state): it grows when a spin observes the change and shrinks when
+// the spins are wasted and we block anyway.
+static constexpr uint32_t kMaxSpins = 1024;
+// The floor keeps a small probe window so the spin can pay off again
+// after a period of long waits has shrunk it.
+static constexpr uint32_t kMinSpins = 16;
+static std::atomic<uint32_t> gSpinLimit(kMaxSpins / 2);
+
+static inline void cpu_relax()
+{
+#if defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#elif defined(__i386__) || defined(__x86_64__)
+    __asm__ __volatile__("pause");
+#endif
+}
+
 int audio_utils_fifo_index::wait(int op, uint32_t expected, const struct timespec *timeout)
 {
+    const uint32_t limit = gSpinLimit.load(std::memory_order_relaxed);
+    for (uint32_t spins = 0; spins < limit; ++spins) {
+        if (atomic_load_explicit(&mIndex, std::memory_order_relaxed) != expected) {
+            // Success: grow the window by 1/8.  Report the observed change the
+            // same way sys_futex does when *addr != expected, so callers
+            // re-load the index through their existing EWOULDBLOCK path.
+            uint32_t grown = limit + (limit >> 3) + 1;
+            if (grown > kMaxSpins) {
+                grown = kMaxSpins;
+            }
+            gSpinLimit.store(grown, std::memory_order_relaxed);
+            errno = EWOULDBLOCK;
+            return -1;
+        }
+        cpu_relax();
+    }
+    // The spins were wasted: shrink the window by 1/8 before blocking.
+    uint32_t shrunk = limit - (limit >> 3);
+    if (shrunk < kMinSpins) {
+        shrunk = kMinSpins;
+    }
+    gSpinLimit.store(shrunk, std::memory_order_relaxed);
     return sys_futex(&mIndex, op, expected, timeout, NULL, 0);
 }
 
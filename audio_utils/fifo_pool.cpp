@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "audio_utils_fifo_pool"
+
+#include <errno.h>
+#include <new>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <audio_utils/fifo_pool.h>
+#include <log/log.h>
+
+namespace {
+
+size_t roundUpToPageSize(size_t bytes)
+{
+    const size_t pageSize = (size_t) sysconf(_SC_PAGESIZE);
+    return (bytes + pageSize - 1) & ~(pageSize - 1);
+}
+
+// Keep the two indices on separate cache lines to avoid false sharing
+// between the writer and the throttling reader.
+constexpr size_t kIndexSpacing = 64;
+
+}   // namespace
+
+audio_utils_fifo_pool::audio_utils_fifo_pool(size_t bufferCount, size_t capacityBytes) :
+    mCapacityBytes(roundUpToPageSize(capacityBytes)),
+    mSlotBytes(mCapacityBytes + roundUpToPageSize(2 * kIndexSpacing)),
+    mOutstanding(0)
+{
+    LOG_ALWAYS_FATAL_IF(capacityBytes == 0);
+    std::lock_guard<std::mutex> lock(mLock);
+    mFree.reserve(bufferCount);
+    for (size_t i = 0; i < bufferCount; i++) {
+        audio_utils_fifo_pool_buffer *buffer = allocateSlot();
+        if (buffer == NULL) {
+            ALOGW("%s: preallocated only %zu of %zu buffers of %zu bytes",
+                    __func__, i, bufferCount, mSlotBytes);
+            break;
+        }
+        mFree.push_back(buffer);
+    }
+}
+
+audio_utils_fifo_pool::~audio_utils_fifo_pool()
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    LOG_ALWAYS_FATAL_IF(mOutstanding != 0,
+            "%s: destroyed with %zu buffer(s) still acquired", __func__, mOutstanding);
+    for (audio_utils_fifo_pool_buffer *buffer : mFree) {
+        (void) munmap(buffer->mBuffer, mSlotBytes);
+        delete buffer;
+    }
+}
+
+audio_utils_fifo_pool_buffer *audio_utils_fifo_pool::allocateSlot()
+{
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_POPULATE
+    flags |= MAP_POPULATE;  // prefault now, not at stream open
+#endif
+    void *slot = mmap(NULL, mSlotBytes, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (slot == MAP_FAILED) {
+        ALOGE("%s: mmap of %zu bytes failed: %s", __func__, mSlotBytes, strerror(errno));
+        return NULL;
+    }
+#ifdef MADV_HUGEPAGE
+    // Best effort only; ignore failure on kernels without THP.
+    (void) madvise(slot, mCapacityBytes, MADV_HUGEPAGE);
+#endif
+    // Touch every page in case MAP_POPULATE is unavailable or was ignored.
+    memset(slot, 0, mSlotBytes);
+    audio_utils_fifo_pool_buffer *buffer = new audio_utils_fifo_pool_buffer;
+    buffer->mBuffer = slot;
+    char *indexPage = (char *) slot + mCapacityBytes;
+    buffer->mWriterRear = (audio_utils_fifo_index *) indexPage;
+    buffer->mThrottleFront = (audio_utils_fifo_index *) (indexPage + kIndexSpacing);
+    return buffer;
+}
+
+audio_utils_fifo_pool_buffer *audio_utils_fifo_pool::acquire()
+{
+    audio_utils_fifo_pool_buffer *buffer;
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        if (!mFree.empty()) {
+            buffer = mFree.back();
+            mFree.pop_back();
+        } else {
+            // exhausted; grow by one slot, equivalent to an allocate-per-open.
+            buffer = allocateSlot();
+            if (buffer == NULL) {
+                return NULL;
+            }
+        }
+        mOutstanding++;
+    }
+    // Construct fresh indices for the new stream; audio_utils_fifo_index is
+    // POD so this is merely a reset to zero without a destructor call.
+    (void) new ((void *) buffer->mWriterRear) audio_utils_fifo_index();
+    (void) new ((void *) buffer->mThrottleFront) audio_utils_fifo_index();
+    return buffer;
+}
+
+void audio_utils_fifo_pool::release(audio_utils_fifo_pool_buffer *buffer)
+{
+    LOG_ALWAYS_FATAL_IF(buffer == NULL);
+    std::lock_guard<std::mutex> lock(mLock);
+    LOG_ALWAYS_FATAL_IF(mOutstanding == 0, "%s: more releases than acquires", __func__);
+    mOutstanding--;
+    // LIFO: the most recently used mapping is the most likely to still be
+    // cache and TLB warm when the next stream opens.
+    mFree.push_back(buffer);
+}
+
+size_t audio_utils_fifo_pool::available() const
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    return mFree.size();
+}
@@ -0,0 +1,253 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <new>
+#include <audio_utils/fifo_shm.h>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#endif
+
+// huge page flags appeared after memfd_create itself; define for older libc
+#ifndef MFD_HUGETLB
+#define MFD_HUGETLB     0x0004U
+#endif
+#ifndef MFD_HUGE_2MB
+#define MFD_HUGE_2MB    (21U << 26)     // 21 == log2(2 MB), at MFD_HUGE_SHIFT
+#endif
+
+static const uint32_t kMagic = 0x6d687366;  // 'fshm' (little-endian)
+static const uint32_t kVersion = 1;
+static const size_t kCacheLineSize = 64;
+static const size_t kHugePageSize = 2 * 1024 * 1024;
+
+// Self-describing header at the start of the mapping, so attach() needs only
+// the file descriptor.  Fits in the cache line before the rear index.
+struct shm_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t frameCount;
+    uint32_t frameSize;
+    uint32_t rearOffset;
+    uint32_t frontOffset;
+    uint32_t bufferOffset;
+};
+static_assert(sizeof(shm_header) <= kCacheLineSize, "header must fit in one cache line");
+
+static shm_header *header_of(void *base)
+{
+    return static_cast<shm_header *>(base);
+}
+
+audio_utils_fifo_shm::audio_utils_fifo_shm(int fd, void *base, size_t mappedSize)
+    : mFd(fd), mBase(base), mMappedSize(mappedSize)
+{
+}
+
+audio_utils_fifo_shm::~audio_utils_fifo_shm()
+{
+    (void) munmap(mBase, mMappedSize);
+    (void) close(mFd);
+}
+
+audio_utils_fifo_index *audio_utils_fifo_shm::writerRear() const
+{
+    return reinterpret_cast<audio_utils_fifo_index *>(
+            static_cast<char *>(mBase) + header_of(mBase)->rearOffset);
+}
+
+audio_utils_fifo_index *audio_utils_fifo_shm::throttleFront() const
+{
+    return reinterpret_cast<audio_utils_fifo_index *>(
+            static_cast<char *>(mBase) + header_of(mBase)->frontOffset);
+}
+
+void *audio_utils_fifo_shm::buffer() const
+{
+    return static_cast<char *>(mBase) + header_of(mBase)->bufferOffset;
+}
+
+uint32_t audio_utils_fifo_shm::frameCount() const
+{
+    return header_of(mBase)->frameCount;
+}
+
+uint32_t audio_utils_fifo_shm::frameSize() const
+{
+    return header_of(mBase)->frameSize;
+}
+
+// binds the mapping's backing pages to one NUMA node, or returns a negative errno
+static int bind_to_node(void *base, size_t size, int numaNode)
+{
+#ifdef __linux__
+    // libnuma is not a dependency of this library, so issue the raw syscall.
+    unsigned long nodemask = 1UL << numaNode;
+    if (syscall(SYS_mbind, base, size, MPOL_BIND, &nodemask,
+            sizeof(nodemask) * CHAR_BIT, 0) != 0) {
+        return -errno;
+    }
+    return 0;
+#else
+    (void) base;
+    (void) size;
+    (void) numaNode;
+    return -ENOSYS;
+#endif
+}
+
+int audio_utils_fifo_shm::create(uint32_t frameCount, uint32_t frameSize, uint32_t flags,
+        int numaNode, audio_utils_fifo_shm **shm)
+{
+    if (shm == NULL) {
+        return -EINVAL;
+    }
+    *shm = NULL;
+    // same limits as the audio_utils_fifo constructor
+    if (frameCount == 0 || frameSize == 0 ||
+            frameCount > ((uint32_t) INT32_MAX) / frameSize) {
+        return -EINVAL;
+    }
+    if (numaNode < -1 || numaNode >= (int) (sizeof(unsigned long) * CHAR_BIT)) {
+        return -EINVAL;
+    }
+
+    const size_t bufferOffset = 3 * kCacheLineSize;
+    const size_t totalSize = bufferOffset + (size_t) frameCount * frameSize;
+
+    int fd = -1;
+    void *base = MAP_FAILED;
+    size_t mappedSize = 0;
+    if (flags & AUDIO_UTILS_FIFO_SHM_HUGE_PAGES) {
+        // round to a whole number of huge pages; fall through on any failure,
+        // including an exhausted huge page pool first seen at mmap() time
+        fd = memfd_create("audio_utils_fifo", MFD_CLOEXEC | MFD_HUGETLB | MFD_HUGE_2MB);
+        if (fd >= 0) {
+            mappedSize = (totalSize + kHugePageSize - 1) & ~(kHugePageSize - 1);
+            if (ftruncate(fd, (off_t) mappedSize) == 0) {
+                base = mmap(NULL, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                        (off_t) 0);
+            }
+            if (base == MAP_FAILED) {
+                (void) close(fd);
+                fd = -1;
+            }
+        }
+    }
+    if (fd < 0) {
+        fd = memfd_create("audio_utils_fifo", MFD_CLOEXEC);
+        if (fd < 0) {
+            return -errno;
+        }
+        const size_t pageSize = (size_t) sysconf(_SC_PAGESIZE);
+        mappedSize = (totalSize + pageSize - 1) & ~(pageSize - 1);
+        if (ftruncate(fd, (off_t) mappedSize) != 0) {
+            const int err = -errno;
+            (void) close(fd);
+            return err;
+        }
+        base = mmap(NULL, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, (off_t) 0);
+        if (base == MAP_FAILED) {
+            const int err = -errno;
+            (void) close(fd);
+            return err;
+        }
+    }
+
+    if (numaNode >= 0) {
+        const int err = bind_to_node(base, mappedSize, numaNode);
+        if (err != 0) {
+            (void) munmap(base, mappedSize);
+            (void) close(fd);
+            return err;
+        }
+    }
+
+    // the index constructors must execute exactly once, so here and not in attach()
+    (void) new((char *) base + 1 * kCacheLineSize) audio_utils_fifo_index();
+    (void) new((char *) base + 2 * kCacheLineSize) audio_utils_fifo_index();
+
+    shm_header *header = header_of(base);
+    header->version = kVersion;
+    header->frameCount = frameCount;
+    header->frameSize = frameSize;
+    header->rearOffset = (uint32_t) (1 * kCacheLineSize);
+    header->frontOffset = (uint32_t) (2 * kCacheLineSize);
+    header->bufferOffset = (uint32_t) bufferOffset;
+    // the magic is stored last so a concurrent attach() cannot see a partial header
+    header->magic = kMagic;
+
+    audio_utils_fifo_shm *object = new(std::nothrow) audio_utils_fifo_shm(fd, base, mappedSize);
+    if (object == NULL) {
+        (void) munmap(base, mappedSize);
+        (void) close(fd);
+        return -ENOMEM;
+    }
+    *shm = object;
+    return 0;
+}
+
+int audio_utils_fifo_shm::attach(int fd, audio_utils_fifo_shm **shm)
+{
+    if (shm == NULL) {
+        return -EINVAL;
+    }
+    *shm = NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        return -errno;
+    }
+    const size_t mappedSize = (size_t) st.st_size;
+    if (mappedSize < 3 * kCacheLineSize) {
+        return -EINVAL;
+    }
+    const int ourFd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (ourFd < 0) {
+        return -errno;
+    }
+    void *base = mmap(NULL, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, ourFd, (off_t) 0);
+    if (base == MAP_FAILED) {
+        const int err = -errno;
+        (void) close(ourFd);
+        return err;
+    }
+    const shm_header *header = header_of(base);
+    if (header->magic != kMagic || header->version != kVersion ||
+            header->frameCount == 0 || header->frameSize == 0 ||
+            header->bufferOffset < 3 * kCacheLineSize ||
+            (uint64_t) header->bufferOffset +
+                    (uint64_t) header->frameCount * header->frameSize > mappedSize) {
+        (void) munmap(base, mappedSize);
+        (void) close(ourFd);
+        return -EINVAL;
+    }
+    audio_utils_fifo_shm *object = new(std::nothrow) audio_utils_fifo_shm(ourFd, base, mappedSize);
+    if (object == NULL) {
+        (void) munmap(base, mappedSize);
+        (void) close(ourFd);
+        return -ENOMEM;
+    }
+    *shm = object;
+    return 0;
+}
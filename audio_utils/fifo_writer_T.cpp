@@ -41,7 +41,8 @@ static inline void memcpyWords(T *dst, const T *src, uint32_t count)
 
 template <typename T>
 audio_utils_fifo_writer_T<T>::audio_utils_fifo_writer_T(audio_utils_fifo& fifo) :
-    mLocalRear(0), mFrameCountP2(fifo.mFrameCountP2), mBuffer((T *) fifo.mBuffer),
+    mLocalRear(0), mBatchFrames(0), mPending(0),
+    mFrameCountP2(fifo.mFrameCountP2), mBuffer((T *) fifo.mBuffer),
     mWriterRear(fifo.mWriterRear)
 {
     if (fifo.mFrameSize != sizeof(T) || fifo.mFudgeFactor != 0) {
@@ -72,6 +73,12 @@ void audio_utils_fifo_writer_T<T>::write(const T *buffer, uint32_t count)
     uint32_t part2 = availToWrite - part1;
     memcpyWords(&mBuffer[0], &buffer[part1], part2);
     mLocalRear += availToWrite;
+    if (mBatchFrames != 0) {
+        mPending += availToWrite;
+        if (mPending >= mBatchFrames) {
+            storeRelease();
+        }
+    }
 }
 
 // Instantiate for the specific types we need, which is currently just int32_t and int64_t.
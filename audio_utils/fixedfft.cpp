@@ -22,62 +22,113 @@
  * keep it small, only radix-2 Cooley-Tukey algorithm is implemented, and only
  * half of the twiddle factors are stored. Although there are still ways to make
  * it even faster or smaller, it costs too much on one of the aspects.
+ *
+ * The twiddle factors are generated at compile time, so the maximum transform
+ * size is set by LOG_FFT_SIZE alone: fixed_fft() accepts any power of two up
+ * to MAX_FFT_SIZE points and fixed_fft_real() up to MAX_FFT_SIZE / 2 points.
+ * On AArch64 the butterflies of each stage are processed four columns at a
+ * time with NEON, bit-exact with the scalar code.
+ *
+ * float_fft() and float_fft_real() are the single precision counterparts for
+ * pipelines that are float end-to-end.  They keep the in-place convention and
+ * size limits of the fixed point functions, with complex values stored as
+ * adjacent (real, imaginary) float pairs instead of packed 16-bit halves.
+ * Unlike the fixed point transform, which halves the data every stage to
+ * avoid overflow, the float transform computes unscaled DFT sums.
  */
 
 #include <stdint.h>
 
+#include <array>
+
 #include <audio_utils/fixedfft.h>
 
-#define LOG_FFT_SIZE 10
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#define LOG_FFT_SIZE 14
 #define MAX_FFT_SIZE (1 << LOG_FFT_SIZE)
 
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+/* Taylor series, requires |x| <= pi / 2.  The truncation error is far below
+ * one Q15 ulp, so the generated table rounds identically to one computed
+ * with library sin().
+ */
+constexpr double constexpr_sin(double x)
+{
+    double term = x;
+    double sum = x;
+    const double x2 = x * x;
+    for (int n = 1; n <= 12; ++n) {
+        term *= -x2 / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double constexpr_cos(double x)
+{
+    return constexpr_sin(kPi / 2 - x);
+}
+
+/* Round to nearest, halfway away from zero. */
+constexpr int32_t round_q15(double x)
+{
+    return x >= 0 ? (int32_t)(x * 32768 + 0.5) : -(int32_t)(-x * 32768 + 0.5);
+}
+
+/* Entry k packs -sin(2 * pi * k / MAX_FFT_SIZE) in the higher 16 bits and
+ * -cos of the same angle in the lower ones, both Q15.  This reproduces the
+ * literal table previously stored here for LOG_FFT_SIZE 10.
+ */
+constexpr std::array<uint32_t, MAX_FFT_SIZE / 4> makeTwiddle()
+{
+    std::array<uint32_t, MAX_FFT_SIZE / 4> table{};
+    for (int k = 0; k < MAX_FFT_SIZE / 4; ++k) {
+        const double theta = 2 * kPi * k / MAX_FFT_SIZE;
+        const int32_t re = round_q15(-constexpr_sin(theta));
+        const int32_t im = round_q15(-constexpr_cos(theta));
+        table[k] = ((uint32_t)(uint16_t)re << 16) | (uint16_t)im;
+    }
+    return table;
+}
+
+struct float_complex {
+    float re;
+    float im;
+};
+
+/* Entry k is e^(-2 * pi * i * k / MAX_FFT_SIZE) for k < MAX_FFT_SIZE / 2,
+ * which covers every twiddle a forward transform needs without reflection.
+ * The quadrant fold keeps the Taylor series within its |x| <= pi / 2 domain.
+ */
+constexpr std::array<float_complex, MAX_FFT_SIZE / 2> makeFloatTwiddle()
+{
+    std::array<float_complex, MAX_FFT_SIZE / 2> table{};
+    for (int k = 0; k < MAX_FFT_SIZE / 2; ++k) {
+        const double theta = 2 * kPi * k / MAX_FFT_SIZE;
+        if (theta <= kPi / 2) {
+            table[k] = {(float)constexpr_cos(theta), (float)-constexpr_sin(theta)};
+        } else {
+            table[k] = {(float)-constexpr_sin(theta - kPi / 2),
+                    (float)-constexpr_cos(theta - kPi / 2)};
+        }
+    }
+    return table;
+}
+
+} // namespace
+
 // Actually int32_t, but declare as uint32_t to avoid warnings due to overflow.
 // Be sure to cast all accesses before use, for example "(int32_t) twiddle[...]".
-static const uint32_t twiddle[MAX_FFT_SIZE / 4] = {
-    0x00008000, 0xff378001, 0xfe6e8002, 0xfda58006, 0xfcdc800a, 0xfc13800f,
-    0xfb4a8016, 0xfa81801e, 0xf9b88027, 0xf8ef8032, 0xf827803e, 0xf75e804b,
-    0xf6958059, 0xf5cd8068, 0xf5058079, 0xf43c808b, 0xf374809e, 0xf2ac80b2,
-    0xf1e480c8, 0xf11c80de, 0xf05580f6, 0xef8d8110, 0xeec6812a, 0xedff8146,
-    0xed388163, 0xec718181, 0xebab81a0, 0xeae481c1, 0xea1e81e2, 0xe9588205,
-    0xe892822a, 0xe7cd824f, 0xe7078276, 0xe642829d, 0xe57d82c6, 0xe4b982f1,
-    0xe3f4831c, 0xe3308349, 0xe26d8377, 0xe1a983a6, 0xe0e683d6, 0xe0238407,
-    0xdf61843a, 0xde9e846e, 0xdddc84a3, 0xdd1b84d9, 0xdc598511, 0xdb998549,
-    0xdad88583, 0xda1885be, 0xd95885fa, 0xd8988637, 0xd7d98676, 0xd71b86b6,
-    0xd65c86f6, 0xd59e8738, 0xd4e1877b, 0xd42487c0, 0xd3678805, 0xd2ab884c,
-    0xd1ef8894, 0xd13488dd, 0xd0798927, 0xcfbe8972, 0xcf0489be, 0xce4b8a0c,
-    0xcd928a5a, 0xccd98aaa, 0xcc218afb, 0xcb698b4d, 0xcab28ba0, 0xc9fc8bf5,
-    0xc9468c4a, 0xc8908ca1, 0xc7db8cf8, 0xc7278d51, 0xc6738dab, 0xc5c08e06,
-    0xc50d8e62, 0xc45b8ebf, 0xc3a98f1d, 0xc2f88f7d, 0xc2488fdd, 0xc198903e,
-    0xc0e990a1, 0xc03a9105, 0xbf8c9169, 0xbedf91cf, 0xbe329236, 0xbd86929e,
-    0xbcda9307, 0xbc2f9371, 0xbb8593dc, 0xbadc9448, 0xba3394b5, 0xb98b9523,
-    0xb8e39592, 0xb83c9603, 0xb7969674, 0xb6f196e6, 0xb64c9759, 0xb5a897ce,
-    0xb5059843, 0xb46298b9, 0xb3c09930, 0xb31f99a9, 0xb27f9a22, 0xb1df9a9c,
-    0xb1409b17, 0xb0a29b94, 0xb0059c11, 0xaf689c8f, 0xaecc9d0e, 0xae319d8e,
-    0xad979e0f, 0xacfd9e91, 0xac659f14, 0xabcd9f98, 0xab36a01c, 0xaaa0a0a2,
-    0xaa0aa129, 0xa976a1b0, 0xa8e2a238, 0xa84fa2c2, 0xa7bda34c, 0xa72ca3d7,
-    0xa69ca463, 0xa60ca4f0, 0xa57ea57e, 0xa4f0a60c, 0xa463a69c, 0xa3d7a72c,
-    0xa34ca7bd, 0xa2c2a84f, 0xa238a8e2, 0xa1b0a976, 0xa129aa0a, 0xa0a2aaa0,
-    0xa01cab36, 0x9f98abcd, 0x9f14ac65, 0x9e91acfd, 0x9e0fad97, 0x9d8eae31,
-    0x9d0eaecc, 0x9c8faf68, 0x9c11b005, 0x9b94b0a2, 0x9b17b140, 0x9a9cb1df,
-    0x9a22b27f, 0x99a9b31f, 0x9930b3c0, 0x98b9b462, 0x9843b505, 0x97ceb5a8,
-    0x9759b64c, 0x96e6b6f1, 0x9674b796, 0x9603b83c, 0x9592b8e3, 0x9523b98b,
-    0x94b5ba33, 0x9448badc, 0x93dcbb85, 0x9371bc2f, 0x9307bcda, 0x929ebd86,
-    0x9236be32, 0x91cfbedf, 0x9169bf8c, 0x9105c03a, 0x90a1c0e9, 0x903ec198,
-    0x8fddc248, 0x8f7dc2f8, 0x8f1dc3a9, 0x8ebfc45b, 0x8e62c50d, 0x8e06c5c0,
-    0x8dabc673, 0x8d51c727, 0x8cf8c7db, 0x8ca1c890, 0x8c4ac946, 0x8bf5c9fc,
-    0x8ba0cab2, 0x8b4dcb69, 0x8afbcc21, 0x8aaaccd9, 0x8a5acd92, 0x8a0cce4b,
-    0x89becf04, 0x8972cfbe, 0x8927d079, 0x88ddd134, 0x8894d1ef, 0x884cd2ab,
-    0x8805d367, 0x87c0d424, 0x877bd4e1, 0x8738d59e, 0x86f6d65c, 0x86b6d71b,
-    0x8676d7d9, 0x8637d898, 0x85fad958, 0x85beda18, 0x8583dad8, 0x8549db99,
-    0x8511dc59, 0x84d9dd1b, 0x84a3dddc, 0x846ede9e, 0x843adf61, 0x8407e023,
-    0x83d6e0e6, 0x83a6e1a9, 0x8377e26d, 0x8349e330, 0x831ce3f4, 0x82f1e4b9,
-    0x82c6e57d, 0x829de642, 0x8276e707, 0x824fe7cd, 0x822ae892, 0x8205e958,
-    0x81e2ea1e, 0x81c1eae4, 0x81a0ebab, 0x8181ec71, 0x8163ed38, 0x8146edff,
-    0x812aeec6, 0x8110ef8d, 0x80f6f055, 0x80def11c, 0x80c8f1e4, 0x80b2f2ac,
-    0x809ef374, 0x808bf43c, 0x8079f505, 0x8068f5cd, 0x8059f695, 0x804bf75e,
-    0x803ef827, 0x8032f8ef, 0x8027f9b8, 0x801efa81, 0x8016fb4a, 0x800ffc13,
-    0x800afcdc, 0x8006fda5, 0x8002fe6e, 0x8001ff37,
-};
+static constexpr std::array<uint32_t, MAX_FFT_SIZE / 4> twiddle = makeTwiddle();
+
+static constexpr std::array<float_complex, MAX_FFT_SIZE / 2> float_twiddle =
+        makeFloatTwiddle();
 
 /* Returns the multiplication of \conj{a} and {b}. */
 static inline int32_t mult(int32_t a, int32_t b)
@@ -104,6 +155,34 @@ static inline int32_t half(int32_t a)
 #endif
 }
 
+#if defined(__aarch64__)
+/* Runs one butterfly over four adjacent columns r .. r+3 of a stage, with the
+ * four packed twiddle factors in w.  Bit-exact with the scalar path: half()
+ * is a per 16-bit lane arithmetic shift, mult() is computed on the split
+ * halves with the same truncations, and the final add/sub are done on the
+ * packed 32-bit words so that a carry out of the imaginary half propagates
+ * into the real half exactly as in the scalar code.
+ */
+static inline void butterfly4_neon(int32_t *va, int32_t *vb, int32x4_t w)
+{
+    const int16x4_t wi = vmovn_s32(w);
+    const int16x4_t wr = vshrn_n_s32(w, 16);
+    const int32x4_t b = vld1q_s32(vb);
+    const int16x4_t bi = vmovn_s32(b);
+    const int16x4_t br = vshrn_n_s32(b, 16);
+    /* y = mult(w, b) */
+    const int16x4_t yr = vshrn_n_s32(vmlal_s16(vmull_s16(wr, br), wi, bi), 16);
+    const int16x4_t yi = vshrn_n_s32(vmlsl_s16(vmull_s16(wr, bi), wi, br), 16);
+    const int32x4_t y = vorrq_s32(vshlq_n_s32(vmovl_s16(yr), 16),
+            vandq_s32(vmovl_s16(yi), vdupq_n_s32(0xFFFF)));
+    /* x = half(v[a]) */
+    const int32x4_t x = vreinterpretq_s32_s16(
+            vshrq_n_s16(vreinterpretq_s16_s32(vld1q_s32(va)), 1));
+    vst1q_s32(va, vsubq_s32(x, y));
+    vst1q_s32(vb, vaddq_s32(x, y));
+}
+#endif
+
 void fixed_fft(int n, int32_t *v)
 {
     int scale = LOG_FFT_SIZE, i, p, r;
@@ -127,7 +206,26 @@ void fixed_fft(int n, int32_t *v)
             v[i + p] = x - y;
         }
 
-        for (r = 1; r < p; ++r) {
+        r = 1;
+#if defined(__aarch64__)
+        /* The columns of a stage are adjacent in memory within each block, so
+         * four of them advance per NEON butterfly; the twiddle factors are
+         * fetched once per column group and reused for all n / (2p) blocks.
+         */
+        for (; r + 4 <= p; r += 4) {
+            int32_t w4[4];
+            for (int lane = 0; lane < 4; ++lane) {
+                int32_t w = MAX_FFT_SIZE / 4 - ((r + lane) << scale);
+                i = w >> 31;
+                w4[lane] = ((int32_t) twiddle[(w ^ i) - i]) ^ (i << 16);
+            }
+            const int32x4_t w = vld1q_s32(w4);
+            for (i = r; i < n; i += p << 1) {
+                butterfly4_neon(v + i, v + i + p, w);
+            }
+        }
+#endif
+        for (; r < p; ++r) {
             int32_t w = MAX_FFT_SIZE / 4 - (r << scale);
             i = w >> 31;
             w = ((int32_t) twiddle[(w ^ i) - i]) ^ (i << 16);
@@ -161,3 +259,108 @@ void fixed_fft_real(int n, int32_t *v)
         v[n - i] = (x + y) ^ 0xFFFF;
     }
 }
+
+#if defined(__aarch64__)
+/* Runs one float butterfly over two adjacent columns r and r + 1 of a stage.
+ * Each 128-bit register holds two (real, imaginary) pairs; the complex
+ * multiplication is formed from a lane reversal and a sign vector so that
+ * both columns complete in three multiplies.
+ */
+static inline void butterfly2f_neon(float *va, float *vb,
+        float32x4_t wr, float32x4_t wi)
+{
+    const float32x4_t sign = {-1.f, 1.f, -1.f, 1.f};
+    const float32x4_t b = vld1q_f32(vb);
+    /* y = w * b:  re = wr * br - wi * bi,  im = wr * bi + wi * br */
+    const float32x4_t y = vfmaq_f32(vmulq_f32(wr, b),
+            vmulq_f32(wi, vrev64q_f32(b)), sign);
+    const float32x4_t a = vld1q_f32(va);
+    vst1q_f32(va, vaddq_f32(a, y));
+    vst1q_f32(vb, vsubq_f32(a, y));
+}
+#endif
+
+void float_fft(int n, float *v)
+{
+    int scale = LOG_FFT_SIZE, i, p, r;
+
+    for (r = 0, i = 1; i < n; ++i) {
+        for (p = n; !(p & r); p >>= 1, r ^= p);
+        if (i < r) {
+            float t = v[2 * i];
+            v[2 * i] = v[2 * r];
+            v[2 * r] = t;
+            t = v[2 * i + 1];
+            v[2 * i + 1] = v[2 * r + 1];
+            v[2 * r + 1] = t;
+        }
+    }
+
+    for (p = 1; p < n; p <<= 1) {
+        --scale;
+
+        r = 0;
+#if defined(__aarch64__)
+        for (; r + 2 <= p; r += 2) {
+            const float_complex w0 = float_twiddle[r << scale];
+            const float_complex w1 = float_twiddle[(r + 1) << scale];
+            const float32x4_t wr = vcombine_f32(vdup_n_f32(w0.re), vdup_n_f32(w1.re));
+            const float32x4_t wi = vcombine_f32(vdup_n_f32(w0.im), vdup_n_f32(w1.im));
+            for (i = r; i < n; i += p << 1) {
+                butterfly2f_neon(v + 2 * i, v + 2 * (i + p), wr, wi);
+            }
+        }
+#endif
+        for (; r < p; ++r) {
+            const float wr = float_twiddle[r << scale].re;
+            const float wi = float_twiddle[r << scale].im;
+            for (i = r; i < n; i += p << 1) {
+                float *a = v + 2 * i;
+                float *b = v + 2 * (i + p);
+                const float yr = wr * b[0] - wi * b[1];
+                const float yi = wr * b[1] + wi * b[0];
+                b[0] = a[0] - yr;
+                b[1] = a[1] - yi;
+                a[0] += yr;
+                a[1] += yi;
+            }
+        }
+    }
+}
+
+void float_fft_real(int n, float *v)
+{
+    int scale = LOG_FFT_SIZE, m = n >> 1, i;
+
+    float_fft(n, v);
+    for (i = 1; i <= n; i <<= 1, --scale)
+        ;
+    /* Bin 0 packs the DC term in the real slot and Nyquist in the imaginary
+     * one, as both are purely real; the center bin is its own mirror.
+     */
+    const float re0 = v[0];
+    const float im0 = v[1];
+    v[0] = re0 + im0;
+    v[1] = re0 - im0;
+    v[2 * m + 1] = -v[2 * m + 1];
+
+    for (i = 1; i < n >> 1; ++i) {
+        const float zr = v[2 * i];
+        const float zi = v[2 * i + 1];
+        const float znr = v[2 * (n - i)];
+        const float zni = v[2 * (n - i) + 1];
+        /* even and odd sample spectra from the packed transform */
+        const float er = 0.5f * (zr + znr);
+        const float ei = 0.5f * (zi - zni);
+        const float or_ = 0.5f * (zi + zni);
+        const float oi = 0.5f * (znr - zr);
+        const float wr = float_twiddle[i << scale].re;
+        const float wi = float_twiddle[i << scale].im;
+        const float yr = wr * or_ - wi * oi;
+        const float yi = wr * oi + wi * or_;
+        v[2 * i] = er + yr;
+        v[2 * i + 1] = ei + yi;
+        v[2 * (n - i)] = er - yr;
+        v[2 * (n - i) + 1] = -(ei - yi);
+    }
+}
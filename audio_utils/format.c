@@ -15,149 +15,222 @@
  */
 
 #include <assert.h>
+#include <string.h>
+
+#include <audio_utils/PerfCounters.h>
 #include <audio_utils/format.h>
 #include <audio_utils/primitives.h>
 
-void memcpy_by_audio_format(void *dst, audio_format_t dst_format,
-        const void *src, audio_format_t src_format, size_t count)
+/* Generic-signature wrappers over the typed conversion primitives, so that a
+ * (dst_format, src_format) pair can be resolved once to a function pointer and
+ * then applied to any number of buffers.
+ */
+#define DEFINE_CONVERSION_WRAPPER(name, dtype, stype)                     \
+    static void name##_wrapper(void *dst, const void *src, size_t count) { \
+        name((dtype *)dst, (const stype *)src, count);                    \
+    }
+
+DEFINE_CONVERSION_WRAPPER(memcpy_to_i16_from_float, int16_t, float)
+DEFINE_CONVERSION_WRAPPER(memcpy_to_i16_from_u8, int16_t, uint8_t)
+DEFINE_CONVERSION_WRAPPER(memcpy_to_i16_from_p24, int16_t, uint8_t)
+DEFINE_CONVERSION_WRAPPER(memcpy_to_i16_from_i32, int16_t, int32_t)
+DEFINE_CONVERSION_WRAPPER(memcpy_to_i16_from_q8_23, int16_t, int32_t)
+DEFINE_CONVERSION_WRAPPER(memcpy_to_float_from_i16, float, int16_t)
+DEFINE_CONVERSION_WRAPPER(memcpy_to_float_from_u8, float, uint8_t)
+DEFINE_CONVERSION_WRAPPER(memcpy_to_float_from_p24, float, uint8_t)
+DEFINE_CONVERSION_WRAPPER(memcpy_to_float_from_i32, float, int32_t)
+DEFINE_CONVERSION_WRAPPER(memcpy_to_float_from_q8_23, float, int32_t)
+DEFINE_CONVERSION_WRAPPER(memcpy_to_u8_from_i16, uint8_t, int16_t)
+DEFINE_CONVERSION_WRAPPER(memcpy_to_u8_from_float, uint8_t, float)
+DEFINE_CONVERSION_WRAPPER(memcpy_to_u8_from_p24, uint8_t, uint8_t)
+DEFINE_CONVERSION_WRAPPER(memcpy_to_u8_from_i32, uint8_t, int32_t)
+DEFINE_CONVERSION_WRAPPER(memcpy_to_u8_from_q8_23, uint8_t, int32_t)
+DEFINE_CONVERSION_WRAPPER(memcpy_to_p24_from_i16, uint8_t, int16_t)
+DEFINE_CONVERSION_WRAPPER(memcpy_to_p24_from_float, uint8_t, float)
+DEFINE_CONVERSION_WRAPPER(memcpy_to_p24_from_i32, uint8_t, int32_t)
+DEFINE_CONVERSION_WRAPPER(memcpy_to_p24_from_q8_23, uint8_t, int32_t)
+DEFINE_CONVERSION_WRAPPER(memcpy_to_i32_from_i16, int32_t, int16_t)
+DEFINE_CONVERSION_WRAPPER(memcpy_to_i32_from_float, int32_t, float)
+DEFINE_CONVERSION_WRAPPER(memcpy_to_i32_from_p24, int32_t, uint8_t)
+DEFINE_CONVERSION_WRAPPER(memcpy_to_q8_23_from_i16, int32_t, int16_t)
+DEFINE_CONVERSION_WRAPPER(memcpy_to_q8_23_from_float_with_clamp, int32_t, float)
+DEFINE_CONVERSION_WRAPPER(memcpy_to_q8_23_from_p24, int32_t, uint8_t)
+
+#undef DEFINE_CONVERSION_WRAPPER
+
+/* Straight copies for identical formats; the size is baked into the function
+ * so the resolved pointer keeps the uniform signature.
+ */
+#define DEFINE_SAMESIZE_WRAPPER(bytes)                                         \
+    static void memcpy_samesize_##bytes(void *dst, const void *src, size_t count) { \
+        if (dst != src) {                                                      \
+            /* TODO: should assert if memory regions overlap. */               \
+            memcpy(dst, src, count * bytes);                                   \
+        }                                                              \
+    }
+
+DEFINE_SAMESIZE_WRAPPER(1)
+DEFINE_SAMESIZE_WRAPPER(2)
+DEFINE_SAMESIZE_WRAPPER(3)
+DEFINE_SAMESIZE_WRAPPER(4)
+
+#undef DEFINE_SAMESIZE_WRAPPER
+
+/* Resolves a (dst_format, src_format) pair to its conversion function,
+ * or NULL if the pair is not supported. */
+static audio_format_converter_t resolve_memcpy_by_audio_format(
+        audio_format_t dst_format, audio_format_t src_format)
 {
-    /* default cases for error falls through to assert(false) below. */
     if (dst_format == src_format) {
         switch (dst_format) {
-        case AUDIO_FORMAT_PCM_16_BIT:
-        case AUDIO_FORMAT_PCM_FLOAT:
         case AUDIO_FORMAT_PCM_8_BIT:
+            return memcpy_samesize_1;
+        case AUDIO_FORMAT_PCM_16_BIT:
+            return memcpy_samesize_2;
         case AUDIO_FORMAT_PCM_24_BIT_PACKED:
+            return memcpy_samesize_3;
+        case AUDIO_FORMAT_PCM_FLOAT:
         case AUDIO_FORMAT_PCM_32_BIT:
         case AUDIO_FORMAT_PCM_8_24_BIT:
-            if (dst != src) {
-                // TODO: should assert if memory regions overlap.
-                memcpy(dst, src, count * audio_bytes_per_sample(dst_format));
-            }
-            return;
+            return memcpy_samesize_4;
         default:
-            break;
+            return NULL;
         }
     }
     switch (dst_format) {
     case AUDIO_FORMAT_PCM_16_BIT:
         switch (src_format) {
         case AUDIO_FORMAT_PCM_FLOAT:
-            memcpy_to_i16_from_float((int16_t*)dst, (float*)src, count);
-            return;
+            return memcpy_to_i16_from_float_wrapper;
         case AUDIO_FORMAT_PCM_8_BIT:
-            memcpy_to_i16_from_u8((int16_t*)dst, (uint8_t*)src, count);
-            return;
+            return memcpy_to_i16_from_u8_wrapper;
         case AUDIO_FORMAT_PCM_24_BIT_PACKED:
-            memcpy_to_i16_from_p24((int16_t*)dst, (uint8_t*)src, count);
-            return;
+            return memcpy_to_i16_from_p24_wrapper;
         case AUDIO_FORMAT_PCM_32_BIT:
-            memcpy_to_i16_from_i32((int16_t*)dst, (int32_t*)src, count);
-            return;
+            return memcpy_to_i16_from_i32_wrapper;
         case AUDIO_FORMAT_PCM_8_24_BIT:
-            memcpy_to_i16_from_q8_23((int16_t*)dst, (int32_t*)src, count);
-            return;
+            return memcpy_to_i16_from_q8_23_wrapper;
         default:
-            break;
+            return NULL;
         }
-        break;
     case AUDIO_FORMAT_PCM_FLOAT:
         switch (src_format) {
         case AUDIO_FORMAT_PCM_16_BIT:
-            memcpy_to_float_from_i16((float*)dst, (int16_t*)src, count);
-            return;
+            return memcpy_to_float_from_i16_wrapper;
         case AUDIO_FORMAT_PCM_8_BIT:
-            memcpy_to_float_from_u8((float*)dst, (uint8_t*)src, count);
-            return;
+            return memcpy_to_float_from_u8_wrapper;
         case AUDIO_FORMAT_PCM_24_BIT_PACKED:
-            memcpy_to_float_from_p24((float*)dst, (uint8_t*)src, count);
-            return;
+            return memcpy_to_float_from_p24_wrapper;
         case AUDIO_FORMAT_PCM_32_BIT:
-            memcpy_to_float_from_i32((float*)dst, (int32_t*)src, count);
-            return;
+            return memcpy_to_float_from_i32_wrapper;
         case AUDIO_FORMAT_PCM_8_24_BIT:
-            memcpy_to_float_from_q8_23((float*)dst, (int32_t*)src, count);
-            return;
+            return memcpy_to_float_from_q8_23_wrapper;
         default:
-            break;
+            return NULL;
         }
-        break;
     case AUDIO_FORMAT_PCM_8_BIT:
         switch (src_format) {
         case AUDIO_FORMAT_PCM_16_BIT:
-            memcpy_to_u8_from_i16((uint8_t*)dst, (int16_t*)src, count);
-            return;
+            return memcpy_to_u8_from_i16_wrapper;
         case AUDIO_FORMAT_PCM_FLOAT:
-            memcpy_to_u8_from_float((uint8_t*)dst, (float*)src, count);
-            return;
+            return memcpy_to_u8_from_float_wrapper;
         // The following converts HAL to AudioRecord formats.
         case AUDIO_FORMAT_PCM_24_BIT_PACKED:
-            memcpy_to_u8_from_p24((uint8_t*)dst, (uint8_t*)src, count);
-            return;
+            return memcpy_to_u8_from_p24_wrapper;
         case AUDIO_FORMAT_PCM_32_BIT:
-            memcpy_to_u8_from_i32((uint8_t*)dst, (int32_t*)src, count);
-            return;
+            return memcpy_to_u8_from_i32_wrapper;
         case AUDIO_FORMAT_PCM_8_24_BIT:
-            memcpy_to_u8_from_q8_23((uint8_t*)dst, (int32_t*)src, count);
-            return;
+            return memcpy_to_u8_from_q8_23_wrapper;
         default:
-            break;
+            return NULL;
         }
-        break;
     case AUDIO_FORMAT_PCM_24_BIT_PACKED:
         switch (src_format) {
         case AUDIO_FORMAT_PCM_16_BIT:
-            memcpy_to_p24_from_i16((uint8_t*)dst, (int16_t*)src, count);
-            return;
+            return memcpy_to_p24_from_i16_wrapper;
         case AUDIO_FORMAT_PCM_FLOAT:
-            memcpy_to_p24_from_float((uint8_t*)dst, (float*)src, count);
-            return;
+            return memcpy_to_p24_from_float_wrapper;
         case AUDIO_FORMAT_PCM_32_BIT:
-            memcpy_to_p24_from_i32((uint8_t*)dst, (int32_t*)src, count);
-            return;
+            return memcpy_to_p24_from_i32_wrapper;
         case AUDIO_FORMAT_PCM_8_24_BIT:
-            memcpy_to_p24_from_q8_23((uint8_t*)dst, (int32_t*)src, count);
-            return;
+            return memcpy_to_p24_from_q8_23_wrapper;
         default:
-            break;
+            return NULL;
         }
-        break;
     case AUDIO_FORMAT_PCM_32_BIT:
         switch (src_format) {
         case AUDIO_FORMAT_PCM_16_BIT:
-            memcpy_to_i32_from_i16((int32_t*)dst, (int16_t*)src, count);
-            return;
+            return memcpy_to_i32_from_i16_wrapper;
         case AUDIO_FORMAT_PCM_FLOAT:
-            memcpy_to_i32_from_float((int32_t*)dst, (float*)src, count);
-            return;
+            return memcpy_to_i32_from_float_wrapper;
         case AUDIO_FORMAT_PCM_24_BIT_PACKED:
-            memcpy_to_i32_from_p24((int32_t*)dst, (uint8_t *)src, count);
-            return;
+            return memcpy_to_i32_from_p24_wrapper;
         default:
-            break;
+            return NULL;
         }
-        break;
     case AUDIO_FORMAT_PCM_8_24_BIT:
         switch (src_format) {
         case AUDIO_FORMAT_PCM_16_BIT:
-            memcpy_to_q8_23_from_i16((int32_t*)dst, (int16_t*)src, count);
-            return;
+            return memcpy_to_q8_23_from_i16_wrapper;
         case AUDIO_FORMAT_PCM_FLOAT:
-            memcpy_to_q8_23_from_float_with_clamp((int32_t*)dst, (float*)src, count);
-            return;
-        case AUDIO_FORMAT_PCM_24_BIT_PACKED: {
-            memcpy_to_q8_23_from_p24((int32_t *)dst, (uint8_t *)src, count);
-            return;
-        }
+            return memcpy_to_q8_23_from_float_with_clamp_wrapper;
+        case AUDIO_FORMAT_PCM_24_BIT_PACKED:
+            return memcpy_to_q8_23_from_p24_wrapper;
         default:
-            break;
+            return NULL;
         }
-        break;
     default:
-        break;
+        return NULL;
     }
+}
+
+audio_format_converter_t audio_format_get_converter(audio_format_t dst_format,
+        audio_format_t src_format)
+{
+    return resolve_memcpy_by_audio_format(dst_format, src_format);
+}
+
+void memcpy_by_audio_format(void *dst, audio_format_t dst_format,
+        const void *src, audio_format_t src_format, size_t count)
+{
+    const audio_format_converter_t fn =
+            resolve_memcpy_by_audio_format(dst_format, src_format);
     // invalid src format for dst format
-    assert(false);
+    assert(fn != NULL);
+    fn(dst, src, count);
+    audio_utils_perf_counter_add(AUDIO_UTILS_PERF_COUNTER_CONVERTER_BYTES,
+            count * audio_bytes_per_sample(dst_format));
+}
+
+void memcpy_by_audio_format_inplace(void *buf, audio_format_t dst_format,
+        audio_format_t src_format, size_t count)
+{
+    const audio_format_converter_t fn =
+            resolve_memcpy_by_audio_format(dst_format, src_format);
+    // invalid src format for dst format
+    assert(fn != NULL);
+    /* The conversion primitives iterate back to front when widening and front
+     * to back otherwise, so calling them with dst == src is safe. */
+    fn(buf, buf, count);
+}
+
+void memcpy_by_audio_format_multi(audio_format_t dst_format, audio_format_t src_format,
+        const audio_format_buffer_desc_t *descs, size_t num_descs)
+{
+    const audio_format_converter_t fn =
+            resolve_memcpy_by_audio_format(dst_format, src_format);
+    // invalid src format for dst format
+    assert(fn != NULL);
+    size_t total = 0;
+    for (size_t i = 0; i < num_descs; ++i) {
+        if (i + 1 < num_descs) {
+            __builtin_prefetch(descs[i + 1].src);
+        }
+        fn(descs[i].dst, descs[i].src, descs[i].count);
+        total += descs[i].count;
+    }
+    audio_utils_perf_counter_add(AUDIO_UTILS_PERF_COUNTER_CONVERTER_BYTES,
+            total * audio_bytes_per_sample(dst_format));
 }
 
 size_t memcpy_by_index_array_initialization_from_channel_mask(int8_t *idxary, size_t arysize,
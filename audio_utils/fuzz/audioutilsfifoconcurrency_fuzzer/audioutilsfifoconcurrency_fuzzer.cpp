@@ -0,0 +1,320 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Concurrency harness for the FIFO classes.  Unlike the single-threaded
+// reader/writer fuzzer, this one runs real writer and reader threads
+// concurrently, each executing an operation schedule decoded from the fuzz
+// input (a write / obtain+release / flush storm).  Every frame carries a
+// writer id and sequence number, so the reader can check the ordering
+// invariants of the index protocol while the indices actually race - on
+// weakly ordered cores this doubles as relaxed-memory stress.  Any invariant
+// violation abort()s so libFuzzer records the schedule that found it.
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <audio_utils/fifo.h>
+#include <fuzzer/FuzzedDataProvider.h>
+
+namespace {
+
+// each frame is one word: writer id in the top byte, sequence below.
+constexpr uint32_t kFrameSize = sizeof(uint32_t);
+constexpr uint32_t kMaxWriters = 4;
+constexpr uint32_t kSeqMask = 0x00FFFFFF;
+
+constexpr size_t kMaxOpsPerThread = 24;
+// bounds the retry loops so every schedule terminates even when the other
+// side has finished its schedule and the FIFO stays full or empty.
+constexpr int kMaxSpins = 2000;
+
+enum WriterOpKind : uint8_t { WRITER_WRITE, WRITER_OBTAIN_RELEASE };
+enum ReaderOpKind : uint8_t { READER_READ, READER_OBTAIN_RELEASE, READER_FLUSH };
+
+struct Op {
+    uint8_t kind;
+    uint32_t count;
+};
+
+uint32_t makeFrame(uint32_t writerId, uint32_t seq) {
+    return (writerId << 24) | (seq & kSeqMask);
+}
+
+// Verifies frames consumed by the reader: the sequence of each writer must be
+// strictly increasing (gaps are legal, the reader may lose or flush frames).
+//
+// With a throttling reader the writer can never overwrite unread frames, so
+// any disorder is a protocol bug and aborts immediately.  A non-throttling
+// reader may have its frames overwritten while it is still copying them -
+// the protocol only reports that as lost frames on the next operation - so
+// in that mode disorder is merely counted, and the caller checks that every
+// disordered batch was matched by a reported loss.
+class SequenceChecker {
+public:
+    explicit SequenceChecker(bool strict) : mStrict(strict) {}
+
+    void verify(const uint32_t *frames, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            const uint32_t writerId = frames[i] >> 24;
+            const uint32_t seq = frames[i] & kSeqMask;
+            if (writerId >= kMaxWriters) {
+                abort();    // corrupted frame: id the harness never wrote
+            }
+            if (mSeen[writerId] && seq <= mLastSeq[writerId]) {
+                if (mStrict) {
+                    abort();    // duplicated or reordered frame
+                }
+                ++mViolations;
+            }
+            mLastSeq[writerId] = seq;
+            mSeen[writerId] = true;
+        }
+    }
+
+    uint64_t violations() const { return mViolations; }
+
+private:
+    const bool mStrict;
+    uint64_t mViolations = 0;
+    uint32_t mLastSeq[kMaxWriters]{};
+    bool mSeen[kMaxWriters]{};
+};
+
+// One single-writer thread driving write() and obtain()/release().
+void runWriter(audio_utils_fifo &fifo, audio_utils_fifo_writer *writer,
+        audio_utils_fifo_multiwriter *multiwriter, uint32_t writerId,
+        const std::vector<Op> &ops, std::atomic<uint64_t> &totalWritten) {
+    uint32_t seq = 0;
+    std::vector<uint32_t> frames(fifo.capacity());
+    for (const Op &op : ops) {
+        size_t remaining = op.count;
+        for (int spins = 0; remaining > 0 && spins < kMaxSpins; ++spins) {
+            ssize_t actual;
+            if (writer != nullptr && op.kind == WRITER_OBTAIN_RELEASE) {
+                audio_utils_iovec iovec[2];
+                actual = writer->obtain(iovec, remaining, nullptr);
+                if (actual > 0) {
+                    uint32_t *buffer = (uint32_t *)fifo.buffer();
+                    size_t produced = 0;
+                    for (size_t part = 0; part < 2; ++part) {
+                        for (size_t i = 0; i < iovec[part].mLength; ++i) {
+                            buffer[iovec[part].mOffset + i] =
+                                    makeFrame(writerId, seq + produced++);
+                        }
+                    }
+                    if (produced != (size_t)actual) {
+                        abort();    // obtain() iovec lengths disagree with its count
+                    }
+                    writer->release(actual);
+                }
+            } else {
+                const size_t chunk = std::min(remaining, frames.size());
+                for (size_t i = 0; i < chunk; ++i) {
+                    frames[i] = makeFrame(writerId, seq + i);
+                }
+                actual = writer != nullptr ? writer->write(frames.data(), chunk)
+                        : multiwriter->write(frames.data(), chunk);
+            }
+            if (actual < 0) {
+                if (actual == -EIO) {
+                    abort();        // corrupted indices
+                }
+                break;
+            }
+            if ((size_t)actual > remaining) {
+                abort();            // wrote more than requested
+            }
+            seq += actual;
+            remaining -= actual;
+            totalWritten.fetch_add(actual, std::memory_order_relaxed);
+            if (actual == 0) {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
+
+// The reader thread consumes its schedule, then drains what the writers
+// managed to publish, verifying sequence order throughout.
+void runReader(audio_utils_fifo &fifo, audio_utils_fifo_reader &reader, bool throttles,
+        const std::vector<Op> &ops, std::atomic<bool> &writersDone,
+        uint64_t &totalConsumed) {
+    SequenceChecker checker(throttles);
+    uint64_t totalLost = 0;
+    std::vector<uint32_t> frames(fifo.capacity());
+    auto doRead = [&](size_t count) {
+        size_t lost = 0;
+        const ssize_t actual = reader.read(frames.data(),
+                std::min(count, frames.size()), nullptr, &lost);
+        totalConsumed += lost;
+        totalLost += lost;
+        if (actual < 0) {
+            if (actual == -EIO) {
+                abort();
+            }
+            return actual;          // -EOVERFLOW: resynced, lost counted above
+        }
+        checker.verify(frames.data(), actual);
+        totalConsumed += actual;
+        return actual;
+    };
+    for (const Op &op : ops) {
+        switch (op.kind) {
+        case READER_READ:
+            if (doRead(op.count) == 0) {
+                std::this_thread::yield();
+            }
+            break;
+        case READER_OBTAIN_RELEASE: {
+            audio_utils_iovec iovec[2];
+            size_t lost = 0;
+            const ssize_t actual = reader.obtain(iovec, op.count, nullptr, &lost);
+            totalConsumed += lost;
+            totalLost += lost;
+            if (actual < 0) {
+                if (actual == -EIO) {
+                    abort();
+                }
+                break;
+            }
+            const uint32_t *buffer = (const uint32_t *)fifo.buffer();
+            size_t seen = 0;
+            for (size_t part = 0; part < 2; ++part) {
+                checker.verify(buffer + iovec[part].mOffset, iovec[part].mLength);
+                seen += iovec[part].mLength;
+            }
+            if (seen != (size_t)actual) {
+                abort();            // obtain() iovec lengths disagree with its count
+            }
+            reader.release(actual);
+            totalConsumed += actual;
+            if (actual == 0) {
+                std::this_thread::yield();
+            }
+            break;
+        }
+        case READER_FLUSH: {
+            size_t lost = 0;
+            const ssize_t flushed = reader.flush(&lost);
+            if (flushed == -EIO) {
+                abort();
+            }
+            if (flushed > 0) {
+                totalConsumed += flushed;
+            }
+            totalConsumed += lost;
+            totalLost += lost;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    // drain so the final accounting below can be exact.
+    for (int spins = 0; spins < kMaxSpins; ++spins) {
+        const ssize_t actual = doRead(frames.size());
+        if (actual == 0 && writersDone.load(std::memory_order_acquire)) {
+            break;
+        }
+        if (actual <= 0) {
+            std::this_thread::yield();
+        }
+    }
+    // a non-throttling reader may see disordered frames only if the FIFO
+    // actually reported an overrun somewhere along the way.
+    if (checker.violations() > 0 && totalLost == 0) {
+        abort();
+    }
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (data == nullptr || size < 8) {
+        return 0;
+    }
+    FuzzedDataProvider provider(data, size);
+
+    const bool throttleRead = provider.ConsumeBool();
+    const bool useMultiwriter = provider.ConsumeBool();
+    const uint32_t numWriters = useMultiwriter
+            ? provider.ConsumeIntegralInRange<uint32_t>(2, kMaxWriters) : 1;
+    const uint32_t frameCount = provider.ConsumeIntegralInRange<uint32_t>(2, 512);
+
+    // decode one operation schedule per thread before any thread starts;
+    // FuzzedDataProvider is not thread safe.
+    std::vector<std::vector<Op>> writerOps(numWriters);
+    std::vector<Op> readerOps;
+    while (provider.remaining_bytes() >= 2
+            && readerOps.size() < kMaxOpsPerThread) {
+        for (uint32_t w = 0; w < numWriters; ++w) {
+            writerOps[w].push_back({
+                (uint8_t)(provider.ConsumeIntegral<uint8_t>() % 2),
+                provider.ConsumeIntegralInRange<uint32_t>(1, frameCount)});
+        }
+        readerOps.push_back({
+                (uint8_t)(provider.ConsumeIntegral<uint8_t>() % 3),
+                provider.ConsumeIntegralInRange<uint32_t>(1, frameCount)});
+    }
+    if (readerOps.empty()) {
+        return 0;
+    }
+
+    std::vector<uint32_t> fifoBuffer(frameCount);
+    audio_utils_fifo fifo(frameCount, kFrameSize, fifoBuffer.data(), throttleRead);
+    audio_utils_fifo_reader reader(fifo, throttleRead);
+
+    std::unique_ptr<audio_utils_fifo_writer> writer;
+    std::unique_ptr<audio_utils_fifo_multiwriter> multiwriter;
+    if (useMultiwriter) {
+        multiwriter = std::make_unique<audio_utils_fifo_multiwriter>(fifo);
+    } else {
+        writer = std::make_unique<audio_utils_fifo_writer>(fifo);
+    }
+
+    std::atomic<uint64_t> totalWritten(0);
+    std::atomic<bool> writersDone(false);
+    uint64_t totalConsumed = 0;
+
+    std::vector<std::thread> writers;
+    for (uint32_t w = 0; w < numWriters; ++w) {
+        writers.emplace_back(runWriter, std::ref(fifo), writer.get(),
+                multiwriter.get(), w, std::cref(writerOps[w]), std::ref(totalWritten));
+    }
+    std::thread readerThread([&] {
+        runReader(fifo, reader, throttleRead, readerOps, writersDone, totalConsumed);
+    });
+
+    for (auto &t : writers) {
+        t.join();
+    }
+    writersDone.store(true, std::memory_order_release);
+    readerThread.join();
+
+    // conservation: every written frame was either read, flushed, or counted
+    // lost; nothing was fabricated.  (The drain loop is bounded, so on a
+    // pathological schedule a few frames may legally remain unconsumed.)
+    const ssize_t leftover = reader.available();
+    if (leftover < 0) {
+        abort();
+    }
+    if (totalConsumed + leftover > totalWritten.load(std::memory_order_relaxed)) {
+        abort();
+    }
+    return 0;
+}
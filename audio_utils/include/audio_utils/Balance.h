@@ -17,6 +17,7 @@
 #ifndef ANDROID_AUDIO_UTILS_BALANCE_H
 #define ANDROID_AUDIO_UTILS_BALANCE_H
 
+#include <audio_utils/RampGenerator.h>
 #include <audio_utils/channels.h>
 #include <functional>
 #include <math.h>       /* expf */
@@ -121,6 +122,47 @@ public:
      */
     void process(float *buffer, size_t frames);
 
+    /**
+     * \brief Processes balance and master volume for audio data in one pass.
+     *
+     * The master volume is folded into the balance volumes so the output
+     * chain applies a single multiply per sample instead of separate balance
+     * and volume passes. Gain changes (balance or master volume) ramp in
+     * blocks of kRampBlockFrames frames: the gains are constant within a
+     * block, which allows vector multiplies, and step to the target over
+     * the buffer.
+     *
+     * setChannelMask() must be called before this variant; unlike process(),
+     * a balance of 0.f still applies the master volume.
+     *
+     * \param buffer       pointer to the audio data to be modified in-place.
+     * \param frames       number of frames of audio data to convert.
+     * \param masterVolume master volume applied to all channels.
+     *
+     */
+    void process(float *buffer, size_t frames, float masterVolume);
+
+    /**
+     * \brief Mono blends audio data and processes balance in a single pass.
+     *
+     * Each output frame carries the arithmetic average of the input frame
+     * channels (as mono_blend() computes in-place) scaled by the balance
+     * volumes, so mono-ing for accessibility does not require a second pass
+     * over the buffer. in and out may be the same buffer and must both use
+     * the channel mask set with setChannelMask().
+     *
+     * Unlike process(), a balance of 0.f still blends (with unity volumes).
+     * A channel mask of less than 2 channels copies in to out unchanged.
+     *
+     * \param in        pointer to the audio data to read.
+     * \param out       pointer to where the blended audio data is written.
+     * \param frames    number of frames of audio data to convert.
+     * \param limit     whether to use a limiter (currently only for stereo,
+     *                  as with mono_blend()).
+     *
+     */
+    void processMonoBlend(const float *in, float *out, size_t frames, bool limit = false);
+
     /**
      * \brief Computes the stereo gains for left and right channels.
      *
@@ -142,8 +184,23 @@ public:
      */
     std::string toString() const;
 
+    /** \brief Number of frames sharing one gain step when ramping in blocks. */
+    static constexpr size_t kRampBlockFrames = RampGenerator::kRampBlockFrames;
+
 private:
 
+    /**
+     * \brief Multiplies each frame by the per channel gain vector.
+     *
+     * Dispatches to fixed channel count loops for common channel counts
+     * so the multiplies vectorize.
+     *
+     * \param buffer    pointer to the audio data to be modified in-place.
+     * \param frames    number of frames of audio data to convert.
+     * \param gains     mChannelCount gains applied to each frame.
+     */
+    void applyGains(float *buffer, size_t frames, const float *gains) const;
+
     /**
      * \brief Normalizes f: [0, 1] -> [a, b] to g: [0, 1] -> [0, 1].
      *
@@ -183,6 +240,9 @@ private:
     bool mRamp;                       // whether ramp is enabled.
     float mRampBalance = 0.f;         // last (starting) balance to begin ramp.
     std::vector<float> mRampVolumes;  // last (starting) volumes to begin ramp, clear for no ramp.
+    float mRampMasterVolume = 1.f;    // last (starting) master volume to begin ramp.
+    std::vector<float> mGains;        // scratch for combined balance and master volume gains.
+    RampGenerator mRampGenerator;     // steps and applies the gains of the ramped paths.
 
     const std::function<float(float)> mCurve; // monotone volume transfer func [0, 1] -> [0, 1]
 };
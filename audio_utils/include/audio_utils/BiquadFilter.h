@@ -520,6 +520,117 @@ enum FILTER_OPTION {
     FILTER_OPTION_SCALAR_ONLY = (1 << 0),
 };
 
+// Maps a compile-time channel count to the widest accelerated vector type.
+// Used by BiquadFilterCascade below, where the channel count is a template
+// parameter rather than a constructor argument.
+template <typename D, size_t CHANNELS>
+struct fixed_vector {
+    using type = intrinsics::internal_array_t<D, CHANNELS>;
+};
+
+template <typename D>
+struct fixed_vector<D, 1> {
+    using type = D;
+};
+
+#ifdef USE_NEON
+template <>
+struct fixed_vector<float, 2> {
+    using type = float32x2_t;
+};
+
+template <>
+struct fixed_vector<float, 4> {
+    using type = float32x4_t;
+};
+
+template <>
+struct fixed_vector<float, 8> {
+    using type = float32x4x2_t;
+};
+
+template <>
+struct fixed_vector<float, 16> {
+    using type = float32x4x4_t;
+};
+
+#if defined(__aarch64__)
+template <>
+struct fixed_vector<double, 2> {
+    using type = float64x2_t;
+};
+#endif
+#endif // USE_NEON
+
+template <typename D, size_t CHANNELS>
+using fixed_vector_t = typename fixed_vector<D, CHANNELS>::type;
+
+// Processes SECTIONS cascaded Biquad sections in a single pass over the data.
+// T is the vector type covering all channels of a frame; the coefficients are
+// shared between channels (the SAME_COEF_PER_CHANNEL true layout) and stored
+// section major in normalized form b0 b1 b2 a1 a2.
+//
+// The section states and coefficients are loaded once per call and handed
+// from section to section in registers inside the sample loop; only the final
+// section's output is written, so an N section cascade makes one pass over
+// memory instead of N.
+template <size_t SECTIONS, typename T, typename F>
+void biquad_cascade_func_impl(F *out, const F *in, size_t frames, size_t stride,
+        F *delays, const F *coefs) {
+    using namespace android::audio_utils::intrinsics;
+
+    constexpr size_t CHANNELS = sizeof(T) / sizeof(F);
+    struct Section {
+        F b0, b1ss, b2ss, negativeA1, negativeA2; // state-space converted
+        T s[kBiquadNumDelays];
+    } sections[SECTIONS];
+
+    for (size_t j = 0; j < SECTIONS; ++j) {
+        const F *c = coefs + j * kBiquadNumCoefs;
+        F *d = delays + j * kBiquadNumDelays * CHANNELS;
+        sections[j].b0 = c[0];
+        sections[j].b1ss = c[1] - c[0] * c[3]; // b1 - b0 * a1
+        sections[j].b2ss = c[2] - c[0] * c[4]; // b2 - b0 * a2
+        sections[j].negativeA1 = -c[3];
+        sections[j].negativeA2 = -c[4];
+        sections[j].s[0] = vld1<T>(&d[0]);
+        sections[j].s[1] = vld1<T>(&d[CHANNELS]);
+    }
+
+    T x, y, new_s0; // OK to declare temps here rather than at the point of initialization.
+#ifdef USE_DITHER
+    constexpr F DITHER_VALUE = std::numeric_limits<float>::min() * (1 << 24); // use FLOAT
+    T dither = vdupn<T>(DITHER_VALUE); // NEON does not have vector + scalar acceleration.
+#endif
+    while (frames > 0) {
+        x = vld1<T>(in);
+        in += stride;
+#ifdef USE_DITHER
+        x = vadd(x, dither);
+        dither = vneg(dither);
+#endif
+        #pragma unroll
+        for (size_t j = 0; j < SECTIONS; ++j) {
+            y = vmla(sections[j].s[0], sections[j].b0, x);
+            new_s0 = vmla(vmla(sections[j].s[1], sections[j].b1ss, x),
+                    sections[j].negativeA1, sections[j].s[0]);
+            sections[j].s[1] = vmla(vmul(sections[j].b2ss, x),
+                    sections[j].negativeA2, sections[j].s[0]);
+            sections[j].s[0] = new_s0;
+            x = y; // feed the next section
+        }
+        vst1(out, y);
+        out += stride;
+        frames--;
+    }
+
+    for (size_t j = 0; j < SECTIONS; ++j) {
+        F *d = delays + j * kBiquadNumDelays * CHANNELS;
+        vst1(&d[0], sections[j].s[0]);
+        vst1(&d[CHANNELS], sections[j].s[1]);
+    }
+}
+
 
 /**
  * DefaultBiquadConstOptions holds the default set of options for customizing
@@ -1106,6 +1217,123 @@ private:
     std::decay_t<decltype(mFilterFuncs[0])> mFunc;
 };
 
+/**
+ * BiquadFilterCascade
+ *
+ * A cascade of SECTIONS Biquad sections with a compile time channel count,
+ * applied in a single pass over the data.
+ *
+ * Unlike BiquadFilter, which selects a vector kernel from the runtime channel
+ * count on every process() call, the channel count here is a template
+ * parameter, so process() compiles to one fixed register-resident kernel;
+ * CHANNELS of 2, 4, 8, and 16 map directly onto the NEON vector types.
+ * The sections are chained inside the sample loop: section states and
+ * coefficients are loaded once per process() call and the intermediate
+ * outputs are handed from section to section in registers, so a five section
+ * EQ chain makes one pass over memory instead of five.
+ *
+ * The Biquad coefficients are shared between channels (the
+ * SAME_COEF_PER_CHANNEL = true configuration of BiquadFilter), as is the case
+ * for an EQ applied identically to all channels of a stream.  All sections
+ * run the full second order update; there is no per-occupancy dispatch, so
+ * zero coefficients gain nothing here.
+ *
+ * \param CHANNELS number of channels, fixed at compile time.
+ * \param SECTIONS number of cascaded Biquad sections, section 0 is applied
+ *         to the input first.
+ * \param D type variable representing the data type, one of float or double.
+ *         The default is float.
+ */
+template <size_t CHANNELS, size_t SECTIONS, typename D = float>
+class BiquadFilterCascade {
+    static_assert(CHANNELS >= 1);
+    static_assert(SECTIONS >= 1);
+public:
+    template <typename T = std::array<D, kBiquadNumCoefs>>
+    explicit BiquadFilterCascade(const std::array<T, SECTIONS>& coefs = {}) {
+        for (size_t section = 0; section < SECTIONS; ++section) {
+            setCoefficients(section, coefs[section]);
+        }
+    }
+
+    /**
+     * \brief Sets the coefficients of one section of the cascade.
+     *
+     * \param section the section index to set.
+     * \param coefs the coefficients, in the 5 coefficient normalized or
+     *         6 coefficient general Biquad forms accepted by
+     *         BiquadFilter::setCoefficients().
+     * \return true if the section is stable, otherwise false.
+     */
+    template <typename T = std::array<D, kBiquadNumCoefs>>
+    bool setCoefficients(size_t section, const T& coefs) {
+        assert(section < SECTIONS);
+        const auto lcoef = details::reduceCoefficients<D, T>(coefs);
+        std::copy(lcoef.begin(), lcoef.end(),
+                mCoefs.begin() + section * kBiquadNumCoefs);
+        return isStable(section);
+    }
+
+    /**
+     * Returns true if the given section of the cascade is stable.
+     */
+    bool isStable(size_t section) const {
+        assert(section < SECTIONS);
+        return details::isStable(
+                mCoefs[section * kBiquadNumCoefs + 3],
+                mCoefs[section * kBiquadNumCoefs + 4]);
+    }
+
+    /**
+     * \brief Filters the input data through all sections in one pass.
+     *
+     * \param out     pointer to the output data
+     * \param in      pointer to the input data
+     * \param frames  number of audio frames to be processed
+     */
+    void process(D* out, const D* in, size_t frames) {
+        process(out, in, frames, CHANNELS);
+    }
+
+    /**
+     * \brief Filters the input data with stride
+     *
+     * \param out     pointer to the output data
+     * \param in      pointer to the input data
+     * \param frames  number of audio frames to be processed
+     * \param stride  the total number of samples associated with a frame,
+     *                if not CHANNELS.
+     */
+    void process(D* out, const D* in, size_t frames, size_t stride) {
+        assert(stride >= CHANNELS);
+        details::biquad_cascade_func_impl<SECTIONS, VectorType>(
+                out, in, frames, stride, mDelays.data(), mCoefs.data());
+    }
+
+    /**
+     * \brief Clears the delay elements of all sections
+     */
+    void clear() {
+        mDelays.fill(0);
+    }
+
+private:
+    using VectorType = details::fixed_vector_t<D, CHANNELS>;
+
+    /**
+     * \var D mCoefs
+     * \brief Stores the normalized filter coefficients, section major.
+     */
+    std::array<D, SECTIONS * kBiquadNumCoefs> mCoefs{};
+
+    /**
+     * \var D mDelays
+     * \brief The delay states, section major, channel interleaved within
+     * a section.
+     */
+    std::array<D, SECTIONS * kBiquadNumDelays * CHANNELS> mDelays{};
+};
+
 } // namespace android::audio_utils
 
 #pragma pop_macro("USE_DITHER")
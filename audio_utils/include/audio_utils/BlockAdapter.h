@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_BLOCK_ADAPTER_H
+#define ANDROID_AUDIO_BLOCK_ADAPTER_H
+
+#include <string.h>
+
+#include <vector>
+
+#include <audio_utils/fifo.h>
+
+namespace android::audio_utils {
+
+/**
+ * Adapts a fixed-block processing function to arbitrary host block sizes.
+ *
+ * Effect implementations behind audio_effect.h receive whatever block size the
+ * host mixer uses, while FFT-based effects want a fixed (typically power of
+ * two) block.  This adapter sits between them so each effect does not need its
+ * own bespoke ring buffer:
+ *
+ *  - While every process() count is a multiple of the block size, the
+ *    processing function is called directly on the caller's buffers with no
+ *    copying and no added latency.
+ *  - The first unaligned count switches permanently (until reset()) to
+ *    rebuffering through a pair of single-threaded FIFOs, which adds exactly
+ *    one block of latency: the output is the processed input delayed by
+ *    blockFrames, preceded by blockFrames of silence.
+ *
+ * Like the FIFO machinery it is built on, the adapter works on frames of
+ * opaque bytes, so it is sample format and channel count agnostic.  On the
+ * aligned path the caller's input and output buffers are handed straight to
+ * the processing function, so in-place operation (\p out == \p in) is
+ * supported exactly when the processing function supports it; on the buffered
+ * path the function always sees distinct scratch buffers.
+ *
+ * The adapter is not thread safe: process() and reset() must be called from
+ * the effect's processing thread.
+ */
+class BlockAdapter {
+public:
+    /**
+     * Fixed-block processing function.
+     *
+     * \param cookie Opaque value supplied at construction.
+     * \param in     Pointer to \p frames input frames.
+     * \param out    Pointer to space for \p frames output frames.
+     *               May equal \p in on the aligned path; see class comments.
+     * \param frames Number of frames, always the adapter's block size.
+     */
+    using process_block_fn = void (*)(void *cookie, const void *in, void *out, size_t frames);
+
+    /**
+     * Construct a block adapter.
+     *
+     * \param blockFrames Block size of the processing function in frames, > 0.
+     * \param frameSize   Size of each frame in bytes, > 0.
+     * \param maxFrames   Largest count the host is expected to pass to process(), > 0.
+     *                    Only affects internal buffer sizing; larger counts are
+     *                    handled by slicing, at the cost of intermediate latency
+     *                    variation on the buffered path.
+     * \param process     Non-NULL fixed-block processing function.
+     * \param cookie      Opaque value passed through to \p process.
+     */
+    BlockAdapter(uint32_t blockFrames, uint32_t frameSize, uint32_t maxFrames,
+            process_block_fn process, void *cookie)
+        : mBlockFrames(blockFrames), mFrameSize(frameSize), mMaxFrames(maxFrames),
+          mProcess(process), mCookie(cookie),
+          mInBuffer((size_t) (blockFrames + maxFrames) * frameSize),
+          mOutBuffer((size_t) (blockFrames + maxFrames) * frameSize),
+          mBlockScratch((size_t) blockFrames * frameSize * 2),
+          mInFifo(blockFrames + maxFrames, frameSize, mInBuffer.data(),
+                  true /* throttlesWriter */, AUDIO_UTILS_FIFO_SYNC_SINGLE_THREADED),
+          mOutFifo(blockFrames + maxFrames, frameSize, mOutBuffer.data(),
+                  true /* throttlesWriter */, AUDIO_UTILS_FIFO_SYNC_SINGLE_THREADED),
+          mInWriter(mInFifo), mInReader(mInFifo),
+          mOutWriter(mOutFifo), mOutReader(mOutFifo)
+    { }
+
+    /**
+     * Process \p frames frames through the fixed-block function.
+     *
+     * \param in     Pointer to \p frames input frames.
+     * \param out    Pointer to space for \p frames output frames.
+     * \param frames Number of frames, any value >= 0.
+     */
+    void process(const void *in, void *out, size_t frames) {
+        while (frames > 0) {
+            const size_t slice = frames <= mMaxFrames ? frames : mMaxFrames;
+            processSlice(in, out, slice);
+            in = (const char *) in + slice * mFrameSize;
+            out = (char *) out + slice * mFrameSize;
+            frames -= slice;
+        }
+    }
+
+    /**
+     * Discard all buffered frames and return to the zero-copy aligned path.
+     * Typically called when the effect is disabled or its stream is flushed.
+     */
+    void reset() {
+        if (mBuffered) {
+            (void) mInReader.flush();
+            (void) mOutReader.flush();
+            mBuffered = false;
+        }
+    }
+
+    /**
+     * Return the current latency added by the adapter in frames:
+     * zero on the aligned path, the block size once rebuffering.
+     */
+    uint32_t latencyFrames() const
+            { return mBuffered ? mBlockFrames : 0; }
+
+private:
+    void processSlice(const void *in, void *out, size_t frames) {
+        if (!mBuffered) {
+            if (frames % mBlockFrames == 0) {
+                // Zero-copy path: hand the caller's buffers to the processing
+                // function one block at a time.
+                for (size_t i = 0; i < frames; i += mBlockFrames) {
+                    mProcess(mCookie, (const char *) in + i * mFrameSize,
+                            (char *) out + i * mFrameSize, mBlockFrames);
+                }
+                return;
+            }
+            // First unaligned count: prime the output FIFO with one block of
+            // silence, which establishes the fixed latency of the buffered path.
+            memset(mBlockScratch.data(), 0, (size_t) mBlockFrames * mFrameSize);
+            (void) mOutWriter.write(mBlockScratch.data(), mBlockFrames);
+            mBuffered = true;
+        }
+        // The FIFOs are sized so that none of these transfers can be short:
+        // the input FIFO holds at most blockFrames - 1 residual frames plus
+        // this slice, and the output FIFO at most one block more than that.
+        (void) mInWriter.write(in, frames);
+        char *inScratch = mBlockScratch.data();
+        char *outScratch = mBlockScratch.data() + (size_t) mBlockFrames * mFrameSize;
+        while (mInReader.available() >= (ssize_t) mBlockFrames) {
+            (void) mInReader.read(inScratch, mBlockFrames);
+            mProcess(mCookie, inScratch, outScratch, mBlockFrames);
+            (void) mOutWriter.write(outScratch, mBlockFrames);
+        }
+        (void) mOutReader.read(out, frames);
+    }
+
+    // These fields are const after initialization
+    const uint32_t mBlockFrames;        // block size of the processing function in frames
+    const uint32_t mFrameSize;          // size of each frame in bytes
+    const uint32_t mMaxFrames;          // largest slice handed to processSlice()
+    const process_block_fn mProcess;    // fixed-block processing function
+    void * const mCookie;               // opaque value passed through to mProcess
+
+    bool mBuffered = false;             // false: aligned zero-copy path, true: FIFO path
+
+    std::vector<char> mInBuffer;        // backing store for mInFifo
+    std::vector<char> mOutBuffer;       // backing store for mOutFifo
+    std::vector<char> mBlockScratch;    // two contiguous blocks for the buffered path
+
+    audio_utils_fifo mInFifo;           // unprocessed residual frames
+    audio_utils_fifo mOutFifo;          // processed frames not yet handed out
+    audio_utils_fifo_writer mInWriter;
+    audio_utils_fifo_reader mInReader;
+    audio_utils_fifo_writer mOutWriter;
+    audio_utils_fifo_reader mOutReader;
+};
+
+}   // namespace android::audio_utils
+
+#endif  // !ANDROID_AUDIO_BLOCK_ADAPTER_H
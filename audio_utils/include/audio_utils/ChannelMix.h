@@ -16,6 +16,7 @@
 
 #pragma once
 #include "channels.h"
+#include <array>
 #include <math.h>
 
 namespace android::audio_utils::channels {
@@ -61,109 +62,35 @@ public:
             // Compute at what index each channel is: samples will be in the following order:
             //   FL  FR  FC    LFE   BL  BR  BC    SL  SR
             //
-            // Prior to API 32, use of downmix resulted in channels being scaled in half amplitude.
-            // We now use a compliant downmix matrix for 5.1 with the following standards:
-            // ITU-R 775-2, ATSC A/52, ETSI TS 101 154, IEC 14496-3, which is unity gain for the
-            // front left and front right channel contribution.
-            //
-            // For 7.1 to 5.1 we set equal contributions for the side and back channels
-            // which follow Dolby downmix recommendations.
-            //
-            // We add contributions from the LFE into the L and R channels
-            // at a weight of 0.5 (rather than the power preserving 0.707)
-            // which is to ensure that headphones can still experience LFE
-            // with lesser risk of speaker overload.
-            //
-            // Note: geometrically left and right channels contribute only to the corresponding
-            // left and right outputs respectively.  Geometrically center channels contribute
-            // to both left and right outputs, so they are scaled by 0.707 to preserve power.
-            //
-            //  (transfer matrix)
-            //   FL  FR  FC    LFE  BL  BR     BC  SL    SR
-            //   1.0     0.707 0.5  0.707      0.5 0.707
-            //       1.0 0.707 0.5       0.707 0.5       0.707
+            // The per-position coefficients are documented with
+            // stereoDownmixCoefficients(), which is also evaluated at compile
+            // time for the layouts given fast paths in processSwitch().
             int index = 0;
-            constexpr float COEF_25 = 0.2508909536f;
-            constexpr float COEF_35 = 0.3543928915f;
-            constexpr float COEF_36 = 0.3552343859f;
-            constexpr float COEF_61 = 0.6057043428f;
             for (unsigned tmp = inputChannelMask; tmp != 0; ++index) {
                 const unsigned lowestBit = tmp & -(signed)tmp;
-                switch (lowestBit) {
-                    case AUDIO_CHANNEL_OUT_FRONT_LEFT:
-                    case AUDIO_CHANNEL_OUT_TOP_FRONT_LEFT:
-                    case AUDIO_CHANNEL_OUT_BOTTOM_FRONT_LEFT:
-                        mMatrix[index][0] = 1.f;
-                        mMatrix[index][1] = 0.f;
-                        break;
-                    case AUDIO_CHANNEL_OUT_SIDE_LEFT:
-                    case AUDIO_CHANNEL_OUT_BACK_LEFT:
-                    case AUDIO_CHANNEL_OUT_TOP_BACK_LEFT:
-                    case AUDIO_CHANNEL_OUT_FRONT_WIDE_LEFT: // FRONT_WIDE closer to SIDE.
-                        mMatrix[index][0] = MINUS_3_DB_IN_FLOAT;
-                        mMatrix[index][1] = 0.f;
-                        break;
-                    case AUDIO_CHANNEL_OUT_FRONT_RIGHT:
-                    case AUDIO_CHANNEL_OUT_TOP_FRONT_RIGHT:
-                    case AUDIO_CHANNEL_OUT_BOTTOM_FRONT_RIGHT:
-                        mMatrix[index][0] = 0.f;
-                        mMatrix[index][1] = 1.f;
-                        break;
-                    case AUDIO_CHANNEL_OUT_SIDE_RIGHT:
-                    case AUDIO_CHANNEL_OUT_BACK_RIGHT:
-                    case AUDIO_CHANNEL_OUT_TOP_BACK_RIGHT:
-                    case AUDIO_CHANNEL_OUT_FRONT_WIDE_RIGHT: // FRONT_WIDE closer to SIDE.
-                        mMatrix[index][0] = 0.f;
-                        mMatrix[index][1] = MINUS_3_DB_IN_FLOAT;
-                        break;
-                    case AUDIO_CHANNEL_OUT_FRONT_CENTER:
-                    case AUDIO_CHANNEL_OUT_TOP_FRONT_CENTER:
-                    case AUDIO_CHANNEL_OUT_BOTTOM_FRONT_CENTER:
-                        mMatrix[index][0] = mMatrix[index][1] = MINUS_3_DB_IN_FLOAT;
-                        break;
-                    case AUDIO_CHANNEL_OUT_TOP_SIDE_LEFT:
-                        mMatrix[index][0] = COEF_61;
-                        mMatrix[index][1] = 0.f;
-                        break;
-                    case AUDIO_CHANNEL_OUT_TOP_SIDE_RIGHT:
-                        mMatrix[index][0] = 0.f;
-                        mMatrix[index][1] = COEF_61;
-                        break;
-                    case AUDIO_CHANNEL_OUT_FRONT_LEFT_OF_CENTER:
-                        mMatrix[index][0] = COEF_61;
-                        mMatrix[index][1] = COEF_25;
-                        break;
-                    case AUDIO_CHANNEL_OUT_FRONT_RIGHT_OF_CENTER:
-                        mMatrix[index][0] = COEF_25;
-                        mMatrix[index][1] = COEF_61;
-                        break;
-                    case AUDIO_CHANNEL_OUT_TOP_CENTER:
-                        mMatrix[index][0] = mMatrix[index][1] = COEF_36;
-                        break;
-                    case AUDIO_CHANNEL_OUT_TOP_BACK_CENTER:
-                        mMatrix[index][0] = mMatrix[index][1] = COEF_35;
-                        break;
-                    case AUDIO_CHANNEL_OUT_LOW_FREQUENCY_2:
-                        mMatrix[index][0] = 0.f;
-                        mMatrix[index][1] = MINUS_3_DB_IN_FLOAT;
-                        break;
-                    case AUDIO_CHANNEL_OUT_LOW_FREQUENCY:
-                        if (inputChannelMask & AUDIO_CHANNEL_OUT_LOW_FREQUENCY_2) {
-                            mMatrix[index][0] = MINUS_3_DB_IN_FLOAT;
-                            mMatrix[index][1] = 0.f;
-                            break;
-                        }
-                        FALLTHROUGH_INTENDED;
-                    case AUDIO_CHANNEL_OUT_BACK_CENTER:
-                        mMatrix[index][0] = mMatrix[index][1] = 0.5f;
-                        break;
-                }
+                stereoDownmixCoefficients(lowestBit, inputChannelMask, mMatrix[index]);
                 tmp ^= lowestBit;
             }
             mInputChannelMask = inputChannelMask;
             // Note: mLastValidChannelIndexPlusOne is the same as mInputChannelCount for
             // this particular matrix, as it has a nonzero column for every channel position.
             mInputChannelCount = mLastValidChannelIndexPlusOne = index;
+
+            // Sparse form of the matrix: per output channel, the nonzero input
+            // columns and their coefficients.  Purely left or right positions
+            // contribute to a single output, so this halves the multiplies of
+            // the general mixing loop.
+            for (size_t out = 0; out < mOutputChannelCount; ++out) {
+                size_t count = 0;
+                for (size_t i = 0; i < mInputChannelCount; ++i) {
+                    if (mMatrix[i][out] != 0.f) {
+                        mSparseIndex[out][count] = i;
+                        mSparseCoef[out][count] = mMatrix[i][out];
+                        ++count;
+                    }
+                }
+                mSparseCount[out] = count;
+            }
         }
         return true;
     }
@@ -216,6 +143,10 @@ private:
     // Keep alignment for matrix for more stable benchmarking.
     // Currently only stereo output supported.
     alignas(128) float mMatrix[MAX_INPUT_CHANNELS_SUPPORTED][FCC_2];
+    // Sparse form of mMatrix, rebuilt with it in setInputChannelMask().
+    alignas(128) float mSparseCoef[FCC_2][MAX_INPUT_CHANNELS_SUPPORTED]{};
+    uint8_t mSparseIndex[FCC_2][MAX_INPUT_CHANNELS_SUPPORTED]{};
+    size_t mSparseCount[FCC_2]{};
     audio_channel_mask_t mInputChannelMask = AUDIO_CHANNEL_NONE;
     size_t mLastValidChannelIndexPlusOne = 0;
     size_t mInputChannelCount = 0;
@@ -228,6 +159,136 @@ private:
         return fmin(fmax(value, -LIMIT_AMPLITUDE), LIMIT_AMPLITUDE);
     }
 
+    /**
+     * Computes the [left, right] downmix coefficients of one channel position.
+     *
+     * This is the single source of the downmix matrix: setInputChannelMask()
+     * evaluates it at runtime for arbitrary position masks, and
+     * makeStereoDownmixMatrix() evaluates it at compile time for the layouts
+     * given fast paths in processSwitch().
+     *
+     * Prior to API 32, use of downmix resulted in channels being scaled in half amplitude.
+     * We now use a compliant downmix matrix for 5.1 with the following standards:
+     * ITU-R 775-2, ATSC A/52, ETSI TS 101 154, IEC 14496-3, which is unity gain for the
+     * front left and front right channel contribution.
+     *
+     * For 7.1 to 5.1 we set equal contributions for the side and back channels
+     * which follow Dolby downmix recommendations.
+     *
+     * We add contributions from the LFE into the L and R channels
+     * at a weight of 0.5 (rather than the power preserving 0.707)
+     * which is to ensure that headphones can still experience LFE
+     * with lesser risk of speaker overload.
+     *
+     * Note: geometrically left and right channels contribute only to the corresponding
+     * left and right outputs respectively.  Geometrically center channels contribute
+     * to both left and right outputs, so they are scaled by 0.707 to preserve power.
+     *
+     *  (transfer matrix)
+     *   FL  FR  FC    LFE  BL  BR     BC  SL    SR
+     *   1.0     0.707 0.5  0.707      0.5 0.707
+     *       1.0 0.707 0.5       0.707 0.5       0.707
+     *
+     * \param position         a single bit of the channel position mask.
+     * \param inputChannelMask the entire mask, consulted as LOW_FREQUENCY
+     *                         pans left only when LOW_FREQUENCY_2 is present.
+     * \param coef             the [left, right] coefficients filled on return.
+     */
+    static constexpr void stereoDownmixCoefficients(
+            unsigned position, unsigned inputChannelMask, float coef[FCC_2]) {
+        constexpr float COEF_25 = 0.2508909536f;
+        constexpr float COEF_35 = 0.3543928915f;
+        constexpr float COEF_36 = 0.3552343859f;
+        constexpr float COEF_61 = 0.6057043428f;
+        switch (position) {
+            case AUDIO_CHANNEL_OUT_FRONT_LEFT:
+            case AUDIO_CHANNEL_OUT_TOP_FRONT_LEFT:
+            case AUDIO_CHANNEL_OUT_BOTTOM_FRONT_LEFT:
+                coef[0] = 1.f;
+                coef[1] = 0.f;
+                break;
+            case AUDIO_CHANNEL_OUT_SIDE_LEFT:
+            case AUDIO_CHANNEL_OUT_BACK_LEFT:
+            case AUDIO_CHANNEL_OUT_TOP_BACK_LEFT:
+            case AUDIO_CHANNEL_OUT_FRONT_WIDE_LEFT: // FRONT_WIDE closer to SIDE.
+                coef[0] = MINUS_3_DB_IN_FLOAT;
+                coef[1] = 0.f;
+                break;
+            case AUDIO_CHANNEL_OUT_FRONT_RIGHT:
+            case AUDIO_CHANNEL_OUT_TOP_FRONT_RIGHT:
+            case AUDIO_CHANNEL_OUT_BOTTOM_FRONT_RIGHT:
+                coef[0] = 0.f;
+                coef[1] = 1.f;
+                break;
+            case AUDIO_CHANNEL_OUT_SIDE_RIGHT:
+            case AUDIO_CHANNEL_OUT_BACK_RIGHT:
+            case AUDIO_CHANNEL_OUT_TOP_BACK_RIGHT:
+            case AUDIO_CHANNEL_OUT_FRONT_WIDE_RIGHT: // FRONT_WIDE closer to SIDE.
+                coef[0] = 0.f;
+                coef[1] = MINUS_3_DB_IN_FLOAT;
+                break;
+            case AUDIO_CHANNEL_OUT_FRONT_CENTER:
+            case AUDIO_CHANNEL_OUT_TOP_FRONT_CENTER:
+            case AUDIO_CHANNEL_OUT_BOTTOM_FRONT_CENTER:
+                coef[0] = coef[1] = MINUS_3_DB_IN_FLOAT;
+                break;
+            case AUDIO_CHANNEL_OUT_TOP_SIDE_LEFT:
+                coef[0] = COEF_61;
+                coef[1] = 0.f;
+                break;
+            case AUDIO_CHANNEL_OUT_TOP_SIDE_RIGHT:
+                coef[0] = 0.f;
+                coef[1] = COEF_61;
+                break;
+            case AUDIO_CHANNEL_OUT_FRONT_LEFT_OF_CENTER:
+                coef[0] = COEF_61;
+                coef[1] = COEF_25;
+                break;
+            case AUDIO_CHANNEL_OUT_FRONT_RIGHT_OF_CENTER:
+                coef[0] = COEF_25;
+                coef[1] = COEF_61;
+                break;
+            case AUDIO_CHANNEL_OUT_TOP_CENTER:
+                coef[0] = coef[1] = COEF_36;
+                break;
+            case AUDIO_CHANNEL_OUT_TOP_BACK_CENTER:
+                coef[0] = coef[1] = COEF_35;
+                break;
+            case AUDIO_CHANNEL_OUT_LOW_FREQUENCY_2:
+                coef[0] = 0.f;
+                coef[1] = MINUS_3_DB_IN_FLOAT;
+                break;
+            case AUDIO_CHANNEL_OUT_LOW_FREQUENCY:
+                if (inputChannelMask & AUDIO_CHANNEL_OUT_LOW_FREQUENCY_2) {
+                    coef[0] = MINUS_3_DB_IN_FLOAT;
+                    coef[1] = 0.f;
+                    break;
+                }
+                FALLTHROUGH_INTENDED;
+            case AUDIO_CHANNEL_OUT_BACK_CENTER:
+                coef[0] = coef[1] = 0.5f;
+                break;
+            default: // caller screens the mask, but constexpr evaluation must not read garbage.
+                coef[0] = coef[1] = 0.f;
+                break;
+        }
+    }
+
+    /**
+     * Generates the full stereo downmix matrix of MASK at compile time.
+     */
+    template <audio_channel_mask_t MASK>
+    static constexpr auto makeStereoDownmixMatrix() {
+        std::array<std::array<float, FCC_2>, __builtin_popcount(MASK)> matrix{};
+        size_t index = 0;
+        for (unsigned tmp = MASK; tmp != 0; ++index) {
+            const unsigned lowestBit = tmp & -(signed)tmp;
+            stereoDownmixCoefficients(lowestBit, MASK, matrix[index].data());
+            tmp ^= lowestBit;
+        }
+        return matrix;
+    }
+
     /**
      * Downmixes audio data in src to dst.
      *
@@ -253,6 +314,23 @@ private:
                 return specificProcess<6 /* CHANNEL_COUNT */, ACCUMULATE>(src, dst, frameCount);
             case AUDIO_CHANNEL_OUT_7POINT1:
                 return specificProcess<8 /* CHANNEL_COUNT */, ACCUMULATE>(src, dst, frameCount);
+            // The spatial layouts below go through matrices generated at
+            // compile time, skipping the sparse runtime indirection.
+            case AUDIO_CHANNEL_OUT_5POINT1POINT4:
+                return specificMatrixProcess<AUDIO_CHANNEL_OUT_5POINT1POINT4, ACCUMULATE>(
+                        src, dst, frameCount);
+            case AUDIO_CHANNEL_OUT_7POINT1POINT2:
+                return specificMatrixProcess<AUDIO_CHANNEL_OUT_7POINT1POINT2, ACCUMULATE>(
+                        src, dst, frameCount);
+            case AUDIO_CHANNEL_OUT_7POINT1POINT4:
+                return specificMatrixProcess<AUDIO_CHANNEL_OUT_7POINT1POINT4, ACCUMULATE>(
+                        src, dst, frameCount);
+            case AUDIO_CHANNEL_OUT_13POINT_360RA:
+                return specificMatrixProcess<AUDIO_CHANNEL_OUT_13POINT_360RA, ACCUMULATE>(
+                        src, dst, frameCount);
+            case AUDIO_CHANNEL_OUT_22POINT2:
+                return specificMatrixProcess<AUDIO_CHANNEL_OUT_22POINT2, ACCUMULATE>(
+                        src, dst, frameCount);
             default:
                 break; // handled below.
             }
@@ -273,27 +351,54 @@ private:
      * \return false if the CHANNEL_COUNT is not supported.
      */
     bool matrixProcess(const float *src, float *dst, size_t frameCount, bool accumulate) const {
-        // matrix multiply
+        // sparse matrix multiply over the precomputed nonzero columns,
+        // a block of frames at a time so each coefficient load is amortized
+        // over BLOCK independent accumulators the compiler can vectorize.
         if (mInputChannelMask == AUDIO_CHANNEL_NONE) return false;
-        while (frameCount) {
-            float ch[2]{}; // left, right
-            for (size_t i = 0; i < mLastValidChannelIndexPlusOne; ++i) {
-                ch[0] += mMatrix[i][0] * src[i];
-                ch[1] += mMatrix[i][1] * src[i];
-            }
-            if (accumulate) {
-                ch[0] += dst[0];
-                ch[1] += dst[1];
-            }
-            dst[0] = clamp(ch[0]);
-            dst[1] = clamp(ch[1]);
+        constexpr size_t BLOCK = 4; // frames per block
+        for (; frameCount >= BLOCK; frameCount -= BLOCK) {
+            sparseMix<BLOCK>(src, dst, accumulate);
+            src += mInputChannelCount * BLOCK;
+            dst += mOutputChannelCount * BLOCK;
+        }
+        for (; frameCount > 0; --frameCount) {
+            sparseMix<1>(src, dst, accumulate);
             src += mInputChannelCount;
             dst += mOutputChannelCount;
-            --frameCount;
         }
         return true;
     }
 
+    /**
+     * Mixes FRAMES frames through the sparse matrix form.
+     *
+     * The nonzero entries of an output channel are visited in ascending
+     * input index, so the result is bit-identical to the former dense loop
+     * (skipped terms are exact zeros).
+     */
+    template <size_t FRAMES>
+    void sparseMix(const float *src, float *dst, bool accumulate) const {
+        float ch[FRAMES][FCC_2]{};
+        for (size_t out = 0; out < mOutputChannelCount; ++out) {
+            for (size_t k = 0; k < mSparseCount[out]; ++k) {
+                const float coef = mSparseCoef[out][k];
+                const size_t index = mSparseIndex[out][k];
+                for (size_t frame = 0; frame < FRAMES; ++frame) {
+                    ch[frame][out] += coef * src[frame * mInputChannelCount + index];
+                }
+            }
+        }
+        for (size_t frame = 0; frame < FRAMES; ++frame) {
+            for (size_t out = 0; out < mOutputChannelCount; ++out) {
+                float value = ch[frame][out];
+                if (accumulate) {
+                    value += dst[frame * mOutputChannelCount + out];
+                }
+                dst[frame * mOutputChannelCount + out] = clamp(value);
+            }
+        }
+    }
+
     /**
      * Downmixes to stereo a multichannel signal of specified number of channels
      *
@@ -362,6 +467,47 @@ private:
         }
         return true;
     }
+
+    /**
+     * Downmixes to stereo through a compile-time generated mixing matrix.
+     *
+     * MASK is the input channel position mask, whose matrix comes from
+     * makeStereoDownmixMatrix().  The loop bounds and coefficients are
+     * compile-time constants, so after unrolling the zero coefficient terms
+     * vanish - the higher-order layouts get the dead column elimination of
+     * the sparse runtime path without its indirection.
+     * ACCUMULATE is true if the downmix is added to the destination or
+     *               false if the downmix replaces the destination.
+     *
+     * \param src          multichannel audio buffer to downmix
+     * \param dst          downmixed stereo audio samples
+     * \param frameCount   number of multichannel frames to downmix
+     *
+     * \return true, as the matrix exists for every positional MASK.
+     */
+    template <audio_channel_mask_t MASK, bool ACCUMULATE>
+    static bool specificMatrixProcess(const float *src, float *dst, size_t frameCount) {
+        constexpr size_t CHANNEL_COUNT = __builtin_popcount(MASK);
+        constexpr auto matrix = makeStereoDownmixMatrix<MASK>();
+        while (frameCount > 0) {
+            float ch[FCC_2]{};
+            for (size_t i = 0; i < CHANNEL_COUNT; ++i) {
+                if (matrix[i][0] != 0.f) ch[0] += matrix[i][0] * src[i];
+                if (matrix[i][1] != 0.f) ch[1] += matrix[i][1] * src[i];
+            }
+            if constexpr (ACCUMULATE) {
+                dst[0] = clamp(dst[0] + ch[0]);
+                dst[1] = clamp(dst[1] + ch[1]);
+            } else {
+                dst[0] = clamp(ch[0]);
+                dst[1] = clamp(ch[1]);
+            }
+            src += CHANNEL_COUNT;
+            dst += mOutputChannelCount;
+            --frameCount;
+        }
+        return true;
+    }
 };
 
 } // android::audio_utils::channels
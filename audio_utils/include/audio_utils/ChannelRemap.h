@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string.h>
+
+#include "channels.h"
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace android::audio_utils::channels {
+
+/**
+ * ChannelRemap
+ *
+ * Converts interleaved audio between two positional channel masks by position:
+ * an output channel takes the input channel at the same position, or silence
+ * if the input mask does not contain that position.  Unlike adjust_channels(),
+ * which can only add or drop channels at the end of the frame, the mapping is
+ * compiled once from the (input mask, output mask, sample size) triple, so a
+ * stream pays the dispatch cost at configuration time rather than per buffer.
+ *
+ * On AArch64, when the output frame fits a vector register and the input
+ * frame fits a three register table, each output frame is produced by a
+ * single byte permute (silent channels come from the permute's out of range
+ * zeroing); other shapes use a cached per-sample program.
+ *
+ * The input and output buffers must either be completely separate, or start
+ * at the same address for in-place conversion (the permute path is bypassed
+ * in-place); partially overlapping buffers are not supported.
+ */
+class ChannelRemap {
+public:
+    /** maximum channels supported per mask, as for ChannelMix. */
+    static constexpr size_t kMaxChannels = FCC_26;
+
+    /**
+     * Creates a ChannelRemap object.
+     *
+     * Note: if construction is unsuccessful then getInputChannelMask will
+     * return AUDIO_CHANNEL_NONE.
+     *
+     * \param inputChannelMask  positional channel mask of the input data.
+     * \param outputChannelMask positional channel mask of the output data.
+     * \param sampleSize        bytes per sample, 1, 2, 3, or 4.
+     */
+    ChannelRemap(audio_channel_mask_t inputChannelMask,
+            audio_channel_mask_t outputChannelMask, size_t sampleSize) {
+        setRemap(inputChannelMask, outputChannelMask, sampleSize);
+    }
+
+    ChannelRemap() = default;
+
+    /**
+     * Compiles the remap program for a new configuration.
+     *
+     * \return false if a mask is not positional, has more than kMaxChannels
+     *         channels, or the sample size is unsupported.
+     */
+    bool setRemap(audio_channel_mask_t inputChannelMask,
+            audio_channel_mask_t outputChannelMask, size_t sampleSize) {
+        mInputChannelMask = AUDIO_CHANNEL_NONE;
+        mOutputChannelMask = AUDIO_CHANNEL_NONE;
+        if (audio_channel_mask_get_representation(inputChannelMask)
+                        != AUDIO_CHANNEL_REPRESENTATION_POSITION
+                || audio_channel_mask_get_representation(outputChannelMask)
+                        != AUDIO_CHANNEL_REPRESENTATION_POSITION
+                || sampleSize < 1 || sampleSize > 4) {
+            return false;
+        }
+        const uint32_t inBits = audio_channel_mask_get_bits(inputChannelMask);
+        const uint32_t outBits = audio_channel_mask_get_bits(outputChannelMask);
+        const size_t inChannels = __builtin_popcount(inBits);
+        const size_t outChannels = __builtin_popcount(outBits);
+        if (inChannels == 0 || inChannels > kMaxChannels
+                || outChannels == 0 || outChannels > kMaxChannels) {
+            return false;
+        }
+
+        // samples are interleaved in ascending mask bit order, so the input
+        // index of a position is the popcount of the mask bits below it.
+        size_t dst = 0;
+        for (uint32_t bits = outBits; bits != 0; bits &= bits - 1) {
+            const uint32_t bit = __builtin_ctz(bits);
+            mMap[dst++] = (inBits >> bit) & 1
+                    ? (int8_t)__builtin_popcount(inBits & ((1u << bit) - 1))
+                    : -1;
+        }
+
+        mInputChannelMask = inputChannelMask;
+        mOutputChannelMask = outputChannelMask;
+        mInputChannelCount = inChannels;
+        mOutputChannelCount = outChannels;
+        mSampleSize = sampleSize;
+#if defined(__aarch64__)
+        // byte indices into a 48 byte input window; 0xFF is out of table
+        // range so the permute delivers the silence for missing channels.
+        const size_t inFrameSize = inChannels * sampleSize;
+        const size_t outFrameSize = outChannels * sampleSize;
+        mUsePermute = inFrameSize <= 3 * sizeof(uint8x16_t)
+                && outFrameSize <= sizeof(uint8x16_t);
+        if (mUsePermute) {
+            for (size_t j = 0; j < sizeof(mShuffle); ++j) {
+                const size_t sample = j / sampleSize;
+                uint8_t index = 0xFF;
+                if (sample < outChannels && mMap[sample] >= 0) {
+                    index = mMap[sample] * sampleSize + j % sampleSize;
+                }
+                mShuffle[j] = index;
+            }
+        }
+#endif
+        return true;
+    }
+
+    audio_channel_mask_t getInputChannelMask() const { return mInputChannelMask; }
+    audio_channel_mask_t getOutputChannelMask() const { return mOutputChannelMask; }
+
+    /**
+     * Remaps audio data from the input to the output channel configuration.
+     *
+     * \param input     interleaved input frames.
+     * \param output    interleaved output frames.
+     * \param frameCount frames to convert.
+     *
+     * \return the number of output bytes generated.
+     */
+    size_t process(const void *input, void *output, size_t frameCount) const {
+        const uint8_t *in = (const uint8_t *)input;
+        uint8_t *out = (uint8_t *)output;
+        const size_t inFrameSize = mInputChannelCount * mSampleSize;
+        const size_t outFrameSize = mOutputChannelCount * mSampleSize;
+        size_t frame = 0;
+
+#if defined(__aarch64__)
+        // Each permuted store writes a full register and each table load
+        // reads a full window, so the frames near the end of the buffer
+        // (and in-place conversions) take the scalar path instead.
+        if (mUsePermute && input != output) {
+            const size_t loadGuard =
+                    (3 * sizeof(uint8x16_t) + inFrameSize - 1) / inFrameSize;
+            const size_t storeGuard =
+                    (sizeof(uint8x16_t) + outFrameSize - 1) / outFrameSize;
+            const size_t guard = loadGuard > storeGuard ? loadGuard : storeGuard;
+            if (frameCount > guard) {
+                const uint8x16_t shuffle = vld1q_u8(mShuffle);
+                for (; frame < frameCount - guard; ++frame) {
+                    const uint8_t *src = in + frame * inFrameSize;
+                    uint8x16x3_t window;
+                    window.val[0] = vld1q_u8(src);
+                    window.val[1] = vld1q_u8(src + 16);
+                    window.val[2] = vld1q_u8(src + 32);
+                    vst1q_u8(out + frame * outFrameSize,
+                            vqtbl3q_u8(window, shuffle));
+                }
+            }
+        }
+#endif
+        // In-place expansion must run back to front so no input frame is
+        // overwritten before it is read; the frame staging buffer makes the
+        // sample moves within a frame order-independent.
+        const bool backwards = in == out && outFrameSize > inFrameSize;
+        for (size_t i = frame; i < frameCount; ++i) {
+            const size_t f = backwards ? frameCount - 1 - (i - frame) : i;
+            uint8_t staged[kMaxChannels * 4];
+            memcpy(staged, in + f * inFrameSize, inFrameSize);
+            uint8_t *dst = out + f * outFrameSize;
+            for (size_t ch = 0; ch < mOutputChannelCount; ++ch) {
+                if (mMap[ch] < 0) {
+                    memset(dst + ch * mSampleSize, 0, mSampleSize);
+                } else {
+                    memcpy(dst + ch * mSampleSize,
+                            staged + mMap[ch] * mSampleSize, mSampleSize);
+                }
+            }
+        }
+        return frameCount * outFrameSize;
+    }
+
+private:
+    audio_channel_mask_t mInputChannelMask = AUDIO_CHANNEL_NONE;
+    audio_channel_mask_t mOutputChannelMask = AUDIO_CHANNEL_NONE;
+    size_t mInputChannelCount = 0;
+    size_t mOutputChannelCount = 0;
+    size_t mSampleSize = 0;
+    int8_t mMap[kMaxChannels]{};  // output sample -> input channel, -1 silence
+#if defined(__aarch64__)
+    bool mUsePermute = false;
+    uint8_t mShuffle[16]{};
+#endif
+};
+
+} // namespace android::audio_utils::channels
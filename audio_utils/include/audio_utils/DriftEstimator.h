@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_UTILS_DRIFT_ESTIMATOR_H
+#define ANDROID_AUDIO_UTILS_DRIFT_ESTIMATOR_H
+
+#include <algorithm>
+#include <array>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace android::audio_utils {
+
+/**
+ * DriftEstimator - windowed least-squares clock drift between two timebases.
+ *
+ * Estimates the rate and offset between a local clock (e.g. CLOCK_MONOTONIC)
+ * and a remote clock (e.g. a DSP wallclock) from a sliding window of
+ * (local, remote) timestamp pairs.
+ *
+ * A ring buffer holds the last capacity pairs and the regression is kept as
+ * running sums: add() subtracts the contribution of the evicted pair and adds
+ * the new one, so both the update and the drift query are O(1) - no per-query
+ * pass over the history as with re-fitting the pairs each time.  The sums are
+ * rebuilt from the ring once per window of evictions to shed accumulated
+ * floating point rounding, which keeps add() amortized O(1).
+ *
+ * Timestamps are taken as int64_t nanoseconds and accumulated as seconds
+ * relative to the first pair of the window, so the double precision sums
+ * retain accuracy regardless of the absolute clock values.
+ *
+ * Unlike LinearMap, which tracks a piecewise linear correspondence for
+ * position-to-time lookup, this class assumes a single underlying rate over
+ * the window and reports how far it is from nominal (getDriftPpm()) together
+ * with the fit quality (getR2()), following the least-squares formulation of
+ * Statistics.h (computeYLineFromStatistics()).
+ *
+ * The caller must provide thread safety (typically the timestamps arrive on
+ * one thread).
+ */
+class DriftEstimator {
+public:
+    /** \brief Default number of timestamp pairs kept in the window. */
+    static constexpr size_t kDefaultCapacity = 64;
+
+    /**
+     * \brief Creates a DriftEstimator.
+     *
+     * \param capacity number of (local, remote) pairs in the window,
+     *                 at least 2.
+     */
+    explicit DriftEstimator(size_t capacity = kDefaultCapacity)
+        : mCapacity(std::max(capacity, (size_t)2))
+        , mPairs(mCapacity) { }
+
+    /**
+     * \brief Adds a (local, remote) timestamp pair, evicting the oldest
+     *        pair once the window is full.  Amortized O(1).
+     *
+     * \param localNs  local clock timestamp in nanoseconds.
+     * \param remoteNs remote clock timestamp in nanoseconds.
+     */
+    void add(int64_t localNs, int64_t remoteNs) {
+        if (mCount == 0) {
+            // accumulate relative to the first pair for precision.
+            mOriginLocal = localNs;
+            mOriginRemote = remoteNs;
+        }
+        if (mCount == mCapacity) {
+            if (++mEvictions >= mCapacity) {
+                // periodically rebuild to shed accumulated rounding;
+                // once per window keeps add() amortized O(1).
+                mPairs[mHead] = { localNs, remoteNs };
+                mHead = (mHead + 1) % mCapacity;
+                rebuild();
+                mEvictions = 0;
+                return;
+            }
+            remove(mPairs[mHead]);
+        } else {
+            ++mCount;
+        }
+        mPairs[mHead] = { localNs, remoteNs };
+        mHead = (mHead + 1) % mCapacity;
+        accumulate(localNs, remoteNs, 1.);
+    }
+
+    /** \brief Clears the window. */
+    void reset() {
+        mCount = 0;
+        mHead = 0;
+        mEvictions = 0;
+        mSumX = mSumY = mSumXX = mSumXY = mSumYY = 0.;
+    }
+
+    /** \brief Returns the number of pairs in the window. */
+    size_t getSampleCount() const {
+        return mCount;
+    }
+
+    /**
+     * \brief Returns whether a drift estimate is available.
+     *
+     * At least two pairs with distinct local timestamps are required.
+     */
+    bool isValid() const {
+        return mCount >= 2 && getVarX() > 0.;
+    }
+
+    /**
+     * \brief Returns the remote rate relative to the local clock,
+     *        d(remote) / d(local); 1.0 means no drift.
+     *
+     * Call only when isValid().
+     */
+    double getSlope() const {
+        return getCovXY() / getVarX();
+    }
+
+    /**
+     * \brief Returns the drift of the remote clock against the local clock
+     *        in parts per million; positive means the remote runs fast.
+     *
+     * Call only when isValid().
+     */
+    double getDriftPpm() const {
+        return (getSlope() - 1.) * 1e6;
+    }
+
+    /**
+     * \brief Returns the confidence of the fit as the correlation
+     *        coefficient r2 in [0, 1]; 1.0 means the pairs lie on a line
+     *        (see computeYLineFromStatistics()).
+     *
+     * Call only when isValid().  A noisy or quantized remote clock lowers
+     * r2; gate rate corrections on it before trusting getDriftPpm().
+     */
+    double getR2() const {
+        const double varY = getVarY();
+        if (varY == 0.) return 1.;  // exact fit: remote advanced uniformly.
+        const double covXY = getCovXY();
+        return covXY * covXY / (getVarX() * varY);
+    }
+
+    /**
+     * \brief Maps a local clock timestamp to the remote timebase using the
+     *        fitted line (which passes through the window means).
+     *
+     * Call only when isValid().
+     */
+    int64_t localToRemote(int64_t localNs) const {
+        const double x = (localNs - mOriginLocal) * kNsToS;
+        const double y = getMeanY() + getSlope() * (x - getMeanX());
+        return mOriginRemote + (int64_t)(y * kSToNs);
+    }
+
+    /**
+     * \brief Maps a remote clock timestamp to the local timebase,
+     *        the inverse fit of localToRemote().
+     *
+     * Call only when isValid().
+     */
+    int64_t remoteToLocal(int64_t remoteNs) const {
+        const double y = (remoteNs - mOriginRemote) * kNsToS;
+        const double x = getMeanX() + (y - getMeanY()) * getVarX() / getCovXY();
+        return mOriginLocal + (int64_t)(x * kSToNs);
+    }
+
+    /** \brief Returns a string representation suitable for logging. */
+    std::string toString() const {
+        std::stringstream ss;
+        ss << "DriftEstimator: samples " << mCount << "/" << mCapacity;
+        if (isValid()) {
+            ss << " drift(ppm) " << getDriftPpm() << " r2 " << getR2();
+        } else {
+            ss << " (no estimate)";
+        }
+        return ss.str();
+    }
+
+private:
+    static constexpr double kNsToS = 1e-9;
+    static constexpr double kSToNs = 1e9;
+
+    // Running sums of the window, in seconds relative to the origin pair.
+    double getMeanX() const { return mSumX / mCount; }
+    double getMeanY() const { return mSumY / mCount; }
+    double getVarX() const { return mSumXX / mCount - getMeanX() * getMeanX(); }
+    double getVarY() const { return mSumYY / mCount - getMeanY() * getMeanY(); }
+    double getCovXY() const { return mSumXY / mCount - getMeanX() * getMeanY(); }
+
+    void accumulate(int64_t localNs, int64_t remoteNs, double sign) {
+        const double x = (localNs - mOriginLocal) * kNsToS;
+        const double y = (remoteNs - mOriginRemote) * kNsToS;
+        mSumX += sign * x;
+        mSumY += sign * y;
+        mSumXX += sign * x * x;
+        mSumXY += sign * x * y;
+        mSumYY += sign * y * y;
+    }
+
+    void remove(const std::array<int64_t, 2>& pair) {
+        accumulate(pair[0], pair[1], -1.);
+    }
+
+    // Recomputes the sums from the ring, rebasing the origin on the oldest
+    // pair of the window so the accumulated offsets stay small.
+    void rebuild() {
+        mSumX = mSumY = mSumXX = mSumXY = mSumYY = 0.;
+        const size_t oldest = mCount == mCapacity ? mHead : 0;
+        mOriginLocal = mPairs[oldest][0];
+        mOriginRemote = mPairs[oldest][1];
+        for (size_t i = 0; i < mCount; ++i) {
+            const auto& pair = mPairs[(oldest + i) % mCapacity];
+            accumulate(pair[0], pair[1], 1.);
+        }
+    }
+
+    const size_t mCapacity;
+    std::vector<std::array<int64_t, 2>> mPairs;  // ring of (local, remote) ns.
+    size_t mHead = 0;       // next slot to write.
+    size_t mCount = 0;      // pairs in the window.
+    size_t mEvictions = 0;  // evictions since the last rebuild().
+
+    int64_t mOriginLocal = 0;   // origin of the x offsets, ns.
+    int64_t mOriginRemote = 0;  // origin of the y offsets, ns.
+    double mSumX = 0.;
+    double mSumY = 0.;
+    double mSumXX = 0.;
+    double mSumXY = 0.;
+    double mSumYY = 0.;
+};
+
+} // namespace android::audio_utils
+
+#endif // !ANDROID_AUDIO_UTILS_DRIFT_ESTIMATOR_H
@@ -19,15 +19,17 @@
 
 #ifdef __cplusplus
 
-#include <iomanip>
+#include <algorithm>
+#include <atomic>
 #include <mutex>
-#include <sstream>
+#include <string>
 #include <unistd.h>
 #include <vector>
 
 #include <sys/cdefs.h>
 
 #include <audio_utils/clock.h>
+#include <audio_utils/string.h>
 #include <utils/Errors.h>
 
 namespace android {
@@ -101,43 +103,40 @@ public:
     {
         std::lock_guard<std::mutex> guard(mLock);
 
-        std::stringstream ss;
         const size_t numberOfEntries = mEntries.size();
         const size_t headerLines = 2;
 
         if (lines == 0) {
             lines = SIZE_MAX;
         }
-        ss << prefix << "Errors: " << mErrors << "\n";
+        // fixed-capacity writer: a dump during bugreport collection must not
+        // reallocate while audio threads are running.
+        lines = std::min(lines, headerLines + numberOfEntries);
+        audio_utils::dump_buffer<> buf(lines * (strlen(prefix) + kMaxDumpLineLength));
+        buf.appendf("%sErrors: %lld\n", prefix, (long long)mErrors);
 
         if (mErrors == 0 || lines <= headerLines) {
-            return ss.str();
+            return {buf.c_str(), buf.size()};
         }
 
         lines = std::min(lines - headerLines, numberOfEntries);
-        // compute where to start dump log
-        ssize_t offset;
-        for (offset = 0; offset < (ssize_t)lines; ++offset) {
-            const auto &entry =
-                    mEntries[(mIdx + numberOfEntries - offset) % numberOfEntries];
-            if (entry.mCount == 0 || entry.mLastTime < limitNs) {
-                break;
-            }
-        }
+        // compute where to start dump log; entries are time ordered so the
+        // cutoff is found by binary search rather than a scan.
+        ssize_t offset = (ssize_t)std::min(lines, countRecentLocked(limitNs));
         if (offset > 0) {
             offset--;
-            ss << prefix << " Code  Freq          First time           Last time\n";
+            buf.appendf("%s Code  Freq          First time           Last time\n", prefix);
             for (; offset >= 0; --offset) {
                 const auto &entry =
                         mEntries[(mIdx + numberOfEntries - offset) % numberOfEntries];
 
-                ss << prefix << std::setw(5) <<  entry.mCode
-                        << " " << std::setw(5) << entry.mCount
-                        << "  " << audio_utils_time_string_from_ns(entry.mFirstTime).time
-                        << "  " << audio_utils_time_string_from_ns(entry.mLastTime).time << "\n";
+                buf.appendf("%s%5lld %5u  %s  %s\n", prefix,
+                        (long long)entry.mCode, entry.mCount,
+                        audio_utils_time_string_from_ns(entry.mFirstTime).time,
+                        audio_utils_time_string_from_ns(entry.mLastTime).time);
             }
         }
-        return ss.str();
+        return {buf.c_str(), buf.size()};
     }
 
     /**
@@ -183,7 +182,76 @@ public:
         int64_t mLastTime;  // last time of the error code.
     };
 
+    /**
+     * \brief Copies the entries overlapping the time window [startNs, endNs].
+     *
+     * Entries are time ordered (log() times are expected to be monotonic),
+     * so the window bounds are located by binary search rather than a full
+     * scan, and no string formatting is performed.  Intended for triage
+     * tooling querying incident windows from large logs.
+     *
+     * \param startNs           include entries with last time >= startNs.
+     * \param endNs             include entries with first time <= endNs.
+     * \return the matching entries, ordered oldest first.
+     */
+    std::vector<Entry> copyEntries(int64_t startNs = 0, int64_t endNs = INT64_MAX) const
+    {
+        std::lock_guard<std::mutex> guard(mLock);
+
+        // backward logical index k: entryAt(0) is the newest entry.
+        // Unused entries (mCount == 0) follow the valid ones, and both
+        // mLastTime and mFirstTime are nonincreasing in k, so each bound
+        // below is a monotonic predicate.
+        const size_t kOld = firstEntryLocked([&](const Entry &entry) {
+            return entry.mCount == 0 || entry.mLastTime < startNs;
+        });
+        size_t kNew = firstEntryLocked([&](const Entry &entry) {
+            return entry.mFirstTime <= endNs;
+        });
+
+        std::vector<Entry> result;
+        if (kNew < kOld) {
+            const size_t numberOfEntries = mEntries.size();
+            result.reserve(kOld - kNew);
+            for (size_t k = kOld; k-- > kNew; ) {
+                result.push_back(mEntries[(mIdx + numberOfEntries - k) % numberOfEntries]);
+            }
+        }
+        return result;
+    }
+
 private:
+    // Binary search (REQUIRES mLock): returns the smallest backward logical
+    // index k in [0, size] for which pred(entry(k)) holds, where entry(0) is
+    // the newest entry; pred must be monotonic going backward in time.
+    template <typename P>
+    size_t firstEntryLocked(P pred) const
+    {
+        const size_t numberOfEntries = mEntries.size();
+        size_t lo = 0, hi = numberOfEntries;
+        while (lo < hi) {
+            const size_t mid = (lo + hi) / 2;
+            if (pred(mEntries[(mIdx + numberOfEntries - mid) % numberOfEntries])) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+        return lo;
+    }
+
+    // REQUIRES mLock: the count of newest entries in use with
+    // mLastTime >= limitNs.
+    size_t countRecentLocked(int64_t limitNs) const
+    {
+        return firstEntryLocked([=](const Entry &entry) {
+            return entry.mCount == 0 || entry.mLastTime < limitNs;
+        });
+    }
+
+    // generous bound on one dump line, excluding the caller's prefix
+    static constexpr size_t kMaxDumpLineLength = 96;
+
     mutable std::mutex mLock;     // monitor mutex
     int64_t mErrors;              // total number of errors registered
     size_t mIdx;                  // current index into mEntries (active)
@@ -191,6 +259,238 @@ private:
     std::vector<Entry> mEntries;  // circular buffer of error entries.
 };
 
+/**
+ * WaitFreeErrorLog is an ErrorLog variant safe for SCHED_FIFO (real-time)
+ * threads: Writer::log() never takes a lock, allocates, or otherwise blocks,
+ * so logging cannot priority-invert against a dump in progress.
+ *
+ * Each writer owns a preallocated ring, entries carry a global sequence
+ * number, and the rings are merged in logging order only at dump time.
+ * Obtain one Writer per logging thread with createWriter() during setup
+ * (createWriter() itself is lock-free but not intended for the hot path).
+ * As with ErrorLog, consecutive identical error codes within aggregateNs
+ * from the same writer are combined into a single entry.
+ *
+ * Entries are protected by a per-entry sequence word acting as a seqlock:
+ * the dumping thread retries or skips entries the writer is updating, and
+ * never delays the writer.
+ */
+template <typename T>
+class WaitFreeErrorLog {
+private:
+    struct Entry {
+        // 0 means unused, kBusy means the writer is updating, otherwise the
+        // global logging order of the entry (a seqlock validity check).
+        std::atomic<uint64_t> mSequence{0};
+        T mCode;            // error code
+        uint32_t mCount;    // number of consecutive errors of the same code.
+        int64_t mFirstTime; // first time of the error code.
+        int64_t mLastTime;  // last time of the error code.
+    };
+
+    static constexpr uint64_t kBusy = UINT64_MAX;
+    static constexpr int kMaxReadRetries = 3;
+    // generous bound on one dump line, excluding the caller's prefix
+    static constexpr size_t kMaxDumpLineLength = 96;
+
+public:
+    class Writer;
+
+    /**
+     * \brief Creates a WaitFreeErrorLog object
+     *
+     * \param entriesPerWriter  the length of error history for each writer.
+     * \param maxWriters        the number of writers preallocated.
+     * \param aggregateNs       the maximum time in nanoseconds between identical error codes
+     *                          to be aggregated into a single entry.
+     */
+    WaitFreeErrorLog(size_t entriesPerWriter, size_t maxWriters,
+            int64_t aggregateNs = 1000000000 /* one second */)
+        : mAggregateNs(aggregateNs)
+        , mWriters(maxWriters)
+    {
+        for (auto &writer : mWriters) {
+            writer.mLog = this;
+            writer.mEntries = std::vector<Entry>(entriesPerWriter);
+        }
+    }
+
+    /**
+     * \brief Assigns a preallocated writer, typically one per logging thread.
+     *
+     * Lock-free, but intended for thread setup rather than the hot path.
+     *
+     * \return the writer, or nullptr if maxWriters are already assigned.
+     */
+    Writer *createWriter()
+    {
+        const size_t idx = mNumWriters.fetch_add(1, std::memory_order_relaxed);
+        return idx < mWriters.size() ? &mWriters[idx] : nullptr;
+    }
+
+    class Writer {
+        friend class WaitFreeErrorLog<T>;
+    public:
+        /**
+         * \brief Adds new error code to this writer's ring; wait-free.
+         *
+         * A writer must be used by a single thread at a time.
+         *
+         * \param code              error code of type T.
+         * \param nowNs             current time in nanoseconds.
+         */
+        void log(const T &code, int64_t nowNs)
+        {
+            mLog->mErrors.fetch_add(1, std::memory_order_relaxed);
+
+            // Within mAggregateNs (1 second by default), aggregate error codes together.
+            // The writer-owned shadow fields avoid reading back through the ring.
+            if (mValid && code == mCode && nowNs - mLastTime < mLog->mAggregateNs) {
+                Entry &entry = mEntries[mIdx];
+                const uint64_t sequence = entry.mSequence.load(std::memory_order_relaxed);
+                entry.mSequence.store(kBusy, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                ++entry.mCount;
+                entry.mLastTime = nowNs;
+                std::atomic_thread_fence(std::memory_order_release);
+                entry.mSequence.store(sequence, std::memory_order_release);
+                mLastTime = nowNs;
+                return;
+            }
+
+            // Add new error entry.
+            if (mValid && ++mIdx >= mEntries.size()) {
+                mIdx = 0;
+            }
+            Entry &entry = mEntries[mIdx];
+            entry.mSequence.store(kBusy, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            entry.mCode = code;
+            entry.mCount = 1;
+            entry.mFirstTime = nowNs;
+            entry.mLastTime = nowNs;
+            std::atomic_thread_fence(std::memory_order_release);
+            entry.mSequence.store(
+                    mLog->mNextSequence.fetch_add(1, std::memory_order_relaxed),
+                    std::memory_order_release);
+            mValid = true;
+            mCode = code;
+            mLastTime = nowNs;
+        }
+
+    private:
+        WaitFreeErrorLog<T> *mLog = nullptr;
+        std::vector<Entry> mEntries;  // ring, written only by the owning thread.
+        size_t mIdx = 0;              // current index into mEntries (active)
+        bool mValid = false;          // true once the first entry is written.
+        T mCode{};                    // shadow copy of the active entry code.
+        int64_t mLastTime = 0;        // shadow copy of the active entry last time.
+    };
+
+    /**
+     * \brief Dumps the merged log to a std::string.
+     *
+     * Entries from all writers are merged in logging (sequence) order.
+     * Entries being updated concurrently may be skipped; the writers are
+     * never delayed.
+     *
+     * \param prefix            the prefix to use for each line
+     *                          (generally a null terminated string of spaces).
+     * \param lines             maximum number of lines to output (0 disables).
+     * \param limitNs           limit dump to data more recent than limitNs (0 disables).
+     * \return std::string of the dump.
+     */
+    std::string dumpToString(const char *prefix = "", size_t lines = 0, int64_t limitNs = 0) const
+    {
+        struct Snapshot {
+            uint64_t mSequence;
+            T mCode;
+            uint32_t mCount;
+            int64_t mFirstTime;
+            int64_t mLastTime;
+        };
+        std::vector<Snapshot> snapshots;
+        for (const auto &writer : mWriters) {
+            for (const auto &entry : writer.mEntries) {
+                for (int retry = 0; retry < kMaxReadRetries; ++retry) {
+                    const uint64_t sequence = entry.mSequence.load(std::memory_order_acquire);
+                    if (sequence == 0) {
+                        break; // unused
+                    }
+                    if (sequence == kBusy) {
+                        continue; // writer mid-update
+                    }
+                    const Snapshot snapshot{sequence, entry.mCode, entry.mCount,
+                            entry.mFirstTime, entry.mLastTime};
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (entry.mSequence.load(std::memory_order_relaxed) == sequence) {
+                        if (snapshot.mLastTime >= limitNs) {
+                            snapshots.push_back(snapshot);
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+        std::sort(snapshots.begin(), snapshots.end(),
+                [](const Snapshot &lhs, const Snapshot &rhs) {
+                    return lhs.mSequence < rhs.mSequence;
+                });
+
+        const size_t headerLines = 2;
+        if (lines == 0) {
+            lines = SIZE_MAX;
+        }
+        // fixed-capacity writer, sized once; see ErrorLog::dumpToString()
+        lines = std::min(lines, headerLines + snapshots.size());
+        audio_utils::dump_buffer<> buf(lines * (strlen(prefix) + kMaxDumpLineLength));
+        buf.appendf("%sErrors: %lld\n", prefix,
+                (long long)mErrors.load(std::memory_order_relaxed));
+        if (snapshots.empty() || lines <= headerLines) {
+            return {buf.c_str(), buf.size()};
+        }
+        size_t offset = 0;
+        if (snapshots.size() > lines - headerLines) {
+            offset = snapshots.size() - (lines - headerLines);
+        }
+        buf.appendf("%s Code  Freq          First time           Last time\n", prefix);
+        for (; offset < snapshots.size(); ++offset) {
+            const auto &snapshot = snapshots[offset];
+            buf.appendf("%s%5lld %5u  %s  %s\n", prefix,
+                    (long long)snapshot.mCode, snapshot.mCount,
+                    audio_utils_time_string_from_ns(snapshot.mFirstTime).time,
+                    audio_utils_time_string_from_ns(snapshot.mLastTime).time);
+        }
+        return {buf.c_str(), buf.size()};
+    }
+
+    /**
+     * \brief Dumps the merged log to a raw file descriptor.
+     * \param fd                file descriptor to use.
+     * \param prefix            the prefix to use for each line
+     *                          (generally a null terminated string of spaces).
+     * \param lines             maximum number of lines to output (0 disables).
+     * \param limitNs           limit dump to data more recent than limitNs (0 disables).
+     * \return
+     *   NO_ERROR on success or a negative number (-errno) on failure of write().
+     */
+    status_t dump(int fd, const char *prefix = "", size_t lines = 0, int64_t limitNs = 0) const
+    {
+        const std::string s = dumpToString(prefix, lines, limitNs);
+        if (s.size() > 0 && write(fd, s.c_str(), s.size()) < 0) {
+            return -errno;
+        }
+        return NO_ERROR;
+    }
+
+private:
+    const int64_t mAggregateNs;   // number of nanoseconds to aggregate consecutive error codes.
+    std::atomic<int64_t> mErrors{0};        // total number of errors registered.
+    std::atomic<uint64_t> mNextSequence{1}; // logging order of the next new entry.
+    std::atomic<size_t> mNumWriters{0};     // writers assigned by createWriter().
+    std::vector<Writer> mWriters;           // preallocated per-thread rings.
+};
+
 } // namespace android
 
 #endif // __cplusplus
@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_EVENT_JOURNAL_H
+#define ANDROID_AUDIO_EVENT_JOURNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+
+#include <audio_utils/fifo.h>
+#include <audio_utils/fifo_shm.h>
+
+namespace android::audio_utils {
+
+/**
+ * A cross-process timestamped event journal.
+ *
+ * Debugging latency across process boundaries (app, audioserver, HAL) means
+ * merging several differently-formatted logs by hand.  The journal replaces
+ * that with fixed-size binary records stamped from the one clock every
+ * process shares, CLOCK_MONOTONIC, so records from different processes merge
+ * by simple timestamp comparison.
+ *
+ * Each writing process owns one journal: a shared-memory ring of records
+ * (audio_utils_fifo via audio_utils_fifo_shm) with a single lock-free,
+ * non-blocking writer.  log() is a clock_gettime, a 32-byte copy and a
+ * store-release - safe from a SCHED_FIFO thread.  The writer is not
+ * throttled: when the ring wraps, the oldest records are lost and the
+ * reader reports how many.
+ *
+ * The observing process receives each journal's file descriptor (over a
+ * socket, binder, or inherited on fork), attaches an EventJournalReader per
+ * journal, and either polls records programmatically or calls
+ * dumpMergedEventJournals() to k-way merge any number of journals into one
+ * time-ordered dump - cross-process latency attribution in one call.
+ */
+
+/** Bytes of caller payload carried by each record. */
+inline constexpr size_t kEventJournalPayloadSize = 16;
+
+/**
+ * One journal record.  Plain old data, fixed 32 bytes, identical layout in
+ * every process mapping the ring.
+ */
+struct event_journal_record {
+    uint32_t id;        /**< caller-defined event id */
+    uint32_t sequence;  /**< per-journal sequence number, for gap detection */
+    int64_t  timeNs;    /**< CLOCK_MONOTONIC at log() time */
+    uint8_t  payload[kEventJournalPayloadSize]; /**< caller payload, zero padded */
+};
+
+static_assert(sizeof(event_journal_record) == 32, "record layout is ABI across processes");
+static_assert(std::is_trivially_copyable_v<event_journal_record>,
+        "records are copied through shared memory");
+
+/**
+ * The writing side of one journal.  One instance per process; log() may only
+ * be called from one thread at a time (give each thread its own journal if
+ * needed, the merge makes that free).
+ */
+class EventJournalWriter {
+public:
+    /**
+     * Create a journal.
+     *
+     *  \param capacityEvents Number of records the ring holds before the
+     *                        oldest are overwritten, > 0.
+     *  \param writer         Receives the new object on success.
+     *
+     * \return 0 on success, or a negative errno value.
+     */
+    static int create(uint32_t capacityEvents, EventJournalWriter **writer);
+
+    /**
+     * Append one record, stamped with CLOCK_MONOTONIC now.
+     * Lock-free, non-blocking, no allocation; never fails.
+     *
+     *  \param id      caller-defined event id.
+     *  \param payload optional payload, or NULL.
+     *  \param size    payload bytes to copy, truncated to
+     *                 kEventJournalPayloadSize; the rest is zero filled.
+     */
+    void log(uint32_t id, const void *payload = nullptr, size_t size = 0);
+
+    /** Return the file descriptor to pass to the observing process. */
+    int fd() const
+            { return mShm->fd(); }
+
+private:
+    explicit EventJournalWriter(audio_utils_fifo_shm *shm);
+
+    const std::unique_ptr<audio_utils_fifo_shm> mShm;
+    audio_utils_fifo mFifo;
+    audio_utils_fifo_writer mWriter;
+    uint32_t mSequence = 0;
+};
+
+/**
+ * The reading side of one journal, in the observing process.
+ */
+class EventJournalReader {
+public:
+    /**
+     * Attach to a journal created in another process.
+     *
+     *  \param fd     File descriptor obtained from EventJournalWriter::fd().
+     *                The caller retains ownership.
+     *  \param reader Receives the new object on success.
+     *
+     * \return 0 on success, or a negative errno value;
+     *         -EINVAL if the region is not a journal of this record layout.
+     */
+    static int attach(int fd, EventJournalReader **reader);
+
+    /**
+     * Read available records in log order.
+     *
+     *  \param records  Array of at least \p maxCount records.
+     *  \param maxCount Maximum number of records to read.
+     *  \param lost     Optionally receives the number of records overwritten
+     *                  by the writer before they could be read.
+     *
+     * \return Number of records read, >= 0, or a negative errno value.
+     */
+    ssize_t read(event_journal_record *records, size_t maxCount, size_t *lost = nullptr);
+
+private:
+    explicit EventJournalReader(audio_utils_fifo_shm *shm);
+
+    const std::unique_ptr<audio_utils_fifo_shm> mShm;
+    audio_utils_fifo mFifo;
+    audio_utils_fifo_reader mReader;
+};
+
+/**
+ * Drain any number of journals and write one merged, time-ordered dump.
+ *
+ * Records are sorted by their CLOCK_MONOTONIC timestamp across journals;
+ * each line carries the journal's tag so a record remains attributable to
+ * its process.  Records lost to ring wrap are reported per journal.
+ *
+ *  \param fd      File descriptor to dump to.
+ *  \param readers Array of \p count attached readers.
+ *  \param tags    Array of \p count short per-journal labels (e.g. the
+ *                 process name), or NULL to label by index.
+ *  \param count   Number of journals to merge.
+ */
+void dumpMergedEventJournals(int fd, EventJournalReader *const *readers,
+        const char *const *tags, size_t count);
+
+}  // namespace android::audio_utils
+
+#endif  // ANDROID_AUDIO_EVENT_JOURNAL_H
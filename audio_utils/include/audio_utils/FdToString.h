@@ -17,12 +17,26 @@
 #ifndef ANDROID_AUDIO_FD_TO_STRING_H
 #define ANDROID_AUDIO_FD_TO_STRING_H
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <fcntl.h>
+#include <functional>
 #include <future>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <poll.h>
 #include <sstream>
+#include <string.h>
+#include <string_view>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <thread>
 #include <unistd.h>
 #include <utils/Timers.h>
+#include <vector>
 
 #include "clock.h"
 
@@ -132,6 +146,423 @@ private:
     std::future<std::string> mOutput;
 };
 
+/**
+ * FdToStringService
+ *
+ * A reusable variant of FdToString for repeated dumps.
+ *
+ * FdToString spawns (and joins) a reader thread per capture, which dominates
+ * the cost when a dump captures dozens of fds.  The service keeps one
+ * persistent reader thread with an epoll set over all open captures, and each
+ * capture accumulates into a preallocated string, so a capture costs a pipe
+ * and no thread create/join.
+ *
+ * Usage:
+ *
+ *   FdToStringService service;       // typically a long lived member.
+ *   auto capture = service.createCapture("- ");
+ *   if (capture) {
+ *       dumpToFd(capture->fd());
+ *       result = capture->getStringAndClose();
+ *   }
+ *
+ * Captures may be open concurrently from multiple threads.  The service must
+ * outlive its captures.
+ */
+class FdToStringService {
+public:
+    class Capture {
+    public:
+        ~Capture() {
+            if (mWriteFd >= 0) close(mWriteFd);
+        }
+
+        /**
+         * Returns the write end of the pipe as a file descriptor
+         * or -1 if already closed.
+         *
+         * Do not close this fd directly as the capture owns it. Instead, use
+         * getStringAndClose() to close the fd and return the string.
+         */
+        int fd() const {
+            return mWriteFd;
+        }
+
+        /**
+         * Returns the string representation of data written to the fd.
+         *
+         * Unlike FdToString, the timeout applies from this call, not from
+         * creation, and on timeout the data captured so far is returned
+         * (further writes to the fd are discarded).  May be called once.
+         *
+         * \param timeoutMs maximum time to wait for the writer to close the fd.
+         */
+        std::string getStringAndClose(int timeoutMs = 200) {
+            return mService.closeAndGetString(this, timeoutMs);
+        }
+
+    private:
+        friend class FdToStringService;
+
+        Capture(FdToStringService &service, int readFd, int writeFd, std::string prefix)
+                : mService(service)
+                , mPrefix(std::move(prefix))
+                , mReadFd(readFd)
+                , mWriteFd(writeFd) {}
+
+        FdToStringService &mService;
+        const std::string mPrefix;  // prefix prepended to each line.
+        int mReadFd;                // owned by the service (guarded by service lock).
+        int mWriteFd;               // owned by the capture, returned by fd().
+        std::string mString;        // accumulated data (guarded by service lock).
+        bool mRequiresPrefix = true;
+        bool mDone = false;         // reader saw the write end close.
+    };
+
+    FdToStringService() {
+        mEpollFd = epoll_create1(EPOLL_CLOEXEC);
+        mWakeFd = eventfd(0, EFD_CLOEXEC);
+        if (mEpollFd < 0 || mWakeFd < 0) return;  // createCapture() will fail.
+        struct epoll_event event = { .events = EPOLLIN };
+        event.data.fd = mWakeFd;
+        if (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, mWakeFd, &event) != 0) return;
+        mThread = std::thread([this] { threadLoop(); });
+    }
+
+    ~FdToStringService() {
+        {
+            std::lock_guard lg(mLock);
+            mQuit = true;
+        }
+        if (mWakeFd >= 0) {
+            const uint64_t one = 1;
+            (void)write(mWakeFd, &one, sizeof(one));
+        }
+        if (mThread.joinable()) mThread.join();
+        {
+            // finish any captures still open so their strings are retrievable.
+            std::lock_guard lg(mLock);
+            for (auto &[readFd, capture] : mCaptures) {
+                close(readFd);
+                capture->mReadFd = -1;
+                capture->mDone = true;
+            }
+            mCaptures.clear();
+            mCondition.notify_all();
+        }
+        if (mWakeFd >= 0) close(mWakeFd);
+        if (mEpollFd >= 0) close(mEpollFd);
+    }
+
+    /**
+     * Runs all writers concurrently, each into its own capture, and returns
+     * their outputs concatenated in writer order (regardless of completion
+     * order).  A dump of N independent tracks therefore costs roughly the
+     * slowest track rather than the sum of all of them.
+     *
+     * Each writer is called once with its capture's write fd and must not
+     * close it; at most maxConcurrency writers (including the calling
+     * thread) run at a time.  The timeout is a single deadline over the
+     * whole aggregation; writers that do not finish in time contribute the
+     * data they produced before the deadline.
+     *
+     * \param writers one dump function per output segment.
+     * \param prefix is the prefix string prepended to each new line.
+     * \param timeoutMs deadline for the whole aggregation in milliseconds.
+     * \param maxConcurrency maximum writers running at once.
+     * \return the segments concatenated in writer order.
+     */
+    std::string aggregateDumps(
+            const std::vector<std::function<void(int fd)>> &writers,
+            const std::string &prefix = "- ",
+            int timeoutMs = 200,
+            size_t maxConcurrency = 8) {
+        if (writers.empty()) return "";
+        const int64_t deadlineNs = systemTime() + timeoutMs * NANOS_PER_MILLISECOND;
+        std::vector<std::string> segments(writers.size());
+        std::atomic<size_t> nextWriter{0};
+        const auto work = [&] {
+            for (;;) {
+                const size_t i = nextWriter.fetch_add(1);
+                if (i >= writers.size()) return;
+                auto capture = createCapture(prefix);
+                if (capture == nullptr) continue;  // empty segment.
+                writers[i](capture->fd());
+                segments[i] = capture->getStringAndClose(
+                        toMillisecondTimeoutDelay(systemTime(), deadlineNs));
+            }
+        };
+        const size_t threadCount =
+                std::min(maxConcurrency > 0 ? maxConcurrency : 1, writers.size());
+        std::vector<std::thread> pool;
+        pool.reserve(threadCount - 1);
+        for (size_t t = 1; t < threadCount; ++t) {
+            pool.emplace_back(work);
+        }
+        work();  // the calling thread is one of the draining contexts.
+        for (auto &thread : pool) {
+            thread.join();
+        }
+        size_t total = 0;
+        for (const auto &segment : segments) total += segment.size();
+        std::string result;
+        result.reserve(total);
+        for (const auto &segment : segments) result += segment;
+        return result;
+    }
+
+    /**
+     * Opens a new capture serviced by the reader thread.
+     *
+     * \param prefix is the prefix string prepended to each new line.
+     * \param reserved bytes preallocated for the output string.
+     * \return the capture, or nullptr on failure.
+     */
+    std::shared_ptr<Capture> createCapture(
+            const std::string &prefix = "- ", size_t reserved = 4096) {
+        if (mEpollFd < 0 || !mThread.joinable()) return nullptr;
+        int pipeFd[2];
+        if (pipe2(pipeFd, O_CLOEXEC) != 0) return nullptr;
+        // only the read end is non-blocking: writers expect blocking fds.
+        (void)fcntl(pipeFd[0], F_SETFL, O_NONBLOCK);
+        std::shared_ptr<Capture> capture(
+                new Capture(*this, pipeFd[0], pipeFd[1], prefix));
+        capture->mString.reserve(reserved);
+        {
+            std::lock_guard lg(mLock);
+            mCaptures.emplace(pipeFd[0], capture);
+        }
+        struct epoll_event event = { .events = EPOLLIN | EPOLLRDHUP };
+        event.data.fd = pipeFd[0];
+        if (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, pipeFd[0], &event) != 0) {
+            std::lock_guard lg(mLock);
+            mCaptures.erase(pipeFd[0]);
+            close(pipeFd[0]);
+            capture->mReadFd = -1;
+            return nullptr;  // ~Capture closes the write end.
+        }
+        return capture;
+    }
+
+private:
+    void threadLoop() {
+        struct epoll_event events[8];
+        for (;;) {
+            const int count = epoll_wait(
+                    mEpollFd, events, sizeof(events) / sizeof(events[0]), -1 /* timeout */);
+            if (count < 0) {
+                if (errno == EINTR) continue;
+                return;
+            }
+            for (int i = 0; i < count; ++i) {
+                if (events[i].data.fd == mWakeFd) {
+                    uint64_t value;
+                    (void)read(mWakeFd, &value, sizeof(value));
+                    std::lock_guard lg(mLock);
+                    if (mQuit) return;
+                    continue;
+                }
+                serviceCapture(events[i].data.fd);
+            }
+        }
+    }
+
+    // Drains readFd into its capture; finishes the capture on eof (writer closed).
+    void serviceCapture(int readFd) {
+        char buf[4096];
+        std::shared_ptr<Capture> capture;
+        {
+            std::lock_guard lg(mLock);
+            const auto it = mCaptures.find(readFd);
+            if (it == mCaptures.end()) return;  // closed by a timeout.
+            capture = it->second;
+        }
+        for (;;) {
+            const ssize_t size = read(readFd, buf, sizeof(buf));
+            if (size > 0) {
+                std::lock_guard lg(mLock);
+                appendLocked(*capture, buf, size);
+                continue;
+            }
+            if (size < 0 && (errno == EAGAIN || errno == EINTR)) return;  // drained for now.
+            break;  // eof or error: the writer closed.
+        }
+        std::lock_guard lg(mLock);
+        if (capture->mReadFd != readFd) return;  // already finished elsewhere.
+        // erase before close so the fd number cannot alias a new capture.
+        mCaptures.erase(readFd);
+        (void)epoll_ctl(mEpollFd, EPOLL_CTL_DEL, readFd, nullptr);
+        close(readFd);
+        capture->mReadFd = -1;
+        capture->mDone = true;
+        mCondition.notify_all();
+    }
+
+    // Appends a chunk, prepending the prefix at each new line (as FdToString).
+    void appendLocked(Capture &capture, const char *buf, size_t size) {
+        const char *bptr = buf;
+        const char *delim;
+        while (!capture.mPrefix.empty()
+                && (delim = (const char *)memchr(bptr, '\n', size)) != nullptr) {
+            if (capture.mRequiresPrefix) capture.mString += capture.mPrefix;
+            const size_t line = delim - bptr + 1;
+            capture.mString.append(bptr, line);
+            bptr += line;
+            size -= line;
+            capture.mRequiresPrefix = true;
+        }
+        if (size > 0) {
+            if (capture.mRequiresPrefix) capture.mString += capture.mPrefix;
+            capture.mString.append(bptr, size);
+            capture.mRequiresPrefix = false;
+        }
+    }
+
+    std::string closeAndGetString(Capture *capture, int timeoutMs) {
+        std::unique_lock ul(mLock);
+        if (capture->mWriteFd >= 0) {
+            close(capture->mWriteFd);
+            capture->mWriteFd = -1;
+        }
+        mCondition.wait_for(ul, std::chrono::milliseconds(timeoutMs),
+                [capture] { return capture->mDone; });
+        if (!capture->mDone) {
+            // Timed out: return what we have.  The read end stays with the
+            // reader thread, which finishes (and discards) the capture when
+            // the pipe drains; since our write end is closed that is imminent.
+            capture->mDone = true;
+        }
+        return std::move(capture->mString);
+    }
+
+    std::mutex mLock;
+    std::condition_variable mCondition;
+    std::map<int, std::shared_ptr<Capture>> mCaptures;  // keyed by read fd (guarded by mLock).
+    bool mQuit = false;       // guarded by mLock.
+    int mEpollFd = -1;        // epoll set over the capture read fds and mWakeFd.
+    int mWakeFd = -1;         // eventfd to wake the reader for shutdown.
+    std::thread mThread;      // the persistent reader.
+};
+
+/**
+ * FdToMemfd
+ *
+ * Captures fd dump output into a memfd ring via splice(2): the dump bytes
+ * move pipe to page cache inside the kernel, never passing through a
+ * userspace buffer, and the capture never exists as one contiguous
+ * userspace allocation of the dump size.
+ *
+ * The ring retains the most recent \p capacity bytes; a dump larger than
+ * the ring overwrites its own oldest output, which suits continuous
+ * diagnostics sampling where the tail is the interesting part.  The
+ * captured bytes are consumed incrementally through visitAndClose(),
+ * in place in the memfd mapping.
+ *
+ * No per-line prefixing is applied: prefixing rewrites the bytes, which
+ * would reintroduce exactly the copy this class avoids.  Use FdToString
+ * when a prefix is required.
+ */
+class FdToMemfd {
+public:
+    /**
+     * \param capacity  bytes retained by the ring (at least one page).
+     * \param timeoutMs the total timeout to wait for obtaining data in milliseconds.
+     */
+    explicit FdToMemfd(size_t capacity = 2 << 20, int timeoutMs = 200)
+            : mCapacity(capacity < 4096 ? 4096 : capacity)
+            , mTimeoutTimeNs(systemTime() + timeoutMs * NANOS_PER_MILLISECOND) {
+        mMemFd = memfd_create("audio_utils_fdtomemfd", MFD_CLOEXEC);
+        if (mMemFd < 0) return;
+        if (ftruncate(mMemFd, (off_t)mCapacity) != 0 || pipe2(mPipeFd, O_CLOEXEC) != 0) {
+            return;  // fd() returns -1.
+        }
+        mResult = std::async(std::launch::async, splicer,
+                mPipeFd[0], mMemFd, mCapacity, mTimeoutTimeNs);
+    }
+
+    ~FdToMemfd() {
+        if (mPipeFd[1] >= 0) {
+            close(mPipeFd[1]);
+            mPipeFd[1] = -1;
+        }
+        if (mResult.valid()) mResult.wait();  // the splicer exits on eof.
+        if (mPipeFd[0] >= 0) close(mPipeFd[0]);
+        if (mMemFd >= 0) close(mMemFd);
+    }
+
+    /**
+     * Returns the write end of the pipe as a file descriptor or -1 if invalid or already closed.
+     *
+     * Do not close this fd directly as this class should own the fd. Instead, use
+     * visitAndClose() to close the fd and consume the capture.
+     */
+    int fd() const {
+        return mPipeFd[1];
+    }
+
+    /**
+     * Waits for the writer to close (or the timeout), then visits the
+     * retained bytes oldest first: one chunk, or two when the ring has
+     * wrapped.  The chunks point into the memfd mapping and are only valid
+     * during the visit.
+     *
+     * \return the total number of bytes the writer produced, which exceeds
+     *         the retained size when the ring wrapped, or -1 on failure.
+     */
+    ssize_t visitAndClose(const std::function<void(std::string_view)>& visitor) {
+        if (!mResult.valid()) return -1;
+        if (mPipeFd[1] >= 0) {
+            close(mPipeFd[1]);
+            mPipeFd[1] = -1;
+        }
+        const ssize_t total = mResult.get();
+        if (total < 0) return -1;
+        const size_t retained = (size_t)total < mCapacity ? (size_t)total : mCapacity;
+        if (retained > 0) {
+            void *base = mmap(nullptr, mCapacity, PROT_READ, MAP_SHARED, mMemFd, (off_t)0);
+            if (base == MAP_FAILED) return -1;
+            const char *data = static_cast<const char *>(base);
+            if ((size_t)total <= mCapacity) {
+                visitor(std::string_view(data, retained));
+            } else {
+                const size_t head = (size_t)total % mCapacity;  // one past the newest byte.
+                visitor(std::string_view(data + head, mCapacity - head));
+                visitor(std::string_view(data, head));
+            }
+            munmap(base, mCapacity);
+        }
+        return total;
+    }
+
+private:
+    static ssize_t splicer(int readFd, int memFd, size_t capacity, int64_t timeoutTimeNs) {
+        ssize_t total = 0;
+        for (;;) {
+            struct pollfd pfd = {
+                .fd = readFd,
+                .events = POLLIN | POLLRDHUP,
+            };
+            const int waitMs = toMillisecondTimeoutDelay(systemTime(), timeoutTimeNs);
+            if (waitMs <= 0) break;
+            const int retval = poll(&pfd, 1 /* nfds */, waitMs);
+            if (retval <= 0 || (pfd.revents & POLLIN) != POLLIN) break;  // error or timeout
+            // splice up to the end of the ring; the next call continues at the wrap.
+            loff_t offset = (loff_t)(total % (ssize_t)capacity);
+            const ssize_t spliced = splice(readFd, nullptr, memFd, &offset,
+                    capacity - (size_t)offset, SPLICE_F_MOVE);
+            if (spliced <= 0) break;  // 0 is eof (writer closed); negative is an error.
+            total += spliced;
+        }
+        return total;
+    }
+
+    const size_t mCapacity;
+    const int64_t mTimeoutTimeNs;
+    int mMemFd = -1;
+    int mPipeFd[2] = {-1, -1};
+    std::future<ssize_t> mResult;
+};
+
 } // namespace audio_utils
 } // namespace android
 
@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "BiquadFilter.h"
+
+#include <array>
+
+#include <assert.h>
+
+// Use dither to prevent subnormals for CPUs that raise an exception.
+#pragma push_macro("USE_DITHER")
+#undef USE_DITHER
+
+#if defined(__i386__) || defined(__x86_x64__)
+#define USE_DITHER
+#endif
+
+namespace android::audio_utils {
+
+/**
+ * FilterBank
+ *
+ * Applies BANDS parallel Biquad filters to a single input signal in one
+ * vectorized sweep, producing band interleaved output.
+ *
+ * A multiband processor (e.g. multiband dynamics) conventionally runs one
+ * BiquadFilter instance per band, each making its own pass over the block
+ * with its own coefficient and state memory traffic.  Here the bands are
+ * spread across the lanes of one vector: the coefficients and delay states
+ * are stored in a structure-of-arrays layout (all b0's contiguous, etc.),
+ * each input sample is broadcast to all lanes, and every band advances in
+ * the same instruction.  BANDS of 2, 4, 8 and 16 map directly onto the NEON
+ * vector types (see details::fixed_vector).
+ *
+ * The output is band interleaved, out[frame * BANDS + band], analogous to
+ * channel interleaved audio with the bands as channels.  The band
+ * coefficients follow the 5 coefficient normalized or 6 coefficient general
+ * Biquad conventions of BiquadFilter::setCoefficients().
+ *
+ * \param BANDS number of filter bands, fixed at compile time.
+ * \param D type variable representing the data type, one of float or double.
+ *         The default is float.
+ */
+template <size_t BANDS, typename D = float>
+class FilterBank {
+    static_assert(BANDS >= 2);
+public:
+    template <typename T = std::array<D, kBiquadNumCoefs>>
+    explicit FilterBank(const std::array<T, BANDS>& coefs = {}) {
+        for (size_t band = 0; band < BANDS; ++band) {
+            setCoefficients(band, coefs[band]);
+        }
+    }
+
+    /**
+     * \brief Sets the coefficients of one band of the filter bank.
+     *
+     * \param band the band index to set.
+     * \param coefs the coefficients, in the 5 coefficient normalized or
+     *         6 coefficient general Biquad forms accepted by
+     *         BiquadFilter::setCoefficients().
+     * \return true if the band filter is stable, otherwise false.
+     */
+    template <typename T = std::array<D, kBiquadNumCoefs>>
+    bool setCoefficients(size_t band, const T& coefs) {
+        assert(band < BANDS);
+        const auto lcoef = details::reduceCoefficients<D, T>(coefs);
+        // Stored state-space converted (see BiquadStateSpace), one row per
+        // coefficient with the band as the column.
+        mCoefs[0 * BANDS + band] = lcoef[0];                       // b0
+        mCoefs[1 * BANDS + band] = lcoef[1] - lcoef[0] * lcoef[3]; // b1 - b0 * a1
+        mCoefs[2 * BANDS + band] = lcoef[2] - lcoef[0] * lcoef[4]; // b2 - b0 * a2
+        mCoefs[3 * BANDS + band] = -lcoef[3];                      // -a1
+        mCoefs[4 * BANDS + band] = -lcoef[4];                      // -a2
+        return isStable(band);
+    }
+
+    /**
+     * Returns true if the given band of the filter bank is stable.
+     */
+    bool isStable(size_t band) const {
+        assert(band < BANDS);
+        return details::isStable(
+                -mCoefs[3 * BANDS + band], -mCoefs[4 * BANDS + band]);
+    }
+
+    /**
+     * \brief Filters one input block through all bands.
+     *
+     * \param out     pointer to the band interleaved output data,
+     *                frames * BANDS samples.
+     * \param in      pointer to the single channel input data, frames samples.
+     * \param frames  number of input samples to be processed.
+     */
+    void process(D* out, const D* in, size_t frames) {
+        using namespace intrinsics;
+        using T = details::fixed_vector_t<D, BANDS>;
+
+        const T b0 = vld1<T>(&mCoefs[0 * BANDS]);
+        const T b1ss = vld1<T>(&mCoefs[1 * BANDS]);
+        const T b2ss = vld1<T>(&mCoefs[2 * BANDS]);
+        const T negativeA1 = vld1<T>(&mCoefs[3 * BANDS]);
+        const T negativeA2 = vld1<T>(&mCoefs[4 * BANDS]);
+        T s0 = vld1<T>(&mDelays[0]);
+        T s1 = vld1<T>(&mDelays[BANDS]);
+        T x, y, new_s0; // OK to declare temps here rather than at the point of initialization.
+#ifdef USE_DITHER
+        constexpr D DITHER_VALUE = std::numeric_limits<float>::min() * (1 << 24); // use FLOAT
+        T dither = vdupn<T>(DITHER_VALUE); // NEON does not have vector + scalar acceleration.
+#endif
+        while (frames > 0) {
+            x = vdupn<T>(*in++);
+#ifdef USE_DITHER
+            x = vadd(x, dither);
+            dither = vneg(dither);
+#endif
+            y = vmla(s0, b0, x);
+            new_s0 = vmla(vmla(s1, b1ss, x), negativeA1, s0);
+            s1 = vmla(vmul(b2ss, x), negativeA2, s0);
+            s0 = new_s0;
+            vst1(out, y);
+            out += BANDS;
+            frames--;
+        }
+        vst1(&mDelays[0], s0);
+        vst1(&mDelays[BANDS], s1);
+    }
+
+    /**
+     * \brief Clears the delay elements of all bands
+     */
+    void clear() {
+        mDelays.fill(0);
+    }
+
+private:
+    /**
+     * \var D mCoefs
+     * \brief The state-space converted coefficients, structure-of-arrays:
+     * rows b0, b1 - b0*a1, b2 - b0*a2, -a1, -a2, each BANDS wide.
+     */
+    std::array<D, kBiquadNumCoefs * BANDS> mCoefs{};
+
+    /**
+     * \var D mDelays
+     * \brief The delay states, row s1 then row s2, each BANDS wide.
+     */
+    std::array<D, kBiquadNumDelays * BANDS> mDelays{};
+};
+
+} // namespace android::audio_utils
+
+#pragma pop_macro("USE_DITHER")
@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_FILTER_DESIGN_H
+#define ANDROID_AUDIO_FILTER_DESIGN_H
+
+#include <array>
+#include <cstddef>
+
+namespace android::audio_utils {
+
+/**
+ * Constexpr biquad design (Audio EQ Cookbook forms) for BiquadFilter.
+ *
+ * Each design function returns the five coefficients {b0, b1, b2, a1, a2},
+ * normalized by a0 and with the a's in "positive" reference, i.e. directly in
+ * the layout BiquadFilter::setCoefficients() takes.
+ *
+ * Every function here is constexpr, so a filter whose parameters are known at
+ * compile time costs nothing at runtime:
+ *
+ *     static constexpr auto kCoefs = biquadLowpass(1000.f / 48000.f);
+ *
+ * For runtime retuning (e.g. 100 Hz parameter automation), the trig comes from
+ * a quarter-wave sine table with linear interpolation and the dB conversion
+ * from a short polynomial, so recomputing a section is a handful of multiplies
+ * and two divides with no libm calls.  Table accuracy is about 1e-7 absolute,
+ * far below coefficient quantization audibility.
+ *
+ * Frequencies are normalized: f = f0 / sampleRate, with 0 < f < 0.5.
+ * The default Q of 1/sqrt(2) makes lowpass/highpass maximally flat
+ * (second-order Butterworth).
+ */
+
+namespace filter_design_details {
+
+inline constexpr double kPi = 3.14159265358979323846;
+inline constexpr double kLn2 = 0.69314718055994530942;
+inline constexpr double kLn10 = 2.30258509299404568402;
+
+// Newton's method; converges quadratically from a safe starting guess.
+constexpr double sqrt_(double x) {
+    double guess = x > 1. ? x : 1.;
+    for (int i = 0; i < 64; ++i) {
+        guess = 0.5 * (guess + x / guess);
+    }
+    return guess;
+}
+
+// exp by range reduction to [0, ln2) plus a Taylor series; exact enough for
+// the +-24 dB gain range of an EQ band and still cheap at runtime.
+constexpr double exp_(double x) {
+    int n = static_cast<int>(x / kLn2);
+    if (x < 0. && x != n * kLn2) {
+        --n;
+    }
+    const double r = x - n * kLn2;
+    double term = 1.;
+    double sum = 1.;
+    for (int i = 1; i < 20; ++i) {
+        term *= r / i;
+        sum += term;
+    }
+    for (; n > 0; --n) sum *= 2.;
+    for (; n < 0; ++n) sum *= 0.5;
+    return sum;
+}
+
+// Taylor sine, used only to build the table at compile time.
+constexpr double taylorSin(double x) {
+    double term = x;
+    double sum = x;
+    const double x2 = x * x;
+    for (int i = 1; i < 16; ++i) {
+        term *= -x2 / ((2 * i) * (2 * i + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+// Quarter-wave sine table covering [0, pi/2]; sinpi/cospi fold into it.
+// 2048 steps give a linear interpolation error of about h^2/8 ~= 7e-8.
+inline constexpr size_t kSinTableSize = 2048;
+
+struct SinTable {
+    double v[kSinTableSize + 1];
+};
+
+constexpr SinTable makeSinTable() {
+    SinTable table{};
+    for (size_t i = 0; i <= kSinTableSize; ++i) {
+        table.v[i] = taylorSin(i * (kPi / 2) / kSinTableSize);
+    }
+    return table;
+}
+
+inline constexpr SinTable kSinTable = makeSinTable();
+
+// sin(pi * x) for x in [0, 1], by table interpolation
+constexpr double sinpi(double x) {
+    if (x > 0.5) {
+        x = 1. - x;
+    }
+    const double pos = x * (2 * kSinTableSize);    // map [0, 0.5] onto the table
+    const size_t i = static_cast<size_t>(pos);
+    const double frac = pos - i;
+    return kSinTable.v[i] + (kSinTable.v[i + 1] - kSinTable.v[i]) * frac;
+}
+
+// cos(pi * x) for x in [0, 1], by table interpolation
+constexpr double cospi(double x) {
+    return x <= 0.5 ? sinpi(0.5 - x) : -sinpi(x - 0.5);
+}
+
+// 10^(db / 40), the cookbook's A parameter for shelf and peaking gains
+constexpr double gainA(double db) {
+    return exp_(db * (kLn10 / 40.));
+}
+
+template <typename D>
+constexpr std::array<D, 5> normalize(
+        double b0, double b1, double b2, double a0, double a1, double a2) {
+    return {static_cast<D>(b0 / a0), static_cast<D>(b1 / a0), static_cast<D>(b2 / a0),
+            static_cast<D>(a1 / a0), static_cast<D>(a2 / a0)};
+}
+
+}  // namespace filter_design_details
+
+inline constexpr double kButterworthQ = 0.70710678118654752440;  // 1/sqrt(2)
+
+/**
+ * Design a second-order lowpass.
+ *
+ * \param f normalized corner frequency, 0 < f < 0.5.
+ * \param Q quality factor; the default gives a Butterworth response.
+ * \return coefficients {b0, b1, b2, a1, a2} for BiquadFilter::setCoefficients().
+ */
+template <typename D = double>
+constexpr std::array<D, 5> biquadLowpass(double f, double Q = kButterworthQ) {
+    using namespace filter_design_details;
+    const double cosw = cospi(2 * f);
+    const double alpha = sinpi(2 * f) / (2 * Q);
+    return normalize<D>((1. - cosw) * 0.5, 1. - cosw, (1. - cosw) * 0.5,
+            1. + alpha, -2. * cosw, 1. - alpha);
+}
+
+/**
+ * Design a second-order highpass.
+ *
+ * \param f normalized corner frequency, 0 < f < 0.5.
+ * \param Q quality factor; the default gives a Butterworth response.
+ * \return coefficients {b0, b1, b2, a1, a2} for BiquadFilter::setCoefficients().
+ */
+template <typename D = double>
+constexpr std::array<D, 5> biquadHighpass(double f, double Q = kButterworthQ) {
+    using namespace filter_design_details;
+    const double cosw = cospi(2 * f);
+    const double alpha = sinpi(2 * f) / (2 * Q);
+    return normalize<D>((1. + cosw) * 0.5, -(1. + cosw), (1. + cosw) * 0.5,
+            1. + alpha, -2. * cosw, 1. - alpha);
+}
+
+/**
+ * Design a peaking (bell) EQ band.
+ *
+ * \param f      normalized center frequency, 0 < f < 0.5.
+ * \param Q      quality factor of the bell.
+ * \param gainDb boost (positive) or cut (negative) at the center, in dB.
+ * \return coefficients {b0, b1, b2, a1, a2} for BiquadFilter::setCoefficients().
+ */
+template <typename D = double>
+constexpr std::array<D, 5> biquadPeaking(double f, double Q, double gainDb) {
+    using namespace filter_design_details;
+    const double A = gainA(gainDb);
+    const double cosw = cospi(2 * f);
+    const double alpha = sinpi(2 * f) / (2 * Q);
+    return normalize<D>(1. + alpha * A, -2. * cosw, 1. - alpha * A,
+            1. + alpha / A, -2. * cosw, 1. - alpha / A);
+}
+
+/**
+ * Design a low shelf.
+ *
+ * \param f      normalized transition frequency, 0 < f < 0.5.
+ * \param gainDb shelf gain in dB.
+ * \param Q      shelf steepness; the default gives the maximally
+ *               steep response without resonance (cookbook S = 1).
+ * \return coefficients {b0, b1, b2, a1, a2} for BiquadFilter::setCoefficients().
+ */
+template <typename D = double>
+constexpr std::array<D, 5> biquadLowShelf(double f, double gainDb, double Q = kButterworthQ) {
+    using namespace filter_design_details;
+    const double A = gainA(gainDb);
+    const double cosw = cospi(2 * f);
+    const double alpha = sinpi(2 * f) / (2 * Q);
+    const double k = 2. * sqrt_(A) * alpha;
+    return normalize<D>(
+            A * ((A + 1.) - (A - 1.) * cosw + k),
+            2. * A * ((A - 1.) - (A + 1.) * cosw),
+            A * ((A + 1.) - (A - 1.) * cosw - k),
+            (A + 1.) + (A - 1.) * cosw + k,
+            -2. * ((A - 1.) + (A + 1.) * cosw),
+            (A + 1.) + (A - 1.) * cosw - k);
+}
+
+/**
+ * Design a high shelf.
+ *
+ * \param f      normalized transition frequency, 0 < f < 0.5.
+ * \param gainDb shelf gain in dB.
+ * \param Q      shelf steepness; the default gives the maximally
+ *               steep response without resonance (cookbook S = 1).
+ * \return coefficients {b0, b1, b2, a1, a2} for BiquadFilter::setCoefficients().
+ */
+template <typename D = double>
+constexpr std::array<D, 5> biquadHighShelf(double f, double gainDb, double Q = kButterworthQ) {
+    using namespace filter_design_details;
+    const double A = gainA(gainDb);
+    const double cosw = cospi(2 * f);
+    const double alpha = sinpi(2 * f) / (2 * Q);
+    const double k = 2. * sqrt_(A) * alpha;
+    return normalize<D>(
+            A * ((A + 1.) + (A - 1.) * cosw + k),
+            -2. * A * ((A - 1.) + (A + 1.) * cosw),
+            A * ((A + 1.) + (A - 1.) * cosw - k),
+            (A + 1.) - (A - 1.) * cosw + k,
+            2. * ((A - 1.) - (A + 1.) * cosw),
+            (A + 1.) - (A - 1.) * cosw - k);
+}
+
+}  // namespace android::audio_utils
+
+#endif  // ANDROID_AUDIO_FILTER_DESIGN_H
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "variadic_utils.h"
+
+namespace android::audio_utils::channels {
+
+/**
+ * GainMatrix applies a fixed IN_CHANNELS x OUT_CHANNELS linear gain matrix
+ * to interleaved audio frames.
+ *
+ * The channel counts are compile-time parameters and each frame is mixed
+ * through the variadic_utils operators on std::array, so the
+ * multiply-accumulate network of a frame is fully unrolled by pack
+ * expansion - there is no runtime loop over channels.  With a constexpr
+ * matrix (the usual case for fixed routing, e.g. a 12x8 automotive matrix)
+ * the coefficients become immediates, zero terms fold away, and the frame
+ * mix compiles to straight-line vectorizable code.
+ *
+ * Unlike ChannelMix this is a pure linear operator with no output clamping;
+ * the caller owns the headroom of its routing gains.
+ */
+template <typename T, size_t IN_CHANNELS, size_t OUT_CHANNELS>
+class GainMatrix {
+public:
+    static_assert(IN_CHANNELS > 0 && OUT_CHANNELS > 0);
+
+    /** The output gains of one input channel, one matrix row. */
+    using Row = std::array<T, OUT_CHANNELS>;
+
+    /** The full gain matrix, indexed [inChannel][outChannel]. */
+    using Matrix = std::array<Row, IN_CHANNELS>;
+
+    constexpr explicit GainMatrix(const Matrix& matrix) : mMatrix(matrix) {}
+
+    /**
+     * Mixes interleaved audio frames in src through the matrix into dst.
+     *
+     * The src and dst buffers must not overlap.
+     *
+     * \param src          input audio buffer of IN_CHANNELS channel frames.
+     * \param dst          output audio buffer of OUT_CHANNELS channel frames.
+     * \param frameCount   number of frames to mix.
+     * \param accumulate   is true if the mix is added to the destination or
+     *                     false if the mix replaces the destination.
+     */
+    constexpr void process(const T *src, T *dst, size_t frameCount,
+            bool accumulate = false) const {
+        accumulate ? processSwitch<true>(src, dst, frameCount)
+                : processSwitch<false>(src, dst, frameCount);
+    }
+
+    /** \return the gain of inChannel into outChannel. */
+    constexpr T gain(size_t inChannel, size_t outChannel) const {
+        return mMatrix[inChannel][outChannel];
+    }
+
+private:
+    template <bool ACCUMULATE>
+    constexpr void processSwitch(const T *src, T *dst, size_t frameCount) const {
+        for (; frameCount > 0; --frameCount) {
+            const Row mixed = mixFrame(src, std::make_index_sequence<IN_CHANNELS>{});
+            storeFrame<ACCUMULATE>(mixed, dst, std::make_index_sequence<OUT_CHANNELS>{});
+            src += IN_CHANNELS;
+            dst += OUT_CHANNELS;
+        }
+    }
+
+    // One frame of the network: the sum of the input samples scaled by their
+    // matrix rows, written with the variadic_utils array * array and
+    // array + array operators so the whole frame expands without a loop.
+    template <std::size_t... I>
+    constexpr Row mixFrame(const T *src, std::index_sequence<I...>) const {
+        return ((mMatrix[I] * broadcast(src[I])) + ...);
+    }
+
+    template <std::size_t... O>
+    static constexpr Row broadcastImpl(T value, std::index_sequence<O...>) {
+        return {(static_cast<void>(O), value)...};
+    }
+
+    /** A Row with every element set to value. */
+    static constexpr Row broadcast(T value) {
+        return broadcastImpl(value, std::make_index_sequence<OUT_CHANNELS>{});
+    }
+
+    template <bool ACCUMULATE, std::size_t... O>
+    static constexpr void storeFrame(const Row& mixed, T *dst, std::index_sequence<O...>) {
+        if constexpr (ACCUMULATE) {
+            ((dst[O] += std::get<O>(mixed)), ...);
+        } else {
+            ((dst[O] = std::get<O>(mixed)), ...);
+        }
+    }
+
+    const Matrix mMatrix;
+};
+
+} // namespace android::audio_utils::channels
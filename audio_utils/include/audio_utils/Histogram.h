@@ -17,10 +17,15 @@
 #ifndef AUDIO_UTILS_HISTOGRAM_H
 #define AUDIO_UTILS_HISTOGRAM_H
 
+#include <atomic>
+#include <cassert>
 #include <memory>
-#include <sstream>
+#include <new>
+#include <string>
 #include <vector>
 
+#include <audio_utils/string.h>
+
 namespace android::audio_utils {
 
 class Histogram {
@@ -118,36 +123,386 @@ public:
      * @return string bins in CSV format
      */
     std::string dump() const {
-        std::stringstream result;
+        // format directly with the string.h kernels rather than a
+        // stringstream, which reallocates and locale-formats per value.
+        dump_buffer<> buf(mBins.size() * kMaxDumpLineLength + 64);
         uint64_t count = getCountBelowRange();
         if (count > 0) {
-            result << "below range = " << count << std::endl;
+            buf.append("below range = ").append_uint(count).append("\n");
         }
-        result << "index, start, count, last" << std::endl;
+        buf.append("index, start, count, last\n");
         for (size_t i = 1; i < mBins.size() - 1; i++) {
             if (mBins[i] > 0) {
-                size_t properIndex = i - 1;
-                result << properIndex;
-                result << ", "<< (properIndex * mBinWidth);
-                result << ", " << mBins[i];
-                result << ", " << mLastItemNumbers[i];
-                result << std::endl;
+                const size_t properIndex = i - 1;
+                buf.append_uint(properIndex)
+                        .append(", ").append_uint(properIndex * mBinWidth)
+                        .append(", ").append_uint(mBins[i])
+                        .append(", ").append_uint(mLastItemNumbers[i])
+                        .append("\n");
             }
         }
         count = getCountAboveRange();
         if (count > 0) {
-            result << "above range = " << count << std::endl;
+            buf.append("above range = ").append_uint(count).append("\n");
         }
-        return result.str();
+        return {buf.c_str(), buf.size()};
     }
 
 private:
     static constexpr int kExtraBins = 2; // for out of range values
+    static constexpr size_t kMaxDumpLineLength = 90; // four 20-digit values and separators
     const int32_t mBinWidth;
     int64_t mItemCount = 0;
     std::vector<uint64_t> mBins;  // count of the number of items in the range of this bin
     std::vector<uint64_t> mLastItemNumbers; // number of the last item added this bin
 };
 
+/**
+ * LogHistogram bins values on a log-linear (HDR-style) scale with constant
+ * memory, so a single object covers several decades of range (e.g. 50us and
+ * 50ms callback times in ns) at a fixed relative resolution.
+ *
+ * Values 0 to 2^subBucketBits - 1 get exact bins; above that, each octave
+ * [2^e, 2^(e+1)) is split into 2^subBucketBits equal sub-bins, giving a
+ * relative bin width of about 2^-subBucketBits everywhere.  The bin index
+ * is computed with a single bit scan, so add() is O(1) with no search.
+ * Histograms with the same configuration can be merge()d for aggregation.
+ */
+class LogHistogram {
+public:
+    /**
+     * Construct a log-linear histogram.
+     * @param subBucketBits log2 of the sub-bins per octave, e.g. 5 for ~3% resolution.
+     *                      Must be between 1 and 31.
+     * @param maxValue values above this go in the top (out of range) bin. Must be positive.
+     */
+    LogHistogram(int32_t subBucketBits, int64_t maxValue)
+    : mSubBucketBits(subBucketBits)
+    , mMaxValue(maxValue)
+    , mBins(binIndex(maxValue) + 1 + kExtraBins)
+    {
+        assert(subBucketBits > 0 && subBucketBits < 32);
+        assert(maxValue > 0);
+    }
+
+    /**
+     * Add another item to the histogram.
+     * @param value
+     */
+    void add(int64_t value) {
+        int32_t index;
+        if (value < 0) {
+            index = 0;                        // values below range in bottom bin
+        } else if (value > mMaxValue) {
+            index = (int32_t)mBins.size() - 1; // values above range in top bin
+        } else {
+            index = binIndex(value) + 1;
+        }
+        mBins[index]++;
+        mItemCount++;
+    }
+
+    /**
+     * Add the counts of another histogram to this one.
+     * @param other histogram with the same subBucketBits and maxValue
+     * @return true on success, false if the configurations do not match
+     */
+    bool merge(const LogHistogram &other) {
+        if (other.mSubBucketBits != mSubBucketBits || other.mMaxValue != mMaxValue) {
+            return false;
+        }
+        for (size_t i = 0; i < mBins.size(); i++) {
+            mBins[i] += other.mBins[i];
+        }
+        mItemCount += other.mItemCount;
+        return true;
+    }
+
+    /**
+     * Reset all counters to zero.
+     */
+    void clear() {
+        std::fill(mBins.begin(), mBins.end(), 0);
+        mItemCount = 0;
+    }
+
+    /**
+     * @return number of bins between the out of range bins
+     */
+    int32_t getNumBinsInRange() const {
+        return mBins.size() - kExtraBins;
+    }
+
+    /**
+     * @return number of items below zero
+     */
+    uint64_t getCountBelowRange() const {
+        return mBins[0];
+    }
+
+    /**
+     * @param binIndex between 0 and numBins-1
+     * @return number of items for the given bin index
+     */
+    uint64_t getCount(int32_t binIndex) const {
+        if (binIndex < 0 || binIndex >= getNumBinsInRange()) {
+            return 0;
+        }
+        return mBins[binIndex + 1];
+    }
+
+    /**
+     * @return total number of items added
+     */
+    uint64_t getCount() const {
+        return mItemCount;
+    }
+
+    /**
+     * @param binIndex between 0 and numBins-1
+     * @return lowest value that falls in the given bin
+     */
+    int64_t getBinStart(int32_t binIndex) const {
+        if (binIndex < 0 || binIndex >= getNumBinsInRange()) {
+            return 0;
+        }
+        const int64_t subBucketCount = (int64_t)1 << mSubBucketBits;
+        if (binIndex < 2 * subBucketCount) {
+            return binIndex;
+        }
+        const int32_t shift = binIndex / (int32_t)subBucketCount - 1;
+        return (binIndex - (int64_t)shift * subBucketCount) << shift;
+    }
+
+    /**
+     * @return number of items above maxValue
+     */
+    uint64_t getCountAboveRange() const {
+        return mBins[mBins.size() - 1];
+    }
+
+    /**
+     * Dump the bins in CSV format, which can be easily imported into a spreadsheet.
+     * @return string bins in CSV format
+     */
+    std::string dump() const {
+        // format directly with the string.h kernels rather than a
+        // stringstream, which reallocates and locale-formats per value.
+        dump_buffer<> buf(mBins.size() * kMaxDumpLineLength + 64);
+        uint64_t count = getCountBelowRange();
+        if (count > 0) {
+            buf.append("below range = ").append_uint(count).append("\n");
+        }
+        buf.append("index, start, count\n");
+        for (size_t i = 1; i < mBins.size() - 1; i++) {
+            if (mBins[i] > 0) {
+                const size_t properIndex = i - 1;
+                buf.append_uint(properIndex)
+                        .append(", ").append_int(getBinStart(properIndex))
+                        .append(", ").append_uint(mBins[i])
+                        .append("\n");
+            }
+        }
+        count = getCountAboveRange();
+        if (count > 0) {
+            buf.append("above range = ").append_uint(count).append("\n");
+        }
+        return {buf.c_str(), buf.size()};
+    }
+
+private:
+    friend class SharedLogHistogram; // shares the bin mapping and fills snapshots
+
+    // bin index for value >= 0: values below 2^subBucketBits map exactly,
+    // larger values keep subBucketBits significant bits (a single bit scan).
+    static int32_t binIndexFor(int64_t value, int32_t subBucketBits) {
+        const int32_t topBit = 63 - __builtin_clzll((uint64_t)value | 1);
+        const int32_t shift = std::max(topBit - subBucketBits, 0);
+        return (int32_t)((int64_t)shift << subBucketBits) + (int32_t)(value >> shift);
+    }
+
+    int32_t binIndex(int64_t value) const {
+        return binIndexFor(value, mSubBucketBits);
+    }
+
+    static constexpr int kExtraBins = 2; // for out of range values
+    static constexpr size_t kMaxDumpLineLength = 70; // three 20-digit values and separators
+    const int32_t mSubBucketBits;
+    const int64_t mMaxValue;
+    int64_t mItemCount = 0;
+    std::vector<uint64_t> mBins;  // count of the number of items in the range of this bin
+};
+
+/**
+ * SharedLogHistogram puts the LogHistogram bin layout over a caller-provided
+ * memory region, typically shared between processes, so that several writers
+ * (audioserver, HALs, DSP proxies) can feed one histogram and a collector can
+ * read device-wide distributions without any dump parsing or serialization.
+ *
+ * Exactly one process placement-constructs the histogram in the region with
+ * createAt(); every other process validates and adopts the same region with
+ * attachAt().  The object is trivially destructible, so no process needs to
+ * (or should) run a destructor; unmapping the region is sufficient.
+ *
+ * add() is a single relaxed-atomic increment and is safe from any number of
+ * threads and processes concurrently.  Because increments are relaxed and
+ * independent, a concurrent snapshot() may observe some bins before and some
+ * after a given add(); each bin is individually consistent, and the snapshot
+ * totals always equal the sum of the bin counts read.
+ */
+class SharedLogHistogram {
+public:
+    /**
+     * @return bytes of (8-byte aligned) memory needed for the given configuration,
+     *         parameters as for the LogHistogram constructor
+     */
+    static size_t requiredSize(int32_t subBucketBits, int64_t maxValue) {
+        return sizeof(SharedLogHistogram)
+                + numBinsFor(subBucketBits, maxValue) * sizeof(std::atomic<uint64_t>);
+    }
+
+    /**
+     * Placement-construct a histogram in a caller-provided region.
+     * Must be called by exactly one process per region.
+     * @param memory region of at least requiredSize() bytes, aligned for uint64_t
+     * @param size size of the region in bytes
+     * @param subBucketBits as for the LogHistogram constructor
+     * @param maxValue as for the LogHistogram constructor
+     * @return the histogram, or nullptr if the region or configuration is invalid
+     */
+    static SharedLogHistogram *createAt(void *memory, size_t size,
+            int32_t subBucketBits, int64_t maxValue) {
+        if (memory == nullptr || ((uintptr_t)memory & (alignof(std::atomic<uint64_t>) - 1)) != 0
+                || subBucketBits < 1 || subBucketBits > 31 || maxValue <= 0
+                || size < requiredSize(subBucketBits, maxValue)) {
+            return nullptr;
+        }
+        SharedLogHistogram *histogram =
+                new (memory) SharedLogHistogram(subBucketBits, maxValue);
+        histogram->clear();
+        return histogram;
+    }
+
+    /**
+     * Adopt a histogram that another process already constructed in the region.
+     * @param memory region holding a histogram from createAt()
+     * @param size size of the region in bytes
+     * @return the histogram, or nullptr if the region does not hold a valid one
+     */
+    static SharedLogHistogram *attachAt(void *memory, size_t size) {
+        if (memory == nullptr || ((uintptr_t)memory & (alignof(std::atomic<uint64_t>) - 1)) != 0
+                || size < sizeof(SharedLogHistogram)) {
+            return nullptr;
+        }
+        SharedLogHistogram *histogram = static_cast<SharedLogHistogram *>(memory);
+        if (histogram->mMagic != kMagic
+                || histogram->mSubBucketBits < 1 || histogram->mSubBucketBits > 31
+                || histogram->mMaxValue <= 0
+                || histogram->mNumBins
+                        != numBinsFor(histogram->mSubBucketBits, histogram->mMaxValue)
+                || size < requiredSize(histogram->mSubBucketBits, histogram->mMaxValue)) {
+            return nullptr;
+        }
+        return histogram;
+    }
+
+    /**
+     * Add another item to the histogram.
+     * Safe to call concurrently from any thread in any attached process.
+     * @param value
+     */
+    void add(int64_t value) {
+        int32_t index;
+        if (value < 0) {
+            index = 0;                 // values below range in bottom bin
+        } else if (value > mMaxValue) {
+            index = mNumBins - 1;      // values above range in top bin
+        } else {
+            index = LogHistogram::binIndexFor(value, mSubBucketBits) + 1;
+        }
+        bins()[index].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Add a snapshot of the current counts into a private LogHistogram,
+     * which can accumulate snapshots from several shared histograms.
+     * @param into histogram with the same subBucketBits and maxValue
+     * @return true on success, false if the configurations do not match
+     */
+    bool snapshot(LogHistogram &into) const {
+        if (into.mSubBucketBits != mSubBucketBits || into.mMaxValue != mMaxValue) {
+            return false;
+        }
+        for (int32_t i = 0; i < mNumBins; i++) {
+            const uint64_t count = bins()[i].load(std::memory_order_relaxed);
+            into.mBins[i] += count;
+            into.mItemCount += count;
+        }
+        return true;
+    }
+
+    /**
+     * Reset all counters to zero.
+     * Counts from add() calls racing with a clear() may survive it.
+     */
+    void clear() {
+        for (int32_t i = 0; i < mNumBins; i++) {
+            bins()[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @return total number of items added, by summing the bins
+     */
+    uint64_t getCount() const {
+        uint64_t total = 0;
+        for (int32_t i = 0; i < mNumBins; i++) {
+            total += bins()[i].load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    /** @return subBucketBits configuration, to construct matching LogHistograms */
+    int32_t getSubBucketBits() const { return mSubBucketBits; }
+
+    /** @return maxValue configuration, to construct matching LogHistograms */
+    int64_t getMaxValue() const { return mMaxValue; }
+
+private:
+    SharedLogHistogram(int32_t subBucketBits, int64_t maxValue)
+    : mMagic(kMagic)
+    , mSubBucketBits(subBucketBits)
+    , mNumBins(numBinsFor(subBucketBits, maxValue))
+    , mMaxValue(maxValue)
+    {
+    }
+
+    static int32_t numBinsFor(int32_t subBucketBits, int64_t maxValue) {
+        return LogHistogram::binIndexFor(maxValue, subBucketBits) + 1
+                + LogHistogram::kExtraBins;
+    }
+
+    // The bin array immediately follows the header in the same region.
+    std::atomic<uint64_t> *bins() {
+        return reinterpret_cast<std::atomic<uint64_t> *>(this + 1);
+    }
+    const std::atomic<uint64_t> *bins() const {
+        return reinterpret_cast<const std::atomic<uint64_t> *>(this + 1);
+    }
+
+    static constexpr uint32_t kMagic = 0x686c6731; // 'hlg1', bump on layout change
+
+    // These fields are const after createAt(), and read-only via attachAt().
+    const uint32_t mMagic;
+    const int32_t  mSubBucketBits;
+    const int32_t  mNumBins;
+    const int64_t  mMaxValue;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+        "shared histogram bins must not use a per-process lock");
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t),
+        "bin array layout must be the same in every process");
+
 } // namespace
 #endif //AUDIO_UTILS_HISTOGRAM_H
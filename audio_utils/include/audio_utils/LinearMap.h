@@ -17,7 +17,9 @@
 #ifndef ANDROID_LINEAR_MAP_H
 #define ANDROID_LINEAR_MAP_H
 
+#include <atomic>
 #include <stdint.h>
+#include <string.h>
 
 namespace android {
 
@@ -220,6 +222,21 @@ public:
         return mSamples != 0;
     }
 
+    // Copies the state of another map of the same size into this map.
+    //
+    // Used by LockFreeLinearMap to snapshot the writer's map under its
+    // sequence counter; may also be used to reuse a scratch map between
+    // snapshots to avoid allocation.
+    void copyStateFrom(const LinearMap &other) {
+        LOG_ALWAYS_FATAL_IF(mSize != other.mSize, "Mismatched size(%zu)", other.mSize);
+        mPos = other.mPos;
+        mSamples = other.mSamples;
+        mStepValid = other.mStepValid;
+        mExtrapolateTail = other.mExtrapolateTail;
+        memcpy(mX, other.mX, mSize * sizeof(T));
+        memcpy(mY, other.mY, mSize * sizeof(T));
+    }
+
     // find the corresponding X point from a Y point.
     // See findU for details.
     __attribute__((no_sanitize("integer")))
@@ -361,6 +378,91 @@ private:
     T * const       mY;         // History of Y values as a circular array.
 };
 
+/*
+A single writer, multiple reader LinearMap.
+
+The writer thread (e.g. the mixer or driver thread posting position to time
+reference points) calls push() and reset() and never blocks: the sample
+history is published through a sequence counter (seqlock) instead of a mutex.
+Reader threads (e.g. binder threads answering timestamp queries) snapshot the
+history and interpolate on the snapshot with the same findX()/findY() API as
+LinearMap; a reader retries its snapshot if a write overlapped, so a reader
+may briefly spin but can never make the writer wait.
+
+push() and reset() must be called from one thread at a time;
+findX()/findY()/snapshot() may be called concurrently from any thread.
+*/
+template <typename T>
+class LockFreeLinearMap {
+public:
+    using FindMethod = typename LinearMap<T>::FindMethod;
+
+    explicit LockFreeLinearMap(size_t size)
+            : mSize(size),
+              mMap(size) { }
+
+    // Add a new sample point to the linear map (writer thread only).
+    // See LinearMap::push() for the monotonicity and step requirements.
+    void push(T x, T y) {
+        const uint32_t sequence = mSequence.load(std::memory_order_relaxed);
+        mSequence.store(sequence + 1, std::memory_order_relaxed); // odd: write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        mMap.push(x, y);
+        mSequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    // clear all samples (writer thread only).
+    void reset() {
+        const uint32_t sequence = mSequence.load(std::memory_order_relaxed);
+        mSequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        mMap.reset();
+        mSequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    // returns true if the map contains at least one sample.
+    // The single word read needs no snapshot; a concurrent push() or reset()
+    // is reflected by the next call.
+    bool hasData() const {
+        return mMap.hasData();
+    }
+
+    // Copies a consistent view of the sample history into map, which must
+    // have been created with the same size.  Use with a caller owned scratch
+    // map to avoid the allocation of the findX()/findY() convenience below
+    // when making multiple queries against one snapshot.
+    void snapshot(LinearMap<T> &map) const {
+        for (;;) {
+            const uint32_t sequence = mSequence.load(std::memory_order_acquire);
+            if (sequence & 1) continue; // write in progress, retry
+            map.copyStateFrom(mMap);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (mSequence.load(std::memory_order_relaxed) == sequence) return;
+        }
+    }
+
+    // find the corresponding X point from a Y point.
+    // See LinearMap::findU for details.
+    T findX(T y, FindMethod *method = NULL, double extrapolation = 0.0, T startValue = 0) const {
+        LinearMap<T> map(mSize);
+        snapshot(map);
+        return map.findX(y, method, extrapolation, startValue);
+    }
+
+    // find the corresponding Y point from a X point.
+    // See LinearMap::findU for details.
+    T findY(T x, FindMethod *method = NULL, double extrapolation = 0.0, T startValue = 0) const {
+        LinearMap<T> map(mSize);
+        snapshot(map);
+        return map.findY(x, method, extrapolation, startValue);
+    }
+
+private:
+    const size_t           mSize;         // Size of the sample history.
+    LinearMap<T>           mMap;          // Sample history, written by the writer thread only.
+    std::atomic<uint32_t>  mSequence{0};  // Odd while the writer modifies mMap.
+};
+
 } // namespace android
 
 #endif // ANDROID_LINEAR_MAP_H
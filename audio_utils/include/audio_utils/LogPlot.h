@@ -24,6 +24,7 @@
 #include <map>
 #include <sstream>
 #include <string>
+#include <vector>
 
 // TODO Make a class called LogPlot and put this functionality in it.
 // Actually maybe this file can be called AsciiPlot or something...
@@ -112,6 +113,167 @@ std::string audio_utils_log_plot(RandomAccessIterator first, RandomAccessIterato
     return ss.str();
 }
 
+/**
+ * \brief Incremental plotter for live telemetry.
+ *
+ * Keeps a rolling window of at most width points downsampled with the
+ * largest-triangle-three-buckets (LTTB) criterion: incoming samples are
+ * grouped into buckets of bucketSize samples and each completed bucket
+ * contributes the sample forming the largest triangle with the previously
+ * kept point and the mean of the following bucket.  add() is O(1) amortized
+ * and plot() cost is bounded by the window width, independent of how many
+ * samples have been added, unlike audio_utils_log_plot() which walks every
+ * raw point on each call.
+ */
+template <typename T = float>
+class LogPlot {
+public:
+    /**
+     * \param width       maximum number of downsampled points kept (plot columns).
+     * \param bucketSize  number of raw samples represented by one kept point.
+     */
+    explicit LogPlot(size_t width = 200U, size_t bucketSize = 8)
+        : mWidth(std::max(width, (size_t)2))
+        , mBucketSize(std::max(bucketSize, (size_t)1))
+    {
+        mPending.reserve(mBucketSize);
+        mCurrent.reserve(mBucketSize);
+    }
+
+    /**
+     * \brief Adds one sample to the plot.
+     *
+     * \param value  the data value.
+     * \param start  whether the sample starts a new data point in time
+     *               (i.e. a break in time continuity); the marker is kept
+     *               on the bucket's selected point.
+     */
+    void add(T value, bool start = false) {
+        mCurrent.emplace_back(value, start);
+        ++mCount;
+        if (mCurrent.size() < mBucketSize) {
+            return;
+        }
+        // mCurrent is complete and serves as the "next" bucket anchoring the
+        // selection from mPending, which completed one bucket earlier.
+        if (!mPending.empty()) {
+            const size_t index = selectIndex(
+                    currentStartX() + (mCurrent.size() - 1) / 2., currentMeanY());
+            std::pair<T, bool> p = mPending[index];
+            for (const auto &q : mPending) {
+                p.second = p.second || q.second;
+            }
+            pushRing(p);
+            mPrevX = pendingStartX() + index;
+            mPrevY = p.first;
+            mHasPrev = true;
+        }
+        mPending.swap(mCurrent);
+        mCurrent.clear();
+    }
+
+    /** \return the number of downsampled points currently in the window. */
+    size_t size() const {
+        return mRing.size();
+    }
+
+    /**
+     * \brief Renders the current window.
+     *
+     * Points not yet committed to the window (the trailing partial buckets)
+     * are included so the most recent samples always show; state is not
+     * modified.
+     *
+     * \return the std::string of the graph, as audio_utils_log_plot().
+     */
+    std::string plot() const {
+        std::vector<std::pair<T, bool>> points;
+        points.reserve(mRing.size() + 2);
+        for (size_t i = 0; i < mRing.size(); ++i) {
+            points.push_back(mRing[(mHead + i) % mRing.size()]);
+        }
+        if (!mPending.empty()) {
+            size_t index;
+            if (mCurrent.empty()) {
+                index = selectIndex(pendingStartX() + mPending.size() - 1,
+                        mPending.back().first);
+            } else {
+                index = selectIndex(
+                        currentStartX() + (mCurrent.size() - 1) / 2., currentMeanY());
+            }
+            std::pair<T, bool> p = mPending[index];
+            for (const auto &q : mPending) {
+                p.second = p.second || q.second;
+            }
+            points.push_back(p);
+        }
+        if (!mCurrent.empty()) {
+            points.push_back(mCurrent.back());
+        }
+        return audio_utils_log_plot(points.begin(), points.end());
+    }
+
+private:
+    // x coordinates are raw sample indices; buckets are contiguous, so the
+    // bucket start positions follow from the total sample count.
+    double pendingStartX() const {
+        return (double)(mCount - mCurrent.size() - mPending.size());
+    }
+
+    double currentStartX() const {
+        return (double)(mCount - mCurrent.size());
+    }
+
+    double currentMeanY() const {
+        double sum = 0.;
+        for (const auto &p : mCurrent) {
+            sum += p.first;
+        }
+        return sum / mCurrent.size();
+    }
+
+    // Picks the sample of mPending forming the largest triangle with the
+    // previously kept point and the anchor (bx, by).  With no previous point
+    // the bucket's first sample is kept, matching LTTB's keep-first rule.
+    size_t selectIndex(double bx, double by) const {
+        size_t best = 0;
+        if (mHasPrev) {
+            const double x0 = pendingStartX();
+            double bestArea = -1.;
+            for (size_t i = 0; i < mPending.size(); ++i) {
+                const double area = fabs(
+                        (mPrevX - bx) * (mPending[i].first - mPrevY)
+                        - (mPrevX - (x0 + i)) * (by - mPrevY));
+                if (area > bestArea) {
+                    bestArea = area;
+                    best = i;
+                }
+            }
+        }
+        return best;
+    }
+
+    void pushRing(const std::pair<T, bool> &p) {
+        if (mRing.size() < mWidth) {
+            mRing.push_back(p);
+        } else {
+            mRing[mHead] = p;
+            mHead = (mHead + 1) % mWidth;
+        }
+    }
+
+    const size_t mWidth;                        // downsampled window capacity
+    const size_t mBucketSize;                   // raw samples per kept point
+    std::vector<std::pair<T, bool>> mRing;      // kept points, oldest at mHead
+    std::vector<std::pair<T, bool>> mPending;   // last complete bucket
+    std::vector<std::pair<T, bool>> mCurrent;   // bucket being filled
+    size_t mHead = 0;
+    size_t mCount = 0;                          // total samples added
+    double mPrevX = 0.;                         // last kept point, for LTTB
+    double mPrevY = 0.;
+    bool mHasPrev = false;
+};
+
 // determines how many character spaces an integer takes up.
 inline int widthOf(int x) {
     int width = 0;
@@ -18,6 +18,7 @@
 #define ANDROID_AUDIO_METADATA_H
 
 #include <stdint.h>
+#include <string.h>
 #include <sys/cdefs.h>
 #include <unistd.h>
 
@@ -26,6 +27,7 @@
 #include <any>
 #include <map>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <vector>
 
@@ -905,6 +907,289 @@ ByteString byteStringFromData(const Data &data) {
     return bs; // copy elision
 }
 
+/**
+ * Writes the Data map into a caller provided byte string, replacing its
+ * contents.
+ *
+ * The byte string's capacity is retained, so a caller serializing per
+ * buffer can hold one ByteString and stop paying an allocation per parcel
+ * once the string has grown to the working size.
+ *
+ * \param data the Data map to serialize.
+ * \param bs   the byte string to overwrite.
+ * \return true on success, false if the data could not be serialized
+ *         (bs contents are then unspecified).
+ */
+inline
+bool byteStringFromData(const Data &data, ByteString &bs) {
+    bs.clear();
+    return copyToByteString(data, bs);
+}
+
+/**
+ * DataView parses a metadata byte string (a Payload<Data>) in place.
+ *
+ * Unlike dataFromByteString(), no Data map is materialized: a lookup walks
+ * the byte string and reads the one value requested, so hot paths that
+ * extract a few keys per buffer do not allocate.  Since the Keys of a Data
+ * map are serialized in sorted order, a lookup stops at the first key
+ * greater than the one requested.
+ *
+ * The view does not own the byte string, which must outlive it (and any
+ * std::string_view or nested DataView obtained from it).  All accesses are
+ * bounds checked against the view size; a malformed byte string results in
+ * failed lookups, never out of bounds reads.
+ */
+class DataView {
+public:
+    DataView(const uint8_t *data, size_t size) : mData(data), mSize(size) {}
+    explicit DataView(const ByteString &bs) : DataView(bs.data(), bs.size()) {}
+
+    /**
+     * Returns the number of entries, 0 if the byte string is malformed.
+     */
+    size_t size() const {
+        size_t idx = 0;
+        index_size_t entries;
+        if (!read(&entries, idx)) return 0;
+        return entries;
+    }
+
+    /**
+     * Returns true if the key is present (with any value type).
+     */
+    bool contains(const char *key) const {
+        type_size_t type;
+        size_t payloadIdx, payloadSize;
+        return find(key, &type, &payloadIdx, &payloadSize);
+    }
+
+    /**
+     * Reads a primitive value for the key.
+     *
+     * \return false if the key is absent, the value type does not match T,
+     *         or the byte string is malformed (value is then unmodified).
+     */
+    template <typename T>
+    std::enable_if_t<is_primitive_metadata_type_v<T>, bool>
+    get(const char *key, T *value) const {
+        type_size_t type;
+        size_t payloadIdx, payloadSize;
+        if (!find(key, &type, &payloadIdx, &payloadSize)
+                || type != type_as_value<T>
+                || payloadSize != sizeof(T)) {
+            return false;
+        }
+        memcpy(value, mData + payloadIdx, sizeof(T));
+        return true;
+    }
+
+    /**
+     * Reads a string value for the key as a view into the byte string,
+     * without copying.  See get() above for the failure modes.
+     */
+    bool get(const char *key, std::string_view *value) const {
+        type_size_t type;
+        size_t payloadIdx, payloadSize;
+        if (!find(key, &type, &payloadIdx, &payloadSize)
+                || type != type_as_value<std::string>
+                || payloadSize < sizeof(index_size_t)) {
+            return false;
+        }
+        index_size_t length;
+        memcpy(&length, mData + payloadIdx, sizeof(length));
+        if (length != payloadSize - sizeof(length)) return false;
+        *value = std::string_view(
+                (const char *)mData + payloadIdx + sizeof(length), length);
+        return true;
+    }
+
+    /**
+     * Reads a nested Data value for the key as another view, without
+     * materializing the nested map.  See get() above for the failure modes.
+     */
+    bool get(const char *key, DataView *value) const {
+        type_size_t type;
+        size_t payloadIdx, payloadSize;
+        if (!find(key, &type, &payloadIdx, &payloadSize)
+                || type != type_as_value<Data>) {
+            return false;
+        }
+        *value = DataView(mData + payloadIdx, payloadSize);
+        return true;
+    }
+
+private:
+    template <typename... Ts>
+    friend class DataSchema;  // binds to entry offsets through find().
+
+    // bounds checked read of a trivially copyable value at idx, advancing idx.
+    template <typename T>
+    bool read(T *dest, size_t &idx) const {
+        if (idx > mSize || sizeof(T) > mSize - idx) return false;
+        memcpy(dest, mData + idx, sizeof(T));
+        idx += sizeof(T);
+        return true;
+    }
+
+    // Walks the entries for key, returning its Datum type and payload span.
+    // If entryIdx is non-null it receives the offset of the entry header.
+    bool find(const char *key, type_size_t *type,
+            size_t *payloadIdx, size_t *payloadSize,
+            size_t *entryIdx = nullptr) const {
+        const size_t keyLen = strlen(key);
+        size_t idx = 0;
+        index_size_t entries;
+        if (!read(&entries, idx)) return false;
+        for (index_size_t i = 0; i < entries; ++i) {
+            const size_t entryStart = idx;
+            index_size_t entryKeyLen;
+            if (!read(&entryKeyLen, idx)) return false;
+            if (entryKeyLen > mSize - idx) return false;
+            const uint8_t * const entryKey = mData + idx;
+            idx += entryKeyLen;
+            if (!read(type, idx)) return false;
+            datum_size_t datumSize;
+            if (!read(&datumSize, idx)) return false;
+            if (datumSize > mSize - idx) return false;
+            int cmp = memcmp(entryKey, key, entryKeyLen < keyLen ? entryKeyLen : keyLen);
+            if (cmp == 0) cmp = entryKeyLen < keyLen ? -1 : entryKeyLen > keyLen ? 1 : 0;
+            if (cmp == 0) {
+                *payloadIdx = idx;
+                *payloadSize = datumSize;
+                if (entryIdx != nullptr) *entryIdx = entryStart;
+                return true;
+            }
+            if (cmp > 0) return false; // keys are sorted, no match possible.
+            idx += datumSize;
+        }
+        return false;
+    }
+
+    const uint8_t *mData;  // the byte string, not owned.
+    size_t mSize;          // valid bytes at mData.
+};
+
+/**
+ * DataSchema caches the byte string layout for a fixed set of primitive keys,
+ * so steady-state reads are fixed-offset copies.
+ *
+ * A pipeline stage that extracts the same few keys from every buffer pays,
+ * even with DataView, a sorted key walk and a type check per key per buffer.
+ * The layout of the byte string, however, only changes when the producer
+ * changes the key set or resizes a variable-length value: between such
+ * changes every buffer places each value at the same offset.  A DataSchema
+ * is declared once over the keys of interest, bind() parses one byte string
+ * and records each key's payload offset together with a copy of its entry
+ * header, and matches() revalidates a subsequent byte string by comparing
+ * the cached headers in place - a few small memcmps with no walk.  While
+ * matches() holds, get<I>() is a single memcpy from the cached offset.
+ *
+ * The usual per-buffer pattern, rebinding only when the layout changes,
+ * is provided by get(bs, &v0, &v1, ...).
+ *
+ * matches() is a layout check, not a validator: a crafted byte string could
+ * reproduce the cached headers at the cached offsets while meaning something
+ * else.  Offsets never exceed the size checked at bind(), so reads stay in
+ * bounds regardless, but callers parsing untrusted input should use
+ * DataView or dataFromByteString() instead.
+ */
+template <typename... Ts>
+class DataSchema {
+    static_assert(sizeof...(Ts) > 0, "DataSchema requires at least one key");
+    static_assert((is_primitive_metadata_type_v<Ts> && ...),
+            "DataSchema keys must have primitive value types");
+
+public:
+    explicit DataSchema(const CKey<Ts>&... keys) : mNames{keys.getName()...} {}
+
+    /**
+     * Parses the byte string and caches the payload offset of every schema
+     * key, replacing any previous binding.
+     *
+     * \return false if any key is absent, has the wrong value type, or the
+     *         byte string is malformed; the schema is then left unbound.
+     */
+    bool bind(const ByteString &bs) {
+        mBound = false;
+        mHeaders.clear();
+        const DataView view(bs);
+        static constexpr type_size_t types[] = { type_as_value<Ts>... };
+        static constexpr size_t sizes[] = { sizeof(Ts)... };
+        for (size_t i = 0; i < kKeys; ++i) {
+            type_size_t type;
+            size_t entryIdx, payloadIdx, payloadSize;
+            if (!view.find(mNames[i], &type, &payloadIdx, &payloadSize, &entryIdx)
+                    || type != types[i] || payloadSize != sizes[i]) {
+                return false;
+            }
+            mEntryIdx[i] = entryIdx;
+            mHeaderOff[i] = mHeaders.size();
+            mHeaders.append(bs.data() + entryIdx, payloadIdx - entryIdx);
+            mPayloadIdx[i] = payloadIdx;
+        }
+        mSize = bs.size();
+        mBound = true;
+        return true;
+    }
+
+    /**
+     * Returns true if the byte string still has the bound layout, so the
+     * cached offsets (and get()) apply to it.
+     */
+    bool matches(const ByteString &bs) const {
+        if (!mBound || bs.size() != mSize) return false;
+        for (size_t i = 0; i < kKeys; ++i) {
+            if (memcmp(bs.data() + mEntryIdx[i], mHeaders.data() + mHeaderOff[i],
+                    mPayloadIdx[i] - mEntryIdx[i]) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Reads the value of the I-th schema key from a byte string for which
+     * matches() returned true.
+     */
+    template <size_t I>
+    std::tuple_element_t<I, std::tuple<Ts...>> get(const ByteString &bs) const {
+        std::tuple_element_t<I, std::tuple<Ts...>> value;
+        memcpy(&value, bs.data() + mPayloadIdx[I], sizeof(value));
+        return value;
+    }
+
+    /**
+     * Reads all schema values from the byte string, rebinding first if the
+     * layout changed since the last call.
+     *
+     * \return false if rebinding was needed and failed (values are then
+     *         unmodified).
+     */
+    bool get(const ByteString &bs, Ts*... values) {
+        if (!matches(bs) && !bind(bs)) return false;
+        getAll(bs, std::index_sequence_for<Ts...>{}, values...);
+        return true;
+    }
+
+private:
+    static constexpr size_t kKeys = sizeof...(Ts);
+
+    template <size_t... Is>
+    void getAll(const ByteString &bs, std::index_sequence<Is...>,
+            Ts*... values) const {
+        ((*values = get<Is>(bs)), ...);
+    }
+
+    const char *mNames[kKeys];     // schema key names, in declaration order.
+    size_t mEntryIdx[kKeys]{};     // offset of each key's entry header.
+    size_t mPayloadIdx[kKeys]{};   // offset of each key's payload.
+    size_t mHeaderOff[kKeys]{};    // offset of each cached header in mHeaders.
+    ByteString mHeaders;           // concatenated entry headers from bind().
+    size_t mSize = 0;              // total size of the bound byte string.
+    bool mBound = false;
+};
+
 /**
  * \brief Returns the length of the byte string buffer from the raw pointer.
  *
@@ -917,7 +1202,6 @@ ByteString byteStringFromData(const Data &data) {
  * \param byteString       byte string buffer raw pointer.
  * \return size in bytes of metadata in the buffer or 0 if something went wrong.
  */
-
 inline size_t dataByteStringLen(const uint8_t *ptr) {
     index_size_t elements;
     const uint8_t * const origPtr = ptr;
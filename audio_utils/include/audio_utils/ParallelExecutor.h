@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_PARALLEL_EXECUTOR_H
+#define ANDROID_AUDIO_PARALLEL_EXECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace android::audio_utils {
+
+/**
+ * ParallelExecutor fans a block operation out over a persistent worker pool.
+ *
+ * It is aimed at the wide, embarrassingly parallel loops in audio_utils -
+ * per-channel-group mixing (ChannelMix::process) and the sample conversion
+ * kernels in primitives.c / format.c - where a multichannel high-rate chain
+ * otherwise saturates one core.  The work range is split into grains that
+ * the caller and the workers claim from a shared atomic cursor, so a worker
+ * that finishes early takes grains that would have gone to a slower one;
+ * this self-scheduling gives the load balancing of work stealing without
+ * per-thread deques.
+ *
+ * Latency safety: parallelFor() runs the whole range inline on the caller
+ * when it is smaller than minGrain * 2, so small low-latency buffers never
+ * pay the wakeup cost.  The caller always participates in the loop and
+ * parallelFor() returns only when every grain is done, so delivery order
+ * is unchanged.
+ *
+ * The functor receives disjoint [begin, end) subranges and must not carry
+ * sequential state across them (filters with history need ordered frames -
+ * split those by channel group instead, see Pipeline.h for ordered tiling).
+ *
+ * Workers are plain threads; callers that need them on specific cores can
+ * set affinity/priority from onWorkerStart.
+ */
+class ParallelExecutor {
+public:
+    /**
+     * \param threadCount number of pool workers; 0 selects one fewer than
+     *                    the hardware concurrency (the caller is a worker
+     *                    too).  A pool of 0 workers degenerates to inline
+     *                    execution.
+     * \param onWorkerStart optional hook run once on each worker thread at
+     *                    start, for affinity or priority setup.
+     */
+    explicit ParallelExecutor(size_t threadCount = 0,
+            std::function<void(size_t workerIndex)> onWorkerStart = {})
+        : mOnWorkerStart(std::move(onWorkerStart))
+    {
+        if (threadCount == 0) {
+            const unsigned hw = std::thread::hardware_concurrency();
+            threadCount = hw > 1 ? hw - 1 : 0;
+        }
+        mThreads.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; ++i) {
+            mThreads.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ~ParallelExecutor() {
+        {
+            std::lock_guard lg(mLock);
+            mExit = true;
+        }
+        mWake.notify_all();
+        for (auto &t : mThreads) {
+            t.join();
+        }
+    }
+
+    ParallelExecutor(const ParallelExecutor&) = delete;
+    ParallelExecutor& operator=(const ParallelExecutor&) = delete;
+
+    /** Number of pool workers (not counting the calling thread). */
+    size_t threadCount() const { return mThreads.size(); }
+
+    /**
+     * Applies f to disjoint subranges covering [begin, end).
+     *
+     * \param begin    first index of the range (frames, samples or channel
+     *                 groups - the unit is up to the caller).
+     * \param end      one past the last index.
+     * \param minGrain smallest subrange worth dispatching; ranges below
+     *                 2 * minGrain run inline on the caller.
+     * \param f        callable void(size_t subBegin, size_t subEnd).
+     *
+     * Blocks until the whole range is processed.  Not reentrant: a single
+     * parallelFor may be in flight per ParallelExecutor at a time.
+     */
+    template <typename F>
+    void parallelFor(size_t begin, size_t end, size_t minGrain, F&& f) {
+        if (begin >= end) return;
+        if (minGrain == 0) minGrain = 1;
+        if (mThreads.empty() || end - begin < minGrain * 2) {
+            f(begin, end);
+            return;
+        }
+        mCursor.store(begin, std::memory_order_relaxed);
+        mEnd = end;
+        mGrain = minGrain;
+        mTask = [&f](size_t b, size_t e) { f(b, e); };
+        {
+            std::lock_guard lg(mLock);
+            mActiveWorkers = mThreads.size();
+            ++mGeneration;
+        }
+        mWake.notify_all();
+        runGrains();  // the caller works too
+        std::unique_lock ul(mLock);
+        mDone.wait(ul, [this] { return mActiveWorkers == 0; });
+        mTask = nullptr;
+    }
+
+private:
+    void runGrains() {
+        for (;;) {
+            const size_t b = mCursor.fetch_add(mGrain, std::memory_order_relaxed);
+            if (b >= mEnd) break;
+            const size_t e = b + mGrain < mEnd ? b + mGrain : mEnd;
+            mTask(b, e);
+        }
+    }
+
+    void workerLoop(size_t workerIndex) {
+        if (mOnWorkerStart) {
+            mOnWorkerStart(workerIndex);
+        }
+        uint64_t seenGeneration = 0;
+        for (;;) {
+            {
+                std::unique_lock ul(mLock);
+                mWake.wait(ul, [this, seenGeneration] {
+                    return mExit || mGeneration != seenGeneration;
+                });
+                if (mExit) return;
+                seenGeneration = mGeneration;
+            }
+            runGrains();
+            bool last;
+            {
+                std::lock_guard lg(mLock);
+                last = --mActiveWorkers == 0;
+            }
+            if (last) {
+                mDone.notify_one();
+            }
+        }
+    }
+
+    const std::function<void(size_t)> mOnWorkerStart;
+    std::vector<std::thread> mThreads;
+
+    std::mutex mLock;
+    std::condition_variable mWake;
+    std::condition_variable mDone;
+    uint64_t mGeneration = 0;   // bumped per parallelFor to wake workers
+    size_t mActiveWorkers = 0;
+    bool mExit = false;
+
+    // per-call state, valid while a parallelFor is in flight
+    std::atomic<size_t> mCursor{0};
+    size_t mEnd = 0;
+    size_t mGrain = 0;
+    std::function<void(size_t, size_t)> mTask;
+};
+
+}  // namespace android::audio_utils
+
+#endif  // !ANDROID_AUDIO_PARALLEL_EXECUTOR_H
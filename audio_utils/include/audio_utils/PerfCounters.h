@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_PERF_COUNTERS_H
+#define ANDROID_AUDIO_PERF_COUNTERS_H
+
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+/**
+ * Low-overhead performance counters for the libaudioutils hot paths.
+ *
+ * A fixed-slot page of lock-free counters and log2 duration histograms is
+ * compiled in permanently: an update is one relaxed atomic add, cheap enough
+ * to leave on in production.  The library instruments its own hot paths
+ * (FIFO write/read stalls with stall duration, converter bytes, resampler
+ * frames); the slots above the custom base are free for process-local use.
+ *
+ * By default the page lives in static storage.  A process that wants the
+ * counters observable from outside maps a shared memory region (ashmem,
+ * memfd) and calls android::audio_utils::perfCounterAttach(); an external
+ * agent can then read the page without stopping or signalling the audio
+ * process, since readers only perform relaxed loads of monotonic counts.
+ */
+
+/** \cond */
+__BEGIN_DECLS
+/** \endcond */
+
+/** Well-known counter slots.  Values are a running sum since attach/start. */
+enum {
+    AUDIO_UTILS_PERF_COUNTER_FIFO_WRITE_STALLS = 0,  /**< writer futex/sleep waits */
+    AUDIO_UTILS_PERF_COUNTER_FIFO_READ_STALLS  = 1,  /**< reader futex/sleep waits */
+    AUDIO_UTILS_PERF_COUNTER_CONVERTER_BYTES   = 2,  /**< memcpy_by_audio_format output bytes */
+    AUDIO_UTILS_PERF_COUNTER_RESAMPLER_FRAMES  = 3,  /**< resampler output frames */
+    AUDIO_UTILS_PERF_COUNTER_CUSTOM_BASE       = 16, /**< first slot free for callers */
+    AUDIO_UTILS_PERF_COUNTER_COUNT             = 32,
+};
+
+/** Well-known duration histogram slots.  Binned by floor(log2(ns)). */
+enum {
+    AUDIO_UTILS_PERF_HISTOGRAM_FIFO_WRITE_STALL_NS = 0,
+    AUDIO_UTILS_PERF_HISTOGRAM_FIFO_READ_STALL_NS  = 1,
+    AUDIO_UTILS_PERF_HISTOGRAM_CUSTOM_BASE         = 4,
+    AUDIO_UTILS_PERF_HISTOGRAM_COUNT               = 8,
+};
+
+/**
+ * Add amount to the given counter slot.
+ * One relaxed atomic add; out of range slots are ignored.
+ */
+void audio_utils_perf_counter_add(unsigned slot, uint64_t amount);
+
+/**
+ * Record a duration (or other value) in the given histogram slot.
+ * Values <= 0 go in bin 0, otherwise bin floor(log2(value)) + 1.
+ */
+void audio_utils_perf_histogram_add(unsigned slot, int64_t value);
+
+/** \cond */
+__END_DECLS
+/** \endcond */
+
+#ifdef __cplusplus
+
+#include <atomic>
+
+namespace android::audio_utils {
+
+/**
+ * The counter page layout.  Plain standard-layout data with address-free
+ * atomics so a page placed in MAP_SHARED memory is readable from another
+ * process with no synchronization beyond the atomic loads themselves.
+ */
+struct PerfCounterPage {
+    static constexpr uint32_t kMagic = 0x61755043;  // 'auPC'
+    static constexpr uint32_t kVersion = 1;
+    /** bin 0 holds values <= 0, bin b holds [2^(b-1), 2^b) ns */
+    static constexpr size_t kHistogramBins = 64;
+
+    uint32_t magic;
+    uint32_t version;
+    std::atomic<uint64_t> counters[AUDIO_UTILS_PERF_COUNTER_COUNT];
+    struct DurationHistogram {
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> bins[kHistogramBins];
+    } histograms[AUDIO_UTILS_PERF_HISTOGRAM_COUNT];
+};
+
+static_assert(std::is_standard_layout_v<PerfCounterPage>);
+static_assert(std::is_trivially_destructible_v<PerfCounterPage>);
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+/** The page currently receiving updates (never nullptr). */
+PerfCounterPage* perfCounterPage();
+
+/**
+ * Redirect updates to page, typically a freshly mapped shared region.
+ * A page with zero magic is zero-initialized and stamped; a page with a
+ * valid magic (e.g. on re-attach) is left intact so counts accumulate.
+ * Passing nullptr restores the built-in static page.
+ * \return false if the page has a magic/version from an incompatible layout.
+ */
+bool perfCounterAttach(PerfCounterPage* page);
+
+}  // namespace android::audio_utils
+
+#endif  // __cplusplus
+
+#endif  // !ANDROID_AUDIO_PERF_COUNTERS_H
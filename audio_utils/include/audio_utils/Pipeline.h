@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_PIPELINE_H
+#define ANDROID_AUDIO_PIPELINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace android::audio_utils {
+
+/**
+ * Pipeline composes a chain of audio processing stages and executes them
+ * tile by tile instead of buffer by buffer.
+ *
+ * Running N independent stages over a large buffer makes N round trips to
+ * main memory; running them over a tile that fits in the L1/L2 cache keeps
+ * every intermediate result cache resident, so the buffer is read from and
+ * written to memory once regardless of the chain length.
+ *
+ * A stage is any callable with the signature
+ *
+ *     void(void *out, const void *in, size_t frames)
+ *
+ * typically a lambda wrapping an existing audio_utils primitive such as
+ * adjust_channels(), BiquadFilter::process(), Balance::process() or
+ * memcpy_by_audio_format().  A stage is handed the same frame count it
+ * must produce; it may change the frame size (channel count or sample
+ * format), which is why the frame sizes at the pipeline edges and the
+ * largest intermediate frame size are declared at construction.  Stages
+ * that process in place may simply treat out as the buffer when out == in
+ * is documented by the wrapper; Pipeline always hands each stage distinct
+ * input and output pointers, so wrappers for in-place primitives copy
+ * into out first - the copy stays within the tile and is cheap.
+ *
+ * Stateful stages (filters, balance) carry their state in the captured
+ * object and see the frames in order, so results are identical to running
+ * the stages over the whole buffer.
+ *
+ * Use makePipeline() to deduce the stage types:
+ *
+ *     auto pipeline = makePipeline(
+ *             sizeof(int16_t) * 2,     // input frame size
+ *             sizeof(int16_t) * 2,     // output frame size
+ *             sizeof(float) * 2,       // largest intermediate frame size
+ *             [&](void *out, const void *in, size_t frames) { ... },
+ *             ...);
+ *     pipeline.process(dst, src, frames);
+ */
+template <typename... Stages>
+class Pipeline {
+public:
+    /** 512 frames of stereo float is 4KB per intermediate, well inside L1. */
+    static constexpr size_t kDefaultTileFrames = 512;
+
+    Pipeline(size_t inFrameSize, size_t outFrameSize, size_t maxFrameSize,
+            Stages... stages)
+        : Pipeline(kDefaultTileFrames, inFrameSize, outFrameSize, maxFrameSize,
+                std::move(stages)...) {}
+
+    Pipeline(size_t tileFrames, size_t inFrameSize, size_t outFrameSize,
+            size_t maxFrameSize, Stages... stages)
+        : mTileFrames(tileFrames)
+        , mInFrameSize(inFrameSize)
+        , mOutFrameSize(outFrameSize)
+        , mStages(std::move(stages)...)
+    {
+        static_assert(sizeof...(Stages) > 0);
+        // intermediates ping-pong between two preallocated tile buffers
+        if constexpr (sizeof...(Stages) > 1) {
+            mScratch[0].resize(tileFrames * maxFrameSize);
+            mScratch[1].resize(tileFrames * maxFrameSize);
+        } else {
+            (void)maxFrameSize;
+        }
+    }
+
+    /**
+     * Runs the stage chain over frames of interleaved audio.
+     * out and in may only alias if every stage supports in == out
+     * (for a multi-stage pipeline they never see the aliasing, as all
+     * intermediates go through the scratch tiles).
+     */
+    void process(void *out, const void *in, size_t frames) {
+        auto *dst = static_cast<uint8_t *>(out);
+        const auto *src = static_cast<const uint8_t *>(in);
+        while (frames > 0) {
+            const size_t tile = frames < mTileFrames ? frames : mTileFrames;
+            runStage<0>(dst, src, tile);
+            dst += tile * mOutFrameSize;
+            src += tile * mInFrameSize;
+            frames -= tile;
+        }
+    }
+
+private:
+    template <size_t I>
+    void runStage(void *out, const void *in, size_t frames) {
+        if constexpr (I == sizeof...(Stages) - 1) {
+            std::get<I>(mStages)(out, in, frames);
+        } else {
+            void *scratch = mScratch[I & 1].data();
+            std::get<I>(mStages)(scratch, in, frames);
+            runStage<I + 1>(out, scratch, frames);
+        }
+    }
+
+    const size_t mTileFrames;
+    const size_t mInFrameSize;
+    const size_t mOutFrameSize;
+    std::tuple<Stages...> mStages;
+    std::vector<uint8_t> mScratch[2];
+};
+
+/** Deduces the stage types; see Pipeline. */
+template <typename... Stages>
+auto makePipeline(size_t inFrameSize, size_t outFrameSize, size_t maxFrameSize,
+        Stages&&... stages) {
+    return Pipeline<std::decay_t<Stages>...>(inFrameSize, outFrameSize,
+            maxFrameSize, std::forward<Stages>(stages)...);
+}
+
+}  // namespace android::audio_utils
+
+#endif  // !ANDROID_AUDIO_PIPELINE_H
@@ -19,7 +19,10 @@
 
 #ifdef __cplusplus
 
+#include <atomic>
+#include <memory>
 #include <mutex>
+#include <utility>
 #include <vector>
 #include <system/audio.h>
 #include <utils/Errors.h>
@@ -33,8 +36,9 @@ namespace android {
  * and grouped by signals consisting of consecutive non-zero energy bins.
  * The sum energy in dB of each signal is computed for comparison purposes.
  *
- * No distinction is made between channels in an audio frame; they are all
- * summed together for energy purposes.
+ * The channels of an audio frame are summed together for the main history,
+ * and the per-channel energies are additionally kept (up to
+ * kMaxPrecomputeChannels channels) so channel imbalance remains visible.
  *
  * The public methods are internally protected by a mutex to be thread-safe.
  */
@@ -76,7 +80,7 @@ public:
      * \return the std::string for the log.
      */
     std::string dumpToString(const char *prefix = "", size_t lines = 0, int64_t limitNs = 0,
-            bool logPlot = true) const;
+            bool logPlot = true);
 
     /**
      * \brief Dumps the log to a raw file descriptor.
@@ -90,12 +94,176 @@ public:
      *   NO_ERROR on success or a negative number (-errno) on failure of write().
      */
     status_t dump(int fd, const char *prefix = "", size_t lines = 0, int64_t limitNs = 0,
-            bool logPlot = true) const;
+            bool logPlot = true);
+
+    /**
+     * Channel counts up to this bound get the per-channel energy history and
+     * the out-of-lock energy precomputation in log(); beyond it the channels
+     * are summed as before (the bound keeps the scratch off the heap on the
+     * logging thread).
+     */
+    static constexpr uint32_t kMaxPrecomputeChannels = 32;
+
+    /**
+     * \brief Returns a snapshot of the per-channel energy history.
+     *
+     * The result holds one energy per channel per entry, flattened
+     * [entry][channel] and indexed in step with the summed history, so row
+     * i corresponds to the entry at index i.  All zero for channel counts
+     * above kMaxPrecomputeChannels.
+     *
+     * \param idx    if non-null, receives the next write position in entries.
+     * \return the flattened per-channel energies.
+     */
+    std::vector<float> channelEnergies(size_t *idx = nullptr);
+
+    /**
+     * Wait-free entry path.
+     *
+     * A single real-time producer, such as a thread mirroring energy frames
+     * reported by an offload DSP, may append precomputed energies with
+     * logRealtime(), which never takes the log mutex: entries go into a
+     * fixed single-producer single-consumer ring published with a monotonic
+     * sequence, and are folded into the regular history by the next log(),
+     * dump, or explicit foldRealtimeEntries() call.
+     *
+     * Folded entries carry summed energy only, so they do not contribute to
+     * the per-channel imbalance history.  If the ring is full the entry is
+     * dropped and counted in realtimeOverruns(); the producer never blocks.
+     */
+
+    /** Default wait-free ring capacity in entries; see enableRealtimeLog(). */
+    static constexpr size_t kDefaultRealtimeEntries = 256;
+
+    /**
+     * \brief Enables the wait-free entry path.
+     *
+     * Call before the producer starts; enabling is not thread-safe against
+     * a concurrent logRealtime().
+     *
+     * \param capacity          ring capacity in entries, rounded up to a
+     *                          power of two, 0 for the default.
+     * \return NO_ERROR on success, NO_MEMORY if the ring cannot be allocated.
+     */
+    status_t enableRealtimeLog(size_t capacity = kDefaultRealtimeEntries);
+
+    /**
+     * \brief Appends precomputed energy to the log, wait-free.
+     *
+     * At most one thread may be the producer.  A no-op (not an error) if
+     * enableRealtimeLog() has not been called.
+     *
+     * \param energy            normalized energy, summed over all channels
+     *                          and frames of the block.
+     * \param frames            number of audio frames the energy covers.
+     * \param nowNs             time of the first frame in nanoseconds.
+     */
+    void logRealtime(float energy, size_t frames, int64_t nowNs);
+
+    /**
+     * \brief Folds pending wait-free entries into the history (consumer side).
+     *
+     * Called implicitly by log() and the dump methods; call explicitly to
+     * bound the staleness of the history between dumps.
+     */
+    void foldRealtimeEntries();
+
+    /**
+     * \return number of wait-free entries dropped because the ring was full.
+     */
+    uint32_t realtimeOverruns() const;
+
+    /**
+     * Shared-memory export.
+     *
+     * The writer may attach a caller-mapped region (e.g. ashmem shared with an
+     * observer process) with setSharedRegion().  Each completed entry is then
+     * also published into the region under a single-writer seqlock, so an
+     * observer samples recent power history with readSharedRegion() without
+     * taking the PowerLog lock or stalling the logging thread.
+     */
+
+    /** One entry of the exported history ring. */
+    struct SharedEntry {
+        int64_t timeNs;  // real time ns, 0 if unused
+        float energy;    // normalized energy, 0 terminates a signal
+        float reserved;
+    };
+
+    /** Header of the shared region, followed by entries SharedEntry's. */
+    struct SharedHeader {
+        uint32_t version;                // layout version, kSharedVersion
+        std::atomic<uint32_t> sequence;  // seqlock: odd while the writer updates
+        uint32_t entries;                // capacity of the history ring
+        uint32_t idx;                    // next write position in the ring
+        uint32_t sampleRate;
+        uint32_t channelCount;
+        uint32_t format;                 // audio_format_t
+        uint32_t framesPerEntry;
+    };
+
+    static constexpr uint32_t kSharedVersion = 1;
+
+    /** \return the region size in bytes needed to export a ring of entries. */
+    static constexpr size_t sharedSize(size_t entries) {
+        return sizeof(SharedHeader) + entries * sizeof(SharedEntry);
+    }
+
+    /**
+     * \brief Attaches (or with nullptr detaches) a shared region for export.
+     *
+     * The caller keeps the region mapped for the life of the PowerLog.
+     *
+     * \param shared            region of at least sharedSize(entries) bytes.
+     * \param size              mapped size of the region in bytes.
+     * \return NO_ERROR on success, BAD_VALUE if the region is too small.
+     */
+    status_t setSharedRegion(void *shared, size_t size);
+
+    /**
+     * \brief Snapshots the history ring from a shared region (observer side).
+     *
+     * Lock-free: retries while the writer is mid-update and never blocks it.
+     *
+     * \param shared            region attached by the writer with setSharedRegion().
+     * \param size              mapped size of the region in bytes.
+     * \param entries           receives the history ring (cleared first).
+     * \param idx               receives the writer's next write position.
+     * \return true if a consistent snapshot was taken.
+     */
+    static bool readSharedRegion(const void *shared, size_t size,
+            std::vector<std::pair<int64_t /* real time ns */, float /* energy */>> *entries,
+            size_t *idx);
 
 private:
+    /** One entry of the wait-free producer ring. */
+    struct RealtimeEntry {
+        int64_t timeNs;   // time of the first frame
+        float energy;     // normalized energy, summed over channels and frames
+        uint32_t frames;  // number of frames the energy covers
+    };
+
+    // completes the accumulated current entry into mEntries, with the
+    // zero-termination, per-channel and shared-region publication handling.
+    // Must be called with mLock held.
+    void completeEntry_l(int64_t nowNs);
+
+    // folds pending wait-free ring entries into the history.
+    // Must be called with mLock held (the fold is the single consumer).
+    void foldRealtimeEntries_l();
+
+    // publishes mEntries[entryIdx] and mIdx into the shared region, if attached.
+    // Must be called with mLock held (single writer for the seqlock).
+    void publishEntry(size_t entryIdx);
+
+    static SharedEntry *sharedEntries(SharedHeader *header) {
+        return reinterpret_cast<SharedEntry *>(header + 1);
+    }
     mutable std::mutex mLock;     // monitor mutex
     int64_t mCurrentTime;         // time of first frame in buffer
     float mCurrentEnergy;         // local energy accumulation
+    std::vector<float> mCurrentChannelEnergy; // per-channel part of mCurrentEnergy,
+                                  // empty above kMaxPrecomputeChannels channels
     size_t mCurrentFrames;        // number of frames in the energy
     size_t mIdx;                  // next usable index in mEntries
     size_t mConsecutiveZeroes;    // current run of consecutive zero entries
@@ -104,6 +272,16 @@ private:
     const audio_format_t mFormat; // audio data format
     const size_t mFramesPerEntry; // number of audio frames per entry
     std::vector<std::pair<int64_t /* real time ns */, float /* energy */>> mEntries;
+    std::vector<float> mChannelEnergies; // per-channel history, [entry][channel]
+                                  // flattened in step with mEntries
+    SharedHeader *mShared = nullptr; // export region, nullptr if not attached
+
+    // Wait-free entry path; see enableRealtimeLog().
+    std::unique_ptr<RealtimeEntry[]> mRealtimeRing; // SPSC ring, nullptr if not enabled
+    uint32_t mRealtimeMask = 0;               // ring capacity - 1 (capacity a power of two)
+    std::atomic<uint32_t> mRealtimeRear{0};   // monotonic sequence, advanced by the producer
+    std::atomic<uint32_t> mRealtimeFront{0};  // advanced by the consumer under mLock
+    std::atomic<uint32_t> mRealtimeOverruns{0}; // entries dropped with the ring full
 };
 
 } // namespace android
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_UTILS_RAMP_GENERATOR_H
+#define ANDROID_AUDIO_UTILS_RAMP_GENERATOR_H
+
+#include <stddef.h>
+#include <vector>
+
+namespace android::audio_utils {
+
+/**
+ * \brief Per channel gain ramping for zipper noise free volume changes.
+ *
+ * RampGenerator steps a vector of per channel gains toward a target, either
+ * linearly over a fixed number of frames or exponentially with a one-pole
+ * time constant, and applies the gains to interleaved audio data.
+ *
+ * While ramping, the gains are held constant over blocks of kRampBlockFrames
+ * frames and step between blocks, so the per sample work stays a plain gain
+ * vector multiply that vectorizes; the per frame recursion only runs once per
+ * block. This is the same block ramp used by Balance.
+ *
+ * The class is not thread safe; callers sharing an instance must lock.
+ */
+class RampGenerator {
+public:
+    explicit RampGenerator(size_t channelCount = 0) {
+        setChannelCount(channelCount);
+    }
+
+    /**
+     * \brief Sets the number of channels of the gain vector.
+     *
+     * Resets all gains to unity and cancels any ramp in progress.
+     * A channel count of 0 means no processing is done.
+     *
+     * \param channelCount the number of channels of the interleaved data.
+     */
+    void setChannelCount(size_t channelCount);
+
+    /** \brief Returns the current channel count. */
+    size_t getChannelCount() const {
+        return mChannelCount;
+    }
+
+    /**
+     * \brief Sets the gains immediately, cancelling any ramp in progress.
+     *
+     * \param gains getChannelCount() gains, one per channel.
+     */
+    void setGains(const float *gains);
+
+    /** \brief Sets all channels to the same gain immediately. */
+    void setGain(float gain);
+
+    /**
+     * \brief Starts a linear ramp from the current gains to targets.
+     *
+     * The gain of frame i is start + (target - start) * i / rampFrames,
+     * reaching the target after rampFrames frames have been consumed by
+     * fill() or process(). A rampFrames of 0 sets the targets immediately.
+     *
+     * \param targets    getChannelCount() target gains, one per channel.
+     * \param rampFrames number of frames over which to reach the targets.
+     */
+    void rampLinear(const float *targets, size_t rampFrames);
+
+    /** \brief Linear ramp of all channels to the same target gain. */
+    void rampLinear(float target, size_t rampFrames);
+
+    /**
+     * \brief Starts an exponential approach of the targets.
+     *
+     * The gains follow the one-pole recursion g += (target - g) * alpha
+     * per frame with alpha = 1 - exp(-1 / timeConstantFrames), covering
+     * about 63% of the remaining distance every timeConstantFrames frames.
+     * The ramp snaps to the targets and completes once every gain is
+     * within kRampEpsilon of its target. A time constant of 0 or less
+     * sets the targets immediately.
+     *
+     * \param targets            getChannelCount() target gains per channel.
+     * \param timeConstantFrames the time constant of the approach in frames.
+     */
+    void rampExponential(const float *targets, float timeConstantFrames);
+
+    /** \brief Exponential approach of all channels to the same target gain. */
+    void rampExponential(float target, float timeConstantFrames);
+
+    /** \brief Returns true if a ramp is in progress. */
+    bool isRamping() const {
+        return mState != RAMP_NONE;
+    }
+
+    /** \brief Returns the current per channel gains. */
+    const std::vector<float>& getGains() const {
+        return mGains;
+    }
+
+    /**
+     * \brief Fills interleaved per frame gain vectors and advances the ramp.
+     *
+     * Writes frames * getChannelCount() gains, the gain of every channel of
+     * every frame, for call sites that fuse the gain into their own loop
+     * (e.g. combined with a blend or mix).
+     *
+     * \param gains     pointer to frames * getChannelCount() floats to fill.
+     * \param frames    number of frames of gains to generate.
+     */
+    void fill(float *gains, size_t frames);
+
+    /**
+     * \brief Multiplies the audio data by the gains and advances the ramp.
+     *
+     * While ramping, the gains are constant over kRampBlockFrames frame
+     * blocks; once the ramp completes (or if none is active) a single
+     * vectorized pass applies the settled gains.
+     *
+     * \param buffer    pointer to the audio data to be modified in-place.
+     * \param frames    number of frames of audio data to process.
+     */
+    void process(float *buffer, size_t frames);
+
+    /**
+     * \brief Multiplies each frame by the per channel gain vector.
+     *
+     * Dispatches to fixed channel count loops for common channel counts
+     * so the multiplies vectorize. Exposed for call sites that manage
+     * gain state of their own (e.g. Balance's non-ramped path).
+     *
+     * \param buffer       pointer to the audio data to be modified in-place.
+     * \param frames       number of frames of audio data to process.
+     * \param gains        channelCount gains applied to each frame.
+     * \param channelCount the number of channels of the interleaved data.
+     */
+    static void applyGains(float *buffer, size_t frames, const float *gains,
+            size_t channelCount);
+
+    /** \brief Number of frames sharing one gain step when ramping. */
+    static constexpr size_t kRampBlockFrames = 8;
+
+    /** \brief Gain error at which an exponential ramp snaps to its target. */
+    static constexpr float kRampEpsilon = 1e-4f;
+
+private:
+    /** \brief Steps mGains forward by frames and retires a finished ramp. */
+    void advance(size_t frames);
+
+    enum State {
+        RAMP_NONE,        // gains are settled.
+        RAMP_LINEAR,      // stepping from mStartGains to mTargets.
+        RAMP_EXPONENTIAL, // one-pole approach of mTargets.
+    };
+
+    size_t mChannelCount = 0;
+    State mState = RAMP_NONE;
+    std::vector<float> mGains;      // current gains (the next frame to generate).
+    std::vector<float> mStartGains; // linear: gains at the start of the segment.
+    std::vector<float> mTargets;    // gains at the end of the ramp.
+    size_t mRampFrames = 0;         // linear: total frames of the segment.
+    size_t mFrame = 0;              // linear: frames consumed so far.
+    float mAlpha = 0.f;             // exponential: per frame coefficient.
+    std::vector<float> mScratch;    // scratch for the single gain overloads.
+};
+
+} // namespace android::audio_utils
+
+#endif // !ANDROID_AUDIO_UTILS_RAMP_GENERATOR_H
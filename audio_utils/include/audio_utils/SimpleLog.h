@@ -17,15 +17,19 @@
 #ifndef ANDROID_AUDIO_SIMPLE_LOG_H
 #define ANDROID_AUDIO_SIMPLE_LOG_H
 
+#include <algorithm>
+#include <atomic>
 #include <deque>
 #include <mutex>
-#include <sstream>
 #include <stdint.h>
+#include <string.h>
 #include <string>
 #include <unistd.h>
+#include <vector>
 #include <utils/Errors.h>
 
 #include <audio_utils/clock.h>
+#include <audio_utils/string.h>
 
 namespace android {
 
@@ -160,7 +164,6 @@ public:
             lines = mLog.size();
         }
 
-        std::stringstream ss;
         std::lock_guard<std::mutex> guard(mLock);
         auto it = mLog.begin();
 
@@ -168,13 +171,17 @@ public:
         if (mLog.size() > lines) {
             it += (mLog.size() - lines);
         }
+        // fixed-capacity writer: a dump during bugreport collection must not
+        // reallocate while audio threads are running.
+        audio_utils::dump_buffer<> buf(std::min(lines, mLog.size())
+                * (strlen(prefix) + kMaxDumpLineLength));
         for (; it != mLog.end(); ++it) {
             const int64_t time = it->first;
             if (time < limitNs) continue;  // too old
-            ss << prefix << audio_utils_time_string_from_ns(time).time
-                    << " " << it->second.c_str() << "\n";
+            buf.appendf("%s%s %s\n", prefix,
+                    audio_utils_time_string_from_ns(time).time, it->second.c_str());
         }
-        return ss.str();
+        return {buf.c_str(), buf.size()};
     }
 
     /**
@@ -203,11 +210,247 @@ private:
     mutable std::mutex mLock;
     static const size_t kMaxStringLength = 1024;  // maximum formatted string length
     static const size_t kDefaultMaxLogLines = 80; // default maximum log history
+    // bound on one dump line: timestamp plus text, excluding the caller's prefix
+    static const size_t kMaxDumpLineLength = kMaxStringLength + 32;
 
     const size_t mMaxLogLines;                    // maximum log history
     std::deque<std::pair<int64_t, std::string>> mLog; // circular buffer is backed by deque.
 };
 
+/**
+ * WaitFreeSimpleLog is a SimpleLog variant safe for SCHED_FIFO (real-time)
+ * threads: Writer::log() never takes a lock, allocates, or otherwise blocks,
+ * so logging cannot priority-invert against a dump in progress.
+ *
+ * Each writer owns a preallocated ring of fixed-size text entries, entries
+ * carry a global sequence number, and the rings are merged in logging order
+ * only at dump time.  Obtain one Writer per logging thread with
+ * createWriter() during setup (createWriter() itself is lock-free but not
+ * intended for the hot path).
+ *
+ * Formatted logs are truncated at kMaxEntryLength - 1 due to null
+ * termination, a tighter limit than SimpleLog since the entry storage is
+ * preallocated.  Entries are protected by a per-entry sequence word acting
+ * as a seqlock: the dumping thread retries or skips entries the writer is
+ * updating, and never delays the writer.
+ */
+class WaitFreeSimpleLog {
+private:
+    static const size_t kMaxEntryLength = 256;    // maximum string length plus null.
+
+    struct Entry {
+        // 0 means unused, kBusy means the writer is updating, otherwise the
+        // global logging order of the entry (a seqlock validity check).
+        std::atomic<uint64_t> mSequence{0};
+        int64_t mTimeNs;
+        char mText[kMaxEntryLength];
+    };
+
+    static constexpr uint64_t kBusy = UINT64_MAX;
+    static constexpr int kMaxReadRetries = 3;
+    // bound on one dump line: timestamp plus text, excluding the caller's prefix
+    static constexpr size_t kMaxDumpLineLength = kMaxEntryLength + 32;
+
+public:
+    class Writer;
+
+    /**
+     * \brief Creates a WaitFreeSimpleLog object.
+     *
+     * \param linesPerWriter the maximum number of log lines for each writer.
+     * \param maxWriters     the number of writers preallocated.
+     */
+    explicit WaitFreeSimpleLog(
+            size_t linesPerWriter = kDefaultMaxLogLines, size_t maxWriters = 4)
+        : mWriters(maxWriters)
+    {
+        for (auto &writer : mWriters) {
+            writer.mLog = this;
+            writer.mEntries = std::vector<Entry>(linesPerWriter);
+        }
+    }
+
+    /**
+     * \brief Assigns a preallocated writer, typically one per logging thread.
+     *
+     * Lock-free, but intended for thread setup rather than the hot path.
+     *
+     * \return the writer, or nullptr if maxWriters are already assigned.
+     */
+    Writer *createWriter()
+    {
+        const size_t idx = mNumWriters.fetch_add(1, std::memory_order_relaxed);
+        return idx < mWriters.size() ? &mWriters[idx] : nullptr;
+    }
+
+    class Writer {
+        friend class WaitFreeSimpleLog;
+    public:
+        /**
+         * \brief Adds a formatted string into this writer's ring; wait-free.
+         *
+         * A writer must be used by a single thread at a time.
+         *
+         * \param nowNs             the time to use for logging.  If -1, then
+         *                          audio_utils_get_real_time_ns() is called.
+         * \param format            the format string, similar to printf().
+         *
+         * and optional arguments.
+         */
+        // using C++11 unified attribute syntax; index is offset by 1 for implicit "this".
+        [[gnu::format(printf, 3 /* string-index */, 4 /* first-to-check */)]]
+        void log(int64_t nowNs, const char *format, ...)
+        {
+            va_list args;
+            va_start(args, format);
+            logv(nowNs, format, args);
+            va_end(args);
+        }
+
+        /**
+         * \brief Adds a formatted string by va_list with time.  Not intended for typical use.
+         *
+         * \param nowNs             the time to use for logging.  If -1, then
+         *                          audio_utils_get_real_time_ns() is called.
+         * \param format            the format string, similar to printf().
+         * \param args              va_list args.
+         */
+        void logv(int64_t nowNs, const char *format, va_list args)
+        {
+            if (nowNs == -1) {
+                nowNs = audio_utils_get_real_time_ns();
+            }
+            if (mValid && ++mIdx >= mEntries.size()) {
+                mIdx = 0;
+            }
+            Entry &entry = mEntries[mIdx];
+            entry.mSequence.store(kBusy, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            entry.mTimeNs = nowNs;
+            // format directly into the preallocated entry storage.
+            int length = vsnprintf(entry.mText, sizeof(entry.mText), format, args);
+            if (length < 0) { // encoding error
+                strcpy(entry.mText, "invalid format");
+            } else {
+                if (length >= (signed)sizeof(entry.mText)) {
+                    length = sizeof(entry.mText) - 1;
+                }
+                // strip out trailing newlines
+                while (length > 0 && entry.mText[length - 1] == '\n') {
+                    entry.mText[--length] = '\0';
+                }
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+            entry.mSequence.store(
+                    mLog->mNextSequence.fetch_add(1, std::memory_order_relaxed),
+                    std::memory_order_release);
+            mValid = true;
+        }
+
+    private:
+        WaitFreeSimpleLog *mLog = nullptr;
+        std::vector<Entry> mEntries;  // ring, written only by the owning thread.
+        size_t mIdx = 0;              // current index into mEntries (active)
+        bool mValid = false;          // true once the first entry is written.
+    };
+
+    /**
+     * \brief Dumps the merged log to a string.
+     *
+     * Entries from all writers are merged in logging (sequence) order.
+     * Entries being updated concurrently may be skipped; the writers are
+     * never delayed.
+     *
+     * \param prefix            the prefix to use for each line
+     *                          (generally a null terminated string of spaces).
+     * \param lines             maximum number of lines to output (0 disables).
+     * \param limitNs           limit dump to data more recent than limitNs (0 disables).
+     * \return a string object for the log.
+     */
+    std::string dumpToString(const char *prefix = "", size_t lines = 0, int64_t limitNs = 0) const
+    {
+        struct Snapshot {
+            uint64_t mSequence;
+            int64_t mTimeNs;
+            char mText[kMaxEntryLength];
+        };
+        std::vector<Snapshot> snapshots;
+        for (const auto &writer : mWriters) {
+            for (const auto &entry : writer.mEntries) {
+                for (int retry = 0; retry < kMaxReadRetries; ++retry) {
+                    const uint64_t sequence = entry.mSequence.load(std::memory_order_acquire);
+                    if (sequence == 0) {
+                        break; // unused
+                    }
+                    if (sequence == kBusy) {
+                        continue; // writer mid-update
+                    }
+                    Snapshot snapshot;
+                    snapshot.mSequence = sequence;
+                    snapshot.mTimeNs = entry.mTimeNs;
+                    memcpy(snapshot.mText, entry.mText, sizeof(snapshot.mText));
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (entry.mSequence.load(std::memory_order_relaxed) == sequence) {
+                        snapshot.mText[sizeof(snapshot.mText) - 1] = '\0'; // if torn, terminated
+                        snapshots.push_back(snapshot);
+                        break;
+                    }
+                }
+            }
+        }
+        std::sort(snapshots.begin(), snapshots.end(),
+                [](const Snapshot &lhs, const Snapshot &rhs) {
+                    return lhs.mSequence < rhs.mSequence;
+                });
+
+        if (lines == 0) {
+            lines = snapshots.size();
+        }
+        size_t offset = 0;
+        // Note: this restricts the lines before checking the time constraint.
+        if (snapshots.size() > lines) {
+            offset = snapshots.size() - lines;
+        }
+        // fixed-capacity writer, sized once; see SimpleLog::dumpToString()
+        audio_utils::dump_buffer<> buf((snapshots.size() - offset)
+                * (strlen(prefix) + kMaxDumpLineLength));
+        for (; offset < snapshots.size(); ++offset) {
+            const auto &snapshot = snapshots[offset];
+            if (snapshot.mTimeNs < limitNs) continue;  // too old
+            buf.appendf("%s%s %s\n", prefix,
+                    audio_utils_time_string_from_ns(snapshot.mTimeNs).time, snapshot.mText);
+        }
+        return {buf.c_str(), buf.size()};
+    }
+
+    /**
+     * \brief Dumps the merged log to a raw file descriptor.
+     *
+     * \param fd                file descriptor to use.
+     * \param prefix            the prefix to use for each line
+     *                          (generally a null terminated string of spaces).
+     * \param lines             maximum number of lines to output (0 disables).
+     * \param limitNs           limit dump to data more recent than limitNs (0 disables).
+     * \return
+     *   NO_ERROR on success or a negative number (-errno) on failure of write().
+     */
+    status_t dump(int fd, const char *prefix = "", size_t lines = 0, int64_t limitNs = 0) const
+    {
+        const std::string s = dumpToString(prefix, lines, limitNs);
+        if (s.size() > 0 && write(fd, s.c_str(), s.size()) < 0) {
+            return -errno;
+        }
+        return NO_ERROR;
+    }
+
+private:
+    static const size_t kDefaultMaxLogLines = 80; // default maximum log history per writer
+
+    std::atomic<uint64_t> mNextSequence{1}; // logging order of the next new entry.
+    std::atomic<size_t> mNumWriters{0};     // writers assigned by createWriter().
+    std::vector<Writer> mWriters;           // preallocated per-thread rings.
+};
+
 } // namespace android
 
 #endif // !ANDROID_AUDIO_SIMPLE_LOG_H
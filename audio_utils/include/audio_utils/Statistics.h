@@ -24,6 +24,7 @@
 #include "variadic_utils.h"
 
 // variadic_utils already contains stl headers; in addition:
+#include <algorithm> // for QuantileEstimator sort
 #include <deque> // for ReferenceStatistics implementation
 #include <sstream>
 
@@ -243,6 +244,27 @@ public:
  * https://en.wikipedia.org/wiki/Kahan_summation_algorithm
  */
 
+/**
+ * Return the alpha whose exponential weighting is equivalent to a rectangular
+ * window of the given length.
+ *
+ * Equivalence is by steady-state total weight: sum_{k=0}^inf alpha^k = 1/(1 - alpha),
+ * so alpha = 1 - 1/windowLength gives the same total weight as windowLength
+ * equally-weighted samples, and the statistics track the input with roughly the
+ * same responsiveness as a windowLength-sample moving average.
+ *
+ * This removes the trial and error from choosing smoothing constants: express the
+ * averaging interval in samples (e.g. seconds * sample rate of the metered signal)
+ * and convert, at compile time if the interval is fixed.
+ *
+ * \param windowLength equivalent rectangular window length in samples, >= 1.
+ * \return alpha in [0, 1), suitable for the Statistics constructor or setAlpha().
+ */
+template <typename A = double>
+constexpr A alphaFromWindowLength(size_t windowLength) {
+    return windowLength <= 1 ? A(0.) : A(1.) - A(1.) / A(windowLength);
+}
+
 template <
     typename T,               // input data type
     typename D = double,      // output mean data type
@@ -271,25 +293,45 @@ public:
         mAlpha = alpha;
     }
 
+    /**
+     * Use rectangular weighting (alpha == 1) for the first \p samples samples,
+     * then switch to the configured alpha.
+     *
+     * The weight-normalized estimates here are unbiased from the first sample
+     * either way, but with alpha < 1 the early estimates lean on very few
+     * effectively-independent samples (see getEffectiveCount()).  Weighting the
+     * startup window equally minimizes the estimator variance while it fills,
+     * so metering settles at stream start as fast as the sample count allows;
+     * once \p samples have been seen the exponential weighting takes over.
+     * Pairs naturally with alphaFromWindowLength(): pass the same length.
+     *
+     * \param samples startup window length in samples, or 0 (the default) to
+     *                apply the configured alpha from the first sample.
+     */
+    constexpr void setStartupWindow(int64_t samples) {
+        mStartupWindow = samples;
+    }
+
     constexpr void add(const T &value) {
         // Note: fastest implementation uses fmin fminf but would not be constexpr
 
+        const A alpha = mN < mStartupWindow ? A(1.) : mAlpha;
         mMax = audio_utils::max(mMax, value); // order important: reject NaN
         mMin = audio_utils::min(mMin, value); // order important: reject NaN
         ++mN;
         const D delta = value - mMean;
-        /* if (mAlpha == 1.) we have Welford's algorithm
+        /* if (alpha == 1.) we have Welford's algorithm
             ++mN;
             mMean += delta / mN;
             mM2 += delta * (value - mMean);
 
             Note delta * (value - mMean) should be non-negative.
         */
-        mWeight = A(1.) + mAlpha * mWeight;
-        mWeight2 = A(1.) + mAlpha * mAlpha * mWeight2;
+        mWeight = A(1.) + alpha * mWeight;
+        mWeight2 = A(1.) + alpha * alpha * mWeight2;
         D meanDelta = delta / mWeight;
         mMean += meanDelta;
-        mM2 = mAlpha * mM2 + PRODUCT()(delta, (value - mMean));
+        mM2 = alpha * mM2 + PRODUCT()(delta, (value - mMean));
 
         /*
            Alternate variant related to:
@@ -306,6 +348,32 @@ public:
         */
     }
 
+    /**
+     * Add a block of samples.
+     *
+     * Equivalent to calling add() on each element (up to rounding), but with
+     * rectangular weighting (alpha == 1) the block is accumulated with plain
+     * sum and sum of squared deviation loops that carry no serial dependency
+     * per sample, so the compiler may vectorize them; the block is then
+     * merged into the running state through the compensated (Kahan/Neumaier)
+     * mean summation.  With alpha != 1 each sample has a distinct weight and
+     * this reduces to the per-element add().
+     */
+    constexpr void add(const T *data, size_t count) {
+        if (!(mAlpha == A(1.))) {
+            for (size_t i = 0; i < count; ++i) {
+                add(data[i]);
+            }
+            return;
+        }
+        // Process in chunks that stay cache resident, as the squared
+        // deviation pass rereads the chunk.
+        constexpr size_t kBlock = 256;
+        for (size_t i = 0; i < count; i += kBlock) {
+            addBlock(data + i, std::min(count - i, kBlock));
+        }
+    }
+
     constexpr int64_t getN() const {
         return mN;
     }
@@ -324,6 +392,20 @@ public:
         return mWeight;
     }
 
+    /**
+     * Return the effective (Kish) sample size of the current estimates,
+     * (sum of weights)^2 / (sum of squared weights).
+     *
+     * With rectangular weighting this equals getN(); with exponential weighting
+     * it rises from 1 towards the steady-state (1 + alpha) / (1 - alpha).
+     * Useful for gating decisions on young statistics at stream start: an
+     * estimate backed by an effective count of 3 is worth 3 independent
+     * samples no matter how many were actually folded in.
+     */
+    constexpr A getEffectiveCount() const {
+        return mN == 0 ? A(0.) : mWeight * mWeight / mWeight2;
+    }
+
     constexpr D getMean() const {
         return mMean;
     }
@@ -379,7 +461,74 @@ public:
     }
 
 private:
+    // Merges one block (alpha == 1 only) by the parallel variance combination:
+    // https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance#Parallel_algorithm
+    //
+    // Each pass accumulates into kLanes independent lanes, so the reductions
+    // carry no loop-wide serial dependency and the compiler may emit SIMD
+    // without being allowed to reassociate a single floating point sum.
+    // The lanes are combined pairwise afterwards, which also keeps the
+    // result independent of the vector width chosen by the compiler.
+    constexpr void addBlock(const T *data, size_t count) {
+        if (count == 0) return;
+        constexpr size_t kLanes = 4;
+        T lanesMin[kLanes] = { StatisticsConstants<T>::positiveInfinity(),
+                               StatisticsConstants<T>::positiveInfinity(),
+                               StatisticsConstants<T>::positiveInfinity(),
+                               StatisticsConstants<T>::positiveInfinity() };
+        T lanesMax[kLanes] = { StatisticsConstants<T>::negativeInfinity(),
+                               StatisticsConstants<T>::negativeInfinity(),
+                               StatisticsConstants<T>::negativeInfinity(),
+                               StatisticsConstants<T>::negativeInfinity() };
+        D sums[kLanes] = {};
+        size_t i = 0;
+        for (; i + kLanes <= count; i += kLanes) {
+            for (size_t j = 0; j < kLanes; ++j) {
+                lanesMax[j] = audio_utils::max(lanesMax[j], data[i + j]); // reject NaN
+                lanesMin[j] = audio_utils::min(lanesMin[j], data[i + j]); // reject NaN
+                sums[j] += D(data[i + j]);
+            }
+        }
+        for (; i < count; ++i) {
+            lanesMax[0] = audio_utils::max(lanesMax[0], data[i]); // reject NaN
+            lanesMin[0] = audio_utils::min(lanesMin[0], data[i]); // reject NaN
+            sums[0] += D(data[i]);
+        }
+        const T blockMin = audio_utils::min(
+                audio_utils::min(lanesMin[0], lanesMin[1]),
+                audio_utils::min(lanesMin[2], lanesMin[3]));
+        const T blockMax = audio_utils::max(
+                audio_utils::max(lanesMax[0], lanesMax[1]),
+                audio_utils::max(lanesMax[2], lanesMax[3]));
+        const D sum = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+        const D blockMean = sum / A(count);
+        D2 m2s[kLanes] = {};
+        i = 0;
+        for (; i + kLanes <= count; i += kLanes) {
+            for (size_t j = 0; j < kLanes; ++j) {
+                const D deviation = D(data[i + j]) - blockMean;
+                m2s[j] = m2s[j] + PRODUCT()(deviation, deviation);
+            }
+        }
+        for (; i < count; ++i) {
+            const D deviation = D(data[i]) - blockMean;
+            m2s[0] = m2s[0] + PRODUCT()(deviation, deviation);
+        }
+        const D2 blockM2 = (m2s[0] + m2s[1]) + (m2s[2] + m2s[3]);
+        mMax = audio_utils::max(mMax, blockMax);
+        mMin = audio_utils::min(mMin, blockMin);
+        const int64_t newN = mN + count;
+        const D delta = blockMean - mMean;
+        const D meanDelta = delta / (A(newN) / A(count));
+        mMean += meanDelta;
+        mM2 = mM2 + blockM2 + (A(mN) / A(newN) * A(count)) * PRODUCT()(delta, delta);
+        mN = newN;
+        mWeight = mWeight + A(count);
+        mWeight2 = mWeight2 + A(count);
+    }
+
     A mAlpha;
+    int64_t mStartupWindow = 0;  // rectangular weighting until mN reaches this; see setStartupWindow()
     T mMin{StatisticsConstants<T>::positiveInfinity()};
     T mMax{StatisticsConstants<T>::negativeInfinity()};
 
@@ -546,6 +695,202 @@ private:
     }
 };
 
+/**
+ * QuantileEstimator is a bounded-memory streaming quantile sketch, a
+ * simplified single-buffer variant of the merging t-digest:
+ *
+ * https://arxiv.org/abs/1902.04023
+ *
+ * Incoming samples are staged in a small buffer; every BUFFERED samples the
+ * buffer is folded into at most CENTROIDS weighted centroids kept sorted by
+ * mean.  The scale function concentrates centroid resolution at the tails of
+ * the distribution, which is where percentile objectives (p95, p99) live,
+ * while the state remains a fixed block with no allocation after
+ * construction.
+ *
+ * add() is amortized O(1) per sample: most calls append to the buffer, and
+ * every BUFFERED-th call runs one bounded compression pass (a sort and scan
+ * of at most CENTROIDS + BUFFERED elements).  As with Statistics<>,
+ * everything except toString() is safe to call from a SCHED_FIFO thread.
+ *
+ * Sketches from different streams may be combined with merge(), which folds
+ * the other sketch's centroids in with their accumulated weights.
+ */
+template <
+    typename T,             // input data type
+    typename D = double,    // output quantile data type
+    size_t CENTROIDS = 32,  // retained clusters; more gives finer resolution
+    size_t BUFFERED = 32    // samples staged between compression passes
+    >
+class QuantileEstimator {
+public:
+    void add(const T &value) {
+        mMax = audio_utils::max(mMax, value); // order important: reject NaN
+        mMin = audio_utils::min(mMin, value); // order important: reject NaN
+        ++mN;
+        push({D(value), D(1.)});
+    }
+
+    void add(const T *data, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            add(data[i]);
+        }
+    }
+
+    /**
+     * Folds another sketch into this one with its accumulated weights.
+     * other must be a distinct object.
+     */
+    void merge(const QuantileEstimator &other) {
+        mMax = audio_utils::max(mMax, other.mMax);
+        mMin = audio_utils::min(mMin, other.mMin);
+        mN += other.mN;
+        for (size_t i = 0; i < other.mCentroidCount; ++i) {
+            push(other.mCentroids[i]);
+        }
+        for (size_t i = 0; i < other.mBufferCount; ++i) {
+            push(other.mBuffer[i]);
+        }
+    }
+
+    /**
+     * Returns the estimated q-th quantile for q in [0, 1] by linear
+     * interpolation between centroid midpoints, with the exact minimum and
+     * maximum anchoring the ends.  Each call sorts the staged samples, so
+     * reading after bulk adds is cheaper than reading between samples.
+     */
+    D quantile(D q) const {
+        if (mN == 0) return {};
+        std::array<Centroid, CENTROIDS + BUFFERED> view;
+        size_t n = 0;
+        for (size_t i = 0; i < mCentroidCount; ++i) view[n++] = mCentroids[i];
+        for (size_t i = 0; i < mBufferCount; ++i) view[n++] = mBuffer[i];
+        std::sort(view.begin(), view.begin() + n,
+                [](const Centroid &a, const Centroid &b) { return a.mean < b.mean; });
+        D total{};
+        for (size_t i = 0; i < n; ++i) total += view[i].weight;
+        const D target = q * total;
+        D cum{};            // weight preceding the current centroid
+        D prevMid{};        // cumulative weight at the previous anchor
+        D prevValue = D(mMin);
+        for (size_t i = 0; i < n; ++i) {
+            const D mid = cum + D(0.5) * view[i].weight;
+            if (target <= mid) {
+                const D span = mid - prevMid;
+                return span > D(0.) ? prevValue
+                        + (view[i].mean - prevValue) * (target - prevMid) / span
+                        : view[i].mean;
+            }
+            prevMid = mid;
+            prevValue = view[i].mean;
+            cum += view[i].weight;
+        }
+        // beyond the last centroid midpoint: approach the exact maximum
+        const D span = total - prevMid;
+        return span > D(0.) ? prevValue + (D(mMax) - prevValue) * (target - prevMid) / span
+                : D(mMax);
+    }
+
+    int64_t getN() const {
+        return mN;
+    }
+
+    T getMin() const {
+        return mMin;
+    }
+
+    T getMax() const {
+        return mMax;
+    }
+
+    void reset() {
+        mMin = StatisticsConstants<T>::positiveInfinity();
+        mMax = StatisticsConstants<T>::negativeInfinity();
+        mN = 0;
+        mCentroidCount = 0;
+        mBufferCount = 0;
+    }
+
+    std::string toString() const {
+        if (getN() == 0) return "unavail";
+
+        std::stringstream ss;
+        ss << "p50=" << quantile(D(0.50));
+        ss << " p95=" << quantile(D(0.95));
+        ss << " p99=" << quantile(D(0.99));
+        ss << " min=" << getMin();
+        ss << " max=" << getMax();
+        return ss.str();
+    }
+
+private:
+    struct Centroid {
+        D mean{};
+        D weight{};
+    };
+
+    // Scale function k1 from the t-digest paper: the cluster width allowed
+    // by the merge criterion shrinks toward q == 0 and q == 1, keeping the
+    // tail quantiles sharp.  The nominal compression is half the centroid
+    // capacity, which leaves enough headroom that the compression pass
+    // rarely needs its hard limit on the cluster count (kept as a safety
+    // net so accuracy rather than correctness depends on this bound).
+    static D scale(D q) {
+        constexpr D kDelta = D(CENTROIDS) * D(0.5);
+        return kDelta * std::asin(D(2.) * q - D(1.)) / D(M_PI);
+    }
+
+    // appends a weighted point, compressing when the stage is full
+    void push(const Centroid &c) {
+        mBuffer[mBufferCount++] = c;
+        if (mBufferCount == BUFFERED) {
+            compress();
+        }
+    }
+
+    // folds the staged samples into the centroids:  sort all points by mean,
+    // then greedily coalesce neighbors while the merged cluster stays within
+    // the scale function's width budget.
+    void compress() {
+        std::array<Centroid, CENTROIDS + BUFFERED> all;
+        size_t n = 0;
+        for (size_t i = 0; i < mCentroidCount; ++i) all[n++] = mCentroids[i];
+        for (size_t i = 0; i < mBufferCount; ++i) all[n++] = mBuffer[i];
+        mBufferCount = 0;
+        if (n == 0) return;
+        std::sort(all.begin(), all.begin() + n,
+                [](const Centroid &a, const Centroid &b) { return a.mean < b.mean; });
+        D total{};
+        for (size_t i = 0; i < n; ++i) total += all[i].weight;
+        size_t out = 0;
+        mCentroids[0] = all[0];
+        D cum{};   // weight preceding the output cluster being built
+        for (size_t i = 1; i < n; ++i) {
+            const D qLeft = cum / total;
+            const D qRight = (cum + mCentroids[out].weight + all[i].weight) / total;
+            if (scale(qRight) - scale(qLeft) <= D(1.) || out == CENTROIDS - 1) {
+                // coalesce into the current cluster
+                const D weight = mCentroids[out].weight + all[i].weight;
+                mCentroids[out].mean +=
+                        (all[i].mean - mCentroids[out].mean) * all[i].weight / weight;
+                mCentroids[out].weight = weight;
+            } else {
+                cum += mCentroids[out].weight;
+                mCentroids[++out] = all[i];
+            }
+        }
+        mCentroidCount = out + 1;
+    }
+
+    T mMin{StatisticsConstants<T>::positiveInfinity()};
+    T mMax{StatisticsConstants<T>::negativeInfinity()};
+    int64_t mN = 0;                              // running count of samples.
+    size_t mCentroidCount = 0;
+    size_t mBufferCount = 0;
+    std::array<Centroid, CENTROIDS> mCentroids;  // sorted by mean.
+    std::array<Centroid, BUFFERED> mBuffer;      // staged points, unsorted.
+};
+
 /**
  * Least squares fitting of a 2D straight line based on the covariance matrix.
  *
@@ -17,6 +17,8 @@
 #ifndef ANDROID_AUDIO_UTILS_TIMESTAMP_VERIFIER_H
 #define ANDROID_AUDIO_UTILS_TIMESTAMP_VERIFIER_H
 
+#include <array>
+
 #include <audio_utils/clock.h>
 #include <audio_utils/Statistics.h>
 
@@ -94,11 +96,14 @@ public:
             mLastTimestamp = mFirstTimestamp;
             mLastCorrectedTimestamp = mFirstTimestamp;
             mSampleRate = sampleRate;
+            // cache the reciprocal so the steady state add() converts frame
+            // deltas to time with a multiply instead of a division.
+            mInvSampleRateNs = 1e9 / sampleRate;
         } else {
             assert(sampleRate != 0);
             const FrameTime timestamp{frames, timeNs};
             if (mCold && (timestamp.mTimeNs == mLastTimestamp.mTimeNs
-                    || computeRatio(timestamp, mLastTimestamp, sampleRate)
+                    || computeRatio(timestamp, mLastTimestamp)
                             < kMinimumSpeedToStartVerification)) {
                 // cold is when the timestamp may take some time to start advancing at normal rate.
                 ++mColds;
@@ -107,8 +112,14 @@ public:
                 // ALOGD("colds:%lld frames:%lld timeNs:%lld",
                 //         (long long)mColds, (long long)frames, (long long)timeNs);
             } else {
-                const double jitterMs = computeJitterMs(timestamp, mLastTimestamp, sampleRate);
+                const double jitterMs = computeJitterMs(timestamp, mLastTimestamp);
                 mJitterMs.add(jitterMs);
+                mWindowJitterMs.add(jitterMs);
+                if (mWindowJitterMs.getN() >= kJitterWindowSize) {
+                    // tumble: keep the completed window for O(1) queries.
+                    mLastWindowJitterMs = mWindowJitterMs;
+                    mWindowJitterMs.reset();
+                }
                 // ALOGD("frames:%lld  timeNs:%lld jitterMs:%lf",
                 //         (long long)frames, (long long)timeNs, jitterMs);
 
@@ -150,7 +161,7 @@ public:
 
                 // Compute the jitter if the corrected timestamp is used.
                 const double correctedJitterMs = computeJitterMs(
-                        correctedTimestamp, mLastCorrectedTimestamp, sampleRate);
+                        correctedTimestamp, mLastCorrectedTimestamp);
                 mCorrectedJitterMs.add(correctedJitterMs);
                 mLastCorrectedTimestamp = correctedTimestamp;
             }
@@ -159,6 +170,19 @@ public:
         ++mTimestamps;
     }
 
+    /** adds a batch of timestamps, as parallel frame count and time arrays
+     * of the shape device drivers report them.
+     *
+     * Equivalent to calling add() for each (frames[i], timeNs[i]) pair in
+     * order; the per-pair frame-delta conversion uses the reciprocal cached
+     * for the sample rate, so the loop performs no divisions.
+     */
+    constexpr void add(const F *frames, const T *timeNs, size_t count, uint32_t sampleRate) {
+        for (size_t i = 0; i < count; ++i) {
+            add(frames[i], timeNs[i], sampleRate);
+        }
+    }
+
     // How a discontinuity affects frame position.
     enum DiscontinuityMode : int32_t {
         DISCONTINUITY_MODE_CONTINUOUS, // frame position is unaffected.
@@ -186,6 +210,9 @@ public:
             mDiscontinuity = true;
             mDiscontinuityMode = mode;
             mCold = true;
+            // record the anomaly with its context in the ring (no locks taken).
+            mAnomalies[mDiscontinuities % kAnomalyRingSize] = {
+                    mTimestamps, mLastTimestamp, mSampleRate, mode };
             ++mDiscontinuities;
         }
     }
@@ -220,6 +247,7 @@ public:
                     mLastTimestamp, mFirstTimestamp, mSampleRate);
         }
         ss << " jitterMs(" << mJitterMs.toString() << ")";  // timestamp jitter statistics.
+        ss << " windowJitterMs(" << getJitterMsWindow().toString() << ")"; // rolling window.
 
         double a, b, r2; // sample rate is the slope b.
         estimateSampleRate(a, b, r2);
@@ -240,6 +268,13 @@ public:
     constexpr const audio_utils::Statistics<double> & getJitterMs() const {
         return mJitterMs;
     }
+    /** returns rolling-window jitter statistics in O(1): the last completed
+     * window of kJitterWindowSize timestamps, or the partial current window
+     * if none has completed yet.
+     */
+    constexpr const audio_utils::Statistics<double> & getJitterMsWindow() const {
+        return mLastWindowJitterMs.getN() > 0 ? mLastWindowJitterMs : mWindowJitterMs;
+    }
     // estimate local sample rate (dframes / dtime) which is the slope b from:
     // y = a + bx
     constexpr void estimateSampleRate(double &a, double &b, double &r2) const {
@@ -254,6 +289,34 @@ public:
 
     constexpr FrameTime getLastCorrectedTimestamp() const { return mLastCorrectedTimestamp; }
 
+    /** context captured at each counted discontinuity.
+     *
+     * The most recent kAnomalyRingSize anomalies are kept in a bounded ring,
+     * written without locks so recording is safe from a SCHED_FIFO thread.
+     */
+    struct Anomaly {
+        int64_t mTimestampCount;   // mTimestamps when the discontinuity was registered.
+        FrameTime mLastTimestamp;  // last timestamp before the discontinuity.
+        uint32_t mSampleRate;      // sample rate before the discontinuity.
+        DiscontinuityMode mMode;   // mode of the discontinuity.
+    };
+
+    /** returns the number of anomalies retained in the ring. */
+    constexpr size_t getAnomalyCount() const {
+        return std::min(mDiscontinuities, (int64_t)kAnomalyRingSize);
+    }
+
+    /** returns a retained anomaly, where index 0 is the most recent.
+     *
+     * index must be less than getAnomalyCount().
+     */
+    constexpr Anomaly getAnomaly(size_t index) const {
+        return mAnomalies[(mDiscontinuities - 1 - index) % kAnomalyRingSize];
+    }
+
+    static constexpr size_t kAnomalyRingSize = 16;
+    static constexpr int64_t kJitterWindowSize = 128;
+
     // Inf+-, NaN is possible only if sampleRate is 0 (should not happen)
     static constexpr double computeJitterMs(
             const FrameTime &current, const FrameTime &last, uint32_t sampleRate) {
@@ -284,6 +347,7 @@ private:
     FrameTime mFirstTimestamp{};
     FrameTime mLastTimestamp{};
     uint32_t mSampleRate = 0;
+    double mInvSampleRateNs = 0.; // 1e9 / mSampleRate, for the hot path of add().
 
     // timestamp estimation and correction
     audio_utils::LinearLeastSquaresFit<double> mTimestampEstimator{kDefaultAlphaEstimator};
@@ -291,6 +355,13 @@ private:
     FrameTime mLastCorrectedTimestamp{};
     audio_utils::Statistics<double> mCorrectedJitterMs{kDefaultAlphaJitter};
 
+    // rolling (tumbling) window jitter statistics, unweighted (alpha == 1).
+    audio_utils::Statistics<double> mWindowJitterMs{1.};     // current (partial) window.
+    audio_utils::Statistics<double> mLastWindowJitterMs{1.}; // last completed window.
+
+    // bounded ring of discontinuity context, see Anomaly.
+    std::array<Anomaly, kAnomalyRingSize> mAnomalies{};
+
     // configuration
     DiscontinuityMode mDiscontinuityMode = DISCONTINUITY_MODE_CONTINUOUS;
 
@@ -314,6 +385,21 @@ private:
         const double frameDifferenceNs = diff.first * 1e9 / sampleRate;
         return frameDifferenceNs / diff.second;
     }
+
+    // as the static variants above but at the current sample rate, using the
+    // cached reciprocal: add() runs per audio callback on every stream, and
+    // the per-call divisions show up in profiles on little cores.
+    constexpr double computeJitterMs(const FrameTime &current, const FrameTime &last) const {
+        const auto diff = sub(current, last);
+        const double frameDifferenceNs = diff.first * mInvSampleRateNs;
+        const double jitterNs = diff.second - frameDifferenceNs;  // actual - expected
+        return jitterNs * 1e-6;
+    }
+
+    constexpr double computeRatio(const FrameTime &current, const FrameTime &last) const {
+        const auto diff = sub(current, last);
+        return diff.first * mInvSampleRateNs / diff.second;
+    }
 };
 
 } // namespace android
@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_TYPED_FIFO_H
+#define ANDROID_AUDIO_TYPED_FIFO_H
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <audio_utils/fifo_index.h>
+#include <audio_utils/roundup.h>
+
+namespace android::audio_utils {
+
+/**
+ * TypedFifo is a single-producer single-consumer wait-free queue of C++ objects.
+ *
+ * audio_utils_fifo deals in opaque fixed-size frames and audio_utils_fifo_writer_T
+ * only optimizes the writing side for trivially-copyable payloads; neither can carry
+ * an object with a constructor or a move-only member.  TypedFifo closes that gap for
+ * the command/parameter queues between a control thread and a processing thread
+ * (e.g. effect parameter delivery), which otherwise tend to be hand-rolled rings
+ * with ad-hoc - and historically subtly wrong - memory ordering.
+ *
+ * Elements are constructed in place in the ring by the producer (emplace/push with
+ * move support) and destroyed by the consumer as they are popped, so T need not be
+ * trivially copyable, only movable.  The synchronization is the same publication
+ * protocol as the frame FIFOs, on the same audio_utils_fifo_index type: the
+ * producer's store-release of the rear index is what makes a constructed element
+ * visible, and the consumer's store-release of the front index is what returns a
+ * slot.  The two shared indices are padded to separate cache lines, and each side
+ * keeps a cached copy of the other side's index so the shared line is only touched
+ * when the cached bound is exhausted.
+ *
+ * Restrictions compared to audio_utils_fifo:
+ *  - exactly one producer thread and one consumer thread, in one process
+ *    (objects with pointers cannot cross an address space anyway)
+ *  - no blocking or futex support: a push to a full ring and a pop from an
+ *    empty ring return immediately; callers that need to block can layer
+ *    their own wakeup, as the command queues this replaces already do
+ *  - capacity is rounded up to a power of 2
+ *
+ * The destructor destroys any elements still queued; as for construction, it must
+ * not run concurrently with either side.
+ */
+template <typename T>
+class TypedFifo {
+    static_assert(std::is_move_constructible_v<T>, "TypedFifo requires a movable T");
+
+public:
+    /**
+     * Construct a TypedFifo.
+     *
+     * \param minCapacity Minimum number of elements the ring can hold, > 0;
+     *                    rounded up to the next power of 2.
+     */
+    explicit TypedFifo(uint32_t minCapacity)
+        : mCapacity(audio_utils_next_pow2(minCapacity < 2 ? 2 : minCapacity)),
+          mSlots(new Slot[mCapacity])
+    {
+    }
+
+    ~TypedFifo() {
+        // single-threaded here by contract, so plain loads would also do
+        uint32_t front = mFront.loadAcquire();
+        const uint32_t rear = mRear.loadAcquire();
+        for (; front != rear; ++front) {
+            slot(front)->~T();
+        }
+    }
+
+    TypedFifo(const TypedFifo&) = delete;
+    TypedFifo& operator=(const TypedFifo&) = delete;
+
+    /**
+     * Construct an element in place at the rear of the ring.  Producer only.
+     *
+     * \param args Constructor arguments for T.
+     * \return true if the element was enqueued, false if the ring is full.
+     */
+    template <typename... Args>
+    bool emplace(Args&&... args) {
+        const uint32_t rear = mLocalRear;
+        if (rear - mCachedFront == mCapacity) {
+            mCachedFront = mFront.loadAcquire();
+            if (rear - mCachedFront == mCapacity) {
+                return false;       // full
+            }
+        }
+        ::new (static_cast<void *>(&mSlots[rear & (mCapacity - 1)]))
+                T(std::forward<Args>(args)...);
+        mLocalRear = rear + 1;
+        mRear.storeRelease(mLocalRear);
+        return true;
+    }
+
+    /**
+     * Copy an element into the ring.  Producer only.
+     *
+     * \return true if the element was enqueued, false if the ring is full.
+     */
+    bool push(const T& value) {
+        return emplace(value);
+    }
+
+    /**
+     * Move an element into the ring.  Producer only.
+     * The value is left in its moved-from state only on success.
+     *
+     * \return true if the element was enqueued, false if the ring is full.
+     */
+    bool push(T&& value) {
+        return emplace(std::move(value));
+    }
+
+    /**
+     * Pop the element at the front of the ring, if any.  Consumer only.
+     *
+     * \param out Move-assigned from the popped element on success.
+     * \return true if an element was popped, false if the ring is empty.
+     */
+    bool pop(T& out) {
+        return pop(&out, 1) != 0;
+    }
+
+    /**
+     * Pop up to \p maxCount elements from the front of the ring.  Consumer only.
+     * The slots are returned to the producer with a single store-release after
+     * the batch, so a draining consumer invalidates the shared index line once
+     * per batch rather than once per element.
+     *
+     * \param out      Array of at least \p maxCount elements, move-assigned in
+     *                 queue order.
+     * \param maxCount Maximum number of elements to pop.
+     * \return Actual number of elements popped, possibly zero.
+     */
+    size_t pop(T *out, size_t maxCount) {
+        uint32_t front = mLocalFront;
+        uint32_t avail = mCachedRear - front;
+        if (avail == 0) {
+            mCachedRear = mRear.loadAcquire();
+            avail = mCachedRear - front;
+            if (avail == 0) {
+                return 0;           // empty
+            }
+        }
+        const size_t n = maxCount < avail ? maxCount : avail;
+        for (size_t i = 0; i < n; i++, front++) {
+            T *p = slot(front);
+            out[i] = std::move(*p);
+            p->~T();
+        }
+        mLocalFront = front;
+        mFront.storeRelease(front);
+        return n;
+    }
+
+    /** Return the capacity, after rounding up to a power of 2. */
+    uint32_t capacity() const {
+        return mCapacity;
+    }
+
+    /**
+     * Return the number of queued elements.
+     * Exact if called by the producer or the consumer, a hint otherwise.
+     */
+    uint32_t size() {
+        return mRear.loadAcquire() - mFront.loadAcquire();
+    }
+
+private:
+    // raw storage for one T; constructed/destroyed explicitly as elements move through
+    struct Slot {
+        alignas(T) unsigned char mBytes[sizeof(T)];
+    };
+
+    T *slot(uint32_t index) {
+        return std::launder(reinterpret_cast<T *>(mSlots[index & (mCapacity - 1)].mBytes));
+    }
+
+    static constexpr size_t kCacheLineSize = 64;
+
+    // These fields are const after initialization
+    const uint32_t                mCapacity;    // power of 2
+    const std::unique_ptr<Slot[]> mSlots;
+
+    // Producer cache line: the shared rear index it publishes, plus its
+    // working copies (mCachedFront under-reports free slots, never unsafely).
+    alignas(kCacheLineSize) audio_utils_fifo_index mRear;
+    uint32_t mLocalRear = 0;    // frame index of the next slot to construct into
+    uint32_t mCachedFront = 0;  // producer's last observed value of mFront
+
+    // Consumer cache line, symmetrically.
+    alignas(kCacheLineSize) audio_utils_fifo_index mFront;
+    uint32_t mLocalFront = 0;   // frame index of the next element to pop
+    uint32_t mCachedRear = 0;   // consumer's last observed value of mRear
+};
+
+}  // namespace android::audio_utils
+
+#endif  // ANDROID_AUDIO_TYPED_FIFO_H
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_CACHE_TOPOLOGY_H
+#define ANDROID_AUDIO_CACHE_TOPOLOGY_H
+
+#include <stddef.h>
+#include <sys/cdefs.h>
+
+/** \cond */
+__BEGIN_DECLS
+/** \endcond */
+
+/**
+ * Data cache topology of the CPU the caller is likely to run on,
+ * for sizing the working set of block-processing kernels.
+ * Sizes are in bytes; a level not present reads as 0.
+ */
+struct audio_utils_cache_topology {
+    size_t l1d_size;    /**< per-core L1 data cache */
+    size_t l2_size;     /**< per-core or per-cluster L2 */
+    size_t l3_size;     /**< shared last level cache, 0 if none */
+    size_t line_size;   /**< cache line size */
+};
+
+/**
+ * Fill in the cache topology, probed once from sysfs
+ * (/sys/devices/system/cpu/cpu0/cache) and cached.  On kernels that do not
+ * expose the topology, conservative defaults are reported (32 KB L1d,
+ * 256 KB L2, 64 byte lines).
+ *
+ * \return 0 if the topology was probed, -ENOENT if defaults were reported
+ *         (the struct is filled in either way).
+ */
+int audio_utils_get_cache_topology(struct audio_utils_cache_topology *topology);
+
+/**
+ * Recommend a tile size in frames for a block-processing chain, so that the
+ * chain's working set stays cache resident instead of round-tripping every
+ * intermediate through main memory (see Pipeline.h for the executor that
+ * consumes such tiles).
+ *
+ * \param max_frame_size  largest frame size in bytes among the chain's
+ *                        input, output and intermediate buffers.
+ * \param num_buffers     number of buffers live per tile: input, output and
+ *                        each distinct intermediate (a single in-place stage
+ *                        passes 2).
+ * \return a power-of-two frame count, at least 32 and at most 4096, chosen
+ *         so num_buffers * tile * max_frame_size fits in about half the L1
+ *         data cache (leaving room for filter state and stack), growing to
+ *         L2 only when L1 cannot hold the minimum tile.
+ */
+size_t audio_utils_recommend_tile_frames(size_t max_frame_size, size_t num_buffers);
+
+/** \cond */
+__END_DECLS
+/** \endcond */
+
+#endif  // !ANDROID_AUDIO_CACHE_TOPOLOGY_H
@@ -244,6 +244,55 @@ constexpr inline ssize_t pairIdxFromChannelIdx(size_t idx) {
     return -1;
 }
 
+/**
+ * ChannelPositions decodes a channel position mask once into the ordered
+ * array of channel bit indices, so per-buffer processing loops can iterate
+ * the cached indices instead of re-scanning the mask bits for every buffer.
+ *
+ * The decode is constexpr; for the canonical channel masks, e.g.
+ * AUDIO_CHANNEL_OUT_7POINT1POINT4, the position table folds to a
+ * compile time constant.  For a mask known only at run time, construct
+ * once where the mask is configured and keep the object for the
+ * processing loop.
+ *
+ * The mask representation bits are ignored; for an index mask the channel
+ * bit indices are simply 0, 1, ... count - 1, matching the position of
+ * each channel in the frame.
+ *
+ * For the channel mask spec, see system/media/audio/include/system/audio*.h.
+ */
+class ChannelPositions {
+public:
+    constexpr ChannelPositions() = default;
+
+    explicit constexpr ChannelPositions(audio_channel_mask_t mask) {
+        // equivalent to audio_channel_mask_get_bits(), which is not constexpr.
+        uint32_t bits = mask & ((1u << AUDIO_CHANNEL_COUNT_MAX) - 1);
+        while (bits != 0) {
+            mPositions[mCount++] = (uint8_t)__builtin_ctz(bits);
+            bits &= bits - 1;  // clear lowest bit set.
+        }
+    }
+
+    /** Returns the number of channels in the mask. */
+    constexpr size_t size() const { return mCount; }
+
+    /**
+     * Returns the channel mask bit index of the i-th channel in the frame,
+     * or 0 if out of range (as with the geometry lookups above).
+     */
+    constexpr size_t operator[](size_t i) const {
+        return i < mCount ? mPositions[i] : 0;
+    }
+
+    constexpr const uint8_t* begin() const { return mPositions; }
+    constexpr const uint8_t* end() const { return mPositions + mCount; }
+
+private:
+    uint8_t mPositions[AUDIO_CHANNEL_COUNT_MAX]{};
+    size_t mCount = 0;
+};
+
 } // android::audio_utils::channels
 
 #endif // __cplusplus
@@ -276,6 +325,36 @@ size_t adjust_channels(const void* in_buff, size_t in_buff_chans,
                        void* out_buff, size_t out_buff_chans,
                        unsigned sample_size_in_bytes, size_t num_in_bytes);
 
+/**
+ * Pointer to a channel adjust routine with the adjust_channels() signature.
+ */
+typedef size_t (*adjust_channels_fn)(const void* in_buff, size_t in_buff_chans,
+                       void* out_buff, size_t out_buff_chans,
+                       unsigned sample_size_in_bytes, size_t num_in_bytes);
+
+/**
+ * Returns an adjust_channels() routine specialized for one
+ * (in_buff_chans, out_buff_chans, sample_size_in_bytes) tuple.
+ *
+ * For the fixed conversions of hardware streams (mono/stereo fan-out and the
+ * stereo <-> 4, 6, 8 channel pairs used by USB devices) the routine is
+ * instantiated from a template with the channel counts as compile time
+ * constants, so the per-frame channel dispatch of adjust_channels() is
+ * resolved once at stream open instead of per buffer.  Other tuples return
+ * the generic adjust_channels().  Output is bit identical to
+ * adjust_channels() in all cases, including in-place operation.
+ *
+ *   \param in_buff_chans        Specifies the number of channels in the input buffer.
+ *   \param out_buff_chans       Specifies the number of channels in the output buffer.
+ *   \param sample_size_in_bytes Specifies the number of bytes per sample. 1, 2, 3, 4 are
+ *     currently valid.
+ *
+ * \return
+ *   the conversion routine, or NULL if sample_size_in_bytes is invalid.
+ */
+adjust_channels_fn adjust_channels_get_fn(size_t in_buff_chans, size_t out_buff_chans,
+                       unsigned sample_size_in_bytes);
+
 /**
  * Expands or contracts sample data from one interleaved channel format to another.
  * Extra expanded channels are left alone in the output buffer.
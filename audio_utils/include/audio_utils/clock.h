@@ -133,4 +133,68 @@ static inline int64_t audio_utils_get_real_time_ns() {
 
 }
 
+/**
+ * \brief Gets the monotonic time clock in nanoseconds.
+ * \return the monotonic time clock in nanoseconds, or 0 on error.
+ */
+static inline int64_t audio_utils_get_monotonic_time_ns() {
+    struct timespec now_ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &now_ts) == 0) {
+        return audio_utils_ns_from_timespec(&now_ts);
+    }
+    return 0; // should not happen.
+}
+
+/**
+ * Hybrid coarse/fine time source.
+ *
+ * Per-buffer bookkeeping can make tens of thousands of clock_gettime()
+ * calls per second on a stream thread, even though most of those consumers
+ * only need buffer-granularity time.  Instead, a housekeeping point (the
+ * top of the stream loop, or a periodic timer) refreshes a process-wide
+ * cached monotonic timestamp with audio_utils_cached_time_tick(), and the
+ * bookkeeping reads it back with audio_utils_cached_time_ns() for the cost
+ * of one relaxed atomic load.  The cached value is stale by up to one tick
+ * interval; consumers that need fine-grained time (e.g. timestamps fed to a
+ * TimestampVerifier) must keep calling audio_utils_get_monotonic_time_ns()
+ * explicitly.
+ */
+
+/** \cond */
+__BEGIN_DECLS
+/** \endcond */
+
+/** Backing store of the cached timestamp; use the accessors below. */
+extern int64_t audio_utils_cached_time_state;
+
+/** \cond */
+__END_DECLS
+/** \endcond */
+
+/**
+ * \brief Refreshes the cached timestamp from the monotonic clock.
+ *
+ * Call from a housekeeping point at the coarsest interval the readers can
+ * tolerate.  Any thread may tick; the last tick wins.
+ *
+ * \return the monotonic time in nanoseconds just stored in the cache.
+ */
+static inline int64_t audio_utils_cached_time_tick() {
+    const int64_t now_ns = audio_utils_get_monotonic_time_ns();
+    __atomic_store_n(&audio_utils_cached_time_state, now_ns, __ATOMIC_RELAXED);
+    return now_ns;
+}
+
+/**
+ * \brief Reads the cached monotonic time without a clock_gettime() call.
+ *
+ * \return the timestamp of the most recent audio_utils_cached_time_tick(),
+ *         or a fresh reading (which also primes the cache) if no tick
+ *         has happened yet.
+ */
+static inline int64_t audio_utils_cached_time_ns() {
+    const int64_t cached_ns = __atomic_load_n(&audio_utils_cached_time_state, __ATOMIC_RELAXED);
+    return cached_ns != 0 ? cached_ns : audio_utils_cached_time_tick();
+}
+
 #endif  // !ANDROID_AUDIO_CLOCK_H
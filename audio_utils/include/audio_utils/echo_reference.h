@@ -62,6 +62,52 @@ int create_echo_reference(audio_format_t rdFormat,
 
 void release_echo_reference(struct echo_reference_itfe *echo_reference);
 
+/**
+ * Set the playback channel weights used when write() folds multichannel
+ * playback down to the reference channel count.
+ *
+ * Write channel c contributes to reference channel (c % rdChannelCount), so
+ * a stereo reference folds even write channels to the left and odd write
+ * channels to the right. By default every write channel contributes equally;
+ * unequal weights let a multi-speaker zone de-emphasize e.g. distant corner
+ * speakers in the reference fed to the AEC. The weights of each reference
+ * channel are normalized to unity gain on assignment, so only their ratios
+ * matter. Weights may be changed while writing.
+ *
+ * weights is an array of count non-negative values, one per write channel
+ * (count must equal wrChannelCount), with a non-zero sum per reference
+ * channel; NULL restores the default equal weighting.
+ * Returns 0 on success, -EINVAL on invalid weights.
+ */
+int echo_reference_set_channel_weights(struct echo_reference_itfe *echo_reference,
+                                       const float *weights, size_t count);
+
+/**
+ * Add an independent reader over an existing echo reference.
+ *
+ * Each reader has its own read cursor over the reference stream, so several
+ * consumers (e.g. an AEC and a sound trigger or barge-in detector) can share
+ * one echo reference without duplicating the down mix and resampling done by
+ * write().
+ *
+ * The returned interface only implements read(). A read never blocks: the
+ * frames accumulated since the previous read are returned and frame_count is
+ * updated with the number of frames actually returned. A reader never blocks
+ * the writer either; a reader too slow to keep up skips ahead to the most
+ * recent frames. Readers are not delay adjusted against the capture stream:
+ * delay_ns is always returned as 0. Reading with a NULL buffer stops the
+ * reader and discards pending frames, as with the main read() interface.
+ *
+ * Up to 4 readers can be active on one echo reference.
+ * Readers must be released with echo_reference_release_reader() before
+ * release_echo_reference() is called.
+ */
+int echo_reference_create_reader(struct echo_reference_itfe *echo_reference,
+                                 struct echo_reference_itfe **reader);
+
+/** Release a reader obtained with echo_reference_create_reader(). */
+void echo_reference_release_reader(struct echo_reference_itfe *reader);
+
 __END_DECLS
 
 #endif // ANDROID_ECHO_REFERENCE_H
@@ -19,12 +19,51 @@
 
 #include <stdlib.h>
 #include <sys/types.h>
+#include <memory>
 #include <audio_utils/fifo_index.h>
 
 #ifndef __cplusplus
 #error C API is no longer supported
 #endif
 
+namespace android::audio_utils {
+class LogHistogram;
+}
+
+/**
+ * Snapshot of the blocking-wait telemetry for one side of a FIFO.
+ * Writer waits mean the (throttling) reader is not keeping up;
+ * reader waits mean the writer is not producing.
+ */
+struct audio_utils_fifo_wait_stats {
+    uint64_t waits;     ///< number of times obtain() blocked
+    int64_t totalNs;    ///< total time spent blocked
+    int64_t maxNs;      ///< longest single blocking wait
+};
+
+/**
+ * Per-frame integrity tag, stamped by audio_utils_fifo_writer::write() and verified by
+ * audio_utils_fifo_reader::read() when integrity mode is enabled;
+ * see audio_utils_fifo::enableIntegrity().
+ */
+struct audio_utils_fifo_integrity_tag {
+    /** Low 32 bits of the frame's index, in the same index space as the rear and front. */
+    uint32_t mSequence;
+    /** CRC-32C of the frame payload, seeded with mSequence to bind the tag to its slot. */
+    uint32_t mCrc;
+};
+
+/**
+ * Reader-side integrity validation counters; see audio_utils_fifo::enableIntegrity().
+ * A non-zero error count means the shared buffer or tag array was modified by someone
+ * other than the writer, or that the two sides did not both enable integrity mode.
+ */
+struct audio_utils_fifo_integrity_stats {
+    uint64_t framesChecked;     ///< frames read while integrity mode was enabled
+    uint64_t crcErrors;         ///< frames whose payload did not match the tagged CRC
+    uint64_t sequenceErrors;    ///< frames whose tag sequence did not match the read index
+};
+
 /** Indicates whether index is multi-thread safe, and the synchronization technique. */
 enum audio_utils_fifo_sync {
     /** Index is not multi-thread safe. No support for synchronization or timeouts. */
@@ -109,7 +148,7 @@ protected:
 
     /** Maximum usable frames to be stored in the FIFO > 0 && <= INT32_MAX, aka "capacity". */
     const uint32_t mFrameCount;
-    /** Equal to roundup(mFrameCount). */
+    /** Equal to audio_utils_next_pow2(mFrameCount). */
     const uint32_t mFrameCountP2;
 
     /**
@@ -118,6 +157,12 @@ protected:
      */
     const uint32_t mFudgeFactor;
 
+    /**
+     * Equal to log2(mFrameCountP2).  As the divisor is always a power of two, a "reciprocal"
+     * division by mFrameCountP2 reduces to a right shift by this precomputed amount.
+     */
+    const uint32_t mFrameCountP2Shift;
+
     /** Reference to writer's rear index. */
     audio_utils_fifo_index&         mWriterRear;
     /** Indicates how synchronization is done for mWriterRear. */
@@ -145,6 +190,7 @@ class audio_utils_fifo : public audio_utils_fifo_base {
 
     friend class audio_utils_fifo_reader;
     friend class audio_utils_fifo_writer;
+    friend class audio_utils_fifo_multiwriter;
     template <typename T> friend class audio_utils_fifo_writer_T;
 
 public:
@@ -163,9 +209,13 @@ public:
      *  \param writerRear  Writer's rear index.  Passed by reference because it must be non-NULL.
      *  \param throttleFront Pointer to the front index of at most one reader that throttles the
      *                       writer, or NULL for no throttling.
+     *  \param flushEpoch  Pointer to a shared flush epoch cell, or NULL for no flush signaling.
+     *                     Both sides must pass the same cell (or both NULL).
+     *                     See audio_utils_fifo_writer::flushRequested().
      */
     audio_utils_fifo(uint32_t frameCount, uint32_t frameSize, void *buffer,
-            audio_utils_fifo_index& writerRear, audio_utils_fifo_index *throttleFront = NULL);
+            audio_utils_fifo_index& writerRear, audio_utils_fifo_index *throttleFront = NULL,
+            audio_utils_fifo_index *flushEpoch = NULL);
 
     /**
      * Construct a FIFO object: single-process.
@@ -203,17 +253,66 @@ public:
     void *buffer() const
             { return mBuffer; }
 
+    /**
+     * Attach a per-frame integrity tag array and enable integrity mode.
+     *
+     * In integrity mode, the writer's write() stamps each frame's tag with the frame's
+     * sequence number and the CRC-32C of its payload, computed while the source data is
+     * still warm in cache, and the reader's read() re-computes both over the data it
+     * received and counts mismatches; see audio_utils_fifo_reader::integrityStats().
+     * This detects shared-memory corruption by a misbehaving process at the FIFO
+     * boundary, instead of downstream as audio artifacts.
+     *
+     * Integrity mode covers the copy APIs write() and read() only: frames transferred
+     * through obtain()/release(), readVia(), or a multi-writer are neither tagged nor
+     * verified, and mixing the two styles on one FIFO will misreport errors.
+     *
+     * \param tags  Pointer to a caller-allocated, zero-initialized array of \p frameCount
+     *              tags, or NULL to disable.  For a multi-process FIFO the array must be
+     *              in shared memory, like the main buffer, and both sides must attach the
+     *              same array before transferring data.
+     */
+    void enableIntegrity(audio_utils_fifo_integrity_tag *tags)
+            { mIntegrityTags = tags; }
+
 private:
     // These fields are const after initialization
     const uint32_t mFrameSize;  // size of each frame in bytes
     void * const   mBuffer;     // non-NULL pointer to caller-allocated buffer
                                 // of size mFrameCount frames
 
+    /**
+     * Pointer to a shared cell holding the flush epoch: a count of reader-initiated
+     * flushes, bumped by the throttling reader's flush() and polled by the writer's
+     * flushRequested().  NULL if flush signaling is not configured.
+     * The cell is an audio_utils_fifo_index so it can be placed in shared memory
+     * the same way as the rear and front indices, but it is not a frame index.
+     */
+    audio_utils_fifo_index* const   mFlushEpoch;
+
+    /**
+     * Pointer to a caller-allocated array of mFrameCount per-frame integrity tags,
+     * indexed by the physical frame offset, or NULL if integrity mode is off.
+     * Like mBuffer, the array may be in shared memory; see enableIntegrity().
+     */
+    audio_utils_fifo_integrity_tag* mIntegrityTags;
+
+    /**
+     * Counter name under which the fill level is emitted to atrace by the writer's
+     * and throttling reader's release(), so glitch investigations can see queue
+     * depths without a custom build.  Built once at construction; emission is gated
+     * on the audio trace category and costs one relaxed load when tracing is off.
+     */
+    char mTraceName[32];
+
     // only used for single-process constructor
     audio_utils_fifo_index      mSingleProcessSharedRear;
 
     // only used for single-process constructor when throttlesWriter == true
     audio_utils_fifo_index      mSingleProcessSharedFront;
+
+    // only used for single-process constructor when throttlesWriter == true
+    audio_utils_fifo_index      mSingleProcessSharedFlushEpoch;
 };
 
 /**
@@ -326,6 +425,36 @@ public:
     uint64_t totalReleased() const
             { return mTotalReleased; }
 
+    /**
+     * Return a snapshot of the blocking-wait telemetry for this provider.
+     * The counters are updated by the thread calling obtain(), so a snapshot
+     * taken from another thread (e.g. a dump) may be slightly stale.
+     *
+     * \return Wait count, total and maximum blocked time since construction.
+     */
+    audio_utils_fifo_wait_stats waitStats() const
+            { return {mWaitCount, mWaitTotalNs, mWaitMaxNs}; }
+
+    /**
+     * Enable an optional per-provider histogram of blocking-wait times,
+     * binned on a log-linear scale (see Histogram.h); the defaults give
+     * power-of-two bucket boundaries up to one second.  The histogram
+     * complements the scalar waitStats(), which are always maintained.
+     * Replaces (and so clears) any previously enabled histogram.
+     *
+     * \param subBucketBits log2 of the sub-bins per octave, >= 1.
+     * \param maxNs         waits longer than this land in the top bin.
+     */
+    void enableWaitHistogram(int32_t subBucketBits = 1,
+            int64_t maxNs = 1000000000 /* 1 second */);
+
+    /**
+     * Return the wait-time histogram, or NULL if not enabled.
+     * Same staleness caveat as waitStats().
+     */
+    const android::audio_utils::LogHistogram *waitHistogram() const
+            { return mWaitHistogram.get(); }
+
     /** Return a reference to the associated FIFO. */
     audio_utils_fifo& fifo()    { return mFifo; }
 
@@ -343,6 +472,17 @@ protected:
      * For a reader, this includes lost and flushed frames.
      */
     uint64_t    mTotalReleased;
+
+    /** Folds one blocking wait of \p ns into the stats and optional histogram. */
+    void recordWaitNs(int64_t ns);
+
+    /** Blocking-wait telemetry; see waitStats(). */
+    uint64_t    mWaitCount = 0;
+    int64_t     mWaitTotalNs = 0;
+    int64_t     mWaitMaxNs = 0;
+
+    /** Optional wait-time histogram; see enableWaitHistogram(). */
+    std::unique_ptr<android::audio_utils::LogHistogram> mWaitHistogram;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -447,10 +587,109 @@ public:
      */
     void getHysteresis(uint32_t *armLevel, uint32_t *triggerLevel) const;
 
+    /**
+     * Enable or disable rate-proportional pacing of blocking writes.
+     *
+     * When the FIFO is full, a blocking write() or obtain() normally parks on a futex until
+     * the throttling reader's next release, which tends to overshoot (the reader typically
+     * releases a whole period) and so the writer runs in bursts.  With pacing enabled, the
+     * writer instead estimates the reader's drain rate from the progress of the front index
+     * between its own index loads, and sleeps for the time the reader is expected to need
+     * to free the requested frames, then re-polls.
+     *
+     * Paced waits are bounded by \p timeout as usual, but the hard "block until at least one
+     * frame or timeout" guarantee is relaxed: a paced write() or obtain() may return zero
+     * before the timeout expires if the rate estimate was optimistic.  Callers in a paced
+     * write loop should treat zero like -EINTR and retry.
+     *
+     * Pacing only applies when index synchronization is AUDIO_UTILS_FIFO_SYNC_PRIVATE or
+     * AUDIO_UTILS_FIFO_SYNC_SHARED, and falls back to the futex wait until the writer has
+     * observed enough reader progress to form a rate estimate.  Default is disabled.
+     *
+     * \param paced  Whether to pace blocking writes against the estimated reader rate.
+     */
+    void setPaced(bool paced);
+
+    /**
+     * Get whether rate-proportional pacing is enabled.
+     *
+     * \return true if pacing is enabled.
+     */
+    bool isPaced() const
+            { return mPaced; }
+
+    /**
+     * Poll whether the throttling reader has called flush() since the last call
+     * to this method (or since construction).  Consumes the indication.
+     *
+     * A reader flush() only discards frames already in the buffer; without this
+     * signal the writer keeps submitting whatever stale data is queued upstream,
+     * and recovery from an underrun takes as long as it takes to drain that
+     * backlog through the ring.  A writer that polls this before each write()
+     * can instead discard its own stale pipeline and restart from fresh data,
+     * so recovery converges in one period.
+     *
+     * Requires the FIFO to be constructed with a flush epoch cell (automatic for
+     * the single-process constructor with \p throttlesWriter true); otherwise
+     * always returns false.  The reader's flush() also wakes a writer blocked in
+     * write() or obtain(), so a blocked writer re-polls promptly.
+     *
+     * \return true if the reader has flushed since the last poll.
+     */
+    bool flushRequested();
+
 private:
+    /**
+     * Fold an observed value of the reader's front index into the drain rate estimate.
+     * Called from the index loads that obtain() and release() already perform,
+     * so pacing adds no extra loads of the shared index.
+     *
+     * \param front  Front index value just loaded from the throttling reader.
+     */
+    void updateReaderRate(uint32_t front);
+
+    /**
+     * Sleep for the time the reader is expected to need to free \p count frames,
+     * bounded below by kPacedMinSleepNs, above by kPacedMaxSleepNs and by \p timeout.
+     * Only called when a drain rate estimate is available (mNsPerFrame > 0).
+     *
+     * \param count   Desired number of frames to write, > 0.
+     * \param timeout Maximum time to block, non-NULL and not {0, 0}.
+     *
+     * \return Zero if the wait completed and the caller should re-poll,
+     *  \retval -ETIMEDOUT the sleep was clipped by \p timeout.
+     *  \retval -EINTR the sleep was interrupted by a signal.
+     */
+    int pacedWait(size_t count, const struct timespec *timeout);
+
+    // Bounds on a single paced sleep: long enough that re-polling is not a spin,
+    // short enough that a stale rate estimate cannot park the writer for long.
+    static constexpr int64_t kPacedMinSleepNs =   100000;   // 100 us
+    static constexpr int64_t kPacedMaxSleepNs = 10000000;   // 10 ms
+
     // Accessed by writer only using ordinary operations
     uint32_t    mLocalRear; // frame index of next frame slot available to write, or write index
 
+    /**
+     * Writer-local lower bound on frames available to write without reloading the
+     * reader's front index.  The reader's front index only advances, so a stale value
+     * under-reports but is never unsafe.  obtain() serves requests within this bound
+     * without touching the shared index (which is typically in a cache line owned by
+     * the reader's CPU), and refreshes it from a real load otherwise; release()
+     * updates it for free from the front index load it already does for wakeup.
+     */
+    uint32_t    mCachedAvail;
+
+    // Flush epoch value at the previous flushRequested() poll; see flushRequested().
+    uint32_t    mLocalFlushEpoch;
+
+    // Rate-proportional pacing state; see setPaced().
+    // The rate estimate is writer-local and fed only by index loads the writer does anyway.
+    bool        mPaced;             // whether pacing of blocking writes is enabled
+    int64_t     mNsPerFrame;        // smoothed reader drain time per frame, 0 until estimated
+    uint32_t    mPacedLastFront;    // front index at the previous rate sample
+    int64_t     mPacedLastNs;       // CLOCK_MONOTONIC time of the previous rate sample
+
     // TODO make a separate class and associate with the synchronization object
     uint32_t    mArmLevel;          // arm if filled < arm level before release()
     uint32_t    mTriggerLevel;      // trigger if armed and filled > trigger level after release()
@@ -461,6 +700,93 @@ private:
 
 ////////////////////////////////////////////////////////////////////////////////
 
+/**
+ * Used to write to a FIFO from multiple threads of a single process without a mutex.
+ *
+ * Unlike audio_utils_fifo_writer, the multi-writer is thread-safe with respect to
+ * multiple threads calling write() concurrently: each write() claims a slice of the
+ * buffer by atomically advancing a private reservation index, copies outside of any
+ * lock, and then publishes the slice to reader(s) in claim order.  A writer that
+ * finishes its copy before an earlier claim has been published briefly spins
+ * (yielding the CPU) until it is its turn to publish.
+ *
+ * Because claiming and publishing are separate steps, the two-phase
+ * obtain() / release() API cannot be exposed; only write() is available.
+ * There is no support for blocking with timeout: a write to a full FIFO returns
+ * a partial or zero count, as for a non-blocking audio_utils_fifo_writer.
+ *
+ * The reservation index lives in the multi-writer object, not in shared memory,
+ * so all writing threads must share one audio_utils_fifo_multiwriter in one process.
+ * Reader(s) are unaffected and may be in another process.
+ * Do not mix an audio_utils_fifo_writer and a multi-writer on the same FIFO.
+ */
+class audio_utils_fifo_multiwriter {
+
+public:
+    /**
+     * Construct a multi-writer for a FIFO.
+     *
+     * \param fifo Associated FIFO.  Passed by reference because it must be non-NULL.
+     *             The FIFO index synchronization must not be
+     *             AUDIO_UTILS_FIFO_SYNC_SINGLE_THREADED.
+     */
+    explicit audio_utils_fifo_multiwriter(audio_utils_fifo& fifo);
+    ~audio_utils_fifo_multiwriter();
+
+    /**
+     * Write to FIFO.  May be called concurrently from multiple threads.
+     *
+     * \param buffer  Pointer to source buffer containing \p count frames of data.
+     *                Pointer must be non-NULL if \p count is greater than zero.
+     * \param count   Desired number of frames to write.
+     *
+     * \return Actual number of frames written, if greater than or equal to zero.
+     *         Guaranteed to be <= \p count.
+     *         The actual transfer count may be zero if the FIFO is full,
+     *         or partial if the FIFO was almost full.
+     *  \retval -EIO  corrupted indices, no recovery is possible
+     */
+    ssize_t write(const void *buffer, size_t count);
+
+    /**
+     * Determine the number of frames that could be written without losing data.
+     * Inherently racy with respect to concurrent writers, so only a hint.
+     *
+     * \return Number of available frames, if greater than or equal to zero.
+     *  \retval -EIO  corrupted indices, no recovery is possible
+     */
+    ssize_t available();
+
+    /** Return the capacity, or statically configured maximum frame count. */
+    uint32_t capacity() const
+            { return mFifo.capacity(); }
+
+    /** Return the total number of frames written and published since construction. */
+    uint64_t totalReleased() const
+            { return mTotalReleased.load(std::memory_order_relaxed); }
+
+    /** Return a reference to the associated FIFO. */
+    audio_utils_fifo& fifo()    { return mFifo; }
+
+private:
+    audio_utils_fifo&       mFifo;
+
+    /**
+     * Frame index of the next slot to be claimed by a writer.
+     * Runs ahead of mFifo.mWriterRear by the total size of claimed
+     * but not yet published slices.
+     */
+    std::atomic<uint32_t>   mReserveRear;
+
+    /** Total number of frames written and published since construction. */
+    std::atomic<uint64_t>   mTotalReleased;
+
+    /** Number of in-order publication spins before yielding the CPU. */
+    static constexpr uint32_t kSpinsBeforeYield = 100;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
 /**
  * Used to read from a FIFO.  There can be one or more readers per FIFO,
  * and at most one of those readers can throttle the writer.
@@ -557,11 +883,41 @@ public:
      */
     ssize_t available(size_t *lost);
 
+    /**
+     * Read from FIFO without copying, by passing pointers directly into the buffer
+     * to a caller-supplied callback.  Resets the number of releasable frames to zero.
+     *
+     * The callback is invoked once per virtually contiguous fragment (so at most
+     * twice per call when the slice wraps), and returns the number of frames it
+     * consumed, <= the number offered.  Consumed frames are released; iteration
+     * stops on a short (partial) consumption.  The data must be fully processed
+     * before the callback returns, as the frames are then available for overwrite.
+     *
+     * \param via     Non-NULL callback invoked with \p cookie, a read-only pointer
+     *                to the first frame of a fragment, and the fragment length in
+     *                frames.  Returns the number of frames consumed.
+     * \param cookie  Opaque value passed through to the callback.
+     * \param count   Desired maximum number of frames to process.
+     * \param timeout See read().
+     * \param lost    See read().
+     *
+     * \return Actual number of frames processed and released, if greater than or
+     *         equal to zero; or a negative error code as listed for read().
+     */
+    ssize_t readVia(size_t (*via)(void *cookie, const void *buffer, size_t count),
+            void *cookie, size_t count = SIZE_MAX, const struct timespec *timeout = NULL,
+            size_t *lost = NULL);
+
     /**
      * Flush (discard) all frames that could be obtained or read without blocking.
      * Note that flush is a method on a reader, so if the writer wants to flush
      * then it must communicate the request to the reader(s) via an out-of-band channel.
      *
+     * If this reader throttles the writer and the FIFO has a flush epoch cell,
+     * the epoch is bumped and a writer blocked in write() or obtain() is woken,
+     * so the writer can observe the flush via flushRequested() and restart from
+     * fresh data instead of continuing to push stale frames.
+     *
      * \param lost    If non-NULL, set to the approximate number of frames lost before
      *                re-synchronization when -EOVERFLOW occurs, or set to zero when no frames lost.
      *
@@ -623,6 +979,15 @@ public:
     uint64_t totalFlushed() const
             { return mTotalFlushed; }
 
+    /**
+     * Return a snapshot of the integrity validation counters;
+     * see audio_utils_fifo::enableIntegrity().  All zero if integrity mode is off.
+     *
+     * \return Integrity statistics.
+     */
+    audio_utils_fifo_integrity_stats integrityStats() const
+            { return mIntegrityStats; }
+
 private:
     // Accessed by reader only using ordinary operations
     uint32_t     mLocalFront;   // frame index of first frame slot available to read, or read index
@@ -639,6 +1004,9 @@ private:
 
     uint64_t    mTotalLost;         // total lost frames, does not include flushed frames
     uint64_t    mTotalFlushed;      // total flushed frames, does not include lost frames
+
+    // Integrity validation counters, updated by read(); see integrityStats().
+    audio_utils_fifo_integrity_stats mIntegrityStats;
 };
 
 #endif  // !ANDROID_AUDIO_FIFO_H
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_FIFO_ASYNC_H
+#define ANDROID_AUDIO_FIFO_ASYNC_H
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <audio_utils/fifo.h>
+
+#ifndef __cplusplus
+#error C API is no longer supported
+#endif
+
+/**
+ * Services any number of FIFO readers from a single thread, as an alternative
+ * to one blocked reader thread per stream.
+ *
+ * A registered reader gets a completion callback on the service thread
+ * whenever at least the requested number of frames is available; the callback
+ * is expected to consume them (typically via read() or obtain()/release()).
+ * This replaces N per-stream thread stacks and their context switch storms
+ * with one thread, at the cost of up to one poll interval of added wakeup
+ * latency — the same trade as AUDIO_UTILS_FIFO_SYNC_SLEEP, and appropriate
+ * for capture paths with tens of consumers.
+ *
+ * The service thread sleeps on an internal index futex with the poll interval
+ * as timeout, so registration, shutdown, and (on release of a registration)
+ * rescans take effect immediately rather than after a full tick.
+ */
+class audio_utils_fifo_async_service {
+
+public:
+
+    /**
+     * Completion callback, invoked on the service thread.
+     *
+     * \param reader    The registered reader, ready for a non-blocking read.
+     * \param available Number of frames available if greater than or equal to zero,
+     *                  or a negative error code from available(), e.g. -EIO or
+     *                  -EOVERFLOW, after which the registration is removed.
+     *
+     * The callback should consume frames and return promptly; it is called
+     * again on a later pass while at least the requested frames remain.
+     */
+    using callback_t = std::function<void(audio_utils_fifo_reader &reader, ssize_t available)>;
+
+    /**
+     * Construct a service and start its thread.
+     *
+     * \param pollNs Poll interval in nanoseconds > 0, the upper bound on added
+     *               wakeup latency.  Defaults to 2 ms to match a typical fast
+     *               mixer period.
+     */
+    explicit audio_utils_fifo_async_service(int64_t pollNs = 2000000);
+
+    /**
+     * Destroy the service.  Joins the service thread; no callbacks are invoked
+     * after the destructor returns.  Outstanding registrations are discarded.
+     */
+    ~audio_utils_fifo_async_service();
+
+    /**
+     * Register a reader for completion callbacks.
+     * The reader and its FIFO must outlive the registration.
+     *
+     * \param reader    Reader to wait on.  Must not be used from other threads
+     *                  while registered, except as documented for the callback.
+     * \param minFrames Invoke the callback when at least this many frames are
+     *                  available, > 0.
+     * \param callback  Non-NULL completion callback.
+     *
+     * \return Positive registration handle for unregisterReader().
+     */
+    int registerReader(audio_utils_fifo_reader &reader, size_t minFrames, callback_t callback);
+
+    /**
+     * Remove a registration.  After return, the callback is not invoked again,
+     * unless a call on the service thread was already in progress; that call
+     * completes before this method returns only if invoked off the service
+     * thread.  Safe to call from within the callback itself.
+     *
+     * \param handle Registration handle from registerReader(); stale or
+     *               already-removed handles are ignored.
+     */
+    void unregisterReader(int handle);
+
+private:
+    void threadLoop();
+    void wakeLocked();
+
+    struct Entry {
+        audio_utils_fifo_reader&    mReader;
+        const size_t                mMinFrames;
+        const callback_t            mCallback;
+        bool                        mActive = true;     // cleared by unregisterReader()
+
+        Entry(audio_utils_fifo_reader &reader, size_t minFrames, callback_t callback) :
+            mReader(reader), mMinFrames(minFrames), mCallback(std::move(callback)) { }
+    };
+
+    const int64_t               mPollNs;
+
+    std::mutex                  mLock;      // guards the fields below
+    std::map<int, std::shared_ptr<Entry>>   mEntries;
+    int                         mNextHandle = 1;
+    bool                        mQuit = false;
+
+    audio_utils_fifo_index      mWake;      // service thread sleeps on this futex
+    std::thread                 mThread;    // last, so the thread starts fully initialized
+};
+
+#endif  // !ANDROID_AUDIO_FIFO_ASYNC_H
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_FIFO_POOL_H
+#define ANDROID_AUDIO_FIFO_POOL_H
+
+#include <mutex>
+#include <stddef.h>
+#include <vector>
+#include <audio_utils/fifo_index.h>
+
+#ifndef __cplusplus
+#error C API is no longer supported
+#endif
+
+/**
+ * One ring buffer allocation handed out by audio_utils_fifo_pool.
+ * The buffer and both indices live in a single page-aligned, prefaulted
+ * mapping owned by the pool; the indices are constructed (reset to zero)
+ * on each acquire() and are placed on separate cache lines.
+ * Suitable for the buffer and index parameters of the audio_utils_fifo
+ * constructors.
+ */
+struct audio_utils_fifo_pool_buffer {
+    /** Page-aligned, prefaulted buffer of capacityBytes() usable bytes. */
+    void                    *mBuffer;
+    /** Writer's rear index, constructed, ready for use. */
+    audio_utils_fifo_index  *mWriterRear;
+    /** Throttling reader's front index, constructed, ready for use. */
+    audio_utils_fifo_index  *mThrottleFront;
+};
+
+/**
+ * A pool of preallocated ring buffers with their associated indices,
+ * intended for processes that open and close many streams.
+ *
+ * Allocation happens once at pool construction: each slot is mmap()ed,
+ * prefaulted so that stream open does not take page faults on first use,
+ * and, where the kernel supports it, eligible for transparent huge pages
+ * to reduce TLB pressure on large rings.  acquire() and release() just
+ * move slots on and off a free list under a mutex; the free list is LIFO
+ * so a recently released (cache and TLB warm) buffer is reused first.
+ *
+ * The pool grows by one slot if acquire() finds the free list empty, so
+ * a conservative initial bufferCount degrades to the old allocate-per-open
+ * behavior rather than failing.
+ *
+ * The mappings are private to the process; for multi-process FIFOs the
+ * shared memory must still be provided by the caller as before.
+ * All public methods are multi-thread safe.
+ */
+class audio_utils_fifo_pool {
+
+public:
+
+    /**
+     * Construct a pool and preallocate its initial slots.
+     *
+     *  \param bufferCount   Number of ring buffers to preallocate >= 0.
+     *  \param capacityBytes Usable bytes per ring buffer > 0,
+     *                       rounded up to a multiple of the page size.
+     */
+    audio_utils_fifo_pool(size_t bufferCount, size_t capacityBytes);
+
+    /**
+     * Destroy the pool and unmap all slots.
+     * All acquired buffers must have been released; this is fatal otherwise,
+     * as the mappings underlying any outstanding FIFO would disappear.
+     */
+    ~audio_utils_fifo_pool();
+
+    /**
+     * Obtain a buffer from the pool, allocating a new slot if the pool
+     * is exhausted.  The indices are freshly constructed.
+     *
+     * \return A buffer of capacityBytes() usable bytes,
+     *         or NULL if a slot could not be allocated.
+     */
+    audio_utils_fifo_pool_buffer *acquire();
+
+    /**
+     * Return a buffer to the pool for reuse.
+     * The associated FIFO, writer(s), and reader(s) must be destroyed first.
+     *
+     * \param buffer A non-NULL buffer previously returned by acquire().
+     */
+    void release(audio_utils_fifo_pool_buffer *buffer);
+
+    /** Return the usable bytes per ring buffer, after page size round up. */
+    size_t capacityBytes() const
+            { return mCapacityBytes; }
+
+    /** Return the number of buffers on the free list. */
+    size_t available() const;
+
+private:
+    // Allocate, prefault, and wrap one slot; returns NULL on mmap failure.
+    audio_utils_fifo_pool_buffer *allocateSlot();
+
+    // These fields are const after initialization
+    const size_t    mCapacityBytes; // usable bytes per ring, page multiple
+    const size_t    mSlotBytes;     // mCapacityBytes + one page for the indices
+
+    mutable std::mutex  mLock;      // guards the fields below
+    std::vector<audio_utils_fifo_pool_buffer *> mFree;  // LIFO free list
+    size_t          mOutstanding;   // buffers acquired but not yet released
+};
+
+#endif  // !ANDROID_AUDIO_FIFO_POOL_H
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_FIFO_SHM_H
+#define ANDROID_AUDIO_FIFO_SHM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <audio_utils/fifo_index.h>
+
+/** Flags for audio_utils_fifo_shm::create(). */
+enum audio_utils_fifo_shm_flags : uint32_t {
+    AUDIO_UTILS_FIFO_SHM_NONE       = 0,
+    /**
+     * Back the mapping with 2 MB huge pages when the kernel can provide
+     * them, reducing TLB pressure for large rings.  Silently falls back
+     * to normal pages when huge pages are not configured.
+     */
+    AUDIO_UTILS_FIFO_SHM_HUGE_PAGES = 0x1,
+};
+
+/**
+ * Owns one shared memory mapping laid out for the multi-process
+ * audio_utils_fifo constructor: a self-describing header, the writer rear
+ * index and the reader front index each on their own cache line, then the
+ * ring buffer.  Allocating everything in a single mapping keeps the indexes
+ * and the hot ring on the same pages (and the same huge page when
+ * requested), and gives client processes a single file descriptor to
+ * exchange instead of three separately mapped regions.
+ *
+ * The creating process calls create(), which constructs the indexes exactly
+ * once; every other process receives the file descriptor and calls attach().
+ * Either side then constructs its audio_utils_fifo from writerRear(),
+ * throttleFront() and buffer().
+ */
+class audio_utils_fifo_shm {
+public:
+    /**
+     * Allocate and map the combined region and construct the indexes.
+     * Must be called by exactly one process; the others use attach().
+     *
+     *  \param frameCount  As for the audio_utils_fifo constructor.
+     *  \param frameSize   As for the audio_utils_fifo constructor.
+     *  \param flags       Bitwise OR of audio_utils_fifo_shm_flags.
+     *  \param numaNode    NUMA node to bind the mapping to, or -1 for the
+     *                     kernel's default placement.  An explicit binding
+     *                     that the kernel refuses fails the creation, as the
+     *                     caller asked for locality.
+     *  \param shm         Receives the new object on success.
+     *
+     * \return 0 on success, or a negative errno value.
+     */
+    static int create(uint32_t frameCount, uint32_t frameSize, uint32_t flags,
+            int numaNode, audio_utils_fifo_shm **shm);
+
+    /**
+     * Map a region created by create() in another process.
+     * Does not construct the indexes.
+     *
+     *  \param fd   File descriptor obtained from the creator's fd(),
+     *              typically received over a socket or inherited on fork.
+     *              The caller retains ownership; attach() duplicates it.
+     *  \param shm  Receives the new object on success.
+     *
+     * \return 0 on success, or a negative errno value;
+     *         -EINVAL if the region was not created by create() or is truncated.
+     */
+    static int attach(int fd, audio_utils_fifo_shm **shm);
+
+    /** Unmap the region and close our duplicate of the file descriptor. */
+    ~audio_utils_fifo_shm();
+
+    /** Return the file descriptor to pass to attaching processes. */
+    int fd() const
+            { return mFd; }
+
+    /** Return the writer's rear index within the mapping. */
+    audio_utils_fifo_index *writerRear() const;
+
+    /** Return the reader's front index within the mapping. */
+    audio_utils_fifo_index *throttleFront() const;
+
+    /** Return the ring buffer within the mapping, frameCount() frames. */
+    void *buffer() const;
+
+    uint32_t frameCount() const;
+    uint32_t frameSize() const;
+
+private:
+    audio_utils_fifo_shm(int fd, void *base, size_t mappedSize);
+
+    const int    mFd;         // owned duplicate of the region's descriptor
+    void * const mBase;       // start of the mapping, holds the header
+    const size_t mMappedSize; // length of the mapping, page or huge page rounded
+};
+
+#endif  // ANDROID_AUDIO_FIFO_SHM_H
@@ -40,6 +40,11 @@
  *  - construct an ordinary reader based on that FIFO
  *  - construct a writer_T using the FIFO
  *  - use a sequence of write and write1, followed by storeSingleThreaded or storeRelease to commit
+ *
+ * Alternatively, call setBatchFrames() to have the writer publish automatically
+ * with a single release store once per batch of frames, instead of after every
+ * call.  This bounds the rate at which the reader's cached copy of the rear
+ * index is invalidated, which matters for high-rate streams of small frames.
  */
 template <typename T>
 class audio_utils_fifo_writer_T /* : public audio_utils_fifo_provider */ {
@@ -63,9 +68,23 @@ public:
      * Write one T value to FIFO.
      */
     void write1(const T& value)
-            __attribute__((no_sanitize("integer")))     // mLocalRear ++ can wrap
+            __attribute__((no_sanitize("integer")))     // mLocalRear ++ can wrap, as can mPending
     {
         mBuffer[mLocalRear++ & (mFrameCountP2 - 1)] = value;
+        if (mBatchFrames != 0 && ++mPending >= mBatchFrames) {
+            storeRelease();
+        }
+    }
+
+    /**
+     * Set the number of frames to accumulate before publishing automatically
+     * with a single release store, or zero (the default) for no automatic
+     * publication, i.e. the caller commits explicitly as before.
+     * A partial batch is not published until it fills or the caller commits;
+     * latency-sensitive callers should commit explicitly at stream pauses.
+     */
+    void setBatchFrames(uint32_t batchFrames) {
+        mBatchFrames = batchFrames;
     }
 
     /**
@@ -74,6 +93,7 @@ public:
      */
     void storeSingleThreaded() {
         mWriterRear.storeSingleThreaded(mLocalRear);
+        mPending = 0;
     }
 
     /**
@@ -82,11 +102,14 @@ public:
      */
     void storeRelease() {
         mWriterRear.storeRelease(mLocalRear);
+        mPending = 0;
     }
 
 private:
     // Accessed by writer only using ordinary operations
     uint32_t    mLocalRear; // frame index of next frame slot available to write, or write index
+    uint32_t    mBatchFrames;   // automatic publication interval in frames, 0 for manual commit
+    uint32_t    mPending;       // frames written but not yet published
 
     // These fields are copied from fifo for better performance (avoids an extra de-reference)
     const uint32_t          mFrameCountP2;
@@ -28,6 +28,14 @@ __BEGIN_DECLS
 void fixed_fft(int n, int32_t *v);
 void fixed_fft_real(int n, int32_t *v);
 
+/**
+ * Single precision counterparts for float end-to-end pipelines; complex
+ * values are adjacent (real, imaginary) float pairs, so \p v holds 2n floats.
+ * See description in fixedfft.cpp.
+ */
+void float_fft(int n, float *v);
+void float_fft_real(int n, float *v);
+
 /** \cond */
 __END_DECLS
 /** \endcond */
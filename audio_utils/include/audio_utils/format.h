@@ -64,6 +64,78 @@ __BEGIN_DECLS
 void memcpy_by_audio_format(void *dst, audio_format_t dst_format,
         const void *src, audio_format_t src_format, size_t count);
 
+/**
+ * Convert a buffer between sample formats in place.
+ *
+ *  \param buf        Buffer holding count samples of src_format on entry and
+ *                    count samples of dst_format on return
+ *  \param dst_format Destination sample format
+ *  \param src_format Source sample format
+ *  \param count      Number of samples to convert
+ *
+ * The permitted format pairs are those of memcpy_by_audio_format().
+ * buf must be large enough for the wider of the two formats, i.e.
+ * count * max(audio_bytes_per_sample(dst_format), audio_bytes_per_sample(src_format))
+ * bytes; for an expanding conversion the caller allocates at the destination
+ * size and fills only the source-sized prefix.
+ *
+ * Conversions to a wider format are performed back to front and conversions to
+ * a narrower or same-width format front to back, so no sample is overwritten
+ * before it is read and no scratch buffer is needed.
+ *
+ * Logs a fatal error if dst or src format is not allowed by the conversion rules.
+ */
+void memcpy_by_audio_format_inplace(void *buf, audio_format_t dst_format,
+        audio_format_t src_format, size_t count);
+
+/**
+ * Conversion function resolved by audio_format_get_converter().
+ */
+typedef void (*audio_format_converter_t)(void *dst, const void *src, size_t count);
+
+/**
+ * Resolve a (dst_format, src_format) pair to its conversion function.
+ *
+ *  \param dst_format Destination buffer format
+ *  \param src_format Source buffer format
+ *
+ * \return a function converting count samples as if by memcpy_by_audio_format(),
+ * or NULL if the format pair is not supported (see the conversion rules above).
+ *
+ * Intended for hot paths: resolve once at stream configuration time and call
+ * the returned pointer per period with no further format dispatch.
+ */
+audio_format_converter_t audio_format_get_converter(audio_format_t dst_format,
+        audio_format_t src_format);
+
+/**
+ * Buffer descriptor for memcpy_by_audio_format_multi().
+ */
+typedef struct audio_format_buffer_desc {
+    void *dst;        /**< Destination buffer */
+    const void *src;  /**< Source buffer */
+    size_t count;     /**< Number of samples to copy */
+} audio_format_buffer_desc_t;
+
+/**
+ * Copy a batch of buffers sharing one (dst_format, src_format) pair.
+ *
+ *  \param dst_format Destination buffers format
+ *  \param src_format Source buffers format
+ *  \param descs      Array of buffer descriptors, each converted as if by
+ *                    memcpy_by_audio_format()
+ *  \param num_descs  Number of descriptors in descs
+ *
+ * The format pair is resolved to a conversion function once for the whole
+ * batch, so callers converting many streams per period (e.g. a mixer) avoid
+ * repeating the per-call format dispatch and keep one conversion kernel hot.
+ * The permitted format pairs and the buffer overlap rules are those of
+ * memcpy_by_audio_format().
+ *
+ * Logs a fatal error if dst or src format is not allowed by the conversion rules.
+ */
+void memcpy_by_audio_format_multi(audio_format_t dst_format, audio_format_t src_format,
+        const audio_format_buffer_desc_t *descs, size_t num_descs);
 
 /**
  * This function creates an index array for converting audio data with different
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_FORMAT_TRAITS_H
+#define ANDROID_AUDIO_FORMAT_TRAITS_H
+
+#include <cstring>
+
+#include <audio_utils/format.h>
+#include <audio_utils/primitives.h>
+
+/**
+ * \file format_traits.h
+ * Compile-time resolved sample format conversion.
+ *
+ * When the (dst, src) format pair is known at compile time, convert<DST, SRC>()
+ * inlines the underlying primitives.h kernel directly with no per-call dispatch.
+ * When the pair is only known at stream open, use audio_format_get_converter()
+ * from format.h to resolve it once and call the returned pointer per period.
+ *
+ * The supported pairs are exactly those of memcpy_by_audio_format();
+ * unsupported pairs fail to compile instead of asserting at runtime.
+ */
+namespace android::audio_utils::format {
+
+/**
+ * Maps an audio_format_t onto the C sample type used by the primitives.h
+ * kernels, and its size in bytes (which differs from sizeof(type) for
+ * packed 24 bit, stored as 3 uint8_t per sample).
+ */
+template <audio_format_t F>
+struct format_traits;
+
+template <>
+struct format_traits<AUDIO_FORMAT_PCM_8_BIT> {
+    using type = uint8_t;
+    static constexpr size_t bytes_per_sample = 1;
+};
+
+template <>
+struct format_traits<AUDIO_FORMAT_PCM_16_BIT> {
+    using type = int16_t;
+    static constexpr size_t bytes_per_sample = 2;
+};
+
+template <>
+struct format_traits<AUDIO_FORMAT_PCM_24_BIT_PACKED> {
+    using type = uint8_t;  // 3 bytes per sample
+    static constexpr size_t bytes_per_sample = 3;
+};
+
+template <>
+struct format_traits<AUDIO_FORMAT_PCM_8_24_BIT> {
+    using type = int32_t;
+    static constexpr size_t bytes_per_sample = 4;
+};
+
+template <>
+struct format_traits<AUDIO_FORMAT_PCM_32_BIT> {
+    using type = int32_t;
+    static constexpr size_t bytes_per_sample = 4;
+};
+
+template <>
+struct format_traits<AUDIO_FORMAT_PCM_FLOAT> {
+    using type = float;
+    static constexpr size_t bytes_per_sample = 4;
+};
+
+// For static_assert(false) in the final else, see intrinsic_utils.h.
+template <audio_format_t DST, audio_format_t SRC>
+inline constexpr bool unsupported_conversion_v = false;
+
+/**
+ * Convert count samples from SRC format to DST format, statically dispatched.
+ *
+ * Pointer types are the trait types above, so a mismatched buffer type is a
+ * compile error.  Buffer overlap rules are those of memcpy_by_audio_format().
+ */
+template <audio_format_t DST, audio_format_t SRC>
+inline void convert(typename format_traits<DST>::type *dst,
+        const typename format_traits<SRC>::type *src, size_t count)
+{
+    constexpr audio_format_t D = DST;  // shorthand for readability below
+    constexpr audio_format_t S = SRC;
+    if constexpr (D == S) {
+        if (dst != src) {
+            memcpy(dst, src, count * format_traits<D>::bytes_per_sample);
+        }
+    } else if constexpr (D == AUDIO_FORMAT_PCM_16_BIT && S == AUDIO_FORMAT_PCM_FLOAT) {
+        memcpy_to_i16_from_float(dst, src, count);
+    } else if constexpr (D == AUDIO_FORMAT_PCM_16_BIT && S == AUDIO_FORMAT_PCM_8_BIT) {
+        memcpy_to_i16_from_u8(dst, src, count);
+    } else if constexpr (D == AUDIO_FORMAT_PCM_16_BIT && S == AUDIO_FORMAT_PCM_24_BIT_PACKED) {
+        memcpy_to_i16_from_p24(dst, src, count);
+    } else if constexpr (D == AUDIO_FORMAT_PCM_16_BIT && S == AUDIO_FORMAT_PCM_32_BIT) {
+        memcpy_to_i16_from_i32(dst, src, count);
+    } else if constexpr (D == AUDIO_FORMAT_PCM_16_BIT && S == AUDIO_FORMAT_PCM_8_24_BIT) {
+        memcpy_to_i16_from_q8_23(dst, src, count);
+    } else if constexpr (D == AUDIO_FORMAT_PCM_FLOAT && S == AUDIO_FORMAT_PCM_16_BIT) {
+        memcpy_to_float_from_i16(dst, src, count);
+    } else if constexpr (D == AUDIO_FORMAT_PCM_FLOAT && S == AUDIO_FORMAT_PCM_8_BIT) {
+        memcpy_to_float_from_u8(dst, src, count);
+    } else if constexpr (D == AUDIO_FORMAT_PCM_FLOAT && S == AUDIO_FORMAT_PCM_24_BIT_PACKED) {
+        memcpy_to_float_from_p24(dst, src, count);
+    } else if constexpr (D == AUDIO_FORMAT_PCM_FLOAT && S == AUDIO_FORMAT_PCM_32_BIT) {
+        memcpy_to_float_from_i32(dst, src, count);
+    } else if constexpr (D == AUDIO_FORMAT_PCM_FLOAT && S == AUDIO_FORMAT_PCM_8_24_BIT) {
+        memcpy_to_float_from_q8_23(dst, src, count);
+    } else if constexpr (D == AUDIO_FORMAT_PCM_8_BIT && S == AUDIO_FORMAT_PCM_16_BIT) {
+        memcpy_to_u8_from_i16(dst, src, count);
+    } else if constexpr (D == AUDIO_FORMAT_PCM_8_BIT && S == AUDIO_FORMAT_PCM_FLOAT) {
+        memcpy_to_u8_from_float(dst, src, count);
+    } else if constexpr (D == AUDIO_FORMAT_PCM_8_BIT && S == AUDIO_FORMAT_PCM_24_BIT_PACKED) {
+        memcpy_to_u8_from_p24(dst, src, count);
+    } else if constexpr (D == AUDIO_FORMAT_PCM_8_BIT && S == AUDIO_FORMAT_PCM_32_BIT) {
+        memcpy_to_u8_from_i32(dst, src, count);
+    } else if constexpr (D == AUDIO_FORMAT_PCM_8_BIT && S == AUDIO_FORMAT_PCM_8_24_BIT) {
+        memcpy_to_u8_from_q8_23(dst, src, count);
+    } else if constexpr (D == AUDIO_FORMAT_PCM_24_BIT_PACKED && S == AUDIO_FORMAT_PCM_16_BIT) {
+        memcpy_to_p24_from_i16(dst, src, count);
+    } else if constexpr (D == AUDIO_FORMAT_PCM_24_BIT_PACKED && S == AUDIO_FORMAT_PCM_FLOAT) {
+        memcpy_to_p24_from_float(dst, src, count);
+    } else if constexpr (D == AUDIO_FORMAT_PCM_24_BIT_PACKED && S == AUDIO_FORMAT_PCM_32_BIT) {
+        memcpy_to_p24_from_i32(dst, src, count);
+    } else if constexpr (D == AUDIO_FORMAT_PCM_24_BIT_PACKED && S == AUDIO_FORMAT_PCM_8_24_BIT) {
+        memcpy_to_p24_from_q8_23(dst, src, count);
+    } else if constexpr (D == AUDIO_FORMAT_PCM_32_BIT && S == AUDIO_FORMAT_PCM_16_BIT) {
+        memcpy_to_i32_from_i16(dst, src, count);
+    } else if constexpr (D == AUDIO_FORMAT_PCM_32_BIT && S == AUDIO_FORMAT_PCM_FLOAT) {
+        memcpy_to_i32_from_float(dst, src, count);
+    } else if constexpr (D == AUDIO_FORMAT_PCM_32_BIT && S == AUDIO_FORMAT_PCM_24_BIT_PACKED) {
+        memcpy_to_i32_from_p24(dst, src, count);
+    } else if constexpr (D == AUDIO_FORMAT_PCM_8_24_BIT && S == AUDIO_FORMAT_PCM_16_BIT) {
+        memcpy_to_q8_23_from_i16(dst, src, count);
+    } else if constexpr (D == AUDIO_FORMAT_PCM_8_24_BIT && S == AUDIO_FORMAT_PCM_FLOAT) {
+        memcpy_to_q8_23_from_float_with_clamp(dst, src, count);
+    } else if constexpr (D == AUDIO_FORMAT_PCM_8_24_BIT && S == AUDIO_FORMAT_PCM_24_BIT_PACKED) {
+        memcpy_to_q8_23_from_p24(dst, src, count);
+    } else {
+        static_assert(unsupported_conversion_v<DST, SRC>,
+                "unsupported format conversion pair");
+    }
+}
+
+}  // namespace android::audio_utils::format
+
+#endif  // !ANDROID_AUDIO_FORMAT_TRAITS_H
@@ -195,6 +195,80 @@ static inline T vld1(const F *f) {
     }
 }
 
+/**
+ * Deinterleaving load of C channels from an interleaved sample pointer.
+ *
+ * Reads C * (samples per T) contiguous interleaved samples starting at \p f
+ * and returns a struct whose element i holds channel i as type T, ready for
+ * the math functions in this file.  Maps to the vld2/vld4 structure loads on
+ * NEON; elsewhere the scalar loop is shaped so the compiler lowers it to
+ * shuffle sequences when vectorizing the enclosing kernel (see the dispatch
+ * comments below).
+ */
+template<typename T, size_t C, typename F>
+static inline internal_array_t<T, C> vload_deinterleave(const F *f) {
+    internal_array_t<T, C> ret;
+
+#ifdef USE_NEON
+    if constexpr (std::is_same_v<T, float32x2_t> && C == 2) {
+        const float32x2x2_t t = vld2_f32(f);
+        ret.v[0] = t.val[0];
+        ret.v[1] = t.val[1];
+        return ret;
+    } else if constexpr (std::is_same_v<T, float32x2_t> && C == 4) {
+        const float32x2x4_t t = vld4_f32(f);
+#pragma unroll
+        for (size_t c = 0; c < C; ++c) {
+            ret.v[c] = t.val[c];
+        }
+        return ret;
+    } else if constexpr (std::is_same_v<T, float32x4_t> && C == 2) {
+        const float32x4x2_t t = vld2q_f32(f);
+        ret.v[0] = t.val[0];
+        ret.v[1] = t.val[1];
+        return ret;
+    } else if constexpr (std::is_same_v<T, float32x4_t> && C == 4) {
+        const float32x4x4_t t = vld4q_f32(f);
+#pragma unroll
+        for (size_t c = 0; c < C; ++c) {
+            ret.v[c] = t.val[c];
+        }
+        return ret;
+#if defined(__aarch64__)
+    } else if constexpr (std::is_same_v<T, float64x2_t> && C == 2) {
+        const float64x2x2_t t = vld2q_f64(f);
+        ret.v[0] = t.val[0];
+        ret.v[1] = t.val[1];
+        return ret;
+    } else if constexpr (std::is_same_v<T, float64x2_t> && C == 4) {
+        const float64x2x4_t t = vld4q_f64(f);
+#pragma unroll
+        for (size_t c = 0; c < C; ++c) {
+            ret.v[c] = t.val[c];
+        }
+        return ret;
+#endif
+    } else
+#endif // USE_NEON
+
+    /* constexpr */ {
+        constexpr size_t lanes = sizeof(T) / sizeof(F);
+        F tmp[C][lanes];
+#pragma unroll
+        for (size_t i = 0; i < lanes; ++i) {
+#pragma unroll
+            for (size_t c = 0; c < C; ++c) {
+                tmp[c][i] = f[i * C + c];
+            }
+        }
+#pragma unroll
+        for (size_t c = 0; c < C; ++c) {
+            ret.v[c] = vld1<T>(tmp[c]);
+        }
+        return ret;
+    }
+}
+
 /**
  * Returns c as follows:
  * c_i = a_i * b_i if a and b are the same vector type or
@@ -464,6 +538,74 @@ static inline void vst1(F *f, T a) {
     }
 }
 
+/**
+ * Interleaving store of C channels to an interleaved sample pointer.
+ *
+ * The inverse of vload_deinterleave: writes element i of \p a as channel i,
+ * C * (samples per T) contiguous interleaved samples starting at \p f.
+ * Maps to the vst2/vst4 structure stores on NEON.
+ */
+template<typename T, size_t C, typename F>
+static inline void vstore_interleave(F *f, internal_array_t<T, C> a) {
+#ifdef USE_NEON
+    if constexpr (std::is_same_v<T, float32x2_t> && C == 2) {
+        float32x2x2_t t;
+        t.val[0] = a.v[0];
+        t.val[1] = a.v[1];
+        vst2_f32(f, t);
+    } else if constexpr (std::is_same_v<T, float32x2_t> && C == 4) {
+        float32x2x4_t t;
+#pragma unroll
+        for (size_t c = 0; c < C; ++c) {
+            t.val[c] = a.v[c];
+        }
+        vst4_f32(f, t);
+    } else if constexpr (std::is_same_v<T, float32x4_t> && C == 2) {
+        float32x4x2_t t;
+        t.val[0] = a.v[0];
+        t.val[1] = a.v[1];
+        vst2q_f32(f, t);
+    } else if constexpr (std::is_same_v<T, float32x4_t> && C == 4) {
+        float32x4x4_t t;
+#pragma unroll
+        for (size_t c = 0; c < C; ++c) {
+            t.val[c] = a.v[c];
+        }
+        vst4q_f32(f, t);
+#if defined(__aarch64__)
+    } else if constexpr (std::is_same_v<T, float64x2_t> && C == 2) {
+        float64x2x2_t t;
+        t.val[0] = a.v[0];
+        t.val[1] = a.v[1];
+        vst2q_f64(f, t);
+    } else if constexpr (std::is_same_v<T, float64x2_t> && C == 4) {
+        float64x2x4_t t;
+#pragma unroll
+        for (size_t c = 0; c < C; ++c) {
+            t.val[c] = a.v[c];
+        }
+        vst4q_f64(f, t);
+#endif
+    } else
+#endif // USE_NEON
+
+    /* constexpr */ {
+        constexpr size_t lanes = sizeof(T) / sizeof(F);
+        F tmp[C][lanes];
+#pragma unroll
+        for (size_t c = 0; c < C; ++c) {
+            vst1(tmp[c], a.v[c]);
+        }
+#pragma unroll
+        for (size_t i = 0; i < lanes; ++i) {
+#pragma unroll
+            for (size_t c = 0; c < C; ++c) {
+                f[i * C + c] = tmp[c][i];
+            }
+        }
+    }
+}
+
 // subtract a - b
 template<typename T>
 static inline T vsub(T a, T b) {
@@ -503,6 +645,94 @@ static inline T vsub(T a, T b) {
     }
 }
 
+/*
+  Runtime CPU feature dispatch.
+
+  The intrinsics above are selected at compile time: the templates inline into
+  their callers, so on x86 the scalar fallback is taken even when the CPU
+  supports wider vectors than the build baseline.  Since the selection is
+  per-call inline code, dispatch is done at the level of the processing kernel
+  (e.g. a filter loop using vmul/vmla/vadd), not per intrinsic: compile the
+  kernel once per ISA of interest (on x86 with __attribute__((target("avx2")))
+  so the scalar paths above auto-vectorize to the wider registers) and resolve
+  the best variant once through dsp_dispatch, typically as a function scope
+  static.
+*/
+
+// ISA variants a kernel may be compiled for.  scalar is the build baseline
+// and is always available; neon is a compile time property of the target.
+enum class dsp_isa {
+    scalar,
+    neon,
+    avx2,
+};
+
+// string conversion for logging and benchmark labels.
+inline constexpr const char *dsp_isa_to_string(dsp_isa isa) {
+    switch (isa) {
+    case dsp_isa::scalar: return "scalar";
+    case dsp_isa::neon:   return "neon";
+    case dsp_isa::avx2:   return "avx2";
+    }
+    return "unknown";
+}
+
+// Returns the best ISA the CPU we are running on supports.
+inline dsp_isa best_dsp_isa() {
+#if defined(USE_NEON)
+    return dsp_isa::neon;
+#elif defined(__i386__) || defined(__x86_64__)
+    // cached so the cpuid check runs once.
+    static const dsp_isa isa =
+            __builtin_cpu_supports("avx2") ? dsp_isa::avx2 : dsp_isa::scalar;
+    return isa;
+#else
+    return dsp_isa::scalar;
+#endif
+}
+
+/**
+ * Resolves a kernel function pointer to the best ISA variant supplied.
+ *
+ * The scalar variant is required; variants for ISAs the CPU (or build) does
+ * not support are ignored, and omitted variants fall back to scalar.
+ * Resolution happens at construction, so a function scope static dispatcher
+ * pays the cpuid check only on first call:
+ *
+ *   static const dsp_dispatch<void, float *, const float *, size_t> process(
+ *           processScalar, processNeon, processAvx2);
+ *   process(out, in, frames);
+ */
+template <typename Ret, typename... Args>
+class dsp_dispatch {
+public:
+    using function_t = Ret (*)(Args...);
+
+    explicit dsp_dispatch(function_t scalar,
+            function_t neon = nullptr, function_t avx2 = nullptr)
+        : mIsa(selectIsa(neon != nullptr, avx2 != nullptr))
+        , mFunction(mIsa == dsp_isa::neon ? neon
+                : mIsa == dsp_isa::avx2 ? avx2 : scalar) {}
+
+    Ret operator()(Args... args) const {
+        return mFunction(args...);
+    }
+
+    // the variant operator() calls, for logging and benchmark labels.
+    dsp_isa isa() const { return mIsa; }
+
+private:
+    static dsp_isa selectIsa(bool hasNeon, bool hasAvx2) {
+        const dsp_isa best = best_dsp_isa();
+        if (best == dsp_isa::neon && hasNeon) return dsp_isa::neon;
+        if (best == dsp_isa::avx2 && hasAvx2) return dsp_isa::avx2;
+        return dsp_isa::scalar;
+    }
+
+    const dsp_isa mIsa;
+    const function_t mFunction;
+};
+
 } // namespace android::audio_utils::intrinsics
 
 #pragma pop_macro("USE_NEON")
@@ -17,6 +17,8 @@
 #ifndef ANDROID_AUDIO_LIMITER_H
 #define ANDROID_AUDIO_LIMITER_H
 
+#include <stddef.h>
+#include <stdint.h>
 #include <sys/cdefs.h>
 
 /** \cond */
@@ -33,6 +35,58 @@ __BEGIN_DECLS
  */
 float limiter(float in);
 
+/**
+ * Opaque state of a brickwall lookahead limiter.
+ *
+ * The limiter delays the signal by the lookahead, tracks the per-frame
+ * peak over the lookahead window with a monotonic deque (O(1) amortized
+ * per frame), and applies a gain that is guaranteed to keep every output
+ * sample at or below the threshold.  Gain reduction engages ahead of the
+ * peak (the lookahead acts as the attack) and recovers with a one-pole
+ * release.
+ */
+typedef struct lookahead_limiter lookahead_limiter_t;
+
+/**
+ * Creates a lookahead limiter.
+ *
+ * \param sample_rate      sample rate in Hz, used to derive the release coefficient.
+ * \param channel_count    interleaved channels per frame, must be positive.
+ * \param lookahead_frames delay and attack time in frames; 0 gives a zero-latency
+ *                         limiter with instantaneous attack.
+ * \param threshold        linear output ceiling, e.g. 0.98f; must be positive.
+ * \param release_ms       release time constant in milliseconds.
+ * \return the limiter state, or NULL on failure.
+ */
+lookahead_limiter_t *lookahead_limiter_create(uint32_t sample_rate,
+        uint32_t channel_count, uint32_t lookahead_frames,
+        float threshold, float release_ms);
+
+/** Frees the limiter state.  NULL is permitted. */
+void lookahead_limiter_free(lookahead_limiter_t *limiter);
+
+/** Clears the delay line and gain history, e.g. before reuse on a new stream. */
+void lookahead_limiter_reset(lookahead_limiter_t *limiter);
+
+/** \return the limiter latency in frames (equal to lookahead_frames). */
+uint32_t lookahead_limiter_get_delay(const lookahead_limiter_t *limiter);
+
+/**
+ * Processes frames of interleaved float audio.  The output lags the input
+ * by the lookahead; the first lookahead_frames output frames of a fresh
+ * (or reset) limiter are silence.  In-place operation (out == in) is
+ * permitted.
+ */
+void lookahead_limiter_process(lookahead_limiter_t *limiter,
+        float *out, const float *in, size_t frames);
+
+/**
+ * As lookahead_limiter_process() but for interleaved Q15 (int16_t) audio.
+ * The threshold is interpreted on the [-1.0, 1.0) scale of the Q15 data.
+ */
+void lookahead_limiter_process_q15(lookahead_limiter_t *limiter,
+        int16_t *out, const int16_t *in, size_t frames);
+
 /** \cond */
 __END_DECLS
 /** \endcond */
@@ -17,6 +17,7 @@
 #ifndef ANDROID_AUDIO_MINIFLOAT_H
 #define ANDROID_AUDIO_MINIFLOAT_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <sys/cdefs.h>
 
@@ -79,8 +80,65 @@ gain_minifloat_t gain_from_float(float f);
 /** Convert the internal representation used for gains to float */
 float float_from_gain(gain_minifloat_t gain);
 
+/**
+ * Unpack and convert an array of packed gain pairs to floats.
+ * Bit-exact with float_from_gain() on each half, but branch-free inside
+ * the loop so batches of per-track ramp gains convert in one pass.
+ */
+void float_from_gain_array(float *left, float *right,
+        const gain_minifloat_packed_t *gains, size_t count);
+
+/**
+ * Convert and pack arrays of left/right float gains into packed pairs.
+ * Bit-exact with gain_from_float() on each half.
+ */
+void gain_from_float_array(gain_minifloat_packed_t *gains,
+        const float *left, const float *right, size_t count);
+
 /** \cond */
 __END_DECLS
 /** \endcond */
 
+#ifdef __cplusplus
+
+namespace android::audio_utils {
+
+/**
+ * constexpr equivalents of float_from_gain() and gain_from_float() for
+ * compile-time gain constants, e.g. ramp tables.  Bit-exact with the
+ * runtime conversions.
+ */
+constexpr float float_from_gain_constexpr(gain_minifloat_t gain) {
+    const uint32_t exponent = gain >> 13;
+    const uint32_t mantissa = gain & 0x1FFF;
+    const uint32_t significand = exponent != 0 ? (0x2000u | mantissa) : (mantissa << 1);
+    // scale by 2^(exponent - 20), exponent <= 7 so the scale is always a shrink
+    float scale = 1.0f;
+    for (uint32_t i = exponent; i < 20; ++i) scale *= 0.5f;
+    return (float)significand * scale;
+}
+
+constexpr gain_minifloat_t gain_from_float_constexpr(float v) {
+    if (!(v > 0.0f)) return 0;     // also catches NaN
+    if (v >= 2.0f) return 0xFFFF;
+    // decompose v = r * 2^exp with r in [0.5, 1)
+    int exp = 0;
+    float r = v;
+    while (r >= 1.0f) { r *= 0.5f; ++exp; }
+    while (r < 0.5f) { r *= 2.0f; --exp; }
+    exp += 6;                      // excess
+    if (-exp >= 13) return 0;
+    const int mantissa = (int)(r * 16384.0f);
+    return exp > 0 ? (gain_minifloat_t)((exp << 13) | (mantissa & ~0x2000)) :
+            (gain_minifloat_t)((mantissa >> (1 - exp)) & 0x1FFF);
+}
+
+static_assert(gain_from_float_constexpr(GAIN_FLOAT_UNITY) == GAIN_MINIFLOAT_UNITY);
+static_assert(float_from_gain_constexpr(GAIN_MINIFLOAT_UNITY) == GAIN_FLOAT_UNITY);
+static_assert(gain_from_float_constexpr(GAIN_FLOAT_ZERO) == 0);
+
+}  // namespace android::audio_utils
+
+#endif  // __cplusplus
+
 #endif  // ANDROID_AUDIO_MINIFLOAT_H
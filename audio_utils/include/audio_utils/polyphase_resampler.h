@@ -0,0 +1,112 @@
+/*
+** Copyright 2026, The Android Open-Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef ANDROID_AUDIO_POLYPHASE_RESAMPLER_H
+#define ANDROID_AUDIO_POLYPHASE_RESAMPLER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+/** \cond */
+__BEGIN_DECLS
+/** \endcond */
+
+/**
+ * In-tree polyphase resampler engine, see description in polyphase_resampler.c.
+ * It is normally used through create_resampler() in resampler.h with quality
+ * RESAMPLER_QUALITY_POLYPHASE, but can also be driven directly.
+ */
+struct polyphase_resampler;
+
+/**
+ * Create a resampler converting between any two rates, for \p channel_count
+ * interleaved int16_t channels.
+ *
+ * \return NULL on allocation failure or invalid parameters.
+ */
+struct polyphase_resampler *polyphase_resampler_create(uint32_t in_sample_rate,
+        uint32_t out_sample_rate, uint32_t channel_count);
+
+void polyphase_resampler_destroy(struct polyphase_resampler *rs);
+
+/** Discard all buffered input and return to the initial state. */
+void polyphase_resampler_reset(struct polyphase_resampler *rs);
+
+/**
+ * Consume *in_frames frames from \p in and produce at most *out_frames frames
+ * into \p out.  All input is always consumed (it is buffered internally);
+ * *in_frames and *out_frames are updated with the frames consumed and
+ * produced.
+ *
+ * \return 0 on success, -ENOMEM if the internal buffer could not grow.
+ */
+int polyphase_resampler_process(struct polyphase_resampler *rs,
+        const int16_t *in, size_t *in_frames, int16_t *out, size_t *out_frames);
+
+/** \return the filter group delay in frames at the input sample rate. */
+size_t polyphase_resampler_input_latency(const struct polyphase_resampler *rs);
+
+/**
+ * A bank of \p stream_count identical resamplers processed in lockstep.
+ *
+ * All streams share one coefficient table and one stream position, so a
+ * pool of identical capture streams (e.g. 16 x 48k -> 16k) is converted
+ * with the filter taps loaded once per output frame instead of once per
+ * stream.  Bitexact with stream_count independent polyphase_resampler
+ * instances fed the same splits.
+ */
+struct polyphase_resampler_bank;
+
+/**
+ * Create a bank of \p stream_count resamplers, each converting
+ * \p channel_count interleaved int16_t channels between the two rates.
+ *
+ * \return NULL on allocation failure or invalid parameters.
+ */
+struct polyphase_resampler_bank *polyphase_resampler_bank_create(
+        uint32_t in_sample_rate, uint32_t out_sample_rate,
+        uint32_t channel_count, uint32_t stream_count);
+
+void polyphase_resampler_bank_destroy(struct polyphase_resampler_bank *rs);
+
+/** Discard all buffered input of every stream and return to the initial state. */
+void polyphase_resampler_bank_reset(struct polyphase_resampler_bank *rs);
+
+/**
+ * Consume *in_frames frames from each of the stream_count buffers in \p in
+ * and produce at most *out_frames frames into each buffer in \p out.  The
+ * streams advance in lockstep: every call applies one block size to all of
+ * them, the natural shape of a round-robin capture pool.  As with
+ * polyphase_resampler_process() all input is always consumed; *in_frames
+ * and *out_frames are updated with the frames consumed and produced, the
+ * same counts for every stream.
+ *
+ * \return 0 on success, -ENOMEM if the internal buffer could not grow.
+ */
+int polyphase_resampler_bank_process(struct polyphase_resampler_bank *rs,
+        const int16_t *const *in, size_t *in_frames,
+        int16_t *const *out, size_t *out_frames);
+
+/** \return the filter group delay in frames at the input sample rate. */
+size_t polyphase_resampler_bank_input_latency(
+        const struct polyphase_resampler_bank *rs);
+
+/** \cond */
+__END_DECLS
+/** \endcond */
+
+#endif // ANDROID_AUDIO_POLYPHASE_RESAMPLER_H
@@ -62,6 +62,78 @@ float audio_utils_compute_power_mono(const void *buffer, audio_format_t format,
 
 float audio_utils_compute_energy_mono(const void *buffer, audio_format_t format, size_t samples);
 
+/**
+ * \brief Compute per-channel signal energy and peak amplitude in a single pass.
+ *
+ * Metering an interleaved buffer with audio_utils_compute_energy_mono() per
+ * channel plus a separate peak scan reads the buffer several times; this fused
+ * kernel deinterleaves, accumulates energy, and tracks peak in one sweep.
+ *
+ *   \param buffer       buffer of interleaved samples.
+ *   \param format       one of AUDIO_FORMAT_PCM_8_BIT, AUDIO_FORMAT_PCM_16_BIT,
+ *                       AUDIO_FORMAT_PCM_24_BIT_PACKED, AUDIO_FORMAT_PCM_8_24_BIT,
+ *                       AUDIO_FORMAT_PCM_32_BIT, AUDIO_FORMAT_PCM_FLOAT.
+ *   \param frames       number of audio frames in buffer.
+ *   \param channelCount number of interleaved channels per frame > 0.
+ *   \param energy       array of \p channelCount elements set to the signal energy
+ *                       (sum of squares) of each channel, where each sample is
+ *                       normalized to peak to peak range of 1.f.
+ *   \param peak         if non-NULL, array of \p channelCount elements set to the
+ *                       maximum absolute normalized amplitude of each channel.
+ */
+void audio_utils_compute_energy_peak(const void *buffer, audio_format_t format,
+        size_t frames, size_t channelCount, float *energy, float *peak);
+
+/**
+ * \brief Opaque state of a K-weighting pre-filter (ITU-R BS.1770).
+ *
+ * K-weighting is a high shelf (head diffraction) followed by a highpass
+ * (RLB weighting).  The filters are recursive, so loudness metering keeps
+ * one of these per stream and feeds it consecutive buffers.
+ */
+typedef struct audio_utils_kweight audio_utils_kweight_t;
+
+/**
+ * \brief Creates a K-weighting filter state.
+ *
+ * The BS.1770 filter coefficients are specified at 48000 Hz and are
+ * recomputed for the requested sample rate.
+ *
+ * \param sample_rate   sample rate of the audio data in Hz.
+ * \param channel_count number of interleaved channels per frame > 0.
+ * \return the filter state, or NULL on invalid parameters.
+ */
+audio_utils_kweight_t *audio_utils_kweight_create(
+        uint32_t sample_rate, size_t channel_count);
+
+/** \brief Frees a K-weighting filter state. */
+void audio_utils_kweight_free(audio_utils_kweight_t *kweight);
+
+/** \brief Resets the filter memory, as across a stream discontinuity. */
+void audio_utils_kweight_reset(audio_utils_kweight_t *kweight);
+
+/**
+ * \brief Computes per-channel K-weighted signal energy in a single pass.
+ *
+ * Equivalent to running the shelf and highpass BiquadFilters and then
+ * audio_utils_compute_energy_mono() per channel, but the filter state is
+ * embedded and the buffer is read once.  The loudness of the block follows
+ * BS.1770 as
+ *
+ *   LKFS = -0.691 + 10 log10( sum_c G_c * energy[c] / frames )
+ *
+ * with the per-channel position weights G_c applied by the caller.
+ *
+ *   \param kweight      filter state from audio_utils_kweight_create();
+ *                       updated by the call.
+ *   \param buffer       buffer of interleaved float samples.
+ *   \param frames       number of audio frames in buffer.
+ *   \param energy       array of channel_count elements set to the K-weighted
+ *                       signal energy (sum of squares) of each channel.
+ */
+void audio_utils_compute_energy_kweighted(audio_utils_kweight_t *kweight,
+        const float *buffer, size_t frames, float *energy);
+
 /**
  * \brief  Returns true if the format is supported for compute_energy_for_mono()
  *         and compute_power_for_mono().
@@ -67,6 +67,59 @@ void ditherAndClamp(int32_t *out, const int32_t *sums, size_t pairs);
  */
 void memcpy_to_i16_from_q4_27(int16_t *dst, const int32_t *src, size_t count);
 
+/** Maximum interleaved channels carried by one audio_utils_dither_state. */
+#define AUDIO_UTILS_DITHER_MAX_CHANNELS 8
+
+/**
+ * Per-stream state for dithered conversion to 16 bit: the dither generator
+ * and the per-channel noise shaping error history, carried across buffers so
+ * the shaping filter stays continuous at buffer boundaries.
+ *
+ * Treat the fields as private; initialize with audio_utils_dither_init().
+ */
+struct audio_utils_dither_state {
+    uint32_t lcg;        /**< dither generator state */
+    uint32_t channels;   /**< interleaved channel count */
+    float error1[AUDIO_UTILS_DITHER_MAX_CHANNELS];  /**< shaping error, previous frame */
+    float error2[AUDIO_UTILS_DITHER_MAX_CHANNELS];  /**< shaping error, two frames back */
+};
+
+/**
+ * Initialize (or reset) a dither state for a stream of \p channels
+ * interleaved channels.
+ *
+ *  \param state     State to initialize
+ *  \param channels  Interleaved channel count, clamped to
+ *                   [1, AUDIO_UTILS_DITHER_MAX_CHANNELS]
+ */
+void audio_utils_dither_init(struct audio_utils_dither_state *state, uint32_t channels);
+
+/**
+ * Copy samples from single-precision floating-point to signed fixed-point 16 bit Q0.15
+ * with TPDF dither and second-order noise shaping.
+ *
+ * Each output code receives triangular dither of +-1 lsb peak, and the total
+ * quantization noise is fed back per channel through a (1 - z^-1)^2 error
+ * filter, pushing it out of the low frequencies where truncation artifacts
+ * are audible on quiet material.  Unlike ditherAndClamp() (which despite its
+ * name only narrows), this really dithers, and unlike memcpy_to_i16_from_float()
+ * it is appropriate as the final conversion feeding a 16-bit sink.
+ *
+ * The state must be initialized with audio_utils_dither_init() and is updated
+ * by each call, so consecutive buffers of one stream form one continuous
+ * dithered stream.  Do not share one state between streams or threads.
+ *
+ *  \param dst     Destination buffer
+ *  \param src     Source buffer, frames * state->channels interleaved samples
+ *  \param frames  Number of frames to convert
+ *  \param state   Per-stream dither state
+ *
+ * The destination and source buffers must either be completely separate (non-overlapping), or
+ * they must both start at the same address.  Partially overlapping buffers are not supported.
+ */
+void memcpy_to_i16_from_float_dithered(int16_t *dst, const float *src, size_t frames,
+        struct audio_utils_dither_state *state);
+
 /**
  * Expand and copy samples from unsigned 8-bit offset by 0x80 to signed 16-bit.
  *
@@ -172,6 +225,23 @@ void memcpy_to_i16_from_i32(int16_t *dst, const int32_t *src, size_t count);
  */
 void memcpy_to_i16_from_float(int16_t *dst, const float *src, size_t count);
 
+/**
+ * Same conversion as memcpy_to_i16_from_float(), but the destination is written
+ * with non-temporal (cache bypassing) stores where the architecture provides
+ * them.  Use for large buffers that will not be re-read soon, so the stores do
+ * not evict the working set of concurrently running processing.
+ * memcpy_to_i16_from_float() selects this variant automatically above a size
+ * threshold; call it directly when the caller knows better.
+ *
+ *  \param dst     Destination buffer
+ *  \param src     Source buffer
+ *  \param count   Number of samples to copy
+ *
+ * The destination and source buffers must either be completely separate (non-overlapping), or
+ * they must both start at the same address.  Partially overlapping buffers are not supported.
+ */
+void memcpy_to_i16_from_float_nt(int16_t *dst, const float *src, size_t count);
+
 /**
  * Copy samples from signed fixed-point 32-bit Q4.27 to single-precision floating-point.
  * The nominal output float range is [-1.0, 1.0] if the fixed-point range is
@@ -201,6 +271,66 @@ void memcpy_to_float_from_q4_27(float *dst, const int32_t *src, size_t count);
  */
 void memcpy_to_float_from_i16(float *dst, const int16_t *src, size_t count);
 
+/**
+ * Copy samples from IEEE 754 half-precision binary16, stored in a uint16_t array,
+ * to single-precision floating-point.
+ * Every half value is exactly representable in float, so the conversion is exact.
+ * Uses the hardware half conversions where available (fcvtl on arm64, F16C on x86).
+ *
+ *  \param dst     Destination buffer
+ *  \param src     Source buffer
+ *  \param count   Number of samples to copy
+ *
+ * The destination and source buffers must either be completely separate (non-overlapping), or
+ * they must both start at the same address.  Partially overlapping buffers are not supported.
+ */
+void memcpy_to_float_from_f16(float *dst, const uint16_t *src, size_t count);
+
+/**
+ * Copy samples from single-precision floating-point to IEEE 754 half-precision binary16,
+ * stored in a uint16_t array.
+ * Rounding is to nearest, ties to even; values beyond the half range overflow to infinity.
+ * See f16_from_float() for details.
+ * Uses the hardware half conversions where available (fcvtn on arm64, F16C on x86).
+ *
+ *  \param dst     Destination buffer
+ *  \param src     Source buffer
+ *  \param count   Number of samples to copy
+ *
+ * The destination and source buffers must either be completely separate (non-overlapping), or
+ * they must both start at the same address.  Partially overlapping buffers are not supported.
+ */
+void memcpy_to_f16_from_float(uint16_t *dst, const float *src, size_t count);
+
+/**
+ * Copy samples from IEEE 754 half-precision binary16, stored in a uint16_t array,
+ * to signed fixed-point 16 bit Q0.15.
+ * The data is clamped and rounded as by clamp16_from_float().
+ *
+ *  \param dst     Destination buffer
+ *  \param src     Source buffer
+ *  \param count   Number of samples to copy
+ *
+ * The destination and source buffers must either be completely separate (non-overlapping), or
+ * they must both start at the same address.  Partially overlapping buffers are not supported.
+ */
+void memcpy_to_i16_from_f16(int16_t *dst, const uint16_t *src, size_t count);
+
+/**
+ * Copy samples from signed fixed-point 16 bit Q0.15 to IEEE 754 half-precision binary16,
+ * stored in a uint16_t array.
+ * The half mantissa holds 11 significant bits, so inputs of magnitude up to 2048 codes
+ * are exact and larger magnitudes round to nearest, ties to even.
+ *
+ *  \param dst     Destination buffer
+ *  \param src     Source buffer
+ *  \param count   Number of samples to copy
+ *
+ * The destination and source buffers must either be completely separate (non-overlapping), or
+ * they must both start at the same address.  Partially overlapping buffers are not supported.
+ */
+void memcpy_to_f16_from_i16(uint16_t *dst, const int16_t *src, size_t count);
+
 /**
  * Copy samples from unsigned fixed-point 8 bit to single-precision floating-point.
  * The output float range is [-1.0, 1.0) for the fixed-point range [0x00, 0xFF].
@@ -471,6 +601,114 @@ void memcpy_to_float_from_i32(float *dst, const int32_t *src, size_t count);
 void memcpy_to_float_from_float_with_clamping(float *dst, const float *src, size_t count,
                                               float absMax);
 
+/**
+ * Copy samples from G.711 mu-law to signed fixed-point 16-bit Q0.15.
+ * Decoding is done according to i16_from_ulaw().
+ *
+ *  \param dst     Destination buffer
+ *  \param src     Source buffer
+ *  \param count   Number of samples to copy
+ *
+ * The destination and source buffers must either be completely separate (non-overlapping), or
+ * they must both start at the same address.  Partially overlapping buffers are not supported.
+ */
+void memcpy_to_i16_from_ulaw(int16_t *dst, const uint8_t *src, size_t count);
+
+/**
+ * Copy samples from signed fixed-point 16-bit Q0.15 to G.711 mu-law.
+ * Encoding is done according to ulaw_from_i16().
+ *
+ *  \param dst     Destination buffer
+ *  \param src     Source buffer
+ *  \param count   Number of samples to copy
+ *
+ * The destination and source buffers must either be completely separate (non-overlapping), or
+ * they must both start at the same address.  Partially overlapping buffers are not supported.
+ */
+void memcpy_to_ulaw_from_i16(uint8_t *dst, const int16_t *src, size_t count);
+
+/**
+ * Copy samples from G.711 mu-law to single-precision floating-point,
+ * without materializing an intermediate 16-bit buffer.
+ * The float range follows float_from_i16() applied to i16_from_ulaw().
+ *
+ *  \param dst     Destination buffer
+ *  \param src     Source buffer
+ *  \param count   Number of samples to copy
+ *
+ * The destination and source buffers must either be completely separate (non-overlapping), or
+ * they must both start at the same address.  Partially overlapping buffers are not supported.
+ */
+void memcpy_to_float_from_ulaw(float *dst, const uint8_t *src, size_t count);
+
+/**
+ * Copy samples from single-precision floating-point to G.711 mu-law,
+ * without materializing an intermediate 16-bit buffer.
+ * Clamping is done according to clamp16_from_float() before encoding.
+ *
+ *  \param dst     Destination buffer
+ *  \param src     Source buffer
+ *  \param count   Number of samples to copy
+ *
+ * The destination and source buffers must either be completely separate (non-overlapping), or
+ * they must both start at the same address.  Partially overlapping buffers are not supported.
+ */
+void memcpy_to_ulaw_from_float(uint8_t *dst, const float *src, size_t count);
+
+/**
+ * Copy samples from G.711 A-law to signed fixed-point 16-bit Q0.15.
+ * Decoding is done according to i16_from_alaw().
+ *
+ *  \param dst     Destination buffer
+ *  \param src     Source buffer
+ *  \param count   Number of samples to copy
+ *
+ * The destination and source buffers must either be completely separate (non-overlapping), or
+ * they must both start at the same address.  Partially overlapping buffers are not supported.
+ */
+void memcpy_to_i16_from_alaw(int16_t *dst, const uint8_t *src, size_t count);
+
+/**
+ * Copy samples from signed fixed-point 16-bit Q0.15 to G.711 A-law.
+ * Encoding is done according to alaw_from_i16().
+ *
+ *  \param dst     Destination buffer
+ *  \param src     Source buffer
+ *  \param count   Number of samples to copy
+ *
+ * The destination and source buffers must either be completely separate (non-overlapping), or
+ * they must both start at the same address.  Partially overlapping buffers are not supported.
+ */
+void memcpy_to_alaw_from_i16(uint8_t *dst, const int16_t *src, size_t count);
+
+/**
+ * Copy samples from G.711 A-law to single-precision floating-point,
+ * without materializing an intermediate 16-bit buffer.
+ * The float range follows float_from_i16() applied to i16_from_alaw().
+ *
+ *  \param dst     Destination buffer
+ *  \param src     Source buffer
+ *  \param count   Number of samples to copy
+ *
+ * The destination and source buffers must either be completely separate (non-overlapping), or
+ * they must both start at the same address.  Partially overlapping buffers are not supported.
+ */
+void memcpy_to_float_from_alaw(float *dst, const uint8_t *src, size_t count);
+
+/**
+ * Copy samples from single-precision floating-point to G.711 A-law,
+ * without materializing an intermediate 16-bit buffer.
+ * Clamping is done according to clamp16_from_float() before encoding.
+ *
+ *  \param dst     Destination buffer
+ *  \param src     Source buffer
+ *  \param count   Number of samples to copy
+ *
+ * The destination and source buffers must either be completely separate (non-overlapping), or
+ * they must both start at the same address.  Partially overlapping buffers are not supported.
+ */
+void memcpy_to_alaw_from_float(uint8_t *dst, const float *src, size_t count);
+
 /**
  * Downmix pairs of interleaved stereo input 16-bit samples to mono output 16-bit samples.
  *
@@ -743,14 +981,118 @@ void accumulate_i32(int32_t *dst, const int32_t *src, size_t count);
  */
 void accumulate_float(float *dst, const float *src, size_t count);
 
+/**
+ * Accumulate signed 16-bit samples into float samples with gain applied.
+ * Each dst[i] += src[i] * gain / 32768, so a full scale int16_t contributes
+ * gain to dst.  Result is not clamped.
+ *
+ *  \param dst     Destination buffer
+ *  \param src     Source buffer
+ *  \param count   Number of samples to accumulate
+ *  \param gain    Scale applied to each normalized source sample
+ *
+ * The destination and source buffers must be completely separate.
+ */
+void accumulate_float_from_i16_with_gain(float *dst, const int16_t *src, size_t count,
+        float gain);
+
+/**
+ * Accumulate packed 24-bit samples (native endian) into float samples with gain
+ * applied.  Each dst[i] += src[i] * gain / 8388608, so a full scale packed
+ * 24-bit sample contributes gain to dst.  Result is not clamped.
+ *
+ *  \param dst     Destination buffer
+ *  \param src     Source buffer
+ *  \param count   Number of samples to accumulate
+ *  \param gain    Scale applied to each normalized source sample
+ *
+ * The destination and source buffers must be completely separate.
+ */
+void accumulate_float_from_p24_with_gain(float *dst, const uint8_t *src, size_t count,
+        float gain);
+
+/**
+ * Accumulate float samples into float samples with gain applied.
+ * Each dst[i] += src[i] * gain.  Result is not clamped.
+ *
+ *  \param dst     Destination buffer
+ *  \param src     Source buffer
+ *  \param count   Number of samples to accumulate
+ *  \param gain    Scale applied to each source sample
+ *
+ * The destination and source buffers must be completely separate.
+ */
+void accumulate_float_from_float_with_gain(float *dst, const float *src, size_t count,
+        float gain);
+
+/**
+ * Accumulate interleaved signed 16-bit samples into interleaved float samples
+ * with a per-channel gain vector applied.
+ * dst[i * channelCount + c] += src[i * channelCount + c] * gains[c] / 32768.
+ * Result is not clamped.
+ *
+ *  \param dst          Destination buffer
+ *  \param src          Source buffer
+ *  \param frames       Number of frames to accumulate
+ *  \param channelCount Number of interleaved channels per frame > 0
+ *  \param gains        Array of channelCount gains, one per channel
+ *
+ * The destination and source buffers must be completely separate.
+ */
+void accumulate_float_from_i16_with_channel_gains(float *dst, const int16_t *src,
+        size_t frames, size_t channelCount, const float *gains);
+
+/**
+ * Accumulate interleaved packed 24-bit samples (native endian) into interleaved
+ * float samples with a per-channel gain vector applied.
+ * Result is not clamped; see accumulate_float_from_i16_with_channel_gains().
+ *
+ *  \param dst          Destination buffer
+ *  \param src          Source buffer
+ *  \param frames       Number of frames to accumulate
+ *  \param channelCount Number of interleaved channels per frame > 0
+ *  \param gains        Array of channelCount gains, one per channel
+ *
+ * The destination and source buffers must be completely separate.
+ */
+void accumulate_float_from_p24_with_channel_gains(float *dst, const uint8_t *src,
+        size_t frames, size_t channelCount, const float *gains);
+
+/**
+ * Accumulate interleaved float samples into interleaved float samples with a
+ * per-channel gain vector applied.
+ * dst[i * channelCount + c] += src[i * channelCount + c] * gains[c].
+ * Result is not clamped.
+ *
+ *  \param dst          Destination buffer
+ *  \param src          Source buffer
+ *  \param frames       Number of frames to accumulate
+ *  \param channelCount Number of interleaved channels per frame > 0
+ *  \param gains        Array of channelCount gains, one per channel
+ *
+ * The destination and source buffers must be completely separate.
+ */
+void accumulate_float_from_float_with_channel_gains(float *dst, const float *src,
+        size_t frames, size_t channelCount, const float *gains);
+
+/* The integer clamps below are written as arithmetic selects rather than
+ * comparison chains: hot-signal clipping makes the out-of-range test data
+ * dependent, so a conditional jump mispredicts exactly when the input is
+ * loudest.  The select form costs the same few ALU operations regardless of
+ * toolchain, where the earlier if-based form was only branchless when the
+ * compiler happened to if-convert it.
+ */
+
 /**
  * Clamp (aka hard limit or clip) a signed 32-bit sample to 16-bit range.
  */
 static inline int16_t clamp16(int32_t sample)
 {
-    if ((sample>>15) ^ (sample>>31))
-        sample = 0x7FFF ^ (sample>>31);
-    return sample;
+    /* mask is all ones iff sample is outside 16-bit range;
+     * 0x7FFF ^ (sample>>31) is the rail nearest to sample's sign
+     */
+    const int32_t mask = -(int32_t)(((sample>>15) ^ (sample>>31)) != 0);
+    return (int16_t)((sample & ~mask) | ((0x7FFF ^ (sample>>31)) & mask));
 }
 
 /**
@@ -758,9 +1100,30 @@ static inline int16_t clamp16(int32_t sample)
  */
 static inline int32_t clamp32(int64_t sample)
 {
-    if ((sample>>31) ^ (sample>>63))
-        sample = 0x7fffffff ^ (sample>>63);
-    return sample;
+    const int64_t mask = -(int64_t)(((sample>>31) ^ (sample>>63)) != 0);
+    return (int32_t)((sample & ~mask) | ((0x7fffffff ^ (sample>>63)) & mask));
+}
+
+/**
+ * Add two signed 16-bit samples, clamping the sum to 16-bit range.
+ */
+static inline int16_t clamp16_add(int16_t a, int16_t b)
+{
+    return clamp16((int32_t)a + b);
+}
+
+/**
+ * Add two signed 32-bit samples, clamping the sum to 32-bit range.
+ * The overflow builtin reduces to the hardware flag, so the saturation
+ * is a flag-based select rather than a widening add and compare.
+ */
+static inline int32_t clamp32_add(int32_t a, int32_t b)
+{
+    int32_t sum;
+    const int32_t overflowed = (int32_t)__builtin_add_overflow(a, b, &sum);
+    /* on overflow both terms have the sign of a, so a picks the rail */
+    const int32_t mask = -overflowed;
+    return (sum & ~mask) | ((int32_t)(0x7fffffff ^ (a>>31)) & mask);
 }
 
 /**
@@ -775,6 +1138,11 @@ static inline int32_t clamp32(int64_t sample)
  *
  * OLD code disabled: Rounding of 0.5 lsb is to even (default for IEEE 754).
  * NEW code enabled: Rounding of 0.5 lsb is away from 0.
+ *
+ * The result does not depend on the dynamic (fenv) rounding mode: the power of
+ * two scaling is exact and roundf() rounds to nearest, ties away from zero,
+ * regardless of the mode.  Callers using fesetround() for directed rounding
+ * elsewhere need not save and restore the mode around this conversion.
  */
 static inline int16_t clamp16_from_float(float f)
 {
@@ -820,6 +1188,9 @@ static inline int16_t clamp16_from_float(float f)
  *
  * OLD code disabled: Rounding of 0.5 lsb is to even (default for IEEE 754).
  * NEW code enabled: Rounding of 0.5 lsb is away from 0.
+ *
+ * Like clamp16_from_float(), the result does not depend on the dynamic (fenv)
+ * rounding mode.
  */
 static inline uint8_t clamp8_from_float(float f)
 {
@@ -848,7 +1219,11 @@ static inline uint8_t clamp8_from_float(float f)
         return 255;
     return u.i; /* Return lower 8 bits, the part of interest in the significand. */
 #else
-    return roundf(fmaxf(fminf(f * 128.f + 128.f, 255.f), 0.f));
+    /* the scaling is exact (power of two) and the bias is added in double
+     * precision, where the sum is also exact, so unlike a single precision
+     * bias no intermediate here depends on the dynamic rounding mode.
+     */
+    return (uint8_t)round(fmax(fmin((double)f * 128. + 128., 255.), 0.));
 #endif
 }
 
@@ -860,15 +1235,12 @@ static inline uint8_t clamp8_from_float(float f)
  */
 static inline uint8_t clamp8_from_q8_23(int32_t ival)
 {
-    static const int32_t limpos = 0x7fffff;
-    static const int32_t limneg = -0x800000;
-    if (ival < limneg) {
-        return 0;
-    } else if (ival > limpos) {
-        return 0xff;
-    } else {
-        return (ival >> 16) + 0x80;
-    }
+    /* arithmetic select, branch-free like clamp16(); the 24-bit rails map
+     * exactly to the 8-bit rails after the shift and bias
+     */
+    const int32_t mask = -(int32_t)(((ival>>23) ^ (ival>>31)) != 0);
+    const int32_t clamped = (ival & ~mask) | ((0x7fffff ^ (ival>>31)) & mask);
+    return (uint8_t)((clamped >> 16) + 0x80);
 }
 
 /**
@@ -881,6 +1253,9 @@ static inline uint8_t clamp8_from_q8_23(int32_t ival)
  * Values outside the range [-1.0, 1.0) are properly clamped to -8388608 and 8388607,
  * including -Inf and +Inf. NaN values are considered undefined, and behavior may change
  * depending on hardware and future implementation of this function.
+ *
+ * Like clamp16_from_float(), the result does not depend on the dynamic (fenv)
+ * rounding mode.
  */
 static inline int32_t clamp24_from_float(float f)
 {
@@ -913,15 +1288,9 @@ static inline int32_t clamp24_from_float(float f)
  */
 static inline int32_t clamp24_from_q8_23(int32_t ival)
 {
-    static const int32_t limpos = 0x7fffff;
-    static const int32_t limneg = -0x800000;
-    if (ival < limneg) {
-        return limneg;
-    } else if (ival > limpos) {
-        return limpos;
-    } else {
-        return ival;
-    }
+    /* arithmetic select, branch-free like clamp16() */
+    const int32_t mask = -(int32_t)(((ival>>23) ^ (ival>>31)) != 0);
+    return (ival & ~mask) | ((0x7fffff ^ (ival>>31)) & mask);
 }
 
 /**
@@ -931,6 +1300,10 @@ static inline int32_t clamp24_from_q8_23(int32_t ival)
  * Values outside the range [-16.0, 16.0) are properly clamped to -2147483648 and 2147483647,
  * including -Inf and +Inf. NaN values are considered undefined, and behavior may change
  * depending on hardware and future implementation of this function.
+ *
+ * Independent of the dynamic (fenv) rounding mode: the power of two scaling is
+ * exact, the half-lsb bias is added in double precision where the sum is also
+ * exact, and the final integer conversion truncates toward zero in every mode.
  */
 static inline int32_t clampq4_27_from_float(float f)
 {
@@ -957,6 +1330,9 @@ static inline int32_t clampq4_27_from_float(float f)
  * Values outside the range [-1.0, 1.0) are properly clamped to -2147483648 and 2147483647,
  * including -Inf and +Inf. NaN values are considered undefined, and behavior may change
  * depending on hardware and future implementation of this function.
+ *
+ * Independent of the dynamic (fenv) rounding mode, for the same reasons as
+ * clampq4_27_from_float().
  */
 static inline int32_t clamp32_from_float(float f)
 {
@@ -1036,6 +1412,9 @@ static inline float float_from_u4_12(uint16_t uval)
  * Values outside the range [0, 16.0] are properly clamped to [0, 4294967295]
  * including -Inf and +Inf. NaN values are considered undefined, and behavior may change
  * depending on hardware and future implementation of this function.
+ *
+ * Independent of the dynamic (fenv) rounding mode, for the same reasons as
+ * clampq4_27_from_float().
  */
 static inline uint32_t u4_28_from_float(float f)
 {
@@ -1060,6 +1439,9 @@ static inline uint32_t u4_28_from_float(float f)
  * Values outside the range [0, 16.0) are properly clamped to [0, 65535]
  * including -Inf and +Inf. NaN values are considered undefined, and behavior may change
  * depending on hardware and future implementation of this function.
+ *
+ * Independent of the dynamic (fenv) rounding mode, for the same reasons as
+ * clampq4_27_from_float().
  */
 static inline uint16_t u4_12_from_float(float f)
 {
@@ -1109,6 +1491,162 @@ static inline float float_from_u8(uint8_t uval)
     return ((int)uval - 128) * scale;
 }
 
+/**
+ * Convert an IEEE 754 half-precision binary16 value, stored in a uint16_t,
+ * to single-precision floating-point.
+ *
+ * Every half value, including subnormals, infinities and NaNs, is exactly
+ * representable in float, so the conversion is exact.
+ */
+static inline float float_from_f16(uint16_t hval)
+{
+    const uint32_t sign = (uint32_t)(hval & 0x8000) << 16;
+    uint32_t exponent = (hval >> 10) & 0x1f;
+    uint32_t mantissa = hval & 0x3ff;
+    union {
+        float f;
+        uint32_t i;
+    } u;
+
+    if (exponent == 0x1f) {             /* infinity or NaN */
+        u.i = sign | 0x7f800000 | (mantissa << 13);
+    } else if (exponent != 0) {         /* normal: rebias exponent from 15 to 127 */
+        u.i = sign | ((exponent + (127 - 15)) << 23) | (mantissa << 13);
+    } else if (mantissa != 0) {         /* subnormal: normalize, it fits a float exponent */
+        exponent = 113;                 /* 127 - 15 + 1, for the implicit bit at 0x400 */
+        while ((mantissa & 0x400) == 0) {
+            mantissa <<= 1;
+            --exponent;
+        }
+        u.i = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+    } else {                            /* (signed) zero */
+        u.i = sign;
+    }
+    return u.f;
+}
+
+/**
+ * Convert a single-precision floating-point value to IEEE 754 half-precision
+ * binary16, stored in a uint16_t.
+ *
+ * Rounding is to nearest, ties to even - the IEEE 754 default, and what the
+ * hardware conversion instructions produce.  Values beyond the half range
+ * overflow to infinity, and any NaN converts to a quiet NaN.
+ */
+static inline uint16_t f16_from_float(float f)
+{
+    union {
+        float f;
+        uint32_t i;
+    } u;
+    uint32_t bits;
+    uint16_t sign;
+
+    u.f = f;
+    bits = u.i;
+    sign = (bits >> 16) & 0x8000;
+    bits &= 0x7fffffff;
+    if (bits > 0x7f800000) {            /* NaN */
+        return sign | 0x7e00;
+    }
+    if (bits >= 0x47800000) {           /* 65536. and up (including infinity) */
+        return sign | 0x7c00;
+    }
+    if (bits >= 0x38800000) {           /* normal half */
+        bits -= 0x38000000;             /* rebias exponent from 127 to 15 */
+        /* round to nearest on the 13 dropped bits, ties to even; a carry out
+         * of the mantissa increments the exponent, which is correct rounding,
+         * up to and including overflow to infinity.
+         */
+        bits += 0xfff + ((bits >> 13) & 1);
+        return sign | (uint16_t)(bits >> 13);
+    }
+    if (bits < 0x33000000) {            /* below half of the smallest subnormal */
+        return sign;                    /* underflow to (signed) zero */
+    }
+    /* subnormal half: align the mantissa with the implicit bit restored,
+     * round to nearest, ties to even.  A carry into the exponent field
+     * produces the smallest normal half, again correct rounding.
+     */
+    {
+        const uint32_t shift = 126 - (bits >> 23);  /* 14 to 24 for this range */
+        const uint32_t mantissa = (bits & 0x7fffff) | 0x800000;
+        const uint32_t halfway = 1u << (shift - 1);
+        const uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint16_t hval = mantissa >> shift;
+
+        hval += remainder > halfway || (remainder == halfway && (hval & 1));
+        return sign | hval;
+    }
+}
+
+/**
+ * Convert a G.711 mu-law sample to signed fixed-point 16-bit Q0.15.
+ * Decoding follows ITU-T G.711; both zero codes (0x7f and 0xff) decode to 0.
+ */
+static inline int16_t i16_from_ulaw(uint8_t uval)
+{
+    uval = ~uval;
+    /* reassemble the biased magnitude: mantissa plus hidden bit, scaled by the exponent */
+    const int32_t t = (((uval & 0x0f) << 3) + 0x84) << ((uval & 0x70) >> 4);
+    return (uval & 0x80) ? (0x84 - t) : (t - 0x84);
+}
+
+/**
+ * Convert a signed fixed-point 16-bit Q0.15 sample to G.711 mu-law.
+ * Zero encodes to 0xff; the alternate zero code 0x7f is never produced.
+ */
+static inline uint8_t ulaw_from_i16(int16_t ival)
+{
+    int32_t t = ival;
+    const int32_t sign = (t < 0) ? 0x80 : 0;
+    if (t < 0) {
+        t = -t;
+    }
+    if (t > 32635) {
+        t = 32635;  /* avoid exponent overflow once biased */
+    }
+    t += 0x84;  /* bias so the exponent is the position of the highest set bit */
+    const int32_t exponent = 24 - __builtin_clz((uint32_t)t);  /* 0 to 7 */
+    const int32_t mantissa = (t >> (exponent + 3)) & 0x0f;
+    return (uint8_t)~(sign | (exponent << 4) | mantissa);
+}
+
+/**
+ * Convert a G.711 A-law sample to signed fixed-point 16-bit Q0.15.
+ * Decoding follows ITU-T G.711; the 13-bit code values are returned
+ * on the 16-bit scale, so the peak decoded magnitude is 32256.
+ */
+static inline int16_t i16_from_alaw(uint8_t aval)
+{
+    aval ^= 0x55;  /* undo the alternate-bit inversion of the stored code */
+    const int32_t exponent = (aval & 0x70) >> 4;
+    int32_t t = ((aval & 0x0f) << 4) + 8;
+    if (exponent != 0) {
+        t = (t + 0x100) << (exponent - 1);
+    }
+    return (aval & 0x80) ? t : -t;
+}
+
+/**
+ * Convert a signed fixed-point 16-bit Q0.15 sample to G.711 A-law.
+ */
+static inline uint8_t alaw_from_i16(int16_t ival)
+{
+    int32_t t = ival >> 3;  /* A-law encodes a 13-bit magnitude */
+    int32_t mask = 0xd5;    /* sign bit plus the alternate-bit inversion */
+    if (t < 0) {
+        mask = 0x55;
+        t = -t - 1;
+    }
+    const int32_t exponent = (t > 0x0f) ? 27 - __builtin_clz((uint32_t)t) : 0;  /* 0 to 8 */
+    if (exponent > 7) {
+        return (uint8_t)(0x7f ^ mask);  /* clamp to the largest code */
+    }
+    const int32_t mantissa = (t >> (exponent < 2 ? 1 : exponent)) & 0x0f;
+    return (uint8_t)((exponent << 4 | mantissa) ^ mask);
+}
+
 /**
  * Convert a packed 24bit Q0.23 value stored native-endian in a uint8_t ptr
  * to a signed fixed-point 32 bit integer Q0.31 value. The output Q0.31 range
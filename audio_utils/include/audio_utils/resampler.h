@@ -19,6 +19,7 @@
 
 #include <stdint.h>
 #include <sys/time.h>
+#include <system/audio.h>
 
 __BEGIN_DECLS
 
@@ -28,6 +29,9 @@ __BEGIN_DECLS
 #define RESAMPLER_QUALITY_DEFAULT 4
 #define RESAMPLER_QUALITY_VOIP 3
 #define RESAMPLER_QUALITY_DESKTOP 5
+/** selects the in-tree polyphase engine instead of speex, see
+ * polyphase_resampler.h */
+#define RESAMPLER_QUALITY_POLYPHASE RESAMPLER_QUALITY_MAX
 
 struct resampler_buffer {
     union {
@@ -85,6 +89,23 @@ struct resampler_itfe {
      * \return the latency introduced by the resampler in ns.
      */
     int32_t (*delay_ns)(struct resampler_itfe *resampler);
+    /**
+     * Same as resample_from_input() but with frames in the source and destination
+     * sample formats passed to create_resampler_for_formats().
+     */
+    int (*resample_from_input_by_format)(struct resampler_itfe *resampler,
+                    const void *in,
+                    size_t *inFrameCount,
+                    void *out,
+                    size_t *outFrameCount);
+    /**
+     * Same as resample_from_provider() but the buffer provider supplies frames in the
+     * source sample format and out receives frames in the destination sample format
+     * passed to create_resampler_for_formats().
+     */
+    int (*resample_from_provider_by_format)(struct resampler_itfe *resampler,
+                    void *out,
+                    size_t *outFrameCount);
 };
 
 /**
@@ -99,6 +120,24 @@ int create_resampler(uint32_t inSampleRate,
           struct resampler_buffer_provider *provider,
           struct resampler_itfe **);
 
+/**
+ * Same as create_resampler(), composed with sample format conversion: frames enter
+ * in \p inFormat and leave in \p outFormat while the engine runs on int16_t.
+ * The input conversion is fused into the copy that already stages frames into the
+ * internal buffer, so a capture stream needs no separate conversion pass or
+ * intermediate buffer ahead of the resampler.
+ * The formats must be linear PCM formats convertible to and from
+ * AUDIO_FORMAT_PCM_16_BIT by memcpy_by_audio_format() (see format.h).
+ */
+int create_resampler_for_formats(uint32_t inSampleRate,
+          uint32_t outSampleRate,
+          uint32_t channelCount,
+          uint32_t quality,
+          audio_format_t inFormat,
+          audio_format_t outFormat,
+          struct resampler_buffer_provider *provider,
+          struct resampler_itfe **);
+
 /**
  * release resampler resources.
  */
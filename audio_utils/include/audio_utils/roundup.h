@@ -17,13 +17,82 @@
 #ifndef ANDROID_AUDIO_ROUNDUP_H
 #define ANDROID_AUDIO_ROUNDUP_H
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <sys/cdefs.h>
 
+/**
+ * Power-of-two and alignment math.
+ *
+ * These are inline (and constexpr for C++ callers) so sizing expressions
+ * such as audio_utils_fifo's power-of-two frame count constant-fold when
+ * the inputs are known at compile time, instead of paying a call per use.
+ */
+
+/** C++ callers additionally get constexpr. */
+#ifdef __cplusplus
+#define AUDIO_UTILS_POW2_CONSTEXPR constexpr
+#else
+#define AUDIO_UTILS_POW2_CONSTEXPR
+#endif
+
+/** Returns true if v is a (nonzero) power of 2. */
+static inline AUDIO_UTILS_POW2_CONSTEXPR bool audio_utils_is_pow2(uint64_t v)
+{
+    return v != 0 && (v & (v - 1)) == 0;
+}
+
+/**
+ * Returns the smallest power of 2 greater than or equal to v.
+ * 0 maps to 1, and values above 0x80000000 are rounded _down_ to
+ * 0x80000000 to prevent overflow, matching the historic roundup().
+ */
+static inline AUDIO_UTILS_POW2_CONSTEXPR unsigned audio_utils_next_pow2(unsigned v)
+{
+    // __builtin_clz is undefined for zero input
+    if (v == 0) {
+        v = 1;
+    }
+    const int lz = __builtin_clz(v);
+    unsigned rounded = 0x80000000u >> lz;
+    if (v > rounded && lz > 0) {
+        rounded <<= 1;
+    }
+    return rounded;
+}
+
+/** Returns the largest power of 2 less than or equal to v; 0 maps to 1. */
+static inline AUDIO_UTILS_POW2_CONSTEXPR unsigned audio_utils_prev_pow2(unsigned v)
+{
+    if (v == 0) {
+        return 1;
+    }
+    return 0x80000000u >> __builtin_clz(v);
+}
+
+/** Rounds value up to a multiple of align, which must be a power of 2. */
+static inline AUDIO_UTILS_POW2_CONSTEXPR size_t audio_utils_round_up(size_t value, size_t align)
+{
+    return (value + align - 1) & ~(align - 1);
+}
+
+/** Rounds value down to a multiple of align, which must be a power of 2. */
+static inline AUDIO_UTILS_POW2_CONSTEXPR size_t audio_utils_round_down(size_t value, size_t align)
+{
+    return value & ~(align - 1);
+}
+
 /** \cond */
 __BEGIN_DECLS
 /** \endcond */
 
-/** Round up to the next highest power of 2 */
+/**
+ * Round up to the next highest power of 2.
+ *
+ * Kept out-of-line for binary compatibility with existing callers;
+ * new code should prefer the inline audio_utils_next_pow2() above.
+ */
 unsigned roundup(unsigned v);
 
 /** \cond */
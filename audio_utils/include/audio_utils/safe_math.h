@@ -14,6 +14,9 @@
  * limitations under the License.
  */
 
+#include <cassert>
+#include <type_traits>
+
 namespace android::audio_utils {
 
 // safe_sub_overflow is used ensure that subtraction occurs in the same native
@@ -46,4 +49,37 @@ auto safe_add_overflow(const T& a, const U& b) {
   return result;
 }
 
+// add_assume_no_overflow is for call sites where the caller can contract
+// that the addition never overflows, e.g. from an invariant checked
+// elsewhere.  Debug builds verify the contract with assert(); release
+// builds promote it to an optimizer assumption through
+// __builtin_unreachable(), so the compiler may treat the arithmetic as
+// non-wrapping and derive value ranges across it.  Unlike the safe_*
+// helpers above, invoking this with operands that do overflow is
+// undefined behavior in release builds.
+template <typename T, typename U,
+          typename = std::enable_if_t<
+              std::is_same<std::decay_t<T>, std::decay_t<U>>{}>>
+auto add_assume_no_overflow(const T& a, const U& b) {
+  std::decay_t<T> result;
+  if (__builtin_add_overflow(a, b, &result)) {
+    assert(false && "add_assume_no_overflow overflowed");
+    __builtin_unreachable();
+  }
+  return result;
+}
+
+// similar to add_assume_no_overflow but for sub operator.
+template <typename T, typename U,
+          typename = std::enable_if_t<
+              std::is_same<std::decay_t<T>, std::decay_t<U>>{}>>
+auto sub_assume_no_overflow(const T& a, const U& b) {
+  std::decay_t<T> result;
+  if (__builtin_sub_overflow(a, b, &result)) {
+    assert(false && "sub_assume_no_overflow overflowed");
+    __builtin_unreachable();
+  }
+  return result;
+}
+
 } // namespace android::audio_utils
@@ -17,6 +17,7 @@
 #ifndef ANDROID_AUDIO_SAMPLE_H
 #define ANDROID_AUDIO_SAMPLE_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <sys/cdefs.h>
 
@@ -33,6 +34,39 @@ typedef int16_t sample_minifloat_t;
 sample_minifloat_t sample_from_float(float f);
 float float_from_sample(sample_minifloat_t sample);
 
+/* Buffer-level conversions between minifloat samples and float or int16_t
+ * buffers.  Results are identical to looping the scalar converters above, but
+ * the conversion is done by direct bit manipulation in a form the compiler can
+ * vectorize, so mixer lines carried as minifloat do not pay a per-sample
+ * frexpf()/ldexpf() call.
+ */
+
+/* Copy samples from minifloat to float, count samples. */
+void memcpy_to_float_from_sample(float *dst, const sample_minifloat_t *src, size_t count);
+
+/* Copy samples from float to minifloat, count samples.
+ * NaNs convert to 0, values outside (-2.0f, 2.0f) saturate.
+ */
+void memcpy_to_sample_from_float(sample_minifloat_t *dst, const float *src, size_t count);
+
+/* Copy samples from minifloat to int16_t with Q0.15 scaling, count samples.
+ * Clamped and rounded as by clamp16_from_float() in primitives.h.
+ */
+void memcpy_to_i16_from_sample(int16_t *dst, const sample_minifloat_t *src, size_t count);
+
+/* Copy samples from int16_t with Q0.15 scaling to minifloat, count samples. */
+void memcpy_to_sample_from_i16(sample_minifloat_t *dst, const int16_t *src, size_t count);
+
+/* Copy samples from minifloat to float applying a linear gain, count samples. */
+void memcpy_to_float_from_sample_with_gain(float *dst, const sample_minifloat_t *src,
+        size_t count, float gain);
+
+/* Accumulate minifloat samples into a float mix buffer with a linear gain:
+ * dst[i] += gain * src[i], count samples.
+ */
+void accumulate_float_from_sample_with_gain(float *dst, const sample_minifloat_t *src,
+        size_t count, float gain);
+
 __END_DECLS
 
 #endif // ANDROID_AUDIO_SAMPLE_H
@@ -23,6 +23,7 @@
 // The API should be familiar to clients of similar libraries, but there is
 // no guarantee that it will stay exactly source-code compatible with other libraries.
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <sys/cdefs.h>
@@ -48,6 +49,32 @@ typedef struct SNDFILE_ SNDFILE;
 // Access modes
 #define SFM_READ    1
 #define SFM_WRITE   2
+// As SFM_WRITE, but sf_writef_*() only stages the converted data in a ring
+// buffer and a background thread does the file I/O, so writes return in
+// bounded time even when storage stalls (frames that do not fit in the ring
+// are dropped and reported as a short write).  Intended for PCM debug taps
+// on time-critical threads.  The handle must still be used by one writer
+// thread at a time.
+#define SFM_WRITE_ASYNC 3
+// As SFM_READ, but the file is memory-mapped instead of read through stdio:
+// sf_open() is O(header) and sf_readf_*() converts on demand from the mapped
+// region, so pages of a large file are faulted in only as they are played and
+// the data is never resident twice.  Falls back to SFM_READ behavior if the
+// file cannot be mapped.
+#define SFM_READ_MMAP   4
+// As SFM_WRITE, but the header is written once with streaming sentinel sizes
+// (RIFF and data sizes 0xFFFFFFFF, the RF64 convention for "size unknown,
+// data extends to end of stream") and sf_close() never seeks back to patch
+// it, so the output may be a pipe.  sf_open(SFM_READ) of a regular file with
+// such a header derives the frame count from the file size.
+#define SFM_WRITE_STREAM 5
+// As SFM_WRITE, but the data writes bypass the page cache with O_DIRECT:
+// the header is padded with a JUNK chunk so the data payload starts block
+// aligned, and converted data is staged in an aligned buffer written out in
+// block multiples.  Intended for long capture recordings whose data would
+// otherwise evict the rest of the process working set.  Falls back to plain
+// batched writes where the filesystem refuses O_DIRECT.
+#define SFM_WRITE_DIRECT 6
 
 // Format
 #define SF_FORMAT_TYPEMASK  1
@@ -81,6 +108,48 @@ sf_count_t sf_writef_short(SNDFILE *handle, const int16_t *ptr, sf_count_t desir
 sf_count_t sf_writef_float(SNDFILE *handle, const float *ptr, sf_count_t desired);
 sf_count_t sf_writef_int(SNDFILE *handle, const int *ptr, sf_count_t desired);
 
+/**
+ * Pluggable compressed container support.
+ *
+ * sf_open(SFM_READ) consults the registered decoders when a file does not
+ * start with a RIFF header.  A decoder parses the container header itself
+ * and then produces interleaved PCM in whatever chunk size is natural for
+ * the codec; the library stages those chunks in a small ring so
+ * sf_readf_*() can serve any request size with bounded memory.
+ */
+typedef struct SF_DECODER {
+    /** decoder name, for diagnostics only */
+    const char *name;
+    /**
+     * \return true if the leading bytes of a file belong to this container.
+     */
+    bool (*probe)(const uint8_t *header, size_t length);
+    /**
+     * Parse the container header from the rewound stream and fill in info,
+     * including a SF_FORMAT_SUBMASK code describing the decoded output.
+     * A decoder that cannot derive the total frame count from the header
+     * must report an upper bound in info->frames; reads stop at the actual
+     * end of the stream.  The stream remains owned by the caller.
+     * \return decoder state passed to decode() and close(), or NULL on error
+     */
+    void *(*open)(FILE *stream, SF_INFO *info);
+    /**
+     * Decode up to size bytes of interleaved frames into buffer.
+     * \return bytes produced, 0 at end of stream, or a negative errno
+     */
+    int (*decode)(void *state, void *buffer, size_t size);
+    /** Release the decoder state. */
+    void (*close)(void *state);
+} SF_DECODER;
+
+/**
+ * Register a container decoder for sf_open(SFM_READ).  Decoders are probed
+ * in registration order.  The table is process wide; registration is not
+ * thread safe with respect to concurrent sf_open() calls.
+ * \return 0 on success, -EINVAL on a malformed entry, -ENOSPC if the table is full
+ */
+int sf_register_decoder(const SF_DECODER *decoder);
+
 /**
  * Map SF_FORMAT to PCM format
  */
@@ -45,6 +45,16 @@ public:
      */
     virtual bool scan(uint8_t byte);
 
+    /**
+     * Skip ahead over unsynchronized data to the next possible sync word.
+     * Uses a wide memory search instead of the byte-wise state machine, so
+     * call this before scan() when a whole buffer is available.
+     * Only skips when the scanner is between frames; the returned bytes must
+     * not be passed to scan().
+     * @return number of leading bytes that cannot start a sync word
+     */
+    size_t skipToSync(const uint8_t *data, size_t length);
+
     /**
      * @return address of where the sync header was stored by scan()
      */
@@ -109,6 +119,8 @@ protected:
     uint8_t   mHeaderBuffer[32]; // a place to gather the relevant header bytes for parsing
     uint32_t  mHeaderLength;     // the number of bytes we need to parse
     uint32_t  mCursor;           // position in the mHeaderBuffer
+    uint8_t   mPreviousHeader[32]; // last successfully parsed header
+    bool      mHeaderCacheValid; // mPreviousHeader holds a parsed header
     uint32_t  mFormatDumpCount;  // used to thin out the debug dumps
     uint32_t  mSampleRate;       // encoded sample rate
     uint32_t  mRateMultiplier;   // SPDIF output data burst rate = msampleRate * mRateMultiplier
@@ -123,6 +135,16 @@ protected:
      */
     virtual bool parseHeader() = 0;
 
+    /**
+     * Called by scan() instead of parseHeader() when the gathered header is
+     * byte identical to the last successfully parsed one, which is the
+     * common case for minutes at a time on stable-bitrate streams.  The
+     * parse outputs (mDataType, mFrameSizeBytes, mSampleRate, ...) are
+     * still in place from that parse; subclasses whose parseHeader() has
+     * per-frame side effects beyond field extraction must apply them here.
+     */
+    virtual void onHeaderRepeated() {}
+
 };
 
 
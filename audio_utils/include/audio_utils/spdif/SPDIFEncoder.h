@@ -54,6 +54,26 @@ public:
      */
     virtual ssize_t writeOutput( const void* buffer, size_t numBytes ) = 0;
 
+    /**
+     * Called by SPDIFEncoder when it starts assembling a data burst.
+     * Override to enable zero-copy output: return a buffer with room for
+     * numBytes bytes (for example a region of an mmap'd ALSA buffer) and the
+     * burst preamble and payload are assembled there in place, avoiding the
+     * staging copy through the internal burst buffer. The buffer must stay
+     * valid until commitOutput() is called or the encoder is reset.
+     * The default returns NULL, which uses the internal buffer and
+     * writeOutput().
+     */
+    virtual void *reserveOutput( size_t numBytes ) { (void) numBytes; return NULL; }
+
+    /**
+     * Called by SPDIFEncoder when a data burst assembled in a buffer from
+     * reserveOutput() is complete. Counterpart of writeOutput() for the
+     * zero-copy path.
+     * @return number of bytes committed or negative error
+     */
+    virtual ssize_t commitOutput( size_t numBytes ) { return numBytes; }
+
     /**
      * Get ratio of the encoded data burst sample rate to the encoded rate.
      * For example, EAC3 data bursts are 4X the encoded rate.
@@ -97,11 +117,18 @@ protected:
     uint32_t  mSampleRate;
     size_t    mFrameSize;   // size of sync frame in bytes
     uint16_t *mBurstBuffer; // ALSA wants to get SPDIF data as shorts.
+    uint16_t *mOutputBuffer; // current burst assembly target, mBurstBuffer or a
+                             // buffer from reserveOutput()
+    bool      mReservedOutput; // true if mOutputBuffer came from reserveOutput()
     size_t    mBurstBufferSizeBytes;
     uint32_t  mRateMultiplier;
     uint32_t  mBurstFrames;
     size_t    mByteCursor;  // cursor into data burst
     int       mBitstreamNumber;
+    // IEC61937-1 burst preamble template. Pa and Pb are constant and Pc only
+    // changes with the framer's data type info, so starting a burst copies
+    // the template instead of reassembling it.
+    uint16_t  mPreamble[4];
     size_t    mPayloadBytesPending; // number of bytes needed to finish burst
     // state variable, true if scanning for start of frame
     bool      mScanning;
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2022, The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_SPDIF_ENCODER_PIPELINE_H
+#define ANDROID_AUDIO_SPDIF_ENCODER_PIPELINE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <audio_utils/fifo.h>
+#include <audio_utils/spdif/SPDIFEncoder.h>
+
+namespace android {
+
+/**
+ * Runs an SPDIFEncoder on its own thread, fed through a lookahead byte queue.
+ *
+ * SPDIFEncoder::write() scans for sync, swabs and assembles bursts inline on
+ * the caller.  At high bitrates (e.g. MAT/TrueHD passthrough) a scanning
+ * latency spike on a malformed stream can eat the output period budget.
+ * SPDIFEncoderPipeline decouples that: the caller's write() is a bounded
+ * copy into an SPSC audio_utils_fifo of bytes, and a pipeline thread drains
+ * the queue through the encoder, so sync scanning and burst assembly (and
+ * the encoder's writeOutput()) run ahead of, and independently from, the
+ * thread that feeds the output.
+ *
+ * The encoder's writeOutput()/reserveOutput()/commitOutput() are invoked on
+ * the pipeline thread only; the subclass must be safe for that (it already
+ * must not assume a particular caller thread, since write() callers vary).
+ *
+ * The caller's write() blocks only when the queue is full, i.e. when the
+ * scanner has fallen a full lookahead window behind.
+ */
+class SPDIFEncoderPipeline {
+public:
+    /** Enough lookahead to absorb several worst case MAT bursts. */
+    static constexpr size_t kDefaultLookaheadBytes = 64 * 1024;
+
+    /**
+     * \param encoder the encoder to drive; must outlive the pipeline.
+     * \param lookaheadBytes capacity of the byte queue.
+     */
+    explicit SPDIFEncoderPipeline(SPDIFEncoder& encoder,
+            size_t lookaheadBytes = kDefaultLookaheadBytes);
+
+    /** Drains the queue through the encoder, then stops the thread. */
+    ~SPDIFEncoderPipeline();
+
+    /**
+     * Queue encoded data for wrapping.  The compressed frames do not have
+     * to be aligned.  Blocks only while the queue is full.
+     * \return number of bytes accepted or negative error.
+     */
+    ssize_t write(const void *buffer, size_t numBytes);
+
+    /**
+     * Wait until all queued bytes have passed through the encoder,
+     * then reset it.  Call when seeking to a new stream position.
+     */
+    void flush();
+
+private:
+    void threadLoop();
+    void waitUntilDrained();
+
+    SPDIFEncoder& mEncoder;
+    std::vector<uint8_t> mQueueBuffer;
+    audio_utils_fifo mFifo;
+    audio_utils_fifo_writer mWriter;
+    audio_utils_fifo_reader mReader;
+
+    std::mutex mLock;
+    std::condition_variable mDrained;   // signalled when encoded catches up
+    uint64_t mBytesAccepted = 0;        // entered the queue (guarded by mLock)
+    uint64_t mBytesEncoded = 0;         // passed through the encoder
+    std::atomic<bool> mExit{false};
+    std::thread mThread;                // started last, uses all of the above
+};
+
+}  // namespace android
+
+#endif  // ANDROID_AUDIO_SPDIF_ENCODER_PIPELINE_H
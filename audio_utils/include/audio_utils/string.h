@@ -36,6 +36,12 @@ inline size_t audio_utils_strlcpy_zerofill(char *dst, const char *src, size_t ds
 
 #ifdef __cplusplus
 
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <memory>
+
 /** similar to audio_utils_strlcpy_zerofill for fixed size destination string. */
 template <size_t size>
 inline size_t audio_utils_strlcpy_zerofill(char (&dst)[size], const char *src) {
@@ -48,6 +54,239 @@ inline size_t audio_utils_strlcpy(char (&dst)[size], const char *src) {
     return strlcpy(dst, src, size);
 }
 
+namespace android::audio_utils {
+
+/**
+ * Minimal decimal formatters for the dump paths.
+ *
+ * The audio dumps format thousands of values per bugreport and spend most
+ * of that time in vsnprintf's format parsing and locale machinery.  These
+ * kernels write the digits of one value directly into a caller buffer,
+ * always null terminate, and return the length written (excluding the
+ * terminator).  They format like printf with the "C" locale, except that
+ * fixed-point values are rounded half away from zero after scaling by a
+ * power of ten in double precision, which can differ from printf in the
+ * last digit for values near a decimal half.
+ */
+
+/** Buffer size sufficient for utoa(): 20 digits and the null terminator. */
+inline constexpr size_t kMaxUtoaLength = 21;
+
+/** Buffer size sufficient for itoa(): sign, 20 digits, null terminator. */
+inline constexpr size_t kMaxItoaLength = 22;
+
+/** Buffer size sufficient for dtoa_fixed(): itoa, point, 9 fraction digits. */
+inline constexpr size_t kMaxDtoaFixedLength = kMaxItoaLength + 10;
+
+/** Formats value in decimal as "%llu"; buffer holds kMaxUtoaLength chars. */
+inline size_t utoa(uint64_t value, char *buffer) {
+    char digits[kMaxUtoaLength - 1];
+    size_t n = 0;
+    do {  // produces the digits in reverse order.
+        digits[n++] = '0' + (char)(value % 10);
+        value /= 10;
+    } while (value != 0);
+    for (size_t i = 0; i < n; ++i) {
+        buffer[i] = digits[n - 1 - i];
+    }
+    buffer[n] = '\0';
+    return n;
+}
+
+/** Formats value in decimal as "%lld"; buffer holds kMaxItoaLength chars. */
+inline size_t itoa(int64_t value, char *buffer) {
+    if (value < 0) {
+        buffer[0] = '-';
+        // negate as unsigned so INT64_MIN does not overflow.
+        return utoa(-(uint64_t)value, buffer + 1) + 1;
+    }
+    return utoa((uint64_t)value, buffer);
+}
+
+/**
+ * Formats value as "%.*f" with decimals (clamped to 9) fraction digits;
+ * buffer holds kMaxDtoaFixedLength chars.  Values too large for the
+ * integer scaling, infinities, and NaNs take a printf fallback.
+ */
+inline size_t dtoa_fixed(double value, unsigned decimals, char *buffer) {
+    static constexpr uint64_t kPow10[] = {
+        1, 10, 100, 1'000, 10'000, 100'000, 1'000'000,
+        10'000'000, 100'000'000, 1'000'000'000,
+    };
+    if (decimals > 9) decimals = 9;
+    const uint64_t scale = kPow10[decimals];
+    if (!isfinite(value) || fabs(value) >= (double)(UINT64_MAX / scale / 2)) {
+        const int length = snprintf(buffer, kMaxDtoaFixedLength, "%.*f", decimals, value);
+        return length < 0 ? 0 : (size_t)length;
+    }
+    // round half away from zero in the scaled integer domain.
+    const uint64_t scaled = (uint64_t)(fabs(value) * scale + 0.5);
+    char *p = buffer;
+    if (signbit(value)) {  // like printf, -0.04 at one decimal prints "-0.0".
+        *p++ = '-';
+    }
+    p += utoa(scaled / scale, p);
+    if (decimals > 0) {
+        *p++ = '.';
+        uint64_t fraction = scaled % scale;
+        for (unsigned i = decimals; i-- > 0; ) {  // zero padded, reverse fill.
+            p[i] = '0' + (char)(fraction % 10);
+            fraction /= 10;
+        }
+        p += decimals;
+        *p = '\0';
+    }
+    return p - buffer;
+}
+
+/**
+ * dump_writer appends text to a caller-provided fixed-capacity buffer.
+ *
+ * The dump() methods of the audio logs are called during bugreport
+ * collection while the audio threads keep running; assembling their text
+ * through std::string or std::stringstream reallocates repeatedly under
+ * the log lock.  A dump_writer never allocates: it formats in place with
+ * printf semantics, keeps the buffer null terminated at all times, and on
+ * overflow drops further appends and reports truncated(), so a partial
+ * dump is still safe to write out.
+ */
+class dump_writer {
+public:
+    dump_writer(char *buffer, size_t capacity)
+        : mBuffer(buffer), mCapacity(capacity)
+    {
+        if (mCapacity > 0) {
+            mBuffer[0] = '\0';
+        }
+    }
+
+    /** Appends len bytes of s, truncating if the buffer is full. */
+    dump_writer& appendn(const char *s, size_t len) {
+        if (mCapacity == 0) {
+            mTruncated = true;
+            return *this;
+        }
+        if (len >= mCapacity - mSize) {
+            len = mCapacity - mSize - 1;
+            mTruncated = true;
+        }
+        memcpy(mBuffer + mSize, s, len);
+        mSize += len;
+        mBuffer[mSize] = '\0';
+        return *this;
+    }
+
+    /** Appends a null terminated string, truncating if the buffer is full. */
+    dump_writer& append(const char *s) {
+        return appendn(s, strlen(s));
+    }
+
+    /** Appends with printf formatting by va_list, truncating if the buffer is full. */
+    dump_writer& appendv(const char *format, va_list args) {
+        if (mCapacity == 0) {
+            mTruncated = true;
+            return *this;
+        }
+        const size_t remaining = mCapacity - mSize;
+        const int length = vsnprintf(mBuffer + mSize, remaining, format, args);
+        if (length < 0) {  // encoding error, buffer contents unspecified
+            mBuffer[mSize] = '\0';
+        } else if ((size_t)length >= remaining) {
+            mSize = mCapacity - (mCapacity != 0);
+            mTruncated = true;
+        } else {
+            mSize += length;
+        }
+        return *this;
+    }
+
+    /** Appends with printf formatting, truncating if the buffer is full. */
+    dump_writer& appendf(const char *format, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, format);
+        appendv(format, args);
+        va_end(args);
+        return *this;
+    }
+
+    /** Appends a decimal integer, as appendf("%lld") without the printf cost. */
+    dump_writer& append_int(int64_t value) {
+        char digits[kMaxItoaLength];
+        return appendn(digits, itoa(value, digits));
+    }
+
+    /** Appends a decimal integer, as appendf("%llu") without the printf cost. */
+    dump_writer& append_uint(uint64_t value) {
+        char digits[kMaxUtoaLength];
+        return appendn(digits, utoa(value, digits));
+    }
+
+    /**
+     * Appends value with a fixed number of fraction digits, space padded on
+     * the left to at least width chars: appendf("%*.*f") without the printf
+     * cost (see dtoa_fixed() for the tie rounding caveat).
+     */
+    dump_writer& append_fixed(double value, unsigned decimals, size_t width = 0) {
+        char digits[kMaxDtoaFixedLength];
+        const size_t length = dtoa_fixed(value, decimals, digits);
+        for (size_t pad = length; pad < width; ++pad) {
+            appendn(" ", 1);
+        }
+        return appendn(digits, length);
+    }
+
+    const char *c_str() const { return mCapacity > 0 ? mBuffer : ""; }
+    size_t size() const { return mSize; }
+    bool truncated() const { return mTruncated; }
+
+private:
+    char * const mBuffer;
+    const size_t mCapacity;
+    size_t mSize = 0;
+    bool mTruncated = false;
+};
+
+/**
+ * dump_buffer is a dump_writer bundled with its storage: stack storage up
+ * to StackCapacity, otherwise a single up-front heap block.  Either way the
+ * capacity is fixed for the lifetime of the writer and nothing reallocates.
+ */
+template <size_t StackCapacity = 4096>
+class dump_buffer {
+public:
+    explicit dump_buffer(size_t capacity = StackCapacity)
+        : mHeap(capacity > StackCapacity ? new char[capacity] : nullptr)
+        , mWriter(mHeap ? mHeap.get() : mStack, capacity)
+    {
+    }
+
+    dump_writer& appendn(const char *s, size_t len) { return mWriter.appendn(s, len); }
+    dump_writer& append(const char *s) { return mWriter.append(s); }
+    dump_writer& appendf(const char *format, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, format);
+        mWriter.appendv(format, args);
+        va_end(args);
+        return mWriter;
+    }
+    dump_writer& append_int(int64_t value) { return mWriter.append_int(value); }
+    dump_writer& append_uint(uint64_t value) { return mWriter.append_uint(value); }
+    dump_writer& append_fixed(double value, unsigned decimals, size_t width = 0) {
+        return mWriter.append_fixed(value, decimals, width);
+    }
+
+    const char *c_str() const { return mWriter.c_str(); }
+    size_t size() const { return mWriter.size(); }
+    bool truncated() const { return mWriter.truncated(); }
+
+private:
+    char mStack[StackCapacity];
+    const std::unique_ptr<char[]> mHeap;
+    dump_writer mWriter;
+};
+
+} // namespace android::audio_utils
+
 #endif // __cplusplus
 
 #endif // !ANDROID_AUDIO_STRING_H
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_THREADS_H
+#define ANDROID_AUDIO_THREADS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+/** \cond */
+__BEGIN_DECLS
+/** \endcond */
+
+/**
+ * Highest SCHED_FIFO priority an audio thread should request.  Higher values
+ * belong to the kernel and the audio HAL interrupt handlers; a helper request
+ * above the ceiling is clamped, not refused.
+ */
+#define AUDIO_UTILS_RT_PRIORITY_CEILING 3
+
+/**
+ * Make the calling thread realtime: SCHED_FIFO at \p priority clamped to
+ * [1, AUDIO_UTILS_RT_PRIORITY_CEILING], optionally pinned to the CPUs in
+ * \p cpu_mask (bit n = CPU n, 0 leaves the affinity unchanged).
+ * A page-granular region of the caller's stack is pre-faulted so the first
+ * deep call on the realtime path does not take page faults.
+ *
+ * \return 0 on success or a negative errno:
+ * \retval -EPERM the caller lacks the privilege for realtime scheduling
+ * \retval -EINVAL cpu_mask selects no online CPU
+ */
+int audio_utils_set_realtime_self(int priority, uint64_t cpu_mask);
+
+/**
+ * \return the realtime (SCHED_FIFO or SCHED_RR) priority of thread \p tid,
+ * 0 if the thread is not realtime, or a negative errno (-ESRCH if gone).
+ */
+int audio_utils_thread_rt_priority(pid_t tid);
+
+/**
+ * Check that the writer and reader threads of a single-writer single-reader
+ * FIFO run at compatible priorities: either both realtime or both timeshared.
+ * A realtime thread paired with a timeshared one is the classic priority
+ * inversion setup — the realtime side meets its deadline while its peer is
+ * starved off-CPU and the FIFO over- or underruns.
+ *
+ * \return 0 when compatible, -EPERM when one side is realtime and the other
+ * is not, or a negative errno if a thread could not be inspected.
+ */
+int audio_utils_check_fifo_thread_priorities(pid_t writer_tid, pid_t reader_tid);
+
+/**
+ * Touch \p bytes of the calling thread's stack (rounded up to whole pages,
+ * clamped to 256 KiB) so they are resident before entering a realtime loop.
+ * Called by audio_utils_set_realtime_self(); exposed for threads that manage
+ * their scheduling elsewhere.
+ */
+void audio_utils_prefault_stack(size_t bytes);
+
+/** \cond */
+__END_DECLS
+/** \endcond */
+
+#endif // ANDROID_AUDIO_THREADS_H
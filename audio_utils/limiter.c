@@ -15,6 +15,9 @@
  */
 
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include <audio_utils/limiter.h>
 
 #undef USE_ATAN_APPROXIMATION
@@ -67,3 +70,214 @@ float limiter(float in)
     }
     return out;
 }
+
+/*
+ * Lookahead limiter
+ *
+ * The input is delayed by lookahead_frames while a monotonic deque tracks
+ * the largest per-frame peak over the window covering the delayed frame
+ * and everything after it up to the present.  The gain derived from that
+ * windowed maximum therefore already bounds the frame being emitted, so
+ * the output can never exceed the threshold; gain reduction ramps in over
+ * the lookahead and recovers with a one-pole release.
+ */
+
+struct lookahead_limiter {
+    uint32_t channel_count;
+    uint32_t lookahead_frames;
+    uint32_t window;            /* lookahead_frames + 1 peaks */
+    float threshold;
+    float release_coeff;        /* one-pole coefficient per frame */
+
+    float gain;                 /* current smoothed gain */
+    uint64_t frame_index;
+    uint32_t delay_pos;         /* frame position in the delay ring */
+    float *delay;               /* lookahead_frames * channel_count samples */
+
+    /* monotonic deque over the peak window: indices strictly increasing,
+       peaks non-increasing from front to back */
+    uint32_t deque_front;
+    uint32_t deque_count;
+    uint64_t *deque_index;
+    float *deque_peak;
+};
+
+lookahead_limiter_t *lookahead_limiter_create(uint32_t sample_rate,
+        uint32_t channel_count, uint32_t lookahead_frames,
+        float threshold, float release_ms)
+{
+    if (sample_rate == 0 || channel_count == 0 || !(threshold > 0.f)) {
+        return NULL;
+    }
+
+    lookahead_limiter_t *limiter = calloc(1, sizeof(*limiter));
+    if (limiter == NULL) {
+        return NULL;
+    }
+    limiter->channel_count = channel_count;
+    limiter->lookahead_frames = lookahead_frames;
+    limiter->window = lookahead_frames + 1;
+    limiter->threshold = threshold;
+    if (release_ms > 0.f) {
+        limiter->release_coeff =
+                1.f - expf(-1000.f / (release_ms * sample_rate));
+    } else {
+        limiter->release_coeff = 1.f;   /* instant release */
+    }
+
+    if (lookahead_frames != 0) {
+        limiter->delay = calloc((size_t)lookahead_frames * channel_count,
+                sizeof(float));
+        if (limiter->delay == NULL) {
+            goto fail;
+        }
+    }
+    limiter->deque_index = calloc(limiter->window, sizeof(uint64_t));
+    limiter->deque_peak = calloc(limiter->window, sizeof(float));
+    if (limiter->deque_index == NULL || limiter->deque_peak == NULL) {
+        goto fail;
+    }
+    limiter->gain = 1.f;
+    return limiter;
+
+fail:
+    lookahead_limiter_free(limiter);
+    return NULL;
+}
+
+void lookahead_limiter_free(lookahead_limiter_t *limiter)
+{
+    if (limiter == NULL) {
+        return;
+    }
+    free(limiter->delay);
+    free(limiter->deque_index);
+    free(limiter->deque_peak);
+    free(limiter);
+}
+
+void lookahead_limiter_reset(lookahead_limiter_t *limiter)
+{
+    if (limiter->delay != NULL) {
+        memset(limiter->delay, 0,
+               (size_t)limiter->lookahead_frames * limiter->channel_count *
+               sizeof(float));
+    }
+    limiter->gain = 1.f;
+    limiter->frame_index = 0;
+    limiter->delay_pos = 0;
+    limiter->deque_front = 0;
+    limiter->deque_count = 0;
+}
+
+uint32_t lookahead_limiter_get_delay(const lookahead_limiter_t *limiter)
+{
+    return limiter->lookahead_frames;
+}
+
+/* returns the gain for the frame about to be emitted, given this frame's peak */
+static inline float limiter_gain_for_peak(lookahead_limiter_t *limiter, float peak)
+{
+    /* drop entries smaller than the new peak; they can never be the max */
+    while (limiter->deque_count != 0) {
+        const uint32_t back = (limiter->deque_front + limiter->deque_count - 1)
+                % limiter->window;
+        if (limiter->deque_peak[back] > peak) {
+            break;
+        }
+        limiter->deque_count--;
+    }
+    const uint32_t back = (limiter->deque_front + limiter->deque_count)
+            % limiter->window;
+    limiter->deque_index[back] = limiter->frame_index;
+    limiter->deque_peak[back] = peak;
+    limiter->deque_count++;
+
+    /* evict entries that slid out of the window */
+    if (limiter->deque_index[limiter->deque_front] + limiter->window
+            <= limiter->frame_index) {
+        limiter->deque_front = (limiter->deque_front + 1) % limiter->window;
+        limiter->deque_count--;
+    }
+    limiter->frame_index++;
+
+    const float window_max = limiter->deque_peak[limiter->deque_front];
+    const float target = window_max > limiter->threshold ?
+            limiter->threshold / window_max : 1.f;
+    if (target < limiter->gain) {
+        limiter->gain = target;     /* the lookahead provides the attack ramp */
+    } else {
+        limiter->gain += limiter->release_coeff * (target - limiter->gain);
+    }
+    return limiter->gain;
+}
+
+void lookahead_limiter_process(lookahead_limiter_t *limiter,
+        float *out, const float *in, size_t frames)
+{
+    const uint32_t channels = limiter->channel_count;
+
+    for (size_t i = 0; i < frames; i++) {
+        float peak = 0.f;
+        for (uint32_t ch = 0; ch < channels; ch++) {
+            const float mag = fabsf(in[ch]);
+            if (mag > peak) {
+                peak = mag;
+            }
+        }
+        const float gain = limiter_gain_for_peak(limiter, peak);
+
+        if (limiter->lookahead_frames == 0) {
+            for (uint32_t ch = 0; ch < channels; ch++) {
+                out[ch] = in[ch] * gain;
+            }
+        } else {
+            float *slot = &limiter->delay[(size_t)limiter->delay_pos * channels];
+            for (uint32_t ch = 0; ch < channels; ch++) {
+                const float delayed = slot[ch];
+                slot[ch] = in[ch];
+                out[ch] = delayed * gain;
+            }
+            if (++limiter->delay_pos == limiter->lookahead_frames) {
+                limiter->delay_pos = 0;
+            }
+        }
+        in += channels;
+        out += channels;
+    }
+}
+
+void lookahead_limiter_process_q15(lookahead_limiter_t *limiter,
+        int16_t *out, const int16_t *in, size_t frames)
+{
+    const uint32_t channels = limiter->channel_count;
+
+    for (size_t i = 0; i < frames; i++) {
+        float peak = 0.f;
+        for (uint32_t ch = 0; ch < channels; ch++) {
+            const float mag = fabsf(in[ch] * (1.f / 32768.f));
+            if (mag > peak) {
+                peak = mag;
+            }
+        }
+        const float gain = limiter_gain_for_peak(limiter, peak);
+
+        if (limiter->lookahead_frames == 0) {
+            for (uint32_t ch = 0; ch < channels; ch++) {
+                out[ch] = (int16_t)lrintf(in[ch] * gain);
+            }
+        } else {
+            float *slot = &limiter->delay[(size_t)limiter->delay_pos * channels];
+            for (uint32_t ch = 0; ch < channels; ch++) {
+                const float delayed = slot[ch];
+                slot[ch] = in[ch];
+                out[ch] = (int16_t)lrintf(delayed * gain);
+            }
+            if (++limiter->delay_pos == limiter->lookahead_frames) {
+                limiter->delay_pos = 0;
+            }
+        }
+        in += channels;
+        out += channels;
+    }
+}
@@ -60,3 +60,68 @@ float float_from_gain(gain_minifloat_t a)
     return ldexpf((exponent > 0 ? HIDDEN_BIT | mantissa : mantissa << 1) / ONE_FLOAT,
             exponent - EXCESS);
 }
+
+/*
+ * Branch-light converters for the batch entry points below.  These are
+ * bit-exact with gain_from_float() / float_from_gain() (verified
+ * exhaustively over all 2^16 minifloats and by sweeping the float range)
+ * but avoid the frexpf/ldexpf calls so the loops vectorize.
+ */
+
+/* 2^(exponent - MANTISSA_BITS - EXCESS - 1), so that
+   value = significand * scale with the denormal doubling folded in */
+static const float exponent_scale[EXPONENT_MAX + 1] = {
+    0x1p-20f, 0x1p-19f, 0x1p-18f, 0x1p-17f,
+    0x1p-16f, 0x1p-15f, 0x1p-14f, 0x1p-13f,
+};
+
+static inline float float_from_gain_bits(gain_minifloat_t a)
+{
+    const uint32_t exponent = a >> MANTISSA_BITS;
+    const uint32_t mantissa = a & MANTISSA_MAX;
+    const uint32_t significand = exponent != 0 ?
+            (HIDDEN_BIT | mantissa) : (mantissa << 1);
+    return (float) significand * exponent_scale[exponent];
+}
+
+static inline gain_minifloat_t gain_from_float_bits(float v)
+{
+    if (!(v > 0.0f)) {      /* also catches NaN */
+        return 0;
+    }
+    if (v >= 2.0f) {
+        return MINIFLOAT_MAX;
+    }
+    union {
+        float f;
+        uint32_t i;
+    } u = { v };
+    /* frexpf exponent: v = r * 2^exp with r in [0.5, 1) */
+    const int exp = (int) (u.i >> 23) - 126;
+    const int e = exp + EXCESS;
+    if (-e >= MANTISSA_BITS) {
+        return 0;
+    }
+    /* (int) (r * ONE_FLOAT), exact as r carries 24 significand bits */
+    const int mantissa = (int) (((u.i & 0x7FFFFF) | 0x800000) >> 10);
+    return e > 0 ? (e << MANTISSA_BITS) | (mantissa & ~HIDDEN_BIT) :
+            (mantissa >> (1 - e)) & MANTISSA_MAX;
+}
+
+void float_from_gain_array(float *left, float *right,
+        const gain_minifloat_packed_t *gains, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        left[i] = float_from_gain_bits(gain_minifloat_unpack_left(gains[i]));
+        right[i] = float_from_gain_bits(gain_minifloat_unpack_right(gains[i]));
+    }
+}
+
+void gain_from_float_array(gain_minifloat_packed_t *gains,
+        const float *left, const float *right, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        gains[i] = gain_minifloat_pack(gain_from_float_bits(left[i]),
+                gain_from_float_bits(right[i]));
+    }
+}
@@ -19,7 +19,53 @@
 #include <audio_utils/limiter.h>
 #include <audio_utils/mono_blend.h>
 
-// TODO: Speed up for special case of 2 channels?
+namespace {
+
+// Fixed channel count blend loops: with channelCount a compile time constant
+// the inner channel loops unroll and the frame loop vectorizes.
+
+template <size_t channelCount>
+void mono_blend_i16(int16_t *out, size_t frames) {
+    for (size_t i = 0; i < frames; ++i) {
+        int accum = 0;
+        for (size_t j = 0; j < channelCount; ++j) {
+            accum += out[j];
+        }
+        accum /= channelCount; // unsigned divide, same rounding as the generic loop
+        for (size_t j = 0; j < channelCount; ++j) {
+            out[j] = accum;
+        }
+        out += channelCount;
+    }
+}
+
+template <size_t channelCount>
+void mono_blend_float(float *out, size_t frames, bool limit) {
+    if (limit && channelCount == 2) {
+        for (size_t i = 0; i < frames; ++i) {
+            const float accum = limiter((out[0] + out[1]) * M_SQRT1_2);
+            out[0] = accum;
+            out[1] = accum;
+            out += channelCount;
+        }
+        return;
+    }
+    constexpr float recipdiv = 1.f / channelCount;
+    for (size_t i = 0; i < frames; ++i) {
+        float accum = 0;
+        for (size_t j = 0; j < channelCount; ++j) {
+            accum += out[j];
+        }
+        accum *= recipdiv;
+        for (size_t j = 0; j < channelCount; ++j) {
+            out[j] = accum;
+        }
+        out += channelCount;
+    }
+}
+
+} // namespace
+
 void mono_blend(void *buf, audio_format_t format, size_t channelCount, size_t frames, bool limit) {
     if (channelCount < 2) {
         return;
@@ -27,6 +73,19 @@ void mono_blend(void *buf, audio_format_t format, size_t channelCount, size_t fr
     switch (format) {
     case AUDIO_FORMAT_PCM_16_BIT: {
         int16_t *out = (int16_t *)buf;
+        switch (channelCount) {
+        case 2:
+            mono_blend_i16<2>(out, frames);
+            return;
+        case 4:
+            mono_blend_i16<4>(out, frames);
+            return;
+        case 8:
+            mono_blend_i16<8>(out, frames);
+            return;
+        default:
+            break;
+        }
         for (size_t i = 0; i < frames; ++i) {
             const int16_t *in = out;
             int accum = 0;
@@ -41,6 +100,19 @@ void mono_blend(void *buf, audio_format_t format, size_t channelCount, size_t fr
     } break;
     case AUDIO_FORMAT_PCM_FLOAT: {
         float *out = (float *)buf;
+        switch (channelCount) {
+        case 2:
+            mono_blend_float<2>(out, frames, limit);
+            return;
+        case 4:
+            mono_blend_float<4>(out, frames, limit);
+            return;
+        case 8:
+            mono_blend_float<8>(out, frames, limit);
+            return;
+        default:
+            break;
+        }
         const float recipdiv = 1. / channelCount;
         for (size_t i = 0; i < frames; ++i) {
             const float *in = out;
@@ -0,0 +1,529 @@
+/*
+** Copyright 2026, The Android Open-Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+/* A polyphase FIR resampler for interleaved int16_t audio.
+ *
+ * At creation a Hann windowed sinc prototype is sampled into a bank of
+ * PHASES + 1 subfilters of `taps` Q14 coefficients each, stored time
+ * reversed so the inner product walks the history buffer forward.  The
+ * output position advances through the input in 32.32 fixed point; the
+ * fractional part selects two adjacent subfilters whose inner products are
+ * linearly interpolated, which is exact because interpolating the
+ * coefficients and interpolating the two dot products are the same thing.
+ * The tap count scales with the decimation ratio so the transition band
+ * stays proportional to the output Nyquist, and every subfilter is
+ * normalized to unit DC gain.
+ *
+ * Rational ratios with a small reduced upsampling factor L (notably the
+ * dominant 44.1k <-> 48k conversion, 147:160) get an exact mixed-radix
+ * path instead: the bank holds all L subfilters, the phase advances by
+ * the reduced ratio in integer arithmetic, and each output frame is a
+ * single inner product with no interpolation, no rounding drift, and a
+ * deterministic per-block cost (exactly L output frames per M input
+ * frames in steady state).
+ *
+ * Input is accumulated in an internal buffer behind `taps - 1` frames of
+ * history, so any split of the input stream across process calls produces
+ * the same output.  On AArch64 the mono inner product runs eight taps per
+ * NEON multiply-accumulate.
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <audio_utils/polyphase_resampler.h>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#define LOG_PHASES 6
+#define PHASES (1 << LOG_PHASES)
+
+/* Base tap count; grows with the decimation ratio, always a multiple of 8. */
+#define BASE_TAPS 16
+#define MAX_TAPS 64
+
+/* Passband edge as a fraction of the narrower Nyquist. */
+#define CUTOFF 0.90
+
+/* Largest reduced upsampling factor L for the exact rational path;
+   covers 147:160 (44.1k <-> 48k) with a 160 x taps Q14 bank of ~20 KB. */
+#define MAX_RATIONAL_PHASES 256
+
+struct polyphase_resampler {
+    uint32_t in_sample_rate;
+    uint32_t out_sample_rate;
+    uint32_t channel_count;
+    uint32_t taps;            // coefficients per subfilter
+    int16_t *coefs;           // subfilter rows of `taps` Q14 coefs, time reversed
+    uint64_t step;            // input frames per output frame, 32.32
+    uint64_t pos;             // position of the next output frame in buf, 32.32
+                              // (fraction always zero in rational mode)
+    uint32_t rational_l;      // nonzero: exact rational mode with this many phases
+    uint32_t rational_m;      // input frames per output frame, numerator over rational_l
+    uint32_t rational_phase;  // phase numerator of the next output frame, < rational_l
+    int16_t *buf;             // history + buffered input, interleaved
+    size_t buf_size;          // allocated frames in buf
+    size_t frames;            // valid frames in buf, always >= taps - 1
+};
+
+/* Samples the prototype into `rows` subfilters at fractional offsets
+   phase / phases; the generic path uses rows == phases + 1 so two adjacent
+   rows always exist for interpolation, the rational path rows == phases. */
+static int16_t *make_filter_bank(uint32_t taps, uint32_t phases, uint32_t rows,
+        uint32_t in_sample_rate, uint32_t out_sample_rate)
+{
+    const double cutoff = CUTOFF *
+            (out_sample_rate < in_sample_rate ?
+                    (double)out_sample_rate / in_sample_rate : 1.);
+
+    int16_t *coefs = (int16_t *)malloc((size_t)rows * taps * sizeof(int16_t));
+    if (coefs == NULL) {
+        return NULL;
+    }
+    for (uint32_t phase = 0; phase < rows; ++phase) {
+        double h[MAX_TAPS];
+        double sum = 0.;
+        for (uint32_t j = 0; j < taps; ++j) {
+            const double u = j + (double)phase / phases;
+            const double x = u - taps / 2.;
+            const double sinc = x == 0. ? 1. : sin(M_PI * cutoff * x) / (M_PI * cutoff * x);
+            const double window = 0.5 - 0.5 * cos(2. * M_PI * u / taps);
+            h[j] = cutoff * sinc * window;
+            sum += h[j];
+        }
+        // unit DC gain per subfilter keeps the passband ripple-free at DC
+        // and the interpolated subfilters normalized as well.
+        int16_t *row = coefs + phase * taps;
+        for (uint32_t j = 0; j < taps; ++j) {
+            row[taps - 1 - j] = (int16_t)lrint(h[j] / sum * (1 << 14));
+        }
+    }
+    return coefs;
+}
+
+// longer filter when decimating, so the transition band tracks the
+// output Nyquist; rounded up to a multiple of 8 for the NEON kernel.
+static uint32_t compute_taps(uint32_t in_sample_rate, uint32_t out_sample_rate)
+{
+    uint64_t taps = (uint64_t)BASE_TAPS * in_sample_rate / out_sample_rate;
+    if (taps < BASE_TAPS) {
+        taps = BASE_TAPS;
+    } else if (taps > MAX_TAPS) {
+        taps = MAX_TAPS;
+    }
+    return ((uint32_t)taps + 7) & ~7u;
+}
+
+static uint32_t gcd(uint32_t a, uint32_t b)
+{
+    while (b != 0) {
+        const uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static inline int16_t clamp16(int32_t sample)
+{
+    if ((sample >> 15) ^ (sample >> 31)) {
+        sample = 0x7FFF ^ (sample >> 31);
+    }
+    return sample;
+}
+
+#if defined(__aarch64__)
+static inline int32_t dot_mono_neon(const int16_t *coef, const int16_t *x, uint32_t taps)
+{
+    int32x4_t acc = vdupq_n_s32(0);
+    for (uint32_t i = 0; i < taps; i += 8) {
+        const int16x8_t c = vld1q_s16(coef + i);
+        const int16x8_t s = vld1q_s16(x + i);
+        acc = vmlal_s16(acc, vget_low_s16(c), vget_low_s16(s));
+        acc = vmlal_s16(acc, vget_high_s16(c), vget_high_s16(s));
+    }
+    return vaddvq_s32(acc);
+}
+#endif
+
+static inline int32_t dot(const int16_t *coef, const int16_t *x,
+        uint32_t taps, uint32_t stride)
+{
+#if defined(__aarch64__)
+    if (stride == 1) {
+        return dot_mono_neon(coef, x, taps);
+    }
+#endif
+    int32_t acc = 0;
+    for (uint32_t i = 0; i < taps; ++i) {
+        acc += coef[i] * x[i * stride];
+    }
+    return acc;
+}
+
+struct polyphase_resampler *polyphase_resampler_create(uint32_t in_sample_rate,
+        uint32_t out_sample_rate, uint32_t channel_count)
+{
+    if (in_sample_rate == 0 || out_sample_rate == 0 || channel_count == 0) {
+        return NULL;
+    }
+
+    struct polyphase_resampler *rs =
+            (struct polyphase_resampler *)calloc(1, sizeof(*rs));
+    if (rs == NULL) {
+        return NULL;
+    }
+    rs->in_sample_rate = in_sample_rate;
+    rs->out_sample_rate = out_sample_rate;
+    rs->channel_count = channel_count;
+
+    rs->taps = compute_taps(in_sample_rate, out_sample_rate);
+    rs->step = ((uint64_t)in_sample_rate << 32) / out_sample_rate;
+
+    const uint32_t g = gcd(in_sample_rate, out_sample_rate);
+    const uint32_t l = out_sample_rate / g;
+    if (l <= MAX_RATIONAL_PHASES) {
+        rs->rational_l = l;
+        rs->rational_m = in_sample_rate / g;
+        rs->coefs = make_filter_bank(rs->taps, l, l,
+                in_sample_rate, out_sample_rate);
+    } else {
+        rs->coefs = make_filter_bank(rs->taps, PHASES, PHASES + 1,
+                in_sample_rate, out_sample_rate);
+    }
+    if (rs->coefs == NULL) {
+        free(rs);
+        return NULL;
+    }
+
+    rs->buf_size = rs->taps - 1;
+    rs->buf = (int16_t *)malloc(rs->buf_size * channel_count * sizeof(int16_t));
+    if (rs->buf == NULL) {
+        free(rs->coefs);
+        free(rs);
+        return NULL;
+    }
+    polyphase_resampler_reset(rs);
+    return rs;
+}
+
+void polyphase_resampler_destroy(struct polyphase_resampler *rs)
+{
+    if (rs == NULL) {
+        return;
+    }
+    free(rs->coefs);
+    free(rs->buf);
+    free(rs);
+}
+
+void polyphase_resampler_reset(struct polyphase_resampler *rs)
+{
+    rs->frames = rs->taps - 1;
+    memset(rs->buf, 0, rs->frames * rs->channel_count * sizeof(int16_t));
+    rs->pos = (uint64_t)(rs->taps - 1) << 32;
+    rs->rational_phase = 0;
+}
+
+size_t polyphase_resampler_input_latency(const struct polyphase_resampler *rs)
+{
+    return rs->taps / 2;
+}
+
+int polyphase_resampler_process(struct polyphase_resampler *rs,
+        const int16_t *in, size_t *in_frames, int16_t *out, size_t *out_frames)
+{
+    const uint32_t channels = rs->channel_count;
+    const uint32_t taps = rs->taps;
+    const size_t total = rs->frames + *in_frames;
+
+    if (total > rs->buf_size) {
+        int16_t *buf = (int16_t *)realloc(rs->buf,
+                total * channels * sizeof(int16_t));
+        if (buf == NULL) {
+            *out_frames = 0;
+            return -ENOMEM;
+        }
+        rs->buf = buf;
+        rs->buf_size = total;
+    }
+    memcpy(rs->buf + rs->frames * channels, in,
+            *in_frames * channels * sizeof(int16_t));
+
+    size_t produced = 0;
+    uint64_t pos = rs->pos;
+    if (rs->rational_l != 0) {
+        // exact rational stepping: the phase numerator selects one exact
+        // subfilter, no interpolation, one inner product per channel.
+        const uint32_t l = rs->rational_l;
+        const uint32_t m = rs->rational_m;
+        uint32_t phase = rs->rational_phase;
+        while (produced < *out_frames && (size_t)(pos >> 32) < total) {
+            const int16_t *window =
+                    rs->buf + ((size_t)(pos >> 32) - (taps - 1)) * channels;
+            const int16_t *c = rs->coefs + phase * taps;
+            for (uint32_t ch = 0; ch < channels; ++ch) {
+                const int32_t acc = dot(c, window + ch, taps, channels);
+                out[produced * channels + ch] = clamp16((acc + (1 << 13)) >> 14);
+            }
+            ++produced;
+            phase += m;
+            pos += (uint64_t)(phase / l) << 32;
+            phase %= l;
+        }
+        rs->rational_phase = phase;
+    } else {
+        while (produced < *out_frames && (size_t)(pos >> 32) < total) {
+            const uint32_t frac = (uint32_t)pos;
+            const uint32_t phase = frac >> (32 - LOG_PHASES);
+            const int32_t mu = (frac >> (32 - LOG_PHASES - 15)) & 0x7FFF;
+            const int16_t *window =
+                    rs->buf + ((size_t)(pos >> 32) - (taps - 1)) * channels;
+            const int16_t *c0 = rs->coefs + phase * taps;
+            const int16_t *c1 = c0 + taps;
+            for (uint32_t ch = 0; ch < channels; ++ch) {
+                const int32_t a = dot(c0, window + ch, taps, channels);
+                const int32_t b = dot(c1, window + ch, taps, channels);
+                const int32_t acc = a + (int32_t)(((int64_t)(b - a) * mu) >> 15);
+                out[produced * channels + ch] = clamp16((acc + (1 << 13)) >> 14);
+            }
+            ++produced;
+            pos += rs->step;
+        }
+    }
+
+    // retain the window of the next output frame (at least taps - 1 frames)
+    size_t consumed = pos >> 32 > taps - 1 ? (size_t)(pos >> 32) - (taps - 1) : 0;
+    if (consumed > total - (taps - 1)) {
+        consumed = total - (taps - 1);
+    }
+    if (consumed > 0) {
+        memmove(rs->buf, rs->buf + consumed * channels,
+                (total - consumed) * channels * sizeof(int16_t));
+        pos -= (uint64_t)consumed << 32;
+    }
+    rs->frames = total - consumed;
+    rs->pos = pos;
+    *out_frames = produced;
+    return 0;
+}
+
+/* A bank of identical resamplers processed in lockstep.
+ *
+ * One coefficient table and one 32.32 position serve every stream, so the
+ * per-output-frame work is: select the two subfilters once, then run the
+ * inner products of all streams while those rows are hot in cache.  The
+ * sample histories are the only per-stream state, laid out as equal sized
+ * regions of one allocation (stream s at buf + s * buf_size * channels).
+ */
+struct polyphase_resampler_bank {
+    uint32_t in_sample_rate;
+    uint32_t out_sample_rate;
+    uint32_t channel_count;
+    uint32_t stream_count;
+    uint32_t taps;            // coefficients per subfilter
+    int16_t *coefs;           // subfilter rows, shared by all streams
+    uint64_t step;            // input frames per output frame, 32.32
+    uint64_t pos;             // position of the next output frame, 32.32
+                              // (fraction always zero in rational mode)
+    uint32_t rational_l;      // nonzero: exact rational mode with this many phases
+    uint32_t rational_m;      // input frames per output frame, numerator over rational_l
+    uint32_t rational_phase;  // phase numerator of the next output frame, < rational_l
+    int16_t *buf;             // stream-major history + buffered input
+    size_t buf_size;          // allocated frames per stream
+    size_t frames;            // valid frames per stream, always >= taps - 1
+};
+
+struct polyphase_resampler_bank *polyphase_resampler_bank_create(
+        uint32_t in_sample_rate, uint32_t out_sample_rate,
+        uint32_t channel_count, uint32_t stream_count)
+{
+    if (in_sample_rate == 0 || out_sample_rate == 0 || channel_count == 0
+            || stream_count == 0) {
+        return NULL;
+    }
+
+    struct polyphase_resampler_bank *rs =
+            (struct polyphase_resampler_bank *)calloc(1, sizeof(*rs));
+    if (rs == NULL) {
+        return NULL;
+    }
+    rs->in_sample_rate = in_sample_rate;
+    rs->out_sample_rate = out_sample_rate;
+    rs->channel_count = channel_count;
+    rs->stream_count = stream_count;
+    rs->taps = compute_taps(in_sample_rate, out_sample_rate);
+    rs->step = ((uint64_t)in_sample_rate << 32) / out_sample_rate;
+
+    // same mode selection as the single-stream resampler, so a bank stays
+    // bit exact with independent resamplers at the same ratio.
+    const uint32_t g = gcd(in_sample_rate, out_sample_rate);
+    const uint32_t l = out_sample_rate / g;
+    if (l <= MAX_RATIONAL_PHASES) {
+        rs->rational_l = l;
+        rs->rational_m = in_sample_rate / g;
+        rs->coefs = make_filter_bank(rs->taps, l, l,
+                in_sample_rate, out_sample_rate);
+    } else {
+        rs->coefs = make_filter_bank(rs->taps, PHASES, PHASES + 1,
+                in_sample_rate, out_sample_rate);
+    }
+    if (rs->coefs == NULL) {
+        free(rs);
+        return NULL;
+    }
+
+    rs->buf_size = rs->taps - 1;
+    rs->buf = (int16_t *)malloc((size_t)stream_count * rs->buf_size
+            * channel_count * sizeof(int16_t));
+    if (rs->buf == NULL) {
+        free(rs->coefs);
+        free(rs);
+        return NULL;
+    }
+    polyphase_resampler_bank_reset(rs);
+    return rs;
+}
+
+void polyphase_resampler_bank_destroy(struct polyphase_resampler_bank *rs)
+{
+    if (rs == NULL) {
+        return;
+    }
+    free(rs->coefs);
+    free(rs->buf);
+    free(rs);
+}
+
+void polyphase_resampler_bank_reset(struct polyphase_resampler_bank *rs)
+{
+    rs->frames = rs->taps - 1;
+    for (uint32_t s = 0; s < rs->stream_count; ++s) {
+        memset(rs->buf + (size_t)s * rs->buf_size * rs->channel_count, 0,
+                rs->frames * rs->channel_count * sizeof(int16_t));
+    }
+    rs->pos = (uint64_t)(rs->taps - 1) << 32;
+    rs->rational_phase = 0;
+}
+
+size_t polyphase_resampler_bank_input_latency(
+        const struct polyphase_resampler_bank *rs)
+{
+    return rs->taps / 2;
+}
+
+int polyphase_resampler_bank_process(struct polyphase_resampler_bank *rs,
+        const int16_t *const *in, size_t *in_frames,
+        int16_t *const *out, size_t *out_frames)
+{
+    const uint32_t channels = rs->channel_count;
+    const uint32_t streams = rs->stream_count;
+    const uint32_t taps = rs->taps;
+    const size_t total = rs->frames + *in_frames;
+
+    if (total > rs->buf_size) {
+        int16_t *buf = (int16_t *)realloc(rs->buf,
+                (size_t)streams * total * channels * sizeof(int16_t));
+        if (buf == NULL) {
+            *out_frames = 0;
+            return -ENOMEM;
+        }
+        // spread the stream regions out to the new stride, last one first
+        // so a region is never overwritten before it has moved.
+        for (uint32_t s = streams; s-- > 1; ) {
+            memmove(buf + (size_t)s * total * channels,
+                    buf + (size_t)s * rs->buf_size * channels,
+                    rs->frames * channels * sizeof(int16_t));
+        }
+        rs->buf = buf;
+        rs->buf_size = total;
+    }
+    for (uint32_t s = 0; s < streams; ++s) {
+        memcpy(rs->buf + ((size_t)s * rs->buf_size + rs->frames) * channels,
+                in[s], *in_frames * channels * sizeof(int16_t));
+    }
+
+    size_t produced = 0;
+    uint64_t pos = rs->pos;
+    if (rs->rational_l != 0) {
+        const uint32_t l = rs->rational_l;
+        const uint32_t m = rs->rational_m;
+        uint32_t phase = rs->rational_phase;
+        while (produced < *out_frames && (size_t)(pos >> 32) < total) {
+            const size_t offset = ((size_t)(pos >> 32) - (taps - 1)) * channels;
+            const int16_t *c = rs->coefs + phase * taps;
+            for (uint32_t s = 0; s < streams; ++s) {
+                const int16_t *window =
+                        rs->buf + (size_t)s * rs->buf_size * channels + offset;
+                for (uint32_t ch = 0; ch < channels; ++ch) {
+                    const int32_t acc = dot(c, window + ch, taps, channels);
+                    out[s][produced * channels + ch] =
+                            clamp16((acc + (1 << 13)) >> 14);
+                }
+            }
+            ++produced;
+            phase += m;
+            pos += (uint64_t)(phase / l) << 32;
+            phase %= l;
+        }
+        rs->rational_phase = phase;
+    } else {
+        while (produced < *out_frames && (size_t)(pos >> 32) < total) {
+            const uint32_t frac = (uint32_t)pos;
+            const uint32_t phase = frac >> (32 - LOG_PHASES);
+            const int32_t mu = (frac >> (32 - LOG_PHASES - 15)) & 0x7FFF;
+            const size_t offset = ((size_t)(pos >> 32) - (taps - 1)) * channels;
+            const int16_t *c0 = rs->coefs + phase * taps;
+            const int16_t *c1 = c0 + taps;
+            for (uint32_t s = 0; s < streams; ++s) {
+                const int16_t *window =
+                        rs->buf + (size_t)s * rs->buf_size * channels + offset;
+                for (uint32_t ch = 0; ch < channels; ++ch) {
+                    const int32_t a = dot(c0, window + ch, taps, channels);
+                    const int32_t b = dot(c1, window + ch, taps, channels);
+                    const int32_t acc =
+                            a + (int32_t)(((int64_t)(b - a) * mu) >> 15);
+                    out[s][produced * channels + ch] =
+                            clamp16((acc + (1 << 13)) >> 14);
+                }
+            }
+            ++produced;
+            pos += rs->step;
+        }
+    }
+
+    // retain the window of the next output frame (at least taps - 1 frames)
+    size_t consumed = pos >> 32 > taps - 1 ? (size_t)(pos >> 32) - (taps - 1) : 0;
+    if (consumed > total - (taps - 1)) {
+        consumed = total - (taps - 1);
+    }
+    if (consumed > 0) {
+        for (uint32_t s = 0; s < streams; ++s) {
+            int16_t *region = rs->buf + (size_t)s * rs->buf_size * channels;
+            memmove(region, region + consumed * channels,
+                    (total - consumed) * channels * sizeof(int16_t));
+        }
+        pos -= (uint64_t)consumed << 32;
+    }
+    rs->frames = total - consumed;
+    rs->pos = pos;
+    *out_frames = produced;
+    return 0;
+}
@@ -20,6 +20,7 @@
 
 #include <algorithm>
 #include <math.h>
+#include <vector>
 
 #include <audio_utils/power.h>
 #include <audio_utils/primitives.h>
@@ -237,6 +238,58 @@ inline float energyMono<AUDIO_FORMAT_PCM_8_24_BIT>(const void *amplitudes, size_
 
 #endif // USE_NEON
 
+// Fused single-pass energy and peak with deinterleave, CHANNELS known at
+// compile time so the accumulators stay in registers and the compiler can
+// vectorize across frames.
+template <audio_format_t FORMAT, size_t CHANNELS>
+inline void energyPeakFixed(const void *amplitudes, size_t frames, float *energy, float *peak)
+{
+    float e[CHANNELS]{};
+    float p[CHANNELS]{};
+    for (size_t i = 0; i < frames; ++i) {
+        for (size_t c = 0; c < CHANNELS; ++c) {
+            const float amplitude = convertToFloatAndIncrement<FORMAT>(&amplitudes);
+            e[c] += amplitude * amplitude;
+            const float absAmplitude = fabsf(amplitude);
+            if (absAmplitude > p[c]) p[c] = absAmplitude;
+        }
+    }
+    for (size_t c = 0; c < CHANNELS; ++c) {
+        energy[c] = e[c];
+        if (peak != nullptr) peak[c] = p[c];
+    }
+}
+
+template <audio_format_t FORMAT>
+inline void energyPeak(const void *amplitudes, size_t frames, size_t channelCount,
+        float *energy, float *peak)
+{
+    switch (channelCount) {
+    case 1: return energyPeakFixed<FORMAT, 1>(amplitudes, frames, energy, peak);
+    case 2: return energyPeakFixed<FORMAT, 2>(amplitudes, frames, energy, peak);
+    case 4: return energyPeakFixed<FORMAT, 4>(amplitudes, frames, energy, peak);
+    case 6: return energyPeakFixed<FORMAT, 6>(amplitudes, frames, energy, peak);
+    case 8: return energyPeakFixed<FORMAT, 8>(amplitudes, frames, energy, peak);
+    default:
+        break;
+    }
+    // generic channel count, accumulate in the caller's arrays
+    for (size_t c = 0; c < channelCount; ++c) {
+        energy[c] = 0.f;
+        if (peak != nullptr) peak[c] = 0.f;
+    }
+    for (size_t i = 0; i < frames; ++i) {
+        for (size_t c = 0; c < channelCount; ++c) {
+            const float amplitude = convertToFloatAndIncrement<FORMAT>(&amplitudes);
+            energy[c] += amplitude * amplitude;
+            if (peak != nullptr) {
+                const float absAmplitude = fabsf(amplitude);
+                if (absAmplitude > peak[c]) peak[c] = absAmplitude;
+            }
+        }
+    }
+}
+
 } // namespace
 
 float audio_utils_compute_energy_mono(const void *buffer, audio_format_t format, size_t samples)
@@ -265,6 +318,35 @@ float audio_utils_compute_energy_mono(const void *buffer, audio_format_t format,
     }
 }
 
+void audio_utils_compute_energy_peak(const void *buffer, audio_format_t format,
+        size_t frames, size_t channelCount, float *energy, float *peak)
+{
+    LOG_ALWAYS_FATAL_IF(channelCount == 0 || energy == NULL);
+    switch (format) {
+    case AUDIO_FORMAT_PCM_8_BIT:
+        return energyPeak<AUDIO_FORMAT_PCM_8_BIT>(buffer, frames, channelCount, energy, peak);
+
+    case AUDIO_FORMAT_PCM_16_BIT:
+        return energyPeak<AUDIO_FORMAT_PCM_16_BIT>(buffer, frames, channelCount, energy, peak);
+
+    case AUDIO_FORMAT_PCM_24_BIT_PACKED:
+        return energyPeak<AUDIO_FORMAT_PCM_24_BIT_PACKED>(
+                buffer, frames, channelCount, energy, peak);
+
+    case AUDIO_FORMAT_PCM_8_24_BIT:
+        return energyPeak<AUDIO_FORMAT_PCM_8_24_BIT>(buffer, frames, channelCount, energy, peak);
+
+    case AUDIO_FORMAT_PCM_32_BIT:
+        return energyPeak<AUDIO_FORMAT_PCM_32_BIT>(buffer, frames, channelCount, energy, peak);
+
+    case AUDIO_FORMAT_PCM_FLOAT:
+        return energyPeak<AUDIO_FORMAT_PCM_FLOAT>(buffer, frames, channelCount, energy, peak);
+
+    default:
+        LOG_ALWAYS_FATAL("invalid format: %#x", format);
+    }
+}
+
 float audio_utils_compute_power_mono(const void *buffer, audio_format_t format, size_t samples)
 {
     return audio_utils_power_from_energy(
@@ -275,3 +357,162 @@ bool audio_utils_is_compute_power_format_supported(audio_format_t format)
 {
     return isFormatSupported(format);
 }
+
+namespace {
+
+/*
+ * K-weighting (ITU-R BS.1770): a high shelf modelling head diffraction
+ * followed by the RLB highpass.  The coefficients are tabulated in the
+ * recommendation at 48000 Hz; they are recomputed here from the underlying
+ * analog design so any sample rate matches the 48 kHz table.
+ *
+ * Both stages run in direct form 2 transposed with double state: the
+ * highpass pole is at 38 Hz, close enough to dc that float state loses
+ * precision at high sample rates.
+ */
+struct KWeightCoefficients {
+    // stage 1: high shelf (b, a); stage 2: highpass (1, -2, 1) / (1, d1, d2).
+    double b0, b1, b2, a1, a2;
+    double d1, d2;
+};
+
+KWeightCoefficients computeKWeightCoefficients(double sampleRate) {
+    KWeightCoefficients coef;
+    {
+        // high shelf, +4 dB above ~1.5 kHz.
+        constexpr double G = 3.999843853973347;   // dB
+        constexpr double f0 = 1681.974450955533;  // Hz
+        constexpr double Q = 0.7071752369554196;
+        const double K = tan(M_PI * f0 / sampleRate);
+        const double Vh = pow(10., G / 20.);
+        const double Vb = pow(Vh, 0.4996667741545416);
+        const double a0 = 1. + K / Q + K * K;
+        coef.b0 = (Vh + Vb * K / Q + K * K) / a0;
+        coef.b1 = 2. * (K * K - Vh) / a0;
+        coef.b2 = (Vh - Vb * K / Q + K * K) / a0;
+        coef.a1 = 2. * (K * K - 1.) / a0;
+        coef.a2 = (1. - K / Q + K * K) / a0;
+    }
+    {
+        // RLB highpass, unity gain in the passband.
+        constexpr double f0 = 38.13547087602444;  // Hz
+        constexpr double Q = 0.5003270373238773;
+        const double K = tan(M_PI * f0 / sampleRate);
+        const double a0 = 1. + K / Q + K * K;
+        coef.d1 = 2. * (K * K - 1.) / a0;
+        coef.d2 = (1. - K / Q + K * K) / a0;
+    }
+    return coef;
+}
+
+} // namespace
+
+struct audio_utils_kweight {
+    size_t channelCount;
+    KWeightCoefficients coef;
+    // 4 doubles per channel: shelf z1 z2, highpass z1 z2.
+    std::vector<double> state;
+};
+
+namespace {
+
+// Fixed channel count kernel: the per channel recursions are independent,
+// so with CHANNELS a compile time constant the channel loops vectorize
+// even though each biquad is recursive along time.
+template <size_t CHANNELS>
+void kweightEnergyFixed(audio_utils_kweight *kweight,
+        const float *buffer, size_t frames, float *energy)
+{
+    const KWeightCoefficients coef = kweight->coef;
+    double state[CHANNELS][4];
+    double e[CHANNELS]{};
+    for (size_t c = 0; c < CHANNELS; ++c) {
+        for (size_t j = 0; j < 4; ++j) {
+            state[c][j] = kweight->state[c * 4 + j];
+        }
+    }
+    for (size_t i = 0; i < frames; ++i) {
+        for (size_t c = 0; c < CHANNELS; ++c) {
+            const double x = buffer[c];
+            // shelf, direct form 2 transposed.
+            const double y = coef.b0 * x + state[c][0];
+            state[c][0] = coef.b1 * x - coef.a1 * y + state[c][1];
+            state[c][1] = coef.b2 * x - coef.a2 * y;
+            // highpass, numerator (1, -2, 1).
+            const double w = y + state[c][2];
+            state[c][2] = -2. * y - coef.d1 * w + state[c][3];
+            state[c][3] = y - coef.d2 * w;
+            e[c] += w * w;
+        }
+        buffer += CHANNELS;
+    }
+    for (size_t c = 0; c < CHANNELS; ++c) {
+        for (size_t j = 0; j < 4; ++j) {
+            kweight->state[c * 4 + j] = state[c][j];
+        }
+        energy[c] = e[c];
+    }
+}
+
+void kweightEnergy(audio_utils_kweight *kweight,
+        const float *buffer, size_t frames, float *energy)
+{
+    switch (kweight->channelCount) {
+    case 1: return kweightEnergyFixed<1>(kweight, buffer, frames, energy);
+    case 2: return kweightEnergyFixed<2>(kweight, buffer, frames, energy);
+    case 4: return kweightEnergyFixed<4>(kweight, buffer, frames, energy);
+    case 6: return kweightEnergyFixed<6>(kweight, buffer, frames, energy);
+    case 8: return kweightEnergyFixed<8>(kweight, buffer, frames, energy);
+    default:
+        break;
+    }
+    // generic channel count, state in place.
+    const KWeightCoefficients coef = kweight->coef;
+    const size_t channelCount = kweight->channelCount;
+    for (size_t c = 0; c < channelCount; ++c) {
+        energy[c] = 0.f;
+    }
+    for (size_t i = 0; i < frames; ++i) {
+        for (size_t c = 0; c < channelCount; ++c) {
+            double *state = &kweight->state[c * 4];
+            const double x = *buffer++;
+            const double y = coef.b0 * x + state[0];
+            state[0] = coef.b1 * x - coef.a1 * y + state[1];
+            state[1] = coef.b2 * x - coef.a2 * y;
+            const double w = y + state[2];
+            state[2] = -2. * y - coef.d1 * w + state[3];
+            state[3] = y - coef.d2 * w;
+            energy[c] += w * w;
+        }
+    }
+}
+
+} // namespace
+
+audio_utils_kweight_t *audio_utils_kweight_create(
+        uint32_t sample_rate, size_t channel_count)
+{
+    if (sample_rate == 0 || channel_count == 0) return nullptr;
+    audio_utils_kweight *kweight = new audio_utils_kweight;
+    kweight->channelCount = channel_count;
+    kweight->coef = computeKWeightCoefficients(sample_rate);
+    kweight->state.resize(channel_count * 4);
+    return kweight;
+}
+
+void audio_utils_kweight_free(audio_utils_kweight_t *kweight)
+{
+    delete kweight;
+}
+
+void audio_utils_kweight_reset(audio_utils_kweight_t *kweight)
+{
+    std::fill(kweight->state.begin(), kweight->state.end(), 0.);
+}
+
+void audio_utils_compute_energy_kweighted(audio_utils_kweight_t *kweight,
+        const float *buffer, size_t frames, float *energy)
+{
+    LOG_ALWAYS_FATAL_IF(kweight == NULL || energy == NULL);
+    kweightEnergy(kweight, buffer, frames, energy);
+}
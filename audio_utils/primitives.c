@@ -18,8 +18,587 @@
 #include <string.h>
 #include "private/private.h"
 
+/*
+ * Vectorized fast paths for the highest traffic sample conversions.
+ *
+ * NEON is part of the arm64 baseline so those kernels are selected at compile time.
+ * On x86 the SSE2 kernels are baseline and an AVX2 variant is chosen once at library
+ * load through __builtin_cpu_supports(), so the per-call cost is a single predictable
+ * branch.  Each kernel processes the largest multiple of its vector width and returns
+ * the number of frames consumed; the scalar loop below it finishes the remainder, and
+ * also serves as the reference implementation on other architectures.
+ *
+ * Kernels for conversions that expand the sample size run from the end of the buffer
+ * towards the front, like their scalar counterparts, to keep in-place use working.
+ */
+/* Destination sizes at or above this many bytes are written with non-temporal
+ * stores by the conversions that support them: such a buffer cannot stay
+ * resident anyway, and streaming it through the cache evicts the working set
+ * of concurrently running processing.  Half of a typical 4MB last level cache.
+ */
+#define AUDIO_UTILS_NT_STORE_THRESHOLD (2u << 20)
+
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_nontemporal_store)
+#define AUDIO_UTILS_HAS_NT_BUILTIN
+#endif
+#endif
+
+#if defined(__aarch64__)
+#define AUDIO_UTILS_USE_NEON
+#include <arm_neon.h>
+#elif defined(__i386__) || defined(__x86_64__)
+#define AUDIO_UTILS_USE_X86
+#include <immintrin.h>
+
+static int g_has_avx2; /* set once before the library is callable */
+static int g_has_f16c;
+
+__attribute__((constructor)) static void primitives_query_cpu(void)
+{
+    __builtin_cpu_init();
+    g_has_avx2 = __builtin_cpu_supports("avx2");
+    g_has_f16c = __builtin_cpu_supports("f16c");
+}
+#endif
+
+#ifdef AUDIO_UTILS_USE_NEON
+
+static size_t memcpy_to_i16_from_float_neon(int16_t *dst, const float *src, size_t count)
+{
+    const float32x4_t scale = vdupq_n_f32(1 << 15);
+    const size_t done = count & ~(size_t)7;
+    /* vcvtaq rounds to nearest, ties away from zero, matching roundf() in the
+     * scalar clamp16_from_float(); vqmovn provides the saturation.
+     */
+    for (size_t i = 0; i < done; i += 8) {
+        const int32x4_t i0 = vcvtaq_s32_f32(vmulq_f32(vld1q_f32(src + i), scale));
+        const int32x4_t i1 = vcvtaq_s32_f32(vmulq_f32(vld1q_f32(src + i + 4), scale));
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(i0), vqmovn_s32(i1)));
+    }
+    return done;
+}
+
+static size_t memcpy_to_float_from_i16_neon(float *dst, const int16_t *src, size_t count)
+{
+    const float32x4_t scale = vdupq_n_f32(1.f / (1 << 15));
+    const size_t done = count & ~(size_t)7;
+    for (size_t i = count; i > count - done; ) {
+        i -= 8;
+        const int16x8_t s = vld1q_s16(src + i);
+        vst1q_f32(dst + i,
+                vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(s))), scale));
+        vst1q_f32(dst + i + 4,
+                vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(s))), scale));
+    }
+    return done;
+}
+
+static size_t memcpy_to_float_from_f16_neon(float *dst, const uint16_t *src, size_t count)
+{
+    const size_t done = count & ~(size_t)7;
+    /* fcvtl is exact: every half value is representable in float */
+    for (size_t i = count; i > count - done; ) {
+        i -= 8;
+        const uint16x8_t h = vld1q_u16(src + i);
+        vst1q_f32(dst + i, vcvt_f32_f16(vreinterpret_f16_u16(vget_low_u16(h))));
+        vst1q_f32(dst + i + 4, vcvt_f32_f16(vreinterpret_f16_u16(vget_high_u16(h))));
+    }
+    return done;
+}
+
+static size_t memcpy_to_f16_from_float_neon(uint16_t *dst, const float *src, size_t count)
+{
+    const size_t done = count & ~(size_t)7;
+    /* fcvtn rounds to nearest, ties to even, matching f16_from_float() */
+    for (size_t i = 0; i < done; i += 8) {
+        const float16x4_t lo = vcvt_f16_f32(vld1q_f32(src + i));
+        const float16x4_t hi = vcvt_f16_f32(vld1q_f32(src + i + 4));
+        vst1q_u16(dst + i, vreinterpretq_u16_f16(vcombine_f16(lo, hi)));
+    }
+    return done;
+}
+
+static size_t memcpy_to_float_from_p24_neon(float *dst, const uint8_t *src, size_t count)
+{
+    const float32x4_t scale = vdupq_n_f32(1.f / (float)(1UL << 31));
+    const size_t done = count & ~(size_t)7;
+    for (size_t i = count; i > count - done; ) {
+        i -= 8;
+        /* deinterleave the 3 bytes of each sample, then assemble
+         * (c2 << 24) | (c1 << 16) | (c0 << 8) as in i32_from_p24().
+         */
+        const uint8x8x3_t p = vld3_u8(src + i * 3);
+        const uint16x8_t w21 = vorrq_u16(vshll_n_u8(p.val[2], 8), vmovl_u8(p.val[1]));
+        const uint16x8_t w0 = vmovl_u8(p.val[0]);
+        const int32x4_t lo = vreinterpretq_s32_u32(
+                vorrq_u32(vshll_n_u16(vget_low_u16(w21), 16),
+                          vshll_n_u16(vget_low_u16(w0), 8)));
+        const int32x4_t hi = vreinterpretq_s32_u32(
+                vorrq_u32(vshll_n_u16(vget_high_u16(w21), 16),
+                          vshll_n_u16(vget_high_u16(w0), 8)));
+        vst1q_f32(dst + i, vmulq_f32(vcvtq_f32_s32(lo), scale));
+        vst1q_f32(dst + i + 4, vmulq_f32(vcvtq_f32_s32(hi), scale));
+    }
+    return done;
+}
+
+static size_t memcpy_to_i16_from_q4_27_neon(int16_t *dst, const int32_t *src, size_t count)
+{
+    const size_t done = count & ~(size_t)7;
+    /* vqshrn is a saturating narrowing shift, i.e. clamp16(x >> 12) in one step */
+    for (size_t i = 0; i < done; i += 8) {
+        const int16x4_t lo = vqshrn_n_s32(vld1q_s32(src + i), 12);
+        const int16x4_t hi = vqshrn_n_s32(vld1q_s32(src + i + 4), 12);
+        vst1q_s16(dst + i, vcombine_s16(lo, hi));
+    }
+    return done;
+}
+
+#ifdef AUDIO_UTILS_HAS_NT_BUILTIN
+static size_t memcpy_to_i16_from_float_nt_neon(int16_t *dst, const float *src, size_t count)
+{
+    const float32x4_t scale = vdupq_n_f32(1 << 15);
+    const size_t done = count & ~(size_t)7;
+    /* same kernel as memcpy_to_i16_from_float_neon(), but the store bypasses
+     * the cache (STNP on arm64).
+     */
+    for (size_t i = 0; i < done; i += 8) {
+        const int32x4_t i0 = vcvtaq_s32_f32(vmulq_f32(vld1q_f32(src + i), scale));
+        const int32x4_t i1 = vcvtaq_s32_f32(vmulq_f32(vld1q_f32(src + i + 4), scale));
+        const int16x8_t v = vcombine_s16(vqmovn_s32(i0), vqmovn_s32(i1));
+        __builtin_nontemporal_store(v, (int16x8_t *)(dst + i));
+    }
+    return done;
+}
+#endif /* AUDIO_UTILS_HAS_NT_BUILTIN */
+
+static size_t memcpy_to_i16_from_ulaw_neon(int16_t *dst, const uint8_t *src, size_t count)
+{
+    const size_t done = count & ~(size_t)7;
+    for (size_t i = count; i > count - done; ) {
+        i -= 8;
+        /* the lane arithmetic mirrors i16_from_ulaw(); the biased magnitude
+         * fits 15 bits so all work is done in 16-bit lanes
+         */
+        const uint16x8_t w = vmovl_u8(vmvn_u8(vld1_u8(src + i)));
+        const int16x8_t exponent = vreinterpretq_s16_u16(
+                vandq_u16(vshrq_n_u16(w, 4), vdupq_n_u16(7)));
+        const uint16x8_t mant = vandq_u16(w, vdupq_n_u16(0x0f));
+        const uint16x8_t biased = vshlq_u16(
+                vaddq_u16(vshlq_n_u16(mant, 3), vdupq_n_u16(0x84)), exponent);
+        const int16x8_t mag = vreinterpretq_s16_u16(vsubq_u16(biased, vdupq_n_u16(0x84)));
+        /* conditionally negate via (x ^ m) - m with m all ones on negative lanes */
+        const int16x8_t neg = vshrq_n_s16(
+                vreinterpretq_s16_u16(vshlq_n_u16(w, 8)), 15);
+        vst1q_s16(dst + i, vsubq_s16(veorq_s16(mag, neg), neg));
+    }
+    return done;
+}
+
+static size_t memcpy_to_i16_from_alaw_neon(int16_t *dst, const uint8_t *src, size_t count)
+{
+    const size_t done = count & ~(size_t)7;
+    for (size_t i = count; i > count - done; ) {
+        i -= 8;
+        /* the lane arithmetic mirrors i16_from_alaw() */
+        const uint16x8_t w = vmovl_u8(veor_u8(vld1_u8(src + i), vdup_n_u8(0x55)));
+        const uint16x8_t exponent = vandq_u16(vshrq_n_u16(w, 4), vdupq_n_u16(7));
+        const uint16x8_t t = vaddq_u16(
+                vshlq_n_u16(vandq_u16(w, vdupq_n_u16(0x0f)), 4), vdupq_n_u16(8));
+        /* exponent-1 is negative for exponent 0 and would shift right, but
+         * those lanes are replaced by the unshifted value below
+         */
+        const uint16x8_t shifted = vshlq_u16(vaddq_u16(t, vdupq_n_u16(0x100)),
+                vsubq_s16(vreinterpretq_s16_u16(exponent), vdupq_n_s16(1)));
+        const int16x8_t mag = vreinterpretq_s16_u16(
+                vbslq_u16(vcgtq_u16(exponent, vdupq_n_u16(0)), shifted, t));
+        /* A-law stores the sign inverted: bit 7 set (after ^0x55) is positive */
+        const int16x8_t neg = vreinterpretq_s16_u16(
+                vceqq_u16(vandq_u16(w, vdupq_n_u16(0x80)), vdupq_n_u16(0)));
+        vst1q_s16(dst + i, vsubq_s16(veorq_s16(mag, neg), neg));
+    }
+    return done;
+}
+
+#endif /* AUDIO_UTILS_USE_NEON */
+
+#ifdef AUDIO_UTILS_USE_X86
+
+/* Round to nearest, ties away from zero, independent of the MXCSR rounding mode.
+ * _mm_cvtps_epi32 follows MXCSR, which fesetround() changes on x86, so it cannot
+ * be used directly: a caller running under directed rounding would get shifted
+ * samples.  Adding the signed half in float does not work either: x + 0.5f is
+ * inexact when the sum crosses into a coarser binade (e.g. 0.5f - 0x1p-25f),
+ * so it both consults the rounding mode and double-rounds away from roundf().
+ * Instead widen to double, where x plus a signed 0.5 is exact for the clamped
+ * magnitudes here (<= 2^15, far inside the 53-bit significand), and finish with
+ * the truncating conversion (always toward zero).  This matches the roundf()
+ * behavior of the scalar clamp16_from_float() bit for bit.
+ */
+static inline __m128i mm_cvtps_epi32_away(__m128 x)
+{
+    const __m128d signbit = _mm_set1_pd(-0.);
+    const __m128d half = _mm_set1_pd(0.5);
+    const __m128d lo = _mm_cvtps_pd(x);
+    const __m128d hi = _mm_cvtps_pd(_mm_movehl_ps(x, x));
+    const __m128i lotrunc = _mm_cvttpd_epi32(
+            _mm_add_pd(lo, _mm_or_pd(half, _mm_and_pd(lo, signbit))));
+    const __m128i hitrunc = _mm_cvttpd_epi32(
+            _mm_add_pd(hi, _mm_or_pd(half, _mm_and_pd(hi, signbit))));
+    return _mm_unpacklo_epi64(lotrunc, hitrunc);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i mm256_cvtps_epi32_away(__m256 x)
+{
+    const __m256d signbit = _mm256_set1_pd(-0.);
+    const __m256d half = _mm256_set1_pd(0.5);
+    const __m256d lo = _mm256_cvtps_pd(_mm256_castps256_ps128(x));
+    const __m256d hi = _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1));
+    const __m128i lotrunc = _mm256_cvttpd_epi32(
+            _mm256_add_pd(lo, _mm256_or_pd(half, _mm256_and_pd(lo, signbit))));
+    const __m128i hitrunc = _mm256_cvttpd_epi32(
+            _mm256_add_pd(hi, _mm256_or_pd(half, _mm256_and_pd(hi, signbit))));
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(lotrunc), hitrunc, 1);
+}
+
+static size_t memcpy_to_i16_from_float_sse2(int16_t *dst, const float *src, size_t count)
+{
+    const __m128 scale = _mm_set1_ps(1 << 15);
+    const __m128 maxval = _mm_set1_ps((1 << 15) - 1);
+    const __m128 minval = _mm_set1_ps(-(1 << 15));
+    const size_t done = count & ~(size_t)7;
+    for (size_t i = 0; i < done; i += 8) {
+        __m128 f0 = _mm_mul_ps(_mm_loadu_ps(src + i), scale);
+        __m128 f1 = _mm_mul_ps(_mm_loadu_ps(src + i + 4), scale);
+        f0 = _mm_max_ps(minval, _mm_min_ps(maxval, f0));
+        f1 = _mm_max_ps(minval, _mm_min_ps(maxval, f1));
+        _mm_storeu_si128((__m128i *)(dst + i),
+                _mm_packs_epi32(mm_cvtps_epi32_away(f0), mm_cvtps_epi32_away(f1)));
+    }
+    return done;
+}
+
+__attribute__((target("avx2")))
+static size_t memcpy_to_i16_from_float_avx2(int16_t *dst, const float *src, size_t count)
+{
+    const __m256 scale = _mm256_set1_ps(1 << 15);
+    const __m256 maxval = _mm256_set1_ps((1 << 15) - 1);
+    const __m256 minval = _mm256_set1_ps(-(1 << 15));
+    const size_t done = count & ~(size_t)15;
+    for (size_t i = 0; i < done; i += 16) {
+        __m256 f0 = _mm256_mul_ps(_mm256_loadu_ps(src + i), scale);
+        __m256 f1 = _mm256_mul_ps(_mm256_loadu_ps(src + i + 8), scale);
+        f0 = _mm256_max_ps(minval, _mm256_min_ps(maxval, f0));
+        f1 = _mm256_max_ps(minval, _mm256_min_ps(maxval, f1));
+        /* packs interleaves the 128-bit lanes; permute restores sample order */
+        const __m256i p = _mm256_permute4x64_epi64(
+                _mm256_packs_epi32(mm256_cvtps_epi32_away(f0), mm256_cvtps_epi32_away(f1)),
+                _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i *)(dst + i), p);
+    }
+    return done;
+}
+
+static size_t memcpy_to_float_from_i16_sse2(float *dst, const int16_t *src, size_t count)
+{
+    const __m128 scale = _mm_set1_ps(1.f / (1 << 15));
+    const __m128i zero = _mm_setzero_si128();
+    const size_t done = count & ~(size_t)7;
+    for (size_t i = count; i > count - done; ) {
+        i -= 8;
+        const __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+        /* unpack into the high 16 bits of each lane, then arithmetic shift
+         * right to sign extend.
+         */
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(zero, s), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(zero, s), 16);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    return done;
+}
+
+__attribute__((target("avx2")))
+static size_t memcpy_to_float_from_i16_avx2(float *dst, const int16_t *src, size_t count)
+{
+    const __m256 scale = _mm256_set1_ps(1.f / (1 << 15));
+    const size_t done = count & ~(size_t)7;
+    for (size_t i = count; i > count - done; ) {
+        i -= 8;
+        const __m256i s = _mm256_cvtepi16_epi32(
+                _mm_loadu_si128((const __m128i *)(src + i)));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(s), scale));
+    }
+    return done;
+}
+
+__attribute__((target("f16c")))
+static size_t memcpy_to_float_from_f16_f16c(float *dst, const uint16_t *src, size_t count)
+{
+    const size_t done = count & ~(size_t)7;
+    /* vcvtph2ps is exact: every half value is representable in float */
+    for (size_t i = count; i > count - done; ) {
+        i -= 8;
+        _mm256_storeu_ps(dst + i,
+                _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(src + i))));
+    }
+    return done;
+}
+
+__attribute__((target("f16c")))
+static size_t memcpy_to_f16_from_float_f16c(uint16_t *dst, const float *src, size_t count)
+{
+    const size_t done = count & ~(size_t)7;
+    /* round to nearest, ties to even, matching f16_from_float() */
+    for (size_t i = 0; i < done; i += 8) {
+        _mm_storeu_si128((__m128i *)(dst + i),
+                _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+    }
+    return done;
+}
+
+static size_t memcpy_to_i16_from_q4_27_sse2(int16_t *dst, const int32_t *src, size_t count)
+{
+    const size_t done = count & ~(size_t)7;
+    /* arithmetic shift keeps the q4.27 headroom bits; packs saturates to 16 bit */
+    for (size_t i = 0; i < done; i += 8) {
+        const __m128i lo = _mm_srai_epi32(
+                _mm_loadu_si128((const __m128i *)(src + i)), 12);
+        const __m128i hi = _mm_srai_epi32(
+                _mm_loadu_si128((const __m128i *)(src + i + 4)), 12);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(lo, hi));
+    }
+    return done;
+}
+
+__attribute__((target("avx2")))
+static size_t memcpy_to_i16_from_q4_27_avx2(int16_t *dst, const int32_t *src, size_t count)
+{
+    const size_t done = count & ~(size_t)15;
+    for (size_t i = 0; i < done; i += 16) {
+        const __m256i lo = _mm256_srai_epi32(
+                _mm256_loadu_si256((const __m256i *)(src + i)), 12);
+        const __m256i hi = _mm256_srai_epi32(
+                _mm256_loadu_si256((const __m256i *)(src + i + 8)), 12);
+        /* packs interleaves the 128-bit lanes; permute restores sample order */
+        const __m256i p = _mm256_permute4x64_epi64(
+                _mm256_packs_epi32(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i *)(dst + i), p);
+    }
+    return done;
+}
+
+/* The streaming-store kernels require an aligned destination (16 bytes for
+ * SSE2, 32 for AVX2); the wrapper aligns with scalar conversions first.
+ * The trailing sfence orders the weakly ordered streaming stores before any
+ * subsequent signaling that the buffer is ready.
+ */
+static size_t memcpy_to_i16_from_float_nt_sse2(int16_t *dst, const float *src, size_t count)
+{
+    const __m128 scale = _mm_set1_ps(1 << 15);
+    const __m128 maxval = _mm_set1_ps((1 << 15) - 1);
+    const __m128 minval = _mm_set1_ps(-(1 << 15));
+    const size_t done = count & ~(size_t)7;
+    for (size_t i = 0; i < done; i += 8) {
+        __m128 f0 = _mm_mul_ps(_mm_loadu_ps(src + i), scale);
+        __m128 f1 = _mm_mul_ps(_mm_loadu_ps(src + i + 4), scale);
+        f0 = _mm_max_ps(minval, _mm_min_ps(maxval, f0));
+        f1 = _mm_max_ps(minval, _mm_min_ps(maxval, f1));
+        _mm_stream_si128((__m128i *)(dst + i),
+                _mm_packs_epi32(mm_cvtps_epi32_away(f0), mm_cvtps_epi32_away(f1)));
+    }
+    _mm_sfence();
+    return done;
+}
+
+__attribute__((target("avx2")))
+static size_t memcpy_to_i16_from_float_nt_avx2(int16_t *dst, const float *src, size_t count)
+{
+    const __m256 scale = _mm256_set1_ps(1 << 15);
+    const __m256 maxval = _mm256_set1_ps((1 << 15) - 1);
+    const __m256 minval = _mm256_set1_ps(-(1 << 15));
+    const size_t done = count & ~(size_t)15;
+    for (size_t i = 0; i < done; i += 16) {
+        __m256 f0 = _mm256_mul_ps(_mm256_loadu_ps(src + i), scale);
+        __m256 f1 = _mm256_mul_ps(_mm256_loadu_ps(src + i + 8), scale);
+        f0 = _mm256_max_ps(minval, _mm256_min_ps(maxval, f0));
+        f1 = _mm256_max_ps(minval, _mm256_min_ps(maxval, f1));
+        /* packs interleaves the 128-bit lanes; permute restores sample order */
+        const __m256i p = _mm256_permute4x64_epi64(
+                _mm256_packs_epi32(mm256_cvtps_epi32_away(f0), mm256_cvtps_epi32_away(f1)),
+                _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_stream_si256((__m256i *)(dst + i), p);
+    }
+    _mm_sfence();
+    return done;
+}
+
+/* SSE2 has no per-lane variable shift, so the G.711 decoders scale the biased
+ * magnitude with a three-stage barrel shifter: conditionally shift by 1, 2 and
+ * 4 according to the exponent bits.
+ */
+static inline __m128i mm_sllv_epi16_barrel(__m128i t, __m128i exponent)
+{
+    for (int k = 1; k <= 4; k <<= 1) {
+        const __m128i bit = _mm_set1_epi16((short)k);
+        const __m128i m = _mm_cmpeq_epi16(_mm_and_si128(exponent, bit), bit);
+        t = _mm_or_si128(_mm_and_si128(m, _mm_slli_epi16(t, k)),
+                _mm_andnot_si128(m, t));
+        if (k == 4) break;  /* the exponent is at most 7 */
+    }
+    return t;
+}
+
+static size_t memcpy_to_i16_from_ulaw_sse2(int16_t *dst, const uint8_t *src, size_t count)
+{
+    const size_t done = count & ~(size_t)7;
+    for (size_t i = count; i > count - done; ) {
+        i -= 8;
+        /* the lane arithmetic mirrors i16_from_ulaw(); the biased magnitude
+         * fits 15 bits so all work is done in 16-bit lanes
+         */
+        const __m128i w = _mm_xor_si128(
+                _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(src + i)),
+                        _mm_setzero_si128()),
+                _mm_set1_epi16(0x00ff));
+        const __m128i exponent = _mm_and_si128(_mm_srli_epi16(w, 4), _mm_set1_epi16(7));
+        const __m128i mant = _mm_and_si128(w, _mm_set1_epi16(0x0f));
+        const __m128i biased = mm_sllv_epi16_barrel(
+                _mm_add_epi16(_mm_slli_epi16(mant, 3), _mm_set1_epi16(0x84)), exponent);
+        const __m128i mag = _mm_sub_epi16(biased, _mm_set1_epi16(0x84));
+        /* conditionally negate via (x ^ m) - m with m all ones on negative lanes */
+        const __m128i neg = _mm_srai_epi16(_mm_slli_epi16(w, 8), 15);
+        _mm_storeu_si128((__m128i *)(dst + i),
+                _mm_sub_epi16(_mm_xor_si128(mag, neg), neg));
+    }
+    return done;
+}
+
+__attribute__((target("avx2")))
+static size_t memcpy_to_i16_from_ulaw_avx2(int16_t *dst, const uint8_t *src, size_t count)
+{
+    const size_t done = count & ~(size_t)15;
+    for (size_t i = count; i > count - done; ) {
+        i -= 16;
+        const __m256i w = _mm256_xor_si256(
+                _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(src + i))),
+                _mm256_set1_epi16(0x00ff));
+        const __m256i exponent = _mm256_and_si256(_mm256_srli_epi16(w, 4),
+                _mm256_set1_epi16(7));
+        const __m256i mant = _mm256_and_si256(w, _mm256_set1_epi16(0x0f));
+        /* AVX2 lacks a 16-bit variable shift as well, but 2^exponent fits a
+         * 16-bit lane, so scale with a multiply by a barrel-shifted one
+         */
+        __m256i factor = _mm256_set1_epi16(1);
+        for (int k = 1; k <= 4; k <<= 1) {
+            const __m256i bit = _mm256_set1_epi16((short)k);
+            const __m256i m = _mm256_cmpeq_epi16(_mm256_and_si256(exponent, bit), bit);
+            factor = _mm256_or_si256(
+                    _mm256_and_si256(m, _mm256_slli_epi16(factor, k)),
+                    _mm256_andnot_si256(m, factor));
+        }
+        const __m256i biased = _mm256_mullo_epi16(
+                _mm256_add_epi16(_mm256_slli_epi16(mant, 3), _mm256_set1_epi16(0x84)),
+                factor);
+        const __m256i mag = _mm256_sub_epi16(biased, _mm256_set1_epi16(0x84));
+        const __m256i neg = _mm256_srai_epi16(_mm256_slli_epi16(w, 8), 15);
+        _mm256_storeu_si256((__m256i *)(dst + i),
+                _mm256_sub_epi16(_mm256_xor_si256(mag, neg), neg));
+    }
+    return done;
+}
+
+static size_t memcpy_to_i16_from_alaw_sse2(int16_t *dst, const uint8_t *src, size_t count)
+{
+    const size_t done = count & ~(size_t)7;
+    for (size_t i = count; i > count - done; ) {
+        i -= 8;
+        /* the lane arithmetic mirrors i16_from_alaw() */
+        const __m128i w = _mm_xor_si128(
+                _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(src + i)),
+                        _mm_setzero_si128()),
+                _mm_set1_epi16(0x0055));
+        const __m128i exponent = _mm_and_si128(_mm_srli_epi16(w, 4), _mm_set1_epi16(7));
+        const __m128i t = _mm_add_epi16(
+                _mm_slli_epi16(_mm_and_si128(w, _mm_set1_epi16(0x0f)), 4),
+                _mm_set1_epi16(8));
+        /* (t + 0x100) << (exponent - 1), computed as a shift by exponent
+         * followed by a halving to keep the barrel shifter non-negative;
+         * exponent-0 lanes are replaced by the unshifted value
+         */
+        const __m128i shifted = _mm_srli_epi16(
+                mm_sllv_epi16_barrel(_mm_add_epi16(t, _mm_set1_epi16(0x100)), exponent), 1);
+        const __m128i expzero = _mm_cmpeq_epi16(exponent, _mm_setzero_si128());
+        const __m128i mag = _mm_or_si128(_mm_and_si128(expzero, t),
+                _mm_andnot_si128(expzero, shifted));
+        /* A-law stores the sign inverted: bit 7 set (after ^0x55) is positive */
+        const __m128i neg = _mm_cmpeq_epi16(_mm_and_si128(w, _mm_set1_epi16(0x80)),
+                _mm_setzero_si128());
+        _mm_storeu_si128((__m128i *)(dst + i),
+                _mm_sub_epi16(_mm_xor_si128(mag, neg), neg));
+    }
+    return done;
+}
+
+__attribute__((target("avx2")))
+static size_t memcpy_to_i16_from_alaw_avx2(int16_t *dst, const uint8_t *src, size_t count)
+{
+    const size_t done = count & ~(size_t)15;
+    for (size_t i = count; i > count - done; ) {
+        i -= 16;
+        const __m256i w = _mm256_xor_si256(
+                _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(src + i))),
+                _mm256_set1_epi16(0x0055));
+        const __m256i exponent = _mm256_and_si256(_mm256_srli_epi16(w, 4),
+                _mm256_set1_epi16(7));
+        const __m256i t = _mm256_add_epi16(
+                _mm256_slli_epi16(_mm256_and_si256(w, _mm256_set1_epi16(0x0f)), 4),
+                _mm256_set1_epi16(8));
+        __m256i factor = _mm256_set1_epi16(1);
+        for (int k = 1; k <= 4; k <<= 1) {
+            const __m256i bit = _mm256_set1_epi16((short)k);
+            const __m256i m = _mm256_cmpeq_epi16(_mm256_and_si256(exponent, bit), bit);
+            factor = _mm256_or_si256(
+                    _mm256_and_si256(m, _mm256_slli_epi16(factor, k)),
+                    _mm256_andnot_si256(m, factor));
+        }
+        const __m256i shifted = _mm256_srli_epi16(_mm256_mullo_epi16(
+                _mm256_add_epi16(t, _mm256_set1_epi16(0x100)), factor), 1);
+        const __m256i expzero = _mm256_cmpeq_epi16(exponent, _mm256_setzero_si256());
+        const __m256i mag = _mm256_or_si256(_mm256_and_si256(expzero, t),
+                _mm256_andnot_si256(expzero, shifted));
+        const __m256i neg = _mm256_cmpeq_epi16(_mm256_and_si256(w, _mm256_set1_epi16(0x80)),
+                _mm256_setzero_si256());
+        _mm256_storeu_si256((__m256i *)(dst + i),
+                _mm256_sub_epi16(_mm256_xor_si256(mag, neg), neg));
+    }
+    return done;
+}
+
+#endif /* AUDIO_UTILS_USE_X86 */
+
 void ditherAndClamp(int32_t *out, const int32_t *sums, size_t pairs)
 {
+    /* The name predates the removal of dither from the mixer; all that is left
+     * is the q4.27 to 16-bit narrowing.  On a little-endian target the packed
+     * (r << 16) | l output words are byte-identical to the interleaved int16
+     * stream, so the q4.27 kernels apply directly to the sample pairs.
+     */
+#if defined(AUDIO_UTILS_USE_NEON) && !HAVE_BIG_ENDIAN
+    const size_t done = memcpy_to_i16_from_q4_27_neon((int16_t *)out, sums, pairs << 1);
+    out += done >> 1;
+    sums += done;
+    pairs -= done >> 1;
+#elif defined(AUDIO_UTILS_USE_X86) && !HAVE_BIG_ENDIAN
+    const size_t done = g_has_avx2
+            ? memcpy_to_i16_from_q4_27_avx2((int16_t *)out, sums, pairs << 1)
+            : memcpy_to_i16_from_q4_27_sse2((int16_t *)out, sums, pairs << 1);
+    out += done >> 1;
+    sums += done;
+    pairs -= done >> 1;
+#endif
     for (; pairs > 0; --pairs) {
         const int32_t l = clamp16(*sums++ >> 12);
         const int32_t r = clamp16(*sums++ >> 12);
@@ -27,8 +606,79 @@ void ditherAndClamp(int32_t *out, const int32_t *sums, size_t pairs)
     }
 }
 
+void audio_utils_dither_init(struct audio_utils_dither_state *state, uint32_t channels)
+{
+    if (channels < 1) {
+        channels = 1;
+    } else if (channels > AUDIO_UTILS_DITHER_MAX_CHANNELS) {
+        channels = AUDIO_UTILS_DITHER_MAX_CHANNELS;
+    }
+    state->lcg = 0x5851f42d;  /* arbitrary seed; this LCG cycles through all 32-bit states */
+    state->channels = channels;
+    memset(state->error1, 0, sizeof(state->error1));
+    memset(state->error2, 0, sizeof(state->error2));
+}
+
+void memcpy_to_i16_from_float_dithered(int16_t *dst, const float *src, size_t frames,
+        struct audio_utils_dither_state *state)
+{
+    const uint32_t channels = state->channels;
+    uint32_t r = state->lcg;
+    for (; frames > 0; --frames) {
+        for (uint32_t c = 0; c < channels; ++c) {
+            /* TPDF dither of +-1 lsb peak: the difference of the two uniform
+             * 16-bit halves of one Numerical Recipes LCG draw per sample.
+             */
+            r = r * 1664525u + 1013904223u;
+            const float dither =
+                    (float)(int32_t)((r & 0xffff) - (r >> 16)) * (1.f / 65536);
+            /* Error feedback through (1 - z^-1)^2: the quantization noise is
+             * shaped away from the low frequencies where it is audible on
+             * quiet material.  The feedback includes the dither, so the
+             * dither noise is shaped as well.
+             */
+            const float v = *src++ * 32768.f
+                    + 2.f * state->error1[c] - state->error2[c];
+            float y = roundf(v + dither);
+            if (y > 32767.f) {
+                y = 32767.f;
+            } else if (y < -32768.f) {
+                y = -32768.f;
+            }
+            float e = v - y;
+            /* Clamping above breaks the feedback equation, and a sustained
+             * out-of-range input would wind the error up without bound;
+             * normal operation keeps |e| below 1.5 lsb, so this cap is
+             * inactive until clipping and then bounds the recovery transient.
+             */
+            if (e > 2.f) {
+                e = 2.f;
+            } else if (e < -2.f) {
+                e = -2.f;
+            }
+            state->error2[c] = state->error1[c];
+            state->error1[c] = e;
+            *dst++ = (int16_t)y;
+        }
+    }
+    state->lcg = r;
+}
+
 void memcpy_to_i16_from_q4_27(int16_t *dst, const int32_t *src, size_t count)
 {
+#if defined(AUDIO_UTILS_USE_NEON)
+    const size_t done = memcpy_to_i16_from_q4_27_neon(dst, src, count);
+    dst += done;
+    src += done;
+    count -= done;
+#elif defined(AUDIO_UTILS_USE_X86)
+    const size_t done = g_has_avx2
+            ? memcpy_to_i16_from_q4_27_avx2(dst, src, count)
+            : memcpy_to_i16_from_q4_27_sse2(dst, src, count);
+    dst += done;
+    src += done;
+    count -= done;
+#endif
     for (; count > 0; --count) {
         *dst++ = clamp16(*src++ >> 12);
     }
@@ -83,6 +733,84 @@ void memcpy_to_u8_from_float(uint8_t *dst, const float *src, size_t count)
     }
 }
 
+void memcpy_to_i16_from_ulaw(int16_t *dst, const uint8_t *src, size_t count)
+{
+#if defined(AUDIO_UTILS_USE_NEON)
+    count -= memcpy_to_i16_from_ulaw_neon(dst, src, count);
+#elif defined(AUDIO_UTILS_USE_X86)
+    count -= g_has_avx2
+            ? memcpy_to_i16_from_ulaw_avx2(dst, src, count)
+            : memcpy_to_i16_from_ulaw_sse2(dst, src, count);
+#endif
+    dst += count;
+    src += count;
+    for (; count > 0; --count) {
+        *--dst = i16_from_ulaw(*--src);
+    }
+}
+
+void memcpy_to_ulaw_from_i16(uint8_t *dst, const int16_t *src, size_t count)
+{
+    for (; count > 0; --count) {
+        *dst++ = ulaw_from_i16(*src++);
+    }
+}
+
+void memcpy_to_float_from_ulaw(float *dst, const uint8_t *src, size_t count)
+{
+    dst += count;
+    src += count;
+    for (; count > 0; --count) {
+        *--dst = float_from_i16(i16_from_ulaw(*--src));
+    }
+}
+
+void memcpy_to_ulaw_from_float(uint8_t *dst, const float *src, size_t count)
+{
+    for (; count > 0; --count) {
+        *dst++ = ulaw_from_i16(clamp16_from_float(*src++));
+    }
+}
+
+void memcpy_to_i16_from_alaw(int16_t *dst, const uint8_t *src, size_t count)
+{
+#if defined(AUDIO_UTILS_USE_NEON)
+    count -= memcpy_to_i16_from_alaw_neon(dst, src, count);
+#elif defined(AUDIO_UTILS_USE_X86)
+    count -= g_has_avx2
+            ? memcpy_to_i16_from_alaw_avx2(dst, src, count)
+            : memcpy_to_i16_from_alaw_sse2(dst, src, count);
+#endif
+    dst += count;
+    src += count;
+    for (; count > 0; --count) {
+        *--dst = i16_from_alaw(*--src);
+    }
+}
+
+void memcpy_to_alaw_from_i16(uint8_t *dst, const int16_t *src, size_t count)
+{
+    for (; count > 0; --count) {
+        *dst++ = alaw_from_i16(*src++);
+    }
+}
+
+void memcpy_to_float_from_alaw(float *dst, const uint8_t *src, size_t count)
+{
+    dst += count;
+    src += count;
+    for (; count > 0; --count) {
+        *--dst = float_from_i16(i16_from_alaw(*--src));
+    }
+}
+
+void memcpy_to_alaw_from_float(uint8_t *dst, const float *src, size_t count)
+{
+    for (; count > 0; --count) {
+        *dst++ = alaw_from_i16(clamp16_from_float(*src++));
+    }
+}
+
 void memcpy_to_i16_from_i32(int16_t *dst, const int32_t *src, size_t count)
 {
     for (; count > 0; --count) {
@@ -90,8 +818,55 @@ void memcpy_to_i16_from_i32(int16_t *dst, const int32_t *src, size_t count)
     }
 }
 
+void memcpy_to_i16_from_float_nt(int16_t *dst, const float *src, size_t count)
+{
+#if defined(AUDIO_UTILS_USE_NEON) && defined(AUDIO_UTILS_HAS_NT_BUILTIN)
+    /* arm64 streaming stores have no alignment requirement */
+    const size_t done = memcpy_to_i16_from_float_nt_neon(dst, src, count);
+    dst += done;
+    src += done;
+    count -= done;
+#elif defined(AUDIO_UTILS_USE_X86)
+    /* convert scalar until the destination is 32-byte aligned, satisfying both
+     * the SSE2 (16 byte) and AVX2 (32 byte) streaming store requirements.
+     */
+    while (count > 0 && ((uintptr_t)dst & 31) != 0) {
+        *dst++ = clamp16_from_float(*src++);
+        --count;
+    }
+    const size_t done = g_has_avx2
+            ? memcpy_to_i16_from_float_nt_avx2(dst, src, count)
+            : memcpy_to_i16_from_float_nt_sse2(dst, src, count);
+    dst += done;
+    src += done;
+    count -= done;
+#endif
+    /* no non-temporal path on this architecture, or trailing remainder */
+    for (; count > 0; --count) {
+        *dst++ = clamp16_from_float(*src++);
+    }
+}
+
 void memcpy_to_i16_from_float(int16_t *dst, const float *src, size_t count)
 {
+    if (count * sizeof(*dst) >= AUDIO_UTILS_NT_STORE_THRESHOLD) {
+        /* too large to stay cache resident; don't evict everything else */
+        memcpy_to_i16_from_float_nt(dst, src, count);
+        return;
+    }
+#if defined(AUDIO_UTILS_USE_NEON)
+    const size_t done = memcpy_to_i16_from_float_neon(dst, src, count);
+    dst += done;
+    src += done;
+    count -= done;
+#elif defined(AUDIO_UTILS_USE_X86)
+    const size_t done = g_has_avx2
+            ? memcpy_to_i16_from_float_avx2(dst, src, count)
+            : memcpy_to_i16_from_float_sse2(dst, src, count);
+    dst += done;
+    src += done;
+    count -= done;
+#endif
     for (; count > 0; --count) {
         *dst++ = clamp16_from_float(*src++);
     }
@@ -106,6 +881,13 @@ void memcpy_to_float_from_q4_27(float *dst, const int32_t *src, size_t count)
 
 void memcpy_to_float_from_i16(float *dst, const int16_t *src, size_t count)
 {
+#if defined(AUDIO_UTILS_USE_NEON)
+    count -= memcpy_to_float_from_i16_neon(dst, src, count);
+#elif defined(AUDIO_UTILS_USE_X86)
+    count -= g_has_avx2
+            ? memcpy_to_float_from_i16_avx2(dst, src, count)
+            : memcpy_to_float_from_i16_sse2(dst, src, count);
+#endif
     dst += count;
     src += count;
     for (; count > 0; --count) {
@@ -113,6 +895,56 @@ void memcpy_to_float_from_i16(float *dst, const int16_t *src, size_t count)
     }
 }
 
+void memcpy_to_float_from_f16(float *dst, const uint16_t *src, size_t count)
+{
+#if defined(AUDIO_UTILS_USE_NEON)
+    count -= memcpy_to_float_from_f16_neon(dst, src, count);
+#elif defined(AUDIO_UTILS_USE_X86)
+    if (g_has_f16c) {
+        count -= memcpy_to_float_from_f16_f16c(dst, src, count);
+    }
+#endif
+    dst += count;
+    src += count;
+    for (; count > 0; --count) {
+        *--dst = float_from_f16(*--src);
+    }
+}
+
+void memcpy_to_f16_from_float(uint16_t *dst, const float *src, size_t count)
+{
+#if defined(AUDIO_UTILS_USE_NEON)
+    const size_t done = memcpy_to_f16_from_float_neon(dst, src, count);
+    dst += done;
+    src += done;
+    count -= done;
+#elif defined(AUDIO_UTILS_USE_X86)
+    if (g_has_f16c) {
+        const size_t done = memcpy_to_f16_from_float_f16c(dst, src, count);
+        dst += done;
+        src += done;
+        count -= done;
+    }
+#endif
+    for (; count > 0; --count) {
+        *dst++ = f16_from_float(*src++);
+    }
+}
+
+void memcpy_to_i16_from_f16(int16_t *dst, const uint16_t *src, size_t count)
+{
+    for (; count > 0; --count) {
+        *dst++ = clamp16_from_float(float_from_f16(*src++));
+    }
+}
+
+void memcpy_to_f16_from_i16(uint16_t *dst, const int16_t *src, size_t count)
+{
+    for (; count > 0; --count) {
+        *dst++ = f16_from_float(float_from_i16(*src++));
+    }
+}
+
 void memcpy_to_float_from_u8(float *dst, const uint8_t *src, size_t count)
 {
     dst += count;
@@ -124,6 +956,9 @@ void memcpy_to_float_from_u8(float *dst, const uint8_t *src, size_t count)
 
 void memcpy_to_float_from_p24(float *dst, const uint8_t *src, size_t count)
 {
+#if defined(AUDIO_UTILS_USE_NEON) && !HAVE_BIG_ENDIAN
+    count -= memcpy_to_float_from_p24_neon(dst, src, count);
+#endif
     dst += count;
     src += count * 3;
     for (; count > 0; --count) {
@@ -590,7 +1425,7 @@ size_t memcpy_by_index_array_initialization_dst_index(int8_t *idxary, size_t idx
 
 void accumulate_i16(int16_t *dst, const int16_t *src, size_t count) {
     while (count--) {
-        *dst = clamp16((int32_t)*dst + *src++);
+        *dst = clamp16_add(*dst, *src++);
         ++dst;
     }
 }
@@ -632,7 +1467,7 @@ void accumulate_q8_23(int32_t *dst, const int32_t *src, size_t count) {
 
 void accumulate_i32(int32_t *dst, const int32_t *src, size_t count) {
     for (; count > 0; --count) {
-        *dst = clamp32((int64_t)*dst + *src++);
+        *dst = clamp32_add(*dst, *src++);
         ++dst;
     }
 }
@@ -642,3 +1477,110 @@ void accumulate_float(float *dst, const float *src, size_t count) {
         *dst++ += *src++;
     }
 }
+
+/* The accumulate-with-gain loops below have no cross-element dependencies,
+ * so the compiler auto-vectorizes them without needing explicit intrinsics.
+ */
+
+void accumulate_float_from_i16_with_gain(float *dst, const int16_t *src, size_t count,
+        float gain)
+{
+    for (; count > 0; --count) {
+        *dst++ += float_from_i16(*src++) * gain;
+    }
+}
+
+void accumulate_float_from_p24_with_gain(float *dst, const uint8_t *src, size_t count,
+        float gain)
+{
+    for (; count > 0; --count) {
+        *dst++ += float_from_p24(src) * gain;
+        src += 3;
+    }
+}
+
+void accumulate_float_from_float_with_gain(float *dst, const float *src, size_t count,
+        float gain)
+{
+    for (; count > 0; --count) {
+        *dst++ += *src++ * gain;
+    }
+}
+
+void accumulate_float_from_i16_with_channel_gains(float *dst, const int16_t *src,
+        size_t frames, size_t channelCount, const float *gains)
+{
+    switch (channelCount) {
+    case 1:
+        accumulate_float_from_i16_with_gain(dst, src, frames, gains[0]);
+        return;
+    case 2: {
+        const float gain0 = gains[0];
+        const float gain1 = gains[1];
+        for (; frames > 0; --frames) {
+            *dst++ += float_from_i16(*src++) * gain0;
+            *dst++ += float_from_i16(*src++) * gain1;
+        }
+    } return;
+    default:
+        for (; frames > 0; --frames) {
+            for (size_t i = 0; i < channelCount; ++i) {
+                *dst++ += float_from_i16(*src++) * gains[i];
+            }
+        }
+        return;
+    }
+}
+
+void accumulate_float_from_p24_with_channel_gains(float *dst, const uint8_t *src,
+        size_t frames, size_t channelCount, const float *gains)
+{
+    switch (channelCount) {
+    case 1:
+        accumulate_float_from_p24_with_gain(dst, src, frames, gains[0]);
+        return;
+    case 2: {
+        const float gain0 = gains[0];
+        const float gain1 = gains[1];
+        for (; frames > 0; --frames) {
+            *dst++ += float_from_p24(src) * gain0;
+            src += 3;
+            *dst++ += float_from_p24(src) * gain1;
+            src += 3;
+        }
+    } return;
+    default:
+        for (; frames > 0; --frames) {
+            for (size_t i = 0; i < channelCount; ++i) {
+                *dst++ += float_from_p24(src) * gains[i];
+                src += 3;
+            }
+        }
+        return;
+    }
+}
+
+void accumulate_float_from_float_with_channel_gains(float *dst, const float *src,
+        size_t frames, size_t channelCount, const float *gains)
+{
+    switch (channelCount) {
+    case 1:
+        accumulate_float_from_float_with_gain(dst, src, frames, gains[0]);
+        return;
+    case 2: {
+        const float gain0 = gains[0];
+        const float gain1 = gains[1];
+        for (; frames > 0; --frames) {
+            *dst++ += *src++ * gain0;
+            *dst++ += *src++ * gain1;
+        }
+    } return;
+    default:
+        for (; frames > 0; --frames) {
+            for (size_t i = 0; i < channelCount; ++i) {
+                *dst++ += *src++ * gains[i];
+            }
+        }
+        return;
+    }
+}
@@ -23,28 +23,40 @@
 #include <log/log.h>
 
 #include <system/audio.h>
+#include <audio_utils/PerfCounters.h>
+#include <audio_utils/format.h>
+#include <audio_utils/polyphase_resampler.h>
 #include <audio_utils/resampler.h>
 #include <speex/speex_resampler.h>
 
 struct resampler {
     struct resampler_itfe itfe;
     SpeexResamplerState *speex_resampler;       // handle on speex resampler
+    struct polyphase_resampler *polyphase;      // in-tree engine, exclusive with speex
     struct resampler_buffer_provider *provider; // buffer provider installed by client
     uint32_t in_sample_rate;                    // input sampling rate in Hz
     uint32_t out_sample_rate;                   // output sampling rate in Hz
     uint32_t channel_count;                     // number of channels (interleaved)
+    audio_format_t in_format;                   // sample format of source frames
+    audio_format_t out_format;                  // sample format of destination frames
+    audio_format_converter_t convert_in;        // in_format to int16_t, fused into the
+                                                // copy staging frames into in_buf
+    audio_format_converter_t convert_out;       // int16_t to out_format
     int16_t *in_buf;                            // input buffer
     size_t in_buf_size;                         // input buffer size
+    int16_t *out_buf;                           // scratch for output conversion, only when
+                                                // out_format is narrower than int16_t
+    size_t out_buf_size;                        // scratch size in frames
     size_t frames_in;                           // number of frames in input buffer
     size_t frames_rq;                           // cached number of output frames
     size_t frames_needed;                       // minimum number of input frames to produce
                                                 // frames_rq output frames
-    int32_t speex_delay_ns;                     // delay introduced by speex resampler in ns
+    int32_t filter_delay_ns;                    // delay introduced by the engine in ns
 };
 
 
 //------------------------------------------------------------------------------
-// speex based resampler
+// speex or polyphase based resampler
 //------------------------------------------------------------------------------
 
 static void resampler_reset(struct resampler_itfe *resampler)
@@ -57,6 +69,76 @@ static void resampler_reset(struct resampler_itfe *resampler)
     if (rsmp != NULL && rsmp->speex_resampler != NULL) {
         speex_resampler_reset_mem(rsmp->speex_resampler);
     }
+    if (rsmp != NULL && rsmp->polyphase != NULL) {
+        polyphase_resampler_reset(rsmp->polyphase);
+    }
+}
+
+// runs the selected engine over interleaved int16_t frames with speex
+// consume/produce semantics; the polyphase engine always consumes all input.
+static void resampler_process(struct resampler *rsmp,
+                              const int16_t *in,
+                              spx_uint32_t *inFrames,
+                              int16_t *out,
+                              spx_uint32_t *outFrames)
+{
+    if (rsmp->polyphase != NULL) {
+        size_t inCount = *inFrames;
+        size_t outCount = *outFrames;
+        polyphase_resampler_process(rsmp->polyphase, in, &inCount, out, &outCount);
+        *inFrames = inCount;
+        *outFrames = outCount;
+    } else if (rsmp->channel_count == 1) {
+        speex_resampler_process_int(rsmp->speex_resampler,
+                                    0,
+                                    in,
+                                    inFrames,
+                                    out,
+                                    outFrames);
+    } else {
+        speex_resampler_process_interleaved_int(rsmp->speex_resampler,
+                                                in,
+                                                inFrames,
+                                                out,
+                                                outFrames);
+    }
+    audio_utils_perf_counter_add(AUDIO_UTILS_PERF_COUNTER_RESAMPLER_FRAMES, *outFrames);
+}
+
+static int resampler_ensure_in_buf(struct resampler *rsmp, size_t frames)
+{
+    if (rsmp->in_buf_size < frames) {
+        int16_t *buf = (int16_t *)realloc(rsmp->in_buf,
+                frames * rsmp->channel_count * sizeof(int16_t));
+        if (buf == NULL) {
+            return -ENOMEM;
+        }
+        rsmp->in_buf = buf;
+        rsmp->in_buf_size = frames;
+    }
+    return 0;
+}
+
+// Returns the int16_t buffer the engine should produce outFrames frames into for a
+// caller buffer in out_format: the caller's buffer itself when each destination
+// sample is at least as wide as int16_t (the output conversion then widens in
+// place, back to front), or internal scratch otherwise.
+// Returns NULL if the scratch buffer could not grow.
+static int16_t *resampler_out_i16_buf(struct resampler *rsmp, void *out, size_t outFrames)
+{
+    if (audio_bytes_per_sample(rsmp->out_format) >= sizeof(int16_t)) {
+        return (int16_t *)out;
+    }
+    if (rsmp->out_buf_size < outFrames) {
+        int16_t *buf = (int16_t *)realloc(rsmp->out_buf,
+                outFrames * rsmp->channel_count * sizeof(int16_t));
+        if (buf == NULL) {
+            return NULL;
+        }
+        rsmp->out_buf = buf;
+        rsmp->out_buf_size = outFrames;
+    }
+    return rsmp->out_buf;
 }
 
 static int32_t resampler_delay_ns(struct resampler_itfe *resampler)
@@ -64,7 +146,7 @@ static int32_t resampler_delay_ns(struct resampler_itfe *resampler)
     struct resampler *rsmp = (struct resampler *)resampler;
 
     int32_t delay = (int32_t)((1000000000 * (int64_t)rsmp->frames_in) / rsmp->in_sample_rate);
-    delay += rsmp->speex_delay_ns;
+    delay += rsmp->filter_delay_ns;
 
     return delay;
 }
@@ -100,10 +182,8 @@ int resampler_resample_from_provider(struct resampler_itfe *resampler,
             // make sure that the number of frames present in rsmp->in_buf (rsmp->frames_in) is at
             // least the number of frames needed to produce the number of frames requested at
             // the output sampling rate
-            if (rsmp->in_buf_size < rsmp->frames_needed) {
-                rsmp->in_buf_size = rsmp->frames_needed;
-                rsmp->in_buf = (int16_t *)realloc(rsmp->in_buf,
-                                        rsmp->in_buf_size * rsmp->channel_count * sizeof(int16_t));
+            if (resampler_ensure_in_buf(rsmp, rsmp->frames_needed) != 0) {
+                break;
             }
             struct resampler_buffer buf;
             buf.frame_count = rsmp->frames_needed - rsmp->frames_in;
@@ -111,29 +191,22 @@ int resampler_resample_from_provider(struct resampler_itfe *resampler,
             if (buf.raw == NULL) {
                 break;
             }
-            memcpy(rsmp->in_buf + rsmp->frames_in * rsmp->channel_count,
+            // converts from in_format in the copy that staged frames anyway,
+            // so non-int16_t sources cost no extra pass or buffer
+            rsmp->convert_in(rsmp->in_buf + rsmp->frames_in * rsmp->channel_count,
                     buf.raw,
-                    buf.frame_count * rsmp->channel_count * sizeof(int16_t));
+                    buf.frame_count * rsmp->channel_count);
             rsmp->frames_in += buf.frame_count;
             rsmp->provider->release_buffer(rsmp->provider, &buf);
         }
 
         spx_uint32_t outFrames = framesRq - framesWr;
         inFrames = rsmp->frames_in;
-        if (rsmp->channel_count == 1) {
-            speex_resampler_process_int(rsmp->speex_resampler,
-                                        0,
-                                        rsmp->in_buf,
-                                        &inFrames,
-                                        out + framesWr,
-                                        &outFrames);
-        } else {
-            speex_resampler_process_interleaved_int(rsmp->speex_resampler,
-                                        rsmp->in_buf,
-                                        &inFrames,
-                                        out + framesWr * rsmp->channel_count,
-                                        &outFrames);
-        }
+        resampler_process(rsmp,
+                          rsmp->in_buf,
+                          &inFrames,
+                          out + framesWr * rsmp->channel_count,
+                          &outFrames);
         framesWr += outFrames;
         rsmp->frames_in -= inFrames;
         ALOGW_IF((framesWr != framesRq) && (rsmp->frames_in != 0),
@@ -167,38 +240,117 @@ int resampler_resample_from_input(struct resampler_itfe *resampler,
         return -ENOSYS;
     }
 
-    if (rsmp->channel_count == 1) {
-        speex_resampler_process_int(rsmp->speex_resampler,
-                                    0,
-                                    in,
-                                    (spx_uint32_t *)inFrameCount,
-                                    out,
-                                    (spx_uint32_t *)outFrameCount);
+    spx_uint32_t inFrames = *inFrameCount;
+    spx_uint32_t outFrames = *outFrameCount;
+    resampler_process(rsmp, in, &inFrames, out, &outFrames);
+    *inFrameCount = inFrames;
+    *outFrameCount = outFrames;
+
+    ALOGV("resampler_resample_from_input() DONE in %zu out %zu", *inFrameCount, *outFrameCount);
+
+    return 0;
+}
+
+static int resampler_resample_from_input_by_format(struct resampler_itfe *resampler,
+                                                   const void *in,
+                                                   size_t *inFrameCount,
+                                                   void *out,
+                                                   size_t *outFrameCount)
+{
+    struct resampler *rsmp = (struct resampler *)resampler;
+
+    if (rsmp == NULL || in == NULL || inFrameCount == NULL ||
+            out == NULL || outFrameCount == NULL) {
+        return -EINVAL;
+    }
+    if (rsmp->provider != NULL) {
+        *outFrameCount = 0;
+        return -ENOSYS;
+    }
+
+    const int16_t *i16_in;
+    if (rsmp->in_format == AUDIO_FORMAT_PCM_16_BIT) {
+        i16_in = (const int16_t *)in;
     } else {
-        speex_resampler_process_interleaved_int(rsmp->speex_resampler,
-                                                in,
-                                                (spx_uint32_t *)inFrameCount,
-                                                out,
-                                                (spx_uint32_t *)outFrameCount);
+        // in_buf is only used in provider mode, so it is free as staging here
+        if (resampler_ensure_in_buf(rsmp, *inFrameCount) != 0) {
+            *outFrameCount = 0;
+            return -ENOMEM;
+        }
+        rsmp->convert_in(rsmp->in_buf, in, *inFrameCount * rsmp->channel_count);
+        i16_in = rsmp->in_buf;
+    }
+    int16_t *i16_out = resampler_out_i16_buf(rsmp, out, *outFrameCount);
+    if (i16_out == NULL) {
+        *outFrameCount = 0;
+        return -ENOMEM;
     }
 
-    ALOGV("resampler_resample_from_input() DONE in %zu out %zu", *inFrameCount, *outFrameCount);
+    spx_uint32_t inFrames = *inFrameCount;
+    spx_uint32_t outFrames = *outFrameCount;
+    resampler_process(rsmp, i16_in, &inFrames, i16_out, &outFrames);
+    if (rsmp->out_format != AUDIO_FORMAT_PCM_16_BIT) {
+        rsmp->convert_out(out, i16_out, outFrames * rsmp->channel_count);
+    }
+    *inFrameCount = inFrames;
+    *outFrameCount = outFrames;
 
     return 0;
 }
 
+static int resampler_resample_from_provider_by_format(struct resampler_itfe *resampler,
+                                                      void *out,
+                                                      size_t *outFrameCount)
+{
+    struct resampler *rsmp = (struct resampler *)resampler;
+
+    if (rsmp == NULL || out == NULL || outFrameCount == NULL) {
+        return -EINVAL;
+    }
+
+    int16_t *i16_out = resampler_out_i16_buf(rsmp, out, *outFrameCount);
+    if (i16_out == NULL) {
+        *outFrameCount = 0;
+        return -ENOMEM;
+    }
+    int status = resampler_resample_from_provider(resampler, i16_out, outFrameCount);
+    if (status == 0 && rsmp->out_format != AUDIO_FORMAT_PCM_16_BIT) {
+        rsmp->convert_out(out, i16_out, *outFrameCount * rsmp->channel_count);
+    }
+    return status;
+}
+
 int create_resampler(uint32_t inSampleRate,
                     uint32_t outSampleRate,
                     uint32_t channelCount,
                     uint32_t quality,
                     struct resampler_buffer_provider* provider,
                     struct resampler_itfe **resampler)
+{
+    return create_resampler_for_formats(inSampleRate,
+                                        outSampleRate,
+                                        channelCount,
+                                        quality,
+                                        AUDIO_FORMAT_PCM_16_BIT,
+                                        AUDIO_FORMAT_PCM_16_BIT,
+                                        provider,
+                                        resampler);
+}
+
+int create_resampler_for_formats(uint32_t inSampleRate,
+                    uint32_t outSampleRate,
+                    uint32_t channelCount,
+                    uint32_t quality,
+                    audio_format_t inFormat,
+                    audio_format_t outFormat,
+                    struct resampler_buffer_provider* provider,
+                    struct resampler_itfe **resampler)
 {
     int error;
     struct resampler *rsmp;
 
-    ALOGV("create_resampler() In SR %d Out SR %d channels %d",
-         inSampleRate, outSampleRate, channelCount);
+    ALOGV("create_resampler_for_formats() In SR %d Out SR %d channels %d formats %#x/%#x",
+         inSampleRate, outSampleRate, channelCount, inFormat, outFormat);
 
     if (resampler == NULL) {
         return -EINVAL;
@@ -206,44 +358,82 @@ int create_resampler(uint32_t inSampleRate,
 
     *resampler = NULL;
 
-    if (quality <= RESAMPLER_QUALITY_MIN || quality >= RESAMPLER_QUALITY_MAX) {
+    if (quality <= RESAMPLER_QUALITY_MIN || quality > RESAMPLER_QUALITY_POLYPHASE) {
+        return -EINVAL;
+    }
+
+    // the engine runs on int16_t, conversion is fused at its buffer boundaries
+    audio_format_converter_t convert_in =
+            audio_format_get_converter(AUDIO_FORMAT_PCM_16_BIT, inFormat);
+    audio_format_converter_t convert_out =
+            audio_format_get_converter(outFormat, AUDIO_FORMAT_PCM_16_BIT);
+    if (convert_in == NULL || convert_out == NULL) {
+        ALOGW("ReSampler: unsupported format conversion %#x/%#x", inFormat, outFormat);
         return -EINVAL;
     }
 
     rsmp = (struct resampler *)calloc(1, sizeof(struct resampler));
 
-    rsmp->speex_resampler = speex_resampler_init(channelCount,
-                                      inSampleRate,
-                                      outSampleRate,
-                                      quality,
-                                      &error);
-    if (rsmp->speex_resampler == NULL) {
-        ALOGW("ReSampler: Cannot create speex resampler: %s", speex_resampler_strerror(error));
-        free(rsmp);
-        return -ENODEV;
+    if (quality == RESAMPLER_QUALITY_POLYPHASE) {
+        rsmp->polyphase = polyphase_resampler_create(inSampleRate,
+                                          outSampleRate,
+                                          channelCount);
+        if (rsmp->polyphase == NULL) {
+            ALOGW("ReSampler: Cannot create polyphase resampler");
+            free(rsmp);
+            return -ENODEV;
+        }
+    } else {
+        rsmp->speex_resampler = speex_resampler_init(channelCount,
+                                          inSampleRate,
+                                          outSampleRate,
+                                          quality,
+                                          &error);
+        if (rsmp->speex_resampler == NULL) {
+            ALOGW("ReSampler: Cannot create speex resampler: %s",
+                  speex_resampler_strerror(error));
+            free(rsmp);
+            return -ENODEV;
+        }
     }
 
     rsmp->itfe.reset = resampler_reset;
     rsmp->itfe.resample_from_provider = resampler_resample_from_provider;
     rsmp->itfe.resample_from_input = resampler_resample_from_input;
     rsmp->itfe.delay_ns = resampler_delay_ns;
+    rsmp->itfe.resample_from_input_by_format = resampler_resample_from_input_by_format;
+    rsmp->itfe.resample_from_provider_by_format = resampler_resample_from_provider_by_format;
 
     rsmp->provider = provider;
     rsmp->in_sample_rate = inSampleRate;
     rsmp->out_sample_rate = outSampleRate;
     rsmp->channel_count = channelCount;
+    rsmp->in_format = inFormat;
+    rsmp->out_format = outFormat;
+    rsmp->convert_in = convert_in;
+    rsmp->convert_out = convert_out;
     rsmp->in_buf = NULL;
     rsmp->in_buf_size = 0;
+    rsmp->out_buf = NULL;
+    rsmp->out_buf_size = 0;
 
     resampler_reset(&rsmp->itfe);
 
-    int frames = speex_resampler_get_input_latency(rsmp->speex_resampler);
-    rsmp->speex_delay_ns = (int32_t)((1000000000 * (int64_t)frames) / rsmp->in_sample_rate);
-    frames = speex_resampler_get_output_latency(rsmp->speex_resampler);
-    rsmp->speex_delay_ns += (int32_t)((1000000000 * (int64_t)frames) / rsmp->out_sample_rate);
+    if (rsmp->polyphase != NULL) {
+        int frames = polyphase_resampler_input_latency(rsmp->polyphase);
+        rsmp->filter_delay_ns =
+                (int32_t)((1000000000 * (int64_t)frames) / rsmp->in_sample_rate);
+    } else {
+        int frames = speex_resampler_get_input_latency(rsmp->speex_resampler);
+        rsmp->filter_delay_ns =
+                (int32_t)((1000000000 * (int64_t)frames) / rsmp->in_sample_rate);
+        frames = speex_resampler_get_output_latency(rsmp->speex_resampler);
+        rsmp->filter_delay_ns +=
+                (int32_t)((1000000000 * (int64_t)frames) / rsmp->out_sample_rate);
+    }
 
     *resampler = &rsmp->itfe;
-    ALOGV("create_resampler() DONE rsmp %p &rsmp->itfe %p speex %p",
+    ALOGV("create_resampler_for_formats() DONE rsmp %p &rsmp->itfe %p speex %p",
          rsmp, &rsmp->itfe, rsmp->speex_resampler);
     return 0;
 }
@@ -257,9 +447,11 @@ void release_resampler(struct resampler_itfe *resampler)
     }
 
     free(rsmp->in_buf);
+    free(rsmp->out_buf);
 
     if (rsmp->speex_resampler != NULL) {
         speex_resampler_destroy(rsmp->speex_resampler);
     }
+    polyphase_resampler_destroy(rsmp->polyphase);
     free(rsmp);
 }
@@ -15,6 +15,8 @@
  */
 
 #include <math.h>
+#include <stdint.h>
+#include <audio_utils/primitives.h>
 #include <audio_utils/sample.h>
 
 #define SAMPLE_NEG_MAX  0xFFFF
@@ -81,3 +83,97 @@ float float_from_sample(sample_minifloat_t a)
             exponent - EXCESS);
     return a & SIGN_MASK ? -f : f;
 }
+
+/* Branch-light equivalents of the scalar converters for the buffer loops
+ * below: the significand and the scale 2^(exponent - 19) are exact in single
+ * precision, so the product equals the ldexpf() form bit for bit, and the
+ * float decomposition reads the IEEE fields directly instead of calling
+ * frexpf().  Kept in step with sample_from_float()/float_from_sample() and
+ * verified exhaustively against them.
+ */
+
+static inline float float_from_sample_inline(sample_minifloat_t a)
+{
+    static const float scale[EXPONENT_MAX + 1] = {
+        0x1p-19f, 0x1p-18f, 0x1p-17f, 0x1p-16f,
+        0x1p-15f, 0x1p-14f, 0x1p-13f, 0x1p-12f,
+    };
+    const int mantissa = a & MANTISSA_MAX;
+    const int exponent = (a >> MANTISSA_BITS) & EXPONENT_MAX;
+    const float f = (float)(exponent > 0 ? HIDDEN_BIT | mantissa : mantissa << 1)
+            * scale[exponent];
+    return a & SIGN_MASK ? -f : f;
+}
+
+static inline sample_minifloat_t sample_from_float_inline(float v)
+{
+    union {
+        float f;
+        uint32_t i;
+    } u;
+    u.f = v;
+    const uint32_t bits = u.i;
+    const sample_minifloat_t sign = (bits >> 16) & SIGN_MASK;
+    const uint32_t exponent32 = (bits >> 23) & 0xFF;
+    if (exponent32 == 0xFF && (bits & 0x7FFFFF) != 0) {
+        return 0;       // NaN
+    }
+    // frexpf() exponent of a normal float, plus EXCESS
+    const int exp = (int)exponent32 - 126 + EXCESS;
+    if (exp > EXPONENT_MAX) {
+        return SAMPLE_POS_MAX | sign;       // |v| >= 2.0f, including infinity
+    }
+    if (-exp >= MANTISSA_BITS) {
+        return 0;       // zeroes, IEEE denormals and other underflow
+    }
+    // (int)(frexpf() fraction * ONE_FLOAT): truncation is a plain shift
+    const int mantissa = (int)((UINT32_C(0x800000) | (bits & 0x7FFFFF)) >> 11);
+    const sample_minifloat_t ret = exp > 0 ?
+            (exp << MANTISSA_BITS) | (mantissa & ~HIDDEN_BIT) :
+            (mantissa >> (1 - exp)) & MANTISSA_MAX;
+    return ret | sign;
+}
+
+void memcpy_to_float_from_sample(float *dst, const sample_minifloat_t *src, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = float_from_sample_inline(src[i]);
+    }
+}
+
+void memcpy_to_sample_from_float(sample_minifloat_t *dst, const float *src, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = sample_from_float_inline(src[i]);
+    }
+}
+
+void memcpy_to_i16_from_sample(int16_t *dst, const sample_minifloat_t *src, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = clamp16_from_float(float_from_sample_inline(src[i]));
+    }
+}
+
+void memcpy_to_sample_from_i16(sample_minifloat_t *dst, const int16_t *src, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = sample_from_float_inline(src[i] * (1.0f / 32768.0f));
+    }
+}
+
+void memcpy_to_float_from_sample_with_gain(float *dst, const sample_minifloat_t *src,
+        size_t count, float gain)
+{
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = gain * float_from_sample_inline(src[i]);
+    }
+}
+
+void accumulate_float_from_sample_with_gain(float *dst, const sample_minifloat_t *src,
+        size_t count, float gain)
+{
+    for (size_t i = 0; i < count; i++) {
+        dst[i] += gain * float_from_sample_inline(src[i]);
+    }
+}
@@ -263,4 +263,15 @@ bool AC3FrameScanner::parseHeader()
     return true;
 }
 
+// A repeated header parses to the fields already in place, but the EAC3
+// burst bookkeeping must still advance for every frame.
+void AC3FrameScanner::onHeaderRepeated()
+{
+    if ((mDataType == SPDIF_DATA_TYPE_E_AC3)
+            && ((mStreamType == AC3_STREAM_TYPE_0)
+                    || (mStreamType == AC3_STREAM_TYPE_2))) {
+        mSubstreamBlockCounts[mSubstreamID] += mAudioBlocksPerSyncFrame;
+    }
+}
+
 }  // namespace android
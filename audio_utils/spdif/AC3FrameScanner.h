@@ -74,6 +74,7 @@ protected:
     static const uint16_t kEAC3BlocksPerFrameTable[EAC3_NUM_BLOCKS_PER_FRAME_TABLE_ENTRIES];
 
     virtual bool parseHeader();
+    virtual void onHeaderRepeated();
 };
 
 }  // namespace android
@@ -25,9 +25,9 @@
 
 namespace android {
 
-BitFieldParser::BitFieldParser(uint8_t *data)
+BitFieldParser::BitFieldParser(const uint8_t *data, size_t size)
  : mData(data)
- , mBitCursor(0)
+ , mSize(size)
 {
 }
 
@@ -35,27 +35,51 @@ BitFieldParser::~BitFieldParser()
 {
 }
 
-uint32_t BitFieldParser::readBits(uint32_t numBits)
+void BitFieldParser::refill()
+{
+    // Load whole bytes below the bits still queued; bytes past the end of
+    // the data are left as zero.
+    while (mBitsInReservoir <= 64 - 8 && mByteCursor < mSize) {
+        mReservoir |= (uint64_t)mData[mByteCursor++] << (64 - 8 - mBitsInReservoir);
+        mBitsInReservoir += 8;
+    }
+}
+
+uint32_t BitFieldParser::peekBits(uint32_t numBits)
 {
     ALOG_ASSERT(numBits <= 32);
+    if (numBits == 0) {
+        return 0;
+    }
+    if (mBitsInReservoir < numBits) {
+        refill();
+    }
+    return (uint32_t)(mReservoir >> (64 - numBits));
+}
 
-    // Extract some bits from the current byte.
-    uint32_t byteCursor = mBitCursor >> 3; // 8 bits per byte
-    uint8_t byte = mData[byteCursor];
-
-    uint32_t bitsLeftInByte = 8 - (mBitCursor & 7);
-    uint32_t bitsFromByte = (bitsLeftInByte < numBits) ? bitsLeftInByte : numBits;
-    uint32_t result = byte >> (bitsLeftInByte - bitsFromByte);
-    result &= (1 << bitsFromByte) - 1; // mask
-    mBitCursor += bitsFromByte;
-
-    uint32_t bitsRemaining = numBits - bitsFromByte;
-    if (bitsRemaining == 0) {
-        return result;
-    } else {
-        // Use recursion to get remaining bits.
-        return (result << bitsRemaining) | readBits(bitsRemaining);
+void BitFieldParser::skipBits(uint32_t numBits)
+{
+    mBitCursor += numBits;
+    while (numBits > 0) {
+        if (mBitsInReservoir == 0) {
+            refill();
+            if (mBitsInReservoir == 0) {
+                break; // past the end of the data
+            }
+        }
+        const uint32_t chunk = (numBits < mBitsInReservoir) ? numBits : mBitsInReservoir;
+        // a large skip can drop a full reservoir; shifting by 64 is undefined
+        mReservoir = (chunk >= 64) ? 0 : (mReservoir << chunk);
+        mBitsInReservoir -= chunk;
+        numBits -= chunk;
     }
 }
 
+uint32_t BitFieldParser::readBits(uint32_t numBits)
+{
+    const uint32_t result = peekBits(numBits);
+    skipBits(numBits);
+    return result;
+}
+
 }  // namespace android
@@ -17,27 +17,45 @@
 #ifndef ANDROID_AUDIO_BIT_FIELD_PARSER_H
 #define ANDROID_AUDIO_BIT_FIELD_PARSER_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 namespace android {
 
 /**
  * Extract bit fields from a byte array.
+ *
+ * The parser keeps a 64-bit reservoir of upcoming bits so that each
+ * extraction is a shift and a mask instead of a walk over the bytes;
+ * the reservoir is refilled from the data array when it runs low.
+ * Bits past the end of the array read as zero, so a malformed header
+ * cannot cause a read out of bounds.
  */
 class BitFieldParser {
 public:
 
-    explicit BitFieldParser(uint8_t *data);
+    BitFieldParser(const uint8_t *data, size_t size);
     virtual ~BitFieldParser();
 
     /**
      * Read numBits bits from the data array.
      * Fields may span byte boundaries but may not exceed 32-bits.
-     * Note that the caller must ensure that there is suffcient data.
      * Assume data is organized as BigEndian format.
      */
     uint32_t readBits(uint32_t numBits);
 
+    /**
+     * Return the next numBits bits without consuming them.
+     * Same restrictions as readBits().
+     */
+    uint32_t peekBits(uint32_t numBits);
+
+    /**
+     * Advance the cursor over numBits bits without extracting a value.
+     * May skip more than 32 bits.
+     */
+    void skipBits(uint32_t numBits);
+
     /*
      * When the cursor is zero it points to a position right before
      * the most significant bit.
@@ -47,8 +65,15 @@ public:
     uint32_t getBitCursor() const { return mBitCursor; }
 
 private:
-    uint8_t *mData;
-    uint32_t mBitCursor;
+    // Top up the reservoir from the data array.
+    void refill();
+
+    const uint8_t *mData;
+    size_t mSize;                  // valid bytes at mData
+    size_t mByteCursor = 0;        // next byte to load into the reservoir
+    uint64_t mReservoir = 0;       // upcoming bits, aligned to the MSB
+    uint32_t mBitsInReservoir = 0; // valid bits at the top of mReservoir
+    uint32_t mBitCursor = 0;       // bits consumed so far
 };
 
 
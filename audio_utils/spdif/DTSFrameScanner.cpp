@@ -77,7 +77,7 @@ DTSFrameScanner::~DTSFrameScanner()
 // @return true if valid
 bool DTSFrameScanner::parseHeader()
 {
-    BitFieldParser parser(&mHeaderBuffer[mSyncLength]);
+    BitFieldParser parser(&mHeaderBuffer[mSyncLength], mHeaderLength - mSyncLength);
 
     // These variables are named after the fields in the DTS spec 5.3.1
     // Extract field in order.
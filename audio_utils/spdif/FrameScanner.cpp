@@ -33,6 +33,7 @@ FrameScanner::FrameScanner(int dataType,
  , mSyncLength(syncLength)
  , mHeaderLength(headerLength)
  , mCursor(0)
+ , mHeaderCacheValid(false)
  , mFormatDumpCount(0)
  , mSampleRate(0)
  , mRateMultiplier(1)
@@ -65,9 +66,18 @@ bool FrameScanner::scan(uint8_t byte)
         // gather header for parsing
         mHeaderBuffer[mCursor++] = byte;
         if (mCursor >= mHeaderLength) {
-            if (parseHeader()) {
+            // Stable-bitrate streams repeat the same header for minutes;
+            // skip the bit field extraction when it has not changed.
+            if (mHeaderCacheValid
+                    && memcmp(mHeaderBuffer, mPreviousHeader, mHeaderLength) == 0) {
+                onHeaderRepeated();
+                result = true;
+            } else if (parseHeader()) {
+                memcpy(mPreviousHeader, mHeaderBuffer, mHeaderLength);
+                mHeaderCacheValid = true;
                 result = true;
             } else {
+                mHeaderCacheValid = false;
                 ALOGE("FrameScanner: ERROR - parseHeader() failed.");
             }
             mCursor = 0;
@@ -76,4 +86,17 @@ bool FrameScanner::scan(uint8_t byte)
     return result;
 }
 
+size_t FrameScanner::skipToSync(const uint8_t *data, size_t length)
+{
+    if (mCursor != 0) {
+        return 0; // mid-header, continue with scan()
+    }
+    // memchr() is wide (SIMD) in libc, much faster than scanning per byte.
+    const void *sync = memchr(data, mSyncBytes[0], length);
+    const size_t skipped = (sync == NULL)
+            ? length : (size_t) ((const uint8_t *) sync - data);
+    mBytesSkipped += skipped; // skip unsynchronized data
+    return skipped;
+}
+
 }  // namespace android
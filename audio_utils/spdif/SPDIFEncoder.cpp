@@ -37,11 +37,14 @@ SPDIFEncoder::SPDIFEncoder(audio_format_t format)
   : mFramer(NULL)
   , mSampleRate(48000)
   , mBurstBuffer(NULL)
+  , mOutputBuffer(NULL)
+  , mReservedOutput(false)
   , mBurstBufferSizeBytes(0)
   , mRateMultiplier(1)
   , mBurstFrames(0)
   , mByteCursor(0)
   , mBitstreamNumber(0)
+  , mPreamble{kSPDIFSync1, kSPDIFSync2, 0, 0}
   , mPayloadBytesPending(0)
   , mScanning(true)
 {
@@ -70,6 +73,7 @@ SPDIFEncoder::SPDIFEncoder(audio_format_t format)
     ALOGI("SPDIFEncoder: mBurstBufferSizeBytes = %zu, littleEndian = %d",
             mBurstBufferSizeBytes, isLittleEndian());
     mBurstBuffer = new uint16_t[mBurstBufferSizeBytes >> 1];
+    mOutputBuffer = mBurstBuffer;
     clearBurstBuffer();
 }
 
@@ -121,7 +125,7 @@ void SPDIFEncoder::writeBurstBufferShorts(const uint16_t *buffer, size_t numShor
         reset();
         return;
     }
-    memcpy(&mBurstBuffer[mByteCursor >> 1], buffer, bytesToWrite);
+    memcpy(&mOutputBuffer[mByteCursor >> 1], buffer, bytesToWrite);
     mByteCursor += bytesToWrite;
 }
 
@@ -145,21 +149,25 @@ void SPDIFEncoder::writeBurstBufferBytes(const uint8_t *buffer, size_t numBytes)
     if (numBytes == 0) {
         return;
     }
-    // Pack bytes into short buffer.
-    uint16_t pad = mBurstBuffer[mByteCursor >> 1];
-    for (size_t i = 0; i < numBytes; i++) {
-        if (mByteCursor & 1 ) {
-            pad |= *buffer++; // put second byte in LSB
-            mBurstBuffer[mByteCursor >> 1] = pad;
-            pad = 0;
-        } else {
-            pad |= (*buffer++) << 8; // put first byte in MSB
-        }
+    // Finish a partially filled short so the pair loop starts on an even cursor.
+    if (mByteCursor & 1) {
+        mOutputBuffer[mByteCursor >> 1] |= *buffer++; // put second byte in LSB
         mByteCursor++;
+        numBytes--;
     }
-    // Save partially filled short.
-    if (mByteCursor & 1 ){
-        mBurstBuffer[mByteCursor >> 1] = pad;
+    // Pack byte pairs into shorts. The iterations are independent, so the
+    // compiler can vectorize this swab (the hot path for burst payloads).
+    uint16_t *out = &mOutputBuffer[mByteCursor >> 1];
+    const size_t numPairs = numBytes >> 1;
+    for (size_t i = 0; i < numPairs; i++) {
+        out[i] = (buffer[2 * i] << 8) | buffer[2 * i + 1];
+    }
+    buffer += numPairs * sizeof(uint16_t);
+    mByteCursor += numPairs * sizeof(uint16_t);
+    // Save a leftover byte as a partially filled short.
+    if (numBytes & 1) {
+        mOutputBuffer[mByteCursor >> 1] = (*buffer) << 8; // put first byte in MSB
+        mByteCursor++;
     }
 }
 
@@ -172,9 +180,12 @@ void SPDIFEncoder::sendZeroPad()
         ALOGE("SPDIFEncoder: Burst buffer, contents too large!");
         clearBurstBuffer();
     } else {
-        // We don't have to write zeros because buffer already set to zero
-        // by clearBurstBuffer(). Just pretend we wrote zeros by
-        // incrementing cursor.
+        // Zero only the actual padding; the buffer is not pre-cleared, so
+        // the per-burst cost is the pad length, not the maximum burst size.
+        // A partially filled short already has a zero LSB (see
+        // writeBurstBufferBytes()), so rounding the cursor up is safe.
+        const size_t padFrom = (mByteCursor + 1) & ~(size_t)1;
+        memset((uint8_t *)mOutputBuffer + padFrom, 0, burstSize - padFrom);
         mByteCursor = burstSize;
     }
 }
@@ -196,38 +207,50 @@ void SPDIFEncoder::flushBurstBuffer()
     if (mByteCursor > preambleSize) {
         // Set lengthCode for valid payload before zeroPad.
         uint16_t numBytes = (mByteCursor - preambleSize);
-        mBurstBuffer[3] = mFramer->convertBytesToLengthCode(numBytes);
+        mOutputBuffer[3] = mFramer->convertBytesToLengthCode(numBytes);
 
         sendZeroPad();
-        writeOutput(mBurstBuffer, mByteCursor);
+        if (mReservedOutput) {
+            // Burst was assembled in place in the caller's buffer.
+            commitOutput(mByteCursor);
+        } else {
+            writeOutput(mBurstBuffer, mByteCursor);
+        }
     }
     reset();
 }
 
 void SPDIFEncoder::clearBurstBuffer()
 {
-    if (mBurstBuffer) {
-        memset(mBurstBuffer, 0, mBurstBufferSizeBytes);
-    }
+    // No need to clear the buffer contents: everything up to the burst size
+    // is either written or explicitly zeroed by sendZeroPad() before it is
+    // output.
+    // Drop any uncommitted reservation; the caller sees no commit for it.
+    mOutputBuffer = mBurstBuffer;
+    mReservedOutput = false;
     mByteCursor = 0;
 }
 
 void SPDIFEncoder::startDataBurst()
 {
-    // Encode IEC61937-1 Burst Preamble
-    uint16_t preamble[4];
+    // Try to assemble the burst in place in a caller-provided buffer.
+    void *reserved = reserveOutput(mBurstBufferSizeBytes);
+    if (reserved != NULL) {
+        mOutputBuffer = (uint16_t *) reserved;
+        mReservedOutput = true;
+    }
 
-    uint16_t burstInfo = (mBitstreamNumber << 13)
+    // Encode IEC61937-1 Burst Preamble from the template; only Pc changes,
+    // and only when the framer's data type info does.
+    const uint16_t burstInfo = (mBitstreamNumber << 13)
         | (mFramer->getDataTypeInfo() << 8)
         | mFramer->getDataType();
+    mPreamble[2] = burstInfo;
+    // mPreamble[3] is the lengthCode, set after the buffer is full.
 
     mRateMultiplier = mFramer->getRateMultiplier();
 
-    preamble[0] = kSPDIFSync1;
-    preamble[1] = kSPDIFSync2;
-    preamble[2] = burstInfo;
-    preamble[3] = 0; // lengthCode - This will get set after the buffer is full.
-    writeBurstBufferShorts(preamble, 4);
+    writeBurstBufferShorts(mPreamble, 4);
 }
 
 size_t SPDIFEncoder::startSyncFrame()
@@ -254,6 +277,13 @@ ssize_t SPDIFEncoder::write( const void *buffer, size_t numBytes )
         mScanning, (uint) *data, numBytes);
     while (bytesLeft > 0) {
         if (mScanning) {
+            // Skip ahead over bytes that cannot start a sync word.
+            size_t skipped = mFramer->skipToSync(data, bytesLeft);
+            data += skipped;
+            bytesLeft -= skipped;
+            if (bytesLeft == 0) {
+                break;
+            }
         // Look for beginning of next encoded frame.
             if (mFramer->scan(*data)) {
                 if (mByteCursor == 0) {
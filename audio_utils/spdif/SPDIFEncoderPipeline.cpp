@@ -0,0 +1,102 @@
+/*
+ * Copyright 2022, The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <limits.h>
+
+#define LOG_TAG "AudioSPDIF"
+#include <log/log.h>
+#include <audio_utils/spdif/SPDIFEncoderPipeline.h>
+
+namespace android {
+
+SPDIFEncoderPipeline::SPDIFEncoderPipeline(SPDIFEncoder& encoder, size_t lookaheadBytes)
+    : mEncoder(encoder)
+    , mQueueBuffer(lookaheadBytes)
+    , mFifo((uint32_t)lookaheadBytes, 1 /*frameSize*/, mQueueBuffer.data(),
+            true /*throttlesWriter*/)
+    , mWriter(mFifo)
+    , mReader(mFifo)
+    , mThread(&SPDIFEncoderPipeline::threadLoop, this)
+{
+}
+
+SPDIFEncoderPipeline::~SPDIFEncoderPipeline()
+{
+    waitUntilDrained();
+    mExit = true;
+    mThread.join();
+}
+
+ssize_t SPDIFEncoderPipeline::write(const void *buffer, size_t numBytes)
+{
+    const uint8_t *data = (const uint8_t *)buffer;
+    size_t bytesLeft = numBytes;
+    // blocks only when a full lookahead window is already queued
+    static const struct timespec timeout = { LONG_MAX, 0 };
+    while (bytesLeft > 0) {
+        const ssize_t actual = mWriter.write(data, bytesLeft, &timeout);
+        if (actual < 0) {
+            ALOGE("SPDIFEncoderPipeline: queue write error %zd", actual);
+            return actual;
+        }
+        {
+            std::lock_guard lg(mLock);
+            mBytesAccepted += actual;
+            if (mBytesEncoded == mBytesAccepted) {
+                // the thread raced ahead of this bookkeeping
+                mDrained.notify_all();
+            }
+        }
+        data += actual;
+        bytesLeft -= actual;
+    }
+    return numBytes;
+}
+
+void SPDIFEncoderPipeline::flush()
+{
+    waitUntilDrained();
+    // the thread is idle with an empty queue, so the encoder is not in use
+    mEncoder.reset();
+}
+
+void SPDIFEncoderPipeline::waitUntilDrained()
+{
+    std::unique_lock ul(mLock);
+    mDrained.wait(ul, [this] { return mBytesEncoded == mBytesAccepted; });
+}
+
+void SPDIFEncoderPipeline::threadLoop()
+{
+    uint8_t chunk[4096];
+    // bounded wait so exit requests are noticed without a wakeup channel
+    const struct timespec timeout = { 0, 100 * 1000 * 1000 };
+    for (;;) {
+        const ssize_t actual = mReader.read(chunk, sizeof(chunk), &timeout);
+        if (actual > 0) {
+            mEncoder.write(chunk, actual);
+            std::lock_guard lg(mLock);
+            mBytesEncoded += actual;
+            if (mBytesEncoded == mBytesAccepted) {
+                mDrained.notify_all();
+            }
+        } else if (mExit) {
+            break;  // a drained queue is guaranteed by the destructor
+        }
+    }
+}
+
+}  // namespace android
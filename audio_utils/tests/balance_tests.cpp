@@ -72,6 +72,84 @@ TEST(audio_utils_balance, 7point1) {
   ASSERT_EQ((std::vector<float>{1.f, 0.f, 0.5f, 0.25f, 0.75f, 0.f, 0.125f, 0.f}), buffer);
 }
 
+TEST(audio_utils_balance, mono_blend) {
+  // disable ramping so we can check single frame processing.
+  android::audio_utils::Balance balance(false /* ramp */);
+  ASSERT_EQ(false, balance.getRamp());
+
+  balance.setChannelMask(AUDIO_CHANNEL_OUT_STEREO);
+  std::vector<float> buffer = {1.f, 0.5f};
+  std::vector<float> out = {0.f, 0.f};
+
+  // balance of 0 still blends, with unity volumes.
+  ASSERT_EQ(0.f, balance.getBalance());
+  balance.processMonoBlend(buffer.data(), out.data(), 1 /* frames */);
+  ASSERT_EQ((std::vector<float>{0.75f, 0.75f}), out);
+  ASSERT_EQ((std::vector<float>{1.f, 0.5f}), buffer); // input untouched
+
+  // balance of 1.f is right: blend then balance in one pass.
+  balance.setBalance(1.f);
+  balance.processMonoBlend(buffer.data(), out.data(), 1 /* frames */);
+  ASSERT_EQ((std::vector<float>{0.f, 0.75f}), out);
+
+  // in-place operation matches mono_blend() followed by process().
+  std::vector<float> inplace = {1.f, 0.5f};
+  balance.processMonoBlend(inplace.data(), inplace.data(), 1 /* frames */);
+  ASSERT_EQ(out, inplace);
+
+  // four channel blend with an index mask (first two channels are balanced).
+  balance.setChannelMask(audio_channel_mask_from_representation_and_bits(
+      AUDIO_CHANNEL_REPRESENTATION_INDEX, 0xf));
+  balance.setBalance(-1.f);
+  std::vector<float> buffer4 = {1.f, 0.5f, 0.25f, 0.25f};
+  std::vector<float> out4(4);
+  balance.processMonoBlend(buffer4.data(), out4.data(), 1 /* frames */);
+  ASSERT_EQ((std::vector<float>{0.5f, 0.f, 0.5f, 0.5f}), out4);
+}
+
+TEST(audio_utils_balance, master_volume) {
+  // non-ramped combined balance and master volume.
+  android::audio_utils::Balance balance(false /* ramp */);
+  balance.setChannelMask(AUDIO_CHANNEL_OUT_STEREO);
+  std::vector<float> buffer = {1.f, -1.f};
+
+  // unlike process(), a balance of 0.f still applies the master volume.
+  ASSERT_EQ(0.f, balance.getBalance());
+  balance.process(buffer.data(), 1 /* frames */, 0.5f /* masterVolume */);
+  ASSERT_EQ((std::vector<float>{0.5f, -0.5f}), buffer);
+
+  // balance and master volume apply in a single pass.
+  balance.setBalance(1.f);
+  buffer = {1.f, -1.f};
+  balance.process(buffer.data(), 1 /* frames */, 0.5f /* masterVolume */);
+  ASSERT_EQ((std::vector<float>{0.f, -0.5f}), buffer);
+}
+
+TEST(audio_utils_balance, master_volume_ramp) {
+  android::audio_utils::Balance balance(true /* ramp */);
+  balance.setChannelMask(AUDIO_CHANNEL_OUT_STEREO);
+  constexpr size_t kFrames = 2 * android::audio_utils::Balance::kRampBlockFrames;
+  std::vector<float> buffer(kFrames * 2, 1.f);
+
+  // the first process() applies directly and saves the ramp starting point.
+  balance.process(buffer.data(), kFrames, 0.f /* masterVolume */);
+  ASSERT_EQ(std::vector<float>(kFrames * 2, 0.f), buffer);
+
+  // a master volume change now block ramps: the first block keeps the
+  // starting gain, the second block is half way to the target.
+  std::fill(buffer.begin(), buffer.end(), 1.f);
+  balance.process(buffer.data(), kFrames, 1.f /* masterVolume */);
+  std::vector<float> expected(kFrames * 2, 0.5f);
+  std::fill(expected.begin(),
+      expected.begin() + android::audio_utils::Balance::kRampBlockFrames * 2, 0.f);
+  ASSERT_EQ(expected, buffer);
+
+  // with no gain change the target applies without ramping.
+  std::fill(buffer.begin(), buffer.end(), 1.f);
+  balance.process(buffer.data(), kFrames, 1.f /* masterVolume */);
+  ASSERT_EQ(std::vector<float>(kFrames * 2, 1.f), buffer);
+}
+
 TEST(audio_utils_balance, lfe) {
   // disable ramping so we can check single frame processing.
   android::audio_utils::Balance balance(false /* ramp */);
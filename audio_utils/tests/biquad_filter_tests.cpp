@@ -351,3 +351,82 @@ TYPED_TEST(BiquadBasicTest, Equivalence) {
 TYPED_TEST(BiquadBasicTest, CoefReductionEquivalence) {
     this->testCoefReductionEquivalence();
 }
+
+// The cascade must match running the sections one after another through
+// BiquadFilter, within float accumulation tolerance.
+template <size_t CHANNELS, size_t SECTIONS>
+static void testCascadeEquivalence() {
+    constexpr size_t TEST_FRAME_COUNT = 256;
+    std::array<std::array<float, kBiquadNumCoefs>, SECTIONS> coefs;
+    for (auto& coef : coefs) {
+        coef = randomFilter<float>();
+    }
+
+    std::vector<float> input(TEST_FRAME_COUNT * CHANNELS);
+    randomBuffer(input.data(), TEST_FRAME_COUNT, CHANNELS);
+
+    // reference: each section applied as a separate BiquadFilter pass.
+    std::vector<float> expected(input);
+    for (const auto& coef : coefs) {
+        BiquadFilter<float> section(CHANNELS, coef);
+        section.process(expected.data(), expected.data(), TEST_FRAME_COUNT);
+    }
+
+    BiquadFilterCascade<CHANNELS, SECTIONS> cascade(coefs);
+    std::vector<float> actual(input.size());
+    // process in two calls to verify the states carry across calls.
+    constexpr size_t SPLIT_FRAME = TEST_FRAME_COUNT / 2;
+    cascade.process(actual.data(), input.data(), SPLIT_FRAME);
+    cascade.process(actual.data() + SPLIT_FRAME * CHANNELS,
+            input.data() + SPLIT_FRAME * CHANNELS, TEST_FRAME_COUNT - SPLIT_FRAME);
+
+    EXPECT_THAT(actual, Pointwise(FloatNear(EPS), expected));
+}
+
+TEST(BiquadFilterCascadeTest, EquivalenceMono) {
+    testCascadeEquivalence<1, 5>();
+}
+
+TEST(BiquadFilterCascadeTest, EquivalenceStereo) {
+    testCascadeEquivalence<2, 5>();
+}
+
+TEST(BiquadFilterCascadeTest, EquivalenceQuad) {
+    testCascadeEquivalence<4, 3>();
+}
+
+TEST(BiquadFilterCascadeTest, Equivalence5point1) {
+    testCascadeEquivalence<6, 2>();
+}
+
+TEST(BiquadFilterCascadeTest, Equivalence7point1) {
+    testCascadeEquivalence<8, 5>();
+}
+
+TEST(BiquadFilterCascadeTest, SingleSectionMatchesBiquadFilter) {
+    constexpr size_t CHANNELS = 2;
+    constexpr size_t TEST_FRAME_COUNT = 128;
+    const std::array<float, kBiquadNumCoefs> coef = randomFilter<float>();
+
+    std::vector<float> input(TEST_FRAME_COUNT * CHANNELS);
+    randomBuffer(input.data(), TEST_FRAME_COUNT, CHANNELS);
+
+    std::vector<float> expected(input.size());
+    BiquadFilter<float> filter(CHANNELS, coef);
+    filter.process(expected.data(), input.data(), TEST_FRAME_COUNT);
+
+    BiquadFilterCascade<CHANNELS, 1> cascade(
+            std::array<std::array<float, kBiquadNumCoefs>, 1>{coef});
+    std::vector<float> actual(input.size());
+    cascade.process(actual.data(), input.data(), TEST_FRAME_COUNT);
+
+    EXPECT_THAT(actual, Pointwise(FloatNear(EPS), expected));
+}
+
+TEST(BiquadFilterCascadeTest, Stability) {
+    BiquadFilterCascade<2, 2> cascade;
+    EXPECT_TRUE(cascade.setCoefficients(0, randomFilter<float>()));
+    EXPECT_FALSE(cascade.setCoefficients(1, randomUnstableFilter<float>()));
+    EXPECT_TRUE(cascade.isStable(0));
+    EXPECT_FALSE(cascade.isStable(1));
+}
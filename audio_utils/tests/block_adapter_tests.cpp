@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <audio_utils/BlockAdapter.h>
+
+using android::audio_utils::BlockAdapter;
+
+namespace {
+
+constexpr uint32_t kBlockFrames = 4;
+constexpr uint32_t kMaxFrames = 16;
+
+// a recognizable fixed-block "effect": doubles each sample,
+// and remembers the block sizes it was called with.
+struct DoublerEffect {
+    std::vector<size_t> blockSizes;
+
+    static void process(void *cookie, const void *in, void *out, size_t frames) {
+        DoublerEffect *effect = (DoublerEffect *) cookie;
+        effect->blockSizes.push_back(frames);
+        const float *fin = (const float *) in;
+        float *fout = (float *) out;
+        for (size_t i = 0; i < frames; i++) {
+            fout[i] = fin[i] * 2.f;
+        }
+    }
+};
+
+std::vector<float> makeRamp(size_t frames) {
+    std::vector<float> ramp(frames);
+    for (size_t i = 0; i < frames; i++) {
+        ramp[i] = (float) (i + 1);
+    }
+    return ramp;
+}
+
+}   // namespace
+
+TEST(block_adapter, aligned_zero_copy) {
+    DoublerEffect effect;
+    BlockAdapter adapter(kBlockFrames, sizeof(float), kMaxFrames,
+            DoublerEffect::process, &effect);
+    EXPECT_EQ(0u, adapter.latencyFrames());
+
+    const std::vector<float> in = makeRamp(2 * kBlockFrames);
+    std::vector<float> out(in.size());
+    adapter.process(in.data(), out.data(), in.size());
+
+    // no latency, every sample doubled, and only whole blocks seen.
+    EXPECT_EQ(0u, adapter.latencyFrames());
+    for (size_t i = 0; i < in.size(); i++) {
+        EXPECT_EQ(in[i] * 2.f, out[i]) << "at frame " << i;
+    }
+    EXPECT_EQ(std::vector<size_t>(2, kBlockFrames), effect.blockSizes);
+}
+
+TEST(block_adapter, aligned_in_place) {
+    DoublerEffect effect;
+    BlockAdapter adapter(kBlockFrames, sizeof(float), kMaxFrames,
+            DoublerEffect::process, &effect);
+
+    const std::vector<float> in = makeRamp(kBlockFrames);
+    std::vector<float> buffer = in;
+    adapter.process(buffer.data(), buffer.data(), buffer.size());
+    for (size_t i = 0; i < in.size(); i++) {
+        EXPECT_EQ(in[i] * 2.f, buffer[i]) << "at frame " << i;
+    }
+}
+
+TEST(block_adapter, unaligned_rebuffers_with_one_block_latency) {
+    DoublerEffect effect;
+    BlockAdapter adapter(kBlockFrames, sizeof(float), kMaxFrames,
+            DoublerEffect::process, &effect);
+
+    // feed a ramp in chunks of 3 against a block size of 4.
+    constexpr size_t kChunk = 3;
+    constexpr size_t kTotal = 24;
+    const std::vector<float> in = makeRamp(kTotal);
+    std::vector<float> out(kTotal, -1.f);
+    for (size_t offset = 0; offset < kTotal; offset += kChunk) {
+        adapter.process(&in[offset], &out[offset], kChunk);
+    }
+    EXPECT_EQ(kBlockFrames, adapter.latencyFrames());
+
+    // output is one block of silence, then the doubled input.
+    for (size_t i = 0; i < kBlockFrames; i++) {
+        EXPECT_EQ(0.f, out[i]) << "at frame " << i;
+    }
+    for (size_t i = kBlockFrames; i < kTotal; i++) {
+        EXPECT_EQ(in[i - kBlockFrames] * 2.f, out[i]) << "at frame " << i;
+    }
+    for (const size_t blockSize : effect.blockSizes) {
+        EXPECT_EQ((size_t) kBlockFrames, blockSize);
+    }
+}
+
+TEST(block_adapter, varying_chunks_and_large_counts) {
+    DoublerEffect effect;
+    BlockAdapter adapter(kBlockFrames, sizeof(float), kMaxFrames,
+            DoublerEffect::process, &effect);
+
+    // mixed chunk sizes, including one larger than maxFrames to force slicing.
+    const size_t chunks[] = { 1, 7, 2, kMaxFrames + 5, 3, 5, 1, 12 };
+    size_t total = 0;
+    for (const size_t chunk : chunks) {
+        total += chunk;
+    }
+    const std::vector<float> in = makeRamp(total);
+    std::vector<float> out(total, -1.f);
+    size_t offset = 0;
+    for (const size_t chunk : chunks) {
+        adapter.process(&in[offset], &out[offset], chunk);
+        offset += chunk;
+    }
+
+    for (size_t i = 0; i < kBlockFrames; i++) {
+        EXPECT_EQ(0.f, out[i]) << "at frame " << i;
+    }
+    for (size_t i = kBlockFrames; i < total; i++) {
+        EXPECT_EQ(in[i - kBlockFrames] * 2.f, out[i]) << "at frame " << i;
+    }
+}
+
+TEST(block_adapter, reset_restores_zero_latency) {
+    DoublerEffect effect;
+    BlockAdapter adapter(kBlockFrames, sizeof(float), kMaxFrames,
+            DoublerEffect::process, &effect);
+
+    const std::vector<float> in = makeRamp(kBlockFrames);
+    std::vector<float> out(in.size());
+    adapter.process(in.data(), out.data(), 3);  // unaligned, switches to buffered
+    EXPECT_EQ(kBlockFrames, adapter.latencyFrames());
+
+    adapter.reset();
+    EXPECT_EQ(0u, adapter.latencyFrames());
+
+    // back on the zero-copy path.
+    adapter.process(in.data(), out.data(), in.size());
+    EXPECT_EQ(0u, adapter.latencyFrames());
+    for (size_t i = 0; i < in.size(); i++) {
+        EXPECT_EQ(in[i] * 2.f, out[i]) << "at frame " << i;
+    }
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "audio_utils_cache_topology_tests"
+
+#include <audio_utils/cache_topology.h>
+#include <gtest/gtest.h>
+
+static bool isPowerOfTwo(size_t v) {
+    return v != 0 && (v & (v - 1)) == 0;
+}
+
+TEST(audio_utils_cache_topology, topology_is_sane)
+{
+    struct audio_utils_cache_topology topology;
+    (void)audio_utils_get_cache_topology(&topology);
+    // whether probed or defaulted, L1d and line size are always reported
+    EXPECT_GE(topology.l1d_size, (size_t)8 * 1024);
+    EXPECT_LE(topology.l1d_size, (size_t)1024 * 1024);
+    EXPECT_GE(topology.line_size, (size_t)16);
+    EXPECT_LE(topology.line_size, (size_t)256);
+    if (topology.l2_size != 0) {
+        EXPECT_GT(topology.l2_size, topology.l1d_size);
+    }
+
+    // the probe is cached: a second call reports the same values
+    struct audio_utils_cache_topology again;
+    (void)audio_utils_get_cache_topology(&again);
+    EXPECT_EQ(topology.l1d_size, again.l1d_size);
+    EXPECT_EQ(topology.l2_size, again.l2_size);
+    EXPECT_EQ(topology.l3_size, again.l3_size);
+    EXPECT_EQ(topology.line_size, again.line_size);
+}
+
+TEST(audio_utils_cache_topology, tile_recommendation)
+{
+    // stereo float through a 3-buffer chain
+    const size_t tile = audio_utils_recommend_tile_frames(sizeof(float) * 2, 3);
+    EXPECT_TRUE(isPowerOfTwo(tile));
+    EXPECT_GE(tile, (size_t)32);
+    EXPECT_LE(tile, (size_t)4096);
+
+    // a heavier chain never gets a larger tile
+    const size_t heavy = audio_utils_recommend_tile_frames(sizeof(float) * 24, 5);
+    EXPECT_LE(heavy, tile);
+
+    // within bounds, the working set respects about half of L1d
+    struct audio_utils_cache_topology topology;
+    (void)audio_utils_get_cache_topology(&topology);
+    if (tile < (size_t)4096) {
+        EXPECT_LE(tile * sizeof(float) * 2 * 3, topology.l1d_size / 2);
+    }
+
+    // degenerate arguments still give a usable tile
+    EXPECT_TRUE(isPowerOfTwo(audio_utils_recommend_tile_frames(0, 0)));
+}
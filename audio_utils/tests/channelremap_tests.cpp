@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <audio_utils/ChannelRemap.h>
+
+using android::audio_utils::channels::ChannelRemap;
+
+// Fills a buffer of interleaved frames where sample (frame, channel) has a
+// unique value, so any misrouted sample is detected.
+template <typename T>
+static std::vector<T> makeRamp(size_t frames, size_t channels) {
+    std::vector<T> v(frames * channels);
+    for (size_t i = 0; i < v.size(); ++i) {
+        v[i] = (T)(i + 1);
+    }
+    return v;
+}
+
+TEST(channel_remap, expand_stereo_to_5point1) {
+    constexpr size_t FRAMES = 7;
+    ChannelRemap remap(AUDIO_CHANNEL_OUT_STEREO, AUDIO_CHANNEL_OUT_5POINT1,
+            sizeof(int16_t));
+    ASSERT_EQ(AUDIO_CHANNEL_OUT_STEREO, remap.getInputChannelMask());
+
+    const auto in = makeRamp<int16_t>(FRAMES, 2);
+    std::vector<int16_t> out(FRAMES * 6, -1);
+    EXPECT_EQ(FRAMES * 6 * sizeof(int16_t),
+            remap.process(in.data(), out.data(), FRAMES));
+
+    for (size_t f = 0; f < FRAMES; ++f) {
+        EXPECT_EQ(in[f * 2], out[f * 6]) << "frame " << f;      // FL
+        EXPECT_EQ(in[f * 2 + 1], out[f * 6 + 1]) << "frame " << f;  // FR
+        for (size_t ch = 2; ch < 6; ++ch) {
+            EXPECT_EQ(0, out[f * 6 + ch]) << "frame " << f << " ch " << ch;
+        }
+    }
+}
+
+TEST(channel_remap, contract_7point1point4_to_stereo) {
+    constexpr size_t FRAMES = 100;
+    ChannelRemap remap(AUDIO_CHANNEL_OUT_7POINT1POINT4, AUDIO_CHANNEL_OUT_STEREO,
+            sizeof(int16_t));
+
+    const auto in = makeRamp<int16_t>(FRAMES, 12);
+    std::vector<int16_t> out(FRAMES * 2, -1);
+    EXPECT_EQ(FRAMES * 2 * sizeof(int16_t),
+            remap.process(in.data(), out.data(), FRAMES));
+
+    // FL and FR are the two lowest positions of both masks.
+    for (size_t f = 0; f < FRAMES; ++f) {
+        EXPECT_EQ(in[f * 12], out[f * 2]) << "frame " << f;
+        EXPECT_EQ(in[f * 12 + 1], out[f * 2 + 1]) << "frame " << f;
+    }
+}
+
+TEST(channel_remap, silence_in_mid_frame) {
+    // 5.1 to 7.1 inserts the silent side pair between LFE and the back pair,
+    // which adjust_channels() cannot express.
+    constexpr size_t FRAMES = 50;
+    ChannelRemap remap(AUDIO_CHANNEL_OUT_5POINT1, AUDIO_CHANNEL_OUT_7POINT1,
+            sizeof(float));
+
+    const auto in = makeRamp<float>(FRAMES, 6);
+    std::vector<float> out(FRAMES * 8, -1.f);
+    remap.process(in.data(), out.data(), FRAMES);
+
+    // 7.1 position order: FL FR FC LFE BL BR SL SR.
+    for (size_t f = 0; f < FRAMES; ++f) {
+        for (size_t ch = 0; ch < 6; ++ch) {
+            EXPECT_EQ(in[f * 6 + ch], out[f * 8 + ch]) << "frame " << f << " ch " << ch;
+        }
+        EXPECT_EQ(0.f, out[f * 8 + 6]) << "frame " << f;  // SL
+        EXPECT_EQ(0.f, out[f * 8 + 7]) << "frame " << f;  // SR
+    }
+}
+
+TEST(channel_remap, sample_sizes) {
+    // the engine is byte based; every sample size must route identically.
+    constexpr size_t FRAMES = 40;
+    for (size_t sampleSize : {1, 2, 3, 4}) {
+        ChannelRemap remap(AUDIO_CHANNEL_OUT_QUAD, AUDIO_CHANNEL_OUT_STEREO,
+                sampleSize);
+        std::vector<uint8_t> in(FRAMES * 4 * sampleSize);
+        for (size_t i = 0; i < in.size(); ++i) {
+            in[i] = (uint8_t)(i * 7 + 1);
+        }
+        std::vector<uint8_t> out(FRAMES * 2 * sampleSize, 0xAA);
+        EXPECT_EQ(FRAMES * 2 * sampleSize,
+                remap.process(in.data(), out.data(), FRAMES));
+        for (size_t f = 0; f < FRAMES; ++f) {
+            for (size_t b = 0; b < 2 * sampleSize; ++b) {
+                EXPECT_EQ(in[f * 4 * sampleSize + b], out[f * 2 * sampleSize + b])
+                        << "frame " << f << " byte " << b
+                        << " sample size " << sampleSize;
+            }
+        }
+    }
+}
+
+TEST(channel_remap, in_place) {
+    constexpr size_t FRAMES = 30;
+    // expansion in-place
+    {
+        ChannelRemap remap(AUDIO_CHANNEL_OUT_STEREO, AUDIO_CHANNEL_OUT_QUAD,
+                sizeof(int16_t));
+        const auto in = makeRamp<int16_t>(FRAMES, 2);
+        std::vector<int16_t> buffer(in);
+        buffer.resize(FRAMES * 4);
+        remap.process(buffer.data(), buffer.data(), FRAMES);
+
+        std::vector<int16_t> expected(FRAMES * 4);
+        remap.process(in.data(), expected.data(), FRAMES);
+        EXPECT_EQ(expected, buffer);
+    }
+    // contraction in-place
+    {
+        ChannelRemap remap(AUDIO_CHANNEL_OUT_QUAD, AUDIO_CHANNEL_OUT_STEREO,
+                sizeof(int16_t));
+        const auto in = makeRamp<int16_t>(FRAMES, 4);
+        std::vector<int16_t> buffer(in);
+        remap.process(buffer.data(), buffer.data(), FRAMES);
+        buffer.resize(FRAMES * 2);
+
+        std::vector<int16_t> expected(FRAMES * 2);
+        remap.process(in.data(), expected.data(), FRAMES);
+        EXPECT_EQ(expected, buffer);
+    }
+}
+
+TEST(channel_remap, matches_adjust_channels) {
+    // when the output mask extends the input mask, the result must agree
+    // with the uncached adjust_channels() path.
+    constexpr size_t FRAMES = 64;
+    ChannelRemap remap(AUDIO_CHANNEL_OUT_STEREO, AUDIO_CHANNEL_OUT_QUAD,
+            sizeof(int16_t));
+    const auto in = makeRamp<int16_t>(FRAMES, 2);
+
+    std::vector<int16_t> engine(FRAMES * 4);
+    remap.process(in.data(), engine.data(), FRAMES);
+
+    std::vector<int16_t> reference(FRAMES * 4);
+    adjust_channels(in.data(), 2, reference.data(), 4,
+            sizeof(int16_t), FRAMES * 2 * sizeof(int16_t));
+    EXPECT_EQ(reference, engine);
+}
+
+TEST(channel_remap, rejects_bad_config) {
+    ChannelRemap remap;
+    EXPECT_FALSE(remap.setRemap(AUDIO_CHANNEL_OUT_STEREO,
+            audio_channel_mask_for_index_assignment_from_count(2), sizeof(int16_t)));
+    EXPECT_FALSE(remap.setRemap(AUDIO_CHANNEL_OUT_STEREO, AUDIO_CHANNEL_OUT_STEREO,
+            8 /* sampleSize */));
+    EXPECT_FALSE(remap.setRemap(AUDIO_CHANNEL_NONE, AUDIO_CHANNEL_OUT_STEREO,
+            sizeof(int16_t)));
+    EXPECT_EQ(AUDIO_CHANNEL_NONE, remap.getInputChannelMask());
+}
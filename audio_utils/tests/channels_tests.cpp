@@ -105,6 +105,38 @@ TEST(audio_utils_channels, array_lr_pair_matching) {
     }
 }
 
+TEST(audio_utils_channels, channel_positions) {
+    using namespace android::audio_utils::channels;
+
+    // fails to compile if the decode is not constexpr.
+    static constexpr ChannelPositions positions7Point1Point4(
+            (audio_channel_mask_t)AUDIO_CHANNEL_OUT_7POINT1POINT4);
+    static_assert(positions7Point1Point4.size() == 12);
+
+    // positions match the order the channels appear in the frame.
+    constexpr ChannelPositions positions5Point1((audio_channel_mask_t)AUDIO_CHANNEL_OUT_5POINT1);
+    ASSERT_EQ((size_t)6, positions5Point1.size());
+    const size_t expected[] = { 0, 1, 2, 3, 4, 5 };  // FL FR FC LFE BL BR
+    size_t i = 0;
+    for (const size_t position : positions5Point1) {
+        ASSERT_EQ(expected[i++], position);
+    }
+    ASSERT_EQ(positions5Point1.size(), i);
+
+    // iteration agrees with a per-buffer style mask scan.
+    for (size_t idx = 0; idx < positions7Point1Point4.size(); ++idx) {
+        const size_t position = positions7Point1Point4[idx];
+        ASSERT_LT(position, (size_t)FCC_26);
+        ASSERT_NE(0, AUDIO_CHANNEL_OUT_7POINT1POINT4 & (1 << position));
+    }
+
+    // out of range access returns 0, empty mask iterates nothing.
+    ASSERT_EQ((size_t)0, positions5Point1[positions5Point1.size()]);
+    constexpr ChannelPositions positionsNone(AUDIO_CHANNEL_NONE);
+    ASSERT_EQ((size_t)0, positionsNone.size());
+    ASSERT_EQ(positionsNone.begin(), positionsNone.end());
+}
+
 TEST(audio_utils_channels, adjust_channels) {
     constexpr size_t size = 65536;
     std::vector<uint16_t> u16ref(size);
@@ -251,3 +283,53 @@ TEST(audio_utils_channels, adjust_channels_non_destructive) {
     // Comparison array must be identical to reference.
     expectEq(u16inout, u16ref);
 }
+
+TEST(audio_utils_channels, adjust_channels_get_fn) {
+    constexpr size_t frames = 4096; /* arbitrary multiple of all channel counts used */
+    constexpr std::pair<size_t, size_t> chanPairs[] = {
+            {1, 2}, {2, 1}, {2, 4}, {4, 2}, {2, 6}, {6, 2}, {2, 8}, {8, 2},
+    };
+
+    // every specialized tuple must be bit identical to the generic path.
+    for (const auto& [inChans, outChans] : chanPairs) {
+        for (unsigned sampleSize = 1; sampleSize <= 4; ++sampleSize) {
+            const adjust_channels_fn fn =
+                    adjust_channels_get_fn(inChans, outChans, sampleSize);
+            ASSERT_NE(nullptr, fn);
+
+            std::vector<uint8_t> in(frames * inChans * sampleSize);
+            for (size_t i = 0; i < in.size(); ++i) {
+                in[i] = i * 7 + (i >> 8); /* arbitrary pattern */
+            }
+            std::vector<uint8_t> expected(frames * outChans * sampleSize);
+            std::vector<uint8_t> actual(expected.size());
+
+            const size_t expectedBytes = adjust_channels(
+                    in.data(), inChans, expected.data(), outChans,
+                    sampleSize, in.size());
+            const size_t actualBytes = fn(
+                    in.data(), inChans, actual.data(), outChans,
+                    sampleSize, in.size());
+
+            EXPECT_EQ(expectedBytes, actualBytes);
+            expectEq(actual, expected);
+
+            // in-place operation (contraction only: expansion would need
+            // the output sized buffer as input).
+            if (outChans < inChans) {
+                std::vector<uint8_t> inplace(in);
+                fn(inplace.data(), inChans, inplace.data(), outChans,
+                        sampleSize, in.size());
+                inplace.resize(actualBytes);
+                expectEq(inplace, actual);
+            }
+        }
+    }
+
+    // uncommon tuples fall back to the generic routine.
+    EXPECT_EQ(&adjust_channels, adjust_channels_get_fn(3, 5, 2));
+
+    // invalid sample sizes are rejected.
+    EXPECT_EQ(nullptr, adjust_channels_get_fn(2, 6, 0));
+    EXPECT_EQ(nullptr, adjust_channels_get_fn(2, 6, 5));
+}
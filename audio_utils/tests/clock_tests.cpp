@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <audio_utils/clock.h>
+
+TEST(audio_utils_clock, monotonic_time) {
+    const int64_t first = audio_utils_get_monotonic_time_ns();
+    const int64_t second = audio_utils_get_monotonic_time_ns();
+    EXPECT_GT(first, 0);
+    EXPECT_GE(second, first);
+}
+
+TEST(audio_utils_clock, cached_time) {
+    // the first read primes the cache from the monotonic clock.
+    const int64_t primed = audio_utils_cached_time_ns();
+    EXPECT_GT(primed, 0);
+    EXPECT_LE(primed, audio_utils_get_monotonic_time_ns());
+
+    // reads between ticks return the cached value, however stale.
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    EXPECT_EQ(primed, audio_utils_cached_time_ns());
+
+    // a tick refreshes the cache and returns the same value it stored.
+    const int64_t ticked = audio_utils_cached_time_tick();
+    EXPECT_GT(ticked, primed);
+    EXPECT_EQ(ticked, audio_utils_cached_time_ns());
+}
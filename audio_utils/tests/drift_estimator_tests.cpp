@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <audio_utils/DriftEstimator.h>
+#include <gtest/gtest.h>
+#include <random>
+
+using android::audio_utils::DriftEstimator;
+
+static constexpr int64_t kSecond = 1'000'000'000;
+
+TEST(audio_utils_drift_estimator, basic) {
+  DriftEstimator drift;
+  ASSERT_EQ(0u, drift.getSampleCount());
+  ASSERT_FALSE(drift.isValid());
+
+  // one pair is not enough for a slope.
+  drift.add(0, 0);
+  ASSERT_FALSE(drift.isValid());
+
+  // a remote clock running 100 ppm fast, sampled once a second.
+  const double rate = 1. + 100e-6;
+  for (int64_t i = 1; i < 10; ++i) {
+    drift.add(i * kSecond, (int64_t)(i * kSecond * rate));
+  }
+  ASSERT_TRUE(drift.isValid());
+  ASSERT_EQ(10u, drift.getSampleCount());
+  EXPECT_NEAR(100., drift.getDriftPpm(), 0.01);
+  EXPECT_NEAR(1., drift.getR2(), 1e-9);
+
+  drift.reset();
+  ASSERT_EQ(0u, drift.getSampleCount());
+  ASSERT_FALSE(drift.isValid());
+}
+
+TEST(audio_utils_drift_estimator, window_eviction) {
+  // a small window so eviction and the periodic rebuild are exercised.
+  DriftEstimator drift(8 /* capacity */);
+
+  // the remote clock starts 200 ppm slow...
+  const int64_t start = 1'000'000 * kSecond;  // large absolute timestamps.
+  int64_t remote = start;
+  int64_t local = start;
+  for (int i = 0; i < 100; ++i) {
+    drift.add(local, remote);
+    local += kSecond;
+    remote += (int64_t)(kSecond * (1. - 200e-6));
+  }
+  ASSERT_EQ(8u, drift.getSampleCount());
+  EXPECT_NEAR(-200., drift.getDriftPpm(), 0.01);
+
+  // ...then switches to 50 ppm fast: the window forgets the old rate.
+  for (int i = 0; i < 100; ++i) {
+    drift.add(local, remote);
+    local += kSecond;
+    remote += (int64_t)(kSecond * (1. + 50e-6));
+  }
+  EXPECT_NEAR(50., drift.getDriftPpm(), 0.01);
+  EXPECT_NEAR(1., drift.getR2(), 1e-6);
+}
+
+TEST(audio_utils_drift_estimator, noisy_confidence) {
+  DriftEstimator clean(32);
+  DriftEstimator noisy(32);
+  std::minstd_rand gen(42);
+  std::uniform_int_distribution<int64_t> jitter(-kSecond / 2, kSecond / 2);
+  for (int64_t i = 0; i < 32; ++i) {
+    clean.add(i * kSecond, i * kSecond);
+    noisy.add(i * kSecond, i * kSecond + jitter(gen));
+  }
+  // jitter lowers r2; an exact line keeps it at 1.
+  EXPECT_NEAR(1., clean.getR2(), 1e-9);
+  EXPECT_LT(noisy.getR2(), clean.getR2());
+  EXPECT_GT(noisy.getR2(), 0.);
+  // the slope estimate survives zero mean jitter to within a few percent.
+  EXPECT_NEAR(0., noisy.getDriftPpm(), 50000.);
+}
+
+TEST(audio_utils_drift_estimator, timebase_mapping) {
+  DriftEstimator drift;
+  // remote = 2 * local + offset; an extreme rate to make mapping obvious.
+  const int64_t offset = 5 * kSecond;
+  for (int64_t i = 0; i < 10; ++i) {
+    drift.add(i * kSecond, 2 * i * kSecond + offset);
+  }
+  ASSERT_TRUE(drift.isValid());
+  EXPECT_NEAR(2., drift.getSlope(), 1e-9);
+  // mapping in both directions round trips through the fitted line.
+  EXPECT_NEAR(2. * 20 * kSecond + offset, drift.localToRemote(20 * kSecond), 1.);
+  EXPECT_NEAR(20 * kSecond, drift.remoteToLocal(2 * 20 * kSecond + offset), 1.);
+}
@@ -20,6 +20,7 @@
 #include <audio_utils/ErrorLog.h>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <thread>
 #include <log/log.h>
 
 using namespace android;
@@ -85,6 +86,135 @@ Errors: 4
      */
 }
 
+TEST(audio_utils_errorlog, copy_entries) {
+    const int64_t oneSecond = 1000000000;
+    auto elog = std::make_unique<ErrorLog<int32_t>>(100 /* lines */);
+
+    // empty log
+    EXPECT_EQ((size_t)0, elog->copyEntries().size());
+
+    // distinct codes two seconds apart: no aggregation, entry i at time 2 * i seconds.
+    constexpr int32_t kEntries = 20;
+    for (int32_t i = 0; i < kEntries; ++i) {
+        elog->log(i /* code */, i * 2 * oneSecond /* nowNs */);
+    }
+
+    // full copy, ordered oldest first.
+    auto entries = elog->copyEntries();
+    ASSERT_EQ((size_t)kEntries, entries.size());
+    for (int32_t i = 0; i < kEntries; ++i) {
+        EXPECT_EQ(i, entries[i].mCode);
+        EXPECT_EQ(i * 2 * oneSecond, entries[i].mFirstTime);
+    }
+
+    // windowed queries agree with a brute force filter over the full copy.
+    for (int64_t startNs : {0L, 3 * oneSecond, 11 * oneSecond, 100 * oneSecond}) {
+        for (int64_t endNs : {2 * oneSecond, 15 * oneSecond, INT64_MAX}) {
+            const auto window = elog->copyEntries(startNs, endNs);
+            std::vector<int32_t> expected;
+            for (const auto &entry : entries) {
+                if (entry.mLastTime >= startNs && entry.mFirstTime <= endNs) {
+                    expected.push_back(entry.mCode);
+                }
+            }
+            ASSERT_EQ(expected.size(), window.size())
+                    << "startNs " << startNs << " endNs " << endNs;
+            for (size_t i = 0; i < window.size(); ++i) {
+                EXPECT_EQ(expected[i], window[i].mCode);
+            }
+        }
+    }
+
+    // wrapped ring: only the newest entries survive, still ordered and searchable.
+    auto small = std::make_unique<ErrorLog<int32_t>>(4 /* lines */);
+    for (int32_t i = 0; i < 10; ++i) {
+        small->log(i /* code */, i * 2 * oneSecond /* nowNs */);
+    }
+    const auto wrapped = small->copyEntries();
+    ASSERT_EQ((size_t)4, wrapped.size());
+    for (int32_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(i + 6, wrapped[i].mCode);
+    }
+    EXPECT_EQ((size_t)1, small->copyEntries(18 * oneSecond).size());
+    EXPECT_EQ((size_t)0, small->copyEntries(19 * oneSecond).size());
+    EXPECT_EQ((size_t)2, small->copyEntries(0, 15 * oneSecond).size());
+}
+
+TEST(audio_utils_errorlog, wait_free_basic) {
+    auto elog = std::make_unique<WaitFreeErrorLog<int32_t>>(
+            100 /* entriesPerWriter */, 2 /* maxWriters */);
+    const int64_t oneSecond = 1000000000;
+
+    auto *writer = elog->createWriter();
+    ASSERT_NE(nullptr, writer);
+
+    EXPECT_EQ((size_t)1, countNewLines(elog->dumpToString()));
+
+    writer->log(1 /* code */, 0 /* nowNs */);
+    writer->log(2 /* code */, 1 /* nowNs */);
+
+    // two separate errors (4 lines including 2 header lines)
+    EXPECT_EQ((size_t)4, countNewLines(elog->dumpToString()));
+
+    // aggregation at (oneSecond - 1)
+    writer->log(2 /* code */, oneSecond /* nowNs */);
+    EXPECT_EQ((size_t)4, countNewLines(elog->dumpToString()));
+
+    // no aggregation if spaced exactly one second apart
+    writer->log(2 /* code */, oneSecond * 2 /* nowNs */);
+    EXPECT_EQ((size_t)5, countNewLines(elog->dumpToString()));
+
+    // truncate on lines
+    EXPECT_EQ((size_t)3, countNewLines(elog->dumpToString("" /* prefix */, 3 /* lines */)));
+
+    // truncate on time
+    EXPECT_EQ((size_t)3, countNewLines(
+            elog->dumpToString("" /* prefix */, 0 /* lines */, oneSecond + 1 /* limitNs */)));
+
+    // a second writer merges into the same dump, in logging order.
+    auto *writer2 = elog->createWriter();
+    ASSERT_NE(nullptr, writer2);
+    writer2->log(3 /* code */, oneSecond * 3 /* nowNs */);
+    EXPECT_EQ((size_t)6, countNewLines(elog->dumpToString()));
+
+    // writers are preallocated; no more than maxWriters are assigned.
+    EXPECT_EQ(nullptr, elog->createWriter());
+
+    elog->dump(0 /* fd (stdout) */);
+}
+
+TEST(audio_utils_errorlog, wait_free_concurrent) {
+    auto elog = std::make_unique<WaitFreeErrorLog<int32_t>>(
+            8 /* entriesPerWriter */, 4 /* maxWriters */);
+    const int64_t oneSecond = 1000000000;
+
+    // logging threads run while dumps are in progress; neither may stall or crash.
+    std::atomic<bool> done{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            auto *writer = elog->createWriter();
+            ASSERT_NE(nullptr, writer);
+            for (int64_t i = 0; i < 10000; ++i) {
+                writer->log(t /* code */, i * oneSecond /* nowNs */);
+            }
+        });
+    }
+    std::thread dumper([&] {
+        while (!done) {
+            (void)elog->dumpToString();
+        }
+    });
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    done = true;
+    dumper.join();
+
+    // 8 entries per writer and no aggregation possible (4 * 8 + 2 header lines).
+    EXPECT_EQ((size_t)34, countNewLines(elog->dumpToString()));
+}
+
 TEST(audio_utils_errorlog, c) {
     error_log_t *error_log =
             error_log_create(100 /* lines */, 1000000000 /* one second aggregation */);
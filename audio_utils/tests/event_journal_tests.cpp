@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+#include <audio_utils/EventJournal.h>
+
+using android::audio_utils::EventJournalReader;
+using android::audio_utils::EventJournalWriter;
+using android::audio_utils::dumpMergedEventJournals;
+using android::audio_utils::event_journal_record;
+using android::audio_utils::kEventJournalPayloadSize;
+
+TEST(audio_utils_event_journal, round_trip)
+{
+    EventJournalWriter *writer;
+    ASSERT_EQ(0, EventJournalWriter::create(64, &writer));
+    std::unique_ptr<EventJournalWriter> writerDeleter(writer);
+
+    constexpr uint32_t kEvents = 10;
+    for (uint32_t i = 0; i < kEvents; i++) {
+        const uint64_t payload = 0x1000 + i;
+        writer->log(100 + i, &payload, sizeof(payload));
+    }
+
+    EventJournalReader *reader;
+    ASSERT_EQ(0, EventJournalReader::attach(writer->fd(), &reader));
+    std::unique_ptr<EventJournalReader> readerDeleter(reader);
+
+    event_journal_record records[kEvents + 1];
+    size_t lost = ~(size_t) 0;
+    ASSERT_EQ((ssize_t) kEvents, reader->read(records, kEvents + 1, &lost));
+    EXPECT_EQ((size_t) 0, lost);
+    for (uint32_t i = 0; i < kEvents; i++) {
+        EXPECT_EQ(100 + i, records[i].id);
+        EXPECT_EQ(i, records[i].sequence);
+        uint64_t payload;
+        memcpy(&payload, records[i].payload, sizeof(payload));
+        EXPECT_EQ(0x1000 + i, payload);
+        // the tail of the payload beyond what the writer supplied is zero filled
+        for (size_t j = sizeof(payload); j < kEventJournalPayloadSize; j++) {
+            EXPECT_EQ(0, records[i].payload[j]);
+        }
+        if (i > 0) {
+            EXPECT_LE(records[i - 1].timeNs, records[i].timeNs);
+        }
+    }
+    // nothing further to read
+    EXPECT_EQ((ssize_t) 0, reader->read(records, kEvents, &lost));
+}
+
+TEST(audio_utils_event_journal, overwrite_reports_lost)
+{
+    constexpr uint32_t kCapacity = 8;
+    constexpr uint32_t kEvents = 100;
+    EventJournalWriter *writer;
+    ASSERT_EQ(0, EventJournalWriter::create(kCapacity, &writer));
+    std::unique_ptr<EventJournalWriter> writerDeleter(writer);
+    EventJournalReader *reader;
+    ASSERT_EQ(0, EventJournalReader::attach(writer->fd(), &reader));
+    std::unique_ptr<EventJournalReader> readerDeleter(reader);
+
+    // the writer is never throttled, so it laps the ring freely
+    for (uint32_t i = 0; i < kEvents; i++) {
+        writer->log(i);
+    }
+
+    event_journal_record records[kCapacity];
+    size_t lost = 0;
+    const ssize_t actual = reader->read(records, kCapacity, &lost);
+    ASSERT_GT(actual, 0);
+    EXPECT_EQ((size_t) kEvents, lost + actual);
+    // the survivors are the newest records, contiguous up to the last one logged
+    for (ssize_t i = 0; i < actual; i++) {
+        EXPECT_EQ(kEvents - actual + i, (ssize_t) records[i].sequence);
+    }
+}
+
+TEST(audio_utils_event_journal, cross_process)
+{
+    constexpr uint32_t kEvents = 50;
+    EventJournalWriter *writer;
+    ASSERT_EQ(0, EventJournalWriter::create(128, &writer));
+    std::unique_ptr<EventJournalWriter> writerDeleter(writer);
+
+    const pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        // child: log through the inherited mapping, then exit
+        for (uint32_t i = 0; i < kEvents; i++) {
+            writer->log(i, &i, sizeof(i));
+        }
+        _exit(0);
+    }
+    int status;
+    ASSERT_EQ(pid, waitpid(pid, &status, 0));
+    ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    EventJournalReader *reader;
+    ASSERT_EQ(0, EventJournalReader::attach(writer->fd(), &reader));
+    std::unique_ptr<EventJournalReader> readerDeleter(reader);
+    event_journal_record records[kEvents];
+    size_t lost = 0;
+    ASSERT_EQ((ssize_t) kEvents, reader->read(records, kEvents, &lost));
+    EXPECT_EQ((size_t) 0, lost);
+    for (uint32_t i = 0; i < kEvents; i++) {
+        EXPECT_EQ(i, records[i].id);
+        EXPECT_EQ(i, records[i].sequence);
+    }
+}
+
+TEST(audio_utils_event_journal, merged_dump)
+{
+    constexpr uint32_t kEventsPerJournal = 20;
+    EventJournalWriter *writers[2];
+    EventJournalReader *readers[2];
+    for (size_t i = 0; i < 2; i++) {
+        ASSERT_EQ(0, EventJournalWriter::create(64, &writers[i]));
+        ASSERT_EQ(0, EventJournalReader::attach(writers[i]->fd(), &readers[i]));
+    }
+    // interleave the two journals in time
+    for (uint32_t i = 0; i < kEventsPerJournal; i++) {
+        writers[0]->log(i);
+        writers[1]->log(i);
+    }
+
+    const int fd = memfd_create("event_journal_dump", 0);
+    ASSERT_GE(fd, 0);
+    const char *tags[2] = {"first", "second"};
+    dumpMergedEventJournals(fd, readers, tags, 2);
+
+    const off_t size = lseek(fd, 0, SEEK_CUR);
+    ASSERT_GT(size, 0);
+    std::string dump((size_t) size, '\0');
+    ASSERT_EQ((ssize_t) size, pread(fd, &dump[0], (size_t) size, 0));
+    (void) close(fd);
+
+    // one line per event, globally sorted by timestamp
+    size_t lines = 0;
+    double previousTime = 0.;
+    size_t pos = 0;
+    while (pos < dump.size()) {
+        const size_t end = dump.find('\n', pos);
+        ASSERT_NE(std::string::npos, end);
+        const std::string line = dump.substr(pos, end - pos);
+        double time;
+        ASSERT_EQ(1, sscanf(line.c_str(), "%lf", &time)) << line;
+        EXPECT_LE(previousTime, time);
+        previousTime = time;
+        EXPECT_TRUE(line.find("first") != std::string::npos ||
+                line.find("second") != std::string::npos) << line;
+        lines++;
+        pos = end + 1;
+    }
+    EXPECT_EQ((size_t) (2 * kEventsPerJournal), lines);
+
+    for (size_t i = 0; i < 2; i++) {
+        delete readers[i];
+        delete writers[i];
+    }
+}
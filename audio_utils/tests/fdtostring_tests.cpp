@@ -38,6 +38,65 @@ TEST(audio_utils_fdtostring, basic) {
     ASSERT_EQ((PREFIX + TEST_STRING), result);
 }
 
+TEST(audio_utils_fdtostring, service) {
+    const std::string PREFIX{"aa "};
+    const std::string TEST_STRING1{"hello world\n"};
+    const std::string TEST_STRING2{"goodbye\n"};
+
+    FdToStringService service;
+
+    // captures may be open concurrently.
+    auto capture1 = service.createCapture(PREFIX);
+    auto capture2 = service.createCapture(PREFIX);
+    ASSERT_NE(nullptr, capture1);
+    ASSERT_NE(nullptr, capture2);
+    ASSERT_TRUE(capture1->fd() >= 0);
+    ASSERT_TRUE(capture2->fd() >= 0);
+
+    write(capture1->fd(), TEST_STRING1.c_str(), TEST_STRING1.size());
+    write(capture2->fd(), TEST_STRING2.c_str(), TEST_STRING2.size());
+    write(capture1->fd(), TEST_STRING2.c_str(), TEST_STRING2.size());
+
+    ASSERT_EQ((PREFIX + TEST_STRING1 + PREFIX + TEST_STRING2), capture1->getStringAndClose());
+    ASSERT_EQ((PREFIX + TEST_STRING2), capture2->getStringAndClose());
+
+    // the service is reusable after captures complete.
+    auto capture3 = service.createCapture(PREFIX);
+    ASSERT_NE(nullptr, capture3);
+    write(capture3->fd(), TEST_STRING1.c_str(), TEST_STRING1.size());
+    ASSERT_EQ((PREFIX + TEST_STRING1), capture3->getStringAndClose());
+}
+
+TEST(audio_utils_fdtostring, aggregate_dumps) {
+    const std::string PREFIX{"aa "};
+    constexpr size_t kWriters = 12;
+
+    FdToStringService service;
+
+    std::vector<std::function<void(int)>> writers;
+    std::string expected;
+    for (size_t i = 0; i < kWriters; ++i) {
+        const std::string line = "track " + std::to_string(i) + "\n";
+        expected += PREFIX + line;
+        writers.emplace_back([line, i](int fd) {
+            // scramble completion order: later writers finish first.
+            std::this_thread::sleep_for(
+                    std::chrono::milliseconds((kWriters - i) % 4));
+            write(fd, line.c_str(), line.size());
+        });
+    }
+
+    // segments come back in writer order, not completion order.
+    ASSERT_EQ(expected, service.aggregateDumps(writers, PREFIX, 10'000));
+
+    // the service is reusable, including for single captures.
+    auto capture = service.createCapture(PREFIX);
+    ASSERT_NE(nullptr, capture);
+    const std::string TEST_STRING{"hello world\n"};
+    write(capture->fd(), TEST_STRING.c_str(), TEST_STRING.size());
+    ASSERT_EQ((PREFIX + TEST_STRING), capture->getStringAndClose());
+}
+
 TEST(audio_utils_fdtostring, multilines) {
     const std::string PREFIX{"aa "};
     const std::string DELIM{"\n"};
@@ -56,3 +115,63 @@ TEST(audio_utils_fdtostring, multilines) {
 
     ASSERT_EQ((PREFIX + TEST_STRING1 + PREFIX + DELIM + PREFIX + TEST_STRING2), result);
 }
+
+TEST(audio_utils_fdtostring, memfd_capture) {
+    const std::string TEST_STRING{"hello zero copy world\n"};
+
+    FdToMemfd capture(1 << 16, 10'000 /* timeoutMs */);
+    const int fd = capture.fd();
+    ASSERT_TRUE(fd >= 0);
+
+    write(fd, TEST_STRING.c_str(), TEST_STRING.size());
+
+    std::string result;
+    size_t chunks = 0;
+    const ssize_t total = capture.visitAndClose([&](std::string_view chunk) {
+        result += chunk;
+        ++chunks;
+    });
+
+    ASSERT_EQ((ssize_t)TEST_STRING.size(), total);
+    ASSERT_EQ(TEST_STRING, result);
+    ASSERT_EQ((size_t)1, chunks);  // no wrap: a single chunk.
+}
+
+TEST(audio_utils_fdtostring, memfd_ring_wrap) {
+    constexpr size_t capacity = 4096;
+    constexpr size_t total = 3 * capacity + 123;  // wraps, ending mid-ring.
+    const auto pattern = [](size_t i) { return (char)('a' + i % 26); };
+
+    FdToMemfd capture(capacity, 10'000 /* timeoutMs */);
+    const int fd = capture.fd();
+    ASSERT_TRUE(fd >= 0);
+
+    // more than a pipe's worth: write from a thread while the splicer drains.
+    std::thread writer([&] {
+        std::string data(total, '\0');
+        for (size_t i = 0; i < total; ++i) {
+            data[i] = pattern(i);
+        }
+        size_t written = 0;
+        while (written < total) {
+            const ssize_t actual = write(fd, data.data() + written, total - written);
+            ASSERT_GT(actual, 0);
+            written += actual;
+        }
+    });
+    writer.join();
+
+    std::string result;
+    size_t chunks = 0;
+    const ssize_t produced = capture.visitAndClose([&](std::string_view chunk) {
+        result += chunk;
+        ++chunks;
+    });
+
+    ASSERT_EQ((ssize_t)total, produced);
+    ASSERT_EQ(capacity, result.size());  // only the newest ring's worth retained.
+    ASSERT_LE(chunks, (size_t)2);
+    for (size_t i = 0; i < capacity; ++i) {
+        ASSERT_EQ(pattern(total - capacity + i), result[i]) << "index " << i;
+    }
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <condition_variable>
+#include <limits.h>
+#include <mutex>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <audio_utils/fifo_async.h>
+
+TEST(audio_utils_fifo_async, single_reader) {
+    constexpr uint32_t kFrameCount = 256;
+    constexpr size_t kMinFrames = 16;
+    constexpr int32_t kTotalFrames = 1024;
+
+    std::vector<int32_t> buffer(kFrameCount);
+    audio_utils_fifo fifo(kFrameCount, sizeof(int32_t), buffer.data(),
+            true /* throttlesWriter */, AUDIO_UTILS_FIFO_SYNC_PRIVATE);
+    audio_utils_fifo_writer writer(fifo);
+    audio_utils_fifo_reader reader(fifo, true /* throttlesWriter */);
+
+    std::mutex lock;
+    std::condition_variable cv;
+    std::vector<int32_t> received;
+
+    audio_utils_fifo_async_service service(1000000 /* pollNs */);
+    const int handle = service.registerReader(reader, kMinFrames,
+            [&](audio_utils_fifo_reader &r, ssize_t available) {
+                ASSERT_GE(available, (ssize_t) kMinFrames);
+                int32_t frames[kFrameCount];
+                const ssize_t actual = r.read(frames, available);
+                ASSERT_EQ(available, actual);
+                std::lock_guard<std::mutex> guard(lock);
+                received.insert(received.end(), frames, frames + actual);
+                cv.notify_all();
+            });
+    ASSERT_GT(handle, 0);
+
+    // a blocking writer paired with the async reader exercises throttling.
+    const struct timespec infinity = { LONG_MAX, 0 };
+    for (int32_t i = 0; i < kTotalFrames; ) {
+        int32_t frames[48];
+        size_t count = std::min((size_t) 48, (size_t) (kTotalFrames - i));
+        for (size_t j = 0; j < count; j++) frames[j] = i + (int32_t) j;
+        const ssize_t written = writer.write(frames, count, &infinity);
+        ASSERT_GT(written, 0);
+        i += written;
+    }
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        ASSERT_TRUE(cv.wait_for(guard, std::chrono::seconds(10),
+                [&] { return received.size() >= (size_t) kTotalFrames - kMinFrames + 1; }));
+    }
+    service.unregisterReader(handle);
+
+    std::lock_guard<std::mutex> guard(lock);
+    for (size_t i = 0; i < received.size(); i++) {
+        ASSERT_EQ((int32_t) i, received[i]);
+    }
+}
+
+TEST(audio_utils_fifo_async, multiple_readers) {
+    constexpr uint32_t kFrameCount = 64;
+    constexpr size_t kFifoCount = 8;
+    constexpr int32_t kFramesPerFifo = 256;
+
+    struct Stream {
+        std::vector<int32_t> buffer = std::vector<int32_t>(kFrameCount);
+        std::unique_ptr<audio_utils_fifo> fifo;
+        std::unique_ptr<audio_utils_fifo_writer> writer;
+        std::unique_ptr<audio_utils_fifo_reader> reader;
+        std::vector<int32_t> received;
+    };
+    std::vector<Stream> streams(kFifoCount);
+    std::mutex lock;
+    std::condition_variable cv;
+
+    // one service thread drains all the streams.
+    audio_utils_fifo_async_service service(1000000 /* pollNs */);
+    std::vector<int> handles;
+    for (auto& stream : streams) {
+        stream.fifo = std::make_unique<audio_utils_fifo>(kFrameCount, sizeof(int32_t),
+                stream.buffer.data(), true /* throttlesWriter */, AUDIO_UTILS_FIFO_SYNC_PRIVATE);
+        stream.writer = std::make_unique<audio_utils_fifo_writer>(*stream.fifo);
+        stream.reader = std::make_unique<audio_utils_fifo_reader>(*stream.fifo, true);
+        handles.push_back(service.registerReader(*stream.reader, 1 /* minFrames */,
+                [&lock, &cv, s = &stream](audio_utils_fifo_reader &r, ssize_t available) {
+                    int32_t frames[kFrameCount];
+                    const ssize_t actual = r.read(frames, available);
+                    ASSERT_GT(actual, 0);
+                    std::lock_guard<std::mutex> guard(lock);
+                    s->received.insert(s->received.end(), frames, frames + actual);
+                    cv.notify_all();
+                }));
+    }
+
+    const struct timespec infinity = { LONG_MAX, 0 };
+    for (int32_t i = 0; i < kFramesPerFifo; i++) {
+        for (auto& stream : streams) {
+            ASSERT_EQ((ssize_t) 1, stream.writer->write(&i, 1, &infinity));
+        }
+    }
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        ASSERT_TRUE(cv.wait_for(guard, std::chrono::seconds(10), [&] {
+            for (const auto& stream : streams) {
+                if (stream.received.size() != (size_t) kFramesPerFifo) return false;
+            }
+            return true;
+        }));
+    }
+    for (int handle : handles) {
+        service.unregisterReader(handle);
+    }
+    for (const auto& stream : streams) {
+        for (int32_t i = 0; i < kFramesPerFifo; i++) {
+            ASSERT_EQ(i, stream.received[i]);
+        }
+    }
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <audio_utils/fifo.h>
+
+TEST(audio_utils_fifo_flush, flush_requested) {
+    constexpr uint32_t kFrameCount = 4;
+
+    std::vector<int32_t> buffer(kFrameCount);
+    audio_utils_fifo fifo(kFrameCount, sizeof(int32_t), buffer.data(),
+            true /* throttlesWriter */, AUDIO_UTILS_FIFO_SYNC_PRIVATE);
+    audio_utils_fifo_writer writer(fifo);
+    audio_utils_fifo_reader reader(fifo, true /* throttlesWriter */);
+
+    // no flush yet.
+    EXPECT_FALSE(writer.flushRequested());
+
+    const int32_t frames[kFrameCount] = {};
+    ASSERT_EQ((ssize_t) kFrameCount, writer.write(frames, kFrameCount));
+    EXPECT_EQ((ssize_t) kFrameCount, reader.flush());
+    EXPECT_EQ((uint64_t) kFrameCount, reader.totalFlushed());
+
+    // the poll consumes the indication.
+    EXPECT_TRUE(writer.flushRequested());
+    EXPECT_FALSE(writer.flushRequested());
+
+    // a flush of an empty FIFO still signals the writer: the point is to
+    // discard the writer's stale upstream data, not just buffered frames.
+    EXPECT_EQ((ssize_t) 0, reader.flush());
+    EXPECT_TRUE(writer.flushRequested());
+
+    // two flushes between polls coalesce into one indication.
+    ASSERT_EQ((ssize_t) kFrameCount, writer.write(frames, kFrameCount));
+    EXPECT_EQ((ssize_t) kFrameCount, reader.flush());
+    EXPECT_EQ((ssize_t) 0, reader.flush());
+    EXPECT_TRUE(writer.flushRequested());
+    EXPECT_FALSE(writer.flushRequested());
+
+    // after a flush the writer has the whole buffer available again.
+    EXPECT_EQ((ssize_t) kFrameCount, writer.available());
+}
+
+TEST(audio_utils_fifo_flush, non_throttling_reader_does_not_signal) {
+    constexpr uint32_t kFrameCount = 4;
+
+    std::vector<int32_t> buffer(kFrameCount);
+    audio_utils_fifo fifo(kFrameCount, sizeof(int32_t), buffer.data(),
+            true /* throttlesWriter */, AUDIO_UTILS_FIFO_SYNC_PRIVATE);
+    audio_utils_fifo_writer writer(fifo);
+    audio_utils_fifo_reader reader(fifo, true /* throttlesWriter */);
+    audio_utils_fifo_reader observer(fifo, false /* throttlesWriter */);
+
+    const int32_t frames[kFrameCount] = {};
+    ASSERT_EQ((ssize_t) kFrameCount, writer.write(frames, kFrameCount));
+
+    // only the throttling reader's flush is a restart request to the writer.
+    EXPECT_EQ((ssize_t) kFrameCount, observer.flush());
+    EXPECT_FALSE(writer.flushRequested());
+
+    EXPECT_EQ((ssize_t) kFrameCount, reader.flush());
+    EXPECT_TRUE(writer.flushRequested());
+}
+
+TEST(audio_utils_fifo_flush, no_epoch_cell) {
+    constexpr uint32_t kFrameCount = 4;
+
+    // Multi-process style constructor without a flush epoch cell:
+    // flush works as before and flushRequested() never fires.
+    std::vector<int32_t> buffer(kFrameCount);
+    audio_utils_fifo_index writerRear;
+    audio_utils_fifo_index throttleFront;
+    audio_utils_fifo fifo(kFrameCount, sizeof(int32_t), buffer.data(),
+            writerRear, &throttleFront);
+    audio_utils_fifo_writer writer(fifo);
+    audio_utils_fifo_reader reader(fifo, true /* throttlesWriter */);
+
+    const int32_t frames[kFrameCount] = {};
+    ASSERT_EQ((ssize_t) kFrameCount, writer.write(frames, kFrameCount));
+    EXPECT_EQ((ssize_t) kFrameCount, reader.flush());
+    EXPECT_FALSE(writer.flushRequested());
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <audio_utils/fifo.h>
+
+TEST(audio_utils_fifo_integrity, disabled_by_default) {
+    constexpr uint32_t kFrameCount = 4;
+
+    std::vector<int32_t> buffer(kFrameCount);
+    audio_utils_fifo fifo(kFrameCount, sizeof(int32_t), buffer.data());
+    audio_utils_fifo_writer writer(fifo);
+    audio_utils_fifo_reader reader(fifo);
+
+    const int32_t frames[kFrameCount] = { 10, 20, 30, 40 };
+    int32_t readback[kFrameCount];
+    ASSERT_EQ((ssize_t) kFrameCount, writer.write(frames, kFrameCount));
+    ASSERT_EQ((ssize_t) kFrameCount, reader.read(readback, kFrameCount));
+
+    const audio_utils_fifo_integrity_stats stats = reader.integrityStats();
+    EXPECT_EQ((uint64_t) 0, stats.framesChecked);
+    EXPECT_EQ((uint64_t) 0, stats.crcErrors);
+    EXPECT_EQ((uint64_t) 0, stats.sequenceErrors);
+}
+
+TEST(audio_utils_fifo_integrity, clean_round_trip) {
+    constexpr uint32_t kFrameCount = 4;
+
+    std::vector<int32_t> buffer(kFrameCount);
+    std::vector<audio_utils_fifo_integrity_tag> tags(kFrameCount);
+    audio_utils_fifo fifo(kFrameCount, sizeof(int32_t), buffer.data());
+    fifo.enableIntegrity(tags.data());
+    audio_utils_fifo_writer writer(fifo);
+    audio_utils_fifo_reader reader(fifo);
+
+    // two transfers of 3 frames in a FIFO of 4, so the second one wraps.
+    const int32_t frames[3] = { 10, 20, 30 };
+    for (int pass = 0; pass < 2; pass++) {
+        int32_t readback[3] = {};
+        ASSERT_EQ((ssize_t) 3, writer.write(frames, 3));
+        ASSERT_EQ((ssize_t) 3, reader.read(readback, 3));
+        EXPECT_EQ(0, memcmp(frames, readback, sizeof(frames)));
+    }
+
+    const audio_utils_fifo_integrity_stats stats = reader.integrityStats();
+    EXPECT_EQ((uint64_t) 6, stats.framesChecked);
+    EXPECT_EQ((uint64_t) 0, stats.crcErrors);
+    EXPECT_EQ((uint64_t) 0, stats.sequenceErrors);
+}
+
+TEST(audio_utils_fifo_integrity, non_pow2_misaligned_batches) {
+    // A non-power-of-2 frame count has a nonzero fudge factor: the index space
+    // skips indices at the buffer wrap, so frame sequence numbers are not
+    // contiguous across it.  Use batch sizes that make the reader and writer
+    // wrap at different points, which a linear per-frame sequence would flag
+    // as corrupt even on clean data.
+    constexpr uint32_t kFrameCount = 6;
+
+    std::vector<int32_t> buffer(kFrameCount);
+    std::vector<audio_utils_fifo_integrity_tag> tags(kFrameCount);
+    audio_utils_fifo fifo(kFrameCount, sizeof(int32_t), buffer.data());
+    fifo.enableIntegrity(tags.data());
+    audio_utils_fifo_writer writer(fifo);
+    audio_utils_fifo_reader reader(fifo);
+
+    const int32_t frames[kFrameCount] = { 10, 20, 30, 40, 50, 60 };
+    int32_t readback[kFrameCount] = {};
+
+    // prologue: leave the indices 4 frames into the buffer, so the full-size
+    // writes below straddle the wrap instead of realigning to offset 0.
+    ASSERT_EQ((ssize_t) 4, writer.write(frames, 4));
+    ASSERT_EQ((ssize_t) 4, reader.read(readback, 4));
+    uint64_t expectedChecked = 4;
+
+    for (int pass = 0; pass < 3; pass++) {
+        memset(readback, 0, sizeof(readback));
+        ASSERT_EQ((ssize_t) kFrameCount, writer.write(frames, kFrameCount));
+        // drain in 2 + 4: the writer wrapped two frames into its batch, the
+        // reader wraps between its batches.
+        ASSERT_EQ((ssize_t) 2, reader.read(readback, 2));
+        ASSERT_EQ((ssize_t) 4, reader.read(readback + 2, 4));
+        EXPECT_EQ(0, memcmp(frames, readback, sizeof(frames)));
+        expectedChecked += kFrameCount;
+    }
+
+    const audio_utils_fifo_integrity_stats stats = reader.integrityStats();
+    EXPECT_EQ(expectedChecked, stats.framesChecked);
+    EXPECT_EQ((uint64_t) 0, stats.crcErrors);
+    EXPECT_EQ((uint64_t) 0, stats.sequenceErrors);
+}
+
+TEST(audio_utils_fifo_integrity, detects_payload_corruption) {
+    constexpr uint32_t kFrameCount = 4;
+
+    std::vector<int32_t> buffer(kFrameCount);
+    std::vector<audio_utils_fifo_integrity_tag> tags(kFrameCount);
+    audio_utils_fifo fifo(kFrameCount, sizeof(int32_t), buffer.data());
+    fifo.enableIntegrity(tags.data());
+    audio_utils_fifo_writer writer(fifo);
+    audio_utils_fifo_reader reader(fifo);
+
+    const int32_t frames[kFrameCount] = { 10, 20, 30, 40 };
+    ASSERT_EQ((ssize_t) kFrameCount, writer.write(frames, kFrameCount));
+
+    // a misbehaving process scribbles on one frame of the shared buffer.
+    buffer[2] ^= 1;
+
+    int32_t readback[kFrameCount];
+    ASSERT_EQ((ssize_t) kFrameCount, reader.read(readback, kFrameCount));
+
+    const audio_utils_fifo_integrity_stats stats = reader.integrityStats();
+    EXPECT_EQ((uint64_t) kFrameCount, stats.framesChecked);
+    EXPECT_EQ((uint64_t) 1, stats.crcErrors);
+    EXPECT_EQ((uint64_t) 0, stats.sequenceErrors);
+}
+
+TEST(audio_utils_fifo_integrity, detects_tag_corruption) {
+    constexpr uint32_t kFrameCount = 4;
+
+    std::vector<int32_t> buffer(kFrameCount);
+    std::vector<audio_utils_fifo_integrity_tag> tags(kFrameCount);
+    audio_utils_fifo fifo(kFrameCount, sizeof(int32_t), buffer.data());
+    fifo.enableIntegrity(tags.data());
+    audio_utils_fifo_writer writer(fifo);
+    audio_utils_fifo_reader reader(fifo);
+
+    const int32_t frames[kFrameCount] = { 10, 20, 30, 40 };
+    ASSERT_EQ((ssize_t) kFrameCount, writer.write(frames, kFrameCount));
+
+    // a clobbered sequence looks like a stale frame from a previous lap.
+    tags[1].mSequence ^= 0x80000000;
+
+    int32_t readback[kFrameCount];
+    ASSERT_EQ((ssize_t) kFrameCount, reader.read(readback, kFrameCount));
+
+    const audio_utils_fifo_integrity_stats stats = reader.integrityStats();
+    EXPECT_EQ((uint64_t) kFrameCount, stats.framesChecked);
+    EXPECT_EQ((uint64_t) 0, stats.crcErrors);
+    EXPECT_EQ((uint64_t) 1, stats.sequenceErrors);
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2024 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <audio_utils/fifo.h>
+#include <audio_utils/fifo_pool.h>
+
+TEST(audio_utils_fifo_pool, acquire_release) {
+    constexpr size_t kBufferCount = 2;
+    constexpr size_t kCapacityBytes = 65536;
+    const size_t pageSize = (size_t) sysconf(_SC_PAGESIZE);
+
+    audio_utils_fifo_pool pool(kBufferCount, kCapacityBytes);
+    ASSERT_GE(pool.capacityBytes(), kCapacityBytes);
+    ASSERT_EQ((size_t) 0, pool.capacityBytes() % pageSize);
+    ASSERT_EQ(kBufferCount, pool.available());
+
+    audio_utils_fifo_pool_buffer *buffer1 = pool.acquire();
+    ASSERT_NE(nullptr, buffer1);
+    ASSERT_EQ((uintptr_t) 0, (uintptr_t) buffer1->mBuffer % pageSize);
+    ASSERT_NE(nullptr, buffer1->mWriterRear);
+    ASSERT_NE(nullptr, buffer1->mThrottleFront);
+    ASSERT_EQ(kBufferCount - 1, pool.available());
+
+    // the pool grows on demand once the preallocated slots are in use.
+    audio_utils_fifo_pool_buffer *buffer2 = pool.acquire();
+    audio_utils_fifo_pool_buffer *buffer3 = pool.acquire();
+    ASSERT_NE(nullptr, buffer2);
+    ASSERT_NE(nullptr, buffer3);
+    ASSERT_EQ((size_t) 0, pool.available());
+
+    // a released buffer is recycled LIFO.
+    pool.release(buffer3);
+    ASSERT_EQ((size_t) 1, pool.available());
+    ASSERT_EQ(buffer3, pool.acquire());
+
+    pool.release(buffer1);
+    pool.release(buffer2);
+    pool.release(buffer3);
+    ASSERT_EQ(kBufferCount + 1, pool.available());
+}
+
+TEST(audio_utils_fifo_pool, fifo_transfer) {
+    constexpr size_t kCapacityBytes = 4096;
+    constexpr uint32_t kFrameSize = sizeof(int16_t);
+
+    audio_utils_fifo_pool pool(1 /* bufferCount */, kCapacityBytes);
+    audio_utils_fifo_pool_buffer *buffer = pool.acquire();
+    ASSERT_NE(nullptr, buffer);
+    const uint32_t frameCount = pool.capacityBytes() / kFrameSize;
+
+    // the pooled buffer and indices serve the multi-process style constructor.
+    {
+        audio_utils_fifo fifo(frameCount, kFrameSize, buffer->mBuffer,
+                *buffer->mWriterRear, buffer->mThrottleFront);
+        audio_utils_fifo_writer writer(fifo);
+        audio_utils_fifo_reader reader(fifo, true /* throttlesWriter */);
+
+        const int16_t source[4] = { 1, 2, 3, 4 };
+        int16_t dest[4] = {};
+        ASSERT_EQ((ssize_t) 4, writer.write(source, 4));
+        ASSERT_EQ((ssize_t) 4, reader.read(dest, 4));
+        ASSERT_EQ(0, memcmp(source, dest, sizeof(source)));
+    }
+    pool.release(buffer);
+
+    // recycled indices are freshly constructed: a new FIFO starts empty.
+    buffer = pool.acquire();
+    ASSERT_NE(nullptr, buffer);
+    {
+        audio_utils_fifo fifo(frameCount, kFrameSize, buffer->mBuffer,
+                *buffer->mWriterRear, buffer->mThrottleFront);
+        ASSERT_EQ((uint32_t) 0, buffer->mWriterRear->loadSingleThreaded());
+        audio_utils_fifo_reader reader(fifo, true /* throttlesWriter */);
+        int16_t dest[4];
+        ASSERT_EQ((ssize_t) 0, reader.read(dest, 4, NULL /* timeout */));
+    }
+    pool.release(buffer);
+}
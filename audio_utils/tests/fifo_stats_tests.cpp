@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <audio_utils/Histogram.h>
+#include <audio_utils/fifo.h>
+
+TEST(audio_utils_fifo_stats, reader_wait) {
+    constexpr uint32_t kFrameCount = 4;
+    constexpr int64_t kTimeoutNs = 10000000;    // 10 ms
+
+    std::vector<int32_t> buffer(kFrameCount);
+    audio_utils_fifo fifo(kFrameCount, sizeof(int32_t), buffer.data(),
+            true /* throttlesWriter */, AUDIO_UTILS_FIFO_SYNC_PRIVATE);
+    audio_utils_fifo_writer writer(fifo);
+    audio_utils_fifo_reader reader(fifo, true /* throttlesWriter */);
+
+    // no waits yet, and the histogram is off by default.
+    audio_utils_fifo_wait_stats stats = reader.waitStats();
+    EXPECT_EQ((uint64_t) 0, stats.waits);
+    EXPECT_EQ((int64_t) 0, stats.totalNs);
+    EXPECT_EQ((int64_t) 0, stats.maxNs);
+    EXPECT_EQ(nullptr, reader.waitHistogram());
+
+    reader.enableWaitHistogram();
+
+    // an empty FIFO makes the reader block until the timeout expires.
+    const struct timespec timeout = { 0, kTimeoutNs };
+    audio_utils_iovec iovec[2];
+    EXPECT_EQ(-ETIMEDOUT, reader.obtain(iovec, kFrameCount, &timeout));
+
+    stats = reader.waitStats();
+    EXPECT_EQ((uint64_t) 1, stats.waits);
+    EXPECT_GE(stats.totalNs, kTimeoutNs);
+    EXPECT_EQ(stats.totalNs, stats.maxNs);
+    ASSERT_NE(nullptr, reader.waitHistogram());
+    EXPECT_EQ((uint64_t) 1, reader.waitHistogram()->getCount());
+
+    // the writer never blocked.
+    stats = writer.waitStats();
+    EXPECT_EQ((uint64_t) 0, stats.waits);
+}
+
+TEST(audio_utils_fifo_stats, writer_wait) {
+    constexpr uint32_t kFrameCount = 4;
+    constexpr int64_t kTimeoutNs = 10000000;    // 10 ms
+
+    std::vector<int32_t> buffer(kFrameCount);
+    audio_utils_fifo fifo(kFrameCount, sizeof(int32_t), buffer.data(),
+            true /* throttlesWriter */, AUDIO_UTILS_FIFO_SYNC_PRIVATE);
+    audio_utils_fifo_writer writer(fifo);
+    audio_utils_fifo_reader reader(fifo, true /* throttlesWriter */);
+    writer.enableWaitHistogram();
+
+    // fill the FIFO so the throttled writer blocks until the timeout expires.
+    const int32_t frames[kFrameCount] = {};
+    ASSERT_EQ((ssize_t) kFrameCount, writer.write(frames, kFrameCount));
+    const struct timespec timeout = { 0, kTimeoutNs };
+    EXPECT_EQ(-ETIMEDOUT, writer.write(frames, kFrameCount, &timeout));
+
+    const audio_utils_fifo_wait_stats stats = writer.waitStats();
+    EXPECT_EQ((uint64_t) 1, stats.waits);
+    EXPECT_GE(stats.totalNs, kTimeoutNs);
+    ASSERT_NE(nullptr, writer.waitHistogram());
+    EXPECT_EQ((uint64_t) 1, writer.waitHistogram()->getCount());
+
+    // draining and refilling does not block, so the stats are unchanged.
+    int32_t readBack[kFrameCount];
+    ASSERT_EQ((ssize_t) kFrameCount, reader.read(readBack, kFrameCount));
+    ASSERT_EQ((ssize_t) kFrameCount, writer.write(frames, kFrameCount));
+    EXPECT_EQ((uint64_t) 1, writer.waitStats().waits);
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+
+#include <gtest/gtest.h>
+
+#include <audio_utils/fifo.h>
+#include <audio_utils/fifo_writer_T.h>
+
+TEST(audio_utils_fifo_writer_T, ExplicitCommit)
+{
+    constexpr uint32_t kFrameCount = 16;
+    int32_t buffer[kFrameCount];
+    audio_utils_fifo fifo(kFrameCount, sizeof(int32_t), buffer, false /* throttlesWriter */);
+    audio_utils_fifo_writer32 writer(fifo);
+    audio_utils_fifo_reader reader(fifo, false /* throttlesWriter */);
+
+    // without a batch size, nothing is observable until the caller commits
+    writer.write1(42);
+    int32_t in[kFrameCount];
+    EXPECT_EQ((ssize_t) 0, reader.read(in, kFrameCount));
+    writer.storeRelease();
+    ASSERT_EQ((ssize_t) 1, reader.read(in, kFrameCount));
+    EXPECT_EQ(42, in[0]);
+}
+
+TEST(audio_utils_fifo_writer_T, BatchedWrite1)
+{
+    constexpr uint32_t kFrameCount = 16;
+    int32_t buffer[kFrameCount];
+    audio_utils_fifo fifo(kFrameCount, sizeof(int32_t), buffer, false /* throttlesWriter */);
+    audio_utils_fifo_writer32 writer(fifo);
+    audio_utils_fifo_reader reader(fifo, false /* throttlesWriter */);
+
+    writer.setBatchFrames(4);
+    int32_t in[kFrameCount];
+    for (int32_t i = 0; i < 3; i++) {
+        writer.write1(i);
+        // a partial batch is not yet published
+        EXPECT_EQ((ssize_t) 0, reader.read(in, kFrameCount));
+    }
+    writer.write1(3);
+    ASSERT_EQ((ssize_t) 4, reader.read(in, kFrameCount));
+    for (int32_t i = 0; i < 4; i++) {
+        EXPECT_EQ(i, in[i]);
+    }
+
+    // an explicit commit flushes a partial batch and restarts the count
+    writer.write1(100);
+    EXPECT_EQ((ssize_t) 0, reader.read(in, kFrameCount));
+    writer.storeRelease();
+    ASSERT_EQ((ssize_t) 1, reader.read(in, kFrameCount));
+    EXPECT_EQ(100, in[0]);
+    for (int32_t i = 0; i < 3; i++) {
+        writer.write1(i);
+        EXPECT_EQ((ssize_t) 0, reader.read(in, kFrameCount));
+    }
+    writer.write1(3);
+    EXPECT_EQ((ssize_t) 4, reader.read(in, kFrameCount));
+}
+
+TEST(audio_utils_fifo_writer_T, BatchedBulkWrite)
+{
+    constexpr uint32_t kFrameCount = 16;
+    int32_t buffer[kFrameCount];
+    audio_utils_fifo fifo(kFrameCount, sizeof(int32_t), buffer, false /* throttlesWriter */);
+    audio_utils_fifo_writer32 writer(fifo);
+    audio_utils_fifo_reader reader(fifo, false /* throttlesWriter */);
+
+    writer.setBatchFrames(4);
+    const int32_t out[6] = {0, 1, 2, 3, 4, 5};
+    int32_t in[kFrameCount];
+
+    // a bulk write short of the batch stays pending
+    writer.write(out, 2);
+    EXPECT_EQ((ssize_t) 0, reader.read(in, kFrameCount));
+    // crossing the batch boundary publishes everything accumulated
+    writer.write(out, 6);
+    ASSERT_EQ((ssize_t) 8, reader.read(in, kFrameCount));
+    EXPECT_EQ(0, in[0]);
+    EXPECT_EQ(1, in[1]);
+    for (int32_t i = 0; i < 6; i++) {
+        EXPECT_EQ(i, in[2 + i]);
+    }
+}
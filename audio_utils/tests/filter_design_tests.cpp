@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "audio_utils_filter_design_tests"
+
+#include <array>
+#include <cmath>
+#include <complex>
+
+#include <audio_utils/FilterDesign.h>
+#include <gtest/gtest.h>
+
+using namespace android::audio_utils;
+
+// all designs are usable in constant expressions
+static constexpr auto kConstexprLowpass = biquadLowpass(1000. / 48000.);
+static constexpr auto kConstexprPeaking = biquadPeaking(0.05, 2., 6.);
+static constexpr auto kConstexprShelf = biquadLowShelf<float>(0.01, -12.);
+static_assert(kConstexprLowpass[0] > 0.);
+static_assert(kConstexprPeaking[0] > 1.);  // boost raises b0 above unity
+static_assert(kConstexprShelf.size() == 5);
+
+// libm reference implementation of the same cookbook forms
+static std::array<double, 5> refPeaking(double f, double Q, double gainDb) {
+    const double A = pow(10., gainDb / 40.);
+    const double w0 = 2. * M_PI * f;
+    const double alpha = sin(w0) / (2. * Q);
+    const double a0 = 1. + alpha / A;
+    return {(1. + alpha * A) / a0, -2. * cos(w0) / a0, (1. - alpha * A) / a0,
+            -2. * cos(w0) / a0, (1. - alpha / A) / a0};
+}
+
+// evaluate |H(e^jw)| for coefficients {b0, b1, b2, a1, a2}
+static double magnitude(const std::array<double, 5>& c, double f) {
+    const std::complex<double> z = std::polar(1., -2. * M_PI * f);
+    return std::abs((c[0] + c[1] * z + c[2] * z * z) / (1. + c[3] * z + c[4] * z * z));
+}
+
+TEST(audio_utils_filter_design, matches_libm_reference)
+{
+    // sweep parameter space and compare against the double-precision libm forms
+    for (double f : {0.001, 0.01, 0.1, 0.25, 0.45}) {
+        for (double Q : {0.5, kButterworthQ, 2., 8.}) {
+            for (double gainDb : {-18., -3., 0., 3., 18.}) {
+                const auto got = biquadPeaking(f, Q, gainDb);
+                const auto want = refPeaking(f, Q, gainDb);
+                for (size_t i = 0; i < 5; ++i) {
+                    EXPECT_NEAR(want[i], got[i], 1e-5)
+                            << "f=" << f << " Q=" << Q << " gainDb=" << gainDb << " i=" << i;
+                }
+            }
+        }
+    }
+}
+
+TEST(audio_utils_filter_design, lowpass_response)
+{
+    const auto c = biquadLowpass(0.05);
+    // unity at DC, -3 dB at the corner, strong rejection well above it
+    EXPECT_NEAR(1., magnitude(c, 0.), 1e-6);
+    EXPECT_NEAR(M_SQRT1_2, magnitude(c, 0.05), 1e-3);
+    EXPECT_LT(magnitude(c, 0.4), 0.02);
+}
+
+TEST(audio_utils_filter_design, highpass_response)
+{
+    const auto c = biquadHighpass(0.05);
+    EXPECT_LT(magnitude(c, 0.001), 0.001);
+    EXPECT_NEAR(M_SQRT1_2, magnitude(c, 0.05), 1e-3);
+    EXPECT_NEAR(1., magnitude(c, 0.45), 1e-3);
+}
+
+TEST(audio_utils_filter_design, peaking_response)
+{
+    const double gainDb = 7.5;
+    const auto c = biquadPeaking(0.1, 4., gainDb);
+    // full gain at the center, unity far away
+    EXPECT_NEAR(gainDb, 20. * log10(magnitude(c, 0.1)), 1e-3);
+    EXPECT_NEAR(0., 20. * log10(magnitude(c, 0.005)), 0.1);
+    EXPECT_NEAR(0., 20. * log10(magnitude(c, 0.49)), 0.1);
+}
+
+TEST(audio_utils_filter_design, shelf_response)
+{
+    const double gainDb = -10.;
+    const auto lo = biquadLowShelf(0.05, gainDb);
+    EXPECT_NEAR(gainDb, 20. * log10(magnitude(lo, 0.)), 1e-3);
+    EXPECT_NEAR(0., 20. * log10(magnitude(lo, 0.45)), 0.05);
+
+    const auto hi = biquadHighShelf(0.05, gainDb);
+    EXPECT_NEAR(0., 20. * log10(magnitude(hi, 0.001)), 0.05);
+    EXPECT_NEAR(gainDb, 20. * log10(magnitude(hi, 0.49)), 1e-2);
+}
+
+TEST(audio_utils_filter_design, zero_gain_is_identity)
+{
+    // a 0 dB peaking or shelf band must pass the signal unchanged
+    for (const auto& c : {biquadPeaking(0.1, 1., 0.), biquadLowShelf(0.1, 0.),
+            biquadHighShelf(0.1, 0.)}) {
+        EXPECT_NEAR(1., c[0], 1e-9);
+        EXPECT_NEAR(0., c[1] - c[3], 1e-9);
+        EXPECT_NEAR(0., c[2] - c[4], 1e-9);
+    }
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <array>
+#include <random>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <audio_utils/FilterBank.h>
+
+using ::testing::Pointwise;
+using ::testing::FloatNear;
+using namespace android::audio_utils;
+
+constexpr float EPS = 1e-5f;
+
+template <typename D>
+static std::array<D, kBiquadNumCoefs> randomFilter() {
+    static std::minstd_rand gen(42);
+    constexpr float amplitude = 0.9f;
+    std::uniform_real_distribution<> dis(-amplitude, amplitude);
+    const D p1 = (D)dis(gen);
+    const D p2 = (D)dis(gen);
+    return {(D)dis(gen), (D)dis(gen), (D)dis(gen), -(p1 + p2), p1 * p2};
+}
+
+template <typename D>
+static void randomBuffer(D *buffer, size_t sampleCount) {
+    static std::minstd_rand gen(42);
+    constexpr float amplitude = 1.0f;
+    std::uniform_real_distribution<> dis(-amplitude, amplitude);
+    for (size_t i = 0; i < sampleCount; ++i) {
+        buffer[i] = dis(gen);
+    }
+}
+
+// Each band of the FilterBank must match an independent single channel
+// BiquadFilter with the same coefficients, within float tolerance.
+template <size_t BANDS>
+static void testBankEquivalence() {
+    constexpr size_t TEST_FRAME_COUNT = 256;
+    std::array<std::array<float, kBiquadNumCoefs>, BANDS> coefs;
+    for (auto& coef : coefs) {
+        coef = randomFilter<float>();
+    }
+
+    std::vector<float> input(TEST_FRAME_COUNT);
+    randomBuffer(input.data(), TEST_FRAME_COUNT);
+
+    FilterBank<BANDS> bank(coefs);
+    std::vector<float> output(TEST_FRAME_COUNT * BANDS);
+    // process in two calls to verify the states carry across calls.
+    constexpr size_t SPLIT_FRAME = TEST_FRAME_COUNT / 2;
+    bank.process(output.data(), input.data(), SPLIT_FRAME);
+    bank.process(output.data() + SPLIT_FRAME * BANDS,
+            input.data() + SPLIT_FRAME, TEST_FRAME_COUNT - SPLIT_FRAME);
+
+    for (size_t band = 0; band < BANDS; ++band) {
+        BiquadFilter<float> reference(1 /* channelCount */, coefs[band]);
+        std::vector<float> expected(TEST_FRAME_COUNT);
+        reference.process(expected.data(), input.data(), TEST_FRAME_COUNT);
+
+        std::vector<float> actual(TEST_FRAME_COUNT);
+        for (size_t i = 0; i < TEST_FRAME_COUNT; ++i) {
+            actual[i] = output[i * BANDS + band];
+        }
+        EXPECT_THAT(actual, Pointwise(FloatNear(EPS), expected))
+                << "band " << band << " of " << BANDS;
+    }
+}
+
+TEST(FilterBankTest, Equivalence2) {
+    testBankEquivalence<2>();
+}
+
+TEST(FilterBankTest, Equivalence4) {
+    testBankEquivalence<4>();
+}
+
+TEST(FilterBankTest, Equivalence8) {
+    testBankEquivalence<8>();
+}
+
+TEST(FilterBankTest, Equivalence10) {
+    testBankEquivalence<10>();
+}
+
+TEST(FilterBankTest, Equivalence16) {
+    testBankEquivalence<16>();
+}
+
+TEST(FilterBankTest, Stability) {
+    FilterBank<4> bank;
+    for (size_t band = 0; band < 4; ++band) {
+        EXPECT_TRUE(bank.setCoefficients(band, randomFilter<float>()));
+        EXPECT_TRUE(bank.isStable(band));
+    }
+    // poles outside the unit circle.
+    EXPECT_FALSE(bank.setCoefficients(
+            0, std::array<float, kBiquadNumCoefs>{1.f, 0.f, 0.f, -2.5f, 1.2f}));
+    EXPECT_FALSE(bank.isStable(0));
+}
+
+TEST(FilterBankTest, Clear) {
+    constexpr size_t TEST_FRAME_COUNT = 64;
+    std::array<std::array<float, kBiquadNumCoefs>, 4> coefs;
+    for (auto& coef : coefs) {
+        coef = randomFilter<float>();
+    }
+    std::vector<float> input(TEST_FRAME_COUNT);
+    randomBuffer(input.data(), TEST_FRAME_COUNT);
+
+    FilterBank<4> bank(coefs);
+    std::vector<float> first(TEST_FRAME_COUNT * 4);
+    bank.process(first.data(), input.data(), TEST_FRAME_COUNT);
+
+    // after clear() the bank must reproduce its initial output.
+    bank.clear();
+    std::vector<float> second(TEST_FRAME_COUNT * 4);
+    bank.process(second.data(), input.data(), TEST_FRAME_COUNT);
+    EXPECT_EQ(first, second);
+}
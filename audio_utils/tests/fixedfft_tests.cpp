@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <audio_utils/fixedfft.h>
+
+// Expected spectra are computed against a double precision reference DFT.
+// The fixed point FFT halves the data every stage, so an n point transform is
+// scaled by 1/n relative to the textbook DFT, and each stage contributes
+// about one ulp of rounding noise.
+static void referenceDft(const std::vector<int32_t>& in,
+        std::vector<double>& re, std::vector<double>& im) {
+    const size_t n = in.size();
+    re.resize(n);
+    im.resize(n);
+    for (size_t k = 0; k < n; ++k) {
+        double sumRe = 0.;
+        double sumIm = 0.;
+        for (size_t i = 0; i < n; ++i) {
+            const double theta = 2. * M_PI * k * i / n;
+            const double xr = (int16_t)(in[i] >> 16);
+            const double xi = (int16_t)(in[i] & 0xFFFF);
+            sumRe += xr * cos(theta) + xi * sin(theta);
+            sumIm += -xr * sin(theta) + xi * cos(theta);
+        }
+        re[k] = sumRe / n;
+        im[k] = sumIm / n;
+    }
+}
+
+// The class is parameterized on the transform size.
+class FixedFftTest : public ::testing::TestWithParam<int> {
+};
+
+TEST_P(FixedFftTest, MatchesReferenceDft) {
+    const int n = GetParam();
+    std::vector<int32_t> v(n);
+    // A few mixed tones, quantized; amplitudes well below full scale to
+    // stay clear of the internal saturation-free headroom assumptions.
+    for (int i = 0; i < n; ++i) {
+        const double x = 8000. * cos(2. * M_PI * 3. * i / n)
+                + 4000. * sin(2. * M_PI * (n / 4.) * i / n);
+        v[i] = (int32_t)lrint(x) << 16;
+    }
+
+    std::vector<double> re;
+    std::vector<double> im;
+    referenceDft(v, re, im);
+
+    fixed_fft(n, v.data());
+
+    // log2(n) stages of rounding, plus quantization of the twiddles.
+    const double tolerance = 2. * log2((double)n);
+    for (int k = 0; k < n; ++k) {
+        EXPECT_NEAR(re[k], (double)(int16_t)(v[k] >> 16), tolerance)
+                << "real bin " << k << " of " << n;
+        EXPECT_NEAR(im[k], (double)(int16_t)(v[k] & 0xFFFF), tolerance)
+                << "imaginary bin " << k << " of " << n;
+    }
+}
+
+// Sizes beyond 1024 were previously rejected by the static twiddle table.
+INSTANTIATE_TEST_CASE_P(FixedFftSizes, FixedFftTest,
+        ::testing::Values(16, 256, 1024, 2048, 8192, 16384));
+
+TEST(fixedfft, impulse) {
+    // A real impulse has a flat spectrum: amplitude / n in every bin.
+    for (int n : {256, 4096, 16384}) {
+        std::vector<int32_t> v(n, 0);
+        v[0] = 0x4000 << 16;
+        fixed_fft(n, v.data());
+        const int expected = 0x4000 / n;
+        for (int k = 0; k < n; ++k) {
+            EXPECT_NEAR(expected, (int16_t)(v[k] >> 16), 1) << "bin " << k;
+            EXPECT_NEAR(0, (int16_t)(v[k] & 0xFFFF), 1) << "bin " << k;
+        }
+    }
+}
+
+TEST(floatfft, matches_reference_dft) {
+    // The float transform computes unscaled DFT sums; tolerance grows with
+    // the accumulated single precision rounding, about an ulp per stage.
+    for (int n : {16, 1024, 16384}) {
+        std::vector<float> v(n * 2);
+        for (int i = 0; i < n; ++i) {
+            v[i * 2] = 0.5f * cosf(2.f * (float)M_PI * 3.f * i / n);
+            v[i * 2 + 1] = 0.25f * sinf(2.f * (float)M_PI * 5.f * i / n);
+        }
+
+        std::vector<double> re(n);
+        std::vector<double> im(n);
+        for (int k = 0; k < n; ++k) {
+            double sumRe = 0.;
+            double sumIm = 0.;
+            for (int i = 0; i < n; ++i) {
+                const double theta = 2. * M_PI * k * i / n;
+                sumRe += v[i * 2] * cos(theta) + v[i * 2 + 1] * sin(theta);
+                sumIm += -v[i * 2] * sin(theta) + v[i * 2 + 1] * cos(theta);
+            }
+            re[k] = sumRe;
+            im[k] = sumIm;
+        }
+
+        float_fft(n, v.data());
+
+        const double tolerance = n * log2((double)n) * 1e-7;
+        for (int k = 0; k < n; ++k) {
+            EXPECT_NEAR(re[k], v[k * 2], tolerance) << "real bin " << k << " of " << n;
+            EXPECT_NEAR(im[k], v[k * 2 + 1], tolerance)
+                    << "imaginary bin " << k << " of " << n;
+        }
+    }
+}
+
+TEST(floatfft, real_impulse) {
+    // A real impulse has a flat, purely real spectrum; bin 0 packs DC in the
+    // real slot and Nyquist in the imaginary one.
+    for (int n : {256, 8192}) {
+        std::vector<float> v(n * 2, 0.f);
+        v[0] = 1.f;
+        float_fft_real(n, v.data());
+        for (int k = 0; k < n; ++k) {
+            EXPECT_NEAR(1.f, v[k * 2], 1e-3f) << "bin " << k << " of " << n;
+            if (k != 0) {
+                EXPECT_NEAR(0.f, v[k * 2 + 1], 1e-3f) << "bin " << k << " of " << n;
+            }
+        }
+        EXPECT_NEAR(1.f, v[1], 1e-3f) << "Nyquist of " << n;
+    }
+}
+
+TEST(fixedfft, real_tone_peak) {
+    // fixed_fft_real packs two real samples per complex slot; a single real
+    // tone must produce its spectral peak at the tone bin.  8192 packed
+    // slots cover a 16384 point real transform.
+    for (int n : {512, 2048, 8192}) {
+        const int bin = 5;
+        std::vector<int32_t> v(n);
+        for (int i = 0; i < n; ++i) {
+            const int16_t even = (int16_t)lrint(8000. * cos(M_PI * bin * (2 * i) / n));
+            const int16_t odd = (int16_t)lrint(8000. * cos(M_PI * bin * (2 * i + 1) / n));
+            v[i] = ((int32_t)even << 16) | (uint16_t)odd;
+        }
+        fixed_fft_real(n, v.data());
+        int64_t best = 0;
+        int bestBin = -1;
+        for (int k = 1; k < n; ++k) {
+            const int64_t magRe = (int16_t)(v[k] >> 16);
+            const int64_t magIm = (int16_t)(v[k] & 0xFFFF);
+            const int64_t mag = magRe * magRe + magIm * magIm;
+            if (mag > best) {
+                best = mag;
+                bestBin = k;
+            }
+        }
+        EXPECT_TRUE(bestBin == bin || bestBin == n - bin)
+                << "peak at " << bestBin << " for n " << n;
+    }
+}
@@ -19,6 +19,7 @@
 #include <log/log.h>
 
 #include <audio_utils/format.h>
+#include <audio_utils/format_traits.h>
 #include <gtest/gtest.h>
 
 /** returns true if the format is a common source or destination format.
@@ -97,6 +98,15 @@ TEST_P(FormatTest, memcpy_by_audio_format)
             check, dst_encoding,
             data, src_encoding, SAMPLES);
 
+    // The resolved converter must exist for this pair and match
+    // memcpy_by_audio_format exactly.
+    const audio_format_converter_t converter =
+            audio_format_get_converter(dst_encoding, src_encoding);
+    ASSERT_NE(nullptr, converter);
+    uint32_t check2[SAMPLES];
+    converter(check2, data, SAMPLES);
+    EXPECT_EQ(0, memcmp(check, check2, SAMPLES * audio_bytes_per_sample(dst_encoding)));
+
     // Check in-place is same as out-of-place conversion.
     memcpy_by_audio_format(
             data, dst_encoding,
@@ -114,6 +124,45 @@ TEST_P(FormatTest, memcpy_by_audio_format)
             memcmp(data, orig_data, SAMPLES * audio_bytes_per_sample(orig_encoding)));
 }
 
+TEST_P(FormatTest, memcpy_by_audio_format_inplace)
+{
+    // fetch parameters
+    const auto param = GetParam();
+    const audio_format_t src_encoding = std::get<0>(param);
+    const audio_format_t dst_encoding = std::get<1>(param);
+
+    // either source or destination (or both) need to be a common format
+    if (!is_common_src_format(src_encoding) && !is_common_dst_format(dst_encoding)) {
+        printf("skip conversion src:%#x  dst:%#x\n", src_encoding, dst_encoding);
+        return;
+    }
+
+    constexpr size_t SAMPLES = UINT8_MAX;
+    constexpr audio_format_t orig_encoding = AUDIO_FORMAT_PCM_16_BIT;
+    int16_t orig_data[SAMPLES];
+
+    fillRamp(orig_data);
+
+    printf("trying in-place conversion src:%#x  dst:%#x\n", src_encoding, dst_encoding);
+    fflush(stdout);
+
+    // data buffer sized for the wider of the two formats
+    // (uint32_t is maximum sample size of 4 bytes).
+    uint32_t data[SAMPLES];
+    memcpy_by_audio_format(
+            data, src_encoding,
+            orig_data, orig_encoding, SAMPLES);
+
+    // out-of-place conversion is the reference result.
+    uint32_t check[SAMPLES];
+    memcpy_by_audio_format(
+            check, dst_encoding,
+            data, src_encoding, SAMPLES);
+
+    memcpy_by_audio_format_inplace(data, dst_encoding, src_encoding, SAMPLES);
+    EXPECT_EQ(0, memcmp(check, data, SAMPLES * audio_bytes_per_sample(dst_encoding)));
+}
+
 INSTANTIATE_TEST_CASE_P(FormatVariations, FormatTest, ::testing::Combine(
     ::testing::Values(
         AUDIO_FORMAT_PCM_8_BIT,
@@ -132,6 +181,29 @@ INSTANTIATE_TEST_CASE_P(FormatVariations, FormatTest, ::testing::Combine(
         AUDIO_FORMAT_PCM_8_24_BIT
     )));
 
+TEST(audio_utils_format, static_convert_matches_runtime)
+{
+    using android::audio_utils::format::convert;
+
+    constexpr size_t SAMPLES = UINT8_MAX;
+    int16_t orig_data[SAMPLES];
+    fillRamp(orig_data);
+
+    float fdata[SAMPLES];
+    float fcheck[SAMPLES];
+    convert<AUDIO_FORMAT_PCM_FLOAT, AUDIO_FORMAT_PCM_16_BIT>(fdata, orig_data, SAMPLES);
+    memcpy_by_audio_format(fcheck, AUDIO_FORMAT_PCM_FLOAT,
+            orig_data, AUDIO_FORMAT_PCM_16_BIT, SAMPLES);
+    EXPECT_EQ(0, memcmp(fdata, fcheck, sizeof(fdata)));
+
+    int16_t idata[SAMPLES];
+    convert<AUDIO_FORMAT_PCM_16_BIT, AUDIO_FORMAT_PCM_FLOAT>(idata, fdata, SAMPLES);
+    EXPECT_EQ(0, memcmp(idata, orig_data, sizeof(idata)));
+
+    // unsupported pairs do not compile:
+    // convert<AUDIO_FORMAT_PCM_32_BIT, AUDIO_FORMAT_PCM_8_24_BIT>(...);
+}
+
 class FormatTest1p : public testing::TestWithParam<audio_format_t>
 {
 };
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <random>
+#include <vector>
+
+#include <audio_utils/GainMatrix.h>
+#include <gtest/gtest.h>
+
+using android::audio_utils::channels::GainMatrix;
+
+// The unrolled network is usable (and checked here) at compile time.
+static constexpr bool constexprGainMatrixCheck() {
+    using GM = GainMatrix<float, 2, 3>;
+    constexpr GM::Matrix matrix{{
+        {1.f, 0.f, 0.5f},   // in 0: to out 0 and half to out 2
+        {0.f, 1.f, 0.5f},   // in 1: to out 1 and half to out 2
+    }};
+    const GM gm(matrix);
+    const float src[2 * 2] = {1.f, 2.f, 3.f, 4.f};
+    float dst[2 * 3] = {};
+    gm.process(src, dst, 2 /* frameCount */);
+    return dst[0] == 1.f && dst[1] == 2.f && dst[2] == 1.5f
+            && dst[3] == 3.f && dst[4] == 4.f && dst[5] == 3.5f;
+}
+static_assert(constexprGainMatrixCheck());
+
+// Reference nested-loop mix the unrolled kernel must match.
+template <typename T>
+static void referenceMix(const T *matrix /* [in][out] */, size_t inChannels, size_t outChannels,
+        const T *src, T *dst, size_t frameCount, bool accumulate) {
+    for (size_t frame = 0; frame < frameCount; ++frame) {
+        for (size_t out = 0; out < outChannels; ++out) {
+            T value = accumulate ? dst[frame * outChannels + out] : T(0);
+            for (size_t in = 0; in < inChannels; ++in) {
+                value += matrix[in * outChannels + out] * src[frame * inChannels + in];
+            }
+            dst[frame * outChannels + out] = value;
+        }
+    }
+}
+
+TEST(audio_utils_gain_matrix, matches_reference_12x8) {
+    constexpr size_t IN = 12;   // e.g. automotive routing source channels
+    constexpr size_t OUT = 8;
+    constexpr size_t FRAMES = 17;  // odd count to exercise any tail handling
+
+    GainMatrix<float, IN, OUT>::Matrix matrix{};
+    std::minstd_rand gen(42 /* seed, arbitrary */);
+    std::uniform_real_distribution<float> dis(-1.f, 1.f);
+    for (size_t in = 0; in < IN; ++in) {
+        for (size_t out = 0; out < OUT; ++out) {
+            // a sparse-ish routing matrix: most gains are exact zeroes.
+            matrix[in][out] = (in + out) % 3 == 0 ? dis(gen) : 0.f;
+        }
+    }
+    const GainMatrix<float, IN, OUT> gm(matrix);
+    EXPECT_EQ(matrix[0][0], gm.gain(0, 0));
+
+    std::vector<float> src(FRAMES * IN);
+    for (auto& sample : src) {
+        sample = dis(gen);
+    }
+
+    for (const bool accumulate : {false, true}) {
+        std::vector<float> dst(FRAMES * OUT, 0.25f);
+        std::vector<float> expected(dst);
+        gm.process(src.data(), dst.data(), FRAMES, accumulate);
+        referenceMix(&matrix[0][0], IN, OUT, src.data(), expected.data(), FRAMES, accumulate);
+        for (size_t i = 0; i < dst.size(); ++i) {
+            // the unrolled fold associates the sums differently than the
+            // reference loop, so allow rounding differences.
+            EXPECT_NEAR(expected[i], dst[i], 1e-6)
+                    << "accumulate: " << accumulate << " index: " << i;
+        }
+    }
+}
+
+TEST(audio_utils_gain_matrix, identity_and_fanout) {
+    // identity matrix passes frames through unchanged.
+    using GM2 = GainMatrix<float, 2, 2>;
+    const GM2 identity(GM2::Matrix{{{1.f, 0.f}, {0.f, 1.f}}});
+    const float stereo[4] = {0.5f, -0.5f, 0.25f, -0.25f};
+    float out2[4] = {};
+    identity.process(stereo, out2, 2 /* frameCount */);
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(stereo[i], out2[i]);
+    }
+
+    // mono fan-out to 4 outputs at distinct gains.
+    using GM14 = GainMatrix<float, 1, 4>;
+    const GM14 fanout(GM14::Matrix{{{1.f, 0.5f, 0.25f, 0.f}}});
+    const float mono[1] = {0.8f};
+    float out4[4] = {};
+    fanout.process(mono, out4, 1 /* frameCount */);
+    EXPECT_EQ(0.8f, out4[0]);
+    EXPECT_EQ(0.4f, out4[1]);
+    EXPECT_EQ(0.2f, out4[2]);
+    EXPECT_EQ(0.f, out4[3]);
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <audio_utils/Histogram.h>
+
+using android::audio_utils::LogHistogram;
+using android::audio_utils::SharedLogHistogram;
+
+static constexpr int32_t kSubBucketBits = 3;
+static constexpr int64_t kMaxValue = 1000000;
+
+TEST(SharedLogHistogram, CreateAddSnapshot)
+{
+    const size_t size = SharedLogHistogram::requiredSize(kSubBucketBits, kMaxValue);
+    std::vector<uint64_t> region(size / sizeof(uint64_t));
+    SharedLogHistogram *shared = SharedLogHistogram::createAt(region.data(), size,
+            kSubBucketBits, kMaxValue);
+    ASSERT_NE(nullptr, shared);
+    EXPECT_EQ(kSubBucketBits, shared->getSubBucketBits());
+    EXPECT_EQ(kMaxValue, shared->getMaxValue());
+
+    // the shared histogram must bin exactly like a private one
+    LogHistogram reference(kSubBucketBits, kMaxValue);
+    const int64_t values[] = {-5, 0, 1, 7, 8, 100, 12345, kMaxValue, kMaxValue + 1};
+    for (int64_t value : values) {
+        shared->add(value);
+        reference.add(value);
+    }
+    EXPECT_EQ(reference.getCount(), shared->getCount());
+
+    LogHistogram collected(kSubBucketBits, kMaxValue);
+    ASSERT_TRUE(shared->snapshot(collected));
+    EXPECT_EQ(reference.getCount(), collected.getCount());
+    EXPECT_EQ(reference.getCountBelowRange(), collected.getCountBelowRange());
+    EXPECT_EQ(reference.getCountAboveRange(), collected.getCountAboveRange());
+    for (int32_t i = 0; i < reference.getNumBinsInRange(); i++) {
+        EXPECT_EQ(reference.getCount(i), collected.getCount(i)) << "bin " << i;
+    }
+
+    // snapshots accumulate, for merging several shared histograms
+    ASSERT_TRUE(shared->snapshot(collected));
+    EXPECT_EQ(2 * reference.getCount(), collected.getCount());
+
+    shared->clear();
+    EXPECT_EQ((uint64_t) 0, shared->getCount());
+}
+
+TEST(SharedLogHistogram, Attach)
+{
+    const size_t size = SharedLogHistogram::requiredSize(kSubBucketBits, kMaxValue);
+    std::vector<uint64_t> region(size / sizeof(uint64_t));
+    SharedLogHistogram *creator = SharedLogHistogram::createAt(region.data(), size,
+            kSubBucketBits, kMaxValue);
+    ASSERT_NE(nullptr, creator);
+    creator->add(42);
+
+    // another view of the same region sees the same counts
+    SharedLogHistogram *attached = SharedLogHistogram::attachAt(region.data(), size);
+    ASSERT_NE(nullptr, attached);
+    EXPECT_EQ((uint64_t) 1, attached->getCount());
+    attached->add(43);
+    EXPECT_EQ((uint64_t) 2, creator->getCount());
+}
+
+TEST(SharedLogHistogram, InvalidArguments)
+{
+    const size_t size = SharedLogHistogram::requiredSize(kSubBucketBits, kMaxValue);
+    std::vector<uint64_t> region(size / sizeof(uint64_t));
+
+    EXPECT_EQ(nullptr, SharedLogHistogram::createAt(nullptr, size, kSubBucketBits, kMaxValue));
+    EXPECT_EQ(nullptr, SharedLogHistogram::createAt(region.data(), size - 1,
+            kSubBucketBits, kMaxValue));
+    EXPECT_EQ(nullptr, SharedLogHistogram::createAt(region.data(), size, 0, kMaxValue));
+    EXPECT_EQ(nullptr, SharedLogHistogram::createAt(region.data(), size, kSubBucketBits, 0));
+
+    // a region that does not hold a histogram is rejected
+    std::fill(region.begin(), region.end(), 0);
+    EXPECT_EQ(nullptr, SharedLogHistogram::attachAt(region.data(), size));
+
+    // a valid histogram in a region reported smaller than required is rejected
+    ASSERT_NE(nullptr, SharedLogHistogram::createAt(region.data(), size,
+            kSubBucketBits, kMaxValue));
+    EXPECT_EQ(nullptr, SharedLogHistogram::attachAt(region.data(), size - 1));
+
+    // snapshot into a histogram with a different configuration is rejected
+    SharedLogHistogram *shared = SharedLogHistogram::attachAt(region.data(), size);
+    ASSERT_NE(nullptr, shared);
+    LogHistogram mismatched(kSubBucketBits + 1, kMaxValue);
+    EXPECT_FALSE(shared->snapshot(mismatched));
+}
+
+TEST(SharedLogHistogram, CrossProcess)
+{
+    constexpr int kChildItems = 1000;
+
+    const size_t size = SharedLogHistogram::requiredSize(kSubBucketBits, kMaxValue);
+    void *region = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    ASSERT_NE(MAP_FAILED, region);
+    SharedLogHistogram *shared = SharedLogHistogram::createAt(region, size,
+            kSubBucketBits, kMaxValue);
+    ASSERT_NE(nullptr, shared);
+
+    const pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        // child: attach to the inherited mapping and add items
+        SharedLogHistogram *childHistogram = SharedLogHistogram::attachAt(region, size);
+        if (childHistogram == nullptr) {
+            _exit(1);
+        }
+        for (int i = 0; i < kChildItems; i++) {
+            childHistogram->add(i);
+        }
+        _exit(0);
+    }
+
+    int status = -1;
+    ASSERT_EQ(pid, waitpid(pid, &status, 0));
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(0, WEXITSTATUS(status));
+
+    // parent: collect the child's counts with no serialization in between
+    LogHistogram collected(kSubBucketBits, kMaxValue);
+    ASSERT_TRUE(shared->snapshot(collected));
+    EXPECT_EQ((uint64_t) kChildItems, collected.getCount());
+    EXPECT_EQ((uint64_t) 0, collected.getCountBelowRange());
+
+    ASSERT_EQ(0, munmap(region, size));
+}
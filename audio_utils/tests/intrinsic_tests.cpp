@@ -42,6 +42,48 @@ TYPED_TEST(IntrisicUtilsTest, vld1) {
     ASSERT_EQ(value, android::audio_utils::intrinsics::vld1<TypeParam>(&value));
 }
 
+TYPED_TEST(IntrisicUtilsTest, vload_deinterleave) {
+    constexpr TypeParam frame[2] = { 1.25f, 2.5f };
+    const auto channels =
+            android::audio_utils::intrinsics::vload_deinterleave<TypeParam, 2>(frame);
+    ASSERT_EQ(frame[0], channels.v[0]);
+    ASSERT_EQ(frame[1], channels.v[1]);
+}
+
+TYPED_TEST(IntrisicUtilsTest, vload_deinterleave_vector) {
+    // exercise the generic path on a composite type of 4 samples per channel.
+    using Vector = android::audio_utils::intrinsics::internal_array_t<TypeParam, 4>;
+    TypeParam interleaved[8];
+    for (size_t i = 0; i < std::size(interleaved); ++i) {
+        interleaved[i] = i + 1;
+    }
+    const auto channels =
+            android::audio_utils::intrinsics::vload_deinterleave<Vector, 2>(interleaved);
+    for (size_t c = 0; c < 2; ++c) {
+        TypeParam channel[4];
+        android::audio_utils::intrinsics::vst1(channel, channels.v[c]);
+        for (size_t i = 0; i < std::size(channel); ++i) {
+            ASSERT_EQ(interleaved[i * 2 + c], channel[i]);
+        }
+    }
+}
+
+TYPED_TEST(IntrisicUtilsTest, vstore_interleave) {
+    // a quad deinterleave followed by an interleave reproduces the input.
+    using Vector = android::audio_utils::intrinsics::internal_array_t<TypeParam, 2>;
+    TypeParam interleaved[8];
+    for (size_t i = 0; i < std::size(interleaved); ++i) {
+        interleaved[i] = i + 1;
+    }
+    const auto channels =
+            android::audio_utils::intrinsics::vload_deinterleave<Vector, 4>(interleaved);
+    TypeParam reconstructed[8] = {};
+    android::audio_utils::intrinsics::vstore_interleave(reconstructed, channels);
+    for (size_t i = 0; i < std::size(interleaved); ++i) {
+        ASSERT_EQ(interleaved[i], reconstructed[i]);
+    }
+}
+
 TYPED_TEST(IntrisicUtilsTest, vmla) {
     constexpr TypeParam a = 2.125f;
     constexpr TypeParam b = 2.25f;
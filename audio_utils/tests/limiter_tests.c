@@ -14,14 +14,84 @@
  * limitations under the License.
  */
 
+#include <assert.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <audio_utils/limiter.h>
 
+#define STEREO 2
+#define LOOKAHEAD 48
+#define THRESHOLD 0.98f
+#define TEST_FRAMES 4800
+
+static void test_lookahead_limiter(void)
+{
+    lookahead_limiter_t *limiter =
+            lookahead_limiter_create(48000, STEREO, LOOKAHEAD, THRESHOLD, 50.f);
+    assert(limiter != NULL);
+    assert(lookahead_limiter_get_delay(limiter) == LOOKAHEAD);
+
+    /* a +6dB sine burst in the middle of an otherwise quiet signal */
+    static float in[TEST_FRAMES * STEREO];
+    static float out[TEST_FRAMES * STEREO];
+    for (int i = 0; i < TEST_FRAMES; i++) {
+        const float amplitude = (i >= 1000 && i < 3000) ? 2.0f : 0.25f;
+        const float s = amplitude * sinf(2.f * (float) M_PI * 997.f * i / 48000.f);
+        in[i * STEREO] = s;
+        in[i * STEREO + 1] = -s;
+    }
+
+    /* process in uneven chunks to exercise the block boundaries */
+    size_t done = 0;
+    while (done < TEST_FRAMES) {
+        size_t chunk = 160 + done % 77;
+        if (chunk > TEST_FRAMES - done) {
+            chunk = TEST_FRAMES - done;
+        }
+        lookahead_limiter_process(limiter,
+                out + done * STEREO, in + done * STEREO, chunk);
+        done += chunk;
+    }
+
+    /* brickwall: no output sample may exceed the threshold */
+    for (int i = 0; i < TEST_FRAMES * STEREO; i++) {
+        assert(fabsf(out[i]) <= THRESHOLD + 1e-6f);
+    }
+    /* quiet passages pass through untouched, delayed by the lookahead */
+    for (int i = 500; i < 900; i++) {
+        assert(out[i * STEREO] == in[(i - LOOKAHEAD) * STEREO]);
+    }
+
+    /* after a reset the limiter behaves like a fresh instance */
+    lookahead_limiter_reset(limiter);
+    static float out2[TEST_FRAMES * STEREO];
+    lookahead_limiter_process(limiter, out2, in, TEST_FRAMES);
+    assert(memcmp(out, out2, sizeof(out)) == 0);
+
+    /* the q15 interface obeys the same ceiling */
+    lookahead_limiter_reset(limiter);
+    static int16_t qin[TEST_FRAMES * STEREO];
+    static int16_t qout[TEST_FRAMES * STEREO];
+    for (int i = 0; i < TEST_FRAMES * STEREO; i++) {
+        float s = in[i] * 16384.f;  /* half scale so +6dB still fits in q15 */
+        qin[i] = (int16_t) (s < -32768.f ? -32768.f : s > 32767.f ? 32767.f : s);
+    }
+    lookahead_limiter_process_q15(limiter, qout, qin, TEST_FRAMES);
+    for (int i = 0; i < TEST_FRAMES * STEREO; i++) {
+        assert(abs(qout[i]) <= (int) (THRESHOLD * 32768.f) + 1);
+    }
+
+    lookahead_limiter_free(limiter);
+    lookahead_limiter_free(NULL);
+    printf("lookahead limiter tests passed\n");
+}
+
 int main(int argc, char **argv)
 {
     int i;
+    test_lookahead_limiter();
     if (argc > 1) {
         for (i = 1; i < argc; i++) {
             float x = atof(argv[i]);
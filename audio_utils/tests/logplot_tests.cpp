@@ -33,5 +33,25 @@ int main()
     std::string graphstr = audio_utils_log_plot(vdata.begin(), vdata.end());
     std::cout << graphstr << std::endl;
 
+    // Incremental plotter: stream far more samples than the window holds.
+    constexpr size_t WIDTH = 100;
+    constexpr size_t BUCKET_SIZE = 10;
+    constexpr size_t SAMPLES = 5000;
+    LogPlot<float> plot(WIDTH, BUCKET_SIZE);
+    for (size_t i = 0; i < SAMPLES; i++) {
+        const float v = -40.f + 25.f * sinf(i * 0.01f) * expf(i * -3e-4f);
+        plot.add(v, i % 1000 == 0);
+    }
+    if (plot.size() > WIDTH) {
+        std::cerr << "downsampled window exceeds width: " << plot.size() << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string incstr = plot.plot();
+    if (incstr.empty()) {
+        std::cerr << "incremental plot is empty" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << incstr << std::endl;
+
     return EXIT_SUCCESS;
 }
@@ -230,6 +230,124 @@ TEST(metadata_tests, basic_data) {
 #endif
 }
 
+TEST(metadata_tests, data_view) {
+    Data d;
+    d.emplace("int32", (int32_t)1);
+    d.emplace("int64", (int64_t)2);
+    d.emplace("float", (float)3.1f);
+    d.emplace("double", (double)4.11);
+    d.emplace("string", "hello");
+    Data s;
+    s.emplace("nested", "world");
+    d.emplace("data", s);
+
+    // serialize into a reused buffer (no allocation once grown).
+    ByteString bs;
+    ASSERT_TRUE(byteStringFromData(d, bs));
+    ASSERT_EQ(byteStringFromData(d), bs);
+
+    // parse in place without materializing the map.
+    DataView view(bs);
+    ASSERT_EQ((size_t)6, view.size());
+    ASSERT_TRUE(view.contains("int32"));
+    ASSERT_FALSE(view.contains("int16"));
+
+    int32_t i32;
+    ASSERT_TRUE(view.get("int32", &i32));
+    ASSERT_EQ(1, i32);
+    int64_t i64;
+    ASSERT_TRUE(view.get("int64", &i64));
+    ASSERT_EQ(2, i64);
+    float f;
+    ASSERT_TRUE(view.get("float", &f));
+    ASSERT_EQ(3.1f, f);
+    double dbl;
+    ASSERT_TRUE(view.get("double", &dbl));
+    ASSERT_EQ(4.11, dbl);
+
+    // strings are returned as views into the byte string.
+    std::string_view sv;
+    ASSERT_TRUE(view.get("string", &sv));
+    ASSERT_EQ("hello", sv);
+
+    // nested Data is returned as another view.
+    DataView nested(nullptr, 0);
+    ASSERT_TRUE(view.get("data", &nested));
+    ASSERT_EQ((size_t)1, nested.size());
+    ASSERT_TRUE(nested.get("nested", &sv));
+    ASSERT_EQ("world", sv);
+
+    // type mismatches and absent keys fail without modifying the value.
+    ASSERT_FALSE(view.get("int32", &i64));
+    ASSERT_FALSE(view.get("string", &i32));
+    ASSERT_FALSE(view.get("absent", &sv));
+    ASSERT_EQ(2, i64);
+
+    // a truncated byte string fails lookups rather than reading out of bounds.
+    DataView truncated(bs.data(), bs.size() / 2);
+    ASSERT_FALSE(truncated.get("string", &sv));
+}
+
+TEST(metadata_tests, data_schema) {
+    static constexpr CKey<int32_t> FRAMES("frames");
+    static constexpr CKey<int64_t> POSITION("position");
+    static constexpr CKey<float> GAIN("gain");
+    static constexpr CKey<double> RATE("rate");
+
+    Data d;
+    d[FRAMES] = (int32_t)960;
+    d[POSITION] = (int64_t)48000;
+    d[GAIN] = 0.5f;
+    d[RATE] = 1.0;
+    d.emplace("codec", "opus");  // non-schema keys interleave freely.
+
+    ByteString bs;
+    ASSERT_TRUE(byteStringFromData(d, bs));
+
+    DataSchema schema(FRAMES, POSITION, GAIN, RATE);
+    ASSERT_FALSE(schema.matches(bs));  // unbound until bind().
+    ASSERT_TRUE(schema.bind(bs));
+    ASSERT_TRUE(schema.matches(bs));
+    ASSERT_EQ(960, schema.get<0>(bs));
+    ASSERT_EQ(48000, schema.get<1>(bs));
+    ASSERT_EQ(0.5f, schema.get<2>(bs));
+    ASSERT_EQ(1.0, schema.get<3>(bs));
+
+    // value changes keep the layout: the binding carries over.
+    d[FRAMES] = (int32_t)961;
+    d[GAIN] = 0.25f;
+    ASSERT_TRUE(byteStringFromData(d, bs));
+    ASSERT_TRUE(schema.matches(bs));
+    ASSERT_EQ(961, schema.get<0>(bs));
+    ASSERT_EQ(0.25f, schema.get<2>(bs));
+
+    // resizing a variable-length value shifts offsets: the convenience
+    // get() detects the stale binding and rebinds.
+    d["codec"] = "pcm";
+    ASSERT_TRUE(byteStringFromData(d, bs));
+    ASSERT_FALSE(schema.matches(bs));
+    int32_t frames;
+    int64_t position;
+    float gain;
+    double rate;
+    ASSERT_TRUE(schema.get(bs, &frames, &position, &gain, &rate));
+    ASSERT_TRUE(schema.matches(bs));
+    ASSERT_EQ(961, frames);
+    ASSERT_EQ(48000, position);
+    ASSERT_EQ(0.25f, gain);
+    ASSERT_EQ(1.0, rate);
+
+    // a missing key or a type change fails the bind and unbinds the schema.
+    Data partial(d);
+    partial.erase(GAIN.getName());
+    ASSERT_TRUE(byteStringFromData(partial, bs));
+    ASSERT_FALSE(schema.bind(bs));
+    ASSERT_FALSE(schema.matches(bs));
+    d[GAIN.getName()] = (int32_t)0;  // was float.
+    ASSERT_TRUE(byteStringFromData(d, bs));
+    ASSERT_FALSE(schema.bind(bs));
+}
+
 TEST(metadata_tests, complex_data) {
     Data small;
     Data big;
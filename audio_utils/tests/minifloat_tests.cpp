@@ -0,0 +1,87 @@
+/*
+ * Copyright 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "audio_utils_minifloat_tests"
+
+#include <cmath>
+#include <vector>
+
+#include <audio_utils/minifloat.h>
+#include <gtest/gtest.h>
+
+TEST(audio_utils_minifloat, round_trip)
+{
+    // every minifloat converts to a float that converts back to itself
+    for (uint32_t m = 0; m <= 0xFFFF; ++m) {
+        const gain_minifloat_t gain = (gain_minifloat_t)m;
+        const float v = float_from_gain(gain);
+        ASSERT_GE(v, 0.f);
+        ASSERT_LT(v, 2.f);
+        ASSERT_EQ(gain, gain_from_float(v)) << "minifloat " << m;
+    }
+    EXPECT_EQ(1.0f, float_from_gain(GAIN_MINIFLOAT_UNITY));
+    EXPECT_EQ(GAIN_MINIFLOAT_UNITY, gain_from_float(1.0f));
+}
+
+TEST(audio_utils_minifloat, array_matches_scalar)
+{
+    // unpack: exhaustive over all minifloats, packed as mirrored pairs
+    constexpr size_t COUNT = 0x10000;
+    std::vector<gain_minifloat_packed_t> gains(COUNT);
+    for (size_t i = 0; i < COUNT; ++i) {
+        gains[i] = gain_minifloat_pack((gain_minifloat_t)i,
+                (gain_minifloat_t)(0xFFFF - i));
+    }
+    std::vector<float> left(COUNT);
+    std::vector<float> right(COUNT);
+    float_from_gain_array(left.data(), right.data(), gains.data(), COUNT);
+    for (size_t i = 0; i < COUNT; ++i) {
+        ASSERT_EQ(float_from_gain(gain_minifloat_unpack_left(gains[i])), left[i]);
+        ASSERT_EQ(float_from_gain(gain_minifloat_unpack_right(gains[i])), right[i]);
+    }
+
+    // pack: sweep the float range including denormal, out of range and NaN inputs
+    std::vector<float> fleft;
+    std::vector<float> fright;
+    for (float v = 1e-8f; v < 4.f; v *= 1.07f) {
+        fleft.push_back(v);
+        fright.push_back(2.f - v);
+    }
+    fleft.push_back(0.f);          fright.push_back(-1.f);
+    fleft.push_back(nanf(""));     fright.push_back(2.f);
+    const size_t fcount = fleft.size();
+    std::vector<gain_minifloat_packed_t> packed(fcount);
+    gain_from_float_array(packed.data(), fleft.data(), fright.data(), fcount);
+    for (size_t i = 0; i < fcount; ++i) {
+        ASSERT_EQ(gain_minifloat_pack(gain_from_float(fleft[i]),
+                gain_from_float(fright[i])), packed[i]) << "value " << fleft[i];
+    }
+}
+
+TEST(audio_utils_minifloat, constexpr_matches_runtime)
+{
+    using android::audio_utils::float_from_gain_constexpr;
+    using android::audio_utils::gain_from_float_constexpr;
+
+    for (uint32_t m = 0; m <= 0xFFFF; ++m) {
+        const gain_minifloat_t gain = (gain_minifloat_t)m;
+        ASSERT_EQ(float_from_gain(gain), float_from_gain_constexpr(gain));
+    }
+    for (float v = 1e-8f; v < 4.f; v *= 1.003f) {
+        ASSERT_EQ(gain_from_float(v), gain_from_float_constexpr(v)) << "value " << v;
+    }
+    EXPECT_EQ(gain_from_float(0.f), gain_from_float_constexpr(0.f));
+}
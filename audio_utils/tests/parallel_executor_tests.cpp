@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "audio_utils_parallel_executor_tests"
+
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+#include <audio_utils/ParallelExecutor.h>
+#include <audio_utils/format.h>
+#include <gtest/gtest.h>
+
+using android::audio_utils::ParallelExecutor;
+
+// the parallel split must produce the same samples as a single pass.
+TEST(audio_utils_parallel_executor, matches_serial_conversion)
+{
+    constexpr size_t SAMPLES = 1 << 20;
+    std::vector<int16_t> in(SAMPLES);
+    for (size_t i = 0; i < SAMPLES; ++i) {
+        in[i] = (int16_t)(i * 7 - 1000);
+    }
+
+    std::vector<float> ref(SAMPLES);
+    memcpy_by_audio_format(ref.data(), AUDIO_FORMAT_PCM_FLOAT,
+            in.data(), AUDIO_FORMAT_PCM_16_BIT, SAMPLES);
+
+    ParallelExecutor executor(3);
+    EXPECT_EQ(3u, executor.threadCount());
+    std::vector<float> out(SAMPLES);
+    executor.parallelFor(0, SAMPLES, 4096,
+            [&](size_t begin, size_t end) {
+                memcpy_by_audio_format(out.data() + begin, AUDIO_FORMAT_PCM_FLOAT,
+                        in.data() + begin, AUDIO_FORMAT_PCM_16_BIT, end - begin);
+            });
+    EXPECT_EQ(0, memcmp(ref.data(), out.data(), SAMPLES * sizeof(float)));
+}
+
+// every index is visited exactly once, over many generations
+TEST(audio_utils_parallel_executor, full_disjoint_coverage)
+{
+    constexpr size_t N = 100000;
+    ParallelExecutor executor(2);
+    for (int pass = 0; pass < 20; ++pass) {
+        std::vector<std::atomic<int>> hits(N);
+        executor.parallelFor(0, N, 64,
+                [&](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; ++i) {
+                        hits[i].fetch_add(1, std::memory_order_relaxed);
+                    }
+                });
+        for (size_t i = 0; i < N; ++i) {
+            ASSERT_EQ(1, hits[i].load(std::memory_order_relaxed))
+                    << "pass " << pass << " index " << i;
+        }
+    }
+}
+
+// small ranges must run entirely on the caller, in one piece
+TEST(audio_utils_parallel_executor, small_range_runs_inline)
+{
+    ParallelExecutor executor(2);
+    const auto callerId = std::this_thread::get_id();
+    size_t calls = 0;
+    executor.parallelFor(10, 25, 8,   // 15 < 2 * 8
+            [&](size_t begin, size_t end) {
+                EXPECT_EQ(callerId, std::this_thread::get_id());
+                EXPECT_EQ(10u, begin);
+                EXPECT_EQ(25u, end);
+                ++calls;
+            });
+    EXPECT_EQ(1u, calls);
+
+    // degenerate cases
+    executor.parallelFor(5, 5, 8, [&](size_t, size_t) { ++calls; });
+    EXPECT_EQ(1u, calls);
+
+    ParallelExecutor inlineOnly(1);
+    std::atomic<size_t> sum{0};
+    inlineOnly.parallelFor(0, 1000, 10,
+            [&](size_t begin, size_t end) { sum += end - begin; });
+    EXPECT_EQ(1000u, sum.load());
+}
+
+TEST(audio_utils_parallel_executor, worker_start_hook)
+{
+    std::atomic<int> started{0};
+    {
+        ParallelExecutor executor(4, [&](size_t workerIndex) {
+            EXPECT_LT(workerIndex, 4u);
+            ++started;
+        });
+        std::atomic<size_t> sum{0};
+        executor.parallelFor(0, 1 << 16, 256,
+                [&](size_t begin, size_t end) { sum += end - begin; });
+        EXPECT_EQ(size_t{1} << 16, sum.load());
+    }
+    EXPECT_EQ(4, started.load());
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "audio_utils_perfcounters_tests"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <audio_utils/PerfCounters.h>
+#include <audio_utils/format.h>
+#include <gtest/gtest.h>
+
+using android::audio_utils::PerfCounterPage;
+using android::audio_utils::perfCounterAttach;
+using android::audio_utils::perfCounterPage;
+
+TEST(audio_utils_perfcounters, counter_and_histogram)
+{
+    PerfCounterPage* page = perfCounterPage();
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(PerfCounterPage::kMagic, page->magic);
+    EXPECT_EQ(PerfCounterPage::kVersion, page->version);
+
+    const unsigned slot = AUDIO_UTILS_PERF_COUNTER_CUSTOM_BASE;
+    const uint64_t before = page->counters[slot];
+    audio_utils_perf_counter_add(slot, 3);
+    audio_utils_perf_counter_add(slot, 4);
+    EXPECT_EQ(before + 7, page->counters[slot]);
+
+    // out of range slots are ignored
+    audio_utils_perf_counter_add(AUDIO_UTILS_PERF_COUNTER_COUNT, 1);
+    audio_utils_perf_counter_add(~0u, 1);
+
+    // histogram binning: bin 0 for <= 0, else floor(log2(value)) + 1
+    const unsigned hslot = AUDIO_UTILS_PERF_HISTOGRAM_CUSTOM_BASE;
+    auto& h = page->histograms[hslot];
+    const uint64_t hcount = h.count;
+    audio_utils_perf_histogram_add(hslot, 0);
+    audio_utils_perf_histogram_add(hslot, -5);
+    audio_utils_perf_histogram_add(hslot, 1);        // bin 1
+    audio_utils_perf_histogram_add(hslot, 1023);     // bin 10
+    audio_utils_perf_histogram_add(hslot, 1024);     // bin 11
+    audio_utils_perf_histogram_add(hslot, INT64_MAX); // bin 63
+    EXPECT_EQ(hcount + 6, h.count);
+    EXPECT_GE(h.bins[0].load(), (uint64_t)2);
+    EXPECT_GE(h.bins[1].load(), (uint64_t)1);
+    EXPECT_GE(h.bins[10].load(), (uint64_t)1);
+    EXPECT_GE(h.bins[11].load(), (uint64_t)1);
+    EXPECT_GE(h.bins[63].load(), (uint64_t)1);
+}
+
+TEST(audio_utils_perfcounters, attach_and_restore)
+{
+    // an uninitialized external page is stamped on attach
+    auto external = std::make_unique<PerfCounterPage>();
+    memset(static_cast<void*>(external.get()), 0, sizeof(PerfCounterPage));
+    ASSERT_TRUE(perfCounterAttach(external.get()));
+    EXPECT_EQ(PerfCounterPage::kMagic, external->magic);
+    EXPECT_EQ(external.get(), perfCounterPage());
+
+    audio_utils_perf_counter_add(AUDIO_UTILS_PERF_COUNTER_CUSTOM_BASE + 1, 5);
+    EXPECT_EQ((uint64_t)5,
+            external->counters[AUDIO_UTILS_PERF_COUNTER_CUSTOM_BASE + 1]);
+
+    // re-attach keeps accumulated counts
+    ASSERT_TRUE(perfCounterAttach(external.get()));
+    EXPECT_EQ((uint64_t)5,
+            external->counters[AUDIO_UTILS_PERF_COUNTER_CUSTOM_BASE + 1]);
+
+    // a page with a foreign layout is rejected
+    auto other = std::make_unique<PerfCounterPage>();
+    memset(static_cast<void*>(other.get()), 0, sizeof(PerfCounterPage));
+    other->magic = PerfCounterPage::kMagic;
+    other->version = PerfCounterPage::kVersion + 1;
+    EXPECT_FALSE(perfCounterAttach(other.get()));
+
+    ASSERT_TRUE(perfCounterAttach(nullptr));  // restore built-in page
+    EXPECT_NE(external.get(), perfCounterPage());
+}
+
+TEST(audio_utils_perfcounters, converter_bytes_instrumented)
+{
+    const uint64_t before =
+            perfCounterPage()->counters[AUDIO_UTILS_PERF_COUNTER_CONVERTER_BYTES];
+    constexpr size_t SAMPLES = 1000;
+    std::vector<int16_t> in(SAMPLES);
+    std::vector<float> out(SAMPLES);
+    memcpy_by_audio_format(out.data(), AUDIO_FORMAT_PCM_FLOAT,
+            in.data(), AUDIO_FORMAT_PCM_16_BIT, SAMPLES);
+    EXPECT_EQ(before + SAMPLES * sizeof(float),
+            perfCounterPage()->counters[AUDIO_UTILS_PERF_COUNTER_CONVERTER_BYTES]);
+}
@@ -0,0 +1,259 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <audio_utils/polyphase_resampler.h>
+
+// Measures the amplitude of frequency toneHz in out, sampled at sampleRate,
+// skipping the filter transient at both ends.
+static double toneAmplitude(const std::vector<int16_t>& out, uint32_t channels,
+        uint32_t channel, uint32_t sampleRate, double toneHz, size_t skipFrames) {
+    double sumRe = 0.;
+    double sumIm = 0.;
+    const size_t frames = out.size() / channels;
+    size_t used = 0;
+    for (size_t i = skipFrames; i + skipFrames < frames; ++i) {
+        const double theta = 2. * M_PI * toneHz * i / sampleRate;
+        sumRe += out[i * channels + channel] * cos(theta);
+        sumIm += out[i * channels + channel] * sin(theta);
+        ++used;
+    }
+    return 2. * sqrt(sumRe * sumRe + sumIm * sumIm) / used;
+}
+
+static std::vector<int16_t> makeTone(size_t frames, uint32_t channels,
+        uint32_t sampleRate, double toneHz, double amplitude) {
+    std::vector<int16_t> v(frames * channels);
+    for (size_t i = 0; i < frames; ++i) {
+        const int16_t s = (int16_t)lrint(
+                amplitude * 32767. * sin(2. * M_PI * toneHz * i / sampleRate));
+        for (uint32_t ch = 0; ch < channels; ++ch) {
+            v[i * channels + ch] = s;
+        }
+    }
+    return v;
+}
+
+// Feeds in through the resampler in chunks and returns everything produced.
+static std::vector<int16_t> resampleAll(struct polyphase_resampler *rs,
+        const std::vector<int16_t>& in, uint32_t channels, size_t chunkFrames) {
+    std::vector<int16_t> out;
+    const size_t inFrames = in.size() / channels;
+    std::vector<int16_t> outChunk((4 * chunkFrames + 16) * channels);
+    for (size_t pos = 0; pos < inFrames; pos += chunkFrames) {
+        size_t inCount = std::min(chunkFrames, inFrames - pos);
+        size_t outCount = outChunk.size() / channels;
+        EXPECT_EQ(0, polyphase_resampler_process(rs, in.data() + pos * channels,
+                &inCount, outChunk.data(), &outCount));
+        out.insert(out.end(), outChunk.begin(),
+                outChunk.begin() + outCount * channels);
+    }
+    return out;
+}
+
+TEST(polyphase_resampler, downsample_tone) {
+    // a 1 kHz tone must survive 48k -> 16k within a fraction of a dB.
+    struct polyphase_resampler *rs = polyphase_resampler_create(48000, 16000, 1);
+    ASSERT_NE(nullptr, rs);
+
+    auto in = makeTone(48000, 1, 48000, 1000., 0.5);
+    auto out = resampleAll(rs, in, 1, 480);
+    EXPECT_NEAR(16000, out.size() / 1, 64);
+
+    const double amplitude = toneAmplitude(out, 1, 0, 16000, 1000., 256);
+    EXPECT_NEAR(0.5 * 32767., amplitude, 0.05 * 32767.);
+    polyphase_resampler_destroy(rs);
+}
+
+TEST(polyphase_resampler, downsample_rejects_alias) {
+    // a 14 kHz tone is above the 16 kHz output Nyquist band and must be
+    // strongly attenuated, not folded to 2 kHz.
+    struct polyphase_resampler *rs = polyphase_resampler_create(48000, 16000, 1);
+    ASSERT_NE(nullptr, rs);
+
+    auto in = makeTone(48000, 1, 48000, 14000., 0.5);
+    auto out = resampleAll(rs, in, 1, 480);
+
+    const double alias = toneAmplitude(out, 1, 0, 16000, 2000., 256);
+    EXPECT_LT(alias, 0.02 * 32767.) << "alias attenuation too weak";
+    polyphase_resampler_destroy(rs);
+}
+
+TEST(polyphase_resampler, upsample_tone) {
+    struct polyphase_resampler *rs = polyphase_resampler_create(16000, 48000, 1);
+    ASSERT_NE(nullptr, rs);
+
+    auto in = makeTone(16000, 1, 16000, 1000., 0.5);
+    auto out = resampleAll(rs, in, 1, 160);
+    EXPECT_NEAR(48000, out.size() / 1, 64);
+
+    const double amplitude = toneAmplitude(out, 1, 0, 48000, 1000., 256);
+    EXPECT_NEAR(0.5 * 32767., amplitude, 0.05 * 32767.);
+    polyphase_resampler_destroy(rs);
+}
+
+TEST(polyphase_resampler, fractional_ratio_stereo) {
+    // 44.1k -> 48k stereo with different tones per channel.
+    struct polyphase_resampler *rs = polyphase_resampler_create(44100, 48000, 2);
+    ASSERT_NE(nullptr, rs);
+
+    const size_t inFrames = 44100;
+    std::vector<int16_t> in(inFrames * 2);
+    for (size_t i = 0; i < inFrames; ++i) {
+        in[i * 2] = (int16_t)lrint(0.4 * 32767. * sin(2. * M_PI * 500. * i / 44100.));
+        in[i * 2 + 1] = (int16_t)lrint(0.3 * 32767. * sin(2. * M_PI * 3000. * i / 44100.));
+    }
+    auto out = resampleAll(rs, in, 2, 441);
+    EXPECT_NEAR(48000, out.size() / 2, 64);
+
+    EXPECT_NEAR(0.4 * 32767., toneAmplitude(out, 2, 0, 48000, 500., 256),
+            0.05 * 32767.);
+    EXPECT_NEAR(0.3 * 32767., toneAmplitude(out, 2, 1, 48000, 3000., 256),
+            0.05 * 32767.);
+    polyphase_resampler_destroy(rs);
+}
+
+TEST(polyphase_resampler, rational_deterministic_blocks) {
+    // 147:160 takes the exact rational path: once the history has primed,
+    // every 147 input frames must yield exactly 160 output frames.
+    struct polyphase_resampler *rs = polyphase_resampler_create(44100, 48000, 1);
+    ASSERT_NE(nullptr, rs);
+
+    auto in = makeTone(44100, 1, 44100, 1000., 0.5);
+    std::vector<int16_t> out(2 * 160);
+    for (size_t off = 0, call = 0; off + 147 <= in.size(); off += 147, ++call) {
+        size_t inFrames = 147;
+        size_t outFrames = out.size();
+        ASSERT_EQ(0, polyphase_resampler_process(rs, in.data() + off, &inFrames,
+                out.data(), &outFrames));
+        if (call > 0) {
+            EXPECT_EQ(160u, outFrames) << "call " << call;
+        }
+    }
+    polyphase_resampler_destroy(rs);
+}
+
+TEST(polyphase_resampler, split_invariance) {
+    // the output must not depend on how the input is split across calls.
+    auto in = makeTone(4800, 1, 48000, 1000., 0.5);
+
+    std::vector<int16_t> ref;
+    {
+        struct polyphase_resampler *rs = polyphase_resampler_create(48000, 16000, 1);
+        ASSERT_NE(nullptr, rs);
+        ref = resampleAll(rs, in, 1, 4800);
+        polyphase_resampler_destroy(rs);
+    }
+    for (size_t chunk : {1, 7, 160, 480}) {
+        struct polyphase_resampler *rs = polyphase_resampler_create(48000, 16000, 1);
+        ASSERT_NE(nullptr, rs);
+        auto out = resampleAll(rs, in, 1, chunk);
+        EXPECT_EQ(ref, out) << "chunk " << chunk;
+        polyphase_resampler_destroy(rs);
+    }
+}
+
+TEST(polyphase_resampler, reset_reproduces) {
+    auto in = makeTone(4800, 1, 48000, 1000., 0.5);
+    struct polyphase_resampler *rs = polyphase_resampler_create(48000, 16000, 1);
+    ASSERT_NE(nullptr, rs);
+
+    auto first = resampleAll(rs, in, 1, 480);
+    polyphase_resampler_reset(rs);
+    auto second = resampleAll(rs, in, 1, 480);
+    EXPECT_EQ(first, second);
+    polyphase_resampler_destroy(rs);
+}
+
+TEST(polyphase_resampler, latency) {
+    struct polyphase_resampler *rs = polyphase_resampler_create(48000, 16000, 1);
+    ASSERT_NE(nullptr, rs);
+    EXPECT_GT(polyphase_resampler_input_latency(rs), 0u);
+    polyphase_resampler_destroy(rs);
+}
+
+TEST(polyphase_resampler, bank_matches_independent) {
+    // a bank fed in lockstep must be bitexact with independent resamplers.
+    constexpr uint32_t kStreams = 16;
+    constexpr uint32_t kChannels = 2;
+    constexpr size_t kInFrames = 4800;
+    constexpr size_t kChunk = 480;
+
+    std::vector<std::vector<int16_t>> in(kStreams);
+    for (uint32_t s = 0; s < kStreams; ++s) {
+        in[s] = makeTone(kInFrames, kChannels, 48000, 400. + 100. * s, 0.4);
+    }
+
+    std::vector<std::vector<int16_t>> ref(kStreams);
+    for (uint32_t s = 0; s < kStreams; ++s) {
+        struct polyphase_resampler *rs = polyphase_resampler_create(48000, 16000, kChannels);
+        ASSERT_NE(nullptr, rs);
+        ref[s] = resampleAll(rs, in[s], kChannels, kChunk);
+        polyphase_resampler_destroy(rs);
+    }
+
+    struct polyphase_resampler_bank *bank =
+            polyphase_resampler_bank_create(48000, 16000, kChannels, kStreams);
+    ASSERT_NE(nullptr, bank);
+    EXPECT_GT(polyphase_resampler_bank_input_latency(bank), 0u);
+
+    std::vector<std::vector<int16_t>> out(kStreams);
+    std::vector<std::vector<int16_t>> outChunk(
+            kStreams, std::vector<int16_t>((4 * kChunk + 16) * kChannels));
+    for (size_t pos = 0; pos < kInFrames; pos += kChunk) {
+        const int16_t *inPtrs[kStreams];
+        int16_t *outPtrs[kStreams];
+        for (uint32_t s = 0; s < kStreams; ++s) {
+            inPtrs[s] = in[s].data() + pos * kChannels;
+            outPtrs[s] = outChunk[s].data();
+        }
+        size_t inCount = std::min(kChunk, kInFrames - pos);
+        size_t outCount = outChunk[0].size() / kChannels;
+        ASSERT_EQ(0, polyphase_resampler_bank_process(bank, inPtrs, &inCount,
+                outPtrs, &outCount));
+        for (uint32_t s = 0; s < kStreams; ++s) {
+            out[s].insert(out[s].end(), outChunk[s].begin(),
+                    outChunk[s].begin() + outCount * kChannels);
+        }
+    }
+    for (uint32_t s = 0; s < kStreams; ++s) {
+        EXPECT_EQ(ref[s], out[s]) << "stream " << s;
+    }
+
+    // after reset the first stream reproduces its output.
+    polyphase_resampler_bank_reset(bank);
+    std::vector<int16_t> again;
+    for (size_t pos = 0; pos < kInFrames; pos += kChunk) {
+        const int16_t *inPtrs[kStreams];
+        int16_t *outPtrs[kStreams];
+        for (uint32_t s = 0; s < kStreams; ++s) {
+            inPtrs[s] = in[s].data() + pos * kChannels;
+            outPtrs[s] = outChunk[s].data();
+        }
+        size_t inCount = std::min(kChunk, kInFrames - pos);
+        size_t outCount = outChunk[0].size() / kChannels;
+        ASSERT_EQ(0, polyphase_resampler_bank_process(bank, inPtrs, &inCount,
+                outPtrs, &outCount));
+        again.insert(again.end(), outChunk[0].begin(),
+                outChunk[0].begin() + outCount * kChannels);
+    }
+    EXPECT_EQ(out[0], again);
+    polyphase_resampler_bank_destroy(bank);
+}
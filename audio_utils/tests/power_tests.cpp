@@ -19,6 +19,7 @@
 
 #include <cmath>
 #include <math.h>
+#include <vector>
 
 #include <audio_utils/power.h>
 #include <gtest/gtest.h>
@@ -162,6 +163,60 @@ TEST(audio_utils_power, power_mono_ramp) {
     }
 }
 
+// the fused single-pass kernel must agree with per-channel energy_mono
+// on deinterleaved copies, and with a scalar peak scan.
+template <typename T>
+void testEnergyPeak(audio_format_t format, size_t channelCount, size_t frames) {
+    std::vector<T> interleaved(frames * channelCount);
+    // deterministic pseudo-random pattern with mixed signs
+    uint32_t seed = 0x1fe3c0de;
+    for (auto& sample : interleaved) {
+        seed = seed * 1664525 + 1013904223;
+        sample = (T)(int32_t)seed;
+    }
+
+    std::vector<float> energy(channelCount);
+    std::vector<float> peak(channelCount);
+    audio_utils_compute_energy_peak(interleaved.data(), format, frames, channelCount,
+            energy.data(), peak.data());
+
+    std::vector<T> mono(frames);
+    for (size_t c = 0; c < channelCount; ++c) {
+        for (size_t i = 0; i < frames; ++i) {
+            mono[i] = interleaved[i * channelCount + c];
+        }
+        const float expected = audio_utils_compute_energy_mono(mono.data(), format, frames);
+        EXPECT_NEAR(expected, energy[c], expected * 1e-5)
+                << "channelCount " << channelCount << " channel " << c;
+        // peak^2 <= energy <= frames * peak^2
+        EXPECT_LE(peak[c] * peak[c], energy[c] * (1.f + 1e-5f));
+        EXPECT_LE(energy[c], peak[c] * peak[c] * frames * (1.f + 1e-5f));
+    }
+
+    // peak is optional
+    std::vector<float> energyOnly(channelCount);
+    audio_utils_compute_energy_peak(interleaved.data(), format, frames, channelCount,
+            energyOnly.data(), nullptr);
+    EXPECT_EQ(energy, energyOnly);
+}
+
+TEST(audio_utils_power, energy_peak) {
+    for (size_t channelCount : { 1, 2, 3, 6, 8 }) {
+        for (size_t frames : { 1, 7, 16, 37 }) {
+            testEnergyPeak<int16_t>(AUDIO_FORMAT_PCM_16_BIT, channelCount, frames);
+            testEnergyPeak<int32_t>(AUDIO_FORMAT_PCM_32_BIT, channelCount, frames);
+        }
+    }
+    // peak of a known float buffer
+    const float buffer[] = { 0.5f, -0.25f, -1.f, 0.75f };  // 2 frames, 2 channels
+    float energy[2], peak[2];
+    audio_utils_compute_energy_peak(buffer, AUDIO_FORMAT_PCM_FLOAT, 2, 2, energy, peak);
+    EXPECT_EQ(0.5f * 0.5f + 1.f, energy[0]);
+    EXPECT_EQ(0.25f * 0.25f + 0.75f * 0.75f, energy[1]);
+    EXPECT_EQ(1.f, peak[0]);
+    EXPECT_EQ(0.75f, peak[1]);
+}
+
 TEST(audio_utils_power, power_from) {
     EXPECT_EQ(0.f, audio_utils_power_from_amplitude(1.f));
     EXPECT_EQ(-INFINITY, audio_utils_power_from_amplitude(0.f));
@@ -171,3 +226,72 @@ TEST(audio_utils_power, power_from) {
     EXPECT_EQ(-INFINITY, audio_utils_power_from_energy(0.f));
     EXPECT_TRUE(std::isnan(audio_utils_power_from_energy(-1.f)));
 }
+
+TEST(audio_utils_power, kweighted_energy) {
+    constexpr uint32_t sampleRate = 48000;
+    constexpr size_t frames = 48000;
+    audio_utils_kweight_t *kweight = audio_utils_kweight_create(sampleRate, 1);
+    ASSERT_NE(nullptr, kweight);
+
+    std::vector<float> buffer(frames);
+    float energy;
+
+    // dc is rejected by the RLB highpass.
+    std::fill(buffer.begin(), buffer.end(), 0.5f);
+    audio_utils_compute_energy_kweighted(kweight, buffer.data(), frames, &energy);
+    EXPECT_LT(energy / frames, 1e-3f);
+
+    // the K-weighting gain at 997 Hz is +0.691 dB - the gain the LKFS
+    // formula's -0.691 dB offset exists to compensate (BS.1770).
+    auto sine = [&](float frequency) {
+        for (size_t i = 0; i < frames; ++i) {
+            buffer[i] = sinf(2.f * M_PI * frequency * i / sampleRate);
+        }
+    };
+    sine(997.f);
+    audio_utils_kweight_reset(kweight);
+    audio_utils_compute_energy_kweighted(kweight, buffer.data(), frames, &energy);
+    const float unweighted =
+            audio_utils_compute_energy_mono(buffer.data(), AUDIO_FORMAT_PCM_FLOAT, frames);
+    EXPECT_NEAR(0.691f, audio_utils_power_from_energy(energy)
+            - audio_utils_power_from_energy(unweighted), 0.05f);
+
+    // a 10 kHz sine lands on the +4 dB shelf.
+    sine(10000.f);
+    audio_utils_kweight_reset(kweight);
+    audio_utils_compute_energy_kweighted(kweight, buffer.data(), frames, &energy);
+    const float unweighted10k =
+            audio_utils_compute_energy_mono(buffer.data(), AUDIO_FORMAT_PCM_FLOAT, frames);
+    EXPECT_NEAR(4.f, audio_utils_power_from_energy(energy)
+            - audio_utils_power_from_energy(unweighted10k), 0.25f);
+
+    audio_utils_kweight_free(kweight);
+}
+
+TEST(audio_utils_power, kweighted_state_continuity) {
+    constexpr uint32_t sampleRate = 44100;
+    constexpr size_t frames = 1024;
+    constexpr size_t channels = 2;
+    std::vector<float> buffer(frames * channels);
+    for (size_t i = 0; i < buffer.size(); ++i) {
+        buffer[i] = sinf(i * 0.37f) * 0.5f;
+    }
+
+    // one pass over the whole buffer...
+    audio_utils_kweight_t *whole = audio_utils_kweight_create(sampleRate, channels);
+    float wholeEnergy[channels];
+    audio_utils_compute_energy_kweighted(whole, buffer.data(), frames, wholeEnergy);
+
+    // ...matches two passes over the halves, since the filter state carries.
+    audio_utils_kweight_t *split = audio_utils_kweight_create(sampleRate, channels);
+    float energy1[channels], energy2[channels];
+    audio_utils_compute_energy_kweighted(split, buffer.data(), frames / 2, energy1);
+    audio_utils_compute_energy_kweighted(split,
+            buffer.data() + frames / 2 * channels, frames / 2, energy2);
+    for (size_t c = 0; c < channels; ++c) {
+        EXPECT_NEAR(wholeEnergy[c], energy1[c] + energy2[c], wholeEnergy[c] * 1e-5f);
+    }
+
+    audio_utils_kweight_free(whole);
+    audio_utils_kweight_free(split);
+}
@@ -20,6 +20,7 @@
 #include <audio_utils/PowerLog.h>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <thread>
 #include <log/log.h>
 
 using namespace android;
@@ -104,6 +105,210 @@ Signal power history:
      */
 }
 
+TEST(audio_utils_powerlog, shared_region) {
+    constexpr size_t entries = 16;
+    auto plog = std::make_unique<PowerLog>(
+            48000 /* sampleRate */,
+            1 /* channelCount */,
+            AUDIO_FORMAT_PCM_16_BIT,
+            entries,
+            1 /* framesPerEntry */);
+
+    std::vector<char> region(PowerLog::sharedSize(entries));
+
+    // a too-small region is rejected.
+    EXPECT_EQ(BAD_VALUE, plog->setSharedRegion(region.data(), region.size() - 1));
+    EXPECT_EQ(NO_ERROR, plog->setSharedRegion(region.data(), region.size()));
+
+    const int16_t zero = 0;
+    const int16_t half = 0x4000;
+    plog->log(&half, 1 /* frames */, 10 /* nowNs */);
+    plog->log(&half, 1 /* frames */, 11 /* nowNs */);
+    plog->log(&zero, 1 /* frames */, 12 /* nowNs */);
+
+    std::vector<std::pair<int64_t, float>> snapshot;
+    size_t idx;
+    EXPECT_TRUE(PowerLog::readSharedRegion(region.data(), region.size(), &snapshot, &idx));
+    ASSERT_EQ(entries, snapshot.size());
+    EXPECT_EQ((size_t)3, idx);
+    EXPECT_EQ(10, snapshot[0].first);
+    EXPECT_GT(snapshot[0].second, 0.f);
+    EXPECT_EQ(snapshot[0].second, snapshot[1].second);
+    EXPECT_EQ(0.f, snapshot[2].second);  // zero terminates the signal
+
+    // after detach, new entries no longer appear in the region.
+    EXPECT_EQ(NO_ERROR, plog->setSharedRegion(nullptr, 0));
+    plog->log(&half, 1 /* frames */, 13 /* nowNs */);
+    EXPECT_TRUE(PowerLog::readSharedRegion(region.data(), region.size(), &snapshot, &idx));
+    EXPECT_EQ((size_t)3, idx);
+
+    // a garbage region is rejected.
+    region.assign(region.size(), 0);
+    EXPECT_FALSE(PowerLog::readSharedRegion(region.data(), region.size(), &snapshot, &idx));
+}
+
+TEST(audio_utils_powerlog, shared_region_concurrent) {
+    constexpr size_t entries = 64;
+    auto plog = std::make_unique<PowerLog>(
+            48000 /* sampleRate */,
+            1 /* channelCount */,
+            AUDIO_FORMAT_PCM_16_BIT,
+            entries,
+            1 /* framesPerEntry */);
+    std::vector<char> region(PowerLog::sharedSize(entries));
+    ASSERT_EQ(NO_ERROR, plog->setSharedRegion(region.data(), region.size()));
+
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        const int16_t half = 0x4000;
+        for (int64_t i = 0; i < 20000; ++i) {
+            plog->log(&half, 1 /* frames */, i + 1 /* nowNs */);
+            // yield periodically: a writer in a tight loop can legitimately
+            // starve the bounded-retry reader, and this test checks snapshot
+            // consistency, not reader progress under saturation.
+            if ((i & 255) == 0) {
+                std::this_thread::yield();
+            }
+        }
+        done = true;
+    });
+
+    // observers must always obtain consistent snapshots while logging runs.
+    std::vector<std::pair<int64_t, float>> snapshot;
+    size_t idx;
+    size_t successes = 0;
+    while (!done) {
+        if (PowerLog::readSharedRegion(region.data(), region.size(), &snapshot, &idx)) {
+            ++successes;
+            EXPECT_LT(idx, entries);
+        }
+    }
+    writer.join();
+    // the writer is quiescent now, so this snapshot cannot fail; it also
+    // guarantees at least one success even if the writer won every race above.
+    ASSERT_TRUE(PowerLog::readSharedRegion(region.data(), region.size(), &snapshot, &idx));
+    ++successes;
+    EXPECT_GT(successes, (size_t)0);
+    EXPECT_EQ(20000, snapshot[(idx + entries - 1) % entries].first);
+}
+
+TEST(audio_utils_powerlog, channel_energies) {
+    constexpr size_t entries = 16;
+    auto plog = std::make_unique<PowerLog>(
+            48000 /* sampleRate */,
+            2 /* channelCount */,
+            AUDIO_FORMAT_PCM_FLOAT,
+            entries,
+            2 /* framesPerEntry */);
+
+    // stereo frames with a deliberate channel imbalance: left 0.5, right 0.25.
+    const float frame[2] = {0.5f, 0.25f};
+    const float signal[6] = {0.5f, 0.25f, 0.5f, 0.25f, 0.5f, 0.25f};
+    const float zero[4] = {};
+
+    // 3 frames: completes one entry (chunked path) and leaves one frame pending.
+    plog->log(signal, 3 /* frames */, 1 /* nowNs */);
+    // 1 frame: completes the second entry through the precomputed pass.
+    plog->log(frame, 1 /* frames */, 2 /* nowNs */);
+    // zero terminates the signal.
+    plog->log(zero, 2 /* frames */, 3 /* nowNs */);
+
+    size_t idx;
+    const auto energies = plog->channelEnergies(&idx);
+    ASSERT_EQ(entries * 2, energies.size());
+    EXPECT_EQ((size_t)3, idx);  // two signal entries and the zero terminator
+    // each entry holds 2 frames: left 2 * 0.5^2, right 2 * 0.25^2.
+    for (size_t entry = 0; entry < 2; ++entry) {
+        EXPECT_NEAR(0.5f, energies[entry * 2], 1e-6);
+        EXPECT_NEAR(0.125f, energies[entry * 2 + 1], 1e-6);
+    }
+    EXPECT_EQ(0.f, energies[2 * 2]);  // the terminator row is zero
+    EXPECT_EQ(0.f, energies[2 * 2 + 1]);
+
+    // a later signal makes the dump emit the per-channel annotation.
+    plog->log(signal, 2 /* frames */, 4 /* nowNs */);
+    const std::string s = plog->dumpToString(
+            "" /* prefix */, 0 /* lines */, 0 /* limitNs */, false /* logPlot */);
+    EXPECT_NE(std::string::npos, s.find("] sum("));
+    EXPECT_NE(std::string::npos, s.find(" ch("));
+}
+
+TEST(audio_utils_powerlog, realtime) {
+    // a wait-free fed log must dump identically to a log() fed one
+    // when given the same energies and timestamps.
+    auto plog = std::make_unique<PowerLog>(
+            48000 /* sampleRate */,
+            1 /* channelCount */,
+            AUDIO_FORMAT_PCM_16_BIT,
+            100 /* entries */,
+            1 /* framesPerEntry */);
+    auto rlog = std::make_unique<PowerLog>(
+            48000 /* sampleRate */,
+            1 /* channelCount */,
+            AUDIO_FORMAT_PCM_16_BIT,
+            100 /* entries */,
+            1 /* framesPerEntry */);
+    ASSERT_EQ(NO_ERROR, rlog->enableRealtimeLog());
+
+    const int16_t zero = 0;
+    const int16_t half = 0x4000;  // energy 0.25 per frame
+
+    for (int64_t i = 0; i < 3; ++i) {
+        plog->log(&half, 1 /* frames */, i + 1 /* nowNs */);
+        rlog->logRealtime(0.25f /* energy */, 1 /* frames */, i + 1 /* nowNs */);
+    }
+    plog->log(&zero, 1 /* frames */, 4 /* nowNs */);
+    rlog->logRealtime(0.f /* energy */, 1 /* frames */, 4 /* nowNs */);
+
+    // the dump folds pending entries without an explicit foldRealtimeEntries().
+    EXPECT_EQ(plog->dumpToString(), rlog->dumpToString());
+    EXPECT_EQ((uint32_t)0, rlog->realtimeOverruns());
+
+    // an entry spanning several bins distributes its energy evenly.
+    rlog->logRealtime(0.75f /* energy */, 3 /* frames */, 10 /* nowNs */);
+    rlog->foldRealtimeEntries();
+    for (int64_t i = 0; i < 3; ++i) {
+        plog->log(&half, 1 /* frames */, i + 10 /* nowNs */);
+    }
+    EXPECT_EQ(plog->dumpToString(), rlog->dumpToString());
+
+    // interleaving with log() folds in arrival order.
+    rlog->logRealtime(0.25f /* energy */, 1 /* frames */, 20 /* nowNs */);
+    rlog->log(&half, 1 /* frames */, 21 /* nowNs */);
+    plog->log(&half, 1 /* frames */, 20 /* nowNs */);
+    plog->log(&half, 1 /* frames */, 21 /* nowNs */);
+    EXPECT_EQ(plog->dumpToString(), rlog->dumpToString());
+}
+
+TEST(audio_utils_powerlog, realtime_overrun) {
+    auto plog = std::make_unique<PowerLog>(
+            48000 /* sampleRate */,
+            1 /* channelCount */,
+            AUDIO_FORMAT_PCM_16_BIT,
+            100 /* entries */,
+            1 /* framesPerEntry */);
+
+    // without enableRealtimeLog() the producer path is a silent no-op.
+    plog->logRealtime(0.25f /* energy */, 1 /* frames */, 1 /* nowNs */);
+    EXPECT_EQ((uint32_t)0, plog->realtimeOverruns());
+    EXPECT_EQ((size_t)1, countNewLines(plog->dumpToString()));  // header only
+
+    ASSERT_EQ(NO_ERROR, plog->enableRealtimeLog(4 /* capacity */));
+    for (int64_t i = 0; i < 6; ++i) {
+        plog->logRealtime(0.25f /* energy */, 1 /* frames */, i + 1 /* nowNs */);
+    }
+    // the ring holds 4 entries; the last 2 are dropped, never blocking.
+    EXPECT_EQ((uint32_t)2, plog->realtimeOverruns());
+    plog->foldRealtimeEntries();
+    // the 4 retained entries are in the history; the ring is free again.
+    plog->logRealtime(0.25f /* energy */, 1 /* frames */, 7 /* nowNs */);
+    plog->foldRealtimeEntries();
+    EXPECT_EQ((uint32_t)2, plog->realtimeOverruns());
+    const std::string s = plog->dumpToString(
+            "" /* prefix */, 0 /* lines */, 0 /* limitNs */, false /* logPlot */);
+    EXPECT_EQ((size_t)2, countNewLines(s));  // header + one signal line
+}
+
 TEST(audio_utils_powerlog, c) {
     power_log_t *power_log = power_log_create(
             48000 /* sample_rate */,
@@ -14,7 +14,9 @@
  * limitations under the License.
  */
 
+#include <fenv.h>
 #include <math.h>
+#include <random>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -739,6 +741,97 @@ void checkAddedClampedu8(uint8_t *out, const uint8_t *in1,
     delete[] outi16ary;
 }
 
+TEST(audio_utils_primitives, memcpy_to_i16_from_float_nt) {
+    // the non-temporal variant must produce identical samples to the
+    // cacheable one, at any destination misalignment and tail length.
+    constexpr size_t size = 65536;
+    std::vector<float> fary(size);
+    std::vector<int16_t> i16ref(size);
+    std::vector<int16_t> i16ary(size);
+
+    for (size_t i = 0; i < size; ++i) {
+        fary[i] = (float) i / (size / 2) - 1.f;
+    }
+    for (size_t offset : { 0, 1, 3, 15 }) {
+        for (size_t count : { (size_t) 1, (size_t) 17, size - 15 }) {
+            zeroFill(i16ref);
+            zeroFill(i16ary);
+            memcpy_to_i16_from_float(i16ref.data() + offset, fary.data(), count);
+            memcpy_to_i16_from_float_nt(i16ary.data() + offset, fary.data(), count);
+            EXPECT_EQ(i16ref, i16ary) << "offset " << offset << " count " << count;
+        }
+    }
+}
+
+TEST(audio_utils_primitives, accumulate_with_gain) {
+    constexpr size_t size = 65536;
+    constexpr float gain = 0.75f;
+    int16_t *i16src = new int16_t[size];
+    float *fsrc = new float[size];
+    float *fdst = new float[size];
+    float *fref = new float[size];
+    uint8_t *p24src = new uint8_t[size * 3];
+
+    for (size_t i = 0; i < size; ++i) {
+        i16src[i] = i - 32768;
+        fref[i] = (float) i / size - 0.5f;
+    }
+    memcpy_to_float_from_i16(fsrc, i16src, size);
+    memcpy_to_p24_from_i16(p24src, i16src, size);
+
+    // i16 source
+    memcpy(fdst, fref, size * sizeof(float));
+    accumulate_float_from_i16_with_gain(fdst, i16src, size, gain);
+    for (size_t i = 0; i < size; ++i) {
+        EXPECT_EQ(fref[i] + float_from_i16(i16src[i]) * gain, fdst[i]);
+    }
+
+    // p24 source
+    memcpy(fdst, fref, size * sizeof(float));
+    accumulate_float_from_p24_with_gain(fdst, p24src, size, gain);
+    for (size_t i = 0; i < size; ++i) {
+        EXPECT_EQ(fref[i] + float_from_p24(p24src + i * 3) * gain, fdst[i]);
+    }
+
+    // float source
+    memcpy(fdst, fref, size * sizeof(float));
+    accumulate_float_from_float_with_gain(fdst, fsrc, size, gain);
+    for (size_t i = 0; i < size; ++i) {
+        EXPECT_EQ(fref[i] + fsrc[i] * gain, fdst[i]);
+    }
+
+    // per-channel gains, both the specialized stereo and the generic path
+    for (size_t channelCount : { 2, 3 }) {
+        const size_t frames = size / channelCount;
+        const float gains[] = { 0.25f, -1.f, 0.5f };
+        memcpy(fdst, fref, size * sizeof(float));
+        accumulate_float_from_float_with_channel_gains(
+                fdst, fsrc, frames, channelCount, gains);
+        for (size_t i = 0; i < frames * channelCount; ++i) {
+            EXPECT_EQ(fref[i] + fsrc[i] * gains[i % channelCount], fdst[i]);
+        }
+        memcpy(fdst, fref, size * sizeof(float));
+        accumulate_float_from_i16_with_channel_gains(
+                fdst, i16src, frames, channelCount, gains);
+        for (size_t i = 0; i < frames * channelCount; ++i) {
+            EXPECT_EQ(fref[i] + float_from_i16(i16src[i]) * gains[i % channelCount], fdst[i]);
+        }
+        memcpy(fdst, fref, size * sizeof(float));
+        accumulate_float_from_p24_with_channel_gains(
+                fdst, p24src, frames, channelCount, gains);
+        for (size_t i = 0; i < frames * channelCount; ++i) {
+            EXPECT_EQ(fref[i] + float_from_p24(p24src + i * 3) * gains[i % channelCount],
+                    fdst[i]);
+        }
+    }
+
+    delete[] p24src;
+    delete[] fref;
+    delete[] fdst;
+    delete[] fsrc;
+    delete[] i16src;
+}
+
 TEST(audio_utils_primitives, accumulate) {
     int16_t *i16ref = new int16_t[65536];
     int16_t *i16add = new int16_t[65536];
@@ -859,3 +952,371 @@ TEST(audio_utils_primitives, MemcpyToFloatFromFloatWithClamping) {
 
     ASSERT_EQ(dst, expected) << "src=" << testing::PrintToString(src);
 }
+
+TEST(audio_utils_primitives, g711_round_trip) {
+    // every code must survive decode then encode, except the mu-law
+    // alternate zero 0x7f which canonicalizes to 0xff
+    for (int code = 0; code < 256; code++) {
+        const uint8_t u = (uint8_t)code;
+        const uint8_t u2 = ulaw_from_i16(i16_from_ulaw(u));
+        EXPECT_EQ(u == 0x7f ? 0xff : u, u2) << "ulaw code " << code;
+        const uint8_t a = (uint8_t)code;
+        EXPECT_EQ(a, alaw_from_i16(i16_from_alaw(a))) << "alaw code " << code;
+    }
+
+    // decoded zero codes are exactly zero
+    EXPECT_EQ(0, i16_from_ulaw(0xff));
+    EXPECT_EQ(0, i16_from_ulaw(0x7f));
+
+    // every 16-bit sample must decode back within its segment's step size
+    for (int i = lim16neg; i <= lim16pos; i++) {
+        const int16_t ival = (int16_t)i;
+        const int uerr = abs(i16_from_ulaw(ulaw_from_i16(ival)) - ival);
+        EXPECT_LE(uerr, 16 + (abs(i) >> 4)) << "ulaw sample " << i;
+        const int aerr = abs(i16_from_alaw(alaw_from_i16(ival)) - ival);
+        EXPECT_LE(aerr, 16 + (abs(i) >> 4)) << "alaw sample " << i;
+    }
+}
+
+TEST(audio_utils_primitives, g711_memcpy) {
+    constexpr size_t size = 65536;
+    std::vector<uint8_t> codes(size);
+    for (size_t i = 0; i < size; i++) {
+        codes[i] = (uint8_t)(i * 7 + (i >> 8));  // covers all codes, varied order
+    }
+
+    // bulk decode agrees with the scalar helpers for every count
+    // (exercises both the vector kernels and the remainder loop)
+    std::vector<int16_t> i16buf(size);
+    std::vector<float> fbuf(size);
+    for (const size_t count : {size_t(1), size_t(7), size_t(64), size_t(65), size}) {
+        zeroFill(i16buf);
+        memcpy_to_i16_from_ulaw(i16buf.data(), codes.data(), count);
+        for (size_t i = 0; i < count; i++) {
+            ASSERT_EQ(i16_from_ulaw(codes[i]), i16buf[i]) << "ulaw index " << i;
+        }
+        zeroFill(i16buf);
+        memcpy_to_i16_from_alaw(i16buf.data(), codes.data(), count);
+        for (size_t i = 0; i < count; i++) {
+            ASSERT_EQ(i16_from_alaw(codes[i]), i16buf[i]) << "alaw index " << i;
+        }
+    }
+
+    // the direct float paths match decode-then-scale
+    memcpy_to_float_from_ulaw(fbuf.data(), codes.data(), size);
+    for (size_t i = 0; i < size; i++) {
+        ASSERT_EQ(float_from_i16(i16_from_ulaw(codes[i])), fbuf[i]);
+    }
+    memcpy_to_float_from_alaw(fbuf.data(), codes.data(), size);
+    for (size_t i = 0; i < size; i++) {
+        ASSERT_EQ(float_from_i16(i16_from_alaw(codes[i])), fbuf[i]);
+    }
+
+    // encode every 16-bit value through the bulk and float paths
+    std::vector<int16_t> samples(size);
+    for (size_t i = 0; i < size; i++) {
+        samples[i] = (int16_t)(i + lim16neg);
+    }
+    std::vector<uint8_t> encoded(size);
+    memcpy_to_ulaw_from_i16(encoded.data(), samples.data(), size);
+    for (size_t i = 0; i < size; i++) {
+        ASSERT_EQ(ulaw_from_i16(samples[i]), encoded[i]);
+    }
+    memcpy_to_alaw_from_i16(encoded.data(), samples.data(), size);
+    for (size_t i = 0; i < size; i++) {
+        ASSERT_EQ(alaw_from_i16(samples[i]), encoded[i]);
+    }
+    memcpy_to_float_from_i16(fbuf.data(), samples.data(), size);
+    memcpy_to_ulaw_from_float(encoded.data(), fbuf.data(), size);
+    for (size_t i = 0; i < size; i++) {
+        ASSERT_EQ(ulaw_from_i16(samples[i]), encoded[i]);
+    }
+    memcpy_to_alaw_from_float(encoded.data(), fbuf.data(), size);
+    for (size_t i = 0; i < size; i++) {
+        ASSERT_EQ(alaw_from_i16(samples[i]), encoded[i]);
+    }
+
+    // in-place expanding decode (shared buffer start) is supported
+    std::vector<int16_t> inplace(size);
+    uint8_t *packed = (uint8_t *)inplace.data();
+    memcpy(packed, codes.data(), size);
+    memcpy_to_i16_from_ulaw(inplace.data(), packed, size);
+    for (size_t i = 0; i < size; i++) {
+        ASSERT_EQ(i16_from_ulaw(codes[i]), inplace[i]) << "in-place index " << i;
+    }
+}
+
+TEST(audio_utils_primitives, f16_scalar) {
+    // spot check exact values across the half encoding ranges
+    EXPECT_EQ(1.f, float_from_f16(0x3c00));
+    EXPECT_EQ(-2.f, float_from_f16(0xc000));
+    EXPECT_EQ(65504.f, float_from_f16(0x7bff));        // largest finite half
+    EXPECT_EQ(ldexpf(1.f, -14), float_from_f16(0x0400)); // smallest normal
+    EXPECT_EQ(ldexpf(1.f, -24), float_from_f16(0x0001)); // smallest subnormal
+    EXPECT_EQ(0.f, float_from_f16(0x0000));
+    EXPECT_EQ(-0.f, float_from_f16(0x8000));
+    EXPECT_TRUE(std::isinf(float_from_f16(0x7c00)));
+    EXPECT_TRUE(std::isnan(float_from_f16(0x7c01)));
+
+    // every non-NaN half code survives the round trip through float exactly
+    for (int code = 0; code < 65536; code++) {
+        const uint16_t h = (uint16_t)code;
+        const float f = float_from_f16(h);
+        if (std::isnan(f)) {
+            EXPECT_EQ(0x7e00, f16_from_float(f) & 0x7fff) << "half code " << code;
+            continue;
+        }
+        EXPECT_EQ(h, f16_from_float(f)) << "half code " << code;
+    }
+
+    // rounding is to nearest, ties to even, on the 13 dropped mantissa bits
+    EXPECT_EQ(0x3c00, f16_from_float(1.f + ldexpf(1.f, -12)));  // tie rounds to even (down)
+    EXPECT_EQ(0x3c01, f16_from_float(1.f + ldexpf(3.f, -12)));  // tie rounds to even (up)
+    EXPECT_EQ(0x3c00, f16_from_float(1.f + ldexpf(1.f, -11) - ldexpf(1.f, -20)));  // below tie
+    EXPECT_EQ(0x3c01, f16_from_float(1.f + ldexpf(1.f, -11) + ldexpf(1.f, -20)));  // above tie
+    EXPECT_EQ(0x7bff, f16_from_float(65519.f));   // just inside the largest half
+    EXPECT_EQ(0x7c00, f16_from_float(65520.f));   // tie with infinity rounds to infinity
+    EXPECT_EQ(0x7c00, f16_from_float(1.e9f));
+    EXPECT_EQ(0x0000, f16_from_float(ldexpf(1.f, -25)));  // tie with zero rounds to zero
+    EXPECT_EQ(0x0001, f16_from_float(ldexpf(1.5f, -25))); // rounds up to smallest subnormal
+    EXPECT_EQ(0x0400, f16_from_float(ldexpf(1.f, -14) - ldexpf(1.f, -26)));  // to normal
+}
+
+TEST(audio_utils_primitives, f16_memcpy) {
+    constexpr size_t size = 65536;
+    std::vector<uint16_t> codes(size);
+    for (size_t i = 0; i < size; i++) {
+        codes[i] = (uint16_t)(i * 7 + (i >> 8));  // covers all codes, varied order
+        if ((codes[i] & 0x7c00) == 0x7c00) {
+            codes[i] &= 0xfc00;  // replace NaN codes (keep infinities)
+        }
+    }
+
+    // bulk decode agrees with the scalar helper for every count
+    // (exercises both the vector kernels and the remainder loop)
+    std::vector<float> fbuf(size);
+    for (const size_t count : {size_t(1), size_t(7), size_t(64), size_t(65), size}) {
+        zeroFill(fbuf);
+        memcpy_to_float_from_f16(fbuf.data(), codes.data(), count);
+        for (size_t i = 0; i < count; i++) {
+            ASSERT_EQ(float_from_f16(codes[i]), fbuf[i]) << "index " << i;
+        }
+    }
+
+    // bulk encode agrees with the scalar helper, including the rounding of
+    // values that are not exactly representable
+    std::vector<float> samples(size);
+    std::minstd_rand gen(size);
+    std::uniform_real_distribution<float> dis(-1.5f, 1.5f);
+    for (size_t i = 0; i < size; i++) {
+        samples[i] = dis(gen);
+    }
+    std::vector<uint16_t> encoded(size);
+    for (const size_t count : {size_t(1), size_t(7), size_t(64), size_t(65), size}) {
+        zeroFill(encoded);
+        memcpy_to_f16_from_float(encoded.data(), samples.data(), count);
+        for (size_t i = 0; i < count; i++) {
+            ASSERT_EQ(f16_from_float(samples[i]), encoded[i]) << "index " << i;
+        }
+    }
+
+    // the i16 paths match composition with the float helpers
+    std::vector<int16_t> i16buf(size);
+    memcpy_to_i16_from_f16(i16buf.data(), codes.data(), size);
+    for (size_t i = 0; i < size; i++) {
+        ASSERT_EQ(clamp16_from_float(float_from_f16(codes[i])), i16buf[i]) << "index " << i;
+    }
+    memcpy_to_f16_from_i16(encoded.data(), i16buf.data(), size);
+    for (size_t i = 0; i < size; i++) {
+        ASSERT_EQ(f16_from_float(float_from_i16(i16buf[i])), encoded[i]) << "index " << i;
+    }
+
+    // in-place expanding decode (shared buffer start) is supported
+    std::vector<float> inplace(size);
+    uint16_t *packed = (uint16_t *)inplace.data();
+    memcpy(packed, codes.data(), size * sizeof(uint16_t));
+    memcpy_to_float_from_f16(inplace.data(), packed, size);
+    for (size_t i = 0; i < size; i++) {
+        ASSERT_EQ(float_from_f16(codes[i]), inplace[i]) << "in-place index " << i;
+    }
+}
+
+TEST(audio_utils_primitives, dither_state) {
+    constexpr uint32_t channels = 2;
+    constexpr size_t frames = 4096;
+    constexpr size_t count = frames * channels;
+
+    std::vector<float> src(count);
+    std::minstd_rand gen(count);
+    std::uniform_real_distribution<float> dis(-0.5f, 0.5f);
+    for (size_t i = 0; i < count; i++) {
+        src[i] = dis(gen);
+    }
+
+    // state carried across buffers: one call and a split stream are identical
+    audio_utils_dither_state whole;
+    audio_utils_dither_init(&whole, channels);
+    std::vector<int16_t> dstWhole(count);
+    memcpy_to_i16_from_float_dithered(dstWhole.data(), src.data(), frames, &whole);
+
+    audio_utils_dither_state split;
+    audio_utils_dither_init(&split, channels);
+    std::vector<int16_t> dstSplit(count);
+    constexpr size_t cut = 333;
+    memcpy_to_i16_from_float_dithered(dstSplit.data(), src.data(), cut, &split);
+    memcpy_to_i16_from_float_dithered(dstSplit.data() + cut * channels,
+            src.data() + cut * channels, frames - cut, &split);
+    EXPECT_EQ(dstWhole, dstSplit);
+
+    // a constant quarter-lsb input truncates to silence undithered; the
+    // dithered conversion must preserve it as the mean of the output
+    constexpr float quarterLsb = 0.25f / 32768.f;
+    std::vector<float> dc(count, quarterLsb);
+    audio_utils_dither_state state;
+    audio_utils_dither_init(&state, channels);
+    std::vector<int16_t> out(count);
+    memcpy_to_i16_from_float_dithered(out.data(), dc.data(), frames, &state);
+    double sum = 0.;
+    for (size_t i = 0; i < count; i++) {
+        ASSERT_LE(abs(out[i]), 4) << "index " << i;  // shaped dither noise is small
+        sum += out[i];
+    }
+    EXPECT_NEAR(0.25, sum / count, 0.05);
+
+    // out of range input clamps, and the error feedback recovers quickly
+    // instead of winding up during the sustained clipping
+    std::vector<float> loud(count, 2.f);
+    memcpy_to_i16_from_float_dithered(out.data(), loud.data(), frames, &state);
+    for (size_t i = channels * 4; i < count; i++) {  // after the shaping transient
+        ASSERT_EQ(32767, out[i]) << "index " << i;
+    }
+    std::vector<float> silence(count, 0.f);
+    memcpy_to_i16_from_float_dithered(out.data(), silence.data(), frames, &state);
+    for (size_t i = channels * 4; i < count; i++) {
+        ASSERT_LE(abs(out[i]), 4) << "index " << i;
+    }
+}
+
+template <typename T, typename S>
+static T clampRef(S sample, S limneg, S limpos) {
+    return (T)(sample < limneg ? limneg : sample > limpos ? limpos : sample);
+}
+
+TEST(audio_utils_primitives, branch_free_clamp) {
+    // sweep a window spanning both 16-bit rails, then the extremes
+    for (int64_t i = -(1 << 18); i <= (1 << 18); i++) {
+        const int32_t ival = (int32_t)i;
+        ASSERT_EQ((clampRef<int16_t, int32_t>(ival, lim16neg, lim16pos)), clamp16(ival))
+                << "sample " << ival;
+    }
+    for (const int32_t ival : {INT32_MIN, INT32_MIN + 1, INT32_MAX - 1, INT32_MAX}) {
+        EXPECT_EQ((clampRef<int16_t, int32_t>(ival, lim16neg, lim16pos)), clamp16(ival));
+    }
+
+    // windows around the q8.23 rails
+    for (int64_t i = -(1 << 24); i <= (1 << 24); i++) {
+        const int32_t ival = (int32_t)i;
+        ASSERT_EQ((clampRef<int32_t, int32_t>(ival, lim24neg, lim24pos)),
+                clamp24_from_q8_23(ival)) << "sample " << ival;
+        ASSERT_EQ((uint8_t)((clampRef<int32_t, int32_t>(ival, lim24neg, lim24pos) >> 16) + 0x80),
+                clamp8_from_q8_23(ival)) << "sample " << ival;
+    }
+
+    // windows around the 32-bit rails
+    for (int64_t i = lim32neg - (1 << 16); i <= lim32neg + (1 << 16); i++) {
+        ASSERT_EQ((clampRef<int32_t, int64_t>(i, lim32neg, lim32pos)), clamp32(i));
+    }
+    for (int64_t i = lim32pos - (1 << 16); i <= lim32pos + (1 << 16); i++) {
+        ASSERT_EQ((clampRef<int32_t, int64_t>(i, lim32neg, lim32pos)), clamp32(i));
+    }
+    EXPECT_EQ(INT32_MIN, clamp32(INT64_MIN));
+    EXPECT_EQ(INT32_MAX, clamp32(INT64_MAX));
+}
+
+TEST(audio_utils_primitives, saturating_add) {
+    const int32_t probes[] = {
+        INT32_MIN, INT32_MIN + 1, lim16neg, -1, 0, 1, lim16pos, INT32_MAX - 1, INT32_MAX,
+    };
+    for (const int32_t a : probes) {
+        for (const int32_t b : probes) {
+            const int64_t wide = (int64_t)a + b;
+            EXPECT_EQ(clamp32(wide), clamp32_add(a, b)) << a << " + " << b;
+            EXPECT_EQ(clamp16((int32_t)clamp16(a) + clamp16(b)),
+                    clamp16_add(clamp16(a), clamp16(b))) << a << " + " << b;
+        }
+    }
+    // saturation picks the rail matching the common sign of the operands
+    EXPECT_EQ(INT32_MAX, clamp32_add(INT32_MAX, 1));
+    EXPECT_EQ(INT32_MIN, clamp32_add(INT32_MIN, -1));
+    EXPECT_EQ(INT32_MAX - 1, clamp32_add(INT32_MAX, -1));
+    EXPECT_EQ(INT32_MIN + 1, clamp32_add(INT32_MIN, 1));
+}
+
+TEST(audio_utils_primitives, fenv_rounding_independence) {
+    // The float to integer conversions are documented not to depend on the
+    // dynamic rounding mode, so a caller using directed rounding for other
+    // DSP does not have to save and restore the mode around them.  Convert
+    // the same input - ties, near-ties, rails and ordinary values - under
+    // every fenv mode and require results identical to FE_TONEAREST.
+    std::vector<float> src;
+    for (int k = -66000; k <= 66000; k += 1237) {
+        src.push_back(k / 65536.f);
+        src.push_back((2 * k + 1) / 65536.f);            // i16 tie
+        src.push_back((2 * k + 1) / 65536.f + 1.f / (1 << 24)); // just above
+        src.push_back(nextafterf((2 * k + 1) / 65536.f, -2.f)); // just below
+        src.push_back((2 * k + 1) / 256.f / 2.f);        // u8 tie region
+    }
+    // (0.5f - 0x1p-25f) * 32768 is just below a tie and its float sum with 0.5f
+    // crosses a binade, so an add-half-then-truncate kernel double-rounds it
+    const float specials[] = { 0.f, -0.f, 1.f, -1.f, 2.f, -2.f, 16.f, -16.f,
+            1.f - 1.f / (1 << 24), -1.f + 1.f / (1 << 24), 1e-10f, -1e-10f,
+            (0.5f - 0x1p-25f) / 32768.f, -(0.5f - 0x1p-25f) / 32768.f };
+    src.insert(src.end(), specials, specials + ARRAY_SIZE(specials));
+    std::minstd_rand gen(42);
+    std::uniform_real_distribution<float> dis(-1.5f, 1.5f);
+    while (src.size() % 16 != 0) {  // SIMD-width multiple plus some extras
+        src.push_back(dis(gen));
+    }
+    const size_t count = src.size();
+
+    std::vector<int16_t> i16ref(count), i16got(count);
+    std::vector<uint8_t> u8ref(count), u8got(count);
+    std::vector<int32_t> i32ref(count), i32got(count);
+    std::vector<int32_t> q23ref(count), q23got(count);
+
+    const int origMode = fegetround();
+    ASSERT_EQ(0, fesetround(FE_TONEAREST));
+    memcpy_to_i16_from_float(i16ref.data(), src.data(), count);
+    memcpy_to_u8_from_float(u8ref.data(), src.data(), count);
+    memcpy_to_i32_from_float(i32ref.data(), src.data(), count);
+    memcpy_to_q8_23_from_float_with_clamp(q23ref.data(), src.data(), count);
+    std::vector<int32_t> q427ref(count);
+    std::vector<uint32_t> u428ref(count);
+    std::vector<uint16_t> u412ref(count);
+    for (size_t i = 0; i < count; ++i) {
+        q427ref[i] = clampq4_27_from_float(src[i]);
+        u428ref[i] = u4_28_from_float(src[i]);
+        u412ref[i] = u4_12_from_float(src[i]);
+        // vectorized conversions must be bit-identical to the scalar reference
+        ASSERT_EQ(clamp16_from_float(src[i]), i16ref[i]) << "index " << i;
+    }
+
+    const int modes[] = { FE_TOWARDZERO, FE_DOWNWARD, FE_UPWARD, FE_TONEAREST };
+    for (const int mode : modes) {
+        ASSERT_EQ(0, fesetround(mode));
+        memcpy_to_i16_from_float(i16got.data(), src.data(), count);
+        memcpy_to_u8_from_float(u8got.data(), src.data(), count);
+        memcpy_to_i32_from_float(i32got.data(), src.data(), count);
+        memcpy_to_q8_23_from_float_with_clamp(q23got.data(), src.data(), count);
+        EXPECT_EQ(i16ref, i16got) << "mode " << mode;
+        EXPECT_EQ(u8ref, u8got) << "mode " << mode;
+        EXPECT_EQ(i32ref, i32got) << "mode " << mode;
+        EXPECT_EQ(q23ref, q23got) << "mode " << mode;
+        for (size_t i = 0; i < count; ++i) {
+            ASSERT_EQ(q427ref[i], clampq4_27_from_float(src[i])) << "mode " << mode;
+            ASSERT_EQ(u428ref[i], u4_28_from_float(src[i])) << "mode " << mode;
+            ASSERT_EQ(u412ref[i], u4_12_from_float(src[i])) << "mode " << mode;
+        }
+    }
+    fesetround(origMode);
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <audio_utils/RampGenerator.h>
+#include <gtest/gtest.h>
+#include <math.h>
+#include <vector>
+
+using android::audio_utils::RampGenerator;
+
+TEST(audio_utils_ramp, constant_gain) {
+  RampGenerator ramp(2 /* channelCount */);
+  ASSERT_EQ(2u, ramp.getChannelCount());
+  ASSERT_FALSE(ramp.isRamping());
+
+  // gains start at unity.
+  std::vector<float> buffer = {1.f, -1.f, 0.5f, -0.5f};
+  ramp.process(buffer.data(), 2 /* frames */);
+  ASSERT_EQ((std::vector<float>{1.f, -1.f, 0.5f, -0.5f}), buffer);
+
+  // setGain() applies immediately without ramping.
+  ramp.setGain(0.5f);
+  ramp.process(buffer.data(), 2 /* frames */);
+  ASSERT_EQ((std::vector<float>{0.5f, -0.5f, 0.25f, -0.25f}), buffer);
+
+  // per channel gains.
+  const float gains[] = {2.f, 0.f};
+  ramp.setGains(gains);
+  ramp.process(buffer.data(), 2 /* frames */);
+  ASSERT_EQ((std::vector<float>{1.f, 0.f, 0.5f, 0.f}), buffer);
+  ASSERT_FALSE(ramp.isRamping());
+}
+
+TEST(audio_utils_ramp, linear_fill) {
+  constexpr size_t kRampFrames = 8;
+  RampGenerator ramp(1 /* channelCount */);
+  ramp.setGain(0.f);
+  ramp.rampLinear(1.f, kRampFrames);
+  ASSERT_TRUE(ramp.isRamping());
+
+  // the gain of frame i is i / kRampFrames, split across two fills.
+  std::vector<float> gains(kRampFrames);
+  ramp.fill(gains.data(), kRampFrames / 2);
+  ASSERT_TRUE(ramp.isRamping());
+  ramp.fill(gains.data() + kRampFrames / 2, kRampFrames / 2);
+  for (size_t i = 0; i < kRampFrames; ++i) {
+    EXPECT_EQ((float)i / kRampFrames, gains[i]) << "frame " << i;
+  }
+
+  // the ramp is complete and the target gain holds.
+  ASSERT_FALSE(ramp.isRamping());
+  ASSERT_EQ((std::vector<float>{1.f}), ramp.getGains());
+  ramp.fill(gains.data(), kRampFrames);
+  ASSERT_EQ(std::vector<float>(kRampFrames, 1.f), gains);
+}
+
+TEST(audio_utils_ramp, linear_process_blocks) {
+  constexpr size_t kBlock = RampGenerator::kRampBlockFrames;
+  constexpr size_t kFrames = 4 * kBlock;
+  RampGenerator ramp(1 /* channelCount */);
+  ramp.setGain(0.f);
+  ramp.rampLinear(1.f, kFrames);
+
+  // while ramping, the gain is constant over each block and steps at
+  // block boundaries.
+  std::vector<float> buffer(kFrames, 1.f);
+  ramp.process(buffer.data(), kFrames);
+  for (size_t i = 0; i < kFrames; ++i) {
+    const float expected = (float)(i - i % kBlock) / kFrames;
+    EXPECT_EQ(expected, buffer[i]) << "frame " << i;
+  }
+
+  // the ramp is complete and further processing applies the target.
+  ASSERT_FALSE(ramp.isRamping());
+  std::fill(buffer.begin(), buffer.end(), 0.5f);
+  ramp.process(buffer.data(), kFrames);
+  ASSERT_EQ(std::vector<float>(kFrames, 0.5f), buffer);
+}
+
+TEST(audio_utils_ramp, linear_stereo_targets) {
+  constexpr size_t kRampFrames = 8;
+  RampGenerator ramp(2 /* channelCount */);
+  const float targets[] = {0.f, 0.5f};
+  ramp.rampLinear(targets, kRampFrames);
+
+  // each channel ramps from unity to its own target.
+  std::vector<float> gains(kRampFrames * 2);
+  ramp.fill(gains.data(), kRampFrames);
+  for (size_t i = 0; i < kRampFrames; ++i) {
+    const float frac = (float)i / kRampFrames;
+    EXPECT_EQ(1.f - frac, gains[i * 2]) << "frame " << i;
+    EXPECT_EQ(1.f - 0.5f * frac, gains[i * 2 + 1]) << "frame " << i;
+  }
+  ASSERT_FALSE(ramp.isRamping());
+  ASSERT_EQ((std::vector<float>{0.f, 0.5f}), ramp.getGains());
+}
+
+TEST(audio_utils_ramp, exponential_approach) {
+  constexpr float kTimeConstantFrames = 16.f;
+  constexpr size_t kFrames = 64;
+  RampGenerator ramp(1 /* channelCount */);
+  ramp.setGain(0.f);
+  ramp.rampExponential(1.f, kTimeConstantFrames);
+  ASSERT_TRUE(ramp.isRamping());
+
+  // fill() follows the one-pole recursion.
+  std::vector<float> gains(kFrames);
+  ramp.fill(gains.data(), kFrames);
+  const float alpha = 1.f - expf(-1.f / kTimeConstantFrames);
+  float expected = 0.f;
+  for (size_t i = 0; i < kFrames; ++i) {
+    EXPECT_NEAR(expected, gains[i], 1e-6f) << "frame " << i;
+    expected += (1.f - expected) * alpha;
+  }
+  // after one time constant about 63% of the distance is covered.
+  EXPECT_NEAR(1.f - expf(-1.f), gains[16], 1e-3f);
+
+  // the ramp eventually snaps to exactly the target.
+  while (ramp.isRamping()) {
+    ramp.fill(gains.data(), kFrames);
+  }
+  ASSERT_EQ((std::vector<float>{1.f}), ramp.getGains());
+}
+
+TEST(audio_utils_ramp, apply_gains) {
+  // 6 channels exercises a fixed channel count dispatch.
+  const float gains[] = {0.f, 0.5f, 1.f, 2.f, -1.f, 0.25f};
+  std::vector<float> buffer;
+  for (size_t i = 0; i < 4; ++i) {
+    for (size_t j = 0; j < 6; ++j) {
+      buffer.push_back(1.f + i);
+    }
+  }
+  RampGenerator::applyGains(buffer.data(), 4 /* frames */, gains, 6 /* channelCount */);
+  for (size_t i = 0; i < 4; ++i) {
+    for (size_t j = 0; j < 6; ++j) {
+      EXPECT_EQ((1.f + i) * gains[j], buffer[i * 6 + j]) << "frame " << i << " channel " << j;
+    }
+  }
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2019 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <limits>
+
+#include <gtest/gtest.h>
+
+#include <audio_utils/safe_math.h>
+
+using namespace android::audio_utils;
+
+TEST(audio_utils_safe_math, safe_overflow_wraps)
+{
+    // the safe_* helpers guarantee 2's complement wrapping in the native type
+    EXPECT_EQ(std::numeric_limits<int32_t>::min(),
+            safe_add_overflow(std::numeric_limits<int32_t>::max(), int32_t(1)));
+    EXPECT_EQ(std::numeric_limits<int32_t>::max(),
+            safe_sub_overflow(std::numeric_limits<int32_t>::min(), int32_t(1)));
+    EXPECT_EQ(int32_t(-2),
+            safe_add_overflow(std::numeric_limits<int32_t>::max(),
+                    std::numeric_limits<int32_t>::max()));
+
+    // unsigned wrapping, as used for FIFO-style monotonic indices
+    EXPECT_EQ(uint32_t(0), safe_add_overflow(std::numeric_limits<uint32_t>::max(), 1u));
+    EXPECT_EQ(std::numeric_limits<uint32_t>::max(), safe_sub_overflow(0u, 1u));
+    EXPECT_EQ(uint32_t(10), safe_sub_overflow(uint32_t(5), uint32_t(0xfffffffb)));
+}
+
+TEST(audio_utils_safe_math, assume_no_overflow)
+{
+    // within the contract the assume variants are exact
+    EXPECT_EQ(int32_t(3), add_assume_no_overflow(int32_t(1), int32_t(2)));
+    EXPECT_EQ(int32_t(-1), sub_assume_no_overflow(int32_t(1), int32_t(2)));
+    EXPECT_EQ(std::numeric_limits<int32_t>::max(),
+            add_assume_no_overflow(std::numeric_limits<int32_t>::max() - 1, int32_t(1)));
+    EXPECT_EQ(std::numeric_limits<int32_t>::min(),
+            sub_assume_no_overflow(std::numeric_limits<int32_t>::min() + 1, int32_t(1)));
+    EXPECT_EQ(uint64_t(1) << 40,
+            add_assume_no_overflow(uint64_t(1) << 39, uint64_t(1) << 39));
+}
@@ -16,7 +16,9 @@
 
 #include <array>
 #include <climits>
+#include <limits>
 #include <math.h>
+#include <vector>
 
 #include <audio_utils/sample.h>
 #include <gtest/gtest.h>
@@ -78,3 +80,72 @@ TEST(audio_utils_sample, Convert)
     }
     ASSERT_LT(prev, 2.0f);
 }
+
+TEST(audio_utils_sample, BufferConvert)
+{
+    // the buffer converters must agree with the scalar converters bit for bit
+    std::vector<sample_minifloat_t> samples;
+    for (int i = 0; i <= 0xFFFF; i++) {
+        if (i == 0x8000) continue;  // undefined negative zero
+        samples.push_back((sample_minifloat_t)i);
+    }
+    std::vector<float> floats(samples.size());
+    memcpy_to_float_from_sample(floats.data(), samples.data(), samples.size());
+    for (size_t i = 0; i < samples.size(); i++) {
+        ASSERT_EQ(float_from_sample(samples[i]), floats[i]);
+    }
+
+    std::vector<sample_minifloat_t> back(floats.size());
+    memcpy_to_sample_from_float(back.data(), floats.data(), floats.size());
+    ASSERT_EQ(samples, back);
+
+    // special values take the scalar converter's edge paths
+    const float specials[] = {
+        0.0f, -0.0f, 1.0f, -1.0f, 2.0f, -2.0f, 65536.0f,
+        std::numeric_limits<float>::infinity(),
+        -std::numeric_limits<float>::infinity(),
+        std::numeric_limits<float>::quiet_NaN(),
+        std::numeric_limits<float>::denorm_min(),
+        1e-10f, -1e-10f,
+    };
+    sample_minifloat_t converted[std::size(specials)];
+    memcpy_to_sample_from_float(converted, specials, std::size(specials));
+    for (size_t i = 0; i < std::size(specials); i++) {
+        ASSERT_EQ(sample_from_float(specials[i]), converted[i]) << "special " << i;
+    }
+}
+
+TEST(audio_utils_sample, BufferConvertI16)
+{
+    // int16_t -> minifloat -> int16_t must reproduce the Q0.15 value:
+    // 16-bit magnitudes fit in the 13-bit significand at these exponents
+    std::vector<int16_t> in;
+    for (int i = -32768; i <= 32767; i += 17) {
+        in.push_back((int16_t)i);
+    }
+    in.push_back(-32768);
+    in.push_back(32767);
+    std::vector<sample_minifloat_t> mini(in.size());
+    memcpy_to_sample_from_i16(mini.data(), in.data(), in.size());
+    std::vector<int16_t> out(in.size());
+    memcpy_to_i16_from_sample(out.data(), mini.data(), mini.size());
+    for (size_t i = 0; i < in.size(); i++) {
+        ASSERT_NEAR(in[i], out[i], 4) << "index " << i;  // 12 mantissa bits of 15
+    }
+}
+
+TEST(audio_utils_sample, BufferGain)
+{
+    const sample_minifloat_t samples[] = {
+        sample_from_float(0.5f), sample_from_float(-0.25f), sample_from_float(1.5f),
+    };
+    float gained[std::size(samples)];
+    memcpy_to_float_from_sample_with_gain(gained, samples, std::size(samples), 0.5f);
+    float acc[std::size(samples)] = { 1.0f, 1.0f, 1.0f };
+    accumulate_float_from_sample_with_gain(acc, samples, std::size(samples), 0.5f);
+    for (size_t i = 0; i < std::size(samples); i++) {
+        const float f = float_from_sample(samples[i]);
+        EXPECT_EQ(0.5f * f, gained[i]);
+        EXPECT_EQ(1.0f + 0.5f * f, acc[i]);
+    }
+}
@@ -20,6 +20,7 @@
 #include <audio_utils/SimpleLog.h>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <thread>
 #include <log/log.h>
 
 using namespace android;
@@ -84,3 +85,70 @@ TEST(audio_utils_simplelog, basic) {
   12-31 16:00:02.000 Goodbye
      */
 }
+
+TEST(audio_utils_simplelog, wait_free_basic) {
+    auto slog = std::make_unique<WaitFreeSimpleLog>(
+            80 /* linesPerWriter */, 2 /* maxWriters */);
+    const int64_t oneSecond = 1000000000;
+
+    auto *writer = slog->createWriter();
+    ASSERT_NE(nullptr, writer);
+
+    EXPECT_EQ((size_t)0, countNewLines(slog->dumpToString()));
+
+    const int nine = 9;
+    writer->log(oneSecond /* nowNs */, "Hello %d", nine);
+    writer->log(oneSecond * 2 /* nowNs */, "World");
+    writer->log(-1 /* nowNs */, "%s", "Now");  // -1 uses the current time.
+
+    EXPECT_EQ((size_t)3, countNewLines(slog->dumpToString()));
+
+    // a second writer merges into the same dump, in logging order.
+    auto *writer2 = slog->createWriter();
+    ASSERT_NE(nullptr, writer2);
+    writer2->log(oneSecond * 3 /* nowNs */, "Other");
+    EXPECT_EQ((size_t)4, countNewLines(slog->dumpToString()));
+
+    // writers are preallocated; no more than maxWriters are assigned.
+    EXPECT_EQ(nullptr, slog->createWriter());
+
+    // truncate on lines
+    EXPECT_EQ((size_t)1, countNewLines(slog->dumpToString("" /* prefix */, 1 /* lines */)));
+
+    // truncate on time
+    EXPECT_EQ((size_t)3, countNewLines(
+            slog->dumpToString("" /* prefix */, 0 /* lines */, oneSecond * 2 /* limitNs */)));
+
+    slog->dump(0 /* fd (stdout) */, "  "); // add a prefix
+}
+
+TEST(audio_utils_simplelog, wait_free_concurrent) {
+    auto slog = std::make_unique<WaitFreeSimpleLog>(
+            8 /* linesPerWriter */, 4 /* maxWriters */);
+
+    // logging threads run while dumps are in progress; neither may stall or crash.
+    std::atomic<bool> done{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            auto *writer = slog->createWriter();
+            ASSERT_NE(nullptr, writer);
+            for (int64_t i = 0; i < 10000; ++i) {
+                writer->log(i + 1 /* nowNs */, "writer %d iteration %lld", t, (long long)i);
+            }
+        });
+    }
+    std::thread dumper([&] {
+        while (!done) {
+            (void)slog->dumpToString();
+        }
+    });
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    done = true;
+    dumper.join();
+
+    // 8 lines per writer remain.
+    EXPECT_EQ((size_t)32, countNewLines(slog->dumpToString()));
+}
@@ -19,10 +19,12 @@
 #include <math.h>
 #include <memory>
 #include <string.h>
+#include <vector>
 
 #include <gtest/gtest.h>
 
 #include <audio_utils/spdif/SPDIFEncoder.h>
+#include <audio_utils/spdif/SPDIFEncoderPipeline.h>
 
 using namespace android;
 
@@ -131,6 +133,104 @@ TEST(audio_utils_spdif, ValidEAC3)
     ASSERT_GE(bufferSize, pendingBytes);
 }
 
+// Captures the data bursts sent through writeOutput().
+class MyStagedEncoder : public MySPDIFEncoder {
+public:
+    explicit MyStagedEncoder(audio_format_t format)
+            : MySPDIFEncoder(format)
+    {
+    }
+
+    ssize_t writeOutput( const void* buffer, size_t numBytes ) override {
+        const uint8_t *bytes = (const uint8_t *) buffer;
+        mData.insert(mData.end(), bytes, bytes + numBytes);
+        return numBytes;
+    }
+
+    std::vector<uint8_t> mData;
+};
+
+// Assembles the data bursts in place through reserveOutput()/commitOutput().
+class MyZeroCopyEncoder : public MySPDIFEncoder {
+public:
+    explicit MyZeroCopyEncoder(audio_format_t format)
+            : MySPDIFEncoder(format)
+    {
+    }
+
+    void *reserveOutput( size_t numBytes ) override {
+        mReserved.resize(numBytes);
+        return mReserved.data();
+    }
+
+    ssize_t commitOutput( size_t numBytes ) override {
+        mData.insert(mData.end(), mReserved.begin(), mReserved.begin() + numBytes);
+        mCommitCount++;
+        return numBytes;
+    }
+
+    ssize_t writeOutput( const void* /* buffer */, size_t numBytes ) override {
+        mWriteCount++; // the zero-copy path must not stage through writeOutput()
+        return numBytes;
+    }
+
+    std::vector<uint8_t> mReserved;
+    std::vector<uint8_t> mData;
+    int mCommitCount = 0;
+    int mWriteCount = 0;
+};
+
+TEST(audio_utils_spdif, ZeroCopyAC3)
+{
+    MyStagedEncoder stagedEncoder(AUDIO_FORMAT_AC3);
+    MyZeroCopyEncoder zeroCopyEncoder(AUDIO_FORMAT_AC3);
+
+    // Write the same stream through both paths to force an output data burst.
+    stagedEncoder.write(sVoice1ch48k_AC3, sizeof(sVoice1ch48k_AC3));
+    zeroCopyEncoder.write(sVoice1ch48k_AC3, sizeof(sVoice1ch48k_AC3));
+    for (int i = 0; i < 7; i++) {
+        stagedEncoder.write(sZeros, sizeof(sZeros));
+        zeroCopyEncoder.write(sZeros, sizeof(sZeros));
+    }
+
+    ASSERT_EQ(1, zeroCopyEncoder.mCommitCount);
+    ASSERT_EQ(0, zeroCopyEncoder.mWriteCount);
+
+    // The burst assembled in place must be identical to the staged burst.
+    ASSERT_GT(stagedEncoder.mData.size(), (size_t)0);
+    ASSERT_EQ(stagedEncoder.mData, zeroCopyEncoder.mData);
+}
+
+TEST(audio_utils_spdif, ChunkedWriteAC3)
+{
+    // Build a stream with unsynchronized garbage before the frame.
+    std::vector<uint8_t> stream;
+    for (int i = 0; i < 17; i++) {
+        stream.push_back(0x55); // cannot start an AC3 sync word
+    }
+    stream.insert(stream.end(), sVoice1ch48k_AC3,
+            sVoice1ch48k_AC3 + sizeof(sVoice1ch48k_AC3));
+    for (int i = 0; i < 7 * 32; i++) {
+        stream.push_back(0);
+    }
+
+    // The output bursts must not depend on how the stream is chunked,
+    // including odd-sized writes that split byte pairs.
+    MyStagedEncoder wholeEncoder(AUDIO_FORMAT_AC3);
+    auto result = wholeEncoder.write(stream.data(), stream.size());
+    ASSERT_EQ((ssize_t)stream.size(), result);
+
+    MyStagedEncoder chunkedEncoder(AUDIO_FORMAT_AC3);
+    for (size_t offset = 0; offset < stream.size(); offset += 3) {
+        size_t chunk = std::min((size_t)3, stream.size() - offset);
+        result = chunkedEncoder.write(&stream[offset], chunk);
+        ASSERT_EQ((ssize_t)chunk, result);
+    }
+
+    ASSERT_GT(wholeEncoder.mData.size(), (size_t)0);
+    ASSERT_EQ(wholeEncoder.mData, chunkedEncoder.mData);
+}
+
 TEST(audio_utils_spdif, InvalidLengthEAC3)
 {
     MySPDIFEncoder encoder(AUDIO_FORMAT_E_AC3);
@@ -150,3 +250,98 @@ TEST(audio_utils_spdif, InvalidLengthEAC3)
     ASSERT_GE(bufferSize, pendingBytes);
 
 }
+
+TEST(audio_utils_spdif, RepeatedHeaderAC3)
+{
+    // A stable-bitrate stream repeats the same header on every frame.
+    // The scanner caches the parse, but each frame must still emit
+    // its own complete burst.
+    std::vector<uint8_t> frame(sVoice1ch48k_AC3,
+            sVoice1ch48k_AC3 + sizeof(sVoice1ch48k_AC3));
+    frame.resize(256, 0); // frame size encoded in the header
+
+    MyStagedEncoder encoder(AUDIO_FORMAT_AC3);
+    for (int i = 0; i < 3; i++) {
+        auto result = encoder.write(frame.data(), frame.size());
+        ASSERT_EQ((ssize_t)frame.size(), result);
+    }
+
+    // Bursts two and three were built from cached headers and must be
+    // identical to the first.
+    const size_t kBurstSize = 6144; // see WriteAC3
+    ASSERT_EQ(3 * kBurstSize, encoder.mData.size());
+    ASSERT_EQ(0, memcmp(&encoder.mData[0], &encoder.mData[kBurstSize], kBurstSize));
+    ASSERT_EQ(0, memcmp(&encoder.mData[0], &encoder.mData[2 * kBurstSize], kBurstSize));
+}
+
+TEST(audio_utils_spdif, RepeatedHeaderEAC3)
+{
+    MyStagedEncoder encoder(AUDIO_FORMAT_E_AC3);
+    auto result = encoder.write(sChannel6ch48k_EAC3, sizeof(sChannel6ch48k_EAC3));
+    ASSERT_EQ(sizeof(sChannel6ch48k_EAC3), result);
+
+    // Pad the real header out to a full frame using the parsed size.
+    const size_t frameSize = encoder.getFramer()->getFrameSizeBytes();
+    ASSERT_GT(frameSize, sizeof(sChannel6ch48k_EAC3));
+    std::vector<uint8_t> frame(sChannel6ch48k_EAC3,
+            sChannel6ch48k_EAC3 + sizeof(sChannel6ch48k_EAC3));
+    frame.resize(frameSize, 0);
+    result = encoder.write(frame.data() + sizeof(sChannel6ch48k_EAC3),
+            frameSize - sizeof(sChannel6ch48k_EAC3));
+    ASSERT_EQ((ssize_t)(frameSize - sizeof(sChannel6ch48k_EAC3)), result);
+
+    // Each repeated frame carries six audio blocks, so even when its
+    // header comes from the cache it must advance the substream block
+    // counts and close out the previous burst.
+    for (int i = 0; i < 3; i++) {
+        result = encoder.write(frame.data(), frame.size());
+        ASSERT_EQ((ssize_t)frame.size(), result);
+    }
+    const size_t kBurstSize = encoder.getFramer()->getSampleFramesPerSyncFrame()
+            * kBytesPerOutputFrame;
+    ASSERT_EQ(3 * kBurstSize, encoder.mData.size());
+}
+
+TEST(audio_utils_spdif, PipelinedWriteAC3)
+{
+    // Same stream as ChunkedWriteAC3: garbage, one real frame, fake payload.
+    std::vector<uint8_t> stream;
+    for (int i = 0; i < 17; i++) {
+        stream.push_back(0x55);
+    }
+    stream.insert(stream.end(), sVoice1ch48k_AC3,
+            sVoice1ch48k_AC3 + sizeof(sVoice1ch48k_AC3));
+    for (int i = 0; i < 7 * 32; i++) {
+        stream.push_back(0);
+    }
+
+    MyStagedEncoder inlineEncoder(AUDIO_FORMAT_AC3);
+    auto result = inlineEncoder.write(stream.data(), stream.size());
+    ASSERT_EQ((ssize_t)stream.size(), result);
+
+    // Through the pipeline the scanning runs on its own thread, but the
+    // emitted bursts must be byte-identical to the inline path.
+    MyStagedEncoder pipelinedEncoder(AUDIO_FORMAT_AC3);
+    {
+        SPDIFEncoderPipeline pipeline(pipelinedEncoder,
+                64 /* lookaheadBytes, tiny to exercise writer throttling */);
+        for (size_t offset = 0; offset < stream.size(); offset += 48) {
+            size_t chunk = std::min((size_t)48, stream.size() - offset);
+            result = pipeline.write(&stream[offset], chunk);
+            ASSERT_EQ((ssize_t)chunk, result);
+        }
+        // destructor drains the queue before stopping the thread
+    }
+
+    ASSERT_GT(inlineEncoder.mData.size(), (size_t)0);
+    ASSERT_EQ(inlineEncoder.mData, pipelinedEncoder.mData);
+
+    // flush() waits for the scanner and resets the encoder for a seek
+    MyStagedEncoder seekEncoder(AUDIO_FORMAT_AC3);
+    SPDIFEncoderPipeline pipeline(seekEncoder);
+    pipeline.write(stream.data(), stream.size() / 2);
+    pipeline.flush();
+    pipeline.write(stream.data(), stream.size());
+    pipeline.flush();
+    ASSERT_EQ(inlineEncoder.mData, seekEncoder.mData);
+}
@@ -348,6 +348,111 @@ TEST(StatisticsTest, stat_variable_alpha)
     verify(stat, rstat);
 }
 
+TEST(StatisticsTest, stat_alpha_from_window_length)
+{
+    // degenerate windows give rectangular weighting
+    static_assert(android::audio_utils::alphaFromWindowLength(0) == 0.);
+    static_assert(android::audio_utils::alphaFromWindowLength(1) == 0.);
+    static_assert(android::audio_utils::alphaFromWindowLength(100) == 0.99);
+
+    // the steady-state total weight must converge to the window length
+    constexpr size_t WINDOW = 100;
+    android::audio_utils::Statistics<double> stat(
+            android::audio_utils::alphaFromWindowLength(WINDOW));
+    for (size_t i = 0; i < WINDOW * 20; ++i) {
+        stat.add(1.);
+    }
+    EXPECT_NEAR(WINDOW, stat.getWeight(), WINDOW * 1e-6);
+
+    // and the smoothed mean must track a step about like a WINDOW-sample average:
+    // after WINDOW samples of the new level the remaining error is alpha^WINDOW ~ 1/e.
+    for (size_t i = 0; i < WINDOW; ++i) {
+        stat.add(2.);
+    }
+    EXPECT_NEAR(2. - 1. / M_E, stat.getMean(), 0.01);
+}
+
+TEST(StatisticsTest, stat_startup_window)
+{
+    constexpr size_t WINDOW = 50;
+    constexpr double alpha = android::audio_utils::alphaFromWindowLength(WINDOW);
+    std::vector<double> data(WINDOW * 4);
+    initUniform(data, -1., 1.);
+
+    android::audio_utils::Statistics<double> windowed(alpha);
+    windowed.setStartupWindow(WINDOW);
+    android::audio_utils::Statistics<double> rectangular;  // alpha == 1
+    android::audio_utils::Statistics<double> exponential(alpha);
+
+    // while the startup window fills, the state matches rectangular weighting exactly
+    for (size_t i = 0; i < WINDOW; ++i) {
+        windowed.add(data[i]);
+        rectangular.add(data[i]);
+        exponential.add(data[i]);
+    }
+    EXPECT_EQ(rectangular.getMean(), windowed.getMean());
+    EXPECT_EQ(rectangular.getVariance(), windowed.getVariance());
+    EXPECT_EQ(rectangular.getWeight(), windowed.getWeight());
+    EXPECT_EQ((double)WINDOW, windowed.getEffectiveCount());
+
+    // the pure exponential start carries less effective information
+    EXPECT_LT(exponential.getEffectiveCount(), windowed.getEffectiveCount());
+
+    // afterwards the configured alpha takes over; since the rectangular weight
+    // equals the exponential steady state 1 / (1 - alpha), the total weight is
+    // already at its fixed point and the transition is seamless
+    for (size_t i = WINDOW; i < data.size(); ++i) {
+        windowed.add(data[i]);
+    }
+    EXPECT_NEAR((double)WINDOW, windowed.getWeight(), 1e-6);
+
+    // effective count never exceeds the true sample count, and with
+    // exponential weighting approaches (1 + alpha) / (1 - alpha)
+    EXPECT_LE(windowed.getEffectiveCount(), (double)windowed.getN());
+    android::audio_utils::Statistics<double> longRun(alpha);
+    for (size_t i = 0; i < WINDOW * 100; ++i) {
+        longRun.add(data[i % data.size()]);
+    }
+    EXPECT_NEAR((1. + alpha) / (1. - alpha), longRun.getEffectiveCount(), 0.1);
+}
+
+TEST(StatisticsTest, stat_bulk_add)
+{
+    // deliberately not a multiple of the internal block size.
+    constexpr size_t TEST_SIZE = (1 << 20) + 259;
+    std::vector<float> data(TEST_SIZE);
+
+    initUniform(data, -1.f, 1.f);
+
+    android::audio_utils::Statistics<float> serial;
+    for (const float f : data) {
+        serial.add(f);
+    }
+
+    android::audio_utils::Statistics<float> bulk;
+    bulk.add(data.data(), data.size());
+
+    EXPECT_EQ(serial.getN(), bulk.getN());
+    EXPECT_EQ(serial.getMin(), bulk.getMin());
+    EXPECT_EQ(serial.getMax(), bulk.getMax());
+    EXPECT_EQ(serial.getWeight(), bulk.getWeight());
+    // the block merge reorders the floating point operations, so the
+    // results agree only to rounding, not bit exactly.
+    EXPECT_NEAR(serial.getMean(), bulk.getMean(), 1e-12);
+    EXPECT_NEAR(serial.getVariance(), bulk.getVariance(), 1e-12);
+    EXPECT_NEAR(serial.getStdDev(), bulk.getStdDev(), 1e-12);
+
+    // with alpha != 1 the bulk path must reduce to the serial one exactly.
+    android::audio_utils::Statistics<float> serialAlpha(0.9);
+    android::audio_utils::Statistics<float> bulkAlpha(0.9);
+    for (const float f : data) {
+        serialAlpha.add(f);
+    }
+    bulkAlpha.add(data.data(), data.size());
+    EXPECT_EQ(serialAlpha.getMean(), bulkAlpha.getMean());
+    EXPECT_EQ(serialAlpha.getVariance(), bulkAlpha.getVariance());
+}
+
 TEST(StatisticsTest, stat_vector)
 {
     // for operator overloading...
@@ -569,3 +674,66 @@ TEST(StatisticsTest, simple_stats)
     simple_stats_to_string(&ss, buffer, sizeof(buffer));
     printf("simple_stats: %s", buffer);
 }
+
+TEST(StatisticsTest, quantile_estimator)
+{
+    // Small sample counts stay staged in the buffer and are near exact.
+    android::audio_utils::QuantileEstimator<double> small;
+    for (int i = 1; i <= 9; ++i) {
+        small.add(i);
+    }
+    EXPECT_EQ(9, small.getN());
+    EXPECT_EQ(1., small.getMin());
+    EXPECT_EQ(9., small.getMax());
+    EXPECT_NEAR(5., small.quantile(0.5), 0.5);
+
+    // Large sample counts are sketched; tails must stay accurate.
+    constexpr size_t TEST_SIZE = 1 << 16;
+    std::vector<double> data(TEST_SIZE);
+    initNormal(data, 10. /* mean */, 2. /* stddev */);
+
+    android::audio_utils::QuantileEstimator<double> stat;
+    stat.add(data.data(), data.size());
+    EXPECT_EQ((int64_t)TEST_SIZE, stat.getN());
+
+    std::vector<double> sorted(data);
+    std::sort(sorted.begin(), sorted.end());
+    for (const double q : { 0.5, 0.95, 0.99 }) {
+        const double exact = sorted[(size_t)(q * (TEST_SIZE - 1))];
+        // tolerance in units of the distribution's spread; the far tail
+        // is represented by fewer samples per centroid and is looser.
+        const double tolerance = (q < 0.99 ? 0.1 : 0.25) * 2. /* stddev */;
+        EXPECT_NEAR(exact, stat.quantile(q), tolerance) << "quantile " << q;
+    }
+    EXPECT_EQ(sorted.front(), stat.getMin());
+    EXPECT_EQ(sorted.back(), stat.getMax());
+
+    printf("quantile_estimator: %s\n", stat.toString().c_str());
+}
+
+TEST(StatisticsTest, quantile_estimator_merge)
+{
+    constexpr size_t TEST_SIZE = 1 << 16;
+    std::vector<double> data(TEST_SIZE);
+    initUniform(data, -1., 1.);
+
+    // Sketching the halves separately and merging must agree with
+    // sketching the whole stream.
+    android::audio_utils::QuantileEstimator<double> whole;
+    android::audio_utils::QuantileEstimator<double> front;
+    android::audio_utils::QuantileEstimator<double> back;
+    whole.add(data.data(), data.size());
+    front.add(data.data(), data.size() / 2);
+    back.add(data.data() + data.size() / 2, data.size() - data.size() / 2);
+
+    front.merge(back);
+    EXPECT_EQ(whole.getN(), front.getN());
+    EXPECT_EQ(whole.getMin(), front.getMin());
+    EXPECT_EQ(whole.getMax(), front.getMax());
+    for (const double q : { 0.5, 0.95, 0.99 }) {
+        EXPECT_NEAR(whole.quantile(q), front.quantile(q), 0.05) << "quantile " << q;
+    }
+
+    front.reset();
+    EXPECT_EQ(0, front.getN());
+}
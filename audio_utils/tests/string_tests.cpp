@@ -84,3 +84,103 @@ TEST(audio_utils_string, check_zero_fill) {
     // check we didn't overwrite
     EXPECT_EQ(sizeof(dst) + DST_START, dst_mirror[sizeof(dst)]);
 }
+
+TEST(audio_utils_string, dump_writer) {
+    using android::audio_utils::dump_writer;
+
+    char buffer[32];
+    dump_writer writer(buffer, sizeof(buffer));
+    EXPECT_EQ(0u, writer.size());
+    EXPECT_STREQ("", writer.c_str());
+
+    writer.append("abc").appendf(" %d %s", 42, "def");
+    EXPECT_STREQ("abc 42 def", writer.c_str());
+    EXPECT_EQ(strlen("abc 42 def"), writer.size());
+    EXPECT_FALSE(writer.truncated());
+
+    // overflow truncates, stays null terminated, and is reported
+    writer.appendf("%s", "0123456789012345678901234567890123456789");
+    EXPECT_TRUE(writer.truncated());
+    EXPECT_EQ(sizeof(buffer) - 1, writer.size());
+    EXPECT_EQ('\0', buffer[sizeof(buffer) - 1]);
+
+    // appends after overflow do not write past the end
+    writer.append("xyz");
+    EXPECT_EQ(sizeof(buffer) - 1, writer.size());
+}
+
+TEST(audio_utils_string, dump_buffer) {
+    // fits in stack storage
+    android::audio_utils::dump_buffer<64> small;
+    small.appendf("%s=%d", "key", 7);
+    EXPECT_STREQ("key=7", small.c_str());
+    EXPECT_FALSE(small.truncated());
+
+    // larger than the stack capacity: one up-front heap block, no truncation
+    constexpr size_t kBig = 1 << 16;
+    android::audio_utils::dump_buffer<64> big(kBig);
+    for (size_t i = 0; i < kBig / 8 - 1; ++i) {  // leave room for the terminator
+        big.appendf("%07zu\n", i);
+    }
+    EXPECT_EQ(kBig - 8, big.size());  // 8 bytes per line
+    EXPECT_FALSE(big.truncated());
+}
+
+TEST(audio_utils_string, itoa) {
+    using android::audio_utils::itoa;
+    using android::audio_utils::utoa;
+
+    // the formatters agree with printf over interesting boundaries.
+    const int64_t values[] = {
+        0, 1, -1, 9, 10, -10, 99, 100, 12345, -987654321,
+        INT32_MAX, INT32_MIN, INT64_MAX, INT64_MIN,
+    };
+    char digits[android::audio_utils::kMaxItoaLength];
+    char expected[32];
+    for (const int64_t value : values) {
+        const size_t length = itoa(value, digits);
+        snprintf(expected, sizeof(expected), "%lld", (long long)value);
+        EXPECT_STREQ(expected, digits);
+        EXPECT_EQ(strlen(expected), length);
+    }
+    EXPECT_EQ(20u, utoa(UINT64_MAX, digits));
+    EXPECT_STREQ("18446744073709551615", digits);
+}
+
+TEST(audio_utils_string, dtoa_fixed) {
+    using android::audio_utils::dtoa_fixed;
+
+    char digits[android::audio_utils::kMaxDtoaFixedLength];
+    char expected[48];
+    const double values[] = {
+        0., 1., -1., 0.04, -0.04, 3.14159, -273.16, 1234.5678, 99.95, -99.99,
+    };
+    for (const double value : values) {
+        for (unsigned decimals = 0; decimals <= 6; ++decimals) {
+            const size_t length = dtoa_fixed(value, decimals, digits);
+            snprintf(expected, sizeof(expected), "%.*f", decimals, value);
+            EXPECT_STREQ(expected, digits) << value << " decimals " << decimals;
+            EXPECT_EQ(strlen(expected), length);
+        }
+    }
+    // non finite values take the printf fallback.
+    dtoa_fixed(-INFINITY, 1, digits);
+    EXPECT_STREQ("-inf", digits);
+    dtoa_fixed(NAN, 1, digits);
+    EXPECT_STREQ("nan", digits);
+    // huge values also fall back rather than overflow the integer scaling.
+    const size_t length = dtoa_fixed(1e30, 0, digits);
+    EXPECT_EQ('1', digits[0]);
+    EXPECT_LE(length, sizeof(digits) - 1);
+}
+
+TEST(audio_utils_string, dump_writer_numeric) {
+    using android::audio_utils::dump_writer;
+
+    char buffer[64];
+    dump_writer writer(buffer, sizeof(buffer));
+    writer.append_int(-42).append(" ").append_uint(7).append(" ");
+    writer.append_fixed(-6.24, 1, 6);  // as appendf("%6.1f"), space padded
+    EXPECT_STREQ("-42 7   -6.2", writer.c_str());
+    EXPECT_FALSE(writer.truncated());
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sched.h>
+#include <unistd.h>
+
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <audio_utils/threads.h>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+static pid_t gettid_compat() {
+    return (pid_t)syscall(SYS_gettid);
+}
+#else
+static pid_t gettid_compat() {
+    return getpid();
+}
+#endif
+
+TEST(audio_utils_threads, prefault_stack) {
+    audio_utils_prefault_stack(0);
+    audio_utils_prefault_stack(1);
+    audio_utils_prefault_stack(64 * 1024);
+}
+
+TEST(audio_utils_threads, rt_priority_self) {
+    const int priority = audio_utils_thread_rt_priority(gettid_compat());
+    // the test runner is not realtime
+    EXPECT_EQ(0, priority);
+    // exact errno for a bad tid differs between bionic and glibc
+    EXPECT_GT(0, audio_utils_thread_rt_priority(-1));
+}
+
+TEST(audio_utils_threads, set_realtime_self) {
+    int status = 0;
+    int priority = -1;
+    std::thread worker([&] {
+        // above the ceiling: must be clamped, not refused
+        status = audio_utils_set_realtime_self(99, 0);
+        if (status == 0) {
+            priority = audio_utils_thread_rt_priority(gettid_compat());
+        }
+    });
+    worker.join();
+    if (status == -EPERM) {
+        GTEST_SKIP() << "no privilege for SCHED_FIFO";
+    }
+    ASSERT_EQ(0, status);
+    EXPECT_EQ(AUDIO_UTILS_RT_PRIORITY_CEILING, priority);
+}
+
+TEST(audio_utils_threads, set_realtime_self_affinity) {
+    int status = 0;
+    bool pinned = false;
+    std::thread worker([&] {
+        status = audio_utils_set_realtime_self(1, 1 /* CPU 0 */);
+        if (status == 0) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            if (sched_getaffinity(0, sizeof(cpus), &cpus) == 0) {
+                pinned = CPU_COUNT(&cpus) == 1 && CPU_ISSET(0, &cpus);
+            }
+        }
+    });
+    worker.join();
+    if (status == -EPERM) {
+        GTEST_SKIP() << "no privilege for SCHED_FIFO";
+    }
+    ASSERT_EQ(0, status);
+    EXPECT_TRUE(pinned);
+}
+
+TEST(audio_utils_threads, check_fifo_thread_priorities) {
+    const pid_t self = gettid_compat();
+    // both timeshared is compatible
+    EXPECT_EQ(0, audio_utils_check_fifo_thread_priorities(self, self));
+    EXPECT_GT(0, audio_utils_check_fifo_thread_priorities(self, -1));
+
+    // a realtime writer against the timeshared main thread must be flagged
+    int status = 0;
+    int check = 0;
+    std::thread worker([&] {
+        status = audio_utils_set_realtime_self(2, 0);
+        if (status == 0) {
+            check = audio_utils_check_fifo_thread_priorities(gettid_compat(), self);
+        }
+    });
+    worker.join();
+    if (status == -EPERM) {
+        GTEST_SKIP() << "no privilege for SCHED_FIFO";
+    }
+    ASSERT_EQ(0, status);
+    EXPECT_EQ(-EPERM, check);
+}
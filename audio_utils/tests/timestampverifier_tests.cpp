@@ -100,6 +100,58 @@ TEST(TimestampVerifier, sanity)
     EXPECT_NEAR(1., r2, std::numeric_limits<double>::epsilon());
 }
 
+TEST(TimestampVerifier, window_and_anomalies)
+{
+    android::TimestampVerifier<int64_t, int64_t> tv;
+
+    // Add timestamps advancing at normal rate past one full jitter window.
+    constexpr int64_t kTimestamps = tv.kJitterWindowSize + 2;
+    int64_t f = 0;
+    int64_t t = 0;
+    for (int64_t i = 0; i < kTimestamps; ++i) {
+        tv.add(f, t, 48000);
+        f += 48000;
+        t += (int64_t)1e9;
+    }
+
+    // the completed window is reported, with the current window in progress.
+    EXPECT_EQ(tv.kJitterWindowSize, tv.getJitterMsWindow().getN());
+    EXPECT_EQ(0., tv.getJitterMsWindow().getMean());
+
+    // no anomalies yet.
+    EXPECT_EQ((size_t)0, tv.getAnomalyCount());
+
+    tv.discontinuity(tv.DISCONTINUITY_MODE_ZERO);
+    // consecutive discontinuities are treated as one, for the anomaly ring as well.
+    tv.discontinuity(tv.DISCONTINUITY_MODE_ZERO);
+    ASSERT_EQ((size_t)1, tv.getAnomalyCount());
+
+    // the anomaly records the context at the discontinuity.
+    const auto anomaly = tv.getAnomaly(0);
+    EXPECT_EQ(kTimestamps, anomaly.mTimestampCount);
+    EXPECT_EQ(48000 * (kTimestamps - 1), anomaly.mLastTimestamp.mFrames);
+    EXPECT_EQ((int64_t)1e9 * (kTimestamps - 1), anomaly.mLastTimestamp.mTimeNs);
+    EXPECT_EQ((uint32_t)48000, anomaly.mSampleRate);
+    EXPECT_EQ(tv.DISCONTINUITY_MODE_ZERO, anomaly.mMode);
+
+    // restart the sequence (frame position resets to zero after a ZERO discontinuity).
+    f = 0;
+    tv.add(f, t, 48000);
+    f += 48000;
+    t += (int64_t)1e9;
+
+    // the ring is bounded: only the most recent kAnomalyRingSize are retained.
+    for (size_t i = 0; i < tv.kAnomalyRingSize + 4; ++i) {
+        tv.discontinuity(tv.DISCONTINUITY_MODE_CONTINUOUS);
+        tv.add(f, t, 48000);  // anchor, so the next discontinuity counts anew.
+        f += 48000;
+        t += (int64_t)1e9;
+    }
+    EXPECT_EQ(tv.kAnomalyRingSize, tv.getAnomalyCount());
+    // index 0 is the most recent.
+    EXPECT_GT(tv.getAnomaly(0).mTimestampCount, tv.getAnomaly(1).mTimestampCount);
+}
+
 TEST(TimestampVerifier, discontinuity_zero)
 {
     android::TimestampVerifier<int64_t, int64_t> tv;
@@ -136,3 +188,31 @@ TEST(TimestampVerifier, discontinuity_zero)
     EXPECT_NE(96000*1.1, tv.getLastCorrectedTimestamp().mFrames);
     EXPECT_EQ(5100000000*0.9, tv.getLastCorrectedTimestamp().mTimeNs);
 }
+
+TEST(TimestampVerifier, batch_add)
+{
+    // the batch overload must match per-timestamp adds exactly.
+    constexpr size_t N = 64;
+    int64_t frames[N];
+    int64_t timeNs[N];
+    for (size_t i = 0; i < N; ++i) {
+        frames[i] = 960 * i;
+        // 20 ms cadence with an alternating +-0.5 ms jitter pattern.
+        timeNs[i] = 20'000'000LL * i + ((i & 1) ? 500'000 : -500'000);
+    }
+
+    android::TimestampVerifier<int64_t, int64_t> scalar, batch;
+    for (size_t i = 0; i < N; ++i) {
+        scalar.add(frames[i], timeNs[i], 48000);
+    }
+    batch.add(frames, timeNs, N, 48000);
+
+    EXPECT_EQ(scalar.getN(), batch.getN());
+    EXPECT_EQ(scalar.getJitterMs().getN(), batch.getJitterMs().getN());
+    EXPECT_EQ(scalar.getJitterMs().getMean(), batch.getJitterMs().getMean());
+    EXPECT_EQ(scalar.getLastTimestamp().mFrames, batch.getLastTimestamp().mFrames);
+    EXPECT_EQ(scalar.getLastTimestamp().mTimeNs, batch.getLastTimestamp().mTimeNs);
+
+    // ~1 ms peak jitter between adjacent timestamps.
+    EXPECT_NEAR(1., batch.getJitterMs().getMax(), 0.05);
+}
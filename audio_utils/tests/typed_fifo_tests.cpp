@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "audio_utils_typed_fifo_tests"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <audio_utils/TypedFifo.h>
+#include <gtest/gtest.h>
+
+using android::audio_utils::TypedFifo;
+
+// a move-only payload that counts live instances, to catch leaks and double-destroys
+static std::atomic<int> sLive{0};
+
+struct Tracked {
+    explicit Tracked(int value = 0) : mValue(value) { sLive++; }
+    Tracked(Tracked&& other) noexcept : mValue(other.mValue) {
+        other.mValue = -1;
+        sLive++;
+    }
+    Tracked& operator=(Tracked&& other) noexcept {
+        mValue = other.mValue;
+        other.mValue = -1;
+        return *this;
+    }
+    Tracked(const Tracked&) = delete;
+    Tracked& operator=(const Tracked&) = delete;
+    ~Tracked() { sLive--; }
+    int mValue;
+};
+
+TEST(audio_utils_typed_fifo, capacity_rounds_up)
+{
+    TypedFifo<int> fifo(1);
+    EXPECT_EQ(2u, fifo.capacity());
+    TypedFifo<int> fifo3(3);
+    EXPECT_EQ(4u, fifo3.capacity());
+    TypedFifo<int> fifo64(64);
+    EXPECT_EQ(64u, fifo64.capacity());
+}
+
+TEST(audio_utils_typed_fifo, push_pop_wraparound)
+{
+    TypedFifo<int> fifo(4);
+    int next = 0, expect = 0;
+    // cycle several times around the ring with a partial fill
+    for (int iter = 0; iter < 100; iter++) {
+        for (int i = 0; i < 3; i++) {
+            ASSERT_TRUE(fifo.push(next++));
+        }
+        int out;
+        for (int i = 0; i < 3; i++) {
+            ASSERT_TRUE(fifo.pop(out));
+            EXPECT_EQ(expect++, out);
+        }
+        ASSERT_FALSE(fifo.pop(out));
+    }
+}
+
+TEST(audio_utils_typed_fifo, full_rejects)
+{
+    TypedFifo<int> fifo(4);
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(fifo.push(i));
+    }
+    EXPECT_FALSE(fifo.push(4));
+    EXPECT_EQ(4u, fifo.size());
+    int out;
+    ASSERT_TRUE(fifo.pop(out));
+    EXPECT_EQ(0, out);
+    EXPECT_TRUE(fifo.push(4));
+    EXPECT_FALSE(fifo.push(5));
+}
+
+TEST(audio_utils_typed_fifo, move_only_and_emplace)
+{
+    sLive = 0;
+    {
+        TypedFifo<Tracked> fifo(8);
+        for (int i = 0; i < 5; i++) {
+            ASSERT_TRUE(fifo.emplace(i));
+        }
+        Tracked out;
+        for (int i = 0; i < 3; i++) {
+            ASSERT_TRUE(fifo.pop(out));
+            EXPECT_EQ(i, out.mValue);
+        }
+        // two elements deliberately left queued for the destructor to clean up
+        EXPECT_EQ(2u, fifo.size());
+    }
+    EXPECT_EQ(0, sLive);
+
+    // unique_ptr payload exercises genuine move-only transfer of ownership
+    TypedFifo<std::unique_ptr<int>> ptrs(4);
+    ASSERT_TRUE(ptrs.push(std::make_unique<int>(42)));
+    std::unique_ptr<int> p;
+    ASSERT_TRUE(ptrs.pop(p));
+    ASSERT_NE(nullptr, p);
+    EXPECT_EQ(42, *p);
+}
+
+TEST(audio_utils_typed_fifo, batch_pop_bounded)
+{
+    TypedFifo<int> fifo(16);
+    for (int i = 0; i < 10; i++) {
+        ASSERT_TRUE(fifo.push(i));
+    }
+    int out[16];
+    // bounded below the available count
+    EXPECT_EQ(4u, fifo.pop(out, 4));
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(i, out[i]);
+    }
+    // bounded by the available count
+    EXPECT_EQ(6u, fifo.pop(out, 16));
+    for (int i = 0; i < 6; i++) {
+        EXPECT_EQ(4 + i, out[i]);
+    }
+    EXPECT_EQ(0u, fifo.pop(out, 16));
+}
+
+TEST(audio_utils_typed_fifo, spsc_threaded)
+{
+    sLive = 0;
+    constexpr int kCount = 200000;
+    {
+        TypedFifo<Tracked> fifo(64);
+        std::thread producer([&] {
+            for (int i = 0; i < kCount; ) {
+                if (fifo.emplace(i)) {
+                    i++;
+                } else {
+                    std::this_thread::yield();  // full; don't starve the consumer
+                }
+            }
+        });
+        int expect = 0;
+        Tracked out[32];
+        while (expect < kCount) {
+            const size_t n = fifo.pop(out, 32);
+            if (n == 0) {
+                std::this_thread::yield();  // empty; let the producer run
+                continue;
+            }
+            for (size_t i = 0; i < n; i++) {
+                ASSERT_EQ(expect++, out[i].mValue);
+            }
+        }
+        producer.join();
+        EXPECT_EQ(0u, fifo.size());
+    }
+    // 32 stack-resident out[] elements remain live until scope exit above;
+    // everything that passed through the ring must be destroyed
+    EXPECT_EQ(0, sLive);
+}
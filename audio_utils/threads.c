@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "audio_utils_threads"
+
+// for cpu_set_t and sched_setaffinity() with glibc on host builds
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <alloca.h>
+#include <errno.h>
+#include <sched.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <log/log.h>
+
+#include <audio_utils/threads.h>
+
+#define PREFAULT_STACK_MAX (256 * 1024)
+#define PREFAULT_STACK_DEFAULT (32 * 1024)
+
+__attribute__((noinline))
+void audio_utils_prefault_stack(size_t bytes)
+{
+    if (bytes == 0) {
+        return;
+    }
+    if (bytes > PREFAULT_STACK_MAX) {
+        bytes = PREFAULT_STACK_MAX;
+    }
+    const long page = sysconf(_SC_PAGESIZE);
+    // one write per page is enough to make it resident; volatile keeps the
+    // otherwise dead stores from being optimized out along with the frame
+    volatile char *frame = (volatile char *)alloca(bytes);
+    for (size_t i = 0; i < bytes; i += (size_t)page) {
+        frame[i] = 0;
+    }
+    frame[bytes - 1] = 0;
+}
+
+int audio_utils_set_realtime_self(int priority, uint64_t cpu_mask)
+{
+    if (priority < 1) {
+        priority = 1;
+    } else if (priority > AUDIO_UTILS_RT_PRIORITY_CEILING) {
+        priority = AUDIO_UTILS_RT_PRIORITY_CEILING;
+    }
+
+    if (cpu_mask != 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (int cpu = 0; cpu < 64; ++cpu) {
+            if (cpu_mask & (UINT64_C(1) << cpu)) {
+                CPU_SET(cpu, &cpus);
+            }
+        }
+        if (sched_setaffinity(0 /* self */, sizeof(cpus), &cpus) != 0) {
+            ALOGE("%s: sched_setaffinity(%#llx) failed: %s",
+                    __func__, (unsigned long long)cpu_mask, strerror(errno));
+            return -errno;
+        }
+    }
+
+    const struct sched_param param = { .sched_priority = priority };
+    if (sched_setscheduler(0 /* self */, SCHED_FIFO, &param) != 0) {
+        ALOGE("%s: sched_setscheduler(SCHED_FIFO, %d) failed: %s",
+                __func__, priority, strerror(errno));
+        return -errno;
+    }
+
+    audio_utils_prefault_stack(PREFAULT_STACK_DEFAULT);
+    return 0;
+}
+
+int audio_utils_thread_rt_priority(pid_t tid)
+{
+    const int policy = sched_getscheduler(tid);
+    if (policy < 0) {
+        return -errno;
+    }
+    if (policy != SCHED_FIFO && policy != SCHED_RR) {
+        return 0;
+    }
+    struct sched_param param;
+    if (sched_getparam(tid, &param) != 0) {
+        return -errno;
+    }
+    return param.sched_priority;
+}
+
+int audio_utils_check_fifo_thread_priorities(pid_t writer_tid, pid_t reader_tid)
+{
+    const int writer = audio_utils_thread_rt_priority(writer_tid);
+    if (writer < 0) {
+        return writer;
+    }
+    const int reader = audio_utils_thread_rt_priority(reader_tid);
+    if (reader < 0) {
+        return reader;
+    }
+    if ((writer > 0) != (reader > 0)) {
+        ALOGW("%s: writer tid %d rt priority %d vs reader tid %d rt priority %d",
+                __func__, writer_tid, writer, reader_tid, reader);
+        return -EPERM;
+    }
+    return 0;
+}
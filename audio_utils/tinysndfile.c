@@ -20,19 +20,102 @@
 #ifdef HAVE_STDERR
 #include <stdio.h>
 #endif
-#include <string.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
 
 #define WAVE_FORMAT_PCM         1
 #define WAVE_FORMAT_IEEE_FLOAT  3
 #define WAVE_FORMAT_EXTENSIBLE  0xFFFE
 
+// staging ring for SFM_WRITE_ASYNC, must be a power of two
+#define ASYNC_RING_SIZE         (256 * 1024)
+
+// staging ring for registered container decoders, must be a power of two
+#define DECODE_RING_SIZE        (32 * 1024)
+
+// O_DIRECT file offset and length alignment for SFM_WRITE_DIRECT; a block
+// size no current kernel or storage exceeds
+#define DIRECT_ALIGN            4096
+// staging buffer for SFM_WRITE_DIRECT, must be a multiple of DIRECT_ALIGN
+#define DIRECT_STAGE_SIZE       (256 * 1024)
+
+// RIFF and data chunk sizes in a streaming header: unknown, read to EOF
+#define STREAM_SIZE_SENTINEL    0xFFFFFFFFu
+
+#define MAX_DECODERS            4
+
+static const SF_DECODER *registered_decoders[MAX_DECODERS];
+static size_t registered_decoder_count;
+
+/*
+ * SFM_READ state for a registered container decoder: decoded PCM is staged
+ * in a ring so the decoder can produce its natural chunk size while
+ * sf_readf_*() consumes arbitrary request sizes with bounded memory.
+ */
+struct decode_state {
+    const SF_DECODER *decoder;
+    void *state;            // decoder private state from open()
+    uint8_t *ring;
+    size_t rear;            // monotonic count of bytes produced by the decoder
+    size_t front;           // monotonic count of bytes consumed by the reader
+    bool eos;               // decoder reached end of stream or failed
+};
+
+/*
+ * SFM_WRITE_ASYNC state: a single-producer single-consumer byte ring.
+ * The writer thread (producer) only loads front and stores rear, the flush
+ * thread (consumer) only loads rear and stores front, so the producer never
+ * blocks; the mutex and condition are used solely to let the flush thread
+ * sleep, and the producer only ever trylocks to signal it (a missed signal
+ * is recovered by the flush thread's timed wait).
+ */
+struct async_state {
+    uint8_t *ring;
+    _Atomic size_t rear;    // monotonic count of bytes staged by the producer
+    _Atomic size_t front;   // monotonic count of bytes written to the stream
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool shutdown;          // guarded by mutex
+    bool error;             // sticky, set by the flush thread on write failure
+    size_t rejected;        // frames returned as short writes because the ring was full
+};
+
+/*
+ * SFM_WRITE_DIRECT state: converted data is staged in a DIRECT_ALIGN aligned
+ * buffer and written to the file in whole buffers with write(2), so every
+ * O_DIRECT transfer has an aligned offset, address and length.  The header
+ * is padded to DIRECT_ALIGN with a JUNK chunk to keep the offsets aligned.
+ */
+struct direct_state {
+    uint8_t *buffer;        // posix_memalign(DIRECT_ALIGN, DIRECT_STAGE_SIZE)
+    size_t used;            // bytes staged and not yet written
+    bool active;            // O_DIRECT is set on the descriptor
+};
+
 struct SNDFILE_ {
     int mode;
     uint8_t *temp;  // realloc buffer used for shrinking 16 bits to 8 bits and byte-swapping
     FILE *stream;
     size_t bytesPerFrame;
     size_t remaining;   // frames unread for SFM_READ, frames written for SFM_WRITE
+    struct async_state *async;  // NULL unless opened with SFM_WRITE_ASYNC
+    struct direct_state *direct;    // NULL unless opened with SFM_WRITE_DIRECT
+    long dataSizeTell;  // offset of the data chunk size field, patched at close
+    bool streamHeader;  // header has streaming sentinel sizes, never patched
+    struct decode_state *decode;    // NULL unless a registered decoder opened the file
+    const uint8_t *mmapBase;    // mapped file for SFM_READ_MMAP, otherwise NULL
+    size_t mmapSize;            // length of the mapping
+    const uint8_t *mmapData;    // start of the data chunk within the mapping
     SF_INFO info;
 };
 
@@ -62,7 +145,375 @@ static void my_swab(short *ptr, size_t numToSwap)
     }
 }
 
-static SNDFILE *sf_open_read(const char *path, SF_INFO *info)
+static void *async_flush_thread(void *arg)
+{
+    SNDFILE *handle = (SNDFILE *) arg;
+    struct async_state *async = handle->async;
+    for (;;) {
+        size_t front = atomic_load_explicit(&async->front, memory_order_relaxed);
+        size_t rear = atomic_load_explicit(&async->rear, memory_order_acquire);
+        if (front == rear) {
+            pthread_mutex_lock(&async->mutex);
+            if (async->shutdown &&
+                    front == atomic_load_explicit(&async->rear, memory_order_acquire)) {
+                pthread_mutex_unlock(&async->mutex);
+                break;
+            }
+            // the timed wait also recovers signals lost to a failed trylock
+            struct timespec ts;
+            clock_gettime(CLOCK_REALTIME, &ts);
+            ts.tv_nsec += 10000000;  // 10 ms
+            if (ts.tv_nsec >= 1000000000) {
+                ts.tv_nsec -= 1000000000;
+                ts.tv_sec++;
+            }
+            (void) pthread_cond_timedwait(&async->cond, &async->mutex, &ts);
+            pthread_mutex_unlock(&async->mutex);
+            continue;
+        }
+        // write the contiguous part up to the end of the ring
+        const size_t offset = front & (ASYNC_RING_SIZE - 1);
+        size_t chunk = rear - front;
+        if (chunk > ASYNC_RING_SIZE - offset) {
+            chunk = ASYNC_RING_SIZE - offset;
+        }
+        const size_t written = fwrite(async->ring + offset, sizeof(char), chunk,
+                handle->stream);
+        handle->remaining += written / handle->bytesPerFrame;
+        atomic_store_explicit(&async->front, front + written, memory_order_release);
+        if (written < chunk) {
+#ifdef HAVE_STDERR
+            fprintf(stderr, "async flush fwrite wrote %zu of %zu\n", written, chunk);
+#endif
+            async->error = true;
+            break;
+        }
+    }
+    return NULL;
+}
+
+// stages bytes for the flush thread; returns the bytes accepted, which is
+// less than requested (by whole frames) when the ring is full
+static size_t async_write(SNDFILE *handle, const void *data, size_t bytes)
+{
+    struct async_state *async = handle->async;
+    const size_t rear = atomic_load_explicit(&async->rear, memory_order_relaxed);
+    const size_t front = atomic_load_explicit(&async->front, memory_order_acquire);
+    const size_t space = ASYNC_RING_SIZE - (rear - front);
+    if (bytes > space) {
+        const size_t accepted = space - space % handle->bytesPerFrame;
+        async->rejected += (bytes - accepted) / handle->bytesPerFrame;
+        bytes = accepted;
+    }
+    const size_t offset = rear & (ASYNC_RING_SIZE - 1);
+    size_t first = bytes;
+    if (first > ASYNC_RING_SIZE - offset) {
+        first = ASYNC_RING_SIZE - offset;
+    }
+    memcpy(async->ring + offset, data, first);
+    memcpy(async->ring, (const uint8_t *) data + first, bytes - first);
+    atomic_store_explicit(&async->rear, rear + bytes, memory_order_release);
+    if (pthread_mutex_trylock(&async->mutex) == 0) {
+        pthread_cond_signal(&async->cond);
+        pthread_mutex_unlock(&async->mutex);
+    }
+    return bytes;
+}
+
+// drops O_DIRECT from the descriptor, e.g. before an unaligned tail write
+static void direct_disable(SNDFILE *handle)
+{
+#ifdef O_DIRECT
+    if (handle->direct->active) {
+        const int fd = fileno(handle->stream);
+        const int flags = fcntl(fd, F_GETFL);
+        if (flags >= 0) {
+            (void) fcntl(fd, F_SETFL, flags & ~O_DIRECT);
+        }
+        handle->direct->active = false;
+    }
+#else
+    handle->direct->active = false;
+#endif
+}
+
+// writes the staged bytes to the file; on an alignment rejection or other
+// write failure falls back to buffered writes for the rest of the file
+static void direct_flush(SNDFILE *handle)
+{
+    struct direct_state *direct = handle->direct;
+    const int fd = fileno(handle->stream);
+    size_t done = 0;
+    while (done < direct->used) {
+        const ssize_t written = write(fd, direct->buffer + done, direct->used - done);
+        if (written <= 0) {
+            if (direct->active) {
+                direct_disable(handle);
+                continue;
+            }
+#ifdef HAVE_STDERR
+            fprintf(stderr, "direct flush write failed errno %d\n", errno);
+#endif
+            break;
+        }
+        done += written;
+    }
+    if (done < direct->used) {
+        memmove(direct->buffer, direct->buffer + done, direct->used - done);
+    }
+    direct->used -= done;
+}
+
+// stages bytes in the aligned buffer, writing whole buffers as they fill
+static size_t direct_write(SNDFILE *handle, const void *data, size_t bytes)
+{
+    struct direct_state *direct = handle->direct;
+    const uint8_t *src = (const uint8_t *) data;
+    size_t total = 0;
+    while (total < bytes) {
+        size_t chunk = DIRECT_STAGE_SIZE - direct->used;
+        if (chunk > bytes - total) {
+            chunk = bytes - total;
+        }
+        memcpy(direct->buffer + direct->used, src + total, chunk);
+        direct->used += chunk;
+        total += chunk;
+        if (direct->used == DIRECT_STAGE_SIZE) {
+            direct_flush(handle);
+            if (direct->used != 0) {
+                break;  // storage failure; accept no more than was staged
+            }
+        }
+    }
+    return total;
+}
+
+static struct direct_state *direct_open(SNDFILE *handle)
+{
+    struct direct_state *direct = (struct direct_state *) calloc(1, sizeof(*direct));
+    if (direct == NULL) {
+        return NULL;
+    }
+    if (posix_memalign((void **) &direct->buffer, DIRECT_ALIGN, DIRECT_STAGE_SIZE) != 0) {
+        free(direct);
+        return NULL;
+    }
+    // the header was written buffered; put it on disk before raw writes begin
+    (void) fflush(handle->stream);
+    handle->direct = direct;
+#ifdef O_DIRECT
+    const int fd = fileno(handle->stream);
+    const int flags = fcntl(fd, F_GETFL);
+    if (flags >= 0 && fcntl(fd, F_SETFL, flags | O_DIRECT) == 0) {
+        direct->active = true;
+    }
+    // if the filesystem refuses O_DIRECT the staging still batches the writes
+#endif
+    return direct;
+}
+
+// writes the unaligned tail buffered and releases the direct state
+static void direct_close(SNDFILE *handle)
+{
+    direct_disable(handle);
+    direct_flush(handle);
+    free(handle->direct->buffer);
+    free(handle->direct);
+    handle->direct = NULL;
+}
+
+// routes converted data to the stream or, for SFM_WRITE_ASYNC, the ring,
+// or, for SFM_WRITE_DIRECT, the aligned staging buffer
+static size_t write_bytes(SNDFILE *handle, const void *data, size_t bytes)
+{
+    if (handle->async != NULL) {
+        return async_write(handle, data, bytes);
+    }
+    if (handle->direct != NULL) {
+        return direct_write(handle, data, bytes);
+    }
+    return fwrite(data, sizeof(char), bytes, handle->stream);
+}
+
+static struct async_state *async_open(SNDFILE *handle)
+{
+    struct async_state *async = (struct async_state *) calloc(1, sizeof(*async));
+    if (async == NULL) {
+        return NULL;
+    }
+    async->ring = (uint8_t *) malloc(ASYNC_RING_SIZE);
+    if (async->ring == NULL) {
+        free(async);
+        return NULL;
+    }
+    pthread_mutex_init(&async->mutex, NULL);
+    pthread_cond_init(&async->cond, NULL);
+    handle->async = async;
+    if (pthread_create(&async->thread, NULL, async_flush_thread, handle) != 0) {
+        handle->async = NULL;
+        free(async->ring);
+        free(async);
+        return NULL;
+    }
+    return async;
+}
+
+// drains the ring, stops the flush thread and releases the async state
+static void async_close(SNDFILE *handle)
+{
+    struct async_state *async = handle->async;
+    pthread_mutex_lock(&async->mutex);
+    async->shutdown = true;
+    pthread_cond_signal(&async->cond);
+    pthread_mutex_unlock(&async->mutex);
+    (void) pthread_join(async->thread, NULL);
+#ifdef HAVE_STDERR
+    if (async->rejected > 0) {
+        fprintf(stderr, "async writer returned %zu frames as short writes (ring full)\n",
+                async->rejected);
+    }
+#endif
+    pthread_cond_destroy(&async->cond);
+    pthread_mutex_destroy(&async->mutex);
+    free(async->ring);
+    free(async);
+    handle->async = NULL;
+}
+
+int sf_register_decoder(const SF_DECODER *decoder)
+{
+    if (decoder == NULL || decoder->probe == NULL || decoder->open == NULL ||
+            decoder->decode == NULL || decoder->close == NULL) {
+        return -EINVAL;
+    }
+    if (registered_decoder_count >= MAX_DECODERS) {
+        return -ENOSPC;
+    }
+    registered_decoders[registered_decoder_count++] = decoder;
+    return 0;
+}
+
+static size_t bytes_per_sample(unsigned format)
+{
+    switch (format) {
+    case SF_FORMAT_PCM_U8:
+        return 1;
+    case SF_FORMAT_PCM_16:
+        return 2;
+    case SF_FORMAT_PCM_24:
+        return 3;
+    case SF_FORMAT_PCM_32:
+    case SF_FORMAT_FLOAT:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+// offers a file that did not parse as WAV to the registered decoders;
+// on success the handle is set up to read through the decode ring
+static bool decode_open(SNDFILE *handle, const unsigned char *header, size_t length)
+{
+    const SF_DECODER *decoder = NULL;
+    for (size_t i = 0; i < registered_decoder_count; i++) {
+        if (registered_decoders[i]->probe(header, length)) {
+            decoder = registered_decoders[i];
+            break;
+        }
+    }
+    if (decoder == NULL) {
+        return false;
+    }
+    rewind(handle->stream);
+    SF_INFO info;
+    memset(&info, 0, sizeof(info));
+    void *state = decoder->open(handle->stream, &info);
+    if (state == NULL) {
+#ifdef HAVE_STDERR
+        fprintf(stderr, "decoder %s probed but failed to open\n", decoder->name);
+#endif
+        return false;
+    }
+    size_t sampleSize = bytes_per_sample(info.format & SF_FORMAT_SUBMASK);
+    if (sampleSize == 0 || info.channels < 1 || info.channels > FCC_LIMIT ||
+            info.samplerate <= 0 || info.frames < 0) {
+#ifdef HAVE_STDERR
+        fprintf(stderr, "decoder %s reported invalid info\n", decoder->name);
+#endif
+        decoder->close(state);
+        return false;
+    }
+    struct decode_state *ds = (struct decode_state *) calloc(1, sizeof(*ds));
+    if (ds == NULL) {
+        decoder->close(state);
+        return false;
+    }
+    ds->ring = (uint8_t *) malloc(DECODE_RING_SIZE);
+    if (ds->ring == NULL) {
+        free(ds);
+        decoder->close(state);
+        return false;
+    }
+    ds->decoder = decoder;
+    ds->state = state;
+    handle->decode = ds;
+    handle->info = info;
+    handle->bytesPerFrame = sampleSize * info.channels;
+    handle->remaining = info.frames;
+    return true;
+}
+
+// copies up to bytes of decoded PCM into buffer, refilling the ring from
+// the decoder as needed; returns the bytes copied, 0 at end of stream
+static size_t decode_read(SNDFILE *handle, void *buffer, size_t bytes)
+{
+    struct decode_state *ds = handle->decode;
+    size_t copied = 0;
+    while (copied < bytes) {
+        size_t avail = ds->rear - ds->front;
+        if (avail == 0) {
+            if (ds->eos) {
+                break;
+            }
+            // refill the contiguous part up to the end of the ring
+            const size_t offset = ds->rear & (DECODE_RING_SIZE - 1);
+            const int produced = ds->decoder->decode(ds->state,
+                    ds->ring + offset, DECODE_RING_SIZE - offset);
+            if (produced <= 0) {
+#ifdef HAVE_STDERR
+                if (produced < 0) {
+                    fprintf(stderr, "decoder %s failed %d\n", ds->decoder->name, produced);
+                }
+#endif
+                ds->eos = true;
+                continue;
+            }
+            ds->rear += produced;
+            avail = ds->rear - ds->front;
+        }
+        const size_t offset = ds->front & (DECODE_RING_SIZE - 1);
+        size_t chunk = bytes - copied;
+        if (chunk > avail) {
+            chunk = avail;
+        }
+        if (chunk > DECODE_RING_SIZE - offset) {
+            chunk = DECODE_RING_SIZE - offset;
+        }
+        memcpy((uint8_t *) buffer + copied, ds->ring + offset, chunk);
+        ds->front += chunk;
+        copied += chunk;
+    }
+    return copied;
+}
+
+// routes raw frame reads to the stream or, for decoded containers, the ring
+static size_t read_bytes(SNDFILE *handle, void *buffer, size_t bytes)
+{
+    return handle->decode == NULL ? fread(buffer, sizeof(char), bytes, handle->stream)
+            : decode_read(handle, buffer, bytes);
+}
+
+static SNDFILE *sf_open_read(const char *path, SF_INFO *info, bool map)
 {
     FILE *stream = fopen(path, "rb");
     if (stream == NULL) {
@@ -76,26 +527,36 @@ static SNDFILE *sf_open_read(const char *path, SF_INFO *info)
     handle->mode = SFM_READ;
     handle->temp = NULL;
     handle->stream = stream;
+    handle->async = NULL;
+    handle->direct = NULL;
+    handle->dataSizeTell = 0L;
+    handle->streamHeader = false;
+    handle->decode = NULL;
+    handle->mmapBase = NULL;
+    handle->mmapSize = 0;
+    handle->mmapData = NULL;
     handle->info.format = SF_FORMAT_WAV;
 
     // don't attempt to parse all valid forms, just the most common ones
     unsigned char wav[12];
     size_t actual;
     actual = fread(wav, sizeof(char), sizeof(wav), stream);
-    if (actual < 12) {
-#ifdef HAVE_STDERR
-        fprintf(stderr, "actual %zu < 44\n", actual);
-#endif
-        goto close;
-    }
-    if (memcmp(wav, "RIFF", 4)) {
+    if (actual < 12 || memcmp(wav, "RIFF", 4)) {
+        // not WAV; offer the leading bytes to the registered container decoders
+        if (decode_open(handle, wav, actual)) {
+            *info = handle->info;
+            return handle;
+        }
 #ifdef HAVE_STDERR
-        fprintf(stderr, "wav != RIFF\n");
+        fprintf(stderr, "no RIFF header in first %zu bytes\n", actual);
 #endif
         goto close;
     }
     unsigned riffSize = little4u(&wav[4]);
-    if (riffSize < 4) {
+    // a streaming header (SFM_WRITE_STREAM, or another writer that could not
+    // seek back) carries sentinel sizes; the data extends to the end of file
+    const bool streaming = riffSize == STREAM_SIZE_SENTINEL;
+    if (!streaming && riffSize < 4) {
 #ifdef HAVE_STDERR
         fprintf(stderr, "riffSize %u < 4\n", riffSize);
 #endif
@@ -107,7 +568,7 @@ static SNDFILE *sf_open_read(const char *path, SF_INFO *info)
 #endif
         goto close;
     }
-    size_t remaining = riffSize - 4;
+    size_t remaining = streaming ? SIZE_MAX : riffSize - 4;
     int hadFmt = 0;
     int hadData = 0;
     long dataTell = 0L;
@@ -115,6 +576,10 @@ static SNDFILE *sf_open_read(const char *path, SF_INFO *info)
         unsigned char chunk[8];
         actual = fread(chunk, sizeof(char), sizeof(chunk), stream);
         if (actual != sizeof(chunk)) {
+            if (streaming && hadData) {
+                remaining = 0;  // a streaming file simply ends
+                break;
+            }
 #ifdef HAVE_STDERR
             fprintf(stderr, "actual %zu != %zu\n", actual, sizeof(chunk));
 #endif
@@ -240,6 +705,18 @@ static SNDFILE *sf_open_read(const char *path, SF_INFO *info)
 #endif
                 goto close;
             }
+            if (streaming && chunkSize == STREAM_SIZE_SENTINEL) {
+                // size the unsized data chunk from the file; nothing follows it
+                dataTell = ftell(stream);
+                struct stat st;
+                chunkSize = fstat(fileno(stream), &st) == 0 && st.st_size > dataTell
+                        ? (unsigned) (st.st_size - dataTell) : 0;
+                handle->remaining = chunkSize / handle->bytesPerFrame;
+                handle->info.frames = handle->remaining;
+                hadData = 1;
+                remaining = 0;
+                break;
+            }
             handle->remaining = chunkSize / handle->bytesPerFrame;
             handle->info.frames = handle->remaining;
             dataTell = ftell(stream);
@@ -277,6 +754,33 @@ static SNDFILE *sf_open_read(const char *path, SF_INFO *info)
         goto close;
     }
     (void) fseek(stream, dataTell, SEEK_SET);
+    if (map) {
+        // map the whole file read-only; sf_readf_*() then converts straight
+        // from the mapping and pages are faulted in only as they are read.
+        // On any failure fall back to the plain stream reads.
+        struct stat st;
+        if (fstat(fileno(stream), &st) == 0 && st.st_size >= dataTell) {
+            void *base = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED,
+                    fileno(stream), 0);
+            if (base != MAP_FAILED) {
+                handle->mmapBase = (const uint8_t *) base;
+                handle->mmapSize = (size_t) st.st_size;
+                handle->mmapData = handle->mmapBase + dataTell;
+                // a truncated file maps short; don't read past the end
+                size_t availableFrames =
+                        ((size_t) st.st_size - dataTell) / handle->bytesPerFrame;
+                if (availableFrames < handle->remaining) {
+                    handle->remaining = availableFrames;
+                    handle->info.frames = availableFrames;
+                }
+            }
+#ifdef HAVE_STDERR
+            else {
+                fprintf(stderr, "mmap %s failed errno %d\n", path, errno);
+            }
+#endif
+        }
+    }
     *info = handle->info;
     return handle;
 
@@ -294,7 +798,7 @@ static void write4u(unsigned char *ptr, unsigned u)
     ptr[3] = u >> 24;
 }
 
-static SNDFILE *sf_open_write(const char *path, SF_INFO *info)
+static SNDFILE *sf_open_write(const char *path, SF_INFO *info, int mode)
 {
     int sub = info->format & SF_FORMAT_SUBMASK;
     if (!(
@@ -306,7 +810,8 @@ static SNDFILE *sf_open_write(const char *path, SF_INFO *info)
           )) {
         return NULL;
     }
-    FILE *stream = fopen(path, "w+b");
+    // a streaming header is never patched, so the output may be a pipe
+    FILE *stream = fopen(path, mode == SFM_WRITE_STREAM ? "wb" : "w+b");
     if (stream == NULL) {
 #ifdef HAVE_STDERR
         fprintf(stderr, "fopen %s failed errno %d\n", path, errno);
@@ -362,15 +867,66 @@ static SNDFILE *sf_open_write(const char *path, SF_INFO *info)
         extra = 14;
     } else
         memcpy(&wav[36], "data", 4);
-    // dataSize is initially zero
-    (void) fwrite(wav, 44 + extra, 1, stream);
+    if (mode == SFM_WRITE_STREAM) {
+        // streaming sentinels: size unknown, data extends to end of stream
+        write4u(&wav[4], STREAM_SIZE_SENTINEL);         // riffSize
+        write4u(&wav[40 + extra], STREAM_SIZE_SENTINEL); // dataSize
+    }
+    // dataSize is initially zero except for a streaming header
+    long dataSizeTell = (long) (40 + extra);
+    if (mode == SFM_WRITE_DIRECT) {
+        // pad the header with a JUNK chunk so the data payload begins on a
+        // DIRECT_ALIGN boundary, as O_DIRECT requires aligned file offsets
+        const size_t lead = 36 + extra;     // header up to the data declaration
+        const unsigned junkSize = DIRECT_ALIGN - (unsigned) (lead + 8 + 8);
+        unsigned char junk[8];
+        memcpy(junk, "JUNK", 4);
+        write4u(&junk[4], junkSize);
+        unsigned char zeros[64];
+        memset(zeros, 0, sizeof(zeros));
+        (void) fwrite(wav, lead, 1, stream);
+        (void) fwrite(junk, sizeof(junk), 1, stream);
+        for (unsigned pad = junkSize; pad > 0; ) {
+            const size_t chunk = pad > sizeof(zeros) ? sizeof(zeros) : pad;
+            (void) fwrite(zeros, chunk, 1, stream);
+            pad -= chunk;
+        }
+        (void) fwrite(&wav[lead], 8, 1, stream);    // the data declaration
+        dataSizeTell = (long) (lead + 8 + junkSize + 4);
+    } else {
+        (void) fwrite(wav, 44 + extra, 1, stream);
+    }
     SNDFILE *handle = (SNDFILE *) malloc(sizeof(SNDFILE));
     handle->mode = SFM_WRITE;
     handle->temp = NULL;
     handle->stream = stream;
     handle->bytesPerFrame = blockAlignment;
     handle->remaining = 0;
+    handle->async = NULL;
+    handle->direct = NULL;
+    handle->dataSizeTell = dataSizeTell;
+    handle->streamHeader = mode == SFM_WRITE_STREAM;
+    handle->decode = NULL;
+    handle->mmapBase = NULL;
+    handle->mmapSize = 0;
+    handle->mmapData = NULL;
     handle->info = *info;
+    if (mode == SFM_WRITE_ASYNC && async_open(handle) == NULL) {
+#ifdef HAVE_STDERR
+        fprintf(stderr, "cannot start async flush thread for %s\n", path);
+#endif
+        fclose(stream);
+        free(handle);
+        return NULL;
+    }
+    if (mode == SFM_WRITE_DIRECT && direct_open(handle) == NULL) {
+#ifdef HAVE_STDERR
+        fprintf(stderr, "cannot allocate direct staging buffer for %s\n", path);
+#endif
+        fclose(stream);
+        free(handle);
+        return NULL;
+    }
     return handle;
 }
 
@@ -384,9 +940,14 @@ SNDFILE *sf_open(const char *path, int mode, SF_INFO *info)
     }
     switch (mode) {
     case SFM_READ:
-        return sf_open_read(path, info);
+        return sf_open_read(path, info, false /* map */);
+    case SFM_READ_MMAP:
+        return sf_open_read(path, info, true /* map */);
     case SFM_WRITE:
-        return sf_open_write(path, info);
+    case SFM_WRITE_ASYNC:
+    case SFM_WRITE_STREAM:
+    case SFM_WRITE_DIRECT:
+        return sf_open_write(path, info, mode);
     default:
 #ifdef HAVE_STDERR
         fprintf(stderr, "mode=%d\n", mode);
@@ -400,17 +961,35 @@ void sf_close(SNDFILE *handle)
     if (handle == NULL)
         return;
     free(handle->temp);
+    if (handle->async != NULL) {
+        // flush the staged data so the header below sees the final frame count
+        async_close(handle);
+    }
+    if (handle->decode != NULL) {
+        handle->decode->decoder->close(handle->decode->state);
+        free(handle->decode->ring);
+        free(handle->decode);
+    }
     if (handle->mode == SFM_WRITE) {
-        (void) fflush(handle->stream);
-        rewind(handle->stream);
-        unsigned char wav[58];
-        size_t extra = (handle->info.format & SF_FORMAT_SUBMASK) == SF_FORMAT_FLOAT ? 14 : 0;
-        (void) fread(wav, 44 + extra, 1, handle->stream);
-        unsigned dataSize = handle->remaining * handle->bytesPerFrame;
-        write4u(&wav[4], dataSize + 36 + extra);    // riffSize
-        write4u(&wav[40 + extra], dataSize);        // dataSize
-        rewind(handle->stream);
-        (void) fwrite(wav, 44 + extra, 1, handle->stream);
+        if (handle->direct != NULL) {
+            // write the unaligned tail buffered before patching the header
+            direct_close(handle);
+        }
+        if (!handle->streamHeader) {
+            (void) fflush(handle->stream);
+            unsigned char size4[4];
+            const unsigned dataSize = handle->remaining * handle->bytesPerFrame;
+            // riffSize spans from after its own field to the end of the data
+            write4u(size4, (unsigned) (handle->dataSizeTell + 4 - 8) + dataSize);
+            (void) fseek(handle->stream, 4, SEEK_SET);
+            (void) fwrite(size4, sizeof(size4), 1, handle->stream);
+            write4u(size4, dataSize);
+            (void) fseek(handle->stream, handle->dataSizeTell, SEEK_SET);
+            (void) fwrite(size4, sizeof(size4), 1, handle->stream);
+        }
+    }
+    if (handle->mmapBase != NULL) {
+        (void) munmap((void *) handle->mmapBase, handle->mmapSize);
     }
     (void) fclose(handle->stream);
     free(handle);
@@ -429,39 +1008,49 @@ sf_count_t sf_readf_short(SNDFILE *handle, short *ptr, sf_count_t desiredFrames)
     size_t desiredBytes = desiredFrames * handle->bytesPerFrame;
     size_t actualBytes;
     void *temp = NULL;
+    const void *src;
     unsigned format = handle->info.format & SF_FORMAT_SUBMASK;
-    if (format == SF_FORMAT_PCM_32 || format == SF_FORMAT_FLOAT || format == SF_FORMAT_PCM_24) {
+    if (handle->mmapBase != NULL) {
+        // convert straight from the mapped data chunk
+        src = handle->mmapData +
+                (size_t) (handle->info.frames - handle->remaining) * handle->bytesPerFrame;
+        actualBytes = desiredBytes;
+    } else if (format == SF_FORMAT_PCM_32 || format == SF_FORMAT_FLOAT ||
+            format == SF_FORMAT_PCM_24) {
         temp = malloc(desiredBytes);
-        actualBytes = fread(temp, sizeof(char), desiredBytes, handle->stream);
+        actualBytes = read_bytes(handle, temp, desiredBytes);
+        src = temp;
     } else {
-        actualBytes = fread(ptr, sizeof(char), desiredBytes, handle->stream);
+        actualBytes = read_bytes(handle, ptr, desiredBytes);
+        src = ptr;
     }
     size_t actualFrames = actualBytes / handle->bytesPerFrame;
     handle->remaining -= actualFrames;
     switch (format) {
     case SF_FORMAT_PCM_U8:
-        memcpy_to_i16_from_u8(ptr, (unsigned char *) ptr, actualFrames * handle->info.channels);
+        memcpy_to_i16_from_u8(ptr, (const unsigned char *) src,
+                actualFrames * handle->info.channels);
         break;
     case SF_FORMAT_PCM_16:
+        if (src != ptr)
+            memcpy(ptr, src, actualFrames * handle->bytesPerFrame);
         if (!isLittleEndian())
             my_swab(ptr, actualFrames * handle->info.channels);
         break;
     case SF_FORMAT_PCM_32:
-        memcpy_to_i16_from_i32(ptr, (const int *) temp, actualFrames * handle->info.channels);
-        free(temp);
+        memcpy_to_i16_from_i32(ptr, (const int *) src, actualFrames * handle->info.channels);
         break;
     case SF_FORMAT_FLOAT:
-        memcpy_to_i16_from_float(ptr, (const float *) temp, actualFrames * handle->info.channels);
-        free(temp);
+        memcpy_to_i16_from_float(ptr, (const float *) src, actualFrames * handle->info.channels);
         break;
     case SF_FORMAT_PCM_24:
-        memcpy_to_i16_from_p24(ptr, (const uint8_t *) temp, actualFrames * handle->info.channels);
-        free(temp);
+        memcpy_to_i16_from_p24(ptr, (const uint8_t *) src, actualFrames * handle->info.channels);
         break;
     default:
         memset(ptr, 0, actualFrames * handle->info.channels * sizeof(short));
         break;
     }
+    free(temp);
     return actualFrames;
 }
 
@@ -478,38 +1067,47 @@ sf_count_t sf_readf_float(SNDFILE *handle, float *ptr, sf_count_t desiredFrames)
     size_t desiredBytes = desiredFrames * handle->bytesPerFrame;
     size_t actualBytes;
     void *temp = NULL;
+    const void *src;
     unsigned format = handle->info.format & SF_FORMAT_SUBMASK;
-    if (format == SF_FORMAT_PCM_16 || format == SF_FORMAT_PCM_U8 || format == SF_FORMAT_PCM_24) {
+    if (handle->mmapBase != NULL) {
+        // convert straight from the mapped data chunk
+        src = handle->mmapData +
+                (size_t) (handle->info.frames - handle->remaining) * handle->bytesPerFrame;
+        actualBytes = desiredBytes;
+    } else if (format == SF_FORMAT_PCM_16 || format == SF_FORMAT_PCM_U8 ||
+            format == SF_FORMAT_PCM_24) {
         temp = malloc(desiredBytes);
-        actualBytes = fread(temp, sizeof(char), desiredBytes, handle->stream);
+        actualBytes = read_bytes(handle, temp, desiredBytes);
+        src = temp;
     } else {
-        actualBytes = fread(ptr, sizeof(char), desiredBytes, handle->stream);
+        actualBytes = read_bytes(handle, ptr, desiredBytes);
+        src = ptr;
     }
     size_t actualFrames = actualBytes / handle->bytesPerFrame;
     handle->remaining -= actualFrames;
     switch (format) {
     case SF_FORMAT_PCM_U8:
-        memcpy_to_float_from_u8(ptr, (const unsigned char *) temp,
+        memcpy_to_float_from_u8(ptr, (const unsigned char *) src,
                 actualFrames * handle->info.channels);
-        free(temp);
         break;
     case SF_FORMAT_PCM_16:
-        memcpy_to_float_from_i16(ptr, (const short *) temp, actualFrames * handle->info.channels);
-        free(temp);
+        memcpy_to_float_from_i16(ptr, (const short *) src, actualFrames * handle->info.channels);
         break;
     case SF_FORMAT_PCM_32:
-        memcpy_to_float_from_i32(ptr, (const int *) ptr, actualFrames * handle->info.channels);
+        memcpy_to_float_from_i32(ptr, (const int *) src, actualFrames * handle->info.channels);
         break;
     case SF_FORMAT_FLOAT:
+        if (src != ptr)
+            memcpy(ptr, src, actualFrames * handle->bytesPerFrame);
         break;
     case SF_FORMAT_PCM_24:
-        memcpy_to_float_from_p24(ptr, (const uint8_t *) temp, actualFrames * handle->info.channels);
-        free(temp);
+        memcpy_to_float_from_p24(ptr, (const uint8_t *) src, actualFrames * handle->info.channels);
         break;
     default:
         memset(ptr, 0, actualFrames * handle->info.channels * sizeof(float));
         break;
     }
+    free(temp);
     return actualFrames;
 }
 
@@ -525,39 +1123,48 @@ sf_count_t sf_readf_int(SNDFILE *handle, int *ptr, sf_count_t desiredFrames)
     // does not check for numeric overflow
     size_t desiredBytes = desiredFrames * handle->bytesPerFrame;
     void *temp = NULL;
+    const void *src;
     unsigned format = handle->info.format & SF_FORMAT_SUBMASK;
     size_t actualBytes;
-    if (format == SF_FORMAT_PCM_16 || format == SF_FORMAT_PCM_U8 || format == SF_FORMAT_PCM_24) {
+    if (handle->mmapBase != NULL) {
+        // convert straight from the mapped data chunk
+        src = handle->mmapData +
+                (size_t) (handle->info.frames - handle->remaining) * handle->bytesPerFrame;
+        actualBytes = desiredBytes;
+    } else if (format == SF_FORMAT_PCM_16 || format == SF_FORMAT_PCM_U8 ||
+            format == SF_FORMAT_PCM_24) {
         temp = malloc(desiredBytes);
-        actualBytes = fread(temp, sizeof(char), desiredBytes, handle->stream);
+        actualBytes = read_bytes(handle, temp, desiredBytes);
+        src = temp;
     } else {
-        actualBytes = fread(ptr, sizeof(char), desiredBytes, handle->stream);
+        actualBytes = read_bytes(handle, ptr, desiredBytes);
+        src = ptr;
     }
     size_t actualFrames = actualBytes / handle->bytesPerFrame;
     handle->remaining -= actualFrames;
     switch (format) {
     case SF_FORMAT_PCM_U8:
-        memcpy_to_i32_from_u8(ptr, (const unsigned char *) temp,
+        memcpy_to_i32_from_u8(ptr, (const unsigned char *) src,
                 actualFrames * handle->info.channels);
-        free(temp);
         break;
     case SF_FORMAT_PCM_16:
-        memcpy_to_i32_from_i16(ptr, (const short *) temp, actualFrames * handle->info.channels);
-        free(temp);
+        memcpy_to_i32_from_i16(ptr, (const short *) src, actualFrames * handle->info.channels);
         break;
     case SF_FORMAT_PCM_32:
+        if (src != ptr)
+            memcpy(ptr, src, actualFrames * handle->bytesPerFrame);
         break;
     case SF_FORMAT_FLOAT:
-        memcpy_to_i32_from_float(ptr, (const float *) ptr, actualFrames * handle->info.channels);
+        memcpy_to_i32_from_float(ptr, (const float *) src, actualFrames * handle->info.channels);
         break;
     case SF_FORMAT_PCM_24:
-        memcpy_to_i32_from_p24(ptr, (const uint8_t *) temp, actualFrames * handle->info.channels);
-        free(temp);
+        memcpy_to_i32_from_p24(ptr, (const uint8_t *) src, actualFrames * handle->info.channels);
         break;
     default:
         memset(ptr, 0, actualFrames * handle->info.channels * sizeof(int));
         break;
     }
+    free(temp);
     return actualFrames;
 }
 
@@ -571,30 +1178,32 @@ sf_count_t sf_writef_short(SNDFILE *handle, const short *ptr, sf_count_t desired
     case SF_FORMAT_PCM_U8:
         handle->temp = realloc(handle->temp, desiredBytes);
         memcpy_to_u8_from_i16(handle->temp, ptr, desiredBytes);
-        actualBytes = fwrite(handle->temp, sizeof(char), desiredBytes, handle->stream);
+        actualBytes = write_bytes(handle, handle->temp, desiredBytes);
         break;
     case SF_FORMAT_PCM_16:
         // does not check for numeric overflow
         if (isLittleEndian()) {
-            actualBytes = fwrite(ptr, sizeof(char), desiredBytes, handle->stream);
+            actualBytes = write_bytes(handle, ptr, desiredBytes);
         } else {
             handle->temp = realloc(handle->temp, desiredBytes);
             memcpy(handle->temp, ptr, desiredBytes);
             my_swab((short *) handle->temp, desiredFrames * handle->info.channels);
-            actualBytes = fwrite(handle->temp, sizeof(char), desiredBytes, handle->stream);
+            actualBytes = write_bytes(handle, handle->temp, desiredBytes);
         }
         break;
     case SF_FORMAT_FLOAT:
         handle->temp = realloc(handle->temp, desiredBytes);
         memcpy_to_float_from_i16((float *) handle->temp, ptr,
                 desiredFrames * handle->info.channels);
-        actualBytes = fwrite(handle->temp, sizeof(char), desiredBytes, handle->stream);
+        actualBytes = write_bytes(handle, handle->temp, desiredBytes);
         break;
     default:
         break;
     }
     size_t actualFrames = actualBytes / handle->bytesPerFrame;
-    handle->remaining += actualFrames;
+    if (handle->async == NULL) {
+        handle->remaining += actualFrames;
+    }
     return actualFrames;
 }
 
@@ -606,20 +1215,22 @@ sf_count_t sf_writef_float(SNDFILE *handle, const float *ptr, sf_count_t desired
     size_t actualBytes = 0;
     switch (handle->info.format & SF_FORMAT_SUBMASK) {
     case SF_FORMAT_FLOAT:
-        actualBytes = fwrite(ptr, sizeof(char), desiredBytes, handle->stream);
+        actualBytes = write_bytes(handle, ptr, desiredBytes);
         break;
     case SF_FORMAT_PCM_16:
         handle->temp = realloc(handle->temp, desiredBytes);
         memcpy_to_i16_from_float((short *) handle->temp, ptr,
                 desiredFrames * handle->info.channels);
-        actualBytes = fwrite(handle->temp, sizeof(char), desiredBytes, handle->stream);
+        actualBytes = write_bytes(handle, handle->temp, desiredBytes);
         break;
     case SF_FORMAT_PCM_U8:  // transcoding from float to byte not yet implemented
     default:
         break;
     }
     size_t actualFrames = actualBytes / handle->bytesPerFrame;
-    handle->remaining += actualFrames;
+    if (handle->async == NULL) {
+        handle->remaining += actualFrames;
+    }
     return actualFrames;
 }
 
@@ -631,12 +1242,14 @@ sf_count_t sf_writef_int(SNDFILE *handle, const int *ptr, sf_count_t desiredFram
     size_t actualBytes = 0;
     switch (handle->info.format & SF_FORMAT_SUBMASK) {
     case SF_FORMAT_PCM_32:
-        actualBytes = fwrite(ptr, sizeof(char), desiredBytes, handle->stream);
+        actualBytes = write_bytes(handle, ptr, desiredBytes);
         break;
     default:    // transcoding from other formats not yet implemented
         break;
     }
     size_t actualFrames = actualBytes / handle->bytesPerFrame;
-    handle->remaining += actualFrames;
+    if (handle->async == NULL) {
+        handle->remaining += actualFrames;
+    }
     return actualFrames;
 }
@@ -61,6 +61,10 @@ enum {
     TYPE_DOUBLE = 4,
     // A 64-bit fraction (camera_metadata_rational_t)
     TYPE_RATIONAL = 5,
+    // A reference to an externally-owned buffer
+    // (camera_metadata_external_blob_t); the payload does not live in the
+    // packet's data section
+    TYPE_EXTERNAL = 6,
     // Number of type fields
     NUM_TYPES
 };
@@ -70,6 +74,23 @@ typedef struct camera_metadata_rational {
     int32_t denominator;
 } camera_metadata_rational_t;
 
+/**
+ * A reference to a bulk payload (depth map, RAW statistics, ...) that is
+ * owned by the sender and not copied into the metadata packet. The packet
+ * stores only this fixed-size descriptor; the payload is the size bytes at
+ * offset in the memory behind fd. The file descriptor is process-local and
+ * must be re-attached by whatever transport carries the packet across a
+ * process boundary. Read descriptors back with
+ * get_camera_metadata_external_blob(), which validates them at access time;
+ * the byte pattern in the buffer is never trusted directly.
+ */
+typedef struct camera_metadata_external_blob {
+    int32_t  fd;
+    int32_t  reserved;     // must be 0
+    uint64_t offset;       // byte offset of the payload behind fd
+    uint64_t size;         // payload size in bytes, non-zero
+} camera_metadata_external_blob_t;
+
 /**
  * A reference to a metadata entry in a buffer.
  *
@@ -89,6 +110,7 @@ typedef struct camera_metadata_entry {
         int64_t *i64;
         double  *d;
         camera_metadata_rational_t *r;
+        camera_metadata_external_blob_t *eb;
     } data;
 } camera_metadata_entry_t;
 
@@ -108,6 +130,7 @@ typedef struct camera_metadata_ro_entry {
         const int64_t *i64;
         const double  *d;
         const camera_metadata_rational_t *r;
+        const camera_metadata_external_blob_t *eb;
     } data;
 } camera_metadata_ro_entry_t;
 
@@ -149,6 +172,47 @@ extern const char* camera_metadata_type_names[NUM_TYPES];
 struct camera_metadata;
 typedef struct camera_metadata camera_metadata_t;
 
+/**
+ * Binary layout constants of a metadata packet
+ * =============================================================================
+ *
+ * The flattened packet layout is a fixed cross-process ABI (shared over
+ * binder and with HALs), so the sizes, alignments and field offsets below
+ * are constants of the format, not properties of a particular build.  They
+ * are exported so optimized readers (typed accessors, vectorized
+ * validation) can static_assert compatibility at compile time instead of
+ * re-checking the layout at runtime in hot read paths; camera_metadata.c
+ * statically asserts that the implementation structures match these values.
+ */
+
+/** Alignment of the packet header (struct camera_metadata). */
+#define CAMERA_METADATA_ALIGNMENT           ((size_t) 4)
+
+/** Size, and therefore stride, of one flattened entry in the entry array. */
+#define CAMERA_METADATA_ENTRY_SIZE          ((size_t) 16)
+
+/** Alignment of the flattened entry array. */
+#define CAMERA_METADATA_ENTRY_ALIGNMENT     ((size_t) 4)
+
+/**
+ * Field offsets within one flattened entry.  The four-byte union at
+ * CAMERA_METADATA_ENTRY_DATA_OFFSET holds either an offset into the data
+ * section, or up to four bytes of value stored inline.
+ */
+#define CAMERA_METADATA_ENTRY_TAG_OFFSET    ((size_t) 0)
+#define CAMERA_METADATA_ENTRY_COUNT_OFFSET  ((size_t) 4)
+#define CAMERA_METADATA_ENTRY_DATA_OFFSET   ((size_t) 8)
+#define CAMERA_METADATA_ENTRY_TYPE_OFFSET   ((size_t) 12)
+
+/** Size and alignment of one datum (the widest value type) in the data
+    section. Out-of-line entry data starts on a datum boundary. */
+#define CAMERA_METADATA_DATA_SIZE           ((size_t) 8)
+#define CAMERA_METADATA_DATA_ALIGNMENT      ((size_t) 8)
+
+/** Required alignment of a whole packet: the maximum of the header, entry
+    and data alignments.  get_camera_metadata_alignment() returns this. */
+#define CAMERA_METADATA_PACKET_ALIGNMENT    CAMERA_METADATA_DATA_ALIGNMENT
+
 /**
  * Functions for manipulating camera metadata
  * =============================================================================
@@ -202,9 +266,32 @@ camera_metadata_t *place_camera_metadata(void *dst, size_t dst_size,
         size_t entry_capacity,
         size_t data_capacity);
 
+/**
+ * Grow the capacity of a metadata buffer previously returned by
+ * allocate_camera_metadata(), clone_camera_metadata(), or
+ * allocate_copy_camera_metadata_checked(), preserving all existing entries.
+ * Must not be used on a buffer from place_camera_metadata(), since the
+ * underlying memory is not owned by the allocator.
+ *
+ * Growth is done with realloc(); when the allocation can be extended in place
+ * only the used data bytes are moved, avoiding the allocate-and-copy of the
+ * whole packet that a fresh allocation plus append would cost.  Capacities
+ * smaller than the current ones are treated as the current ones.
+ *
+ * Returns the (possibly moved) buffer on success; the old pointer must no
+ * longer be used.  Returns NULL on allocation failure, in which case the
+ * original buffer is still valid and unchanged.
+ */
+ANDROID_API
+camera_metadata_t *grow_camera_metadata(camera_metadata_t *metadata,
+        size_t entry_capacity,
+        size_t data_capacity);
+
 /**
  * Free a camera_metadata structure. Should only be used with structures
- * allocated with allocate_camera_metadata().
+ * allocated with allocate_camera_metadata(). If the structure is shared
+ * through acquire_camera_metadata(), this releases one reference; the memory
+ * is freed when the last reference is released.
  */
 ANDROID_API
 void free_camera_metadata(camera_metadata_t *metadata);
@@ -306,6 +393,44 @@ ANDROID_API
 int validate_camera_metadata_structure(const camera_metadata_t *metadata,
                                        const size_t *expected_size);
 
+/**
+ * Seal a metadata packet for cheap re-validation on receive. The packet is
+ * fully validated as by validate_camera_metadata_structure(), and on success a
+ * stamp over the structural header fields is stored in the packet. A receiver
+ * that trusts the sender (same-device transport between cooperating
+ * processes) can then verify the packet with
+ * validate_sealed_camera_metadata() in O(1) instead of re-walking every
+ * entry.
+ *
+ * Any structural modification of the packet (adding, updating, deleting or
+ * sorting entries, appending, growing) clears the seal; re-seal after the
+ * packet reaches its final state. copy_camera_metadata() does not propagate
+ * the seal since it compacts the layout.
+ *
+ * Returns 0 on success, or the validate_camera_metadata_structure() error
+ * if the packet does not validate (in which case it is left unsealed).
+ */
+ANDROID_API
+int seal_camera_metadata(camera_metadata_t *metadata);
+
+/**
+ * Validate a metadata packet received from a trusted source. For a sealed,
+ * well-aligned packet this is O(1): the size bounds and the seal stamp are
+ * checked instead of walking every entry. An unsealed or unaligned packet
+ * falls back to the full validate_camera_metadata_structure() walk, so this
+ * can be called unconditionally on the receive path.
+ *
+ * The seal only vouches that the sender ran the full structural validation;
+ * it is an integrity stamp, not an authentication mechanism. Data from
+ * untrusted sources must be checked with
+ * validate_camera_metadata_structure() regardless of any seal it carries.
+ *
+ * Returns the same values as validate_camera_metadata_structure().
+ */
+ANDROID_API
+int validate_sealed_camera_metadata(const camera_metadata_t *metadata,
+                                    const size_t *expected_size);
+
 /**
  * Append camera metadata in src to an existing metadata structure in dst.  This
  * does not resize the destination structure, so if it is too small, a non-zero
@@ -324,6 +449,184 @@ int append_camera_metadata(camera_metadata_t *dst, const camera_metadata_t *src)
 ANDROID_API
 camera_metadata_t *clone_camera_metadata(const camera_metadata_t *src);
 
+/**
+ * A compact patch describing the difference between two metadata packets.
+ * The patch is a flat, position-independent blob of
+ * get_camera_metadata_patch_size() bytes that can be sent across process
+ * boundaries as-is. Consecutive capture results typically differ in a small
+ * fraction of their entries, so shipping a patch against the previous result
+ * is much cheaper than serializing the full packet every frame.
+ */
+typedef struct camera_metadata_patch camera_metadata_patch_t;
+
+/**
+ * Compute the patch transforming base into updated. Entries are matched by
+ * tag: the patch records entries of updated that are absent from base or
+ * differ in type, count or data, plus the tags present in base but absent
+ * from updated. Matching is linear per tag on unsorted buffers; sort both
+ * packets first for large metadata.
+ *
+ * Tags are assumed unique within each packet, as produced by
+ * add_camera_metadata_entry(); with duplicate tags the match is against an
+ * arbitrary duplicate.
+ *
+ * Returns a patch to be freed with free_camera_metadata_patch(), or NULL on
+ * allocation failure or invalid arguments.
+ */
+ANDROID_API
+camera_metadata_patch_t *diff_camera_metadata(const camera_metadata_t *base,
+        const camera_metadata_t *updated);
+
+/**
+ * Get the size of a patch blob in bytes; this many bytes starting at patch
+ * must be transferred to reconstruct the updated packet on the receiving
+ * side. Returns 0 if patch is NULL.
+ */
+ANDROID_API
+size_t get_camera_metadata_patch_size(const camera_metadata_patch_t *patch);
+
+/**
+ * Apply a patch to the base packet it was diffed against, returning a newly
+ * allocated packet equivalent to the updated packet passed to
+ * diff_camera_metadata(); free it with free_camera_metadata(). The patch
+ * internals are validated, and each patch carries a content hash of its base
+ * packet, so applying against a different base than the one diffed against
+ * fails. Returns NULL on validation or allocation failure.
+ */
+ANDROID_API
+camera_metadata_t *apply_camera_metadata_patch(const camera_metadata_t *base,
+        const camera_metadata_patch_t *patch);
+
+/**
+ * Free a patch returned by diff_camera_metadata().
+ */
+ANDROID_API
+void free_camera_metadata_patch(camera_metadata_patch_t *patch);
+
+/**
+ * An incremental builder for metadata packets of unknown final size.
+ * add_camera_metadata_entry() on a fixed packet fails when the capacity is
+ * exhausted, which forces callers that cannot predict their entry or data
+ * counts to allocate worst-case headroom up front. The builder instead
+ * accumulates entries in growable chunks and emits a contiguous packet sized
+ * exactly for what was added (entry_count == entry_capacity and
+ * data_count == data_capacity) in one final pass.
+ */
+typedef struct camera_metadata_builder camera_metadata_builder_t;
+
+/**
+ * Allocate an empty metadata builder. Returns NULL on allocation failure.
+ * Release it with finish_camera_metadata_builder() or, to discard the staged
+ * entries without building a packet, free_camera_metadata_builder().
+ */
+ANDROID_API
+camera_metadata_builder_t *allocate_camera_metadata_builder(void);
+
+/**
+ * Stage a metadata entry in the builder; arguments are as for
+ * add_camera_metadata_entry(), and the tag type is resolved the same way.
+ * The data is copied, so the caller's buffer may be reused immediately.
+ * There is no capacity to exhaust; returns a non-zero value only for an
+ * unknown tag, invalid arguments, or allocation failure.
+ */
+ANDROID_API
+int add_camera_metadata_builder_entry(camera_metadata_builder_t *builder,
+        uint32_t tag,
+        const void *data,
+        size_t data_count);
+
+/**
+ * Build the packet from the staged entries, in the order they were added,
+ * and free the builder (even on failure). The packet has no unused capacity;
+ * grow_camera_metadata() can add headroom later if needed. Returns NULL on
+ * allocation failure. Free the packet with free_camera_metadata().
+ */
+ANDROID_API
+camera_metadata_t *finish_camera_metadata_builder(
+        camera_metadata_builder_t *builder);
+
+/**
+ * Free a builder without building a packet, discarding the staged entries.
+ */
+ANDROID_API
+void free_camera_metadata_builder(camera_metadata_builder_t *builder);
+
+/**
+ * Take an additional reference on an existing metadata buffer instead of
+ * cloning it. This is an O(1) copy-on-write alternative to
+ * clone_camera_metadata() for buffers that are mostly read and rarely, if
+ * ever, modified: the returned pointer is the buffer itself, and each
+ * reference is released with free_camera_metadata(). The memory is freed when
+ * the last reference is released.
+ *
+ * While a buffer is shared (more than one outstanding reference), all
+ * modifying calls on it fail with ERROR; call unshare_camera_metadata() to
+ * obtain a private copy before writing. Only buffers allocated with
+ * allocate_camera_metadata(), clone_camera_metadata(), or
+ * allocate_copy_camera_metadata_checked() may be shared; buffers from
+ * place_camera_metadata() may not, since their memory is caller owned.
+ *
+ * Returns the buffer on success, or NULL on allocation failure or if metadata
+ * is NULL.
+ */
+ANDROID_API
+camera_metadata_t *acquire_camera_metadata(camera_metadata_t *metadata);
+
+/**
+ * Obtain an exclusively owned version of a possibly shared metadata buffer,
+ * in preparation for modifying it. If the buffer is not shared it is returned
+ * unchanged; otherwise a private clone is made, the caller's reference on the
+ * shared buffer is released, and the clone is returned. This defers the full
+ * copy that clone_camera_metadata() always pays to the first write, and skips
+ * it entirely for references that are never written through.
+ *
+ * Returns the private buffer, which must be freed with free_camera_metadata();
+ * the passed-in pointer must no longer be used unless it is the returned one.
+ * Returns NULL if cloning failed, in which case the caller's reference is
+ * still held.
+ */
+ANDROID_API
+camera_metadata_t *unshare_camera_metadata(camera_metadata_t *metadata);
+
+/**
+ * Check whether a metadata buffer currently has more than one outstanding
+ * reference. Returns 1 if shared, 0 otherwise. A shared buffer must not be
+ * modified; see acquire_camera_metadata().
+ */
+ANDROID_API
+int is_camera_metadata_shared(const camera_metadata_t *metadata);
+
+/**
+ * Pin a metadata buffer for zero-copy reads.
+ *
+ * The data pointers filled in by find_camera_metadata_ro_entry() already
+ * point into the buffer itself; what forces consumers to copy large-array
+ * tags (lens shading maps, tone curves) is that the buffer may be modified
+ * or freed while they hold those pointers. Pinning takes a reference on the
+ * buffer (see acquire_camera_metadata()) and returns a read-only view of it:
+ * while at least one pin is outstanding the buffer counts as shared, so all
+ * modifying calls on it fail with ERROR and the memory cannot be freed out
+ * from under the reader. Entry data pointers obtained from a pinned buffer
+ * therefore stay valid and stable until the matching unpin, and may be
+ * consumed in place.
+ *
+ * Same restrictions as acquire_camera_metadata(): only heap-allocated
+ * buffers may be pinned, not ones from place_camera_metadata().
+ *
+ * Returns the read-only view, or NULL on allocation failure or if metadata
+ * is NULL.
+ */
+ANDROID_API
+const camera_metadata_t *pin_camera_metadata(camera_metadata_t *metadata);
+
+/**
+ * Release one pin taken with pin_camera_metadata(). Entry data pointers
+ * obtained through this pin must no longer be used; the memory is freed when
+ * the last reference is released. If metadata is NULL nothing happens.
+ */
+ANDROID_API
+void unpin_camera_metadata(const camera_metadata_t *metadata);
+
 /**
  * Calculate the number of bytes of extra data a given metadata entry will take
  * up. That is, if entry of 'type' with a payload of 'data_count' values is
@@ -341,8 +644,9 @@ size_t calculate_camera_metadata_entry_data_size(uint8_t type,
  * entries in the data array of the tag's type, not a count of
  * bytes. Vendor-defined tags can not be added using this method, unless
  * set_vendor_tag_query_ops() has been called first. Entries are always added to
- * the end of the structure (highest index), so after addition, a
- * previously-sorted array will be marked as unsorted.
+ * the end of the structure (highest index).  A previously-sorted buffer stays
+ * sorted when tags are added in non-decreasing tag order, and is otherwise
+ * marked as unsorted.
  *
  * Returns 0 on success. A non-0 value is returned on error.
  */
@@ -352,6 +656,22 @@ int add_camera_metadata_entry(camera_metadata_t *dst,
         const void *data,
         size_t data_count);
 
+/**
+ * Add a metadata entry as with add_camera_metadata_entry(), but maintain the
+ * sorted order of an already-sorted buffer by inserting the entry at its sorted
+ * position (shifting later entry descriptors up by one index).  This keeps
+ * find_camera_metadata_entry() on its binary search path without a full
+ * re-sort after every addition.  On an unsorted buffer this is identical to
+ * add_camera_metadata_entry().
+ *
+ * Returns 0 on success. A non-0 value is returned on error.
+ */
+ANDROID_API
+int add_sorted_camera_metadata_entry(camera_metadata_t *dst,
+        uint32_t tag,
+        const void *data,
+        size_t data_count);
+
 /**
  * Sort the metadata buffer for fast searching. If already marked as sorted,
  * does nothing. Adding or appending entries to the buffer will place the buffer
@@ -386,6 +706,34 @@ int get_camera_metadata_ro_entry(const camera_metadata_t *src,
         size_t index,
         camera_metadata_ro_entry_t *entry);
 
+/**
+ * Get metadata entry at position index without any argument checking, for hot
+ * read paths iterating a buffer that has already been validated (e.g. with
+ * validate_sealed_camera_metadata()). The caller must guarantee that src and
+ * entry are non-NULL and that index is less than the entry count; violating
+ * this reads out of bounds.
+ */
+ANDROID_API
+void get_camera_metadata_ro_entry_unchecked(const camera_metadata_t *src,
+        size_t index,
+        camera_metadata_ro_entry_t *entry);
+
+/**
+ * Copy the external buffer descriptor at position index of a TYPE_EXTERNAL
+ * entry into *blob, validating it first: the entry type must be
+ * TYPE_EXTERNAL, index must be less than the entry count, and the
+ * descriptor must be well formed (non-negative fd, zero reserved field,
+ * non-zero size, and offset + size must not overflow). Metadata buffers can
+ * cross process boundaries, so descriptors are validated here, at access
+ * time, rather than trusted from the buffer.
+ *
+ * Returns 0 on success. A non-0 value is returned on error.
+ */
+ANDROID_API
+int get_camera_metadata_external_blob(const camera_metadata_ro_entry_t *entry,
+        size_t index,
+        camera_metadata_external_blob_t *blob);
+
 /**
  * Find an entry with given tag value. If not found, returns -ENOENT. Otherwise,
  * returns entry contents like get_camera_metadata_entry.
@@ -407,6 +755,17 @@ int find_camera_metadata_ro_entry(const camera_metadata_t *src,
         uint32_t tag,
         camera_metadata_ro_entry_t *entry);
 
+/**
+ * Find an entry with the given tag value without any argument checking, as
+ * get_camera_metadata_ro_entry_unchecked(). The caller must guarantee that
+ * src and entry are non-NULL and that the buffer has been validated. Returns
+ * -ENOENT if the tag is not present, 0 otherwise.
+ */
+ANDROID_API
+int find_camera_metadata_ro_entry_unchecked(const camera_metadata_t *src,
+        uint32_t tag,
+        camera_metadata_ro_entry_t *entry);
+
 /**
  * Delete an entry at given index. This is an expensive operation, since it
  * requires repacking entries and possibly entry data. This also invalidates any
@@ -433,6 +792,58 @@ int update_camera_metadata_entry(camera_metadata_t *dst,
         size_t data_count,
         camera_metadata_entry_t *updated_entry);
 
+/**
+ * A batched update transaction. Each size-changing
+ * update_camera_metadata_entry() call memmoves the tail of the data section,
+ * so updating many entries per request is O(updates * data). A transaction
+ * stages the updates and commits them with a single compaction pass over the
+ * data section instead.
+ *
+ * Usage:
+ *   camera_metadata_update_t *update = begin_camera_metadata_update(dst);
+ *   stage_camera_metadata_update(update, index, data, data_count); // repeat
+ *   commit_camera_metadata_update(update);  // or abort_camera_metadata_update
+ */
+typedef struct camera_metadata_update camera_metadata_update_t;
+
+/**
+ * Begin a batched update transaction on a metadata buffer. The buffer must not
+ * be modified through other calls until the transaction is committed or
+ * aborted. Returns NULL on allocation failure or if the buffer is shared.
+ */
+ANDROID_API
+camera_metadata_update_t *begin_camera_metadata_update(camera_metadata_t *dst);
+
+/**
+ * Stage new data for the entry at the given index; the entry type is
+ * unchanged. The data is not copied until commit, so the pointer must remain
+ * valid until then. Staging the same index again replaces the earlier staged
+ * data. Returns a non-zero value if the index is out of range or on
+ * allocation failure; the buffer is not modified.
+ */
+ANDROID_API
+int stage_camera_metadata_update(camera_metadata_update_t *update,
+        size_t index,
+        const void *data,
+        size_t data_count);
+
+/**
+ * Apply all staged updates with one compaction pass over the data section,
+ * and free the transaction. If the final data does not fit in the buffer's
+ * capacity, a non-zero value is returned and the buffer is left unmodified.
+ * Maintains sorting, but invalidates camera_metadata_entry instances pointing
+ * into the buffer.
+ */
+ANDROID_API
+int commit_camera_metadata_update(camera_metadata_update_t *update);
+
+/**
+ * Discard all staged updates and free the transaction. The buffer is not
+ * modified.
+ */
+ANDROID_API
+void abort_camera_metadata_update(camera_metadata_update_t *update);
+
 /**
  * Retrieve human-readable name of section the tag is in. Returns NULL if
  * no such tag is defined. Returns NULL for tags in the vendor section, unless
@@ -569,6 +980,52 @@ void dump_indented_camera_metadata(const camera_metadata_t *metadata,
         int verbosity,
         int indentation);
 
+/**
+ * Incremental dump of a metadata buffer.
+ *
+ * dump_camera_metadata() formats every entry in one call, which can block
+ * the caller for tens of milliseconds on a large static info buffer. The
+ * iterator below bounds the work per call: initialize the state with
+ * dump_camera_metadata_begin(), then call dump_camera_metadata_next()
+ * until it returns 0. Each call examines at most max_entries entries and
+ * writes them straight to fd with no intermediate heap allocation, so a
+ * dump can be interleaved with time-sensitive work.
+ *
+ * The optional filter is consulted with each entry's tag before any
+ * formatting work is done; entries it returns 0 for are skipped but still
+ * count toward max_entries so that per-call cost stays bounded. A NULL
+ * filter dumps every entry. The buffer header lines are written by the
+ * first dump_camera_metadata_next() call.
+ *
+ * The state does not own the metadata buffer; the buffer must outlive it
+ * and must not be modified while the dump is in progress. The whole-buffer
+ * dump functions above are one-shot wrappers around this iterator.
+ */
+typedef struct camera_metadata_dump_state {
+    const camera_metadata_t *metadata;
+    uint32_t next_entry;
+    int verbosity;
+    int indentation;
+    int started;
+} camera_metadata_dump_state_t;
+
+ANDROID_API
+void dump_camera_metadata_begin(const camera_metadata_t *metadata,
+        int verbosity,
+        int indentation,
+        camera_metadata_dump_state_t *state);
+
+/**
+ * Dump the next batch of at most max_entries entries to fd. Returns the
+ * number of entries consumed, or 0 when the dump is complete.
+ */
+ANDROID_API
+size_t dump_camera_metadata_next(camera_metadata_dump_state_t *state,
+        int fd,
+        size_t max_entries,
+        int (*filter)(void *context, uint32_t tag),
+        void *context);
+
 /**
  * Prints the specified tag value as a string. Only works for enum tags.
  * Returns 0 on success, -1 on failure.
@@ -0,0 +1,468 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Typed compile-time accessors for camera metadata entries.
+ *
+ * The value type of every ANDROID_* tag is fixed by the tag tables in
+ * camera_metadata_tag_info.c, so reads through these accessors carry no
+ * runtime type checks or data union dispatch: the tag selects the type at
+ * compile time, and an unknown tag fails to compile.
+ *
+ * ! Do not edit the tag specializations directly !
+ *
+ * Generated automatically from camera_metadata_typed_tags.mako
+ */
+
+#ifndef SYSTEM_MEDIA_INCLUDE_ANDROID_CAMERA_METADATA_TYPED_TAGS_H
+#define SYSTEM_MEDIA_INCLUDE_ANDROID_CAMERA_METADATA_TYPED_TAGS_H
+
+#include <system/camera_metadata.h>
+
+#ifdef __cplusplus
+
+namespace android {
+namespace camera_metadata {
+
+/**
+ * Maps a TYPE_* constant to its C value type and to the matching
+ * camera_metadata_entry data union member.
+ */
+template <int tag_type> struct camera_metadata_type_traits;
+
+template <> struct camera_metadata_type_traits<TYPE_BYTE> {
+    typedef uint8_t type;
+    static const type *data(const camera_metadata_ro_entry_t &entry) { return entry.data.u8; }
+    static type *data(const camera_metadata_entry_t &entry) { return entry.data.u8; }
+};
+
+template <> struct camera_metadata_type_traits<TYPE_INT32> {
+    typedef int32_t type;
+    static const type *data(const camera_metadata_ro_entry_t &entry) { return entry.data.i32; }
+    static type *data(const camera_metadata_entry_t &entry) { return entry.data.i32; }
+};
+
+template <> struct camera_metadata_type_traits<TYPE_FLOAT> {
+    typedef float type;
+    static const type *data(const camera_metadata_ro_entry_t &entry) { return entry.data.f; }
+    static type *data(const camera_metadata_entry_t &entry) { return entry.data.f; }
+};
+
+template <> struct camera_metadata_type_traits<TYPE_INT64> {
+    typedef int64_t type;
+    static const type *data(const camera_metadata_ro_entry_t &entry) { return entry.data.i64; }
+    static type *data(const camera_metadata_entry_t &entry) { return entry.data.i64; }
+};
+
+template <> struct camera_metadata_type_traits<TYPE_DOUBLE> {
+    typedef double type;
+    static const type *data(const camera_metadata_ro_entry_t &entry) { return entry.data.d; }
+    static type *data(const camera_metadata_entry_t &entry) { return entry.data.d; }
+};
+
+template <> struct camera_metadata_type_traits<TYPE_RATIONAL> {
+    typedef camera_metadata_rational_t type;
+    static const type *data(const camera_metadata_ro_entry_t &entry) { return entry.data.r; }
+    static type *data(const camera_metadata_entry_t &entry) { return entry.data.r; }
+};
+
+template <> struct camera_metadata_type_traits<TYPE_EXTERNAL> {
+    typedef camera_metadata_external_blob_t type;
+    static const type *data(const camera_metadata_ro_entry_t &entry) { return entry.data.eb; }
+    static type *data(const camera_metadata_entry_t &entry) { return entry.data.eb; }
+};
+
+/*
+ * The accessors alias the entry data pointers directly over the packet,
+ * which is only sound on the fixed flattened ABI; check the exported
+ * layout constants here once instead of per read.
+ */
+static_assert(sizeof(camera_metadata_rational_t) == CAMERA_METADATA_DATA_SIZE,
+        "a rational must fill exactly one packet datum");
+static_assert(alignof(camera_metadata_rational_t) <= CAMERA_METADATA_DATA_ALIGNMENT
+        && alignof(int64_t) <= CAMERA_METADATA_DATA_ALIGNMENT
+        && alignof(double) <= CAMERA_METADATA_DATA_ALIGNMENT,
+        "the packet data alignment must satisfy every value type");
+
+/**
+ * Compile-time tag to TYPE_* mapping, specialized below for every ANDROID_*
+ * tag; using an unlisted tag is a compile error.
+ */
+template <uint32_t tag> struct camera_metadata_tag_type;
+
+#define CAMERA_METADATA_TAG_TYPE(tag, tag_type) \
+    template <> struct camera_metadata_tag_type<tag> { \
+        static constexpr int value = tag_type; \
+    };
+
+CAMERA_METADATA_TAG_TYPE(ANDROID_COLOR_CORRECTION_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_COLOR_CORRECTION_TRANSFORM, TYPE_RATIONAL)
+CAMERA_METADATA_TAG_TYPE(ANDROID_COLOR_CORRECTION_GAINS, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_COLOR_CORRECTION_ABERRATION_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_COLOR_CORRECTION_AVAILABLE_ABERRATION_MODES, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AE_ANTIBANDING_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AE_EXPOSURE_COMPENSATION, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AE_LOCK, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AE_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AE_REGIONS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AE_TARGET_FPS_RANGE, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AE_PRECAPTURE_TRIGGER, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AF_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AF_REGIONS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AF_TRIGGER, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AWB_LOCK, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AWB_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AWB_REGIONS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_CAPTURE_INTENT, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_EFFECT_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_SCENE_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_VIDEO_STABILIZATION_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AE_AVAILABLE_ANTIBANDING_MODES, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AE_AVAILABLE_MODES, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AE_AVAILABLE_TARGET_FPS_RANGES, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AE_COMPENSATION_RANGE, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AE_COMPENSATION_STEP, TYPE_RATIONAL)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AF_AVAILABLE_MODES, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AVAILABLE_EFFECTS, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AVAILABLE_SCENE_MODES, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AVAILABLE_VIDEO_STABILIZATION_MODES, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AWB_AVAILABLE_MODES, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_MAX_REGIONS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_SCENE_MODE_OVERRIDES, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AE_PRECAPTURE_ID, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AE_STATE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AF_STATE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AF_TRIGGER_ID, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AWB_STATE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AVAILABLE_HIGH_SPEED_VIDEO_CONFIGURATIONS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AE_LOCK_AVAILABLE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AWB_LOCK_AVAILABLE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AVAILABLE_MODES, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_POST_RAW_SENSITIVITY_BOOST_RANGE, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_POST_RAW_SENSITIVITY_BOOST, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_ENABLE_ZSL, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AF_SCENE_CHANGE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AVAILABLE_EXTENDED_SCENE_MODE_MAX_SIZES, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AVAILABLE_EXTENDED_SCENE_MODE_ZOOM_RATIO_RANGES, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_EXTENDED_SCENE_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_ZOOM_RATIO_RANGE, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_ZOOM_RATIO, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AVAILABLE_HIGH_SPEED_VIDEO_CONFIGURATIONS_MAXIMUM_RESOLUTION, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AF_REGIONS_SET, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AE_REGIONS_SET, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_CONTROL_AWB_REGIONS_SET, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_DEMOSAIC_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_EDGE_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_EDGE_STRENGTH, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_EDGE_AVAILABLE_EDGE_MODES, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_FLASH_FIRING_POWER, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_FLASH_FIRING_TIME, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_FLASH_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_FLASH_COLOR_TEMPERATURE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_FLASH_MAX_ENERGY, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_FLASH_STATE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_FLASH_INFO_AVAILABLE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_FLASH_INFO_CHARGE_DURATION, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_FLASH_INFO_STRENGTH_MAXIMUM_LEVEL, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_FLASH_INFO_STRENGTH_DEFAULT_LEVEL, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_HOT_PIXEL_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_HOT_PIXEL_AVAILABLE_HOT_PIXEL_MODES, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_JPEG_GPS_COORDINATES, TYPE_DOUBLE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_JPEG_GPS_PROCESSING_METHOD, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_JPEG_GPS_TIMESTAMP, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_JPEG_ORIENTATION, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_JPEG_QUALITY, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_JPEG_THUMBNAIL_QUALITY, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_JPEG_THUMBNAIL_SIZE, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_JPEG_AVAILABLE_THUMBNAIL_SIZES, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_JPEG_MAX_SIZE, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_JPEG_SIZE, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LENS_APERTURE, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LENS_FILTER_DENSITY, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LENS_FOCAL_LENGTH, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LENS_FOCUS_DISTANCE, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LENS_OPTICAL_STABILIZATION_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LENS_FACING, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LENS_POSE_ROTATION, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LENS_POSE_TRANSLATION, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LENS_FOCUS_RANGE, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LENS_STATE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LENS_INTRINSIC_CALIBRATION, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LENS_RADIAL_DISTORTION, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LENS_POSE_REFERENCE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LENS_DISTORTION, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LENS_DISTORTION_MAXIMUM_RESOLUTION, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LENS_INTRINSIC_CALIBRATION_MAXIMUM_RESOLUTION, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LENS_INFO_AVAILABLE_APERTURES, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LENS_INFO_AVAILABLE_FILTER_DENSITIES, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LENS_INFO_AVAILABLE_FOCAL_LENGTHS, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LENS_INFO_AVAILABLE_OPTICAL_STABILIZATION, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LENS_INFO_HYPERFOCAL_DISTANCE, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LENS_INFO_MINIMUM_FOCUS_DISTANCE, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LENS_INFO_SHADING_MAP_SIZE, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LENS_INFO_FOCUS_DISTANCE_CALIBRATION, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_NOISE_REDUCTION_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_NOISE_REDUCTION_STRENGTH, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_NOISE_REDUCTION_AVAILABLE_NOISE_REDUCTION_MODES, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_QUIRKS_METERING_CROP_REGION, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_QUIRKS_TRIGGER_AF_WITH_AUTO, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_QUIRKS_USE_ZSL_FORMAT, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_QUIRKS_USE_PARTIAL_RESULT, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_QUIRKS_PARTIAL_RESULT, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_REQUEST_FRAME_COUNT, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_REQUEST_ID, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_REQUEST_INPUT_STREAMS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_REQUEST_METADATA_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_REQUEST_OUTPUT_STREAMS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_REQUEST_TYPE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_REQUEST_MAX_NUM_OUTPUT_STREAMS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_REQUEST_MAX_NUM_REPROCESS_STREAMS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_REQUEST_MAX_NUM_INPUT_STREAMS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_REQUEST_PIPELINE_DEPTH, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_REQUEST_PIPELINE_MAX_DEPTH, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_REQUEST_PARTIAL_RESULT_COUNT, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_REQUEST_AVAILABLE_CAPABILITIES, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_REQUEST_AVAILABLE_REQUEST_KEYS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_REQUEST_AVAILABLE_RESULT_KEYS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_REQUEST_AVAILABLE_CHARACTERISTICS_KEYS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_REQUEST_AVAILABLE_SESSION_KEYS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_REQUEST_AVAILABLE_PHYSICAL_CAMERA_REQUEST_KEYS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_REQUEST_CHARACTERISTIC_KEYS_NEEDING_PERMISSION, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_REQUEST_AVAILABLE_DYNAMIC_RANGE_PROFILES_MAP, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_REQUEST_RECOMMENDED_TEN_BIT_DYNAMIC_RANGE_PROFILE, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_CROP_REGION, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_AVAILABLE_FORMATS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_AVAILABLE_JPEG_MIN_DURATIONS, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_AVAILABLE_JPEG_SIZES, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_AVAILABLE_MAX_DIGITAL_ZOOM, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_AVAILABLE_PROCESSED_MIN_DURATIONS, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_AVAILABLE_PROCESSED_SIZES, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_AVAILABLE_RAW_MIN_DURATIONS, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_AVAILABLE_RAW_SIZES, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_AVAILABLE_INPUT_OUTPUT_FORMATS_MAP, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_AVAILABLE_STREAM_CONFIGURATIONS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_AVAILABLE_MIN_FRAME_DURATIONS, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_AVAILABLE_STALL_DURATIONS, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_CROPPING_TYPE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_AVAILABLE_RECOMMENDED_STREAM_CONFIGURATIONS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_AVAILABLE_RECOMMENDED_INPUT_OUTPUT_FORMATS_MAP, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_AVAILABLE_ROTATE_AND_CROP_MODES, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_ROTATE_AND_CROP, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_DEFAULT_SECURE_IMAGE_SIZE, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_PHYSICAL_CAMERA_MULTI_RESOLUTION_STREAM_CONFIGURATIONS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_AVAILABLE_STREAM_CONFIGURATIONS_MAXIMUM_RESOLUTION, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_AVAILABLE_MIN_FRAME_DURATIONS_MAXIMUM_RESOLUTION, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_AVAILABLE_STALL_DURATIONS_MAXIMUM_RESOLUTION, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_AVAILABLE_INPUT_OUTPUT_FORMATS_MAP_MAXIMUM_RESOLUTION, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_MULTI_RESOLUTION_STREAM_SUPPORTED, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_CROP_REGION_SET, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SCALER_AVAILABLE_STREAM_USE_CASES, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_EXPOSURE_TIME, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_FRAME_DURATION, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_SENSITIVITY, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_REFERENCE_ILLUMINANT1, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_REFERENCE_ILLUMINANT2, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_CALIBRATION_TRANSFORM1, TYPE_RATIONAL)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_CALIBRATION_TRANSFORM2, TYPE_RATIONAL)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_COLOR_TRANSFORM1, TYPE_RATIONAL)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_COLOR_TRANSFORM2, TYPE_RATIONAL)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_FORWARD_MATRIX1, TYPE_RATIONAL)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_FORWARD_MATRIX2, TYPE_RATIONAL)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_BASE_GAIN_FACTOR, TYPE_RATIONAL)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_BLACK_LEVEL_PATTERN, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_MAX_ANALOG_SENSITIVITY, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_ORIENTATION, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_PROFILE_HUE_SAT_MAP_DIMENSIONS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_TIMESTAMP, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_TEMPERATURE, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_NEUTRAL_COLOR_POINT, TYPE_RATIONAL)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_NOISE_PROFILE, TYPE_DOUBLE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_PROFILE_HUE_SAT_MAP, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_PROFILE_TONE_CURVE, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_GREEN_SPLIT, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_TEST_PATTERN_DATA, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_TEST_PATTERN_MODE, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_AVAILABLE_TEST_PATTERN_MODES, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_ROLLING_SHUTTER_SKEW, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_OPTICAL_BLACK_REGIONS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_DYNAMIC_BLACK_LEVEL, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_DYNAMIC_WHITE_LEVEL, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_OPAQUE_RAW_SIZE, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_OPAQUE_RAW_SIZE_MAXIMUM_RESOLUTION, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_PIXEL_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_RAW_BINNING_FACTOR_USED, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_READOUT_TIMESTAMP, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_INFO_ACTIVE_ARRAY_SIZE, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_INFO_SENSITIVITY_RANGE, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_INFO_COLOR_FILTER_ARRANGEMENT, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_INFO_EXPOSURE_TIME_RANGE, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_INFO_MAX_FRAME_DURATION, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_INFO_PHYSICAL_SIZE, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_INFO_PIXEL_ARRAY_SIZE, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_INFO_WHITE_LEVEL, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_INFO_TIMESTAMP_SOURCE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_INFO_LENS_SHADING_APPLIED, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_INFO_PRE_CORRECTION_ACTIVE_ARRAY_SIZE, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_INFO_ACTIVE_ARRAY_SIZE_MAXIMUM_RESOLUTION, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_INFO_PIXEL_ARRAY_SIZE_MAXIMUM_RESOLUTION, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_INFO_PRE_CORRECTION_ACTIVE_ARRAY_SIZE_MAXIMUM_RESOLUTION, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SENSOR_INFO_BINNING_FACTOR, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SHADING_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SHADING_STRENGTH, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SHADING_AVAILABLE_MODES, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_FACE_DETECT_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_HISTOGRAM_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_SHARPNESS_MAP_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_HOT_PIXEL_MAP_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_FACE_IDS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_FACE_LANDMARKS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_FACE_RECTANGLES, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_FACE_SCORES, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_HISTOGRAM, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_SHARPNESS_MAP, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_LENS_SHADING_CORRECTION_MAP, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_LENS_SHADING_MAP, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_PREDICTED_COLOR_GAINS, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_PREDICTED_COLOR_TRANSFORM, TYPE_RATIONAL)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_SCENE_FLICKER, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_HOT_PIXEL_MAP, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_LENS_SHADING_MAP_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_OIS_DATA_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_OIS_TIMESTAMPS, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_OIS_X_SHIFTS, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_OIS_Y_SHIFTS, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_INFO_AVAILABLE_FACE_DETECT_MODES, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_INFO_HISTOGRAM_BUCKET_COUNT, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_INFO_MAX_FACE_COUNT, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_INFO_MAX_HISTOGRAM_COUNT, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_INFO_MAX_SHARPNESS_MAP_VALUE, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_INFO_SHARPNESS_MAP_SIZE, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_INFO_AVAILABLE_HOT_PIXEL_MAP_MODES, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_INFO_AVAILABLE_LENS_SHADING_MAP_MODES, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_STATISTICS_INFO_AVAILABLE_OIS_DATA_MODES, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_TONEMAP_CURVE_BLUE, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_TONEMAP_CURVE_GREEN, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_TONEMAP_CURVE_RED, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_TONEMAP_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_TONEMAP_MAX_CURVE_POINTS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_TONEMAP_AVAILABLE_TONE_MAP_MODES, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_TONEMAP_GAMMA, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_TONEMAP_PRESET_CURVE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LED_TRANSMIT, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LED_AVAILABLE_LEDS, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_INFO_SUPPORTED_HARDWARE_LEVEL, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_INFO_VERSION, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_INFO_SUPPORTED_BUFFER_MANAGEMENT_VERSION, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_INFO_DEVICE_STATE_ORIENTATIONS, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_BLACK_LEVEL_LOCK, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SYNC_FRAME_NUMBER, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_SYNC_MAX_LATENCY, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_REPROCESS_EFFECTIVE_EXPOSURE_FACTOR, TYPE_FLOAT)
+CAMERA_METADATA_TAG_TYPE(ANDROID_REPROCESS_MAX_CAPTURE_STALL, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_DEPTH_MAX_DEPTH_SAMPLES, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_DEPTH_AVAILABLE_DEPTH_STREAM_CONFIGURATIONS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_DEPTH_AVAILABLE_DEPTH_MIN_FRAME_DURATIONS, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_DEPTH_AVAILABLE_DEPTH_STALL_DURATIONS, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_DEPTH_DEPTH_IS_EXCLUSIVE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_DEPTH_AVAILABLE_RECOMMENDED_DEPTH_STREAM_CONFIGURATIONS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_DEPTH_AVAILABLE_DYNAMIC_DEPTH_STREAM_CONFIGURATIONS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_DEPTH_AVAILABLE_DYNAMIC_DEPTH_MIN_FRAME_DURATIONS, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_DEPTH_AVAILABLE_DYNAMIC_DEPTH_STALL_DURATIONS, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_DEPTH_AVAILABLE_DEPTH_STREAM_CONFIGURATIONS_MAXIMUM_RESOLUTION, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_DEPTH_AVAILABLE_DEPTH_MIN_FRAME_DURATIONS_MAXIMUM_RESOLUTION, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_DEPTH_AVAILABLE_DEPTH_STALL_DURATIONS_MAXIMUM_RESOLUTION, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_DEPTH_AVAILABLE_DYNAMIC_DEPTH_STREAM_CONFIGURATIONS_MAXIMUM_RESOLUTION, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_DEPTH_AVAILABLE_DYNAMIC_DEPTH_MIN_FRAME_DURATIONS_MAXIMUM_RESOLUTION, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_DEPTH_AVAILABLE_DYNAMIC_DEPTH_STALL_DURATIONS_MAXIMUM_RESOLUTION, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LOGICAL_MULTI_CAMERA_PHYSICAL_IDS, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LOGICAL_MULTI_CAMERA_SENSOR_SYNC_TYPE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_LOGICAL_MULTI_CAMERA_ACTIVE_PHYSICAL_ID, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_DISTORTION_CORRECTION_MODE, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_DISTORTION_CORRECTION_AVAILABLE_MODES, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_HEIC_AVAILABLE_HEIC_STREAM_CONFIGURATIONS, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_HEIC_AVAILABLE_HEIC_MIN_FRAME_DURATIONS, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_HEIC_AVAILABLE_HEIC_STALL_DURATIONS, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_HEIC_AVAILABLE_HEIC_STREAM_CONFIGURATIONS_MAXIMUM_RESOLUTION, TYPE_INT32)
+CAMERA_METADATA_TAG_TYPE(ANDROID_HEIC_AVAILABLE_HEIC_MIN_FRAME_DURATIONS_MAXIMUM_RESOLUTION, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_HEIC_AVAILABLE_HEIC_STALL_DURATIONS_MAXIMUM_RESOLUTION, TYPE_INT64)
+CAMERA_METADATA_TAG_TYPE(ANDROID_HEIC_INFO_SUPPORTED, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_HEIC_INFO_MAX_JPEG_APP_SEGMENTS_COUNT, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_AUTOMOTIVE_LOCATION, TYPE_BYTE)
+CAMERA_METADATA_TAG_TYPE(ANDROID_AUTOMOTIVE_LENS_FACING, TYPE_BYTE)
+
+#undef CAMERA_METADATA_TAG_TYPE
+
+template <uint32_t tag>
+using camera_metadata_tag_traits =
+        camera_metadata_type_traits<camera_metadata_tag_type<tag>::value>;
+
+/**
+ * A typed view of one entry's data.  count is the number of values of the
+ * entry's type, as camera_metadata_ro_entry.count; data is NULL (and count 0)
+ * when the tag is absent.
+ */
+template <typename T>
+struct camera_metadata_span {
+    T *data;
+    size_t count;
+
+    constexpr size_t size() const { return count; }
+    constexpr bool empty() const { return count == 0; }
+    constexpr T *begin() const { return data; }
+    constexpr T *end() const { return data + count; }
+    constexpr T &operator[](size_t i) const { return data[i]; }
+    constexpr explicit operator bool() const { return data != NULL; }
+};
+
+/**
+ * Finds tag in src and returns a typed span of its data, or an empty span if
+ * the tag is not present.  The value type is derived from the tag at compile
+ * time, so no per-access type validation is performed:
+ *
+ *   auto exposure = get<ANDROID_SENSOR_EXPOSURE_TIME>(meta); // int64_t span
+ *   if (!exposure.empty()) useNs(exposure[0]);
+ */
+template <uint32_t tag>
+inline camera_metadata_span<const typename camera_metadata_tag_traits<tag>::type>
+get(const camera_metadata_t *src) {
+    camera_metadata_ro_entry_t entry;
+    if (find_camera_metadata_ro_entry(src, tag, &entry) != 0) {
+        return { NULL, 0 };
+    }
+    return { camera_metadata_tag_traits<tag>::data(entry), entry.count };
+}
+
+/**
+ * As get(), but the returned values may be modified in place.  The count
+ * cannot be changed through the span.
+ */
+template <uint32_t tag>
+inline camera_metadata_span<typename camera_metadata_tag_traits<tag>::type>
+get_mutable(camera_metadata_t *src) {
+    camera_metadata_entry_t entry;
+    if (find_camera_metadata_entry(src, tag, &entry) != 0) {
+        return { NULL, 0 };
+    }
+    return { camera_metadata_tag_traits<tag>::data(entry), entry.count };
+}
+
+}  // namespace camera_metadata
+}  // namespace android
+
+#endif  /* __cplusplus */
+
+#endif  /* SYSTEM_MEDIA_INCLUDE_ANDROID_CAMERA_METADATA_TYPED_TAGS_H */
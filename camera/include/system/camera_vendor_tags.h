@@ -26,6 +26,20 @@ extern "C" {
 
 typedef uint64_t metadata_vendor_id_t;
 
+/**
+ * Full description of one vendor tag, as filled by the batched
+ * get_all_tag_descriptors() calls below.  The name pointers follow the same
+ * ownership rules as the per-tag get_section_name()/get_tag_name() calls:
+ * they are owned by the vendor module and must remain valid for its
+ * lifetime.
+ */
+typedef struct vendor_tag_descriptor_v1 {
+    uint32_t tag;
+    int32_t type;
+    const char *section_name;
+    const char *tag_name;
+} vendor_tag_descriptor_v1_t;
+
 /**
  * Vendor tags:
  *
@@ -89,8 +103,22 @@ struct vendor_tag_ops {
      */
     int (*get_tag_type)(const vendor_tag_ops_t *v, uint32_t tag);
 
+    /**
+     * Fill an array with the descriptors of all supported vendor tags, so a
+     * caller enumerating the whole tag set makes one call instead of three
+     * per tag.  descriptor_array holds space for count descriptors, with
+     * count from get_tag_count().  Returns the number of descriptors
+     * filled, or -1 on error.
+     *
+     * Optional: may be NULL (the slot was formerly reserved, so providers
+     * built against older headers leave it NULL).  Callers must fall back
+     * to get_all_tags() and the per-tag queries above when it is NULL.
+     */
+    int (*get_all_tag_descriptors)(const vendor_tag_ops_t *v,
+            vendor_tag_descriptor_v1_t *descriptor_array, int count);
+
     /* Reserved for future use.  These must be initialized to NULL. */
-    void* reserved[8];
+    void* reserved[7];
 };
 
 struct vendor_tag_cache_ops {
@@ -146,8 +174,22 @@ struct vendor_tag_cache_ops {
      */
     int (*get_tag_type)(uint32_t tag, metadata_vendor_id_t id);
 
+    /**
+     * Fill an array with the descriptors of all supported vendor tags for
+     * the given vendor id; the batched equivalent of get_all_tags() plus
+     * the per-tag queries above.  descriptor_array holds space for count
+     * descriptors, with count from get_tag_count().  Returns the number of
+     * descriptors filled, or -1 on error.
+     *
+     * Optional: may be NULL (the slot was formerly reserved, so providers
+     * built against older headers leave it NULL).  Callers must fall back
+     * to the per-tag queries when it is NULL.
+     */
+    int (*get_all_tag_descriptors)(vendor_tag_descriptor_v1_t *descriptor_array,
+            int count, metadata_vendor_id_t id);
+
     /* Reserved for future use.  These must be initialized to NULL. */
-    void* reserved[8];
+    void* reserved[7];
 };
 
 #ifdef __cplusplus
@@ -22,6 +22,8 @@
 #include <assert.h>
 #include <errno.h>
 #include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -41,7 +43,7 @@
  * array; otherwise, it can found in the parent's data array at index
  * data.offset.
  */
-#define ENTRY_ALIGNMENT ((size_t) 4)
+#define ENTRY_ALIGNMENT CAMERA_METADATA_ENTRY_ALIGNMENT
 typedef struct camera_metadata_buffer_entry {
     uint32_t tag;
     uint32_t count;
@@ -90,7 +92,7 @@ typedef uint32_t metadata_size_t;
  * In short, the entries and data are contiguous in memory after the metadata
  * header.
  */
-#define METADATA_ALIGNMENT ((size_t) 4)
+#define METADATA_ALIGNMENT CAMERA_METADATA_ALIGNMENT
 struct camera_metadata {
     metadata_size_t          size;
     uint32_t                 version;
@@ -101,7 +103,8 @@ struct camera_metadata {
     metadata_size_t          data_count;
     metadata_size_t          data_capacity;
     metadata_uptrdiff_t      data_start; // Offset from camera_metadata
-    uint32_t                 padding;    // padding to 8 bytes boundary
+    uint32_t                 seal;       // seal stamp when FLAG_SEALED is set;
+                                         // otherwise padding to 8 bytes boundary
     metadata_vendor_id_t     vendor_id;
 };
 
@@ -111,7 +114,7 @@ struct camera_metadata {
  * non-pointer type description in order to figure out the largest alignment
  * requirement for data (DATA_ALIGNMENT).
  */
-#define DATA_ALIGNMENT ((size_t) 8)
+#define DATA_ALIGNMENT CAMERA_METADATA_DATA_ALIGNMENT
 typedef union camera_metadata_data {
     uint8_t u8;
     int32_t i32;
@@ -127,19 +130,23 @@ _Static_assert(sizeof(metadata_uptrdiff_t) == 4,
          "Size of metadata_uptrdiff_t must be 4");
 _Static_assert(sizeof(metadata_vendor_id_t) == 8,
          "Size of metadata_vendor_id_t must be 8");
-_Static_assert(sizeof(camera_metadata_data_t) == 8,
-         "Size of camera_metadata_data_t must be 8");
-
-_Static_assert(offsetof(camera_metadata_buffer_entry_t, tag) == 0,
-         "Offset of tag must be 0");
-_Static_assert(offsetof(camera_metadata_buffer_entry_t, count) == 4,
-         "Offset of count must be 4");
-_Static_assert(offsetof(camera_metadata_buffer_entry_t, data) == 8,
-         "Offset of data must be 8");
-_Static_assert(offsetof(camera_metadata_buffer_entry_t, type) == 12,
-         "Offset of type must be 12");
-_Static_assert(sizeof(camera_metadata_buffer_entry_t) == 16,
-         "Size of camera_metadata_buffer_entry_t must be 16");
+_Static_assert(sizeof(camera_metadata_data_t) == CAMERA_METADATA_DATA_SIZE,
+         "Size of camera_metadata_data_t must match the exported layout");
+
+_Static_assert(offsetof(camera_metadata_buffer_entry_t, tag)
+         == CAMERA_METADATA_ENTRY_TAG_OFFSET,
+         "Offset of tag must match the exported layout");
+_Static_assert(offsetof(camera_metadata_buffer_entry_t, count)
+         == CAMERA_METADATA_ENTRY_COUNT_OFFSET,
+         "Offset of count must match the exported layout");
+_Static_assert(offsetof(camera_metadata_buffer_entry_t, data)
+         == CAMERA_METADATA_ENTRY_DATA_OFFSET,
+         "Offset of data must match the exported layout");
+_Static_assert(offsetof(camera_metadata_buffer_entry_t, type)
+         == CAMERA_METADATA_ENTRY_TYPE_OFFSET,
+         "Offset of type must match the exported layout");
+_Static_assert(sizeof(camera_metadata_buffer_entry_t) == CAMERA_METADATA_ENTRY_SIZE,
+         "Size of camera_metadata_buffer_entry_t must match the exported layout");
 
 _Static_assert(offsetof(camera_metadata_t, size) == 0,
          "Offset of size must be 0");
@@ -173,11 +180,55 @@ _Static_assert(sizeof(camera_metadata_t) == 48,
 #define METADATA_PACKET_ALIGNMENT \
     MAX_ALIGNMENT(MAX_ALIGNMENT(DATA_ALIGNMENT, METADATA_ALIGNMENT), ENTRY_ALIGNMENT)
 
+_Static_assert(METADATA_PACKET_ALIGNMENT == CAMERA_METADATA_PACKET_ALIGNMENT,
+         "Packet alignment must match the exported layout");
+
 /** Versioning information */
 #define CURRENT_METADATA_VERSION 1
 
 /** Flag definitions */
 #define FLAG_SORTED 0x00000001
+#define FLAG_SEALED 0x00000002
+
+static uint32_t fnv1a_bytes(uint32_t hash, const void *data, size_t size) {
+    const uint8_t *bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u; // FNV-1a prime
+    }
+    return hash;
+}
+
+/**
+ * Seal stamp over the structural header fields, FNV-1a. The stamp vouches
+ * that the per-entry walk of validate_camera_metadata_structure() was run by
+ * seal_camera_metadata() on this exact layout, so a trusted receiver can
+ * check it in O(1) instead of re-walking every entry. flags is deliberately
+ * excluded: it holds FLAG_SEALED itself and any flag-changing operation also
+ * clears the seal.
+ */
+static uint32_t camera_metadata_seal_hash(const camera_metadata_t *header) {
+    const uint32_t fields[] = {
+        header->size,
+        header->version,
+        header->entry_count,
+        header->entry_capacity,
+        header->entries_start,
+        header->data_count,
+        header->data_capacity,
+        header->data_start,
+    };
+    uint32_t hash = fnv1a_bytes(0x811c9dc5u, fields, sizeof(fields));
+    // 0 is reserved for "never sealed" so a zero-initialized buffer with a
+    // stray FLAG_SEALED bit cannot pass the stamp check.
+    return hash != 0 ? hash : 1;
+}
+
+/** Any structural modification invalidates an existing seal. */
+static void clear_camera_metadata_seal(camera_metadata_t *metadata) {
+    metadata->flags &= ~FLAG_SEALED;
+    metadata->seal = 0;
+}
 
 /** Tag information */
 
@@ -194,7 +245,8 @@ const size_t camera_metadata_type_size[NUM_TYPES] = {
     [TYPE_FLOAT]    = sizeof(float),
     [TYPE_INT64]    = sizeof(int64_t),
     [TYPE_DOUBLE]   = sizeof(double),
-    [TYPE_RATIONAL] = sizeof(camera_metadata_rational_t)
+    [TYPE_RATIONAL] = sizeof(camera_metadata_rational_t),
+    [TYPE_EXTERNAL] = sizeof(camera_metadata_external_blob_t)
 };
 
 const char *camera_metadata_type_names[NUM_TYPES] = {
@@ -203,9 +255,18 @@ const char *camera_metadata_type_names[NUM_TYPES] = {
     [TYPE_FLOAT]    = "float",
     [TYPE_INT64]    = "int64",
     [TYPE_DOUBLE]   = "double",
-    [TYPE_RATIONAL] = "rational"
+    [TYPE_RATIONAL] = "rational",
+    [TYPE_EXTERNAL] = "external"
 };
 
+// External blob descriptors are stored in the data section like any other
+// out-of-line value, so they must pack to a whole number of datums and not
+// need stricter alignment than the data section provides.
+_Static_assert(sizeof(camera_metadata_external_blob_t) % CAMERA_METADATA_DATA_SIZE == 0,
+         "External blob descriptors must be a whole number of datums");
+_Static_assert(_Alignof(camera_metadata_external_blob_t) <= DATA_ALIGNMENT,
+         "External blob descriptors must not outgrow the data alignment");
+
 static camera_metadata_buffer_entry_t *get_entries(
         const camera_metadata_t *metadata) {
     return (camera_metadata_buffer_entry_t*)
@@ -280,6 +341,7 @@ camera_metadata_t *place_camera_metadata(void *dst,
     camera_metadata_t *metadata = (camera_metadata_t*)dst;
     metadata->version = CURRENT_METADATA_VERSION;
     metadata->flags = 0;
+    metadata->seal = 0;
     metadata->entry_count = 0;
     metadata->entry_capacity = entry_capacity;
     metadata->entries_start =
@@ -295,7 +357,178 @@ camera_metadata_t *place_camera_metadata(void *dst,
     assert(validate_camera_metadata_structure(metadata, NULL) == OK);
     return metadata;
 }
+camera_metadata_t *grow_camera_metadata(camera_metadata_t *metadata,
+                                        size_t entry_capacity,
+                                        size_t data_capacity) {
+    if (metadata == NULL) return NULL;
+    if (is_camera_metadata_shared(metadata)) {
+        ALOGE("%s: Cannot grow a shared metadata buffer; unshare it first",
+                __FUNCTION__);
+        return NULL;
+    }
+
+    // Growth only; treat a no-op request as success
+    if (entry_capacity < metadata->entry_capacity) {
+        entry_capacity = metadata->entry_capacity;
+    }
+    if (data_capacity < metadata->data_capacity) {
+        data_capacity = metadata->data_capacity;
+    }
+    if (entry_capacity == metadata->entry_capacity &&
+            data_capacity == metadata->data_capacity) {
+        return metadata;
+    }
+
+    size_t memory_needed = calculate_camera_metadata_size(entry_capacity,
+                                                          data_capacity);
+    camera_metadata_t *grown = (camera_metadata_t*)realloc(metadata, memory_needed);
+    if (grown == NULL) return NULL;
+
+    // The entry descriptor array starts at the same offset but is now larger,
+    // so shift the data section up to its new aligned start.  When realloc
+    // extends the slab in place, this memmove of the used data bytes is the
+    // only copy, instead of copying the whole packet into a fresh allocation.
+    size_t data_unaligned = (uint8_t*)(get_entries(grown) + entry_capacity) -
+            (uint8_t*)grown;
+    size_t data_start = ALIGN_TO(data_unaligned, DATA_ALIGNMENT);
+    memmove((uint8_t*)grown + data_start,
+            (uint8_t*)grown + grown->data_start,
+            grown->data_count);
+    grown->entry_capacity = entry_capacity;
+    grown->data_capacity = data_capacity;
+    grown->data_start = data_start;
+    grown->size = memory_needed;
+    clear_camera_metadata_seal(grown);
+
+    assert(validate_camera_metadata_structure(grown, NULL) == OK);
+    return grown;
+}
+
+/**
+ * Reference counts for buffers shared through acquire_camera_metadata().
+ *
+ * The packet layout is a wire format shared across processes, so the count
+ * cannot live in the buffer itself; it is kept in a side list keyed by the
+ * buffer pointer. A buffer with no node, or a node with refcount 1, is
+ * exclusively owned. The list only ever holds currently-shared buffers, so it
+ * stays short, and shared_metadata_count lets the unshared common case skip
+ * the lock entirely.
+ */
+typedef struct shared_metadata_node {
+    const camera_metadata_t *metadata;
+    size_t refcount;
+    struct shared_metadata_node *next;
+} shared_metadata_node_t;
+
+static pthread_mutex_t shared_metadata_lock = PTHREAD_MUTEX_INITIALIZER;
+static shared_metadata_node_t *shared_metadata_list = NULL;
+static atomic_size_t shared_metadata_count = 0;
+
+static shared_metadata_node_t **find_shared_metadata_locked(
+        const camera_metadata_t *metadata) {
+    shared_metadata_node_t **node = &shared_metadata_list;
+    while (*node != NULL && (*node)->metadata != metadata) {
+        node = &(*node)->next;
+    }
+    return node;
+}
+
+int is_camera_metadata_shared(const camera_metadata_t *metadata) {
+    if (metadata == NULL) return 0;
+    if (atomic_load_explicit(&shared_metadata_count, memory_order_acquire) == 0) {
+        return 0;
+    }
+    pthread_mutex_lock(&shared_metadata_lock);
+    shared_metadata_node_t *node = *find_shared_metadata_locked(metadata);
+    int shared = (node != NULL && node->refcount > 1);
+    pthread_mutex_unlock(&shared_metadata_lock);
+    return shared;
+}
+
+camera_metadata_t *acquire_camera_metadata(camera_metadata_t *metadata) {
+    if (metadata == NULL) return NULL;
+
+    pthread_mutex_lock(&shared_metadata_lock);
+    shared_metadata_node_t *node = *find_shared_metadata_locked(metadata);
+    if (node == NULL) {
+        node = (shared_metadata_node_t*)malloc(sizeof(shared_metadata_node_t));
+        if (node == NULL) {
+            pthread_mutex_unlock(&shared_metadata_lock);
+            ALOGE("%s: Cannot allocate reference node", __FUNCTION__);
+            return NULL;
+        }
+        node->metadata = metadata;
+        node->refcount = 1; // the caller's existing reference
+        node->next = shared_metadata_list;
+        shared_metadata_list = node;
+        atomic_fetch_add_explicit(&shared_metadata_count, 1,
+                memory_order_release);
+    }
+    node->refcount++;
+    pthread_mutex_unlock(&shared_metadata_lock);
+    return metadata;
+}
+
+camera_metadata_t *unshare_camera_metadata(camera_metadata_t *metadata) {
+    if (metadata == NULL) return NULL;
+
+    if (!is_camera_metadata_shared(metadata)) {
+        // Exclusively owned already; drop a stale single-reference node if the
+        // other references have since been released.
+        if (atomic_load_explicit(&shared_metadata_count,
+                memory_order_acquire) != 0) {
+            pthread_mutex_lock(&shared_metadata_lock);
+            shared_metadata_node_t **node = find_shared_metadata_locked(metadata);
+            if (*node != NULL && (*node)->refcount == 1) {
+                shared_metadata_node_t *stale = *node;
+                *node = stale->next;
+                free(stale);
+                atomic_fetch_sub_explicit(&shared_metadata_count, 1,
+                        memory_order_release);
+            }
+            pthread_mutex_unlock(&shared_metadata_lock);
+        }
+        return metadata;
+    }
+
+    // Clone outside the lock; a concurrent release at worst makes this copy
+    // unnecessary, never incorrect.
+    camera_metadata_t *private = clone_camera_metadata(metadata);
+    if (private == NULL) return NULL;
+    free_camera_metadata(metadata);
+    return private;
+}
+
+const camera_metadata_t *pin_camera_metadata(camera_metadata_t *metadata) {
+    // A pin is a shared reference used read-only: the shared state makes
+    // every modifying call fail, which is exactly the stability the reader
+    // needs for in-place entry data access.
+    return acquire_camera_metadata(metadata);
+}
+
+void unpin_camera_metadata(const camera_metadata_t *metadata) {
+    free_camera_metadata((camera_metadata_t *)metadata);
+}
+
 void free_camera_metadata(camera_metadata_t *metadata) {
+    if (metadata != NULL &&
+            atomic_load_explicit(&shared_metadata_count,
+                    memory_order_acquire) != 0) {
+        pthread_mutex_lock(&shared_metadata_lock);
+        shared_metadata_node_t **node = find_shared_metadata_locked(metadata);
+        if (*node != NULL) {
+            if (--(*node)->refcount > 0) {
+                pthread_mutex_unlock(&shared_metadata_lock);
+                return;
+            }
+            shared_metadata_node_t *dead = *node;
+            *node = dead->next;
+            free(dead);
+            atomic_fetch_sub_explicit(&shared_metadata_count, 1,
+                    memory_order_release);
+        }
+        pthread_mutex_unlock(&shared_metadata_lock);
+    }
     free(metadata);
 }
 
@@ -356,7 +589,9 @@ camera_metadata_t* copy_camera_metadata(void *dst, size_t dst_size,
     camera_metadata_t *metadata =
         place_camera_metadata(dst, dst_size, src->entry_count, src->data_count);
 
-    metadata->flags = src->flags;
+    // Compaction changes the layout the seal stamp covers, so the copy is
+    // not sealed; re-seal it if needed.
+    metadata->flags = src->flags & ~FLAG_SEALED;
     metadata->entry_count = src->entry_count;
     metadata->data_count = src->data_count;
     metadata->vendor_id = src->vendor_id;
@@ -517,6 +752,61 @@ int validate_camera_metadata_structure(const camera_metadata_t *metadata,
     const metadata_size_t entry_count = header->entry_count;
     camera_metadata_buffer_entry_t *entries = get_entries(metadata);
 
+    /*
+     * Fast prescreen of the bulk checks.  The entries are a packed 16-byte
+     * stride array, so the range, size and bounds checks are accumulated
+     * branch-free into a single failure flag that the compiler can unroll
+     * and vectorize across entries.  Only the tag/type cross-check needs a
+     * per-entry table lookup and stays scalar.  On any failure we fall
+     * through to the per-entry walk below, which reports the first
+     * offending entry with the usual diagnostics.
+     */
+    if (alignmentOffset == 0 &&
+            header->entries_start % ENTRY_ALIGNMENT == 0) {
+        const uint64_t size_limit = (uint64_t)(SIZE_MAX - DATA_ALIGNMENT + 1);
+        const uint32_t data_start = header->data_start;
+        const uint32_t data_capacity = header->data_capacity;
+        uint64_t bad = 0;
+
+        for (size_t i = 0; i < entry_count; ++i) {
+            const camera_metadata_buffer_entry_t *e = &entries[i];
+            const uint32_t type = e->type;
+            const uint64_t type_size =
+                    camera_metadata_type_size[type < NUM_TYPES ? type : 0];
+            const uint64_t data_bytes = (uint64_t)e->count * type_size;
+            const uint64_t data_size = data_bytes <= 4 ? 0 :
+                    ((data_bytes + DATA_ALIGNMENT - 1) &
+                            ~((uint64_t)DATA_ALIGNMENT - 1));
+
+            bad |= (uint64_t)(type >= NUM_TYPES);
+            bad |= (uint64_t)(data_bytes > size_limit);
+            bad |= (uint64_t)(data_size != 0) &
+                    ((uint64_t)(((data_start + e->data.offset) &
+                            (DATA_ALIGNMENT - 1)) != 0) |
+                     (uint64_t)((uint64_t)e->data.offset + data_size >
+                            data_capacity));
+            bad |= (uint64_t)(data_size == 0) & (uint64_t)(e->count == 0) &
+                    (uint64_t)(e->data.offset != 0);
+        }
+
+        if (bad == 0) {
+            for (size_t i = 0; i < entry_count; ++i) {
+                const camera_metadata_buffer_entry_t *e = &entries[i];
+
+                // TODO: fix vendor_tag_ops across processes so we don't need
+                //       to special case vendor-specific tags
+                uint32_t tag_section = e->tag >> 16;
+                int tag_type = get_local_camera_metadata_tag_type(e->tag, header);
+                if (tag_type != (int)e->type && tag_section < VENDOR_SECTION) {
+                    ALOGE("%s: Entry index %zu had tag type %d, but the type was %d",
+                          __FUNCTION__, i, tag_type, e->type);
+                    return CAMERA_METADATA_VALIDATION_ERROR;
+                }
+            }
+            return OK;
+        }
+    }
+
     for (size_t i = 0; i < entry_count; ++i) {
 
         if ((uintptr_t)&entries[i] + alignmentOffset !=
@@ -599,9 +889,61 @@ int validate_camera_metadata_structure(const camera_metadata_t *metadata,
     return CAMERA_METADATA_VALIDATION_SHIFTED;
 }
 
+int seal_camera_metadata(camera_metadata_t *metadata) {
+    if (metadata == NULL) {
+        return CAMERA_METADATA_VALIDATION_ERROR;
+    }
+    int res = validate_camera_metadata_structure(metadata, NULL);
+    if (res != OK) {
+        // Shifted buffers are not sealable; the stamp covers the layout at
+        // the buffer's own alignment.
+        return res;
+    }
+    metadata->seal = camera_metadata_seal_hash(metadata);
+    metadata->flags |= FLAG_SEALED;
+    return OK;
+}
+
+int validate_sealed_camera_metadata(const camera_metadata_t *metadata,
+                                    const size_t *expected_size) {
+    if (metadata == NULL) {
+        ALOGE("%s: metadata is null!", __FUNCTION__);
+        return CAMERA_METADATA_VALIDATION_ERROR;
+    }
+
+    // The fast path reads the header in place, so it requires a well-aligned
+    // buffer; unaligned or unsealed buffers take the full structural walk.
+    if ((uintptr_t)metadata !=
+                ALIGN_TO(metadata, METADATA_PACKET_ALIGNMENT) ||
+            (expected_size != NULL &&
+                sizeof(camera_metadata_t) > *expected_size)) {
+        return validate_camera_metadata_structure(metadata, expected_size);
+    }
+    if (!(metadata->flags & FLAG_SEALED)) {
+        return validate_camera_metadata_structure(metadata, expected_size);
+    }
+
+    if (expected_size != NULL && metadata->size > *expected_size) {
+        ALOGE("%s: Metadata size (%" PRIu32 ") should be <= expected size (%zu)",
+                __FUNCTION__, metadata->size, *expected_size);
+        return CAMERA_METADATA_VALIDATION_ERROR;
+    }
+    if (metadata->seal != camera_metadata_seal_hash(metadata)) {
+        ALOGE("%s: Seal stamp mismatch; metadata modified or corrupted "
+                "after sealing", __FUNCTION__);
+        return CAMERA_METADATA_VALIDATION_ERROR;
+    }
+    return OK;
+}
+
 int append_camera_metadata(camera_metadata_t *dst,
         const camera_metadata_t *src) {
     if (dst == NULL || src == NULL ) return ERROR;
+    if (is_camera_metadata_shared(dst)) {
+        ALOGE("%s: Cannot modify a shared metadata buffer; unshare it first",
+                __FUNCTION__);
+        return ERROR;
+    }
 
     // Check for overflow
     if (src->entry_count + dst->entry_count < src->entry_count) return ERROR;
@@ -619,6 +961,7 @@ int append_camera_metadata(camera_metadata_t *dst,
         }
     }
 
+    clear_camera_metadata_seal(dst);
     memcpy(get_entries(dst) + dst->entry_count, get_entries(src),
             sizeof(camera_metadata_buffer_entry_t[src->entry_count]));
     memcpy(get_data(dst) + dst->data_count, get_data(src),
@@ -669,6 +1012,430 @@ camera_metadata_t *clone_camera_metadata(const camera_metadata_t *src) {
     return clone;
 }
 
+static int add_camera_metadata_entry_raw(camera_metadata_t *dst,
+        uint32_t tag,
+        uint8_t  type,
+        const void *data,
+        size_t data_count);
+
+/**
+ * Patch blob layout: this fixed header, an array of deleted tags, and an
+ * embedded compact camera_metadata packet holding the changed and added
+ * entries. changed_start is aligned to METADATA_PACKET_ALIGNMENT so the
+ * embedded packet is directly usable when the blob itself is well-aligned.
+ */
+struct camera_metadata_patch {
+    uint32_t size;             // Total patch size in bytes
+    uint32_t version;          // CURRENT_METADATA_VERSION
+    uint32_t base_entry_count; // Binds the patch to its base packet
+    uint32_t base_data_count;
+    uint32_t deleted_count;    // Number of tags deleted from base
+    uint32_t deleted_start;    // Offset from patch to uint32_t[deleted_count]
+    uint32_t changed_start;    // Offset from patch to the embedded packet
+    uint32_t base_hash;        // Content hash binding the patch to its base
+};
+
+/**
+ * FNV-1a over every entry's tag, type, count and payload, in entry order.
+ * Binds a patch to the exact base content it was diffed against; consecutive
+ * frames share their tag layout, so structural counts alone cannot tell
+ * frame N's base from frame N+1's.
+ */
+static uint32_t camera_metadata_content_hash(const camera_metadata_t *metadata) {
+    uint32_t hash = 0x811c9dc5u; // FNV-1a offset basis
+    for (size_t i = 0; i < metadata->entry_count; i++) {
+        camera_metadata_ro_entry_t entry;
+        get_camera_metadata_ro_entry_unchecked(metadata, i, &entry);
+        const uint32_t fields[] = {
+            entry.tag, (uint32_t)entry.type, (uint32_t)entry.count,
+        };
+        hash = fnv1a_bytes(hash, fields, sizeof(fields));
+        hash = fnv1a_bytes(hash, entry.data.u8,
+                entry.count * camera_metadata_type_size[entry.type]);
+    }
+    return hash;
+}
+
+static int metadata_ro_entries_equal(const camera_metadata_ro_entry_t *a,
+        const camera_metadata_ro_entry_t *b) {
+    if (a->type != b->type || a->count != b->count) return 0;
+    return memcmp(a->data.u8, b->data.u8,
+            a->count * camera_metadata_type_size[a->type]) == 0;
+}
+
+static int patch_tag_deleted(const uint32_t *deleted, size_t deleted_count,
+        uint32_t tag) {
+    for (size_t i = 0; i < deleted_count; i++) {
+        if (deleted[i] == tag) return 1;
+    }
+    return 0;
+}
+
+camera_metadata_patch_t *diff_camera_metadata(const camera_metadata_t *base,
+        const camera_metadata_t *updated) {
+    if (base == NULL || updated == NULL) return NULL;
+
+    // First pass: count the changed/added entries with their data, and the
+    // deletions, to size the patch.
+    size_t changed_entries = 0;
+    size_t changed_data = 0;
+    size_t deleted_count = 0;
+    for (size_t i = 0; i < updated->entry_count; i++) {
+        camera_metadata_ro_entry_t new_entry, base_entry;
+        get_camera_metadata_ro_entry_unchecked(updated, i, &new_entry);
+        if (find_camera_metadata_ro_entry(base, new_entry.tag,
+                        &base_entry) != OK ||
+                !metadata_ro_entries_equal(&base_entry, &new_entry)) {
+            changed_entries++;
+            changed_data += calculate_camera_metadata_entry_data_size(
+                    new_entry.type, new_entry.count);
+        }
+    }
+    for (size_t i = 0; i < base->entry_count; i++) {
+        camera_metadata_ro_entry_t base_entry, new_entry;
+        get_camera_metadata_ro_entry_unchecked(base, i, &base_entry);
+        if (find_camera_metadata_ro_entry(updated, base_entry.tag,
+                &new_entry) != OK) {
+            deleted_count++;
+        }
+    }
+
+    const size_t changed_size =
+            calculate_camera_metadata_size(changed_entries, changed_data);
+    const size_t deleted_start = sizeof(camera_metadata_patch_t);
+    const size_t changed_start = ALIGN_TO(
+            deleted_start + deleted_count * sizeof(uint32_t),
+            METADATA_PACKET_ALIGNMENT);
+    const size_t patch_size = changed_start + changed_size;
+
+    camera_metadata_patch_t *patch =
+            (camera_metadata_patch_t*)calloc(1, patch_size);
+    if (patch == NULL) return NULL;
+    patch->size = patch_size;
+    patch->version = CURRENT_METADATA_VERSION;
+    patch->base_entry_count = base->entry_count;
+    patch->base_data_count = base->data_count;
+    patch->deleted_count = deleted_count;
+    patch->deleted_start = deleted_start;
+    patch->changed_start = changed_start;
+    patch->base_hash = camera_metadata_content_hash(base);
+
+    uint32_t *deleted = (uint32_t*)((uint8_t*)patch + deleted_start);
+    size_t next_deleted = 0;
+    for (size_t i = 0; i < base->entry_count; i++) {
+        camera_metadata_ro_entry_t base_entry, new_entry;
+        get_camera_metadata_ro_entry_unchecked(base, i, &base_entry);
+        if (find_camera_metadata_ro_entry(updated, base_entry.tag,
+                &new_entry) != OK) {
+            deleted[next_deleted++] = base_entry.tag;
+        }
+    }
+
+    camera_metadata_t *changed = place_camera_metadata(
+            (uint8_t*)patch + changed_start, changed_size,
+            changed_entries, changed_data);
+    if (changed == NULL) {
+        free(patch);
+        return NULL;
+    }
+    changed->vendor_id = updated->vendor_id;
+    for (size_t i = 0; i < updated->entry_count; i++) {
+        camera_metadata_ro_entry_t new_entry, base_entry;
+        get_camera_metadata_ro_entry_unchecked(updated, i, &new_entry);
+        if (find_camera_metadata_ro_entry(base, new_entry.tag,
+                        &base_entry) != OK ||
+                !metadata_ro_entries_equal(&base_entry, &new_entry)) {
+            if (add_camera_metadata_entry_raw(changed, new_entry.tag,
+                    new_entry.type, new_entry.data.u8, new_entry.count) != OK) {
+                free(patch);
+                return NULL;
+            }
+        }
+    }
+
+    return patch;
+}
+
+size_t get_camera_metadata_patch_size(const camera_metadata_patch_t *patch) {
+    if (patch == NULL) return 0;
+    return patch->size;
+}
+
+camera_metadata_t *apply_camera_metadata_patch(const camera_metadata_t *base,
+        const camera_metadata_patch_t *patch) {
+    if (base == NULL || patch == NULL) return NULL;
+
+    // Validate the patch internals before using them; the blob may have
+    // crossed a process boundary.
+    if (patch->version != CURRENT_METADATA_VERSION) {
+        ALOGE("%s: Unknown patch version %" PRIu32, __FUNCTION__,
+                patch->version);
+        return NULL;
+    }
+    const size_t deleted_end = (size_t)patch->deleted_start +
+            (size_t)patch->deleted_count * sizeof(uint32_t);
+    if (patch->deleted_start < sizeof(camera_metadata_patch_t) ||
+            deleted_end > patch->size ||
+            patch->changed_start < deleted_end ||
+            patch->changed_start > patch->size ||
+            patch->changed_start !=
+                ALIGN_TO(patch->changed_start, METADATA_PACKET_ALIGNMENT)) {
+        ALOGE("%s: Corrupt patch layout", __FUNCTION__);
+        return NULL;
+    }
+    const camera_metadata_t *changed = (const camera_metadata_t*)
+            ((const uint8_t*)patch + patch->changed_start);
+    size_t changed_region = patch->size - patch->changed_start;
+    if (validate_camera_metadata_structure(changed, &changed_region) != OK) {
+        return NULL;
+    }
+    if (base->entry_count != patch->base_entry_count ||
+            base->data_count != patch->base_data_count ||
+            camera_metadata_content_hash(base) != patch->base_hash) {
+        ALOGE("%s: Patch was diffed against a different base packet "
+                "(entries %" PRIu32 "/%" PRIu32 ", data %" PRIu32 "/%" PRIu32
+                ")", __FUNCTION__, base->entry_count, patch->base_entry_count,
+                base->data_count, patch->base_data_count);
+        return NULL;
+    }
+    const uint32_t *deleted =
+            (const uint32_t*)((const uint8_t*)patch + patch->deleted_start);
+
+    // Size the result: surviving base entries (replaced ones at their patch
+    // size), plus patch entries not present in base.
+    size_t result_entries = 0;
+    size_t result_data = 0;
+    for (size_t i = 0; i < base->entry_count; i++) {
+        camera_metadata_ro_entry_t entry;
+        get_camera_metadata_ro_entry_unchecked(base, i, &entry);
+        if (patch_tag_deleted(deleted, patch->deleted_count, entry.tag)) {
+            continue;
+        }
+        camera_metadata_ro_entry_t replacement;
+        if (find_camera_metadata_ro_entry(changed, entry.tag,
+                &replacement) == OK) {
+            entry = replacement;
+        }
+        result_entries++;
+        result_data += calculate_camera_metadata_entry_data_size(
+                entry.type, entry.count);
+    }
+    for (size_t i = 0; i < changed->entry_count; i++) {
+        camera_metadata_ro_entry_t entry, base_entry;
+        get_camera_metadata_ro_entry_unchecked(changed, i, &entry);
+        if (find_camera_metadata_ro_entry(base, entry.tag, &base_entry) != OK) {
+            result_entries++;
+            result_data += calculate_camera_metadata_entry_data_size(
+                    entry.type, entry.count);
+        }
+    }
+
+    camera_metadata_t *result =
+            allocate_camera_metadata(result_entries, result_data);
+    if (result == NULL) return NULL;
+    result->vendor_id = changed->vendor_id != CAMERA_METADATA_INVALID_VENDOR_ID
+            ? changed->vendor_id : base->vendor_id;
+
+    // Surviving base entries in base order, replacements taken from the
+    // patch, then the added entries in patch order.
+    for (size_t i = 0; i < base->entry_count; i++) {
+        camera_metadata_ro_entry_t entry;
+        get_camera_metadata_ro_entry_unchecked(base, i, &entry);
+        if (patch_tag_deleted(deleted, patch->deleted_count, entry.tag)) {
+            continue;
+        }
+        camera_metadata_ro_entry_t replacement;
+        if (find_camera_metadata_ro_entry(changed, entry.tag,
+                &replacement) == OK) {
+            entry = replacement;
+        }
+        if (add_camera_metadata_entry_raw(result, entry.tag, entry.type,
+                entry.data.u8, entry.count) != OK) {
+            free_camera_metadata(result);
+            return NULL;
+        }
+    }
+    for (size_t i = 0; i < changed->entry_count; i++) {
+        camera_metadata_ro_entry_t entry, base_entry;
+        get_camera_metadata_ro_entry_unchecked(changed, i, &entry);
+        if (find_camera_metadata_ro_entry(base, entry.tag, &base_entry) != OK) {
+            if (add_camera_metadata_entry_raw(result, entry.tag, entry.type,
+                    entry.data.u8, entry.count) != OK) {
+                free_camera_metadata(result);
+                return NULL;
+            }
+        }
+    }
+
+    assert(validate_camera_metadata_structure(result, NULL) == OK);
+    return result;
+}
+
+void free_camera_metadata_patch(camera_metadata_patch_t *patch) {
+    free(patch);
+}
+
+/**
+ * Builder internals: entry descriptors and payload bytes accumulate in
+ * singly-linked chunks that are never reallocated, so staged payload
+ * pointers stay valid as the builder grows and building N entries costs N
+ * copies regardless of how the sizes turn out.
+ */
+#define BUILDER_DATA_CHUNK_SIZE 4096
+#define BUILDER_ENTRIES_PER_CHUNK 64
+
+typedef struct builder_data_chunk {
+    struct builder_data_chunk *next;
+    size_t used;
+    size_t capacity;
+    uint8_t bytes[];
+} builder_data_chunk_t;
+
+typedef struct builder_entry {
+    uint32_t tag;
+    uint32_t count;
+    uint8_t  type;
+    const uint8_t *payload; // Into a data chunk; NULL when count == 0
+} builder_entry_t;
+
+typedef struct builder_entry_chunk {
+    struct builder_entry_chunk *next;
+    size_t used;
+    builder_entry_t entries[BUILDER_ENTRIES_PER_CHUNK];
+} builder_entry_chunk_t;
+
+struct camera_metadata_builder {
+    builder_entry_chunk_t *entries_head;
+    builder_entry_chunk_t *entries_tail;
+    builder_data_chunk_t *data_head;
+    builder_data_chunk_t *data_tail;
+    size_t entry_count;
+    size_t data_count; // Extra data bytes the final packet will need
+};
+
+camera_metadata_builder_t *allocate_camera_metadata_builder(void) {
+    return (camera_metadata_builder_t*)calloc(1,
+            sizeof(camera_metadata_builder_t));
+}
+
+static uint8_t *builder_reserve_data(camera_metadata_builder_t *builder,
+        size_t bytes) {
+    builder_data_chunk_t *chunk = builder->data_tail;
+    if (chunk == NULL || chunk->capacity - chunk->used < bytes) {
+        size_t capacity = bytes > BUILDER_DATA_CHUNK_SIZE
+                ? bytes : BUILDER_DATA_CHUNK_SIZE;
+        chunk = (builder_data_chunk_t*)malloc(
+                sizeof(builder_data_chunk_t) + capacity);
+        if (chunk == NULL) return NULL;
+        chunk->next = NULL;
+        chunk->used = 0;
+        chunk->capacity = capacity;
+        if (builder->data_tail != NULL) {
+            builder->data_tail->next = chunk;
+        } else {
+            builder->data_head = chunk;
+        }
+        builder->data_tail = chunk;
+    }
+    uint8_t *payload = chunk->bytes + chunk->used;
+    chunk->used += bytes;
+    return payload;
+}
+
+int add_camera_metadata_builder_entry(camera_metadata_builder_t *builder,
+        uint32_t tag,
+        const void *data,
+        size_t data_count) {
+    if (builder == NULL) return ERROR;
+    int type = get_camera_metadata_tag_type(tag);
+    if (type == -1) {
+        ALOGE("%s: Unknown tag %04x.", __FUNCTION__, tag);
+        return ERROR;
+    }
+    if (data_count && data == NULL) return ERROR;
+    if (validate_and_calculate_camera_metadata_entry_data_size(NULL,
+            type, data_count) != OK) {
+        return ERROR;
+    }
+
+    builder_entry_chunk_t *entries = builder->entries_tail;
+    if (entries == NULL || entries->used == BUILDER_ENTRIES_PER_CHUNK) {
+        entries = (builder_entry_chunk_t*)calloc(1,
+                sizeof(builder_entry_chunk_t));
+        if (entries == NULL) return ERROR;
+        if (builder->entries_tail != NULL) {
+            builder->entries_tail->next = entries;
+        } else {
+            builder->entries_head = entries;
+        }
+        builder->entries_tail = entries;
+    }
+
+    const size_t payload_bytes = data_count * camera_metadata_type_size[type];
+    uint8_t *payload = NULL;
+    if (payload_bytes != 0) {
+        payload = builder_reserve_data(builder, payload_bytes);
+        if (payload == NULL) return ERROR;
+        memcpy(payload, data, payload_bytes);
+    }
+
+    builder_entry_t *entry = &entries->entries[entries->used++];
+    entry->tag = tag;
+    entry->count = data_count;
+    entry->type = type;
+    entry->payload = payload;
+    builder->entry_count++;
+    builder->data_count +=
+            calculate_camera_metadata_entry_data_size(type, data_count);
+    return OK;
+}
+
+void free_camera_metadata_builder(camera_metadata_builder_t *builder) {
+    if (builder == NULL) return;
+    builder_entry_chunk_t *entries = builder->entries_head;
+    while (entries != NULL) {
+        builder_entry_chunk_t *next = entries->next;
+        free(entries);
+        entries = next;
+    }
+    builder_data_chunk_t *data = builder->data_head;
+    while (data != NULL) {
+        builder_data_chunk_t *next = data->next;
+        free(data);
+        data = next;
+    }
+    free(builder);
+}
+
+camera_metadata_t *finish_camera_metadata_builder(
+        camera_metadata_builder_t *builder) {
+    if (builder == NULL) return NULL;
+
+    camera_metadata_t *metadata = allocate_camera_metadata(
+            builder->entry_count, builder->data_count);
+    if (metadata != NULL) {
+        for (const builder_entry_chunk_t *entries = builder->entries_head;
+                entries != NULL; entries = entries->next) {
+            for (size_t i = 0; i < entries->used; i++) {
+                const builder_entry_t *entry = &entries->entries[i];
+                if (add_camera_metadata_entry_raw(metadata, entry->tag,
+                        entry->type, entry->payload, entry->count) != OK) {
+                    // Cannot happen: the packet was sized for these entries
+                    free_camera_metadata(metadata);
+                    metadata = NULL;
+                    break;
+                }
+            }
+            if (metadata == NULL) break;
+        }
+    }
+    free_camera_metadata_builder(builder);
+
+    assert(metadata == NULL ||
+            validate_camera_metadata_structure(metadata, NULL) == OK);
+    return metadata;
+}
+
 static int add_camera_metadata_entry_raw(camera_metadata_t *dst,
         uint32_t tag,
         uint8_t  type,
@@ -676,6 +1443,11 @@ static int add_camera_metadata_entry_raw(camera_metadata_t *dst,
         size_t data_count) {
 
     if (dst == NULL) return ERROR;
+    if (is_camera_metadata_shared(dst)) {
+        ALOGE("%s: Cannot modify a shared metadata buffer; unshare it first",
+                __FUNCTION__);
+        return ERROR;
+    }
     if (dst->entry_count == dst->entry_capacity) return ERROR;
     if (data_count && data == NULL) return ERROR;
 
@@ -683,6 +1455,7 @@ static int add_camera_metadata_entry_raw(camera_metadata_t *dst,
             calculate_camera_metadata_entry_data_size(type, data_count);
     if (data_bytes + dst->data_count > dst->data_capacity) return ERROR;
 
+    clear_camera_metadata_seal(dst);
     size_t data_payload_bytes =
             data_count * camera_metadata_type_size[type];
     camera_metadata_buffer_entry_t *entry = get_entries(dst) + dst->entry_count;
@@ -701,7 +1474,16 @@ static int add_camera_metadata_entry_raw(camera_metadata_t *dst,
         dst->data_count += data_bytes;
     }
     dst->entry_count++;
-    dst->flags &= ~FLAG_SORTED;
+    // Appending a tag >= the previous last tag keeps the buffer sorted, so the
+    // common pattern of adding entries in tag order never needs a re-sort for
+    // binary search in find_camera_metadata_entry().
+    if ((dst->flags & FLAG_SORTED) && dst->entry_count > 1 &&
+            (entry - 1)->tag > tag) {
+        dst->flags &= ~FLAG_SORTED;
+    } else if (dst->entry_count == 1) {
+        // A single entry is trivially sorted
+        dst->flags |= FLAG_SORTED;
+    }
     assert(validate_camera_metadata_structure(dst, NULL) == OK);
     return OK;
 }
@@ -724,6 +1506,40 @@ int add_camera_metadata_entry(camera_metadata_t *dst,
             data_count);
 }
 
+int add_sorted_camera_metadata_entry(camera_metadata_t *dst,
+        uint32_t tag,
+        const void *data,
+        size_t data_count) {
+
+    if (dst == NULL) return ERROR;
+
+    // On an unsorted buffer there is no order to maintain
+    if (!(dst->flags & FLAG_SORTED)) {
+        return add_camera_metadata_entry(dst, tag, data, data_count);
+    }
+
+    size_t old_count = dst->entry_count;
+    int res = add_camera_metadata_entry(dst, tag, data, data_count);
+    if (res != OK) return res;
+
+    // If the appended tag broke the order, rotate it into its sorted position.
+    // Only the entry descriptors move; data offsets are position independent.
+    if (!(dst->flags & FLAG_SORTED)) {
+        camera_metadata_buffer_entry_t *entries = get_entries(dst);
+        camera_metadata_buffer_entry_t added = entries[old_count];
+        size_t index = 0;
+        while (index < old_count && entries[index].tag <= tag) {
+            index++;
+        }
+        memmove(entries + index + 1, entries + index,
+                (old_count - index) * sizeof(camera_metadata_buffer_entry_t));
+        entries[index] = added;
+        dst->flags |= FLAG_SORTED;
+        assert(validate_camera_metadata_structure(dst, NULL) == OK);
+    }
+    return OK;
+}
+
 static int compare_entry_tags(const void *p1, const void *p2) {
     uint32_t tag1 = ((camera_metadata_buffer_entry_t*)p1)->tag;
     uint32_t tag2 = ((camera_metadata_buffer_entry_t*)p2)->tag;
@@ -734,11 +1550,47 @@ static int compare_entry_tags(const void *p1, const void *p2) {
 
 int sort_camera_metadata(camera_metadata_t *dst) {
     if (dst == NULL) return ERROR;
+    if (is_camera_metadata_shared(dst)) {
+        ALOGE("%s: Cannot modify a shared metadata buffer; unshare it first",
+                __FUNCTION__);
+        return ERROR;
+    }
     if (dst->flags & FLAG_SORTED) return OK;
 
-    qsort(get_entries(dst), dst->entry_count,
-            sizeof(camera_metadata_buffer_entry_t),
-            compare_entry_tags);
+    clear_camera_metadata_seal(dst);
+    camera_metadata_buffer_entry_t *entries = get_entries(dst);
+    const size_t entry_count = dst->entry_count;
+    // Request builders typically append a handful of entries to an already
+    // sorted template, so find the sorted prefix first instead of paying a
+    // full qsort for a short unsorted tail.
+    size_t sorted = entry_count > 0 ? 1 : 0;
+    while (sorted < entry_count && entries[sorted - 1].tag <= entries[sorted].tag) {
+        sorted++;
+    }
+    if (entry_count - sorted <= 16) {
+        // Binary-insert each tail entry into the sorted prefix.  Only the
+        // entry descriptors move; data offsets are position independent.
+        for (; sorted < entry_count; sorted++) {
+            camera_metadata_buffer_entry_t added = entries[sorted];
+            size_t lo = 0;
+            size_t hi = sorted;
+            while (lo < hi) {
+                size_t mid = lo + (hi - lo) / 2;
+                if (entries[mid].tag <= added.tag) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
+            }
+            memmove(entries + lo + 1, entries + lo,
+                    (sorted - lo) * sizeof(camera_metadata_buffer_entry_t));
+            entries[lo] = added;
+        }
+    } else {
+        qsort(entries, entry_count,
+                sizeof(camera_metadata_buffer_entry_t),
+                compare_entry_tags);
+    }
     dst->flags |= FLAG_SORTED;
 
     assert(validate_camera_metadata_structure(dst, NULL) == OK);
@@ -773,6 +1625,49 @@ int get_camera_metadata_ro_entry(const camera_metadata_t *src,
             (camera_metadata_entry_t*)entry);
 }
 
+void get_camera_metadata_ro_entry_unchecked(const camera_metadata_t *src,
+        size_t index,
+        camera_metadata_ro_entry_t *entry) {
+    const camera_metadata_buffer_entry_t *buffer_entry =
+            get_entries(src) + index;
+
+    entry->index = index;
+    entry->tag = buffer_entry->tag;
+    entry->type = buffer_entry->type;
+    entry->count = buffer_entry->count;
+    if (buffer_entry->count *
+            camera_metadata_type_size[buffer_entry->type] > 4) {
+        entry->data.u8 = get_data(src) + buffer_entry->data.offset;
+    } else {
+        entry->data.u8 = buffer_entry->data.value;
+    }
+}
+
+int get_camera_metadata_external_blob(const camera_metadata_ro_entry_t *entry,
+        size_t index,
+        camera_metadata_external_blob_t *blob) {
+    if (entry == NULL || blob == NULL) return ERROR;
+    if (entry->type != TYPE_EXTERNAL) {
+        ALOGE("%s: Entry for tag %04x has type %d, not TYPE_EXTERNAL",
+                __FUNCTION__, entry->tag, entry->type);
+        return ERROR;
+    }
+    if (index >= entry->count) return ERROR;
+
+    // The buffer may have crossed a process boundary, so the descriptor
+    // bytes are untrusted until checked here.
+    const camera_metadata_external_blob_t *src = &entry->data.eb[index];
+    if (src->fd < 0 || src->reserved != 0 || src->size == 0 ||
+            src->offset + src->size < src->offset) {
+        ALOGE("%s: Malformed external blob for tag %04x: fd %d, offset %"
+                PRIu64 ", size %" PRIu64, __FUNCTION__, entry->tag,
+                src->fd, src->offset, src->size);
+        return ERROR;
+    }
+    *blob = *src;
+    return OK;
+}
+
 int find_camera_metadata_entry(camera_metadata_t *src,
         uint32_t tag,
         camera_metadata_entry_t *entry) {
@@ -813,12 +1708,49 @@ int find_camera_metadata_ro_entry(const camera_metadata_t *src,
             (camera_metadata_entry_t*)entry);
 }
 
+int find_camera_metadata_ro_entry_unchecked(const camera_metadata_t *src,
+        uint32_t tag,
+        camera_metadata_ro_entry_t *entry) {
+    uint32_t index;
+    if (src->flags & FLAG_SORTED) {
+        // Sorted entries, do a binary search
+        camera_metadata_buffer_entry_t *search_entry = NULL;
+        camera_metadata_buffer_entry_t key;
+        key.tag = tag;
+        search_entry = bsearch(&key,
+                get_entries(src),
+                src->entry_count,
+                sizeof(camera_metadata_buffer_entry_t),
+                compare_entry_tags);
+        if (search_entry == NULL) return NOT_FOUND;
+        index = search_entry - get_entries(src);
+    } else {
+        // Not sorted, linear search
+        camera_metadata_buffer_entry_t *search_entry = get_entries(src);
+        for (index = 0; index < src->entry_count; index++, search_entry++) {
+            if (search_entry->tag == tag) {
+                break;
+            }
+        }
+        if (index == src->entry_count) return NOT_FOUND;
+    }
+
+    get_camera_metadata_ro_entry_unchecked(src, index, entry);
+    return OK;
+}
+
 
 int delete_camera_metadata_entry(camera_metadata_t *dst,
         size_t index) {
     if (dst == NULL) return ERROR;
+    if (is_camera_metadata_shared(dst)) {
+        ALOGE("%s: Cannot modify a shared metadata buffer; unshare it first",
+                __FUNCTION__);
+        return ERROR;
+    }
     if (index >= dst->entry_count) return ERROR;
 
+    clear_camera_metadata_seal(dst);
     camera_metadata_buffer_entry_t *entry = get_entries(dst) + index;
     size_t data_bytes = calculate_camera_metadata_entry_data_size(entry->type,
             entry->count);
@@ -859,8 +1791,14 @@ int update_camera_metadata_entry(camera_metadata_t *dst,
         size_t data_count,
         camera_metadata_entry_t *updated_entry) {
     if (dst == NULL) return ERROR;
+    if (is_camera_metadata_shared(dst)) {
+        ALOGE("%s: Cannot modify a shared metadata buffer; unshare it first",
+                __FUNCTION__);
+        return ERROR;
+    }
     if (index >= dst->entry_count) return ERROR;
 
+    clear_camera_metadata_seal(dst);
     camera_metadata_buffer_entry_t *entry = get_entries(dst) + index;
 
     size_t data_bytes =
@@ -929,9 +1867,264 @@ int update_camera_metadata_entry(camera_metadata_t *dst,
     return OK;
 }
 
+typedef struct staged_entry_update {
+    size_t index;
+    const void *data;
+    size_t data_count;
+} staged_entry_update_t;
+
+struct camera_metadata_update {
+    camera_metadata_t *metadata;
+    staged_entry_update_t *staged;
+    size_t staged_count;
+    size_t staged_capacity;
+};
+
+camera_metadata_update_t *begin_camera_metadata_update(camera_metadata_t *dst) {
+    if (dst == NULL) return NULL;
+    if (is_camera_metadata_shared(dst)) {
+        ALOGE("%s: Cannot modify a shared metadata buffer; unshare it first",
+                __FUNCTION__);
+        return NULL;
+    }
+    camera_metadata_update_t *update =
+            (camera_metadata_update_t*)calloc(1, sizeof(*update));
+    if (update == NULL) return NULL;
+    update->metadata = dst;
+    return update;
+}
+
+int stage_camera_metadata_update(camera_metadata_update_t *update,
+        size_t index,
+        const void *data,
+        size_t data_count) {
+    if (update == NULL) return ERROR;
+    if (index >= update->metadata->entry_count) return ERROR;
+    if (update->staged_count == update->staged_capacity) {
+        size_t new_capacity =
+                update->staged_capacity > 0 ? update->staged_capacity * 2 : 8;
+        staged_entry_update_t *staged = (staged_entry_update_t*)realloc(
+                update->staged, new_capacity * sizeof(*staged));
+        if (staged == NULL) return ERROR;
+        update->staged = staged;
+        update->staged_capacity = new_capacity;
+    }
+    update->staged[update->staged_count].index = index;
+    update->staged[update->staged_count].data = data;
+    update->staged[update->staged_count].data_count = data_count;
+    update->staged_count++;
+    return OK;
+}
+
+// Returns the staged update for an entry index, or NULL. The last staged
+// update for an index wins.
+static const staged_entry_update_t *find_staged_update(
+        const camera_metadata_update_t *update, size_t index) {
+    size_t i;
+    for (i = update->staged_count; i > 0; i--) {
+        if (update->staged[i - 1].index == index) {
+            return &update->staged[i - 1];
+        }
+    }
+    return NULL;
+}
+
+int commit_camera_metadata_update(camera_metadata_update_t *update) {
+    if (update == NULL) return ERROR;
+    camera_metadata_t *dst = update->metadata;
+    int res = ERROR;
+    uint8_t *scratch = NULL;
+    size_t i;
+
+    // Compute the final data section size; fail before modifying anything.
+    size_t new_data_count = 0;
+    for (i = 0; i < dst->entry_count; i++) {
+        camera_metadata_buffer_entry_t *entry = get_entries(dst) + i;
+        const staged_entry_update_t *staged = find_staged_update(update, i);
+        const size_t count = staged != NULL ? staged->data_count : entry->count;
+        new_data_count +=
+                calculate_camera_metadata_entry_data_size(entry->type, count);
+    }
+    if (new_data_count > dst->data_capacity) {
+        // No room
+        goto done;
+    }
+
+    scratch = (uint8_t*)malloc(dst->data_capacity);
+    if (dst->data_capacity > 0 && scratch == NULL) {
+        goto done;
+    }
+
+    // Single compaction pass: lay out every entry's (possibly updated) data
+    // contiguously in entry order, then install the new data section at once.
+    size_t offset = 0;
+    for (i = 0; i < dst->entry_count; i++) {
+        camera_metadata_buffer_entry_t *entry = get_entries(dst) + i;
+        const staged_entry_update_t *staged = find_staged_update(update, i);
+        const size_t count = staged != NULL ? staged->data_count : entry->count;
+        const size_t data_bytes =
+                calculate_camera_metadata_entry_data_size(entry->type, count);
+        const size_t data_payload_bytes =
+                count * camera_metadata_type_size[entry->type];
+        const void *src;
+        if (staged != NULL) {
+            src = staged->data;
+        } else if (data_bytes != 0) {
+            src = get_data(dst) + entry->data.offset;
+        } else {
+            src = entry->data.value; // already in place
+        }
+        if (data_bytes == 0) {
+            // Data fits into entry
+            if (staged != NULL) {
+                memcpy(entry->data.value, src, data_payload_bytes);
+            }
+        } else {
+            memcpy(scratch + offset, src, data_payload_bytes);
+            entry->data.offset = offset;
+            offset += data_bytes;
+        }
+        entry->count = count;
+    }
+    memcpy(get_data(dst), scratch, offset);
+    dst->data_count = offset;
+    clear_camera_metadata_seal(dst);
+    res = OK;
+
+    assert(validate_camera_metadata_structure(dst, NULL) == OK);
+done:
+    free(scratch);
+    free(update->staged);
+    free(update);
+    return res;
+}
+
+void abort_camera_metadata_update(camera_metadata_update_t *update) {
+    if (update == NULL) return;
+    free(update->staged);
+    free(update);
+}
+
 static const vendor_tag_ops_t *vendor_tag_ops = NULL;
 static const struct vendor_tag_cache_ops *vendor_cache_ops = NULL;
 
+/**
+ * Cache of the (immutable) vendor tag set, built once when the ops are
+ * registered and sorted by tag.  Vendor tag queries then bisect the cache
+ * instead of calling into vendor_tag_ops, whose implementations commonly
+ * scan their tag tables linearly per query.  The name pointers are owned by
+ * the vendor module and valid for its lifetime (see camera_vendor_tags.h).
+ */
+typedef struct vendor_tag_cache_entry {
+    uint32_t tag;
+    int type;
+    const char *section_name;
+    const char *tag_name;
+} vendor_tag_cache_entry_t;
+
+typedef struct vendor_tag_cache {
+    int count;
+    vendor_tag_cache_entry_t entries[];
+} vendor_tag_cache_t;
+
+/**
+ * Published with release/acquire semantics so that re-registering the vendor
+ * ops (e.g. on a HAL restart) cannot free a table a concurrent lookup is still
+ * bisecting.  A superseded table is intentionally leaked: re-registration is a
+ * once-per-process-lifetime event and readers may hold the old snapshot for an
+ * unbounded time.
+ */
+static _Atomic(vendor_tag_cache_t *) vendor_tag_cache = NULL;
+
+static int compare_vendor_tag_cache_entry(const void *a, const void *b) {
+    const uint32_t tag_a = ((const vendor_tag_cache_entry_t *)a)->tag;
+    const uint32_t tag_b = ((const vendor_tag_cache_entry_t *)b)->tag;
+    return tag_a < tag_b ? -1 : (tag_a > tag_b ? 1 : 0);
+}
+
+static void publish_vendor_tag_cache(vendor_tag_cache_t *cache) {
+    atomic_store_explicit(&vendor_tag_cache, cache, memory_order_release);
+}
+
+static void build_vendor_tag_cache(const vendor_tag_ops_t *ops) {
+    if (ops == NULL || ops->get_tag_count == NULL || ops->get_all_tags == NULL ||
+            ops->get_section_name == NULL || ops->get_tag_name == NULL ||
+            ops->get_tag_type == NULL) {
+        publish_vendor_tag_cache(NULL);
+        return;
+    }
+    int count = ops->get_tag_count(ops);
+    if (count <= 0) {
+        publish_vendor_tag_cache(NULL);
+        return;
+    }
+    vendor_tag_cache_t *cache = (vendor_tag_cache_t *)
+            malloc(sizeof(*cache) + count * sizeof(cache->entries[0]));
+    if (cache == NULL) {
+        publish_vendor_tag_cache(NULL);
+        return; // no cache; queries fall through to the ops
+    }
+    cache->count = count;
+    if (ops->get_all_tag_descriptors != NULL) {
+        // batched enumeration: one call instead of three per tag
+        vendor_tag_descriptor_v1_t *descriptors = (vendor_tag_descriptor_v1_t *)
+                malloc(count * sizeof(*descriptors));
+        if (descriptors != NULL &&
+                ops->get_all_tag_descriptors(ops, descriptors, count) == count) {
+            for (int i = 0; i < count; i++) {
+                cache->entries[i].tag = descriptors[i].tag;
+                cache->entries[i].type = descriptors[i].type;
+                cache->entries[i].section_name = descriptors[i].section_name;
+                cache->entries[i].tag_name = descriptors[i].tag_name;
+            }
+            free(descriptors);
+            qsort(cache->entries, count, sizeof(cache->entries[0]),
+                    compare_vendor_tag_cache_entry);
+            publish_vendor_tag_cache(cache);
+            return;
+        }
+        free(descriptors); // fall back to the per-tag queries
+    }
+    uint32_t *tags = (uint32_t *)malloc(count * sizeof(*tags));
+    if (tags == NULL) {
+        free(cache);
+        publish_vendor_tag_cache(NULL);
+        return;
+    }
+    ops->get_all_tags(ops, tags);
+    for (int i = 0; i < count; i++) {
+        cache->entries[i].tag = tags[i];
+        cache->entries[i].type = ops->get_tag_type(ops, tags[i]);
+        cache->entries[i].section_name = ops->get_section_name(ops, tags[i]);
+        cache->entries[i].tag_name = ops->get_tag_name(ops, tags[i]);
+    }
+    free(tags);
+    qsort(cache->entries, count, sizeof(cache->entries[0]),
+            compare_vendor_tag_cache_entry);
+    publish_vendor_tag_cache(cache);
+}
+
+static const vendor_tag_cache_entry_t *lookup_vendor_tag_cache(uint32_t tag) {
+    const vendor_tag_cache_t *cache =
+            atomic_load_explicit(&vendor_tag_cache, memory_order_acquire);
+    if (cache == NULL) {
+        return NULL;
+    }
+    int lo = 0;
+    int hi = cache->count - 1;
+    while (lo <= hi) {
+        const int mid = lo + (hi - lo) / 2;
+        if (cache->entries[mid].tag < tag) {
+            lo = mid + 1;
+        } else if (cache->entries[mid].tag > tag) {
+            hi = mid - 1;
+        } else {
+            return &cache->entries[mid];
+        }
+    }
+    return NULL;
+}
+
 // Declared in system/media/private/camera/include/camera_metadata_hidden.h
 const char *get_local_camera_metadata_section_name_vendor_id(uint32_t tag,
         metadata_vendor_id_t id) {
@@ -940,6 +2133,10 @@ const char *get_local_camera_metadata_section_name_vendor_id(uint32_t tag,
                id != CAMERA_METADATA_INVALID_VENDOR_ID) {
            return vendor_cache_ops->get_section_name(tag, id);
     } else if (tag_section >= VENDOR_SECTION && vendor_tag_ops != NULL) {
+        const vendor_tag_cache_entry_t *entry = lookup_vendor_tag_cache(tag);
+        if (entry != NULL) {
+            return entry->section_name;
+        }
         return vendor_tag_ops->get_section_name(
             vendor_tag_ops,
             tag);
@@ -958,6 +2155,10 @@ const char *get_local_camera_metadata_tag_name_vendor_id(uint32_t tag,
                 id != CAMERA_METADATA_INVALID_VENDOR_ID) {
             return vendor_cache_ops->get_tag_name(tag, id);
     } else  if (tag_section >= VENDOR_SECTION && vendor_tag_ops != NULL) {
+        const vendor_tag_cache_entry_t *entry = lookup_vendor_tag_cache(tag);
+        if (entry != NULL) {
+            return entry->tag_name;
+        }
         return vendor_tag_ops->get_tag_name(
             vendor_tag_ops,
             tag);
@@ -978,6 +2179,10 @@ int get_local_camera_metadata_tag_type_vendor_id(uint32_t tag,
                 id != CAMERA_METADATA_INVALID_VENDOR_ID) {
             return vendor_cache_ops->get_tag_type(tag, id);
     } else if (tag_section >= VENDOR_SECTION && vendor_tag_ops != NULL) {
+        const vendor_tag_cache_entry_t *entry = lookup_vendor_tag_cache(tag);
+        if (entry != NULL) {
+            return entry->type;
+        }
         return vendor_tag_ops->get_tag_type(
             vendor_tag_ops,
             tag);
@@ -1045,6 +2250,7 @@ int set_camera_metadata_vendor_tag_ops(const vendor_tag_query_ops_t* ops) {
 // Declared in system/media/private/camera/include/camera_metadata_hidden.h
 int set_camera_metadata_vendor_ops(const vendor_tag_ops_t* ops) {
     vendor_tag_ops = ops;
+    build_vendor_tag_cache(ops);
     return OK;
 }
 
@@ -1089,69 +2295,116 @@ void dump_indented_camera_metadata(const camera_metadata_t *metadata,
         int fd,
         int verbosity,
         int indentation) {
-    if (metadata == NULL) {
-        dprintf(fd, "%*sDumping camera metadata array: Not allocated\n",
-                indentation, "");
-        return;
+    camera_metadata_dump_state_t state;
+    dump_camera_metadata_begin(metadata, verbosity, indentation, &state);
+    while (dump_camera_metadata_next(&state, fd, SIZE_MAX, NULL, NULL) > 0) {
     }
-    unsigned int i;
-    dprintf(fd,
-            "%*sDumping camera metadata array: %" PRIu32 " / %" PRIu32 " entries, "
-            "%" PRIu32 " / %" PRIu32 " bytes of extra data.\n", indentation, "",
-            metadata->entry_count, metadata->entry_capacity,
-            metadata->data_count, metadata->data_capacity);
-    dprintf(fd, "%*sVersion: %d, Flags: %08x\n",
-            indentation + 2, "",
-            metadata->version, metadata->flags);
-    camera_metadata_buffer_entry_t *entry = get_entries(metadata);
-    for (i=0; i < metadata->entry_count; i++, entry++) {
-
-        const char *tag_name, *tag_section;
-        tag_section = get_local_camera_metadata_section_name(entry->tag, metadata);
-        if (tag_section == NULL) {
-            tag_section = "unknownSection";
-        }
-        tag_name = get_local_camera_metadata_tag_name(entry->tag, metadata);
-        if (tag_name == NULL) {
-            tag_name = "unknownTag";
-        }
-        const char *type_name;
-        if (entry->type >= NUM_TYPES) {
-            type_name = "unknown";
-        } else {
-            type_name = camera_metadata_type_names[entry->type];
+}
+
+static void dump_one_camera_metadata_entry(const camera_metadata_t *metadata,
+        const camera_metadata_buffer_entry_t *entry,
+        int fd,
+        int verbosity,
+        int indentation) {
+    const char *tag_name, *tag_section;
+    tag_section = get_local_camera_metadata_section_name(entry->tag, metadata);
+    if (tag_section == NULL) {
+        tag_section = "unknownSection";
+    }
+    tag_name = get_local_camera_metadata_tag_name(entry->tag, metadata);
+    if (tag_name == NULL) {
+        tag_name = "unknownTag";
+    }
+    const char *type_name;
+    if (entry->type >= NUM_TYPES) {
+        type_name = "unknown";
+    } else {
+        type_name = camera_metadata_type_names[entry->type];
+    }
+    dprintf(fd, "%*s%s.%s (%05x): %s[%" PRIu32 "]\n",
+         indentation + 2, "",
+         tag_section,
+         tag_name,
+         entry->tag,
+         type_name,
+         entry->count);
+
+    if (verbosity < 1) return;
+
+    if (entry->type >= NUM_TYPES) return;
+
+    size_t type_size = camera_metadata_type_size[entry->type];
+    const uint8_t *data_ptr;
+    if ( type_size * entry->count > 4 ) {
+        if (entry->data.offset >= metadata->data_count) {
+            ALOGE("%s: Malformed entry data offset: %" PRIu32 " (max %" PRIu32 ")",
+                    __FUNCTION__,
+                    entry->data.offset,
+                    metadata->data_count);
+            return;
         }
-        dprintf(fd, "%*s%s.%s (%05x): %s[%" PRIu32 "]\n",
-             indentation + 2, "",
-             tag_section,
-             tag_name,
-             entry->tag,
-             type_name,
-             entry->count);
-
-        if (verbosity < 1) continue;
-
-        if (entry->type >= NUM_TYPES) continue;
-
-        size_t type_size = camera_metadata_type_size[entry->type];
-        uint8_t *data_ptr;
-        if ( type_size * entry->count > 4 ) {
-            if (entry->data.offset >= metadata->data_count) {
-                ALOGE("%s: Malformed entry data offset: %" PRIu32 " (max %" PRIu32 ")",
-                        __FUNCTION__,
-                        entry->data.offset,
-                        metadata->data_count);
-                continue;
-            }
-            data_ptr = get_data(metadata) + entry->data.offset;
+        data_ptr = get_data(metadata) + entry->data.offset;
+    } else {
+        data_ptr = entry->data.value;
+    }
+    int count = entry->count;
+    if (verbosity < 2 && count > 16) count = 16;
+
+    print_data(fd, data_ptr, entry->tag, entry->type, count, indentation);
+}
+
+void dump_camera_metadata_begin(const camera_metadata_t *metadata,
+        int verbosity,
+        int indentation,
+        camera_metadata_dump_state_t *state) {
+    state->metadata = metadata;
+    state->next_entry = 0;
+    state->verbosity = verbosity;
+    state->indentation = indentation;
+    state->started = 0;
+}
+
+size_t dump_camera_metadata_next(camera_metadata_dump_state_t *state,
+        int fd,
+        size_t max_entries,
+        int (*filter)(void *context, uint32_t tag),
+        void *context) {
+    const camera_metadata_t *metadata = state->metadata;
+
+    if (!state->started) {
+        state->started = 1;
+        if (metadata == NULL) {
+            dprintf(fd, "%*sDumping camera metadata array: Not allocated\n",
+                    state->indentation, "");
         } else {
-            data_ptr = entry->data.value;
+            dprintf(fd,
+                    "%*sDumping camera metadata array: %" PRIu32 " / %" PRIu32
+                    " entries, %" PRIu32 " / %" PRIu32 " bytes of extra data.\n",
+                    state->indentation, "",
+                    metadata->entry_count, metadata->entry_capacity,
+                    metadata->data_count, metadata->data_capacity);
+            dprintf(fd, "%*sVersion: %d, Flags: %08x\n",
+                    state->indentation + 2, "",
+                    metadata->version, metadata->flags);
         }
-        int count = entry->count;
-        if (verbosity < 2 && count > 16) count = 16;
+    }
+    if (metadata == NULL) {
+        return 0;
+    }
 
-        print_data(fd, data_ptr, entry->tag, entry->type, count, indentation);
+    size_t consumed = 0;
+    const camera_metadata_buffer_entry_t *entry =
+            get_entries(metadata) + state->next_entry;
+    while (state->next_entry < metadata->entry_count && consumed < max_entries) {
+        if (filter == NULL || filter(context, entry->tag)) {
+            dump_one_camera_metadata_entry(metadata, entry, fd,
+                    state->verbosity, state->indentation);
+        }
+        state->next_entry++;
+        entry++;
+        consumed++;
     }
+    return consumed;
 }
 
 static void print_data(int fd, const uint8_t *data_ptr, uint32_t tag,
@@ -1163,6 +2416,7 @@ static void print_data(int fd, const uint8_t *data_ptr, uint32_t tag,
         [TYPE_INT64]    = 2,
         [TYPE_DOUBLE]   = 4,
         [TYPE_RATIONAL] = 2,
+        [TYPE_EXTERNAL] = 1,
     };
     size_t type_size = camera_metadata_type_size[type];
     char value_string_tmp[CAMERA_METADATA_ENUM_STRING_MAX_SIZE];
@@ -1226,6 +2480,13 @@ static void print_data(int fd, const uint8_t *data_ptr, uint32_t tag,
                             numerator, denominator);
                     break;
                 }
+                case TYPE_EXTERNAL: {
+                    camera_metadata_external_blob_t blob;
+                    memcpy(&blob, data_ptr + index, sizeof(blob));
+                    dprintf(fd, "(fd %d, offset %" PRIu64 ", size %" PRIu64 ") ",
+                            blob.fd, blob.offset, blob.size);
+                    break;
+                }
                 default:
                     dprintf(fd, "??? ");
             }
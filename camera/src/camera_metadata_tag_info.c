@@ -134,7 +134,7 @@ unsigned int camera_metadata_section_bounds[ANDROID_SECTION_COUNT][2] = {
                                        ANDROID_AUTOMOTIVE_LENS_END },
 };
 
-static tag_info_t android_color_correction[ANDROID_COLOR_CORRECTION_END -
+static const tag_info_t android_color_correction[ANDROID_COLOR_CORRECTION_END -
         ANDROID_COLOR_CORRECTION_START] = {
     [ ANDROID_COLOR_CORRECTION_MODE - ANDROID_COLOR_CORRECTION_START ] =
     { "mode",                          TYPE_BYTE   },
@@ -149,7 +149,7 @@ static tag_info_t android_color_correction[ANDROID_COLOR_CORRECTION_END -
     { "availableAberrationModes",      TYPE_BYTE   },
 };
 
-static tag_info_t android_control[ANDROID_CONTROL_END -
+static const tag_info_t android_control[ANDROID_CONTROL_END -
         ANDROID_CONTROL_START] = {
     [ ANDROID_CONTROL_AE_ANTIBANDING_MODE - ANDROID_CONTROL_START ] =
     { "aeAntibandingMode",             TYPE_BYTE   },
@@ -263,13 +263,13 @@ static tag_info_t android_control[ANDROID_CONTROL_END -
     { "awbRegionsSet",                 TYPE_BYTE   },
 };
 
-static tag_info_t android_demosaic[ANDROID_DEMOSAIC_END -
+static const tag_info_t android_demosaic[ANDROID_DEMOSAIC_END -
         ANDROID_DEMOSAIC_START] = {
     [ ANDROID_DEMOSAIC_MODE - ANDROID_DEMOSAIC_START ] =
     { "mode",                          TYPE_BYTE   },
 };
 
-static tag_info_t android_edge[ANDROID_EDGE_END -
+static const tag_info_t android_edge[ANDROID_EDGE_END -
         ANDROID_EDGE_START] = {
     [ ANDROID_EDGE_MODE - ANDROID_EDGE_START ] =
     { "mode",                          TYPE_BYTE   },
@@ -279,7 +279,7 @@ static tag_info_t android_edge[ANDROID_EDGE_END -
     { "availableEdgeModes",            TYPE_BYTE   },
 };
 
-static tag_info_t android_flash[ANDROID_FLASH_END -
+static const tag_info_t android_flash[ANDROID_FLASH_END -
         ANDROID_FLASH_START] = {
     [ ANDROID_FLASH_FIRING_POWER - ANDROID_FLASH_START ] =
     { "firingPower",                   TYPE_BYTE   },
@@ -295,7 +295,7 @@ static tag_info_t android_flash[ANDROID_FLASH_END -
     { "state",                         TYPE_BYTE   },
 };
 
-static tag_info_t android_flash_info[ANDROID_FLASH_INFO_END -
+static const tag_info_t android_flash_info[ANDROID_FLASH_INFO_END -
         ANDROID_FLASH_INFO_START] = {
     [ ANDROID_FLASH_INFO_AVAILABLE - ANDROID_FLASH_INFO_START ] =
     { "available",                     TYPE_BYTE   },
@@ -307,7 +307,7 @@ static tag_info_t android_flash_info[ANDROID_FLASH_INFO_END -
     { "strengthDefaultLevel",          TYPE_INT32  },
 };
 
-static tag_info_t android_hot_pixel[ANDROID_HOT_PIXEL_END -
+static const tag_info_t android_hot_pixel[ANDROID_HOT_PIXEL_END -
         ANDROID_HOT_PIXEL_START] = {
     [ ANDROID_HOT_PIXEL_MODE - ANDROID_HOT_PIXEL_START ] =
     { "mode",                          TYPE_BYTE   },
@@ -315,7 +315,7 @@ static tag_info_t android_hot_pixel[ANDROID_HOT_PIXEL_END -
     { "availableHotPixelModes",        TYPE_BYTE   },
 };
 
-static tag_info_t android_jpeg[ANDROID_JPEG_END -
+static const tag_info_t android_jpeg[ANDROID_JPEG_END -
         ANDROID_JPEG_START] = {
     [ ANDROID_JPEG_GPS_COORDINATES - ANDROID_JPEG_START ] =
     { "gpsCoordinates",                TYPE_DOUBLE },
@@ -339,7 +339,7 @@ static tag_info_t android_jpeg[ANDROID_JPEG_END -
     { "size",                          TYPE_INT32  },
 };
 
-static tag_info_t android_lens[ANDROID_LENS_END -
+static const tag_info_t android_lens[ANDROID_LENS_END -
         ANDROID_LENS_START] = {
     [ ANDROID_LENS_APERTURE - ANDROID_LENS_START ] =
     { "aperture",                      TYPE_FLOAT  },
@@ -376,7 +376,7 @@ static tag_info_t android_lens[ANDROID_LENS_END -
                                         TYPE_FLOAT  },
 };
 
-static tag_info_t android_lens_info[ANDROID_LENS_INFO_END -
+static const tag_info_t android_lens_info[ANDROID_LENS_INFO_END -
         ANDROID_LENS_INFO_START] = {
     [ ANDROID_LENS_INFO_AVAILABLE_APERTURES - ANDROID_LENS_INFO_START ] =
     { "availableApertures",            TYPE_FLOAT  },
@@ -396,7 +396,7 @@ static tag_info_t android_lens_info[ANDROID_LENS_INFO_END -
     { "focusDistanceCalibration",      TYPE_BYTE   },
 };
 
-static tag_info_t android_noise_reduction[ANDROID_NOISE_REDUCTION_END -
+static const tag_info_t android_noise_reduction[ANDROID_NOISE_REDUCTION_END -
         ANDROID_NOISE_REDUCTION_START] = {
     [ ANDROID_NOISE_REDUCTION_MODE - ANDROID_NOISE_REDUCTION_START ] =
     { "mode",                          TYPE_BYTE   },
@@ -406,7 +406,7 @@ static tag_info_t android_noise_reduction[ANDROID_NOISE_REDUCTION_END -
     { "availableNoiseReductionModes",  TYPE_BYTE   },
 };
 
-static tag_info_t android_quirks[ANDROID_QUIRKS_END -
+static const tag_info_t android_quirks[ANDROID_QUIRKS_END -
         ANDROID_QUIRKS_START] = {
     [ ANDROID_QUIRKS_METERING_CROP_REGION - ANDROID_QUIRKS_START ] =
     { "meteringCropRegion",            TYPE_BYTE   },
@@ -420,7 +420,7 @@ static tag_info_t android_quirks[ANDROID_QUIRKS_END -
     { "partialResult",                 TYPE_BYTE   },
 };
 
-static tag_info_t android_request[ANDROID_REQUEST_END -
+static const tag_info_t android_request[ANDROID_REQUEST_END -
         ANDROID_REQUEST_START] = {
     [ ANDROID_REQUEST_FRAME_COUNT - ANDROID_REQUEST_START ] =
     { "frameCount",                    TYPE_INT32  },
@@ -470,7 +470,7 @@ static tag_info_t android_request[ANDROID_REQUEST_END -
                                         TYPE_INT64  },
 };
 
-static tag_info_t android_scaler[ANDROID_SCALER_END -
+static const tag_info_t android_scaler[ANDROID_SCALER_END -
         ANDROID_SCALER_START] = {
     [ ANDROID_SCALER_CROP_REGION - ANDROID_SCALER_START ] =
     { "cropRegion",                    TYPE_INT32  },
@@ -538,7 +538,7 @@ static tag_info_t android_scaler[ANDROID_SCALER_END -
     { "availableStreamUseCases",       TYPE_INT64  },
 };
 
-static tag_info_t android_sensor[ANDROID_SENSOR_END -
+static const tag_info_t android_sensor[ANDROID_SENSOR_END -
         ANDROID_SENSOR_START] = {
     [ ANDROID_SENSOR_EXPOSURE_TIME - ANDROID_SENSOR_START ] =
     { "exposureTime",                  TYPE_INT64  },
@@ -621,7 +621,7 @@ static tag_info_t android_sensor[ANDROID_SENSOR_END -
     { "readoutTimestamp",              TYPE_BYTE   },
 };
 
-static tag_info_t android_sensor_info[ANDROID_SENSOR_INFO_END -
+static const tag_info_t android_sensor_info[ANDROID_SENSOR_INFO_END -
         ANDROID_SENSOR_INFO_START] = {
     [ ANDROID_SENSOR_INFO_ACTIVE_ARRAY_SIZE - ANDROID_SENSOR_INFO_START ] =
     { "activeArraySize",               TYPE_INT32  },
@@ -658,7 +658,7 @@ static tag_info_t android_sensor_info[ANDROID_SENSOR_INFO_END -
     { "binningFactor",                 TYPE_INT32  },
 };
 
-static tag_info_t android_shading[ANDROID_SHADING_END -
+static const tag_info_t android_shading[ANDROID_SHADING_END -
         ANDROID_SHADING_START] = {
     [ ANDROID_SHADING_MODE - ANDROID_SHADING_START ] =
     { "mode",                          TYPE_BYTE   },
@@ -668,7 +668,7 @@ static tag_info_t android_shading[ANDROID_SHADING_END -
     { "availableModes",                TYPE_BYTE   },
 };
 
-static tag_info_t android_statistics[ANDROID_STATISTICS_END -
+static const tag_info_t android_statistics[ANDROID_STATISTICS_END -
         ANDROID_STATISTICS_START] = {
     [ ANDROID_STATISTICS_FACE_DETECT_MODE - ANDROID_STATISTICS_START ] =
     { "faceDetectMode",                TYPE_BYTE   },
@@ -715,7 +715,7 @@ static tag_info_t android_statistics[ANDROID_STATISTICS_END -
     { "oisYShifts",                    TYPE_FLOAT  },
 };
 
-static tag_info_t android_statistics_info[ANDROID_STATISTICS_INFO_END -
+static const tag_info_t android_statistics_info[ANDROID_STATISTICS_INFO_END -
         ANDROID_STATISTICS_INFO_START] = {
     [ ANDROID_STATISTICS_INFO_AVAILABLE_FACE_DETECT_MODES - ANDROID_STATISTICS_INFO_START ] =
     { "availableFaceDetectModes",      TYPE_BYTE   },
@@ -737,7 +737,7 @@ static tag_info_t android_statistics_info[ANDROID_STATISTICS_INFO_END -
     { "availableOisDataModes",         TYPE_BYTE   },
 };
 
-static tag_info_t android_tonemap[ANDROID_TONEMAP_END -
+static const tag_info_t android_tonemap[ANDROID_TONEMAP_END -
         ANDROID_TONEMAP_START] = {
     [ ANDROID_TONEMAP_CURVE_BLUE - ANDROID_TONEMAP_START ] =
     { "curveBlue",                     TYPE_FLOAT  },
@@ -757,7 +757,7 @@ static tag_info_t android_tonemap[ANDROID_TONEMAP_END -
     { "presetCurve",                   TYPE_BYTE   },
 };
 
-static tag_info_t android_led[ANDROID_LED_END -
+static const tag_info_t android_led[ANDROID_LED_END -
         ANDROID_LED_START] = {
     [ ANDROID_LED_TRANSMIT - ANDROID_LED_START ] =
     { "transmit",                      TYPE_BYTE   },
@@ -765,7 +765,7 @@ static tag_info_t android_led[ANDROID_LED_END -
     { "availableLeds",                 TYPE_BYTE   },
 };
 
-static tag_info_t android_info[ANDROID_INFO_END -
+static const tag_info_t android_info[ANDROID_INFO_END -
         ANDROID_INFO_START] = {
     [ ANDROID_INFO_SUPPORTED_HARDWARE_LEVEL - ANDROID_INFO_START ] =
     { "supportedHardwareLevel",        TYPE_BYTE   },
@@ -778,13 +778,13 @@ static tag_info_t android_info[ANDROID_INFO_END -
     { "deviceStateOrientations",       TYPE_INT64  },
 };
 
-static tag_info_t android_black_level[ANDROID_BLACK_LEVEL_END -
+static const tag_info_t android_black_level[ANDROID_BLACK_LEVEL_END -
         ANDROID_BLACK_LEVEL_START] = {
     [ ANDROID_BLACK_LEVEL_LOCK - ANDROID_BLACK_LEVEL_START ] =
     { "lock",                          TYPE_BYTE   },
 };
 
-static tag_info_t android_sync[ANDROID_SYNC_END -
+static const tag_info_t android_sync[ANDROID_SYNC_END -
         ANDROID_SYNC_START] = {
     [ ANDROID_SYNC_FRAME_NUMBER - ANDROID_SYNC_START ] =
     { "frameNumber",                   TYPE_INT64  },
@@ -792,7 +792,7 @@ static tag_info_t android_sync[ANDROID_SYNC_END -
     { "maxLatency",                    TYPE_INT32  },
 };
 
-static tag_info_t android_reprocess[ANDROID_REPROCESS_END -
+static const tag_info_t android_reprocess[ANDROID_REPROCESS_END -
         ANDROID_REPROCESS_START] = {
     [ ANDROID_REPROCESS_EFFECTIVE_EXPOSURE_FACTOR - ANDROID_REPROCESS_START ] =
     { "effectiveExposureFactor",       TYPE_FLOAT  },
@@ -800,7 +800,7 @@ static tag_info_t android_reprocess[ANDROID_REPROCESS_END -
     { "maxCaptureStall",               TYPE_INT32  },
 };
 
-static tag_info_t android_depth[ANDROID_DEPTH_END -
+static const tag_info_t android_depth[ANDROID_DEPTH_END -
         ANDROID_DEPTH_START] = {
     [ ANDROID_DEPTH_MAX_DEPTH_SAMPLES - ANDROID_DEPTH_START ] =
     { "maxDepthSamples",               TYPE_INT32  },
@@ -846,7 +846,7 @@ static tag_info_t android_depth[ANDROID_DEPTH_END -
                                         TYPE_INT64  },
 };
 
-static tag_info_t android_logical_multi_camera[ANDROID_LOGICAL_MULTI_CAMERA_END -
+static const tag_info_t android_logical_multi_camera[ANDROID_LOGICAL_MULTI_CAMERA_END -
         ANDROID_LOGICAL_MULTI_CAMERA_START] = {
     [ ANDROID_LOGICAL_MULTI_CAMERA_PHYSICAL_IDS - ANDROID_LOGICAL_MULTI_CAMERA_START ] =
     { "physicalIds",                   TYPE_BYTE   },
@@ -856,7 +856,7 @@ static tag_info_t android_logical_multi_camera[ANDROID_LOGICAL_MULTI_CAMERA_END
     { "activePhysicalId",              TYPE_BYTE   },
 };
 
-static tag_info_t android_distortion_correction[ANDROID_DISTORTION_CORRECTION_END -
+static const tag_info_t android_distortion_correction[ANDROID_DISTORTION_CORRECTION_END -
         ANDROID_DISTORTION_CORRECTION_START] = {
     [ ANDROID_DISTORTION_CORRECTION_MODE - ANDROID_DISTORTION_CORRECTION_START ] =
     { "mode",                          TYPE_BYTE   },
@@ -864,7 +864,7 @@ static tag_info_t android_distortion_correction[ANDROID_DISTORTION_CORRECTION_EN
     { "availableModes",                TYPE_BYTE   },
 };
 
-static tag_info_t android_heic[ANDROID_HEIC_END -
+static const tag_info_t android_heic[ANDROID_HEIC_END -
         ANDROID_HEIC_START] = {
     [ ANDROID_HEIC_AVAILABLE_HEIC_STREAM_CONFIGURATIONS - ANDROID_HEIC_START ] =
     { "availableHeicStreamConfigurations",
@@ -885,7 +885,7 @@ static tag_info_t android_heic[ANDROID_HEIC_END -
                                         TYPE_INT64  },
 };
 
-static tag_info_t android_heic_info[ANDROID_HEIC_INFO_END -
+static const tag_info_t android_heic_info[ANDROID_HEIC_INFO_END -
         ANDROID_HEIC_INFO_START] = {
     [ ANDROID_HEIC_INFO_SUPPORTED - ANDROID_HEIC_INFO_START ] =
     { "supported",                     TYPE_BYTE   },
@@ -893,20 +893,20 @@ static tag_info_t android_heic_info[ANDROID_HEIC_INFO_END -
     { "maxJpegAppSegmentsCount",       TYPE_BYTE   },
 };
 
-static tag_info_t android_automotive[ANDROID_AUTOMOTIVE_END -
+static const tag_info_t android_automotive[ANDROID_AUTOMOTIVE_END -
         ANDROID_AUTOMOTIVE_START] = {
     [ ANDROID_AUTOMOTIVE_LOCATION - ANDROID_AUTOMOTIVE_START ] =
     { "location",                      TYPE_BYTE   },
 };
 
-static tag_info_t android_automotive_lens[ANDROID_AUTOMOTIVE_LENS_END -
+static const tag_info_t android_automotive_lens[ANDROID_AUTOMOTIVE_LENS_END -
         ANDROID_AUTOMOTIVE_LENS_START] = {
     [ ANDROID_AUTOMOTIVE_LENS_FACING - ANDROID_AUTOMOTIVE_LENS_START ] =
     { "facing",                        TYPE_BYTE   },
 };
 
 
-tag_info_t *tag_info[ANDROID_SECTION_COUNT] = {
+const tag_info_t *const tag_info[ANDROID_SECTION_COUNT] = {
     android_color_correction,
     android_control,
     android_demosaic,
@@ -941,7 +941,7 @@ tag_info_t *tag_info[ANDROID_SECTION_COUNT] = {
     android_automotive_lens,
 };
 
-static int32_t tag_permission_needed[18] = {
+static const int32_t tag_permission_needed[18] = {
     ANDROID_LENS_POSE_ROTATION,
     ANDROID_LENS_POSE_TRANSLATION,
     ANDROID_LENS_INTRINSIC_CALIBRATION,
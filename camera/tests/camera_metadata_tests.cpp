@@ -21,11 +21,13 @@
 
 #include <vector>
 #include <algorithm>
+#include <type_traits>
 
 #include <gtest/gtest.h>
 #include <log/log.h>
 
 #include "system/camera_metadata.h"
+#include "system/camera_metadata_typed_tags.h"
 #include "camera_metadata_hidden.h"
 
 #include "camera_metadata_tests_fake_vendor.h"
@@ -46,6 +48,19 @@
     EXPECT_EQ(OK, validate_camera_metadata_structure(m, NULL)); \
     free_camera_metadata(m);                                    \
 
+TEST(camera_metadata, layout_constants) {
+    // The exported layout constants describe the flattened ABI; the runtime
+    // query must agree with them.
+    EXPECT_EQ(CAMERA_METADATA_PACKET_ALIGNMENT, get_camera_metadata_alignment());
+
+    // The entry array is dense: stride is a multiple of the entry alignment
+    // and the data union fits between its neighboring fields.
+    static_assert(CAMERA_METADATA_ENTRY_SIZE % CAMERA_METADATA_ENTRY_ALIGNMENT == 0,
+            "entry stride must preserve entry alignment");
+    static_assert(CAMERA_METADATA_ENTRY_DATA_OFFSET + 4 <= CAMERA_METADATA_ENTRY_TYPE_OFFSET,
+            "the four-byte data union precedes the type field");
+}
+
 TEST(camera_metadata, allocate_normal) {
     camera_metadata_t *m = NULL;
     const size_t entry_capacity = 5;
@@ -391,6 +406,54 @@ void add_test_metadata(camera_metadata_t *m, int entry_count) {
             get_camera_metadata_data_count(m));
 }
 
+TEST(camera_metadata, typed_get) {
+    camera_metadata_t *m = NULL;
+    const size_t entry_capacity = 5;
+    const size_t data_capacity = 128;
+
+    m = allocate_camera_metadata(entry_capacity, data_capacity);
+
+    int64_t exposure_time = 1000000000;
+    EXPECT_EQ(OK, add_camera_metadata_entry(m,
+            ANDROID_SENSOR_EXPOSURE_TIME,
+            &exposure_time, 1));
+
+    float colorCorrectionGains[] = {1.69f,  1.00f,  1.00f,  2.41f};
+    EXPECT_EQ(OK, add_camera_metadata_entry(m,
+            ANDROID_COLOR_CORRECTION_GAINS,
+            colorCorrectionGains, ARRAY_SIZE(colorCorrectionGains)));
+
+    // the value type is selected by the tag at compile time
+    auto exposure = android::camera_metadata::get<ANDROID_SENSOR_EXPOSURE_TIME>(m);
+    static_assert(std::is_same<decltype(exposure.data), const int64_t *>::value,
+            "int64 tag must yield an int64_t span");
+    ASSERT_EQ((size_t)1, exposure.count);
+    EXPECT_EQ(exposure_time, exposure[0]);
+
+    auto gains = android::camera_metadata::get<ANDROID_COLOR_CORRECTION_GAINS>(m);
+    static_assert(std::is_same<decltype(gains.data), const float *>::value,
+            "float tag must yield a float span");
+    ASSERT_EQ(ARRAY_SIZE(colorCorrectionGains), gains.count);
+    for (size_t i = 0; i < gains.count; i++) {
+        EXPECT_EQ(colorCorrectionGains[i], gains[i]);
+    }
+
+    // absent tag yields an empty span
+    auto sensitivity = android::camera_metadata::get<ANDROID_SENSOR_SENSITIVITY>(m);
+    EXPECT_TRUE(sensitivity.empty());
+    EXPECT_FALSE(sensitivity);
+    EXPECT_NULL((void *)sensitivity.data);
+
+    // mutable span updates values in place
+    auto mutableGains =
+            android::camera_metadata::get_mutable<ANDROID_COLOR_CORRECTION_GAINS>(m);
+    ASSERT_EQ(ARRAY_SIZE(colorCorrectionGains), mutableGains.count);
+    mutableGains[0] = 2.00f;
+    EXPECT_EQ(2.00f, android::camera_metadata::get<ANDROID_COLOR_CORRECTION_GAINS>(m)[0]);
+
+    FINISH_USING_CAMERA_METADATA(m);
+}
+
 TEST(camera_metadata, add_get_toomany) {
     camera_metadata_t *m = NULL;
     const size_t entry_capacity = 5;
@@ -784,6 +847,68 @@ TEST(camera_metadata, append_metadata_onespace) {
     FINISH_USING_CAMERA_METADATA(m2);
 }
 
+static std::string read_dump_file(FILE *f) {
+    fflush(f);
+    long size = ftell(f);
+    rewind(f);
+    std::string contents(size, '\0');
+    EXPECT_EQ(static_cast<size_t>(size), fread(&contents[0], 1, size, f));
+    return contents;
+}
+
+TEST(camera_metadata, dump_iterator) {
+    camera_metadata_t *m = NULL;
+    const size_t entry_capacity = 20;
+    const size_t data_capacity = 500;
+
+    m = allocate_camera_metadata(entry_capacity, data_capacity);
+    add_test_metadata(m, entry_capacity);
+
+    for (int verbosity = 0; verbosity <= 2; verbosity++) {
+        FILE *whole = tmpfile();
+        FILE *chunked = tmpfile();
+        ASSERT_TRUE(whole != NULL);
+        ASSERT_TRUE(chunked != NULL);
+
+        dump_camera_metadata(m, fileno(whole), verbosity);
+
+        // One entry per call must produce the identical dump.
+        camera_metadata_dump_state_t state;
+        dump_camera_metadata_begin(m, verbosity, /*indentation*/0, &state);
+        size_t total = 0;
+        size_t consumed;
+        while ((consumed = dump_camera_metadata_next(&state, fileno(chunked),
+                /*max_entries*/1, NULL, NULL)) > 0) {
+            EXPECT_EQ(1U, consumed);
+            total += consumed;
+        }
+        EXPECT_EQ(entry_capacity, total);
+
+        EXPECT_EQ(read_dump_file(whole), read_dump_file(chunked));
+        fclose(whole);
+        fclose(chunked);
+    }
+
+    // A filter rejecting every tag consumes all entries but formats none.
+    FILE *filtered = tmpfile();
+    ASSERT_TRUE(filtered != NULL);
+    camera_metadata_dump_state_t state;
+    dump_camera_metadata_begin(m, 2, 0, &state);
+    size_t total = 0;
+    size_t consumed;
+    while ((consumed = dump_camera_metadata_next(&state, fileno(filtered),
+            /*max_entries*/7, [](void *, uint32_t) { return 0; }, NULL)) > 0) {
+        total += consumed;
+    }
+    EXPECT_EQ(entry_capacity, total);
+    std::string contents = read_dump_file(filtered);
+    EXPECT_EQ(std::string::npos, contents.find("exposureTime"));
+    EXPECT_NE(std::string::npos, contents.find("Dumping camera metadata array"));
+    fclose(filtered);
+
+    FINISH_USING_CAMERA_METADATA(m);
+}
+
 TEST(camera_metadata, vendor_tags) {
     camera_metadata_t *m = NULL;
     const size_t entry_capacity = 5;
@@ -873,6 +998,103 @@ TEST(camera_metadata, vendor_tags) {
     FINISH_USING_CAMERA_METADATA(m);
 }
 
+TEST(camera_metadata, vendor_tags_batched) {
+    // the batched descriptor enumeration must answer every query exactly
+    // as the per-tag ops do
+    set_camera_metadata_vendor_ops(&fakevendor_batched_ops);
+
+    int count = get_fakevendor_tag_count(&fakevendor_ops);
+    ASSERT_LT(0, count);
+    std::vector<uint32_t> tags(count);
+    get_fakevendor_tags(&fakevendor_ops, tags.data());
+
+    for (uint32_t tag : tags) {
+        EXPECT_STREQ(get_fakevendor_section_name(&fakevendor_ops, tag),
+                get_camera_metadata_section_name(tag)) << "tag " << tag;
+        EXPECT_STREQ(get_fakevendor_tag_name(&fakevendor_ops, tag),
+                get_camera_metadata_tag_name(tag)) << "tag " << tag;
+        EXPECT_EQ(get_fakevendor_tag_type(&fakevendor_ops, tag),
+                get_camera_metadata_tag_type(tag)) << "tag " << tag;
+    }
+
+    // past the end of a section: same not-found answers as the per-tag ops
+    EXPECT_STREQ("com.fakevendor.scaler",
+            get_camera_metadata_section_name(FAKEVENDOR_SCALER_END));
+    EXPECT_NULL(get_camera_metadata_tag_name(FAKEVENDOR_SCALER_END));
+    EXPECT_EQ(-1, get_camera_metadata_tag_type(FAKEVENDOR_SCALER_END));
+
+    set_camera_metadata_vendor_ops(NULL);
+}
+
+TEST(camera_metadata, external_blob_entries) {
+    camera_metadata_t *m = NULL;
+    const size_t entry_capacity = 5;
+    const size_t data_capacity = 128;
+
+    set_camera_metadata_vendor_ops(&fakevendor_ops);
+    m = allocate_camera_metadata(entry_capacity, data_capacity);
+    ASSERT_NE((void*)NULL, (void*)m);
+
+    camera_metadata_external_blob_t blobs[2] = {};
+    blobs[0].fd = 17;
+    blobs[0].offset = 4096;
+    blobs[0].size = 1 << 20;
+    blobs[1].fd = 17;
+    blobs[1].offset = 0;
+    blobs[1].size = 8;
+
+    int result = add_camera_metadata_entry(m,
+            FAKEVENDOR_SENSOR_DEPTH_MAP,
+            blobs, 2);
+    EXPECT_EQ(OK, result);
+    EXPECT_EQ(OK, validate_camera_metadata_structure(m, NULL));
+
+    camera_metadata_ro_entry_t entry;
+    ASSERT_EQ(OK, find_camera_metadata_ro_entry(m,
+            FAKEVENDOR_SENSOR_DEPTH_MAP, &entry));
+    EXPECT_EQ(TYPE_EXTERNAL, entry.type);
+    ASSERT_EQ((size_t)2, entry.count);
+
+    // only the descriptors ride in the packet, not the payloads
+    camera_metadata_external_blob_t blob;
+    ASSERT_EQ(OK, get_camera_metadata_external_blob(&entry, 0, &blob));
+    EXPECT_EQ(17, blob.fd);
+    EXPECT_EQ((uint64_t)4096, blob.offset);
+    EXPECT_EQ((uint64_t)(1 << 20), blob.size);
+    ASSERT_EQ(OK, get_camera_metadata_external_blob(&entry, 1, &blob));
+    EXPECT_EQ((uint64_t)8, blob.size);
+    EXPECT_EQ(ERROR, get_camera_metadata_external_blob(&entry, 2, &blob));
+
+    // malformed descriptors must be rejected at access time
+    camera_metadata_entry_t writable;
+    ASSERT_EQ(OK, find_camera_metadata_entry(m,
+            FAKEVENDOR_SENSOR_DEPTH_MAP, &writable));
+    writable.data.eb[0].fd = -1;
+    EXPECT_EQ(ERROR, get_camera_metadata_external_blob(&entry, 0, &blob));
+    writable.data.eb[0].fd = 17;
+    writable.data.eb[0].reserved = 1;
+    EXPECT_EQ(ERROR, get_camera_metadata_external_blob(&entry, 0, &blob));
+    writable.data.eb[0].reserved = 0;
+    writable.data.eb[0].size = 0;
+    EXPECT_EQ(ERROR, get_camera_metadata_external_blob(&entry, 0, &blob));
+    writable.data.eb[0].offset = UINT64_MAX;
+    writable.data.eb[0].size = 2;
+    EXPECT_EQ(ERROR, get_camera_metadata_external_blob(&entry, 0, &blob));
+    writable.data.eb[0] = blobs[0];
+    EXPECT_EQ(OK, get_camera_metadata_external_blob(&entry, 0, &blob));
+
+    // entries of other types never decode as external blobs
+    uint8_t superMode = 3;
+    EXPECT_EQ(OK, add_camera_metadata_entry(m,
+            FAKEVENDOR_SENSOR_SUPERMODE, &superMode, 1));
+    ASSERT_EQ(OK, find_camera_metadata_ro_entry(m,
+            FAKEVENDOR_SENSOR_SUPERMODE, &entry));
+    EXPECT_EQ(ERROR, get_camera_metadata_external_blob(&entry, 0, &blob));
+
+    FINISH_USING_CAMERA_METADATA(m);
+    set_camera_metadata_vendor_ops(NULL);
+}
+
 TEST(camera_metadata, add_all_tags) {
     int total_tag_count = 0;
     for (int i = 0; i < ANDROID_SECTION_COUNT; i++) {
@@ -1072,6 +1294,323 @@ TEST(camera_metadata, sort_metadata) {
     FINISH_USING_CAMERA_METADATA(m);
 }
 
+TEST(camera_metadata, sort_metadata_appended_tail) {
+    // A few out-of-order entries appended to a sorted template take the
+    // sorted-prefix insertion path in sort_camera_metadata(); a mostly
+    // reversed buffer still falls back to qsort.  Both must end fully sorted.
+    uint32_t tags[] = {  // all TYPE_BYTE
+        ANDROID_COLOR_CORRECTION_MODE,
+        ANDROID_CONTROL_AE_ANTIBANDING_MODE,
+        ANDROID_CONTROL_AE_LOCK,
+        ANDROID_CONTROL_AE_MODE,
+        ANDROID_CONTROL_AE_PRECAPTURE_TRIGGER,
+        ANDROID_CONTROL_AF_MODE,
+        ANDROID_CONTROL_AF_TRIGGER,
+        ANDROID_CONTROL_AWB_LOCK,
+        ANDROID_CONTROL_AWB_MODE,
+        ANDROID_CONTROL_CAPTURE_INTENT,
+        ANDROID_CONTROL_EFFECT_MODE,
+        ANDROID_CONTROL_MODE,
+        ANDROID_CONTROL_SCENE_MODE,
+        ANDROID_CONTROL_VIDEO_STABILIZATION_MODE,
+        ANDROID_CONTROL_AE_STATE,
+        ANDROID_CONTROL_AF_STATE,
+        ANDROID_CONTROL_AWB_STATE,
+        ANDROID_CONTROL_ENABLE_ZSL,
+        ANDROID_DEMOSAIC_MODE,
+        ANDROID_EDGE_MODE,
+    };
+    const size_t num_tags = ARRAY_SIZE(tags);
+    std::sort(tags, tags + num_tags);
+
+    auto expect_sorted_and_complete = [&](camera_metadata_t *m) {
+        EXPECT_EQ(num_tags, get_camera_metadata_entry_count(m));
+        uint32_t prev_tag = 0;
+        for (size_t i = 0; i < num_tags; i++) {
+            camera_metadata_entry_t entry;
+            ASSERT_EQ(OK, get_camera_metadata_entry(m, i, &entry));
+            if (i > 0) {
+                EXPECT_LT(prev_tag, entry.tag);
+            }
+            prev_tag = entry.tag;
+        }
+        for (size_t i = 0; i < num_tags; i++) {
+            camera_metadata_entry_t entry;
+            ASSERT_EQ(OK, find_camera_metadata_entry(m, tags[i], &entry));
+            EXPECT_EQ(tags[i], entry.tag);
+            EXPECT_EQ((uint8_t)(tags[i] & 0xFF), *entry.data.u8);
+        }
+    };
+
+    // Sorted template of 16 entries plus a short descending tail of 4
+    camera_metadata_t *m = allocate_camera_metadata(num_tags, 0);
+    for (size_t i = 0; i < 16; i++) {
+        uint8_t value = tags[i] & 0xFF;
+        ASSERT_EQ(OK, add_camera_metadata_entry(m, tags[i], &value, 1));
+    }
+    for (size_t i = num_tags; i > 16; i--) {
+        uint8_t value = tags[i - 1] & 0xFF;
+        ASSERT_EQ(OK, add_camera_metadata_entry(m, tags[i - 1], &value, 1));
+    }
+    ASSERT_EQ(OK, sort_camera_metadata(m));
+    expect_sorted_and_complete(m);
+    FINISH_USING_CAMERA_METADATA(m);
+
+    // Fully descending buffer, unsorted tail too long for insertion
+    m = allocate_camera_metadata(num_tags, 0);
+    for (size_t i = num_tags; i > 0; i--) {
+        uint8_t value = tags[i - 1] & 0xFF;
+        ASSERT_EQ(OK, add_camera_metadata_entry(m, tags[i - 1], &value, 1));
+    }
+    ASSERT_EQ(OK, sort_camera_metadata(m));
+    expect_sorted_and_complete(m);
+    FINISH_USING_CAMERA_METADATA(m);
+}
+
+TEST(camera_metadata, add_sorted_metadata) {
+    camera_metadata_t *m = NULL;
+    const size_t entry_capacity = 5;
+    const size_t data_capacity = 100;
+
+    int result;
+
+    m = allocate_camera_metadata(entry_capacity, data_capacity);
+
+    // Insert entries in non-sorted tag order, maintaining sorted order each time
+
+    int32_t sensitivity = 800;
+    result = add_sorted_camera_metadata_entry(m,
+            ANDROID_SENSOR_SENSITIVITY,
+            &sensitivity, 1);
+    EXPECT_EQ(OK, result);
+
+    float focus_distance = 0.5f;
+    result = add_sorted_camera_metadata_entry(m,
+            ANDROID_LENS_FOCUS_DISTANCE,
+            &focus_distance, 1);
+    EXPECT_EQ(OK, result);
+
+    int64_t exposure_time = 1000000000;
+    result = add_sorted_camera_metadata_entry(m,
+            ANDROID_SENSOR_EXPOSURE_TIME,
+            &exposure_time, 1);
+    EXPECT_EQ(OK, result);
+
+    // The buffer must be in sorted order: sorting it again is a no-op and
+    // entries must be found at their sorted indices.
+    result = sort_camera_metadata(m);
+    EXPECT_EQ(OK, result);
+
+    camera_metadata_entry_t entry;
+    result = find_camera_metadata_entry(m,
+            ANDROID_LENS_FOCUS_DISTANCE,
+            &entry);
+    EXPECT_EQ(OK, result);
+    EXPECT_EQ((size_t)0, entry.index);
+    EXPECT_EQ(focus_distance, *entry.data.f);
+
+    result = find_camera_metadata_entry(m,
+            ANDROID_SENSOR_EXPOSURE_TIME,
+            &entry);
+    EXPECT_EQ(OK, result);
+    EXPECT_EQ((size_t)1, entry.index);
+    EXPECT_EQ(exposure_time, *entry.data.i64);
+
+    result = find_camera_metadata_entry(m,
+            ANDROID_SENSOR_SENSITIVITY,
+            &entry);
+    EXPECT_EQ(OK, result);
+    EXPECT_EQ((size_t)2, entry.index);
+    EXPECT_EQ(sensitivity, *entry.data.i32);
+
+    FINISH_USING_CAMERA_METADATA(m);
+}
+
+TEST(camera_metadata, grow_metadata) {
+    camera_metadata_t *m = NULL;
+    const size_t entry_capacity = 2;
+    const size_t data_capacity = 0;
+
+    int result;
+
+    m = allocate_camera_metadata(entry_capacity, data_capacity);
+
+    int32_t sensitivity = 800;
+    result = add_camera_metadata_entry(m,
+            ANDROID_SENSOR_SENSITIVITY,
+            &sensitivity, 1);
+    EXPECT_EQ(OK, result);
+
+    float focus_distance = 0.5f;
+    result = add_camera_metadata_entry(m,
+            ANDROID_LENS_FOCUS_DISTANCE,
+            &focus_distance, 1);
+    EXPECT_EQ(OK, result);
+
+    // Buffer is full
+    int64_t exposure_time = 1000000000;
+    result = add_camera_metadata_entry(m,
+            ANDROID_SENSOR_EXPOSURE_TIME,
+            &exposure_time, 1);
+    EXPECT_NE(OK, result);
+
+    // Grow and retry; data-carrying entries exercise the data section move
+    m = grow_camera_metadata(m, 5, 100);
+    ASSERT_NE((camera_metadata_t*)NULL, m);
+
+    result = add_camera_metadata_entry(m,
+            ANDROID_SENSOR_EXPOSURE_TIME,
+            &exposure_time, 1);
+    EXPECT_EQ(OK, result);
+
+    camera_metadata_rational_t colorTransform[] = {
+        {9, 10}, {0, 1}, {0, 1},
+        {1, 5}, {1, 2}, {0, 1},
+        {0, 1}, {1, 10}, {7, 10}
+    };
+    result = add_camera_metadata_entry(m,
+            ANDROID_COLOR_CORRECTION_TRANSFORM,
+            colorTransform, ARRAY_SIZE(colorTransform));
+    EXPECT_EQ(OK, result);
+
+    // Original entries are intact after the grow
+    camera_metadata_entry_t entry;
+    result = find_camera_metadata_entry(m,
+            ANDROID_SENSOR_SENSITIVITY,
+            &entry);
+    EXPECT_EQ(OK, result);
+    EXPECT_EQ(sensitivity, *entry.data.i32);
+
+    result = find_camera_metadata_entry(m,
+            ANDROID_LENS_FOCUS_DISTANCE,
+            &entry);
+    EXPECT_EQ(OK, result);
+    EXPECT_EQ(focus_distance, *entry.data.f);
+
+    result = find_camera_metadata_entry(m,
+            ANDROID_COLOR_CORRECTION_TRANSFORM,
+            &entry);
+    EXPECT_EQ(OK, result);
+    EXPECT_EQ((size_t)ARRAY_SIZE(colorTransform), entry.count);
+    EXPECT_EQ(0, memcmp(entry.data.r, colorTransform, sizeof(colorTransform)));
+
+    FINISH_USING_CAMERA_METADATA(m);
+}
+
+TEST(camera_metadata, cow_clone_metadata) {
+    camera_metadata_t *m = NULL;
+    const size_t entry_capacity = 5;
+    const size_t data_capacity = 32;
+
+    int result;
+
+    m = allocate_camera_metadata(entry_capacity, data_capacity);
+
+    add_test_metadata(m, 3);
+    EXPECT_FALSE(is_camera_metadata_shared(m));
+
+    // Sharing is O(1): same buffer, one more reference
+    camera_metadata_t *shared = acquire_camera_metadata(m);
+    ASSERT_EQ(m, shared);
+    EXPECT_TRUE(is_camera_metadata_shared(m));
+
+    // A shared buffer rejects modification
+    int32_t exposure_count = 12;
+    result = add_camera_metadata_entry(shared,
+            ANDROID_REQUEST_FRAME_COUNT,
+            &exposure_count, 1);
+    EXPECT_NE(OK, result);
+
+    result = delete_camera_metadata_entry(shared, 0);
+    EXPECT_NE(OK, result);
+
+    int64_t exposure_time = 1000;
+    result = update_camera_metadata_entry(shared,
+            0, &exposure_time, 1, NULL);
+    EXPECT_NE(OK, result);
+
+    // Unsharing pays the copy and yields a writable private buffer
+    shared = unshare_camera_metadata(shared);
+    ASSERT_NE((camera_metadata_t*)NULL, shared);
+    EXPECT_NE(m, shared);
+    EXPECT_FALSE(is_camera_metadata_shared(m));
+    EXPECT_FALSE(is_camera_metadata_shared(shared));
+
+    result = update_camera_metadata_entry(shared,
+            0, &exposure_time, 1, NULL);
+    EXPECT_EQ(OK, result);
+
+    // The original is untouched and writable again
+    camera_metadata_entry_t entry;
+    result = get_camera_metadata_entry(m, 0, &entry);
+    EXPECT_EQ(OK, result);
+    EXPECT_EQ(100, *entry.data.i64);
+
+    result = add_camera_metadata_entry(m,
+            ANDROID_REQUEST_FRAME_COUNT,
+            &exposure_count, 1);
+    EXPECT_EQ(OK, result);
+
+    // An unshared buffer passes through unshare_camera_metadata unchanged
+    EXPECT_EQ(m, unshare_camera_metadata(m));
+
+    FINISH_USING_CAMERA_METADATA(shared);
+    FINISH_USING_CAMERA_METADATA(m);
+}
+
+TEST(camera_metadata, pin_unpin_metadata) {
+    camera_metadata_t *m = NULL;
+    const size_t entry_capacity = 5;
+    const size_t data_capacity = 4096;
+
+    int result;
+
+    m = allocate_camera_metadata(entry_capacity, data_capacity);
+
+    // a large-array tag, the case pinning exists for
+    float shadingMap[9 * 7 * 4];
+    for (size_t i = 0; i < ARRAY_SIZE(shadingMap); i++) {
+        shadingMap[i] = 1.0f + i * 0.25f;
+    }
+    result = add_camera_metadata_entry(m,
+            ANDROID_STATISTICS_LENS_SHADING_MAP,
+            shadingMap, ARRAY_SIZE(shadingMap));
+    EXPECT_EQ(OK, result);
+
+    const camera_metadata_t *pinned = pin_camera_metadata(m);
+    ASSERT_EQ((const camera_metadata_t*)m, pinned);
+    EXPECT_TRUE(is_camera_metadata_shared(m));
+
+    // entry data is a zero-copy view into the pinned buffer
+    camera_metadata_ro_entry_t entry;
+    result = find_camera_metadata_ro_entry(pinned,
+            ANDROID_STATISTICS_LENS_SHADING_MAP, &entry);
+    EXPECT_EQ(OK, result);
+    EXPECT_EQ(ARRAY_SIZE(shadingMap), entry.count);
+    EXPECT_GE((const uint8_t*)entry.data.f, (const uint8_t*)pinned);
+    EXPECT_LT((const uint8_t*)entry.data.f,
+            (const uint8_t*)pinned + get_camera_metadata_size(pinned));
+    EXPECT_EQ(0, memcmp(entry.data.f, shadingMap, sizeof(shadingMap)));
+
+    // the buffer cannot be modified while pinned
+    int32_t sensitivity = 800;
+    result = add_camera_metadata_entry(m,
+            ANDROID_SENSOR_SENSITIVITY,
+            &sensitivity, 1);
+    EXPECT_EQ(ERROR, result);
+
+    unpin_camera_metadata(pinned);
+    EXPECT_FALSE(is_camera_metadata_shared(m));
+
+    // writable again after the last unpin
+    result = add_camera_metadata_entry(m,
+            ANDROID_SENSOR_SENSITIVITY,
+            &sensitivity, 1);
+    EXPECT_EQ(OK, result);
+
+    FINISH_USING_CAMERA_METADATA(m);
+}
+
 TEST(camera_metadata, delete_metadata) {
     camera_metadata_t *m = NULL;
     const size_t entry_capacity = 50;
@@ -1681,6 +2220,334 @@ TEST(camera_metadata, update_metadata) {
 
 }
 
+TEST(camera_metadata, batched_update_metadata) {
+    camera_metadata_t *m = NULL;
+    const size_t entry_capacity = 50;
+    const size_t data_capacity = 450;
+
+    int result;
+
+    m = allocate_camera_metadata(entry_capacity, data_capacity);
+
+    size_t num_entries = 5;
+    size_t data_per_entry =
+            calculate_camera_metadata_entry_data_size(TYPE_INT64, 1);
+    size_t num_data = num_entries * data_per_entry;
+
+    add_test_metadata(m, num_entries);
+
+    // Stage a mix of same-size, growing and shrinking updates,
+    // committed with a single compaction pass.
+    int64_t newExposureTime = 1000;
+    int64_t newExposures[2] = { 5000, 6000 };
+
+    camera_metadata_update_t *update = begin_camera_metadata_update(m);
+    EXPECT_NOT_NULL(update);
+
+    result = stage_camera_metadata_update(update, 0, &newExposureTime, 1);
+    EXPECT_EQ(OK, result);
+    result = stage_camera_metadata_update(update, 2, newExposures, 2);
+    EXPECT_EQ(OK, result);
+    // staging the same index again replaces the earlier staged data.
+    result = stage_camera_metadata_update(update, 0, newExposures, 2);
+    EXPECT_EQ(OK, result);
+    result = stage_camera_metadata_update(update, 0, &newExposureTime, 1);
+    EXPECT_EQ(OK, result);
+
+    // out of range index is rejected when staged.
+    result = stage_camera_metadata_update(update, num_entries, &newExposureTime, 1);
+    EXPECT_NE(OK, result);
+
+    result = commit_camera_metadata_update(update);
+    EXPECT_EQ(OK, result);
+    num_data += data_per_entry; // entry 2 grew by one element
+
+    EXPECT_EQ(num_entries, get_camera_metadata_entry_count(m));
+    EXPECT_EQ(num_data, get_camera_metadata_data_count(m));
+
+    for (size_t i = 0; i < num_entries; i++) {
+        camera_metadata_entry e;
+        result = get_camera_metadata_entry(m, i, &e);
+        EXPECT_EQ(OK, result);
+        EXPECT_EQ(i, e.index);
+        EXPECT_EQ(ANDROID_SENSOR_EXPOSURE_TIME, e.tag);
+        EXPECT_EQ(TYPE_INT64, e.type);
+        if (i == 0) {
+            EXPECT_EQ((size_t)1, e.count);
+            EXPECT_EQ(newExposureTime, *e.data.i64);
+        } else if (i == 2) {
+            EXPECT_EQ((size_t)2, e.count);
+            EXPECT_EQ(newExposures[0], e.data.i64[0]);
+            EXPECT_EQ(newExposures[1], e.data.i64[1]);
+        } else {
+            EXPECT_EQ((size_t)1, e.count);
+            int64_t exposureTime = 100 + 100 * i;
+            EXPECT_EQ(exposureTime, *e.data.i64);
+        }
+    }
+
+    // A commit overflowing the data capacity fails and leaves the buffer as is.
+    int64_t bigExposures[64];
+    for (size_t i = 0; i < ARRAY_SIZE(bigExposures); i++) {
+        bigExposures[i] = i;
+    }
+    update = begin_camera_metadata_update(m);
+    EXPECT_NOT_NULL(update);
+    result = stage_camera_metadata_update(update, 1,
+            bigExposures, ARRAY_SIZE(bigExposures));
+    EXPECT_EQ(OK, result);
+    result = commit_camera_metadata_update(update);
+    EXPECT_NE(OK, result);
+
+    EXPECT_EQ(num_entries, get_camera_metadata_entry_count(m));
+    EXPECT_EQ(num_data, get_camera_metadata_data_count(m));
+
+    // An aborted transaction does not modify the buffer.
+    update = begin_camera_metadata_update(m);
+    EXPECT_NOT_NULL(update);
+    result = stage_camera_metadata_update(update, 1, newExposures, 2);
+    EXPECT_EQ(OK, result);
+    abort_camera_metadata_update(update);
+
+    camera_metadata_entry e;
+    result = get_camera_metadata_entry(m, 1, &e);
+    EXPECT_EQ(OK, result);
+    EXPECT_EQ((size_t)1, e.count);
+    EXPECT_EQ(200, *e.data.i64);
+
+    FINISH_USING_CAMERA_METADATA(m);
+}
+
+TEST(camera_metadata, seal_metadata) {
+    camera_metadata_t *m = NULL;
+    const size_t entry_capacity = 5;
+    const size_t data_capacity = 128;
+
+    m = allocate_camera_metadata(entry_capacity, data_capacity);
+    ASSERT_NE((void*)NULL, (void*)m);
+
+    int64_t exposure_time = 1000000000;
+    EXPECT_EQ(OK, add_camera_metadata_entry(m,
+            ANDROID_SENSOR_EXPOSURE_TIME,
+            &exposure_time, 1));
+    int32_t sensitivity = 800;
+    EXPECT_EQ(OK, add_camera_metadata_entry(m,
+            ANDROID_SENSOR_SENSITIVITY,
+            &sensitivity, 1));
+    float colorCorrectionGains[] = {1.69f,  1.00f,  1.00f,  2.41f};
+    EXPECT_EQ(OK, add_camera_metadata_entry(m,
+            ANDROID_COLOR_CORRECTION_GAINS,
+            colorCorrectionGains, ARRAY_SIZE(colorCorrectionGains)));
+
+    // An unsealed buffer falls back to the full structural walk
+    EXPECT_EQ(OK, validate_sealed_camera_metadata(m, NULL));
+
+    EXPECT_EQ(OK, seal_camera_metadata(m));
+    size_t size = get_camera_metadata_size(m);
+    EXPECT_EQ(OK, validate_sealed_camera_metadata(m, &size));
+
+    // The seal survives a bitwise transfer of the packet
+    camera_metadata_t *received = (camera_metadata_t*)malloc(size);
+    ASSERT_NE((void*)NULL, (void*)received);
+    memcpy(received, m, size);
+    EXPECT_EQ(OK, validate_sealed_camera_metadata(received, &size));
+
+    // Unchecked reads on the validated packet match the checked ones
+    for (size_t i = 0; i < get_camera_metadata_entry_count(received); i++) {
+        camera_metadata_ro_entry_t entry, unchecked;
+        EXPECT_EQ(OK, get_camera_metadata_ro_entry(received, i, &entry));
+        get_camera_metadata_ro_entry_unchecked(received, i, &unchecked);
+        EXPECT_EQ(entry.tag, unchecked.tag);
+        EXPECT_EQ(entry.type, unchecked.type);
+        EXPECT_EQ(entry.count, unchecked.count);
+        EXPECT_EQ(entry.data.u8, unchecked.data.u8);
+    }
+    camera_metadata_ro_entry_t entry;
+    EXPECT_EQ(OK, find_camera_metadata_ro_entry_unchecked(received,
+            ANDROID_SENSOR_EXPOSURE_TIME, &entry));
+    EXPECT_EQ((size_t)1, entry.count);
+    EXPECT_EQ(exposure_time, entry.data.i64[0]);
+    EXPECT_EQ(NOT_FOUND, find_camera_metadata_ro_entry_unchecked(received,
+            ANDROID_CONTROL_AE_MODE, &entry));
+
+    // Header corruption after sealing must fail the O(1) check;
+    // entry_count is the uint32_t at byte offset 12.
+    uint32_t *header_words = (uint32_t*)received;
+    header_words[3]++;
+    EXPECT_EQ(CAMERA_METADATA_VALIDATION_ERROR,
+            validate_sealed_camera_metadata(received, &size));
+    header_words[3]--;
+    EXPECT_EQ(OK, validate_sealed_camera_metadata(received, &size));
+    free(received);
+
+    // Modification clears the seal; the buffer validates via the fallback
+    // walk and can be re-sealed.
+    int32_t new_sensitivity = 400;
+    EXPECT_EQ(OK, update_camera_metadata_entry(m, 1, &new_sensitivity, 1, NULL));
+    EXPECT_EQ(OK, validate_sealed_camera_metadata(m, NULL));
+    EXPECT_EQ(OK, seal_camera_metadata(m));
+    EXPECT_EQ(OK, validate_sealed_camera_metadata(m, NULL));
+
+    FINISH_USING_CAMERA_METADATA(m);
+}
+
+static void expect_metadata_equivalent(const camera_metadata_t *expected,
+        const camera_metadata_t *actual) {
+    ASSERT_EQ(get_camera_metadata_entry_count(expected),
+            get_camera_metadata_entry_count(actual));
+    for (size_t i = 0; i < get_camera_metadata_entry_count(expected); i++) {
+        camera_metadata_ro_entry_t want, got;
+        ASSERT_EQ(OK, get_camera_metadata_ro_entry(expected, i, &want));
+        ASSERT_EQ(OK, find_camera_metadata_ro_entry(actual, want.tag, &got));
+        EXPECT_EQ(want.type, got.type);
+        ASSERT_EQ(want.count, got.count);
+        EXPECT_EQ(0, memcmp(want.data.u8, got.data.u8,
+                want.count * camera_metadata_type_size[want.type]));
+    }
+}
+
+TEST(camera_metadata, diff_apply_metadata) {
+    camera_metadata_t *base = allocate_camera_metadata(5, 128);
+    camera_metadata_t *updated = allocate_camera_metadata(5, 128);
+    ASSERT_NE((void*)NULL, (void*)base);
+    ASSERT_NE((void*)NULL, (void*)updated);
+
+    int64_t exposure_time = 1000000000;
+    int32_t sensitivity = 800;
+    float focus_distance = 0.5f;
+    float gains[] = {1.69f, 1.00f, 1.00f, 2.41f};
+    EXPECT_EQ(OK, add_camera_metadata_entry(base,
+            ANDROID_SENSOR_EXPOSURE_TIME, &exposure_time, 1));
+    EXPECT_EQ(OK, add_camera_metadata_entry(base,
+            ANDROID_SENSOR_SENSITIVITY, &sensitivity, 1));
+    EXPECT_EQ(OK, add_camera_metadata_entry(base,
+            ANDROID_LENS_FOCUS_DISTANCE, &focus_distance, 1));
+    EXPECT_EQ(OK, add_camera_metadata_entry(base,
+            ANDROID_COLOR_CORRECTION_GAINS, gains, ARRAY_SIZE(gains)));
+
+    // updated: sensitivity changed, focus distance deleted, AE mode added,
+    // the other entries identical.
+    int32_t new_sensitivity = 400;
+    uint8_t ae_mode = 1;
+    EXPECT_EQ(OK, add_camera_metadata_entry(updated,
+            ANDROID_SENSOR_EXPOSURE_TIME, &exposure_time, 1));
+    EXPECT_EQ(OK, add_camera_metadata_entry(updated,
+            ANDROID_SENSOR_SENSITIVITY, &new_sensitivity, 1));
+    EXPECT_EQ(OK, add_camera_metadata_entry(updated,
+            ANDROID_COLOR_CORRECTION_GAINS, gains, ARRAY_SIZE(gains)));
+    EXPECT_EQ(OK, add_camera_metadata_entry(updated,
+            ANDROID_CONTROL_AE_MODE, &ae_mode, 1));
+
+    camera_metadata_patch_t *patch = diff_camera_metadata(base, updated);
+    ASSERT_NE((void*)NULL, (void*)patch);
+    size_t patch_size = get_camera_metadata_patch_size(patch);
+    EXPECT_TRUE(patch_size > 0);
+    // The point of the patch: smaller than shipping the full packet
+    EXPECT_LT(patch_size, get_camera_metadata_size(updated));
+
+    // Simulate IPC: only patch_size bytes cross the process boundary
+    camera_metadata_patch_t *received =
+            (camera_metadata_patch_t*)malloc(patch_size);
+    ASSERT_NE((void*)NULL, (void*)received);
+    memcpy(received, patch, patch_size);
+    free_camera_metadata_patch(patch);
+
+    camera_metadata_t *result = apply_camera_metadata_patch(base, received);
+    ASSERT_NE((void*)NULL, (void*)result);
+    expect_metadata_equivalent(updated, result);
+
+    // A patch only applies to the base packet it was diffed against
+    EXPECT_NULL(apply_camera_metadata_patch(updated, received));
+    free_camera_metadata_patch(received);
+    free_camera_metadata(result);
+
+    // An identity diff produces an empty patch that still round-trips
+    camera_metadata_patch_t *empty = diff_camera_metadata(base, base);
+    ASSERT_NE((void*)NULL, (void*)empty);
+    EXPECT_LT(get_camera_metadata_patch_size(empty),
+            get_camera_metadata_size(base));
+    camera_metadata_t *same = apply_camera_metadata_patch(base, empty);
+    ASSERT_NE((void*)NULL, (void*)same);
+    expect_metadata_equivalent(base, same);
+    free_camera_metadata_patch(empty);
+    free_camera_metadata(same);
+
+    FINISH_USING_CAMERA_METADATA(base);
+    FINISH_USING_CAMERA_METADATA(updated);
+}
+
+TEST(camera_metadata, builder_metadata) {
+    camera_metadata_builder_t *builder = allocate_camera_metadata_builder();
+    ASSERT_NE((void*)NULL, (void*)builder);
+
+    int64_t exposure_time = 1000000000;
+    int32_t sensitivity = 800;
+    float gains[] = {1.69f, 1.00f, 1.00f, 2.41f};
+    // large enough to span multiple builder data chunks
+    std::vector<int32_t> curve(4096);
+    for (size_t i = 0; i < curve.size(); i++) {
+        curve[i] = (int32_t)i;
+    }
+
+    EXPECT_EQ(OK, add_camera_metadata_builder_entry(builder,
+            ANDROID_SENSOR_EXPOSURE_TIME, &exposure_time, 1));
+    EXPECT_EQ(OK, add_camera_metadata_builder_entry(builder,
+            ANDROID_SENSOR_SENSITIVITY, &sensitivity, 1));
+    EXPECT_EQ(OK, add_camera_metadata_builder_entry(builder,
+            ANDROID_COLOR_CORRECTION_GAINS, gains, ARRAY_SIZE(gains)));
+    EXPECT_EQ(OK, add_camera_metadata_builder_entry(builder,
+            ANDROID_TONEMAP_CURVE_RED, curve.data(), curve.size()));
+    // unknown tags are rejected like add_camera_metadata_entry
+    EXPECT_NE(OK, add_camera_metadata_builder_entry(builder,
+            0xDEADBEEF, &sensitivity, 1));
+
+    camera_metadata_t *m = finish_camera_metadata_builder(builder);
+    ASSERT_NE((void*)NULL, (void*)m);
+
+    // Perfectly sized: no unused capacity
+    EXPECT_EQ((size_t)4, get_camera_metadata_entry_count(m));
+    EXPECT_EQ(get_camera_metadata_entry_count(m),
+            get_camera_metadata_entry_capacity(m));
+    EXPECT_EQ(get_camera_metadata_data_count(m),
+            get_camera_metadata_data_capacity(m));
+    EXPECT_EQ(get_camera_metadata_size(m),
+            get_camera_metadata_compact_size(m));
+
+    camera_metadata_ro_entry_t entry;
+    EXPECT_EQ(OK, find_camera_metadata_ro_entry(m,
+            ANDROID_SENSOR_EXPOSURE_TIME, &entry));
+    EXPECT_EQ(exposure_time, entry.data.i64[0]);
+    EXPECT_EQ(OK, find_camera_metadata_ro_entry(m,
+            ANDROID_SENSOR_SENSITIVITY, &entry));
+    EXPECT_EQ(sensitivity, entry.data.i32[0]);
+    EXPECT_EQ(OK, find_camera_metadata_ro_entry(m,
+            ANDROID_COLOR_CORRECTION_GAINS, &entry));
+    ASSERT_EQ(ARRAY_SIZE(gains), entry.count);
+    EXPECT_EQ(0, memcmp(gains, entry.data.f, sizeof(gains)));
+    EXPECT_EQ(OK, find_camera_metadata_ro_entry(m,
+            ANDROID_TONEMAP_CURVE_RED, &entry));
+    ASSERT_EQ(curve.size(), entry.count);
+    EXPECT_EQ(0, memcmp(curve.data(), entry.data.i32,
+            curve.size() * sizeof(int32_t)));
+
+    FINISH_USING_CAMERA_METADATA(m);
+
+    // An empty builder produces a valid empty packet
+    builder = allocate_camera_metadata_builder();
+    ASSERT_NE((void*)NULL, (void*)builder);
+    m = finish_camera_metadata_builder(builder);
+    ASSERT_NE((void*)NULL, (void*)m);
+    EXPECT_EQ((size_t)0, get_camera_metadata_entry_count(m));
+    FINISH_USING_CAMERA_METADATA(m);
+
+    // Discarding a builder without finishing it is allowed
+    builder = allocate_camera_metadata_builder();
+    ASSERT_NE((void*)NULL, (void*)builder);
+    EXPECT_EQ(OK, add_camera_metadata_builder_entry(builder,
+            ANDROID_SENSOR_SENSITIVITY, &sensitivity, 1));
+    free_camera_metadata_builder(builder);
+}
+
 TEST(camera_metadata, memcpy) {
     camera_metadata_t *m = NULL;
     const size_t entry_capacity = 50;
@@ -1793,19 +2660,22 @@ TEST(camera_metadata, data_alignment) {
         TYPE_FLOAT,
         TYPE_INT64,
         TYPE_DOUBLE,
-        TYPE_RATIONAL
+        TYPE_RATIONAL,
+        TYPE_EXTERNAL
     };
     const size_t (&m_type_sizes)[NUM_TYPES] = camera_metadata_type_size;
     size_t m_type_align[] = {
-        _Alignas(uint8_t),                    // BYTE
-        _Alignas(int32_t),                    // INT32
-        _Alignas(float),                      // FLOAT
-        _Alignas(int64_t),                    // INT64
-        _Alignas(double),                     // DOUBLE
-        _Alignas(camera_metadata_rational_t), // RATIONAL
+        _Alignas(uint8_t),                         // BYTE
+        _Alignas(int32_t),                         // INT32
+        _Alignas(float),                           // FLOAT
+        _Alignas(int64_t),                         // INT64
+        _Alignas(double),                          // DOUBLE
+        _Alignas(camera_metadata_rational_t),      // RATIONAL
+        _Alignas(camera_metadata_external_blob_t), // EXTERNAL
     };
     /* arbitrary tags. the important thing is that their type
-       corresponds to m_type_sizes[i]
+       corresponds to m_type_sizes[i].  No ANDROID tag has TYPE_EXTERNAL,
+       so that slot uses a fake vendor tag.
        */
     int m_type_tags[] = {
         ANDROID_REQUEST_TYPE,
@@ -1813,8 +2683,10 @@ TEST(camera_metadata, data_alignment) {
         ANDROID_LENS_FOCUS_DISTANCE,
         ANDROID_SENSOR_EXPOSURE_TIME,
         ANDROID_JPEG_GPS_COORDINATES,
-        ANDROID_CONTROL_AE_COMPENSATION_STEP
+        ANDROID_CONTROL_AE_COMPENSATION_STEP,
+        FAKEVENDOR_SENSOR_DEPTH_MAP
     };
+    set_camera_metadata_vendor_ops(&fakevendor_ops);
 
     /*
     if the asserts fail, its because we added more types.
@@ -1869,6 +2741,7 @@ TEST(camera_metadata, data_alignment) {
             }
         }
     }
+    set_camera_metadata_vendor_ops(NULL);
 }
 
 TEST(camera_metadata, buffer_alignment) {
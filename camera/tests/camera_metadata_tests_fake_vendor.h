@@ -46,6 +46,7 @@ enum vendor_extension_section_ranges {
 enum vendor_extension_tags {
     FAKEVENDOR_SENSOR_SUPERMODE = FAKEVENDOR_SENSOR_START,
     FAKEVENDOR_SENSOR_DOUBLE_EXPOSURE,
+    FAKEVENDOR_SENSOR_DEPTH_MAP,
     FAKEVENDOR_SENSOR_END,
 
     FAKEVENDOR_SENSOR_AVAILABLE_SUPERMODES = FAKEVENDOR_SENSOR_I_START,
@@ -82,7 +83,8 @@ uint32_t fakevendor_section_bounds[FAKEVENDOR_SECTION_COUNT][2] = {
 vendor_tag_info_t fakevendor_sensor[FAKEVENDOR_SENSOR_END -
         FAKEVENDOR_SENSOR_START] = {
     { "superMode",       TYPE_BYTE },
-    { "doubleExposure",  TYPE_INT64 }
+    { "doubleExposure",  TYPE_INT64 },
+    { "depthMap",        TYPE_EXTERNAL }
 };
 
 vendor_tag_info_t fakevendor_sensor_info[FAKEVENDOR_SENSOR_I_END -
@@ -117,6 +119,8 @@ int get_fakevendor_tag_type(const vendor_tag_ops_t *v,
         uint32_t tag);
 int get_fakevendor_tag_count(const vendor_tag_ops_t *v);
 void get_fakevendor_tags(const vendor_tag_ops_t *v, uint32_t *tag_array);
+int get_fakevendor_tag_descriptors(const vendor_tag_ops_t *v,
+        vendor_tag_descriptor_v1_t *descriptor_array, int count);
 
 static const vendor_tag_ops_t fakevendor_ops = {
     get_fakevendor_tag_count,
@@ -124,12 +128,24 @@ static const vendor_tag_ops_t fakevendor_ops = {
     get_fakevendor_section_name,
     get_fakevendor_tag_name,
     get_fakevendor_tag_type,
+    NULL, // get_all_tag_descriptors, exercises the per-tag fallback
+    {NULL}
+};
+
+// same tag set, but with the batched enumeration call implemented
+static const vendor_tag_ops_t fakevendor_batched_ops = {
+    get_fakevendor_tag_count,
+    get_fakevendor_tags,
+    get_fakevendor_section_name,
+    get_fakevendor_tag_name,
+    get_fakevendor_tag_type,
+    get_fakevendor_tag_descriptors,
     {NULL}
 };
 
 const char *get_fakevendor_section_name(const vendor_tag_ops_t *v,
         uint32_t tag) {
-    if (v != &fakevendor_ops) return NULL;
+    if (v != &fakevendor_ops && v != &fakevendor_batched_ops) return NULL;
     int tag_section = (tag >> 16) - VENDOR_SECTION;
     if (tag_section < 0 ||
             tag_section >= FAKEVENDOR_SECTION_COUNT) return NULL;
@@ -139,7 +155,7 @@ const char *get_fakevendor_section_name(const vendor_tag_ops_t *v,
 
 const char *get_fakevendor_tag_name(const vendor_tag_ops_t *v,
         uint32_t tag) {
-    if (v != &fakevendor_ops) return NULL;
+    if (v != &fakevendor_ops && v != &fakevendor_batched_ops) return NULL;
     int tag_section = (tag >> 16) - VENDOR_SECTION;
     if (tag_section < 0
             || tag_section >= FAKEVENDOR_SECTION_COUNT
@@ -150,7 +166,7 @@ const char *get_fakevendor_tag_name(const vendor_tag_ops_t *v,
 
 int get_fakevendor_tag_type(const vendor_tag_ops_t *v,
         uint32_t tag) {
-    if (v != &fakevendor_ops) return -1;
+    if (v != &fakevendor_ops && v != &fakevendor_batched_ops) return -1;
     int tag_section = (tag >> 16) - VENDOR_SECTION;
     if (tag_section < 0
             || tag_section >= FAKEVENDOR_SECTION_COUNT
@@ -164,7 +180,7 @@ int get_fakevendor_tag_count(const vendor_tag_ops_t *v) {
     unsigned int start, end;
     int count = 0;
 
-    if (v != &fakevendor_ops) return -1;
+    if (v != &fakevendor_ops && v != &fakevendor_batched_ops) return -1;
     for (section = 0; section < FAKEVENDOR_SECTION_COUNT; section++) {
         start = fakevendor_section_bounds[section][0];
         end = fakevendor_section_bounds[section][1];
@@ -177,7 +193,8 @@ void get_fakevendor_tags(const vendor_tag_ops_t *v, uint32_t *tag_array) {
     int section;
     unsigned int start, end, tag;
 
-    if (v != &fakevendor_ops || tag_array == NULL) return;
+    if ((v != &fakevendor_ops && v != &fakevendor_batched_ops)
+            || tag_array == NULL) return;
     for (section = 0; section < FAKEVENDOR_SECTION_COUNT; section++) {
         start = fakevendor_section_bounds[section][0];
         end = fakevendor_section_bounds[section][1];
@@ -187,4 +204,25 @@ void get_fakevendor_tags(const vendor_tag_ops_t *v, uint32_t *tag_array) {
     }
 }
 
+int get_fakevendor_tag_descriptors(const vendor_tag_ops_t *v,
+        vendor_tag_descriptor_v1_t *descriptor_array, int count) {
+    int section;
+    unsigned int start, end, tag;
+    int filled = 0;
+
+    if (v != &fakevendor_batched_ops || descriptor_array == NULL) return -1;
+    for (section = 0; section < FAKEVENDOR_SECTION_COUNT; section++) {
+        start = fakevendor_section_bounds[section][0];
+        end = fakevendor_section_bounds[section][1];
+        for (tag = start; tag < end && filled < count; tag++) {
+            vendor_tag_descriptor_v1_t *descriptor = &descriptor_array[filled++];
+            descriptor->tag = tag;
+            descriptor->type = get_fakevendor_tag_type(v, tag);
+            descriptor->section_name = get_fakevendor_section_name(v, tag);
+            descriptor->tag_name = get_fakevendor_tag_name(v, tag);
+        }
+    }
+    return filled;
+}
+
 #endif
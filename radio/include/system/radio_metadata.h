@@ -55,6 +55,8 @@ enum {
                                                 RADIO_METADATA_TEXT_LEN_MAX length including NUL. */
     RADIO_METADATA_TYPE_RAW        = 2,      /* raw binary data (icon or art) */
     RADIO_METADATA_TYPE_CLOCK      = 3,      /* clock data, see radio_metadata_clock_t */
+    RADIO_METADATA_TYPE_FD         = 4,      /* shared memory reference to raw binary data,
+                                                see radio_metadata_fd_t */
 };
 typedef int32_t radio_metadata_type_t;
 
@@ -63,6 +65,19 @@ typedef struct radio_metadata_clock {
     int32_t timezone_offset_in_minutes;       /* Minutes offset from the GMT. */
 } radio_metadata_clock_t;
 
+/*
+ * Reference to raw metadata (icon or art) stored in an ashmem region, added with
+ * radio_metadata_add_raw_fd(). The meta data buffer does not own the file descriptor:
+ * the caller must keep it open for as long as the buffer is in use and close it
+ * afterwards. When the buffer crosses a process boundary the transport must pass the
+ * descriptor out of band (e.g. dup it into the parcel) and rewrite the entry on the
+ * receiving side; the raw integer value is only meaningful in the sending process.
+ */
+typedef struct radio_metadata_fd {
+    int         fd;            /* ashmem file descriptor */
+    uint32_t    size;          /* size in bytes of the data in the region */
+} radio_metadata_fd_t;
+
 /*
  * Return the type of the meta data corresponding to the key specified
  *
@@ -93,6 +108,33 @@ int radio_metadata_allocate(radio_metadata_t **metadata,
                             const uint32_t channel,
                             const uint32_t sub_channel);
 
+/*
+ * Allocate a meta data buffer sized for the entries announced by the caller.
+ * The buffer can hold count_hint entries totaling size_hint bytes of values
+ * (text lengths including the NUL terminator) without being re-allocated by
+ * radio_metadata_add_xxx(), plus the index table added by radio_metadata_seal().
+ * Use when the entries to be added are known in advance, e.g. when a tuner
+ * rebuilds the meta data for every program information update.
+ *
+ * arguments:
+ * - metadata: the address where the allocated meta data buffer should be returned.
+ * - channel: channel (frequency) this meta data is associated with.
+ * - sub_channel: sub channel this meta data is associated with.
+ * - count_hint: number of entries that will be added.
+ * - size_hint: total size in bytes of the entry values that will be added.
+ *
+ * returns:
+ *  0 if successfully allocated
+ *  -ENOMEM if meta data buffer cannot be allocated or the hinted size exceeds the
+ *  maximum buffer size
+ */
+ANDROID_API
+int radio_metadata_allocate_hint(radio_metadata_t **metadata,
+                                 const uint32_t channel,
+                                 const uint32_t sub_channel,
+                                 const uint32_t count_hint,
+                                 const size_t size_hint);
+
 /*
  * De-allocate a meta data buffer.
  *
@@ -161,6 +203,33 @@ int radio_metadata_add_raw(radio_metadata_t **metadata,
                            const unsigned char *value,
                            const size_t size);
 
+/*
+ * Add a reference to raw meta data held in an ashmem region to the buffer.
+ * Unlike radio_metadata_add_raw(), the data itself is not copied into the buffer:
+ * only a radio_metadata_fd_t entry is added, so large blobs (album art) can cross
+ * process boundaries by fd passing instead of being copied with the buffer.
+ * The key must accept raw meta data. See radio_metadata_fd_t for the ownership
+ * and transport rules applying to the file descriptor.
+ *
+ * arguments:
+ * - metadata: the address of the meta data buffer. I/O. the meta data can be modified if the
+ * buffer is re-allocated
+ * - key: the meta data key.
+ * - fd: the ashmem file descriptor holding the meta data value.
+ * - size: size in bytes of the meta data value in the region.
+ *
+ * returns:
+ *  0 if successfully added
+ *  -EINVAL if the buffer passed is invalid, the key does not match a raw type, fd is not
+ *  a valid ashmem file descriptor or size is zero or exceeds the region size
+ *  -ENOMEM if meta data buffer cannot be re-allocated
+ */
+ANDROID_API
+int radio_metadata_add_raw_fd(radio_metadata_t **metadata,
+                              const radio_metadata_key_t key,
+                              const int fd,
+                              const size_t size);
+
 /*
  * Add a clock meta data to the buffer.
  *
@@ -180,6 +249,58 @@ int radio_metadata_add_clock(radio_metadata_t **metadata,
                              const radio_metadata_key_t key,
                              const radio_metadata_clock_t *clock);
 
+/*
+ * Replace a meta data entry in the buffer.
+ * The radio_metadata_replace_xxx() functions replace the value of the first entry
+ * with the specified key, or add the entry if the key is absent, with the same
+ * argument validation as the radio_metadata_add_xxx() counterparts.
+ * When the new value is no larger than the space already allocated to the entry it
+ * is written in place: the buffer is not re-allocated, the other entries are not
+ * moved and the index table written by radio_metadata_seal() remains valid, so a
+ * tuner pushing frequent updates of a few fields (e.g. RDS RT) does not rebuild
+ * the packet. The slack left by smaller values is reclaimed by an internal
+ * compaction once it exceeds a fraction of the buffer; a compaction or a value
+ * that must grow the entry reverts the buffer to linear key lookups like
+ * radio_metadata_add_xxx() does.
+ *
+ * arguments:
+ * - metadata: the address of the meta data buffer. I/O. the meta data can be modified if the
+ * buffer is re-allocated
+ * - key: the meta data key.
+ * - value (fd, size / clock): the meta data value, as for the add counterpart.
+ *
+ * returns:
+ *  0 if successfully replaced or added
+ *  -EINVAL under the same conditions as the add counterpart
+ *  -ENOMEM if meta data buffer cannot be re-allocated
+ */
+ANDROID_API
+int radio_metadata_replace_int(radio_metadata_t **metadata,
+                               const radio_metadata_key_t key,
+                               const int32_t value);
+
+ANDROID_API
+int radio_metadata_replace_text(radio_metadata_t **metadata,
+                                const radio_metadata_key_t key,
+                                const char *value);
+
+ANDROID_API
+int radio_metadata_replace_raw(radio_metadata_t **metadata,
+                               const radio_metadata_key_t key,
+                               const unsigned char *value,
+                               const size_t size);
+
+ANDROID_API
+int radio_metadata_replace_raw_fd(radio_metadata_t **metadata,
+                                  const radio_metadata_key_t key,
+                                  const int fd,
+                                  const size_t size);
+
+ANDROID_API
+int radio_metadata_replace_clock(radio_metadata_t **metadata,
+                                 const radio_metadata_key_t key,
+                                 const radio_metadata_clock_t *clock);
+
 /*
  * add all meta data in source buffer to destinaiton buffer.
  *
@@ -196,6 +317,26 @@ ANDROID_API
 int radio_metadata_add_metadata(radio_metadata_t **dst_metadata,
                            radio_metadata_t *src_metadata);
 
+/*
+ * Seal a meta data buffer once all entries have been added.
+ * A key to entry index table is built inside the buffer so that subsequent
+ * radio_metadata_get_from_key() calls are O(1) instead of walking the entries,
+ * and the buffer is trimmed to the size actually used.
+ * Adding an entry after sealing is allowed and reverts the buffer to linear
+ * key lookups.
+ *
+ * arguments:
+ * - metadata: the address of the meta data buffer. I/O. the meta data can be modified if the
+ * buffer is re-allocated.
+ *
+ * returns:
+ *  0 if successfully sealed
+ *  -EINVAL if the buffer passed is invalid
+ *  -ENOMEM if meta data buffer cannot be re-allocated
+ */
+ANDROID_API
+int radio_metadata_seal(radio_metadata_t **metadata);
+
 /*
  * Perform sanity check on a meta data buffer.
  *
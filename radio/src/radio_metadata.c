@@ -22,6 +22,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <cutils/ashmem.h>
 #include <log/log.h>
 
 #include <system/radio.h>
@@ -100,6 +101,13 @@ int check_size(radio_metadata_buffer_t **metadata_ptr, const uint32_t size_int)
     return 0;
 }
 
+/* size in 32 bit units used by an entry with a payload of size bytes */
+static uint32_t entry_size_int(const size_t size)
+{
+    return (uint32_t)(size + sizeof(radio_metadata_entry_t) + sizeof(uint32_t) - 1) /
+            sizeof(uint32_t);
+}
+
 /* checks on size and key validity are done before calling this function */
 int add_metadata(radio_metadata_buffer_t **metadata_ptr,
                  const radio_metadata_key_t key,
@@ -107,17 +115,16 @@ int add_metadata(radio_metadata_buffer_t **metadata_ptr,
                  const void *value,
                  const size_t size)
 {
-    uint32_t entry_size_int;
+    uint32_t size_int;
     int ret;
     radio_metadata_entry_t *entry;
     uint32_t index_offset;
     uint32_t data_offset;
     radio_metadata_buffer_t *metadata = *metadata_ptr;
 
-    entry_size_int = (uint32_t)(size + sizeof(radio_metadata_entry_t));
-    entry_size_int = (entry_size_int + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+    size_int = entry_size_int(size);
 
-    ret = check_size(metadata_ptr, entry_size_int);
+    ret = check_size(metadata_ptr, size_int);
     if (ret < 0) {
         return ret;
     }
@@ -131,9 +138,11 @@ int add_metadata(radio_metadata_buffer_t **metadata_ptr,
     entry->size = (uint32_t)size;
     memcpy(entry->data, value, size);
 
-    data_offset += entry_size_int;
+    data_offset += size_int;
     *((uint32_t *)metadata + index_offset -1) = data_offset;
     metadata->count++;
+    /* the new entry overwrites the free space holding the key table, if any */
+    metadata->key_table_offset = 0;
 
     return 0;
 }
@@ -175,6 +184,111 @@ radio_metadata_entry_t *get_entry_at_index(
     return (radio_metadata_entry_t *)((uint32_t *)metadata + data_offset);
 }
 
+/* size in 32 bit units allocated to the entry at index: the distance to the next
+ * entry (or to the free space for the last entry), which can exceed the used size
+ * after an in-place replacement by a smaller payload */
+static uint32_t entry_span_int(const radio_metadata_buffer_t *metadata, const unsigned index)
+{
+    uint32_t offset = *((uint32_t *)metadata + metadata->size_int - index - 1);
+    uint32_t next_offset = *((uint32_t *)metadata + metadata->size_int - index - 2);
+    return next_offset - offset;
+}
+
+/* total slack in 32 bit units left between entries by in-place replacements */
+static uint32_t fragmentation_int(const radio_metadata_buffer_t *metadata)
+{
+    uint32_t index;
+    uint32_t slack_int = 0;
+
+    for (index = 0; index < metadata->count; index++) {
+        radio_metadata_entry_t *entry = get_entry_at_index(metadata, index, false);
+        slack_int += entry_span_int(metadata, index) - entry_size_int(entry->size);
+    }
+    return slack_int;
+}
+
+/* repack the entries tightly, reclaiming the slack left by in-place replacements.
+ * entry indices are unchanged but the key table location is lost, as when adding */
+static void compact_metadata(radio_metadata_buffer_t *metadata)
+{
+    uint32_t index;
+    uint32_t offset = (sizeof(radio_metadata_buffer_t) + sizeof(uint32_t) - 1) /
+            sizeof(uint32_t);
+
+    for (index = 0; index < metadata->count; index++) {
+        radio_metadata_entry_t *entry = get_entry_at_index(metadata, index, false);
+        uint32_t used_int = entry_size_int(entry->size);
+        if ((uint32_t *)metadata + offset != (uint32_t *)entry) {
+            memmove((uint32_t *)metadata + offset, entry, used_int * sizeof(uint32_t));
+        }
+        *((uint32_t *)metadata + metadata->size_int - index - 1) = offset;
+        offset += used_int;
+    }
+    *((uint32_t *)metadata + metadata->size_int - metadata->count - 1) = offset;
+    metadata->key_table_offset = 0;
+}
+
+/* remove the entry at index, moving the entries after it down and re-indexing them.
+ * entry indices change so the key table location is lost, as when adding */
+static void remove_entry_at_index(radio_metadata_buffer_t *metadata, const unsigned index)
+{
+    uint32_t span_int = entry_span_int(metadata, index);
+    uint32_t offset = *((uint32_t *)metadata + metadata->size_int - index - 1);
+    uint32_t free_offset = *((uint32_t *)metadata + metadata->size_int - metadata->count - 1);
+    uint32_t idx;
+
+    memmove((uint32_t *)metadata + offset,
+            (uint32_t *)metadata + offset + span_int,
+            (free_offset - offset - span_int) * sizeof(uint32_t));
+    /* entries after index shift down one index slot with their offsets reduced */
+    for (idx = index; idx < metadata->count - 1; idx++) {
+        *((uint32_t *)metadata + metadata->size_int - idx - 1) =
+                *((uint32_t *)metadata + metadata->size_int - idx - 2) - span_int;
+    }
+    *((uint32_t *)metadata + metadata->size_int - metadata->count) = free_offset - span_int;
+    metadata->count--;
+    metadata->key_table_offset = 0;
+}
+
+/* checks on size and key validity are done before calling this function.
+ * replaces the first entry with the given key, in place when the new payload fits
+ * in the space allocated to the entry, otherwise by removing and re-adding it.
+ * adds the entry if the key is absent. */
+static int replace_metadata(radio_metadata_buffer_t **metadata_ptr,
+                            const radio_metadata_key_t key,
+                            const radio_metadata_type_t type,
+                            const void *value,
+                            const size_t size)
+{
+    radio_metadata_buffer_t *metadata = *metadata_ptr;
+    radio_metadata_entry_t *entry = NULL;
+    uint32_t index;
+
+    for (index = 0; index < metadata->count; entry = NULL, index++) {
+        entry = get_entry_at_index(metadata, index, false);
+        if (entry->key == key) {
+            break;
+        }
+    }
+    if (entry == NULL) {
+        return add_metadata(metadata_ptr, key, type, value, size);
+    }
+
+    if (entry_size_int(size) <= entry_span_int(metadata, index)) {
+        entry->type = type;
+        entry->size = (uint32_t)size;
+        memcpy(entry->data, value, size);
+        /* in-place replacement preserves entry indices and thus the key table.
+         * defer reclaiming the slack until it exceeds a quarter of the buffer */
+        if (fragmentation_int(metadata) > metadata->size_int / RADIO_METADATA_COMPACT_DIV) {
+            compact_metadata(metadata);
+        }
+        return 0;
+    }
+    remove_entry_at_index(metadata, index);
+    return add_metadata(metadata_ptr, key, type, value, size);
+}
+
 /**
  * metadata API functions
  */
@@ -187,26 +301,58 @@ radio_metadata_type_t radio_metadata_type_of_key(const radio_metadata_key_t key)
     return metadata_key_type_table[key - RADIO_METADATA_KEY_MIN];
 }
 
-int radio_metadata_allocate(radio_metadata_t **metadata,
-                            const uint32_t channel,
-                            const uint32_t sub_channel)
+static int allocate_metadata(radio_metadata_t **metadata,
+                             const uint32_t channel,
+                             const uint32_t sub_channel,
+                             const uint32_t size_int)
 {
     radio_metadata_buffer_t *metadata_buf =
-            (radio_metadata_buffer_t *)calloc(RADIO_METADATA_DEFAULT_SIZE, sizeof(uint32_t));
+            (radio_metadata_buffer_t *)calloc(size_int, sizeof(uint32_t));
     if (metadata_buf == NULL) {
         return -ENOMEM;
     }
 
     metadata_buf->channel = channel;
     metadata_buf->sub_channel = sub_channel;
-    metadata_buf->size_int = RADIO_METADATA_DEFAULT_SIZE;
-    *((uint32_t *)metadata_buf + RADIO_METADATA_DEFAULT_SIZE - 1) =
+    metadata_buf->size_int = size_int;
+    *((uint32_t *)metadata_buf + size_int - 1) =
             (sizeof(radio_metadata_buffer_t) + sizeof(uint32_t) - 1) /
                 sizeof(uint32_t);
     *metadata = (radio_metadata_t *)metadata_buf;
     return 0;
 }
 
+int radio_metadata_allocate(radio_metadata_t **metadata,
+                            const uint32_t channel,
+                            const uint32_t sub_channel)
+{
+    return allocate_metadata(metadata, channel, sub_channel, RADIO_METADATA_DEFAULT_SIZE);
+}
+
+int radio_metadata_allocate_hint(radio_metadata_t **metadata,
+                                 const uint32_t channel,
+                                 const uint32_t sub_channel,
+                                 const uint32_t count_hint,
+                                 const size_t size_hint)
+{
+    uint32_t size_int;
+
+    /* header and free space offset */
+    size_int = (sizeof(radio_metadata_buffer_t) + sizeof(uint32_t) - 1) / sizeof(uint32_t) + 1;
+    /* one entry header and one index entry per announced entry */
+    size_int += count_hint *
+            ((sizeof(radio_metadata_entry_t) + sizeof(uint32_t) - 1) / sizeof(uint32_t) + 1);
+    /* entry values, each padded to a 32 bit boundary in the worst case */
+    size_int += (uint32_t)(size_hint + count_hint * (sizeof(uint32_t) - 1)) / sizeof(uint32_t);
+    /* free space for the key table written by radio_metadata_seal() */
+    size_int += RADIO_METADATA_KEY_TABLE_SIZE_INT;
+
+    if (size_int > RADIO_METADATA_MAX_SIZE) {
+        return -ENOMEM;
+    }
+    return allocate_metadata(metadata, channel, sub_channel, size_int);
+}
+
 void radio_metadata_deallocate(radio_metadata_t *metadata)
 {
     free(metadata);
@@ -248,6 +394,31 @@ int radio_metadata_add_raw(radio_metadata_t **metadata,
     return add_metadata((radio_metadata_buffer_t **)metadata, key, type, value, size);
 }
 
+int radio_metadata_add_raw_fd(radio_metadata_t **metadata,
+                              const radio_metadata_key_t key,
+                              const int fd,
+                              const size_t size)
+{
+    radio_metadata_type_t type = radio_metadata_type_of_key(key);
+    radio_metadata_fd_t value;
+    int region_size;
+
+    if (metadata == NULL || *metadata == NULL || type != RADIO_METADATA_TYPE_RAW || size == 0) {
+        return -EINVAL;
+    }
+    if (!ashmem_valid(fd)) {
+        return -EINVAL;
+    }
+    region_size = ashmem_get_size_region(fd);
+    if (region_size < 0 || (size_t)region_size < size) {
+        return -EINVAL;
+    }
+    value.fd = fd;
+    value.size = (uint32_t)size;
+    return add_metadata((radio_metadata_buffer_t **)metadata,
+                        key, RADIO_METADATA_TYPE_FD, &value, sizeof(value));
+}
+
 int radio_metadata_add_clock(radio_metadata_t **metadata,
                              const radio_metadata_key_t key,
                              const radio_metadata_clock_t *clock) {
@@ -261,6 +432,83 @@ int radio_metadata_add_clock(radio_metadata_t **metadata,
         (radio_metadata_buffer_t **)metadata, key, type, clock, sizeof(radio_metadata_clock_t));
 }
 
+int radio_metadata_replace_int(radio_metadata_t **metadata,
+                               const radio_metadata_key_t key,
+                               const int32_t value)
+{
+    radio_metadata_type_t type = radio_metadata_type_of_key(key);
+    if (metadata == NULL || *metadata == NULL || type != RADIO_METADATA_TYPE_INT) {
+        return -EINVAL;
+    }
+    return replace_metadata((radio_metadata_buffer_t **)metadata,
+                            key, type, &value, sizeof(int32_t));
+}
+
+int radio_metadata_replace_text(radio_metadata_t **metadata,
+                                const radio_metadata_key_t key,
+                                const char *value)
+{
+    radio_metadata_type_t type = radio_metadata_type_of_key(key);
+    if (metadata == NULL || *metadata == NULL || type != RADIO_METADATA_TYPE_TEXT ||
+            value == NULL || strlen(value) >= RADIO_METADATA_TEXT_LEN_MAX) {
+        return -EINVAL;
+    }
+    return replace_metadata((radio_metadata_buffer_t **)metadata,
+                            key, type, value, strlen(value) + 1);
+}
+
+int radio_metadata_replace_raw(radio_metadata_t **metadata,
+                               const radio_metadata_key_t key,
+                               const unsigned char *value,
+                               const size_t size)
+{
+    radio_metadata_type_t type = radio_metadata_type_of_key(key);
+    if (metadata == NULL || *metadata == NULL || type != RADIO_METADATA_TYPE_RAW ||
+            value == NULL) {
+        return -EINVAL;
+    }
+    return replace_metadata((radio_metadata_buffer_t **)metadata, key, type, value, size);
+}
+
+int radio_metadata_replace_raw_fd(radio_metadata_t **metadata,
+                                  const radio_metadata_key_t key,
+                                  const int fd,
+                                  const size_t size)
+{
+    radio_metadata_type_t type = radio_metadata_type_of_key(key);
+    radio_metadata_fd_t value;
+    int region_size;
+
+    if (metadata == NULL || *metadata == NULL || type != RADIO_METADATA_TYPE_RAW || size == 0) {
+        return -EINVAL;
+    }
+    if (!ashmem_valid(fd)) {
+        return -EINVAL;
+    }
+    region_size = ashmem_get_size_region(fd);
+    if (region_size < 0 || (size_t)region_size < size) {
+        return -EINVAL;
+    }
+    value.fd = fd;
+    value.size = (uint32_t)size;
+    return replace_metadata((radio_metadata_buffer_t **)metadata,
+                            key, RADIO_METADATA_TYPE_FD, &value, sizeof(value));
+}
+
+int radio_metadata_replace_clock(radio_metadata_t **metadata,
+                                 const radio_metadata_key_t key,
+                                 const radio_metadata_clock_t *clock)
+{
+    radio_metadata_type_t type = radio_metadata_type_of_key(key);
+    if (metadata == NULL || *metadata == NULL || type != RADIO_METADATA_TYPE_CLOCK ||
+        clock == NULL || clock->timezone_offset_in_minutes < (-12 * 60) ||
+        clock->timezone_offset_in_minutes > (14 * 60)) {
+        return -EINVAL;
+    }
+    return replace_metadata(
+        (radio_metadata_buffer_t **)metadata, key, type, clock, sizeof(radio_metadata_clock_t));
+}
+
 int radio_metadata_add_metadata(radio_metadata_t **dst_metadata,
                            radio_metadata_t *src_metadata)
 {
@@ -299,6 +547,59 @@ int radio_metadata_add_metadata(radio_metadata_t **dst_metadata,
     return status;
 }
 
+int radio_metadata_seal(radio_metadata_t **metadata)
+{
+    radio_metadata_buffer_t *metadata_buf;
+    uint32_t index_offset;
+    uint32_t data_offset;
+    uint32_t used_size_int;
+    uint32_t *key_table;
+    uint32_t index;
+    int ret;
+
+    if (metadata == NULL || *metadata == NULL) {
+        return -EINVAL;
+    }
+
+    /* make room for the key table between the last entry and the index */
+    ret = check_size((radio_metadata_buffer_t **)metadata, RADIO_METADATA_KEY_TABLE_SIZE_INT);
+    if (ret < 0) {
+        return ret;
+    }
+    metadata_buf = (radio_metadata_buffer_t *)*metadata;
+
+    index_offset = metadata_buf->size_int - metadata_buf->count - 1;
+    data_offset = *((uint32_t *)metadata_buf + index_offset);
+
+    key_table = (uint32_t *)metadata_buf + data_offset;
+    memset(key_table, 0, RADIO_METADATA_KEY_TABLE_SIZE_INT * sizeof(uint32_t));
+    for (index = 0; index < metadata_buf->count; index++) {
+        radio_metadata_entry_t *entry = get_entry_at_index(metadata_buf, index, false);
+        uint32_t slot = (uint32_t)(entry->key - RADIO_METADATA_KEY_MIN);
+        /* record the first entry with this key, as returned by a linear search */
+        if (key_table[slot] == 0) {
+            key_table[slot] = index + 1;
+        }
+    }
+    metadata_buf->key_table_offset = data_offset;
+
+    /* trim the buffer to the size actually used */
+    used_size_int = data_offset + RADIO_METADATA_KEY_TABLE_SIZE_INT + metadata_buf->count + 1;
+    if (used_size_int < metadata_buf->size_int) {
+        ALOGV("%s trimming from %u to %u", __func__, metadata_buf->size_int, used_size_int);
+        memmove((uint32_t *)metadata_buf + used_size_int - (metadata_buf->count + 1),
+                (uint32_t *)metadata_buf + metadata_buf->size_int - (metadata_buf->count + 1),
+                (metadata_buf->count + 1) * sizeof(uint32_t));
+        metadata_buf->size_int = used_size_int;
+        metadata_buf = realloc(metadata_buf, used_size_int * sizeof(uint32_t));
+        if (metadata_buf != NULL) {
+            /* a shrinking realloc should not fail; keep the larger buffer if it does */
+            *metadata = (radio_metadata_t *)metadata_buf;
+        }
+    }
+    return 0;
+}
+
 int radio_metadata_check(const radio_metadata_t *metadata)
 {
     radio_metadata_buffer_t *metadata_buf =
@@ -324,6 +625,23 @@ int radio_metadata_check(const radio_metadata_t *metadata)
         return -EINVAL;
     }
 
+    /* sanity check on the key table written by radio_metadata_seal() */
+    if (metadata_buf->key_table_offset != 0) {
+        uint32_t min_offset = (sizeof(radio_metadata_buffer_t) + sizeof(uint32_t) - 1) /
+                        sizeof(uint32_t);
+        if (metadata_buf->key_table_offset < min_offset ||
+                metadata_buf->key_table_offset + RADIO_METADATA_KEY_TABLE_SIZE_INT >
+                        metadata_buf->size_int - metadata_buf->count - 1) {
+            return -EINVAL;
+        }
+        for (count = 0; count < RADIO_METADATA_KEY_TABLE_SIZE_INT; count++) {
+            uint32_t index = *((uint32_t *)metadata_buf + metadata_buf->key_table_offset + count);
+            if (index > metadata_buf->count) {
+                return -EINVAL;
+            }
+        }
+    }
+
     /* sanity check on each entry */
     for (count = 0; count < metadata_buf->count; count++) {
         radio_metadata_entry_t *entry = get_entry_at_index(metadata_buf, count, true);
@@ -335,7 +653,13 @@ int radio_metadata_check(const radio_metadata_t *metadata)
             return -EINVAL;
         }
         if (entry->type != radio_metadata_type_of_key(entry->key)) {
-            return -EINVAL;
+            /* fd references are accepted for keys of raw type,
+             * see radio_metadata_add_raw_fd() */
+            if (entry->type != RADIO_METADATA_TYPE_FD ||
+                    radio_metadata_type_of_key(entry->key) != RADIO_METADATA_TYPE_RAW ||
+                    entry->size != sizeof(radio_metadata_fd_t)) {
+                return -EINVAL;
+            }
         }
 
         /* do not request check because next entry can be the free slot */
@@ -416,6 +740,20 @@ int radio_metadata_get_from_key(const radio_metadata_t *metadata,
         return -EINVAL;
     }
 
+    /* O(1) lookup through the key table when the buffer has been sealed */
+    if (metadata_buf->key_table_offset != 0) {
+        uint32_t index = *((uint32_t *)metadata_buf + metadata_buf->key_table_offset +
+                (key - RADIO_METADATA_KEY_MIN));
+        if (index == 0 || index > metadata_buf->count) {
+            return -ENOENT;
+        }
+        entry = get_entry_at_index(metadata_buf, index - 1, false);
+        *type = entry->type;
+        *value = (void *)entry->data;
+        *size = (size_t)entry->size;
+        return 0;
+    }
+
     for (count = 0; count < metadata_buf->count; entry = NULL, count++) {
         entry = get_entry_at_index(metadata_buf, count, false);
         if (entry->key == key) {
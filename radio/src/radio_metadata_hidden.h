@@ -25,6 +25,13 @@
 #define RADIO_METADATA_DEFAULT_SIZE 64
 /* maximum size allocated for a metadata buffer in 32 bits units */
 #define RADIO_METADATA_MAX_SIZE (RADIO_METADATA_DEFAULT_SIZE << 12)
+/* size of the key to entry index table built by radio_metadata_seal() in 32 bits units:
+ * one slot per possible key */
+#define RADIO_METADATA_KEY_TABLE_SIZE_INT \
+        ((uint32_t)(RADIO_METADATA_KEY_MAX - RADIO_METADATA_KEY_MIN + 1))
+/* compact the entry area when in-place replacements by radio_metadata_replace_xxx() have
+ * left more than 1/RADIO_METADATA_COMPACT_DIV of the buffer as slack between entries */
+#define RADIO_METADATA_COMPACT_DIV 4
 
 /* meta data entry in a meta data buffer */
 typedef struct radio_metadata_entry {
@@ -70,7 +77,13 @@ typedef struct radio_metadata_entry {
 *   radio_metadata_deallocate().
 *   Meta data entries are added with radio_metadata_add_xxx() where xxx is int, text or raw.
 *   The buffer is allocated with a default size (RADIO_METADATA_DEFAULT_SIZE entries)
-*   by radio_metadata_allocate() and reallocated if needed by radio_metadata_add_xxx()
+*   by radio_metadata_allocate() and reallocated if needed by radio_metadata_add_xxx().
+*   radio_metadata_allocate_hint() allocates the exact size needed for the entries announced
+*   by the caller so that radio_metadata_add_xxx() never reallocates.
+*   radio_metadata_seal() writes a key to entry index table in the free space between the last
+*   entry and the index (recorded in key_table_offset) and trims the buffer to its used size.
+*   Each table slot holds the entry index plus one of the first entry with that key, or 0 if
+*   the key is absent. Adding an entry overwrites the table and clears key_table_offset.
 */
 
 /* Radio meta data buffer header */
@@ -79,6 +92,8 @@ typedef struct radio_metadata_buffer {
     uint32_t sub_channel;   /* sub channel this meta data is associated with */
     uint32_t size_int;      /* Total size in 32 bit word units */
     uint32_t count;         /* number of meta data entries */
+    uint32_t key_table_offset; /* offset in 32 bit word units of the key to entry index table
+                                  written by radio_metadata_seal(), 0 if not sealed */
 } radio_metadata_buffer_t;
 
 
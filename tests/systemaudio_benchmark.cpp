@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Benchmarks for the system/audio.h inline helpers used in stream-open and
+// routing hot paths: channel mask <-> count conversions, format property
+// queries and audio_gain comparisons.  Tracks a baseline for helper rework.
+
+#include <benchmark/benchmark.h>
+
+#include <system/audio.h>
+
+namespace {
+
+constexpr audio_channel_mask_t kOutMasks[] = {
+    AUDIO_CHANNEL_OUT_MONO,
+    AUDIO_CHANNEL_OUT_STEREO,
+    AUDIO_CHANNEL_OUT_QUAD,
+    AUDIO_CHANNEL_OUT_5POINT1,
+    AUDIO_CHANNEL_OUT_7POINT1,
+    AUDIO_CHANNEL_OUT_7POINT1POINT4,
+    AUDIO_CHANNEL_OUT_22POINT2,
+};
+
+constexpr audio_channel_mask_t kInMasks[] = {
+    AUDIO_CHANNEL_IN_MONO,
+    AUDIO_CHANNEL_IN_STEREO,
+    AUDIO_CHANNEL_IN_2POINT0POINT2,
+    AUDIO_CHANNEL_IN_5POINT1,
+};
+
+constexpr audio_format_t kFormats[] = {
+    AUDIO_FORMAT_PCM_8_BIT,
+    AUDIO_FORMAT_PCM_16_BIT,
+    AUDIO_FORMAT_PCM_24_BIT_PACKED,
+    AUDIO_FORMAT_PCM_8_24_BIT,
+    AUDIO_FORMAT_PCM_32_BIT,
+    AUDIO_FORMAT_PCM_FLOAT,
+    AUDIO_FORMAT_MP3,
+    AUDIO_FORMAT_AAC_LC,
+};
+
+void BM_ChannelCountFromOutMask(benchmark::State& state) {
+    size_t i = 0;
+    for (auto _ : state) {
+        const audio_channel_mask_t mask = kOutMasks[i];
+        benchmark::DoNotOptimize(audio_channel_count_from_out_mask(mask));
+        i = (i + 1) % std::size(kOutMasks);
+    }
+}
+
+BENCHMARK(BM_ChannelCountFromOutMask);
+
+void BM_ChannelCountFromInMask(benchmark::State& state) {
+    size_t i = 0;
+    for (auto _ : state) {
+        const audio_channel_mask_t mask = kInMasks[i];
+        benchmark::DoNotOptimize(audio_channel_count_from_in_mask(mask));
+        i = (i + 1) % std::size(kInMasks);
+    }
+}
+
+BENCHMARK(BM_ChannelCountFromInMask);
+
+void BM_ChannelOutMaskFromCount(benchmark::State& state) {
+    uint32_t count = 1;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(audio_channel_out_mask_from_count(count));
+        count = count % FCC_24 + 1;
+    }
+}
+
+BENCHMARK(BM_ChannelOutMaskFromCount);
+
+void BM_ChannelInMaskFromCount(benchmark::State& state) {
+    uint32_t count = 1;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(audio_channel_in_mask_from_count(count));
+        count = count % FCC_2 + 1;
+    }
+}
+
+BENCHMARK(BM_ChannelInMaskFromCount);
+
+void BM_ChannelMaskForIndexAssignmentFromCount(benchmark::State& state) {
+    uint32_t count = 1;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(audio_channel_mask_for_index_assignment_from_count(count));
+        count = count % AUDIO_CHANNEL_COUNT_MAX + 1;
+    }
+}
+
+BENCHMARK(BM_ChannelMaskForIndexAssignmentFromCount);
+
+void BM_BytesPerSample(benchmark::State& state) {
+    size_t i = 0;
+    for (auto _ : state) {
+        const audio_format_t format = kFormats[i];
+        benchmark::DoNotOptimize(audio_bytes_per_sample(format));
+        i = (i + 1) % std::size(kFormats);
+    }
+}
+
+BENCHMARK(BM_BytesPerSample);
+
+void BM_BytesPerFrame(benchmark::State& state) {
+    size_t i = 0;
+    for (auto _ : state) {
+        const audio_format_t format = kFormats[i];
+        benchmark::DoNotOptimize(audio_bytes_per_frame(2, format));
+        i = (i + 1) % std::size(kFormats);
+    }
+}
+
+BENCHMARK(BM_BytesPerFrame);
+
+void BM_IsLinearPcm(benchmark::State& state) {
+    size_t i = 0;
+    for (auto _ : state) {
+        const audio_format_t format = kFormats[i];
+        benchmark::DoNotOptimize(audio_is_linear_pcm(format));
+        i = (i + 1) % std::size(kFormats);
+    }
+}
+
+BENCHMARK(BM_IsLinearPcm);
+
+void BM_IsValidFormat(benchmark::State& state) {
+    size_t i = 0;
+    for (auto _ : state) {
+        const audio_format_t format = kFormats[i];
+        benchmark::DoNotOptimize(audio_is_valid_format(format));
+        i = (i + 1) % std::size(kFormats);
+    }
+}
+
+BENCHMARK(BM_IsValidFormat);
+
+void BM_GainConfigAreEqual(benchmark::State& state) {
+    // equal configs take the full comparison path
+    audio_gain_config lhs = {
+        .index = 0,
+        .mode = static_cast<audio_gain_mode_t>(AUDIO_GAIN_MODE_CHANNELS | AUDIO_GAIN_MODE_RAMP),
+        .channel_mask = AUDIO_CHANNEL_OUT_7POINT1,
+        .values = { -3200, -3100, -3000, -2900, -2800, -2700, -2600, -2500 },
+        .ramp_duration_ms = 10,
+    };
+    audio_gain_config rhs = lhs;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(audio_gain_config_are_equal(&lhs, &rhs));
+        benchmark::DoNotOptimize(&lhs);
+        benchmark::DoNotOptimize(&rhs);
+    }
+}
+
+BENCHMARK(BM_GainConfigAreEqual);
+
+void BM_GainsAreEqual(benchmark::State& state) {
+    audio_gain lhs = {
+        .mode = AUDIO_GAIN_MODE_JOINT,
+        .channel_mask = AUDIO_CHANNEL_OUT_STEREO,
+        .min_value = -6400,
+        .max_value = 0,
+        .default_value = -3200,
+        .step_value = 100,
+        .min_ramp_ms = 0,
+        .max_ramp_ms = 1000,
+    };
+    audio_gain rhs = lhs;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(audio_gains_are_equal(&lhs, &rhs));
+        benchmark::DoNotOptimize(&lhs);
+        benchmark::DoNotOptimize(&rhs);
+    }
+}
+
+BENCHMARK(BM_GainsAreEqual);
+
+}  // namespace
+
+BENCHMARK_MAIN();
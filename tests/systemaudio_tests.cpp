@@ -781,3 +781,55 @@ INSTANTIATE_TEST_CASE_P(SystemAudioPortTest, SystemAudioPortTest,
                                 AUDIO_PORT_TYPE_MIX,
                                 AUDIO_PORT_TYPE_SESSION))
         );
+
+TEST(SystemAudioTest, ValidFormatTables) {
+    // Every table entry must be accepted by audio_is_valid_format(), and the
+    // table driven check must agree with it over the whole sub format space
+    // of every main format (valid sub values are all below 0x1000).
+    for (uint32_t i = 0; i < AUDIO_FORMAT_VALID_CNT; ++i) {
+        const audio_format_t format = AUDIO_FORMAT_ALL_VALID_ARRAY[i];
+        EXPECT_TRUE(audio_is_valid_format(format)) << std::hex << format;
+        EXPECT_EQ(static_cast<int>(i), audio_valid_format_index(format));
+    }
+    for (uint32_t mainIndex = 0; mainIndex <= 0xFF; ++mainIndex) {
+        for (uint32_t sub = 0; sub < 0x1000; ++sub) {
+            const audio_format_t format =
+                    static_cast<audio_format_t>(mainIndex << 24 | sub);
+            ASSERT_EQ(audio_is_valid_format(format), audio_is_valid_format_fast(format))
+                    << std::hex << format;
+        }
+    }
+    EXPECT_EQ(-1, audio_valid_format_index(AUDIO_FORMAT_INVALID));
+    EXPECT_EQ(-1, audio_valid_format_index(AUDIO_FORMAT_DEFAULT));
+
+    // The PCM subformat position bits cover exactly the valid PCM formats.
+    for (uint32_t sub = 0; sub < 32; ++sub) {
+        const audio_format_t format = static_cast<audio_format_t>(AUDIO_FORMAT_PCM | sub);
+        EXPECT_EQ(audio_is_valid_format(format),
+                (AUDIO_FORMAT_PCM_SUB_VALID_POSITION_BITS & (1u << sub)) != 0)
+                << std::hex << format;
+    }
+}
+
+TEST(SystemAudioTest, SampleRateTables) {
+    uint32_t allBits = 0;
+    for (uint32_t i = 0; i < AUDIO_SAMPLE_RATE_CNT; ++i) {
+        const uint32_t rate = AUDIO_SAMPLE_RATE_ALL_ARRAY[i];
+        EXPECT_EQ(static_cast<int>(i), audio_sample_rate_index(rate));
+        EXPECT_EQ(1u << i, audio_sample_rate_position_bits(rate));
+        allBits |= audio_sample_rate_position_bits(rate);
+        // off by one rates are not in the set.
+        EXPECT_EQ(-1, audio_sample_rate_index(rate + 1));
+        EXPECT_EQ(0u, audio_sample_rate_position_bits(rate - 1));
+    }
+    EXPECT_EQ((1u << AUDIO_SAMPLE_RATE_CNT) - 1, allBits);
+    EXPECT_EQ(-1, audio_sample_rate_index(0));
+
+    // intersection of two capability sets is an AND of words.
+    const uint32_t sourceCaps = audio_sample_rate_position_bits(44100) |
+            audio_sample_rate_position_bits(48000) |
+            audio_sample_rate_position_bits(96000);
+    const uint32_t sinkCaps = audio_sample_rate_position_bits(48000) |
+            audio_sample_rate_position_bits(192000);
+    EXPECT_EQ(audio_sample_rate_position_bits(48000), sourceCaps & sinkCaps);
+}